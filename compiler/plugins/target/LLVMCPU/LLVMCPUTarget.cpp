@@ -11,6 +11,7 @@
 #include "compiler/plugins/target/LLVMCPU/Builtins/Musl.h"
 #include "compiler/plugins/target/LLVMCPU/Builtins/UKernel.h"
 #include "compiler/plugins/target/LLVMCPU/LLVMIRPasses.h"
+#include "compiler/plugins/target/LLVMCPU/LLVMIRSplitting.h"
 #include "compiler/plugins/target/LLVMCPU/LLVMTargetOptions.h"
 #include "compiler/plugins/target/LLVMCPU/LibraryBuilder.h"
 #include "compiler/plugins/target/LLVMCPU/LinkerTool.h"
@@ -29,12 +30,15 @@
 #include "iree/compiler/Dialect/LinalgExt/IR/LinalgExtDialect.h"
 #include "iree/compiler/PluginAPI/Client.h"
 #include "iree/compiler/Utils/ModuleUtils.h"
+#include "llvm/ADT/Sequence.h"
+#include "llvm/ADT/StringSet.h"
 #include "llvm/Bitcode/BitcodeReader.h"
 #include "llvm/Bitcode/BitcodeWriter.h"
 #include "llvm/IR/GlobalValue.h"
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/Module.h"
 #include "llvm/Linker/Linker.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/TargetSelect.h"
 #include "mlir/Dialect/ArmNeon/ArmNeonDialect.h"
 #include "mlir/Dialect/ArmSME/IR/ArmSME.h"
@@ -45,6 +49,7 @@
 #include "mlir/Dialect/Transform/IR/TransformDialect.h"
 #include "mlir/IR/BuiltinAttributes.h"
 #include "mlir/IR/DialectResourceBlobManager.h"
+#include "mlir/IR/Threading.h"
 #include "mlir/Target/LLVMIR/Dialect/ArmSME/ArmSMEToLLVMIRTranslation.h"
 #include "mlir/Target/LLVMIR/Dialect/ArmSVE/ArmSVEToLLVMIRTranslation.h"
 #include "mlir/Target/LLVMIR/Dialect/Builtin/BuiltinToLLVMIRTranslation.h"
@@ -81,8 +86,21 @@ static void dumpLLVMModuleToPath(StringRef path, StringRef baseName,
                  StringRef(binaryData.data(), binaryData.size()));
 }
 
+// Hides all definitions other than |preserveFuncs|. Definitions named in
+// |sharedNames| are referenced from other object files linked into the same
+// library and remain external with hidden visibility.
 static void fixupVisibility(llvm::Module &module,
-                            const SetVector<llvm::Function *> &preserveFuncs) {
+                            const SetVector<llvm::Function *> &preserveFuncs,
+                            const llvm::StringSet<> &sharedNames = {}) {
+  auto hideValue = [&](llvm::GlobalValue &value) {
+    value.setDSOLocal(true);
+    if (sharedNames.contains(value.getName())) {
+      value.setLinkage(llvm::GlobalValue::LinkageTypes::ExternalLinkage);
+      value.setVisibility(llvm::GlobalValue::VisibilityTypes::HiddenVisibility);
+    } else {
+      value.setLinkage(llvm::GlobalValue::LinkageTypes::InternalLinkage);
+    }
+  };
   for (auto &func : module) {
     if (preserveFuncs.contains(&func) || func.getName() == "iree_dll_main") {
       // Leave our library query function as public/external so that it is
@@ -94,12 +112,14 @@ static void fixupVisibility(llvm::Module &module,
       // often come from declared llvm builtin ops (llvm.memcpy/etc).
       continue;
     }
-    func.setDSOLocal(true);
-    func.setLinkage(llvm::GlobalValue::LinkageTypes::InternalLinkage);
+    hideValue(func);
   }
   for (auto &global : module.globals()) {
-    global.setDSOLocal(true);
-    global.setLinkage(llvm::GlobalValue::LinkageTypes::InternalLinkage);
+    if (global.isDeclaration()) {
+      // Defined by another object file linked into the same library.
+      continue;
+    }
+    hideValue(global);
   }
 }
 
@@ -380,6 +400,7 @@ public:
     }
 
     // Declare exported entry points.
+    SmallVector<llvm::Function *> dispatchFuncs;
     auto align16 = llvm::Attribute::getWithAlignment(context, llvm::Align(16));
     for (auto exportOp : variantOp.getBlock().getOps<ExecutableExportOp>()) {
       // Find the matching function in the LLVM module.
@@ -388,6 +409,7 @@ public:
         continue;
       llvmFunc->setLinkage(llvm::GlobalValue::LinkageTypes::InternalLinkage);
       llvmFunc->setDSOLocal(true);
+      dispatchFuncs.push_back(llvmFunc);
 
       // Tag the function parameters in case they got removed during conversion.
       // (%arg0: environment, %arg1: dispatch_state, %arg2: workgroup_state)
@@ -593,72 +615,87 @@ public:
                            variantOp.getName(), ".linked", *llvmModule);
     }
 
-    // LLVM opt passes that perform code generation optimizations/transformation
-    // similar to what a frontend would do.
-    if (failed(
-            runLLVMIRPasses(target, targetMachine.get(), llvmModule.get()))) {
-      return variantOp.emitError()
-             << "failed to run LLVM-IR opt passes for IREE::HAL::ExecutableOp "
-                "targeting '"
-             << targetTriple.str() << "'";
-    }
-
-    // Fixup visibility from any symbols we may link in - we want to hide all
-    // but the query entry point.
-    // Note: can't move this before runLLVMIRPasses at the moment, as further
-    // symbol references may still be created past this point, namely to math
-    // functions, e.g. `llvm.frem` lowering to a call to `fmodf`.
-    SetVector<llvm::Function *> preservedFuncs;
-    preservedFuncs.insert(queryLibraryFunc);
-    fixupVisibility(*llvmModule, preservedFuncs);
-
-    // Dump bitcode post-linking and optimization.
-    if (!options.dumpIntermediatesPath.empty()) {
-      dumpLLVMModuleToPath(options.dumpIntermediatesPath, options.dumpBaseName,
-                           variantOp.getName(), ".optimized", *llvmModule);
-    }
-
     SmallVector<Artifact> objectFiles;
 
-    // Emit the base object file containing the bulk of our code.
-    // This must come first such that we have the proper library linking order.
-    {
-      // NOTE: today we just use a single object file, however if we wanted to
-      // scale code generation and linking we'd want to generate one per
-      // function (or something like that). A single object file is also
-      // instrumental to static library generation (which only supports one
-      // object file per library).
-      std::string objectData;
-      if (failed(runEmitObjFilePasses(targetMachine.get(), llvmModule.get(),
-                                      llvm::CodeGenFileType::ObjectFile,
-                                      &objectData))) {
+    // Split optimization and code generation across threads if requested.
+    // Static libraries only support a single object file and sanitizers
+    // instrument each module with its own constructors so both always use a
+    // single module.
+    unsigned partitionCount = defaultOptions_.codegenPartitionCount;
+    if (partitionCount > 1 && dispatchFuncs.size() > 1 && !target.linkStatic &&
+        target.sanitizerKind == SanitizerKind::kNone) {
+      if (failed(serializePartitionedObjectFiles(
+              options, target, variantOp, libraryName, queryFunctionName,
+              *llvmModule, dispatchFuncs, partitionCount, objectFiles))) {
+        return failure();
+      }
+    } else {
+      // LLVM opt passes that perform code generation
+      // optimizations/transformation similar to what a frontend would do.
+      if (failed(runLLVMIRPasses(target, targetMachine.get(),
+                                 llvmModule.get()))) {
         return variantOp.emitError()
-               << "failed to compile LLVM-IR module to an object file";
+               << "failed to run LLVM-IR opt passes for "
+                  "IREE::HAL::ExecutableOp targeting '"
+               << targetTriple.str() << "'";
       }
+
+      // Fixup visibility from any symbols we may link in - we want to hide all
+      // but the query entry point.
+      // Note: can't move this before runLLVMIRPasses at the moment, as further
+      // symbol references may still be created past this point, namely to math
+      // functions, e.g. `llvm.frem` lowering to a call to `fmodf`.
+      SetVector<llvm::Function *> preservedFuncs;
+      preservedFuncs.insert(queryLibraryFunc);
+      fixupVisibility(*llvmModule, preservedFuncs);
+
+      // Dump bitcode post-linking and optimization.
       if (!options.dumpIntermediatesPath.empty()) {
-        dumpDataToPath(options.dumpIntermediatesPath, options.dumpBaseName,
-                       variantOp.getName(), ".o", objectData);
+        dumpLLVMModuleToPath(options.dumpIntermediatesPath,
+                             options.dumpBaseName, variantOp.getName(),
+                             ".optimized", *llvmModule);
       }
-      auto objectFile = Artifact::createTemporary(libraryName, "o");
-      auto &os = objectFile.outputFile->os();
-      os << objectData;
-      os.flush();
-      os.close();
-      objectFiles.push_back(std::move(objectFile));
-    }
 
-    // Dump assembly listing after optimization, which is just a textual
-    // representation of the object file we generate below.
-    if (!options.dumpIntermediatesPath.empty()) {
-      std::string asmData;
-      if (failed(runEmitObjFilePasses(targetMachine.get(), llvmModule.get(),
-                                      llvm::CodeGenFileType::AssemblyFile,
-                                      &asmData))) {
-        return variantOp.emitError()
-               << "failed to compile LLVM-IR module to an assembly file";
+      // Emit the base object file containing the bulk of our code.
+      // This must come first such that we have the proper library linking
+      // order.
+      {
+        // NOTE: a single object file is instrumental to static library
+        // generation (which only supports one object file per library).
+        // serializePartitionedObjectFiles is used to scale code generation
+        // across threads otherwise.
+        std::string objectData;
+        if (failed(runEmitObjFilePasses(targetMachine.get(), llvmModule.get(),
+                                        llvm::CodeGenFileType::ObjectFile,
+                                        &objectData))) {
+          return variantOp.emitError()
+                 << "failed to compile LLVM-IR module to an object file";
+        }
+        if (!options.dumpIntermediatesPath.empty()) {
+          dumpDataToPath(options.dumpIntermediatesPath, options.dumpBaseName,
+                         variantOp.getName(), ".o", objectData);
+        }
+        auto objectFile = Artifact::createTemporary(libraryName, "o");
+        auto &os = objectFile.outputFile->os();
+        os << objectData;
+        os.flush();
+        os.close();
+        objectFiles.push_back(std::move(objectFile));
+      }
+
+      // Dump assembly listing after optimization, which is just a textual
+      // representation of the object file we generate below.
+      if (!options.dumpIntermediatesPath.empty()) {
+        std::string asmData;
+        if (failed(runEmitObjFilePasses(targetMachine.get(), llvmModule.get(),
+                                        llvm::CodeGenFileType::AssemblyFile,
+                                        &asmData))) {
+          return variantOp.emitError()
+                 << "failed to compile LLVM-IR module to an assembly file";
+        }
+        dumpDataToPath(options.dumpIntermediatesPath, options.dumpBaseName,
+                       variantOp.getName(), ".s", asmData);
       }
-      dumpDataToPath(options.dumpIntermediatesPath, options.dumpBaseName,
-                     variantOp.getName(), ".s", asmData);
     }
 
     // If custom object files were specified then add those to our artifact set.
@@ -699,6 +736,115 @@ public:
     }
   }
 
+  // Splits |llvmModule| into up to |partitionCount| partitions and optimizes
+  // and emits an object file for each on its own thread. Object files are
+  // appended to |objectFiles| in partition order so that the linked library
+  // does not depend on thread scheduling.
+  LogicalResult serializePartitionedObjectFiles(
+      const SerializationOptions &options, const LLVMTarget &target,
+      IREE::HAL::ExecutableVariantOp variantOp, StringRef libraryName,
+      StringRef queryFunctionName, llvm::Module &llvmModule,
+      ArrayRef<llvm::Function *> dispatchFuncs, unsigned partitionCount,
+      SmallVectorImpl<Artifact> &objectFiles) {
+    SmallVector<LLVMModulePartition> partitions =
+        splitLLVMModule(llvmModule, dispatchFuncs, partitionCount);
+    LLVM_DEBUG(dbgs() << "LLVM-CPU split '" << libraryName << "' into "
+                      << partitions.size() << " partitions\n");
+
+    // Diagnostics are reported after all partitions have been processed as
+    // they cannot be emitted from the worker threads.
+    std::string variantName = variantOp.getName().str();
+    SmallVector<std::string> objectDatas(partitions.size());
+    SmallVector<std::string> errors(partitions.size());
+    auto serializePartition = [&](size_t index) -> LogicalResult {
+      const LLVMModulePartition &partition = partitions[index];
+      std::string dumpName = variantName + "_" + std::to_string(index);
+
+      // Each partition is loaded into its own context and compiled with its
+      // own target machine as neither may be shared across threads.
+      llvm::LLVMContext context;
+      auto moduleOr = llvm::parseBitcodeFile(
+          llvm::MemoryBufferRef(StringRef(partition.bitcode.data(),
+                                          partition.bitcode.size()),
+                                libraryName),
+          context);
+      if (!moduleOr) {
+        errors[index] = "failed to load partition bitcode: " +
+                        llvm::toString(moduleOr.takeError());
+        return failure();
+      }
+      std::unique_ptr<llvm::Module> module = std::move(*moduleOr);
+      auto targetMachine = createTargetMachine(target);
+      if (!targetMachine) {
+        errors[index] = "failed to create target machine";
+        return failure();
+      }
+
+      if (failed(runLLVMIRPasses(target, targetMachine.get(), module.get()))) {
+        errors[index] = "failed to run LLVM-IR opt passes";
+        return failure();
+      }
+
+      // Runtime library functions referenced by code generation in any
+      // partition are defined by the first partition and must stay visible
+      // to the others.
+      SetVector<llvm::Function *> preservedFuncs;
+      if (auto *queryFunc = module->getFunction(queryFunctionName)) {
+        preservedFuncs.insert(queryFunc);
+      }
+      fixupVisibility(*module, preservedFuncs, partition.sharedNames);
+
+      if (!options.dumpIntermediatesPath.empty()) {
+        dumpLLVMModuleToPath(options.dumpIntermediatesPath,
+                             options.dumpBaseName, dumpName, ".optimized",
+                             *module);
+      }
+
+      if (failed(runEmitObjFilePasses(targetMachine.get(), module.get(),
+                                      llvm::CodeGenFileType::ObjectFile,
+                                      &objectDatas[index]))) {
+        errors[index] = "failed to compile LLVM-IR module to an object file";
+        return failure();
+      }
+      if (!options.dumpIntermediatesPath.empty()) {
+        dumpDataToPath(options.dumpIntermediatesPath, options.dumpBaseName,
+                       dumpName, ".o", objectDatas[index]);
+        std::string asmData;
+        if (failed(runEmitObjFilePasses(targetMachine.get(), module.get(),
+                                        llvm::CodeGenFileType::AssemblyFile,
+                                        &asmData))) {
+          errors[index] =
+              "failed to compile LLVM-IR module to an assembly file";
+          return failure();
+        }
+        dumpDataToPath(options.dumpIntermediatesPath, options.dumpBaseName,
+                       dumpName, ".s", asmData);
+      }
+      return success();
+    };
+    if (failed(failableParallelForEach(variantOp.getContext(),
+                                       llvm::seq<size_t>(0, partitions.size()),
+                                       serializePartition))) {
+      for (auto [index, error] : llvm::enumerate(errors)) {
+        if (!error.empty()) {
+          variantOp.emitError() << "partition " << index << " of '"
+                                << libraryName << "': " << error;
+        }
+      }
+      return failure();
+    }
+
+    for (auto &objectData : objectDatas) {
+      auto objectFile = Artifact::createTemporary(libraryName, "o");
+      auto &os = objectFile.outputFile->os();
+      os << objectData;
+      os.flush();
+      os.close();
+      objectFiles.push_back(std::move(objectFile));
+    }
+    return success();
+  }
+
   LogicalResult serializeStaticLibraryExecutable(
       const SerializationOptions &options, const LLVMTarget &target,
       IREE::HAL::ExecutableVariantOp variantOp, OpBuilder &executableBuilder,
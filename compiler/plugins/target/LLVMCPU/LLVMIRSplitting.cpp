@@ -0,0 +1,225 @@
+// Copyright 2025 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "compiler/plugins/target/LLVMCPU/LLVMIRSplitting.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SetVector.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/Bitcode/BitcodeWriter.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/GlobalAlias.h"
+#include "llvm/IR/GlobalVariable.h"
+#include "llvm/IR/InstIterator.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Transforms/Utils/Cloning.h"
+#include "llvm/Transforms/Utils/ValueMapper.h"
+#include "mlir/Support/LLVM.h"
+
+namespace mlir::iree_compiler::IREE::HAL {
+
+// Appends all global values directly referenced by the body or initializer
+// of |value| to |refs|.
+static void
+collectReferencedGlobals(llvm::GlobalValue *value,
+                         SmallVectorImpl<llvm::GlobalValue *> &refs) {
+  SmallVector<llvm::Constant *> worklist;
+  llvm::SmallPtrSet<llvm::Constant *, 16> visited;
+  auto addConstant = [&](llvm::Value *operand) {
+    auto *constant = dyn_cast_if_present<llvm::Constant>(operand);
+    if (constant && visited.insert(constant).second) {
+      worklist.push_back(constant);
+    }
+  };
+  if (auto *func = dyn_cast<llvm::Function>(value)) {
+    for (auto &inst : llvm::instructions(func)) {
+      for (auto &operand : inst.operands()) {
+        addConstant(operand);
+      }
+    }
+    if (func->hasPersonalityFn()) {
+      addConstant(func->getPersonalityFn());
+    }
+  } else if (auto *global = dyn_cast<llvm::GlobalVariable>(value)) {
+    if (global->hasInitializer()) {
+      addConstant(global->getInitializer());
+    }
+  } else if (auto *alias = dyn_cast<llvm::GlobalAlias>(value)) {
+    addConstant(alias->getAliasee());
+  }
+  while (!worklist.empty()) {
+    auto *constant = worklist.pop_back_val();
+    if (auto *ref = dyn_cast<llvm::GlobalValue>(constant)) {
+      refs.push_back(ref);
+      continue;
+    }
+    for (auto &operand : constant->operands()) {
+      addConstant(operand);
+    }
+  }
+}
+
+// Promotes |value| to a hidden external symbol so that it can be referenced
+// from other object files linked into the same library.
+static void promoteToHidden(llvm::GlobalValue *value) {
+  if (!value->hasName()) {
+    // Uniqued by the module symbol table.
+    value->setName("__iree_split_shared");
+  }
+  value->setLinkage(llvm::GlobalValue::ExternalLinkage);
+  value->setVisibility(llvm::GlobalValue::HiddenVisibility);
+  value->setDSOLocal(true);
+}
+
+SmallVector<LLVMModulePartition>
+splitLLVMModule(llvm::Module &module, ArrayRef<llvm::Function *> rootFuncs,
+                unsigned maxPartitionCount) {
+  size_t partitionCount = std::clamp<size_t>(
+      maxPartitionCount, 1, std::max<size_t>(rootFuncs.size(), 1));
+  llvm::DenseSet<llvm::GlobalValue *> rootSet(rootFuncs.begin(),
+                                              rootFuncs.end());
+
+  // Definitions in each partition in the order they were discovered. Values
+  // may be present in multiple partitions (duplicated functions).
+  SmallVector<llvm::SetVector<llvm::GlobalValue *>> partitionValues(
+      partitionCount);
+  SmallVector<uint64_t> partitionSizes(partitionCount, 0);
+
+  // All externally visible definitions that are not roots live in the first
+  // partition. This includes the library query function and tables
+  // referencing every root as well as runtime library functions that code
+  // generation may introduce calls to after optimization.
+  SmallVector<llvm::GlobalValue *> baseValues;
+  for (auto &value : module.global_values()) {
+    if (value.isDeclaration() || value.hasLocalLinkage() ||
+        rootSet.contains(&value)) {
+      continue;
+    }
+    baseValues.push_back(&value);
+    partitionValues[0].insert(&value);
+    if (auto *func = dyn_cast<llvm::Function>(&value)) {
+      partitionSizes[0] += func->getInstructionCount();
+    }
+  }
+
+  // Distribute roots largest first to the smallest partition. Ties are broken
+  // by module order and partition index to keep the result deterministic.
+  SmallVector<std::pair<uint64_t, llvm::Function *>> sortedRoots;
+  for (auto *func : rootFuncs) {
+    sortedRoots.emplace_back(func->getInstructionCount(), func);
+  }
+  llvm::stable_sort(sortedRoots, [](const auto &lhs, const auto &rhs) {
+    return lhs.first > rhs.first;
+  });
+  SmallVector<SmallVector<llvm::GlobalValue *>> partitionRoots(partitionCount);
+  for (auto [size, func] : sortedRoots) {
+    size_t index = std::distance(partitionSizes.begin(),
+                                 llvm::min_element(partitionSizes));
+    partitionSizes[index] += size;
+    partitionRoots[index].push_back(func);
+    partitionValues[index].insert(func);
+  }
+
+  // Pull everything each partition references into it. Functions are
+  // duplicated so that they can still be inlined while data is defined by the
+  // first partition referencing it and shared with the others.
+  llvm::DenseMap<llvm::GlobalValue *, size_t> dataOwners;
+  llvm::SetVector<llvm::GlobalValue *> sharedData;
+  SmallVector<llvm::GlobalValue *> refs;
+  for (auto [index, values] : llvm::enumerate(partitionValues)) {
+    // Values are appended while iterating.
+    for (size_t i = 0; i < values.size(); ++i) {
+      refs.clear();
+      collectReferencedGlobals(values[i], refs);
+      for (auto *ref : refs) {
+        if (ref->isDeclaration() || rootSet.contains(ref)) {
+          continue;
+        } else if (isa<llvm::Function>(ref)) {
+          values.insert(ref);
+        } else if (ref->hasLocalLinkage()) {
+          auto [it, inserted] = dataOwners.try_emplace(ref, index);
+          if (inserted) {
+            values.insert(ref);
+          } else if (it->second != index) {
+            sharedData.insert(ref);
+          }
+        }
+      }
+    }
+  }
+
+  // Roots are referenced from the library tables in the first partition.
+  for (auto *func : rootFuncs) {
+    promoteToHidden(func);
+  }
+  for (auto *value : sharedData) {
+    promoteToHidden(value);
+  }
+
+  SmallVector<LLVMModulePartition> partitions(partitionCount);
+  for (auto [index, partition] : llvm::enumerate(partitions)) {
+    const auto &values = partitionValues[index];
+    for (auto *value : partitionRoots[index]) {
+      partition.sharedNames.insert(value->getName());
+    }
+    for (auto *value : sharedData) {
+      if (dataOwners.lookup(value) == index) {
+        partition.sharedNames.insert(value->getName());
+      }
+    }
+    if (index == 0) {
+      for (auto *value : baseValues) {
+        partition.sharedNames.insert(value->getName());
+      }
+    }
+
+    llvm::ValueToValueMapTy valueMap;
+    auto shouldCloneDefinition = [&](const llvm::GlobalValue *value) {
+      return values.contains(const_cast<llvm::GlobalValue *>(value));
+    };
+    std::unique_ptr<llvm::Module> partitionModule =
+        llvm::CloneModule(module, valueMap, shouldCloneDefinition);
+
+    // Copies of externally visible functions defined by the first partition
+    // are private to each other partition.
+    if (index != 0) {
+      for (auto *value : values) {
+        if (isa<llvm::Function>(value) && !value->hasLocalLinkage() &&
+            !rootSet.contains(value)) {
+          auto *clonedValue = cast<llvm::GlobalValue>(valueMap[value]);
+          clonedValue->setLinkage(llvm::GlobalValue::InternalLinkage);
+          clonedValue->setDSOLocal(true);
+        }
+      }
+    }
+
+    // Drop declarations of everything the partition does not reference.
+    for (auto &func : llvm::make_early_inc_range(*partitionModule)) {
+      if (func.isDeclaration() && func.use_empty()) {
+        func.eraseFromParent();
+      }
+    }
+    for (auto &global :
+         llvm::make_early_inc_range(partitionModule->globals())) {
+      if (global.isDeclaration() && global.use_empty()) {
+        global.eraseFromParent();
+      }
+    }
+
+    llvm::raw_svector_ostream os(partition.bitcode);
+    llvm::WriteBitcodeToFile(*partitionModule, os);
+  }
+  return partitions;
+}
+
+} // namespace mlir::iree_compiler::IREE::HAL
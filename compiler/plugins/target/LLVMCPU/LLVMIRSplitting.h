@@ -0,0 +1,51 @@
+// Copyright 2025 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_COMPILER_PLUGINS_TARGET_LLVMCPU_LLVMIRSPLITTING_H_
+#define IREE_COMPILER_PLUGINS_TARGET_LLVMCPU_LLVMIRSPLITTING_H_
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringSet.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/Module.h"
+
+namespace mlir::iree_compiler::IREE::HAL {
+
+// A partition of a module produced by splitLLVMModule.
+struct LLVMModulePartition {
+  // Bitcode of the partition module. Partitions are serialized so that they
+  // can be loaded into independent llvm::LLVMContexts and compiled on
+  // separate threads.
+  llvm::SmallVector<char, 0> bitcode;
+
+  // Names of definitions in the partition that are referenced from other
+  // partitions. These must remain external with hidden visibility so that
+  // they resolve when the partition object files are linked together.
+  llvm::StringSet<> sharedNames;
+};
+
+// Splits |module| into at most |maxPartitionCount| partitions by distributing
+// |rootFuncs| (the dispatch functions of an executable library) such that
+// the instruction count of each partition is roughly balanced.
+//
+// The first partition additionally holds all other externally visible
+// definitions (library metadata, query functions, linked runtime libraries,
+// etc). Other functions are duplicated as internal copies into every partition
+// referencing them so that they remain inlinable while internal globals are
+// defined in a single partition and shared. Root functions and shared globals
+// are promoted to external linkage with hidden visibility in |module|.
+//
+// Partitioning only depends on the contents of |module| and the partition
+// count and produces identical partitions across runs.
+llvm::SmallVector<LLVMModulePartition>
+splitLLVMModule(llvm::Module &module,
+                llvm::ArrayRef<llvm::Function *> rootFuncs,
+                unsigned maxPartitionCount);
+
+} // namespace mlir::iree_compiler::IREE::HAL
+
+#endif // IREE_COMPILER_PLUGINS_TARGET_LLVMCPU_LLVMIRSPLITTING_H_
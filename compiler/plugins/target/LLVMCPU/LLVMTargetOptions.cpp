@@ -502,6 +502,15 @@ void LLVMCPUTargetCLOptions::bindOptions(OptionsBinder &binder) {
       "iree-llvmcpu-keep-linker-artifacts", keepLinkerArtifacts,
       llvm::cl::cat(category),
       llvm::cl::desc("Keep LLVM linker target artifacts (.so/.dll/etc)"));
+  binder.opt<unsigned>(
+      "iree-llvmcpu-codegen-partitions", codegenPartitionCount,
+      llvm::cl::cat(category),
+      llvm::cl::desc(
+          "Number of partitions the dispatch functions of each executable "
+          "library are split into for LLVM optimization and code generation "
+          "on multiple threads. The output only depends on the partition "
+          "count and not on the number of threads. Ignored when producing "
+          "static libraries."));
 
   // Default device options.
   binder.opt<std::string>("iree-llvmcpu-target-triple", targetTriple,
@@ -598,6 +607,7 @@ LLVMTargetOptions LLVMCPUTargetCLOptions::getTargetOptions() {
   targetOptions.embeddedLinkerPath = embeddedLinkerPath;
   targetOptions.wasmLinkerPath = wasmLinkerPath;
   targetOptions.keepLinkerArtifacts = keepLinkerArtifacts;
+  targetOptions.codegenPartitionCount = codegenPartitionCount;
 
   if (targetTriple.empty()) {
     targetTriple = llvm::sys::getProcessTriple();
@@ -163,6 +163,11 @@ struct LLVMTargetOptions {
 
   // True to keep linker artifacts for debugging.
   bool keepLinkerArtifacts = false;
+
+  // Number of partitions the linked module of each executable library is
+  // split into for optimization and code generation on multiple threads.
+  // 1 compiles the entire library as a single module.
+  unsigned codegenPartitionCount = 1;
 };
 
 // Creates target machine form target options.
@@ -177,6 +182,7 @@ struct LLVMCPUTargetCLOptions {
   std::string embeddedLinkerPath;
   std::string wasmLinkerPath;
   bool keepLinkerArtifacts = false;
+  unsigned codegenPartitionCount = 1;
 
   // Default device options.
   std::string targetTriple;
@@ -1,5 +1,66 @@
 // Tests the embedded ELF linker that will work on all targets.
 // RUN: iree-opt --split-input-file --iree-stream-transformation-pipeline --iree-hal-transformation-pipeline --iree-llvmcpu-link-embedded=true %s | FileCheck %s
+// RUN: iree-opt --split-input-file --iree-stream-transformation-pipeline --iree-hal-transformation-pipeline --iree-llvmcpu-link-embedded=true --iree-llvmcpu-codegen-partitions=2 %s | FileCheck %s
+
+// Partitioned code generation must emit one module per partition and produce
+// identical binaries across compilations.
+// RUN: rm -rf %t
+// RUN: iree-opt --split-input-file --iree-stream-transformation-pipeline --iree-hal-transformation-pipeline --iree-llvmcpu-link-embedded=true --iree-llvmcpu-codegen-partitions=2 \
+// RUN:   --iree-hal-dump-executable-intermediates-to=%t/a --iree-hal-dump-executable-binaries-to=%t/a-bin %s -o /dev/null
+// RUN: iree-opt --split-input-file --iree-stream-transformation-pipeline --iree-hal-transformation-pipeline --iree-llvmcpu-link-embedded=true --iree-llvmcpu-codegen-partitions=2 \
+// RUN:   --iree-hal-dump-executable-intermediates-to=%t/b --iree-hal-dump-executable-binaries-to=%t/b-bin %s -o /dev/null
+// RUN: (echo PARTITION0; grep "^define" %t/a/*_embedded_elf_x86_64_0.optimized.ll; \
+// RUN:  echo PARTITION1; grep "^define" %t/a/*_embedded_elf_x86_64_1.optimized.ll) | \
+// RUN:   FileCheck %s --check-prefix=PARTITIONS --implicit-check-not=define
+// RUN: not ls %t/a/*_embedded_elf_x86_64_2.optimized.ll
+// RUN: cmp %t/a/*_embedded_elf_x86_64_0.o %t/b/*_embedded_elf_x86_64_0.o
+// RUN: cmp %t/a/*_embedded_elf_x86_64_1.o %t/b/*_embedded_elf_x86_64_1.o
+// RUN: diff -r %t/a-bin %t/b-bin
+
+module attributes {
+  hal.device.targets = [
+    #hal.device.target<"local", [
+      #hal.executable.target<"llvm-cpu", "embedded-elf-x86_64", {
+        native_vector_size = 16 : index
+      }>
+    ]> : !hal.device
+  ]
+} {
+
+stream.executable public @add_dispatch_0 {
+  stream.executable.export @add_dispatch_0 workgroups(%arg0 : index) -> (index, index, index) {
+    %x, %y, %z = iree_tensor_ext.dispatch.workgroup_count_from_dag_root(%arg0)
+    stream.return %x, %y, %z : index, index, index
+  }
+  builtin.module  {
+    func.func @add_dispatch_0(%arg0_binding: !stream.binding, %arg1_binding: !stream.binding, %arg2_binding: !stream.binding) {
+      %c0 = arith.constant 0 : index
+      %arg0 = stream.binding.subspan %arg0_binding[%c0] : !stream.binding -> !iree_tensor_ext.dispatch.tensor<readonly:tensor<16xf32>>
+      %arg1 = stream.binding.subspan %arg1_binding[%c0] : !stream.binding -> !iree_tensor_ext.dispatch.tensor<readonly:tensor<16xf32>>
+      %arg2 = stream.binding.subspan %arg2_binding[%c0] : !stream.binding -> !iree_tensor_ext.dispatch.tensor<writeonly:tensor<16xf32>>
+      %0 = tensor.empty() : tensor<16xf32>
+      %1 = iree_tensor_ext.dispatch.tensor.load %arg0, offsets=[0], sizes=[16], strides=[1] : !iree_tensor_ext.dispatch.tensor<readonly:tensor<16xf32>> -> tensor<16xf32>
+      %2 = iree_tensor_ext.dispatch.tensor.load %arg1, offsets=[0], sizes=[16], strides=[1] : !iree_tensor_ext.dispatch.tensor<readonly:tensor<16xf32>> -> tensor<16xf32>
+      %3 = linalg.generic {indexing_maps = [affine_map<(d0) -> (d0)>, affine_map<(d0) -> (d0)>, affine_map<(d0) -> (d0)>], iterator_types = ["parallel"]} ins(%1, %2 : tensor<16xf32>, tensor<16xf32>) outs(%0 : tensor<16xf32>) {
+      ^bb0(%arg3: f32, %arg4: f32, %arg5: f32):
+        %4 = arith.addf %arg3, %arg4 : f32
+        linalg.yield %4 : f32
+      } -> tensor<16xf32>
+      iree_tensor_ext.dispatch.tensor.store %3, %arg2, offsets=[0], sizes=[16], strides=[1] : tensor<16xf32> -> !iree_tensor_ext.dispatch.tensor<writeonly:tensor<16xf32>>
+      return
+    }
+  }
+}
+
+}
+
+// CHECK:       hal.executable.binary public @embedded_elf_x86_64
+// CHECK-SAME:     data = dense
+// CHECK-SAME:     format = "embedded-elf-x86_64"
+
+// -----
+
+// Tests splitting code generation of a library with multiple dispatches.
 
 module attributes {
   hal.device.targets = [
@@ -36,8 +97,42 @@ stream.executable public @add_dispatch_0 {
   }
 }
 
+stream.executable public @mul_dispatch_0 {
+  stream.executable.export @mul_dispatch_0 workgroups(%arg0 : index) -> (index, index, index) {
+    %x, %y, %z = iree_tensor_ext.dispatch.workgroup_count_from_dag_root(%arg0)
+    stream.return %x, %y, %z : index, index, index
+  }
+  builtin.module  {
+    func.func @mul_dispatch_0(%arg0_binding: !stream.binding, %arg1_binding: !stream.binding, %arg2_binding: !stream.binding) {
+      %c0 = arith.constant 0 : index
+      %arg0 = stream.binding.subspan %arg0_binding[%c0] : !stream.binding -> !iree_tensor_ext.dispatch.tensor<readonly:tensor<16xf32>>
+      %arg1 = stream.binding.subspan %arg1_binding[%c0] : !stream.binding -> !iree_tensor_ext.dispatch.tensor<readonly:tensor<16xf32>>
+      %arg2 = stream.binding.subspan %arg2_binding[%c0] : !stream.binding -> !iree_tensor_ext.dispatch.tensor<writeonly:tensor<16xf32>>
+      %0 = tensor.empty() : tensor<16xf32>
+      %1 = iree_tensor_ext.dispatch.tensor.load %arg0, offsets=[0], sizes=[16], strides=[1] : !iree_tensor_ext.dispatch.tensor<readonly:tensor<16xf32>> -> tensor<16xf32>
+      %2 = iree_tensor_ext.dispatch.tensor.load %arg1, offsets=[0], sizes=[16], strides=[1] : !iree_tensor_ext.dispatch.tensor<readonly:tensor<16xf32>> -> tensor<16xf32>
+      %3 = linalg.generic {indexing_maps = [affine_map<(d0) -> (d0)>, affine_map<(d0) -> (d0)>, affine_map<(d0) -> (d0)>], iterator_types = ["parallel"]} ins(%1, %2 : tensor<16xf32>, tensor<16xf32>) outs(%0 : tensor<16xf32>) {
+      ^bb0(%arg3: f32, %arg4: f32, %arg5: f32):
+        %4 = arith.mulf %arg3, %arg4 : f32
+        linalg.yield %4 : f32
+      } -> tensor<16xf32>
+      iree_tensor_ext.dispatch.tensor.store %3, %arg2, offsets=[0], sizes=[16], strides=[1] : tensor<16xf32> -> !iree_tensor_ext.dispatch.tensor<writeonly:tensor<16xf32>>
+      return
+    }
+  }
+}
+
 }
 
 // CHECK:       hal.executable.binary public @embedded_elf_x86_64
 // CHECK-SAME:     data = dense
 // CHECK-SAME:     format = "embedded-elf-x86_64"
+
+// Dispatches are assigned to the partition with the fewest instructions. The
+// first partition starts with the library query function so it receives the
+// second dispatch while the first dispatch is placed in the second partition.
+// PARTITIONS-LABEL: PARTITION0
+// PARTITIONS-DAG:   define {{.*}}@iree_hal_executable_library_query(
+// PARTITIONS-DAG:   define hidden {{.*}}@mul_dispatch_0(
+// PARTITIONS-LABEL: PARTITION1
+// PARTITIONS:       define hidden {{.*}}@add_dispatch_0(
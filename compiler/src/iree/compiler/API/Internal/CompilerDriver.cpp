@@ -39,6 +39,7 @@
 #include <cstdio>
 #include <cstdlib>
 #include <limits>
+#include <optional>
 
 #include "iree/compiler/API/Internal/Diagnostics.h"
 #include "iree/compiler/ConstEval/Passes.h"
@@ -50,16 +51,20 @@
 #include "iree/compiler/Tools/init_passes.h"
 #include "iree/compiler/Tools/version.h"
 #include "iree/compiler/Utils/ModuleUtils.h"
+#include "iree/compiler/Utils/ToolUtils.h"
 #include "iree/compiler/Utils/TracingUtils.h"
 #include "iree/compiler/embedding_api.h"
 #include "iree/compiler/mlir_interop.h"
 #include "llvm/ADT/ScopeExit.h"
+#include "llvm/ADT/StringExtras.h"
 #include "llvm/Support/Allocator.h"
 #include "llvm/Support/Error.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/ManagedStatic.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/PrettyStackTrace.h"
+#include "llvm/Support/SHA256.h"
 #include "llvm/Support/SMLoc.h"
 #include "llvm/Support/Signals.h"
 #include "llvm/Support/SourceMgr.h"
@@ -209,6 +214,30 @@ struct Error {
   std::string message;
 };
 
+// Returns a string identifying the compiler build for keying caches of
+// compilation artifacts. Release builds are identified by their version and
+// revision. Development builds report at most a version that does not change
+// with the sources so the library hosting the compiler is identified by its
+// path, size, and modification time instead. Returns an empty string if the
+// build cannot be identified.
+static std::string getCompilerBuildId(StringRef revision) {
+  if (revision.contains(" @ ")) {
+    return revision.str();
+  }
+  std::string dylibPath = getCurrentDylibPath();
+  if (dylibPath.empty()) {
+    return {};
+  }
+  llvm::sys::fs::file_status status;
+  if (llvm::sys::fs::status(dylibPath, status)) {
+    return {};
+  }
+  return revision.str() + " @ " + dylibPath + ":" +
+         std::to_string(status.getSize()) + ":" +
+         std::to_string(
+             status.getLastModificationTime().time_since_epoch().count());
+}
+
 struct GlobalInit {
   GlobalInit();
   ~GlobalInit() { llvm::llvm_shutdown(); }
@@ -233,6 +262,14 @@ struct GlobalInit {
   // Stash the revision for the life of the instance.
   std::string revision = getIreeRevision();
 
+  // Identifies the compiler build when keying compilation caches. Empty if the
+  // build cannot be identified and caches must not be used.
+  std::string buildId = getCompilerBuildId(revision);
+
+  // Command-line arguments that may affect compilation results (excluding
+  // argv[0], inputs, and output/dump paths) when usesCommandLine is set.
+  std::vector<std::string> commandLineArguments;
+
   // Our session options can optionally be bound to the global command-line
   // environment. If that is not the case, then these will be nullptr, and
   // they should be default initialized at the session level.
@@ -313,6 +350,98 @@ void GlobalInit::initializeContext(MLIRContext &context) {
   }
 }
 
+// Returns true if the option |name| is an output, dump, or cache path that
+// cannot change compilation results.
+static bool isPathOption(StringRef name) {
+  return name == "o" || name == "output-file" ||
+         name.starts_with("iree-hal-dump-") ||
+         name == "iree-hal-executable-cache-dir" ||
+         name == "iree-opt-const-eval-cache-dir" ||
+         name == "dump-compilation-phases-to";
+}
+
+// Returns true if the option |name| names files read during compilation.
+// These are keyed by the contents of the files instead of their paths.
+static bool isInputFileOption(StringRef name) {
+  return name == "iree-codegen-tuning-spec-path" ||
+         name == "iree-codegen-transform-dialect-library" ||
+         name == "iree-codegen-debug-patched-func-ops-file-name" ||
+         name == "iree-llvmcpu-tile-size-profile" ||
+         name == "iree-link-bitcode";
+}
+
+// Returns the key of the files named by the |value| of the input file option
+// |name| or std::nullopt if any of them cannot be read.
+static std::optional<std::string> getInputFilesKey(StringRef name,
+                                                   StringRef value) {
+  SmallVector<StringRef> entries;
+  if (name == "iree-link-bitcode") {
+    value.split(entries, ',', /*MaxSplit=*/-1, /*KeepEmpty=*/false);
+  } else if (!value.empty()) {
+    entries.push_back(value);
+  }
+  llvm::SHA256 hasher;
+  for (StringRef entry : entries) {
+    // Keep any `arch=` prefix or `@sequence` suffix in the key and only
+    // replace the path itself with its contents.
+    StringRef path = entry;
+    if (name == "iree-link-bitcode" && entry.contains('=')) {
+      auto [arch, archPath] = entry.split('=');
+      hasher.update(arch);
+      path = archPath;
+    } else if (name == "iree-codegen-transform-dialect-library") {
+      auto [libraryPath, sequence] = entry.split('@');
+      hasher.update(sequence);
+      path = libraryPath;
+    }
+    auto file = llvm::MemoryBuffer::getFile(path);
+    if (!file) {
+      return std::nullopt;
+    }
+    hasher.update(StringRef("\0", 1));
+    hasher.update((*file)->getBuffer());
+  }
+  return llvm::toHex(hasher.final(), /*LowerCase=*/true);
+}
+
+// Returns the command-line arguments in |argv| that may change compilation
+// results. Positional arguments (input files) and path options are excluded
+// so that the same program compiled from a different location or to a
+// different output produces the same key. Option values passed as a separate
+// argument (`--flag value`) are kept or dropped along with their option and
+// joined with it as `--flag=value`.
+static std::vector<std::string> getCacheKeyArguments(int argc,
+                                                     const char **argv) {
+  auto &registeredOptions = llvm::cl::getRegisteredOptions();
+  std::vector<std::string> arguments;
+  for (int i = 1; i < argc; ++i) {
+    StringRef arg = argv[i];
+    if (arg == "--")
+      break; // only positional arguments follow
+    if (arg.size() < 2 || !arg.starts_with("-"))
+      continue; // positional
+    StringRef name = arg.ltrim('-').split('=').first;
+    bool hasSeparateValue = false;
+    if (!arg.contains('=') && i + 1 < argc) {
+      auto it = registeredOptions.find(name);
+      hasSeparateValue =
+          it != registeredOptions.end() &&
+          it->second->getValueExpectedFlag() == llvm::cl::ValueRequired;
+    }
+    if (isPathOption(name)) {
+      if (hasSeparateValue)
+        ++i;
+      continue;
+    }
+    if (hasSeparateValue) {
+      arguments.push_back((arg + "=" + argv[++i]).str());
+    } else {
+      arguments.push_back(arg.str());
+    }
+  }
+  return arguments;
+}
+
 struct Session {
   Session(GlobalInit &globalInit);
 
@@ -333,6 +462,61 @@ struct Session {
     return nullptr;
   }
 
+  // Returns a key capturing the compiler build, every flag that may change
+  // compilation results, and the contents of files named by flags. Used to
+  // key caches of compilation artifacts shared across compiler invocations.
+  // Returns std::nullopt if the build or any input file cannot be identified
+  // and caches must not be used.
+  std::optional<std::string> getCompilationCacheKey() {
+    if (globalInit.buildId.empty()) {
+      return std::nullopt;
+    }
+    std::string key = globalInit.buildId;
+    auto appendArgument = [&](StringRef arg) {
+      auto [name, value] = arg.ltrim('-').split('=');
+      if (isPathOption(name)) {
+        return true;
+      }
+      key.push_back('\n');
+      if (!isInputFileOption(name)) {
+        key.append(arg);
+        return true;
+      }
+      std::optional<std::string> filesKey = getInputFilesKey(name, value);
+      if (!filesKey) {
+        return false;
+      }
+      key.append(name);
+      key.push_back('=');
+      key.append(*filesKey);
+      return true;
+    };
+    for (auto &arg : globalInit.commandLineArguments) {
+      if (!appendArgument(arg)) {
+        return std::nullopt;
+      }
+    }
+    for (auto &arg : binder.printArguments(/*nonDefaultOnly=*/true)) {
+      if (!appendArgument(arg)) {
+        return std::nullopt;
+      }
+    }
+    return key;
+  }
+
+  // Returns the HAL target options for a pipeline invocation.
+  IREE::HAL::TargetOptions getHALTargetOptions() {
+    IREE::HAL::TargetOptions options = halTargetOptions;
+    if (!options.executableCachePath.empty()) {
+      if (auto key = getCompilationCacheKey()) {
+        options.executableCacheKey = *key + "\n" + options.executableCacheKey;
+      } else {
+        options.executableCachePath.clear();
+      }
+    }
+    return options;
+  }
+
   void getFlags(bool nonDefaultOnly,
                 void (*onFlag)(const char *flag, size_t length, void *),
                 void *userData) {
@@ -744,10 +928,20 @@ Invocation::Invocation(Session &session) : session(session) {
   // Since the jitter invokes much of the top-level compiler recursively,
   // it must be injected at the top-level here vs in the pass pipeline
   // (or else the circular dependency cannot be resolved).
-  auto &targetRegistry = session.targetRegistry;
   pipelineHooks.buildConstEvalPassPipelineCallback =
-      [&targetRegistry](OpPassManager &pm) {
-        pm.addPass(ConstEval::createJitGlobalsPass({&targetRegistry}));
+      [&session](OpPassManager &pm) {
+        ConstEval::JitGlobalsPassOptions options;
+        options.targetRegistry = &session.targetRegistry;
+        options.cachePath =
+            session.highLevelOptimizationOptions.constEvalCachePath;
+        if (!options.cachePath.empty()) {
+          if (auto key = session.getCompilationCacheKey()) {
+            options.cacheKey = *key;
+          } else {
+            options.cachePath.clear();
+          }
+        }
+        pm.addPass(ConstEval::createJitGlobalsPass(options));
       };
 
   // Dump compilation phase results if the option is set.
@@ -953,6 +1147,7 @@ void Invocation::dumpCompilationPhase(IREEVMPipelinePhase phase,
 
 bool Invocation::runPipeline(enum iree_compiler_pipeline_t pipeline) {
   auto passManager = createPassManager();
+  auto halTargetOptions = session.getHALTargetOptions();
 
   if (!session.globalInit.usesCommandLine) {
     session.binder.applyOptimizationDefaults();
@@ -989,8 +1184,8 @@ bool Invocation::runPipeline(enum iree_compiler_pipeline_t pipeline) {
         session.targetRegistry, session.bindingOptions, session.inputOptions,
         session.preprocessingOptions, session.highLevelOptimizationOptions,
         session.dispatchCreationOptions, session.schedulingOptions,
-        session.halTargetOptions, session.vmTargetOptions, pipelineHooks,
-        *passManager, compileFrom, compileTo);
+        halTargetOptions, session.vmTargetOptions, pipelineHooks, *passManager,
+        compileFrom, compileTo);
     break;
   }
   case IREE_COMPILER_PIPELINE_HAL_EXECUTABLE: {
@@ -1008,8 +1203,7 @@ bool Invocation::runPipeline(enum iree_compiler_pipeline_t pipeline) {
       return false;
     }
     IREE::HAL::buildHALTransformPassPipeline(
-        *passManager, session.targetRegistry, session.halTargetOptions,
-        pipelineHooks);
+        *passManager, session.targetRegistry, halTargetOptions, pipelineHooks);
     break;
   }
   case IREE_COMPILER_PIPELINE_PRECOMPILE: {
@@ -1022,8 +1216,7 @@ bool Invocation::runPipeline(enum iree_compiler_pipeline_t pipeline) {
         session.targetRegistry, session.bindingOptions, session.inputOptions,
         session.preprocessingOptions, session.highLevelOptimizationOptions,
         session.dispatchCreationOptions, session.schedulingOptions,
-        session.halTargetOptions, pipelineHooks, *passManager, compileFrom,
-        compileTo);
+        halTargetOptions, pipelineHooks, *passManager, compileFrom, compileTo);
     break;
   }
   default:
@@ -1312,6 +1505,9 @@ void ireeCompilerSetupGlobalCL(int argc, const char **argv, const char *banner,
   }
 
   llvm::cl::ParseCommandLineOptions(argc, argv, banner);
+
+  // Retain the arguments so that compilation caches can be keyed on them.
+  globalInit->commandLineArguments = getCacheKeyArguments(argc, argv);
 }
 
 void ireeCompilerGlobalInitialize() {
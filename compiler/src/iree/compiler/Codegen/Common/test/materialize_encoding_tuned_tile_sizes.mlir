@@ -0,0 +1,91 @@
+// RUN: echo "# operation M0 K0 N0 max_rows cpu model" > %t
+// RUN: echo "f32f32f32 4 1 8 0 Test CPU  Model" >> %t
+// RUN: echo "f32f32f32 2 1 8 4 Test CPU  Model" >> %t
+// RUN: echo "f32f32f32 8 1 32 0 Other CPU" >> %t
+// RUN: iree-opt --pass-pipeline="builtin.module(func.func(iree-codegen-materialize-device-encoding))" --split-input-file \
+// RUN:   --iree-llvmcpu-tuned-tile-sizes=%t --iree-llvmcpu-tuned-tile-sizes-cpu-model="Test CPU  Model" %s | FileCheck %s --check-prefix=TUNED
+// RUN: iree-opt --pass-pipeline="builtin.module(func.func(iree-codegen-materialize-device-encoding))" --split-input-file \
+// RUN:   --iree-llvmcpu-tuned-tile-sizes=%t --iree-llvmcpu-tuned-tile-sizes-cpu-model="Unknown CPU" %s | FileCheck %s --check-prefix=DEFAULT
+
+#map = affine_map<(d0, d1, d2) -> (d0, d2)>
+#map1 = affine_map<(d0, d1, d2) -> (d2, d1)>
+#map2 = affine_map<(d0, d1, d2) -> (d0, d1)>
+#encoding = #iree_encoding.encoding<operand_index = 0 : i64, op_type = matmul, element_types = [f32, f32, f32], user_indexing_maps = [#map, #map1, #map2], iteration_sizes = [?, ?, ?]>
+#executable_target = #hal.executable.target<"llvm-cpu", "xyz", {cpu_features = "+avx512f", iree.encoding.resolver = #iree_cpu.cpu_encoding_resolver<>, target_triple = "x86_64-xyz-xyz"}>
+func.func @set_encoding_f32_lhs(%arg0: tensor<64x64xf32>)
+    -> tensor<64x64xf32, #encoding> attributes { hal.executable.target = #executable_target } {
+  %0 = iree_encoding.set_encoding %arg0 : tensor<64x64xf32> -> tensor<64x64xf32, #encoding>
+  return %0 : tensor<64x64xf32, #encoding>
+}
+// The general tuned tile replaces the built-in 16x16x1 avx512f tile.
+// TUNED-LABEL: func.func @set_encoding_f32_lhs
+// TUNED:         linalg.pack
+// TUNED-SAME:      inner_dims_pos = [0, 1]
+// TUNED-SAME:      inner_tiles = [4, 1]
+// TUNED-SAME:      tensor<64x64xf32> -> tensor<16x64x4x1xf32>
+// DEFAULT-LABEL: func.func @set_encoding_f32_lhs
+// DEFAULT:         linalg.pack
+// DEFAULT-SAME:      inner_dims_pos = [0, 1]
+// DEFAULT-SAME:      inner_tiles = [16, 1]
+// DEFAULT-SAME:      tensor<64x64xf32> -> tensor<4x64x16x1xf32>
+
+// -----
+
+#map = affine_map<(d0, d1, d2) -> (d0, d2)>
+#map1 = affine_map<(d0, d1, d2) -> (d2, d1)>
+#map2 = affine_map<(d0, d1, d2) -> (d0, d1)>
+#encoding = #iree_encoding.encoding<operand_index = 1 : i64, op_type = matmul, element_types = [f32, f32, f32], user_indexing_maps = [#map, #map1, #map2], iteration_sizes = [?, ?, ?]>
+#executable_target = #hal.executable.target<"llvm-cpu", "xyz", {cpu_features = "+avx512f", iree.encoding.resolver = #iree_cpu.cpu_encoding_resolver<>, target_triple = "x86_64-xyz-xyz"}>
+func.func @set_encoding_f32_rhs(%arg0: tensor<64x64xf32>)
+    -> tensor<64x64xf32, #encoding> attributes { hal.executable.target = #executable_target } {
+  %0 = iree_encoding.set_encoding %arg0 : tensor<64x64xf32> -> tensor<64x64xf32, #encoding>
+  return %0 : tensor<64x64xf32, #encoding>
+}
+// TUNED-LABEL: func.func @set_encoding_f32_rhs
+// TUNED:         linalg.pack
+// TUNED-SAME:      outer_dims_perm = [1, 0]
+// TUNED-SAME:      inner_dims_pos = [1, 0]
+// TUNED-SAME:      inner_tiles = [8, 1]
+// TUNED-SAME:      tensor<64x64xf32> -> tensor<8x64x8x1xf32>
+// DEFAULT-LABEL: func.func @set_encoding_f32_rhs
+// DEFAULT:         linalg.pack
+// DEFAULT-SAME:      inner_tiles = [16, 1]
+
+// -----
+
+#map = affine_map<(d0, d1, d2) -> (d0, d2)>
+#map1 = affine_map<(d0, d1, d2) -> (d2, d1)>
+#map2 = affine_map<(d0, d1, d2) -> (d0, d1)>
+#encoding = #iree_encoding.encoding<operand_index = 0 : i64, op_type = matmul, element_types = [f32, f32, f32], user_indexing_maps = [#map, #map1, #map2], iteration_sizes = [3, ?, ?]>
+#executable_target = #hal.executable.target<"llvm-cpu", "xyz", {cpu_features = "+avx512f", iree.encoding.resolver = #iree_cpu.cpu_encoding_resolver<>, target_triple = "x86_64-xyz-xyz"}>
+func.func @set_encoding_f32_skinny_lhs(%arg0: tensor<3x64xf32>)
+    -> tensor<3x64xf32, #encoding> attributes { hal.executable.target = #executable_target } {
+  %0 = iree_encoding.set_encoding %arg0 : tensor<3x64xf32> -> tensor<3x64xf32, #encoding>
+  return %0 : tensor<3x64xf32, #encoding>
+}
+// Matmuls with at most max_rows LHS rows use the skinny tuned tile.
+// TUNED-LABEL: func.func @set_encoding_f32_skinny_lhs
+// TUNED:         linalg.pack
+// TUNED-SAME:      inner_dims_pos = [0, 1]
+// TUNED-SAME:      inner_tiles = [2, 1]
+// TUNED-SAME:      tensor<3x64xf32> -> tensor<2x64x2x1xf32>
+// DEFAULT-LABEL: func.func @set_encoding_f32_skinny_lhs
+// DEFAULT:         linalg.pack
+// DEFAULT-SAME:      inner_tiles = [4, 1]
+
+// -----
+
+#map = affine_map<(d0, d1, d2) -> (d0, d2)>
+#map1 = affine_map<(d0, d1, d2) -> (d2, d1)>
+#map2 = affine_map<(d0, d1, d2) -> (d0, d1)>
+#encoding = #iree_encoding.encoding<operand_index = 0 : i64, op_type = matmul, element_types = [i8, i8, i32], user_indexing_maps = [#map, #map1, #map2], iteration_sizes = [?, ?, ?]>
+#executable_target = #hal.executable.target<"llvm-cpu", "xyz", {cpu_features = "+avx512f,+avx512bw", iree.encoding.resolver = #iree_cpu.cpu_encoding_resolver<>, target_triple = "x86_64-xyz-xyz"}>
+func.func @set_encoding_i8_lhs_untuned(%arg0: tensor<64x64xi8>)
+    -> tensor<64x64xi8, #encoding> attributes { hal.executable.target = #executable_target } {
+  %0 = iree_encoding.set_encoding %arg0 : tensor<64x64xi8> -> tensor<64x64xi8, #encoding>
+  return %0 : tensor<64x64xi8, #encoding>
+}
+// Operations without tuned entries keep the built-in tiles.
+// TUNED-LABEL: func.func @set_encoding_i8_lhs_untuned
+// TUNED:         linalg.pack
+// TUNED-SAME:      inner_tiles = [16, 2]
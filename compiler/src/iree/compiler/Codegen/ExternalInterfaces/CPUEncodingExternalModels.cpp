@@ -37,6 +37,8 @@
 
 #include "iree/compiler/Codegen/ExternalInterfaces/CPUEncodingExternalModels.h"
 
+#include <mutex>
+
 #include "iree/compiler/Codegen/Dialect/CPU/IR/IREECPUTypes.h"
 #include "iree/compiler/Codegen/Dialect/Codegen/IR/IREECodegenTypes.h"
 #include "iree/compiler/Codegen/Dialect/Codegen/Utils/Utils.h"
@@ -46,12 +48,34 @@
 #include "iree/compiler/Dialect/Encoding/IR/EncodingOps.h"
 #include "iree/compiler/Dialect/Encoding/IR/EncodingTypes.h"
 #include "iree/compiler/Dialect/Encoding/Utils/Utils.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/DebugLog.h"
 #include "llvm/Support/InterleavedRange.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "mlir/IR/BuiltinAttributes.h"
+#include "mlir/IR/Diagnostics.h"
 
 #define DEBUG_TYPE "iree-codegen-materialize-encoding"
 
+static llvm::cl::opt<std::string> clTunedTileSizes(
+    "iree-llvmcpu-tuned-tile-sizes",
+    llvm::cl::desc(
+        "Path to a table of matmul tile sizes tuned per CPU model, in the "
+        "format written by the runtime --vmvx_tune_tile_sizes flag. Entries "
+        "for the CPU model given by --iree-llvmcpu-tuned-tile-sizes-cpu-model "
+        "replace the built-in data-tiling tile sizes of matching matmuls."),
+    llvm::cl::init(""));
+
+static llvm::cl::opt<std::string> clTunedTileSizesCpuModel(
+    "iree-llvmcpu-tuned-tile-sizes-cpu-model",
+    llvm::cl::desc(
+        "CPU model of the deployment machine as reported by the runtime (the "
+        "`model name` in /proc/cpuinfo on x86 and RISC-V Linux) selecting the "
+        "entries of --iree-llvmcpu-tuned-tile-sizes to use."),
+    llvm::cl::init(""));
+
 namespace mlir::iree_compiler::IREE::CPU {
 
 using IREE::Codegen::MaterializeEncodingInfo;
@@ -638,9 +662,148 @@ static SmallVector<TileMxNxK> enumerateMatmulTileX86_64(TypeRange elementTypes,
   return {};
 }
 
+// Matmul tile tuned for a CPU model. Mirrors iree_vmvx_tile_sizes_entry_t in
+// runtime/src/iree/modules/vmvx/tile_sizes.h.
+struct TunedMatmulTile {
+  // If non-zero the tile only applies to matmuls with at most this many LHS
+  // rows.
+  int64_t maxRows = 0;
+  TileMxNxK tile;
+};
+
+// Tuned tiles keyed by matmul operation name such as `f32f32f32`.
+using TunedMatmulTileTable = llvm::StringMap<SmallVector<TunedMatmulTile>>;
+
+// Parses the entries for `cpuModel` from the textual tile size table `buffer`.
+// Each line is `<operation> <M0> <K0> <N0> <max_rows> <cpu model>` with the
+// CPU model taking the remainder of the line. Entries for other CPU models are
+// ignored.
+static FailureOr<TunedMatmulTileTable>
+parseTunedMatmulTiles(StringRef buffer, StringRef cpuModel, Location loc) {
+  TunedMatmulTileTable table;
+  SmallVector<StringRef> lines;
+  buffer.split(lines, '\n');
+  for (auto [index, line] : llvm::enumerate(lines)) {
+    line = line.trim();
+    if (line.empty() || line.starts_with("#")) {
+      continue;
+    }
+    StringRef fields[5];
+    StringRef remainder = line;
+    for (StringRef &field : fields) {
+      std::tie(field, remainder) = llvm::getToken(remainder);
+    }
+    remainder = remainder.trim();
+    TunedMatmulTile entry;
+    if (fields[0].empty() || remainder.empty() ||
+        !llvm::to_integer(fields[1], entry.tile.M) || entry.tile.M <= 0 ||
+        !llvm::to_integer(fields[2], entry.tile.K) || entry.tile.K <= 0 ||
+        !llvm::to_integer(fields[3], entry.tile.N) || entry.tile.N <= 0 ||
+        !llvm::to_integer(fields[4], entry.maxRows) || entry.maxRows < 0) {
+      return emitError(loc) << "invalid tuned tile size entry on line "
+                            << (index + 1) << ": '" << line
+                            << "'; expected `<operation> <M0> <K0> <N0> "
+                               "<max_rows> <cpu model>`";
+    }
+    if (remainder != cpuModel) {
+      continue;
+    }
+    table[fields[0]].push_back(entry);
+  }
+  return table;
+}
+
+// Returns the tuned tile table selected by the command line flags or nullptr
+// if none is specified. The table is loaded once per process and a table that
+// fails to load is reported once and treated as empty.
+static const TunedMatmulTileTable *loadTunedMatmulTiles(MLIRContext *context) {
+  if (clTunedTileSizes.empty()) {
+    return nullptr;
+  }
+  static std::mutex tableMutex;
+  static std::optional<TunedMatmulTileTable> table;
+  std::lock_guard<std::mutex> lock(tableMutex);
+  if (table) {
+    return &table.value();
+  }
+  table.emplace();
+  Location loc = UnknownLoc::get(context);
+  auto fileOrErr =
+      llvm::MemoryBuffer::getFile(clTunedTileSizes, /*IsText=*/true);
+  if (std::error_code error = fileOrErr.getError()) {
+    emitError(loc) << "failed to open tuned tile sizes '" << clTunedTileSizes
+                   << "': " << error.message();
+    return &table.value();
+  }
+  FailureOr<TunedMatmulTileTable> parsedTable = parseTunedMatmulTiles(
+      fileOrErr.get()->getBuffer(), StringRef(clTunedTileSizesCpuModel).trim(),
+      loc);
+  if (succeeded(parsedTable)) {
+    table = std::move(parsedTable.value());
+  }
+  return &table.value();
+}
+
+// Returns the tiles tuned for the matmul `encoding` or an empty list if there
+// are none. A row-limited (skinny) tile covering the narrow dimension is used
+// as-is; otherwise the general tile is returned along with its truncations so
+// that chooseMatmulTile can still avoid padding narrow matmuls. Like the
+// enumerated tiles these only cover narrow M and rely on chooseMatmulTile to
+// transpose narrow-N cases.
+static SmallVector<TileMxNxK>
+getTunedMatmulTiles(IREE::Encoding::EncodingAttr encoding,
+                    IREE::Encoding::MatmulNarrowDim narrowDim) {
+  const TunedMatmulTileTable *table =
+      loadTunedMatmulTiles(encoding.getContext());
+  if (!table) {
+    return {};
+  }
+  std::string operation;
+  llvm::raw_string_ostream os(operation);
+  for (Type elementType : encoding.getElementTypesArray()) {
+    os << elementType;
+  }
+  auto it = table->find(operation);
+  if (it == table->end()) {
+    return {};
+  }
+  std::optional<TunedMatmulTile> generalTile;
+  std::optional<TunedMatmulTile> skinnyTile;
+  for (const TunedMatmulTile &entry : it->second) {
+    if (!entry.maxRows) {
+      generalTile = entry;
+    } else if (narrowDim && narrowDim.size <= entry.maxRows &&
+               (!skinnyTile || entry.maxRows < skinnyTile->maxRows)) {
+      skinnyTile = entry;
+    }
+  }
+  if (skinnyTile) {
+    LDBG() << "using tuned skinny tile for " << operation;
+    return {skinnyTile->tile};
+  }
+  if (!generalTile) {
+    return {};
+  }
+  LDBG() << "using tuned tile for " << operation;
+  SmallVector<TileMxNxK> tiles;
+  for (int64_t m = generalTile->tile.M; m > 0; m /= 2) {
+    tiles.push_back(TileMxNxK{m, generalTile->tile.N, generalTile->tile.K});
+  }
+  return tiles;
+}
+
 static SmallVector<TileMxNxK>
 enumerateCPUMatmulTiles(IREE::Encoding::EncodingAttr encoding,
                         DictionaryAttr config) {
+  // Tuned tiles are fixed-size and take precedence over the built-in ones
+  // unless scalable tiles are in use.
+  if (!isAArch64(config) || !isScalableVectorizationEnabled()) {
+    SmallVector<TileMxNxK> tunedTiles = getTunedMatmulTiles(
+        encoding, IREE::Encoding::getPo2MatmulNarrowDim(encoding));
+    if (!tunedTiles.empty()) {
+      return tunedTiles;
+    }
+  }
   // Enumerate available tile shapes for the given encoding and config.
   SmallVector<Type> elementTypes = encoding.getElementTypesArray();
   if (isAArch64(config)) {
@@ -12,6 +12,7 @@
 #include "iree/compiler/Codegen/Dialect/Codegen/IR/IREECodegenInterfaces.h"
 #include "iree/compiler/Codegen/Interfaces/PartitionableLoopsInterface.h"
 #include "iree/compiler/Codegen/LLVMCPU/TargetMLTransformInfo.h"
+#include "iree/compiler/Codegen/LLVMCPU/TileSizeProfile.h"
 #include "iree/compiler/Codegen/LLVMCPU/Utils.h"
 #include "iree/compiler/Codegen/Utils/CPUUtils.h"
 #include "iree/compiler/Codegen/Utils/LinalgOpInfo.h"
@@ -109,6 +110,23 @@ static llvm::cl::opt<bool> clEnableRiscvAggressiveDist(
         "set distConfig.maxTileSizes[i] to 2 * distConfig.minTileSizes[i]."),
     llvm::cl::init(false));
 
+static llvm::cl::opt<std::string> clTileSizeProfile(
+    "iree-llvmcpu-tile-size-profile",
+    llvm::cl::desc(
+        "Path to a profile of dispatch timings measured with each tile size "
+        "candidate (see --iree-llvmcpu-tile-size-candidate). Dispatches in the "
+        "profile use the candidate with the lowest mean time."),
+    llvm::cl::init(""));
+
+static llvm::cl::opt<unsigned> clTileSizeCandidate(
+    "iree-llvmcpu-tile-size-candidate",
+    llvm::cl::desc(
+        "Tile size candidate used for dispatches not in the tile size profile. "
+        "0 uses the default heuristics; other candidates scale the "
+        "distribution tile sizes and are used to compile variants of a "
+        "program when collecting a profile."),
+    llvm::cl::init(0));
+
 using IREE::Codegen::DispatchLoweringPassPipeline;
 using IREE::CPU::TilingLevel;
 
@@ -3232,6 +3250,125 @@ lowerUsingDefaultPipeline(mlir::FunctionOpInterface entryPointFn) {
   return setTranslationInfo(entryPointFn, translationInfo);
 }
 
+/// Returns the tile size candidate to use for |entryPointFn| from the tile size
+/// profile or the candidate flag.
+static FailureOr<unsigned>
+getTileSizeCandidate(mlir::FunctionOpInterface entryPointFn) {
+  if (!clTileSizeProfile.empty()) {
+    auto profile =
+        TileSizeProfile::load(clTileSizeProfile, entryPointFn.getLoc());
+    if (failed(profile)) {
+      return failure();
+    }
+    if (std::optional<unsigned> candidate =
+            (*profile)->getBestCandidate(entryPointFn.getName())) {
+      return *candidate;
+    }
+  }
+  if (clTileSizeCandidate >= kTileSizeCandidateCount) {
+    return entryPointFn.emitOpError("tile size candidate ")
+           << clTileSizeCandidate << " out of range; expected < "
+           << kTileSizeCandidateCount;
+  }
+  return clTileSizeCandidate.getValue();
+}
+
+/// Scales the distribution tile sizes of the root op based on the tile size
+/// candidate selected for |entryPointFn|. Dimensions where the scaled tile
+/// sizes would not be evenly tiled by the inner tiling levels (or have no
+/// effect) keep their original tile sizes.
+static LogicalResult
+applyTileSizeCandidate(mlir::FunctionOpInterface entryPointFn,
+                       Operation *rootOperation) {
+  FailureOr<unsigned> candidate = getTileSizeCandidate(entryPointFn);
+  if (failed(candidate)) {
+    return failure();
+  }
+  if (*candidate == 0) {
+    return success();
+  }
+  auto rootLoweringConfig =
+      getLoweringConfig<IREE::CPU::LoweringConfigAttr>(rootOperation);
+  if (!rootLoweringConfig || !rootLoweringConfig.hasWorkgroupTilingLevel()) {
+    return success();
+  }
+  auto [numerator, denominator] = kTileSizeCandidateScales[*candidate];
+
+  SmallVector<int64_t> staticLoopRanges;
+  if (auto linalgOp = dyn_cast<linalg::LinalgOp>(rootOperation)) {
+    staticLoopRanges = linalgOp.getStaticLoopRanges();
+  }
+
+  SmallVector<IREE::CPU::LoweringConfigLevelInfo> tilingInfo =
+      rootLoweringConfig.getAvailableTilingInfo();
+  IREE::CPU::LoweringConfigLevelInfo *distInfo = nullptr;
+  IREE::CPU::LoweringConfigLevelInfo *cacheInfo = nullptr;
+  for (IREE::CPU::LoweringConfigLevelInfo &info : tilingInfo) {
+    if (info.level == IREE::CPU::DistributionTiles) {
+      distInfo = &info;
+    } else if (info.level == IREE::CPU::CacheParallelTiles) {
+      cacheInfo = &info;
+    }
+  }
+  if (!distInfo) {
+    return success();
+  }
+
+  bool changed = false;
+  for (size_t dim = 0; dim < distInfo->sizes.size(); ++dim) {
+    int64_t tileSize = distInfo->sizes[dim];
+    if (tileSize == 0 || (tileSize * numerator) % denominator != 0) {
+      continue;
+    }
+    int64_t newTileSize = tileSize * numerator / denominator;
+    if (numerator > denominator && dim < staticLoopRanges.size() &&
+        !ShapedType::isDynamic(staticLoopRanges[dim]) &&
+        tileSize >= staticLoopRanges[dim]) {
+      continue;
+    }
+    // Cache tiles matching the distribution tiles are scaled along with them.
+    bool scaleCacheTiles = cacheInfo && dim < cacheInfo->sizes.size() &&
+                           cacheInfo->sizes[dim] == tileSize;
+    bool isLegal = true;
+    for (IREE::CPU::LoweringConfigLevelInfo &info : tilingInfo) {
+      if (&info == distInfo || dim >= info.sizes.size() ||
+          (&info == cacheInfo && scaleCacheTiles)) {
+        continue;
+      }
+      int64_t innerTileSize = info.sizes[dim];
+      bool isScalable =
+          dim < info.scalableFlags.size() && info.scalableFlags[dim];
+      if (innerTileSize == 0) {
+        continue;
+      }
+      if (isScalable || newTileSize < innerTileSize ||
+          (tileSize % innerTileSize == 0 &&
+           newTileSize % innerTileSize != 0)) {
+        isLegal = false;
+        break;
+      }
+    }
+    if (!isLegal) {
+      continue;
+    }
+    distInfo->sizes[dim] = newTileSize;
+    if (scaleCacheTiles) {
+      cacheInfo->sizes[dim] = newTileSize;
+    }
+    changed = true;
+  }
+  if (!changed) {
+    return success();
+  }
+
+  IREE::Codegen::LoweringConfigAttrInterface config =
+      getNewLoweringConfig(rootOperation->getContext(), tilingInfo,
+                           /*setDistributionConfig=*/true);
+  LDBG() << "Tile size candidate " << *candidate << ": " << config;
+  setLoweringConfig(rootOperation, config);
+  return success();
+}
+
 /// Sets the translation information to use for a dispatch region.
 static LogicalResult
 setTranslationInfoAndRootConfig(mlir::FunctionOpInterface entryPointFn,
@@ -3266,6 +3403,10 @@ setTranslationInfoAndRootConfig(mlir::FunctionOpInterface entryPointFn,
   // Ignore the tile sizes adjustment.
   auto pipeline = getTranslationInfo(entryPointFn).getPassPipeline().getValue();
   if (pipeline != DispatchLoweringPassPipeline::TransformDialectCodegen) {
+    if (failed(applyTileSizeCandidate(entryPointFn, rootOperation))) {
+      return failure();
+    }
+
     if (failed(adjustTileSizesForUnPackOp(entryPointFn, rootOperation))) {
       return failure();
     }
@@ -0,0 +1,95 @@
+// Copyright 2025 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/compiler/Codegen/LLVMCPU/TileSizeProfile.h"
+
+#include <mutex>
+
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "mlir/IR/Diagnostics.h"
+
+namespace mlir::iree_compiler {
+
+// static
+FailureOr<std::shared_ptr<const TileSizeProfile>>
+TileSizeProfile::load(StringRef path, Location loc) {
+  static std::mutex cacheMutex;
+  static llvm::StringMap<std::shared_ptr<const TileSizeProfile>> cache;
+  std::lock_guard<std::mutex> lock(cacheMutex);
+  auto it = cache.find(path);
+  if (it != cache.end()) {
+    return it->second;
+  }
+
+  auto fileOrErr = llvm::MemoryBuffer::getFile(path, /*IsText=*/true);
+  if (std::error_code error = fileOrErr.getError()) {
+    return emitError(loc) << "failed to open tile size profile '" << path
+                          << "': " << error.message();
+  }
+  auto profile = parse(fileOrErr.get()->getBuffer(), loc);
+  if (failed(profile)) {
+    return failure();
+  }
+  cache[path] = *profile;
+  return profile;
+}
+
+// static
+FailureOr<std::shared_ptr<const TileSizeProfile>>
+TileSizeProfile::parse(StringRef buffer, Location loc) {
+  auto profile = std::make_shared<TileSizeProfile>();
+  SmallVector<StringRef> lines;
+  buffer.split(lines, '\n');
+  for (auto [index, line] : llvm::enumerate(lines)) {
+    line = line.trim();
+    if (line.empty() || line.starts_with("#")) {
+      continue;
+    }
+    SmallVector<StringRef> fields;
+    line.split(fields, ' ', /*MaxSplit=*/-1, /*KeepEmpty=*/false);
+    unsigned candidate = 0;
+    double timeNs = 0.0;
+    if (fields.size() != 3 || !llvm::to_integer(fields[1], candidate) ||
+        candidate >= kTileSizeCandidateCount ||
+        !llvm::to_float(fields[2], timeNs) || timeNs < 0.0) {
+      return emitError(loc) << "invalid tile size profile entry on line "
+                            << (index + 1) << ": '" << line
+                            << "'; expected `<dispatch name> <candidate (0-"
+                            << (kTileSizeCandidateCount - 1)
+                            << ")> <nanoseconds>`";
+    }
+    auto &timings = profile->dispatches[fields[0]];
+    timings.totalNs[candidate] += timeNs;
+    ++timings.count[candidate];
+  }
+  return std::shared_ptr<const TileSizeProfile>(std::move(profile));
+}
+
+std::optional<unsigned>
+TileSizeProfile::getBestCandidate(StringRef dispatchName) const {
+  auto it = dispatches.find(dispatchName);
+  if (it == dispatches.end()) {
+    return std::nullopt;
+  }
+  const CandidateTimings &timings = it->second;
+  std::optional<unsigned> bestCandidate;
+  double bestMeanNs = 0.0;
+  for (unsigned candidate = 0; candidate < kTileSizeCandidateCount;
+       ++candidate) {
+    if (!timings.count[candidate]) {
+      continue;
+    }
+    double meanNs = timings.totalNs[candidate] / timings.count[candidate];
+    if (!bestCandidate || meanNs < bestMeanNs) {
+      bestCandidate = candidate;
+      bestMeanNs = meanNs;
+    }
+  }
+  return bestCandidate;
+}
+
+} // namespace mlir::iree_compiler
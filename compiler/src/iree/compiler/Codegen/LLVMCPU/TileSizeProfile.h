@@ -0,0 +1,69 @@
+// Copyright 2025 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_COMPILER_CODEGEN_LLVMCPU_TILESIZEPROFILE_H_
+#define IREE_COMPILER_CODEGEN_LLVMCPU_TILESIZEPROFILE_H_
+
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <utility>
+
+#include "llvm/ADT/StringMap.h"
+#include "mlir/IR/Location.h"
+#include "mlir/Support/LLVM.h"
+#include "mlir/Support/LogicalResult.h"
+
+namespace mlir::iree_compiler {
+
+// Tile size candidates are variations of the lowering config chosen by the
+// default heuristics (candidate 0) that scale the distribution tile sizes of
+// the root op by kTileSizeCandidateScales[candidate] as a numerator and
+// denominator. Candidates that cannot be legally applied to a dimension leave
+// it unchanged.
+inline constexpr std::pair<int64_t, int64_t> kTileSizeCandidateScales[] = {
+    {1, 1},
+    {1, 2},
+    {2, 1},
+    {4, 1},
+};
+inline constexpr unsigned kTileSizeCandidateCount =
+    std::size(kTileSizeCandidateScales);
+
+// Timings of dispatches compiled with each candidate used to select the
+// fastest candidate per dispatch. Profiles are text files with one
+// measurement per line as produced by iree-benchmark-executable
+// --dispatch_profile_file=:
+//   <dispatch name> <candidate> <nanoseconds>
+// Blank lines and lines starting with `#` are ignored and repeated
+// measurements of the same candidate are averaged.
+class TileSizeProfile {
+public:
+  // Loads the profile at |path|. Profiles are cached for the lifetime of the
+  // process and shared by all threads. Emits an error at |loc| on failure.
+  static FailureOr<std::shared_ptr<const TileSizeProfile>>
+  load(StringRef path, Location loc);
+
+  // Parses a profile from |buffer| and emits errors at |loc|.
+  static FailureOr<std::shared_ptr<const TileSizeProfile>>
+  parse(StringRef buffer, Location loc);
+
+  // Returns the candidate with the lowest mean time for |dispatchName| or
+  // std::nullopt if the dispatch was not profiled.
+  std::optional<unsigned> getBestCandidate(StringRef dispatchName) const;
+
+private:
+  // Total time and measurement count per candidate.
+  struct CandidateTimings {
+    double totalNs[kTileSizeCandidateCount] = {0};
+    unsigned count[kTileSizeCandidateCount] = {0};
+  };
+  llvm::StringMap<CandidateTimings> dispatches;
+};
+
+} // namespace mlir::iree_compiler
+
+#endif // IREE_COMPILER_CODEGEN_LLVMCPU_TILESIZEPROFILE_H_
@@ -0,0 +1,49 @@
+// RUN: iree-opt --pass-pipeline='builtin.module(iree-llvmcpu-select-lowering-strategy)' --iree-llvmcpu-tile-size-candidate=1 %s | FileCheck %s --check-prefix=CANDIDATE
+// RUN: echo "# dispatch candidate nanoseconds" > %t
+// RUN: echo "dynamic_add 0 1000" >> %t
+// RUN: echo "dynamic_add 1 1200" >> %t
+// RUN: echo "dynamic_add 2 700" >> %t
+// RUN: echo "dynamic_add 2 900" >> %t
+// RUN: echo "dynamic_add 3 850" >> %t
+// RUN: iree-opt --pass-pipeline='builtin.module(iree-llvmcpu-select-lowering-strategy)' --iree-llvmcpu-tile-size-profile=%t --iree-llvmcpu-tile-size-candidate=1 %s | FileCheck %s --check-prefix=PROFILE
+
+#pipeline_layout = #hal.pipeline.layout<constants = 2, bindings = [
+  #hal.pipeline.binding<storage_buffer>,
+  #hal.pipeline.binding<storage_buffer>,
+  #hal.pipeline.binding<storage_buffer>
+]>
+#executable_target_embedded_elf_x86_64_ = #hal.executable.target<"llvm-cpu", "embedded-elf-x86_64", {data_layout = "e-m:e-p270:32:32-p271:32:32-p272:64:64-i64:64-f80:128-n8:16:32:64-S128", native_vector_size = 16 : index, target_triple = "x86_64-unknown-linux-gnu"}>
+#map = affine_map<(d0, d1) -> (d0, d1)>
+#map1 = affine_map<(d0, d1) -> (d1)>
+func.func @dynamic_add() attributes {hal.executable.target = #executable_target_embedded_elf_x86_64_} {
+  %c0 = arith.constant 0 : index
+  %0 = hal.interface.constant.load layout(#pipeline_layout) ordinal(0) : index
+  %1 = hal.interface.constant.load layout(#pipeline_layout) ordinal(1) : index
+  %2 = hal.interface.binding.subspan layout(#pipeline_layout) binding(0) : !iree_tensor_ext.dispatch.tensor<readonly:tensor<?x?xf32>>{%0, %1}
+  %3 = hal.interface.binding.subspan layout(#pipeline_layout) binding(1) : !iree_tensor_ext.dispatch.tensor<readonly:tensor<?xf32>>{%1}
+  %4 = hal.interface.binding.subspan layout(#pipeline_layout) binding(2) : !iree_tensor_ext.dispatch.tensor<writeonly:tensor<?x?xf32>>{%0, %1}
+  %5 = iree_tensor_ext.dispatch.tensor.load %2, offsets = [0, 0], sizes = [%0, %1], strides = [1, 1] : !iree_tensor_ext.dispatch.tensor<readonly:tensor<?x?xf32>>{%0, %1} -> tensor<?x?xf32>
+  %6 = iree_tensor_ext.dispatch.tensor.load %3, offsets = [0], sizes = [%1], strides = [1] : !iree_tensor_ext.dispatch.tensor<readonly:tensor<?xf32>>{%1} -> tensor<?xf32>
+  %7 = tensor.empty(%0, %1) : tensor<?x?xf32>
+  %8 = linalg.generic {indexing_maps = [#map, #map1, #map], iterator_types = ["parallel", "parallel"]} ins(%5, %6 : tensor<?x?xf32>, tensor<?xf32>) outs(%7 : tensor<?x?xf32>) {
+  ^bb0(%in: f32, %in_0: f32, %out: f32):
+    %9 = arith.addf %in, %in_0 : f32
+    linalg.yield %9 : f32
+  } -> tensor<?x?xf32>
+  iree_tensor_ext.dispatch.tensor.store %8, %4, offsets = [0, 0], sizes = [%0, %1], strides = [1, 1] : tensor<?x?xf32> -> !iree_tensor_ext.dispatch.tensor<writeonly:tensor<?x?xf32>>{%0, %1}
+  return
+}
+
+// Dispatches not in the profile use the candidate flag.
+//  CANDIDATE-DAG: #[[CONFIG:.+]] = #iree_cpu.lowering_config<distribution = [32, 32], vector_common_parallel = [1, 4]>
+//  CANDIDATE-DAG: #[[TRANSLATION:.+]] = #iree_codegen.translation_info<pipeline = CPUDoubleTilingExpert>
+//      CANDIDATE: func.func @dynamic_add()
+// CANDIDATE-SAME:     translation_info = #[[TRANSLATION]]
+//      CANDIDATE: linalg.generic
+// CANDIDATE-SAME:     lowering_config = #[[CONFIG]]
+
+// The profiled candidate with the lowest mean time (2) takes precedence.
+//  PROFILE-DAG: #[[CONFIG:.+]] = #iree_cpu.lowering_config<distribution = [128, 128], vector_common_parallel = [1, 4]>
+//      PROFILE: func.func @dynamic_add()
+//      PROFILE: linalg.generic
+// PROFILE-SAME:     lowering_config = #[[CONFIG]]
@@ -0,0 +1,221 @@
+// Copyright 2025 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/compiler/ConstEval/JitCache.h"
+
+#include "iree/compiler/Dialect/Util/IR/UtilOps.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/SHA256.h"
+#include "llvm/Support/raw_ostream.h"
+#include "mlir/Bytecode/BytecodeWriter.h"
+#include "mlir/IR/AsmState.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/OwningOpRef.h"
+#include "mlir/IR/SymbolTable.h"
+#include "mlir/Parser/Parser.h"
+
+namespace mlir::iree_compiler::ConstEval {
+
+// Bumped whenever the entry format or key derivation changes so that stale
+// entries are never loaded.
+static constexpr StringLiteral kCacheFormatVersion = "iree-consteval-cache-v1";
+
+static std::string getEntryPath(StringRef cachePath, StringRef key) {
+  SmallString<256> entryPath(cachePath);
+  llvm::sys::path::append(entryPath, key + ".mlirbc");
+  return entryPath.str().str();
+}
+
+namespace {
+
+// Feeds all bytes written to the stream into a hasher. Used to hash large
+// constant values without materializing them in memory.
+class HashingOStream : public llvm::raw_ostream {
+public:
+  explicit HashingOStream(llvm::SHA256 &hasher) : hasher(hasher) {}
+  ~HashingOStream() override { flush(); }
+
+private:
+  void write_impl(const char *ptr, size_t size) override {
+    hasher.update(StringRef(ptr, size));
+    position += size;
+  }
+  uint64_t current_pos() const override { return position; }
+
+  llvm::SHA256 &hasher;
+  uint64_t position = 0;
+};
+
+} // namespace
+
+// Feeds the contents of all resources referenced by |op| or any op nested
+// within it to |os|. The printed IR only contains resource handle names and
+// resources with the same name may have different contents across inputs.
+// Returns failure if any resource has no contents (such as when elided).
+static LogicalResult hashResources(Operation *op, raw_ostream &os) {
+  auto result = op->walk([&](Operation *nestedOp) {
+    return nestedOp->getAttrDictionary().walk(
+        [&](DenseResourceElementsAttr resourceAttr) {
+          AsmResourceBlob *blob = resourceAttr.getRawHandle().getBlob();
+          if (!blob) {
+            return WalkResult::interrupt();
+          }
+          ArrayRef<char> data = blob->getData();
+          os << '\0' << resourceAttr.getRawHandle().getKey() << '\0'
+             << data.size() << '\0';
+          os.write(data.data(), data.size());
+          return WalkResult::advance();
+        });
+  });
+  return failure(result.wasInterrupted());
+}
+
+// static
+std::optional<std::string>
+JitCache::hashFunction(Operation *funcOp, ArrayRef<Operation *> objectOps) {
+  OpPrintingFlags flags;
+  flags.printGenericOpForm().enableDebugInfo(false).useLocalScope();
+  llvm::SHA256 hasher;
+  HashingOStream os(hasher);
+
+  // Functions are uniqued by the order of initializers in the program. The
+  // name is not part of the evaluation and is normalized.
+  OwningOpRef<Operation *> clonedOp = funcOp->clone();
+  SymbolTable::setSymbolName(clonedOp.get(), "jit_eval");
+  clonedOp.get()->print(os, flags);
+  if (failed(hashResources(clonedOp.get(), os))) {
+    return std::nullopt;
+  }
+  for (auto *objectOp : objectOps) {
+    os << '\0';
+    objectOp->print(os, flags);
+    if (failed(hashResources(objectOp, os))) {
+      return std::nullopt;
+    }
+  }
+  os.flush();
+  return llvm::toHex(hasher.final(), /*LowerCase=*/true);
+}
+
+std::optional<std::string>
+JitCache::computeKey(StringRef functionHash, ArrayRef<Attribute> arguments,
+                     Location loc) const {
+  llvm::SHA256 hasher;
+  auto update = [&](StringRef value) {
+    hasher.update(value);
+    hasher.update(StringRef("\0", 1));
+  };
+  update(kCacheFormatVersion);
+  update(salt);
+  update(functionHash);
+  for (auto argument : arguments) {
+    if (!argument) {
+      return std::nullopt;
+    }
+    auto serializableAttr =
+        dyn_cast<IREE::Util::SerializableAttrInterface>(argument);
+    if (!serializableAttr) {
+      // Primitive values are fully captured by their printed form.
+      std::string str;
+      llvm::raw_string_ostream os(str);
+      os << argument;
+      update(os.str());
+      continue;
+    }
+    if (auto resourceAttr = dyn_cast<DenseResourceElementsAttr>(argument)) {
+      // Elided resources have no contents to hash.
+      if (!resourceAttr.getRawHandle().getBlob()) {
+        return std::nullopt;
+      }
+    }
+    {
+      std::string str;
+      llvm::raw_string_ostream os(str);
+      if (auto typedAttr = dyn_cast<TypedAttr>(argument)) {
+        os << typedAttr.getType();
+      }
+      update(os.str());
+    }
+    HashingOStream os(hasher);
+    if (failed(serializableAttr.serializeToStream(
+            loc, llvm::endianness::little, os))) {
+      return std::nullopt;
+    }
+  }
+  return llvm::toHex(hasher.final(), /*LowerCase=*/true);
+}
+
+std::optional<SmallVector<TypedAttr>>
+JitCache::load(MLIRContext *context, StringRef key,
+               TypeRange resultTypes) const {
+  std::string entryPath = getEntryPath(path, key);
+  if (!llvm::sys::fs::exists(entryPath)) {
+    return std::nullopt;
+  }
+  ParserConfig parserConfig(context);
+  auto moduleOp = parseSourceFile<ModuleOp>(entryPath, parserConfig);
+  if (!moduleOp) {
+    return std::nullopt;
+  }
+  auto globalOps = llvm::to_vector(moduleOp->getOps<IREE::Util::GlobalOp>());
+  if (globalOps.size() != resultTypes.size()) {
+    return std::nullopt;
+  }
+  SmallVector<TypedAttr> results;
+  for (auto [globalOp, resultType] : llvm::zip_equal(globalOps, resultTypes)) {
+    auto value = dyn_cast_if_present<TypedAttr>(globalOp.getInitialValueAttr());
+    if (!value || globalOp.getType() != resultType) {
+      return std::nullopt;
+    }
+    results.push_back(value);
+  }
+  return results;
+}
+
+LogicalResult JitCache::store(MLIRContext *context, StringRef key,
+                              ArrayRef<TypedAttr> results) const {
+  if (llvm::sys::fs::create_directories(path)) {
+    return failure();
+  }
+
+  auto loc = UnknownLoc::get(context);
+  auto moduleOp = OwningOpRef<ModuleOp>(ModuleOp::create(loc));
+  auto builder = OpBuilder::atBlockBegin(moduleOp->getBody());
+  for (auto [index, result] : llvm::enumerate(results)) {
+    builder.create<IREE::Util::GlobalOp>(loc, "result" + std::to_string(index),
+                                         /*isMutable=*/false, result.getType(),
+                                         result);
+  }
+
+  // Write to a unique temporary file and move it into place so concurrent
+  // readers never observe partially written entries.
+  SmallString<256> tempPattern(path);
+  llvm::sys::path::append(tempPattern, key + "-%%%%%%%%.tmp");
+  int tempFd = -1;
+  SmallString<256> tempPath;
+  if (llvm::sys::fs::createUniqueFile(tempPattern, tempFd, tempPath)) {
+    return failure();
+  }
+  bool didWrite = false;
+  {
+    llvm::raw_fd_ostream os(tempFd, /*shouldClose=*/true);
+    didWrite = succeeded(writeBytecodeToFile(*moduleOp, os));
+    os.flush();
+    didWrite = didWrite && !os.has_error();
+    os.clear_error();
+  }
+  if (!didWrite ||
+      llvm::sys::fs::rename(tempPath, getEntryPath(path, key))) {
+    llvm::sys::fs::remove(tempPath);
+    return failure();
+  }
+  return success();
+}
+
+} // namespace mlir::iree_compiler::ConstEval
@@ -0,0 +1,67 @@
+// Copyright 2025 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_COMPILER_CONSTEVAL_JITCACHE_H_
+#define IREE_COMPILER_CONSTEVAL_JITCACHE_H_
+
+#include <optional>
+#include <string>
+
+#include "mlir/IR/BuiltinAttributes.h"
+#include "mlir/IR/Operation.h"
+#include "mlir/IR/TypeRange.h"
+
+namespace mlir::iree_compiler::ConstEval {
+
+// An on-disk cache of the values produced by JIT evaluated initializers.
+// Entries are stored as MLIR bytecode files named by their key in a flat
+// directory that may be shared by concurrent compiler processes.
+//
+// Keys are derived from the generic printed form of the JIT function (and any
+// objects it references) without locations, the contents of any resources
+// used inline, the contents of all argument values, and a |salt| that must
+// capture everything else the results depend on (compiler revision, target
+// device, etc). The cache is best-effort: any failure to read or write an
+// entry is treated as a miss.
+class JitCache {
+public:
+  JitCache(StringRef path, StringRef salt) : path(path), salt(salt) {}
+
+  // Returns true if the cache has a directory to read/write entries from.
+  bool isEnabled() const { return !path.empty(); }
+
+  // Returns a hash of |funcOp| and the |objectOps| it references, including
+  // the contents of any resources they use, that is independent of the
+  // function name and locations. Returns std::nullopt if the contents of a
+  // resource are unavailable (such as when elided).
+  static std::optional<std::string>
+  hashFunction(Operation *funcOp, ArrayRef<Operation *> objectOps);
+
+  // Computes the key of evaluating the function with |functionHash| on
+  // |arguments|. Returns std::nullopt if any argument value is unavailable or
+  // its contents cannot be hashed (such as elided resources).
+  std::optional<std::string> computeKey(StringRef functionHash,
+                                        ArrayRef<Attribute> arguments,
+                                        Location loc) const;
+
+  // Loads the results stored under |key|. Returns std::nullopt if the entry
+  // does not exist, cannot be loaded, or does not match |resultTypes|.
+  std::optional<SmallVector<TypedAttr>> load(MLIRContext *context,
+                                             StringRef key,
+                                             TypeRange resultTypes) const;
+
+  // Stores |results| under |key|, replacing any existing entry.
+  LogicalResult store(MLIRContext *context, StringRef key,
+                      ArrayRef<TypedAttr> results) const;
+
+private:
+  std::string path;
+  std::string salt;
+};
+
+} // namespace mlir::iree_compiler::ConstEval
+
+#endif // IREE_COMPILER_CONSTEVAL_JITCACHE_H_
@@ -4,6 +4,7 @@
 // See https://llvm.org/LICENSE.txt for license information.
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
+#include "iree/compiler/ConstEval/JitCache.h"
 #include "iree/compiler/ConstEval/Passes.h"
 #include "iree/compiler/ConstEval/Runtime.h"
 #include "iree/compiler/Dialect/HAL/Target/TargetOptions.h"
@@ -13,6 +14,7 @@
 #include "iree/compiler/Pipelines/Pipelines.h"
 #include "iree/compiler/Utils/PassUtils.h"
 #include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/SetVector.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/Timer.h"
 #include "llvm/Support/raw_ostream.h"
@@ -22,6 +24,7 @@
 #include "mlir/IR/BuiltinOps.h"
 #include "mlir/IR/IRMapping.h"
 #include "mlir/IR/SymbolTable.h"
+#include "mlir/IR/Threading.h"
 
 #include <cstdlib>
 
@@ -384,8 +387,69 @@ struct JitFunctionDesc {
   std::string name;
   llvm::SmallVector<ArgumentBinding> argumentBindings;
   llvm::SmallVector<ResultBinding> resultBindings;
+  // Indices of earlier functions that load or store any global this function
+  // loads or stores. They must be evaluated first.
+  llvm::SmallVector<size_t> dependencies;
+  // Hash of the function IR used to key cached results. Only set when caching
+  // and the function can be hashed.
+  std::optional<std::string> functionHash;
+  // True once the results have been assigned to the globals.
+  bool isEvaluated = false;
 };
 
+// Records the |dependencies| of each function in |jitFunctions| such that
+// evaluation in dependency order produces the same global values as
+// evaluation in program order.
+static void assignDependencies(MutableArrayRef<JitFunctionDesc> jitFunctions) {
+  // Functions that last stored each global and loaded it since.
+  DenseMap<Operation *, size_t> lastStores;
+  DenseMap<Operation *, llvm::SmallVector<size_t>> loadsSinceStore;
+  for (auto [index, jitFunction] : llvm::enumerate(jitFunctions)) {
+    llvm::SetVector<size_t> dependencies;
+    for (ArgumentBinding &arg : jitFunction.argumentBindings) {
+      if (arg.getType() != ArgumentBinding::Type::GlobalOp)
+        continue;
+      Operation *globalOp = arg.getGlobalOp().getOperation();
+      auto it = lastStores.find(globalOp);
+      if (it != lastStores.end())
+        dependencies.insert(it->second);
+      loadsSinceStore[globalOp].push_back(index);
+    }
+    for (ResultBinding &result : jitFunction.resultBindings) {
+      Operation *globalOp = result.getGlobalOp().getOperation();
+      auto it = lastStores.find(globalOp);
+      if (it != lastStores.end())
+        dependencies.insert(it->second);
+      for (size_t loadIndex : loadsSinceStore[globalOp]) {
+        if (loadIndex != index)
+          dependencies.insert(loadIndex);
+      }
+      loadsSinceStore[globalOp].clear();
+      lastStores[globalOp] = index;
+    }
+    jitFunction.dependencies = dependencies.takeVector();
+  }
+}
+
+// Partitions |jitFunctions| into waves of functions that only depend on
+// functions in prior waves and can be evaluated concurrently.
+static llvm::SmallVector<llvm::SmallVector<size_t>>
+computeEvaluationWaves(ArrayRef<JitFunctionDesc> jitFunctions) {
+  llvm::SmallVector<size_t> functionWaves(jitFunctions.size(), 0);
+  llvm::SmallVector<llvm::SmallVector<size_t>> waves;
+  for (auto [index, jitFunction] : llvm::enumerate(jitFunctions)) {
+    size_t wave = 0;
+    for (size_t dependency : jitFunction.dependencies) {
+      wave = std::max(wave, functionWaves[dependency] + 1);
+    }
+    functionWaves[index] = wave;
+    if (wave >= waves.size())
+      waves.resize(wave + 1);
+    waves[wave].push_back(index);
+  }
+  return waves;
+}
+
 // Clones all object-like symbols used within the function.
 // Objects are only cloned once if used by multiple functions.
 // All object contents are cloned and symbol DCE is relied on to remove any
@@ -430,12 +494,14 @@ public:
   ProgramBuilder(ModuleOp sourceModuleOp,
                  IREE::HAL::DeviceTargetAttr deviceTargetAttr,
                  const IREE::HAL::TargetBackend::SupportedTypes &supportedTypes,
-                 const IREE::Util::ConstExprAnalysis &constExprAnalysis)
+                 const IREE::Util::ConstExprAnalysis &constExprAnalysis,
+                 bool hashFunctions)
       : targetModuleOp(createInnerModule(sourceModuleOp)),
         sourceSymbolTable(sourceModuleOp), targetSymbolTable(targetModuleOp),
         supportedTypes(supportedTypes), constExprAnalysis(constExprAnalysis),
         initializationAnalysis(sourceModuleOp, sourceSymbolTable,
-                               constExprAnalysis) {
+                               constExprAnalysis),
+        hashFunctions(hashFunctions) {
     targetModuleOp->setAttr(
         "hal.device.targets",
         ArrayAttr::get(sourceModuleOp.getContext(),
@@ -580,6 +646,22 @@ private:
     termBuilder.create<IREE::Util::ReturnOp>(funcOp.getLoc(), returns);
     funcOp.setType(termBuilder.getFunctionType(argumentTypes, returnTypes));
 
+    // Hash the function along with all objects it references for use as a
+    // cache key.
+    if (hashFunctions) {
+      llvm::SetVector<Operation *> objectOps;
+      if (auto uses = SymbolTable::getSymbolUses(funcOp)) {
+        for (auto use : uses.value()) {
+          if (auto *objectOp = targetSymbolTable.lookup(
+                  use.getSymbolRef().getRootReference())) {
+            objectOps.insert(objectOp);
+          }
+        }
+      }
+      desc.functionHash =
+          JitCache::hashFunction(funcOp, objectOps.getArrayRef());
+    }
+
     jitFunctions.push_back(std::move(desc));
     return success();
   }
@@ -591,6 +673,7 @@ private:
   const IREE::HAL::TargetBackend::SupportedTypes supportedTypes;
   const IREE::Util::ConstExprAnalysis &constExprAnalysis;
   InitializationAnalysis initializationAnalysis;
+  bool hashFunctions;
 };
 
 class JitGlobalsPass final : public impl::JitGlobalsPassBase<JitGlobalsPass> {
@@ -601,6 +684,8 @@ public:
       : compileOptions(std::make_shared<CompileOptions>()),
         compilePipeline("builtin.module") {
     targetRegistry = options.targetRegistry;
+    cachePath = options.cachePath;
+    cacheKey = options.cacheKey;
 
     // Detect backend.
     compileOptions->targetOptions.f32Extension = true;
@@ -642,74 +727,161 @@ public:
     return clJitTargetDevice;
   }
 
+  // Evaluates |jitFunction| with |binary| or loads its results from |cache|
+  // into |results|. If |binary| is null then only the cache is consulted and
+  // |results| is left unset on a miss.
   LogicalResult
-  processFunctions(CompiledBinary &binary,
-                   llvm::SmallVector<JitFunctionDesc> &jitFunctions,
-                   ModuleOp module, llvm::TimerGroup &tg) {
-    // Process each function through the runtime.
-    for (JitFunctionDesc &jitFunction : jitFunctions) {
-      std::optional<llvm::Timer> invokeTimer;
-      if (debugEnabled) {
-        std::string timerName("Invoke ");
-        timerName.append(jitFunction.name);
-        invokeTimer.emplace(timerName, timerName, tg);
-        invokeTimer->startTimer();
-        llvm::dbgs() << "::: Invoking " << jitFunction.name << "\n";
+  evaluateFunction(ArrayRef<JitFunctionDesc> jitFunctions,
+                   JitFunctionDesc &jitFunction, CompiledBinary *binary,
+                   const JitCache &cache, llvm::TimerGroup &tg,
+                   std::optional<llvm::SmallVector<TypedAttr>> &results) {
+    // Argument values are only valid once their producers have been
+    // evaluated. Evaluation with a binary is always in dependency order.
+    for (size_t dependency : jitFunction.dependencies) {
+      if (!jitFunctions[dependency].isEvaluated) {
+        assert(!binary && "evaluating out of order");
+        return success();
       }
+    }
 
-      FunctionCall call(binary, jitFunction.argumentBindings.size(),
-                        jitFunction.resultBindings.size());
-      if (failed(call.initialize(jitFunction.loc)))
-        return failure();
+    llvm::SmallVector<Attribute> argumentValues;
+    for (ArgumentBinding &arg : jitFunction.argumentBindings) {
+      switch (arg.getType()) {
+      case ArgumentBinding::Type::ElementsAttr:
+        argumentValues.push_back(arg.getElementsAttr());
+        break;
+      case ArgumentBinding::Type::GlobalOp:
+        argumentValues.push_back(arg.getGlobalOp().getGlobalInitialValue());
+        break;
+      }
+    }
+    llvm::SmallVector<Type> resultTypes;
+    for (ResultBinding &resultBinding : jitFunction.resultBindings) {
+      resultTypes.push_back(resultBinding.getGlobalOp().getGlobalType());
+    }
 
-      // Convert arguments.
-      for (ArgumentBinding &arg : jitFunction.argumentBindings) {
-        switch (arg.getType()) {
-        case ArgumentBinding::Type::ElementsAttr: {
-          if (failed(call.addArgument(jitFunction.loc, arg.getElementsAttr())))
-            return failure();
-          break;
-        }
-        case ArgumentBinding::Type::GlobalOp: {
-          auto globalValue = arg.getGlobalOp().getGlobalInitialValue();
-          if (!globalValue) {
-            return emitError(jitFunction.loc)
-                   << "internal error: jit global source initialization order "
-                      "invalid: global "
-                   << arg.getGlobalOp().getGlobalName() << " has no value";
+    // Reuse the results of a previous compilation if available.
+    std::optional<std::string> key;
+    if (cache.isEnabled() && jitFunction.functionHash) {
+      key = cache.computeKey(*jitFunction.functionHash, argumentValues,
+                             jitFunction.loc);
+      if (key) {
+        results = cache.load(&getContext(), *key, resultTypes);
+        if (results) {
+          if (debugEnabled) {
+            llvm::dbgs() << "::: Loaded cached " << jitFunction.name << ": "
+                         << *key << "\n";
           }
-          if (failed(call.addArgument(arg.getGlobalOp().getLoc(), globalValue)))
-            return failure();
-          break;
-        }
+          return success();
         }
       }
+    }
+    if (!binary)
+      return success();
 
-      if (failed(call.invoke(jitFunction.loc, jitFunction.name))) {
-        return failure();
-      }
+    std::optional<llvm::Timer> invokeTimer;
+    if (debugEnabled) {
+      std::string timerName("Invoke ");
+      timerName.append(jitFunction.name);
+      invokeTimer.emplace(timerName, timerName, tg);
+      invokeTimer->startTimer();
+      llvm::dbgs() << "::: Invoking " << jitFunction.name << "\n";
+    }
 
-      // Process results.
-      for (auto it : llvm::enumerate(jitFunction.resultBindings)) {
-        ResultBinding &resultBinding = it.value();
-        switch (resultBinding.getType()) {
-        case ResultBinding::Type::GlobalOp: {
-          TypedAttr attr;
-          if (failed(call.getResultAsAttr(
-                  resultBinding.getGlobalOp().getLoc(), it.index(),
-                  resultBinding.getGlobalOp().getGlobalType(), attr)))
-            return failure();
-          resultBinding.getGlobalOp().setGlobalInitialValue(attr);
-          break;
-        }
+    FunctionCall call(*binary, jitFunction.argumentBindings.size(),
+                      jitFunction.resultBindings.size());
+    if (failed(call.initialize(jitFunction.loc)))
+      return failure();
+
+    // Convert arguments.
+    for (auto [arg, value] :
+         llvm::zip_equal(jitFunction.argumentBindings, argumentValues)) {
+      switch (arg.getType()) {
+      case ArgumentBinding::Type::ElementsAttr: {
+        if (failed(call.addArgument(jitFunction.loc, value)))
+          return failure();
+        break;
+      }
+      case ArgumentBinding::Type::GlobalOp: {
+        if (!value) {
+          return emitError(jitFunction.loc)
+                 << "internal error: jit global source initialization order "
+                    "invalid: global "
+                 << arg.getGlobalOp().getGlobalName() << " has no value";
         }
+        if (failed(call.addArgument(arg.getGlobalOp().getLoc(), value)))
+          return failure();
+        break;
+      }
       }
+    }
+
+    if (failed(call.invoke(jitFunction.loc, jitFunction.name))) {
+      return failure();
+    }
+
+    // Process results.
+    results.emplace();
+    for (auto it : llvm::enumerate(jitFunction.resultBindings)) {
+      ResultBinding &resultBinding = it.value();
+      switch (resultBinding.getType()) {
+      case ResultBinding::Type::GlobalOp: {
+        TypedAttr attr;
+        if (failed(call.getResultAsAttr(resultBinding.getGlobalOp().getLoc(),
+                                        it.index(), resultTypes[it.index()],
+                                        attr)))
+          return failure();
+        results->push_back(attr);
+        break;
+      }
+      }
+    }
+
+    if (debugEnabled) {
+      invokeTimer->stopTimer();
+    }
 
+    if (key && failed(cache.store(&getContext(), *key, *results))) {
       if (debugEnabled) {
-        invokeTimer->stopTimer();
+        llvm::dbgs() << "::: Failed to cache " << jitFunction.name << "\n";
       }
     }
+    return success();
+  }
+
+  // Evaluates all functions in |jitFunctions| that have not yet been evaluated
+  // and assigns their results to the globals they store. Functions without
+  // dependencies on each other are evaluated concurrently.
+  LogicalResult evaluateFunctions(MutableArrayRef<JitFunctionDesc> jitFunctions,
+                                  CompiledBinary *binary, const JitCache &cache,
+                                  llvm::TimerGroup &tg) {
+    for (auto &wave : computeEvaluationWaves(jitFunctions)) {
+      llvm::SmallVector<std::optional<llvm::SmallVector<TypedAttr>>>
+          waveResults(wave.size());
+      if (failed(failableParallelForEach(
+              &getContext(), llvm::seq<size_t>(0, wave.size()), [&](size_t i) {
+                auto &jitFunction = jitFunctions[wave[i]];
+                if (jitFunction.isEvaluated)
+                  return success();
+                return evaluateFunction(jitFunctions, jitFunction, binary,
+                                        cache, tg, waveResults[i]);
+              }))) {
+        return failure();
+      }
 
+      // Globals are only updated between waves as functions in the same wave
+      // may load the prior values.
+      for (auto [index, results] : llvm::zip_equal(wave, waveResults)) {
+        if (!results)
+          continue;
+        auto &jitFunction = jitFunctions[index];
+        for (auto [resultBinding, value] :
+             llvm::zip_equal(jitFunction.resultBindings, *results)) {
+          resultBinding.getGlobalOp().setGlobalInitialValue(value);
+        }
+        jitFunction.isEvaluated = true;
+      }
+    }
     return success();
   }
 
@@ -751,10 +923,14 @@ public:
       }
     }
 
+    // Results are specific to the device they were evaluated with.
+    JitCache cache(cachePath, cacheKey + "\n" + requestedTargetDevice);
+
     // Build the program.
     ProgramBuilder programBuilder(outerModule, *deviceTargetAttr,
                                   supportedTypes,
-                                  getAnalysis<IREE::Util::ConstExprAnalysis>());
+                                  getAnalysis<IREE::Util::ConstExprAnalysis>(),
+                                  /*hashFunctions=*/cache.isEnabled());
 
     // Iterate over initializers.
     llvm::SmallVector<IREE::Util::InitializerOp> initializerOps;
@@ -770,10 +946,38 @@ public:
                      << initializerOp << "\n";
       }
     }
-    if (programBuilder.getJitFunctions().empty()) {
+    auto &jitFunctions = programBuilder.getJitFunctions();
+    if (jitFunctions.empty()) {
       programBuilder.getTargetModule()->erase();
       return;
     }
+    assignDependencies(jitFunctions);
+
+    // Reuse results from previous compilations and only compile the functions
+    // that remain.
+    if (cache.isEnabled()) {
+      if (failed(evaluateFunctions(jitFunctions, /*binary=*/nullptr, cache,
+                                   tg))) {
+        return signalPassFailure();
+      }
+      for (auto &jitFunction : jitFunctions) {
+        if (!jitFunction.isEvaluated)
+          continue;
+        if (auto *funcOp = SymbolTable::lookupSymbolIn(
+                programBuilder.getTargetModule(), jitFunction.name)) {
+          funcOp->erase();
+        }
+      }
+      if (llvm::all_of(jitFunctions, [](const JitFunctionDesc &jitFunction) {
+            return jitFunction.isEvaluated;
+          })) {
+        programBuilder.getTargetModule()->erase();
+        for (auto deadOp : deadInitOps) {
+          deadOp.erase();
+        }
+        return;
+      }
+    }
 
     std::optional<llvm::Timer> compileTimer;
     if (debugEnabled) {
@@ -799,8 +1003,7 @@ public:
     programBuilder.getTargetModule()->erase();
 
     // Process the functions.
-    if (failed(processFunctions(binary, programBuilder.getJitFunctions(),
-                                outerModule, tg))) {
+    if (failed(evaluateFunctions(jitFunctions, &binary, cache, tg))) {
       signalPassFailure();
       return;
     }
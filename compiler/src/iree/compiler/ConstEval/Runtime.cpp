@@ -490,7 +490,7 @@ LogicalResult CompiledBinary::initialize(Location loc, void *data,
         main_module.get(),
     };
     status = iree_vm_context_create_with_modules(
-        runtime.instance.get(), IREE_VM_CONTEXT_FLAG_NONE, modules.size(),
+        runtime.instance.get(), IREE_VM_CONTEXT_FLAG_CONCURRENT, modules.size(),
         modules.data(), iree_allocator_system(), &context);
   }
 
@@ -0,0 +1,42 @@
+// RUN: rm -rf %t
+// RUN: iree-opt --pass-pipeline='builtin.module(iree-consteval-jit-globals{cache-path=%t})' --iree-consteval-jit-debug %s 2>&1 | FileCheck %s --check-prefixes=CHECK,POPULATE
+// RUN: iree-opt --pass-pipeline='builtin.module(iree-consteval-jit-globals{cache-path=%t})' --iree-consteval-jit-debug %s 2>&1 | FileCheck %s --check-prefixes=CHECK,REUSE
+
+// Tests that evaluated values are stored in the cache by the first compilation
+// and reused by subsequent ones without compiling the JIT program. The second
+// initializer depends on the value produced by the first.
+
+// POPULATE: ::: COMPILING JIT
+// POPULATE-DAG: ::: Invoking jit_eval{{$}}
+// POPULATE-DAG: ::: Invoking jit_eval_0{{$}}
+
+// REUSE-DAG: ::: Loaded cached jit_eval:
+// REUSE-DAG: ::: Loaded cached jit_eval_0:
+// REUSE-NOT: ::: COMPILING JIT
+// REUSE-NOT: ::: Invoking
+
+// CHECK-LABEL: @cached_jit
+module @cached_jit {
+  // CHECK: util.global private @[[FIRST:.+]] = dense<4.000000e+00> : tensor<4xf32>
+  util.global private @first : tensor<4xf32>
+  // CHECK: util.global private @[[SECOND:.+]] = dense<1.600000e+01> : tensor<4xf32>
+  util.global private @second : tensor<4xf32>
+  // CHECK-NOT: util.initializer
+  util.initializer {
+    %cst = arith.constant dense<2.0> : tensor<4xf32>
+    %0 = arith.mulf %cst, %cst : tensor<4xf32>
+    util.global.store %0, @first : tensor<4xf32>
+    util.return
+  }
+  util.initializer {
+    %0 = util.global.load @first : tensor<4xf32>
+    %1 = arith.mulf %0, %0 : tensor<4xf32>
+    util.global.store %1, @second : tensor<4xf32>
+    util.return
+  }
+  util.func public @main() -> (tensor<4xf32>, tensor<4xf32>) {
+    %0 = util.global.load @first : tensor<4xf32>
+    %1 = util.global.load @second : tensor<4xf32>
+    util.return %0, %1 : tensor<4xf32>, tensor<4xf32>
+  }
+}
@@ -0,0 +1,144 @@
+// RUN: rm -rf %t
+// RUN: iree-opt --split-input-file --pass-pipeline='builtin.module(iree-consteval-jit-globals{cache-path=%t})' --iree-consteval-jit-debug -o /dev/null %s 2>&1 | FileCheck %s --check-prefix=DEBUG
+// RUN: iree-opt --split-input-file --pass-pipeline='builtin.module(iree-consteval-jit-globals{cache-path=%t})' %s | FileCheck %s
+
+// Tests that resources used inline by the JIT function are keyed on their
+// contents and not only their names: each input is parsed independently and
+// resources with the same name may hold different data. The first RUN line
+// populates the cache and the second verifies the cached values.
+
+// DEBUG: ::: COMPILING JIT
+// DEBUG: ::: Invoking jit_eval{{$}}
+
+// CHECK-LABEL: @resource_ones
+module @resource_ones {
+  // CHECK: util.global private @hoisted = dense<51> : tensor<4xi8>
+  util.global private @hoisted : tensor<4xi8>
+  util.initializer {
+    %cst0 = arith.constant 42 : i8
+    %cst1 = arith.constant dense<4> : tensor<4xi8>
+    %c4 = arith.constant 4 : index
+    %0 = flow.dispatch.workgroups[%c4](%cst0, %cst1) : (i8, tensor<4xi8>) -> tensor<4xi8> =
+        (%arg0: i8, %arg1: !iree_tensor_ext.dispatch.tensor<readonly:tensor<4xi8>>, %arg2: !iree_tensor_ext.dispatch.tensor<writeonly:tensor<4xi8>>) {
+      %bias = arith.constant dense_resource<bias> : tensor<4xi8>
+      %empty = tensor.empty() : tensor<4xi8>
+      %input = iree_tensor_ext.dispatch.tensor.load %arg1, offsets=[0], sizes=[4], strides=[1] : !iree_tensor_ext.dispatch.tensor<readonly:tensor<4xi8>> -> tensor<4xi8>
+      %output = linalg.generic {
+        indexing_maps = [affine_map<(d0) -> (d0)>, affine_map<(d0) -> (d0)>, affine_map<(d0) -> (d0)>, affine_map<(d0) -> (d0)>],
+        iterator_types = ["parallel"]
+      } ins(%input, %input, %bias : tensor<4xi8>, tensor<4xi8>, tensor<4xi8>) outs(%empty : tensor<4xi8>) {
+      ^bb0(%arg3: i8, %arg4: i8, %arg5: i8, %arg6: i8):
+        %addi_x2 = arith.addi %arg3, %arg4 : i8
+        %addi_bias = arith.addi %addi_x2, %arg5 : i8
+        %result = arith.addi %addi_bias, %arg0 : i8
+        linalg.yield %result : i8
+      } -> tensor<4xi8>
+      iree_tensor_ext.dispatch.tensor.store %output, %arg2, offsets=[0], sizes=[4], strides=[1] : tensor<4xi8> -> !iree_tensor_ext.dispatch.tensor<writeonly:tensor<4xi8>>
+      flow.return
+    }
+    util.global.store %0, @hoisted : tensor<4xi8>
+    util.return
+  }
+}
+
+{-#
+  dialect_resources: {
+    builtin: {
+      bias: "0x0100000001010101"
+    }
+  }
+#-}
+
+// -----
+
+// The same function with a same-named resource holding different contents
+// must not reuse the cached results.
+
+// DEBUG-NOT: ::: Loaded cached
+// DEBUG: ::: COMPILING JIT
+// DEBUG: ::: Invoking jit_eval{{$}}
+
+// CHECK-LABEL: @resource_twos
+module @resource_twos {
+  // CHECK: util.global private @hoisted = dense<52> : tensor<4xi8>
+  util.global private @hoisted : tensor<4xi8>
+  util.initializer {
+    %cst0 = arith.constant 42 : i8
+    %cst1 = arith.constant dense<4> : tensor<4xi8>
+    %c4 = arith.constant 4 : index
+    %0 = flow.dispatch.workgroups[%c4](%cst0, %cst1) : (i8, tensor<4xi8>) -> tensor<4xi8> =
+        (%arg0: i8, %arg1: !iree_tensor_ext.dispatch.tensor<readonly:tensor<4xi8>>, %arg2: !iree_tensor_ext.dispatch.tensor<writeonly:tensor<4xi8>>) {
+      %bias = arith.constant dense_resource<bias> : tensor<4xi8>
+      %empty = tensor.empty() : tensor<4xi8>
+      %input = iree_tensor_ext.dispatch.tensor.load %arg1, offsets=[0], sizes=[4], strides=[1] : !iree_tensor_ext.dispatch.tensor<readonly:tensor<4xi8>> -> tensor<4xi8>
+      %output = linalg.generic {
+        indexing_maps = [affine_map<(d0) -> (d0)>, affine_map<(d0) -> (d0)>, affine_map<(d0) -> (d0)>, affine_map<(d0) -> (d0)>],
+        iterator_types = ["parallel"]
+      } ins(%input, %input, %bias : tensor<4xi8>, tensor<4xi8>, tensor<4xi8>) outs(%empty : tensor<4xi8>) {
+      ^bb0(%arg3: i8, %arg4: i8, %arg5: i8, %arg6: i8):
+        %addi_x2 = arith.addi %arg3, %arg4 : i8
+        %addi_bias = arith.addi %addi_x2, %arg5 : i8
+        %result = arith.addi %addi_bias, %arg0 : i8
+        linalg.yield %result : i8
+      } -> tensor<4xi8>
+      iree_tensor_ext.dispatch.tensor.store %output, %arg2, offsets=[0], sizes=[4], strides=[1] : tensor<4xi8> -> !iree_tensor_ext.dispatch.tensor<writeonly:tensor<4xi8>>
+      flow.return
+    }
+    util.global.store %0, @hoisted : tensor<4xi8>
+    util.return
+  }
+}
+
+{-#
+  dialect_resources: {
+    builtin: {
+      bias: "0x0100000002020202"
+    }
+  }
+#-}
+
+// -----
+
+// Matching contents reuse the results of the first input.
+
+// DEBUG: ::: Loaded cached jit_eval:
+// DEBUG-NOT: ::: COMPILING JIT
+
+// CHECK-LABEL: @resource_ones_again
+module @resource_ones_again {
+  // CHECK: util.global private @hoisted = dense<51> : tensor<4xi8>
+  util.global private @hoisted : tensor<4xi8>
+  util.initializer {
+    %cst0 = arith.constant 42 : i8
+    %cst1 = arith.constant dense<4> : tensor<4xi8>
+    %c4 = arith.constant 4 : index
+    %0 = flow.dispatch.workgroups[%c4](%cst0, %cst1) : (i8, tensor<4xi8>) -> tensor<4xi8> =
+        (%arg0: i8, %arg1: !iree_tensor_ext.dispatch.tensor<readonly:tensor<4xi8>>, %arg2: !iree_tensor_ext.dispatch.tensor<writeonly:tensor<4xi8>>) {
+      %bias = arith.constant dense_resource<bias> : tensor<4xi8>
+      %empty = tensor.empty() : tensor<4xi8>
+      %input = iree_tensor_ext.dispatch.tensor.load %arg1, offsets=[0], sizes=[4], strides=[1] : !iree_tensor_ext.dispatch.tensor<readonly:tensor<4xi8>> -> tensor<4xi8>
+      %output = linalg.generic {
+        indexing_maps = [affine_map<(d0) -> (d0)>, affine_map<(d0) -> (d0)>, affine_map<(d0) -> (d0)>, affine_map<(d0) -> (d0)>],
+        iterator_types = ["parallel"]
+      } ins(%input, %input, %bias : tensor<4xi8>, tensor<4xi8>, tensor<4xi8>) outs(%empty : tensor<4xi8>) {
+      ^bb0(%arg3: i8, %arg4: i8, %arg5: i8, %arg6: i8):
+        %addi_x2 = arith.addi %arg3, %arg4 : i8
+        %addi_bias = arith.addi %addi_x2, %arg5 : i8
+        %result = arith.addi %addi_bias, %arg0 : i8
+        linalg.yield %result : i8
+      } -> tensor<4xi8>
+      iree_tensor_ext.dispatch.tensor.store %output, %arg2, offsets=[0], sizes=[4], strides=[1] : tensor<4xi8> -> !iree_tensor_ext.dispatch.tensor<writeonly:tensor<4xi8>>
+      flow.return
+    }
+    util.global.store %0, @hoisted : tensor<4xi8>
+    util.return
+  }
+}
+
+{-#
+  dialect_resources: {
+    builtin: {
+      bias: "0x0100000001010101"
+    }
+  }
+#-}
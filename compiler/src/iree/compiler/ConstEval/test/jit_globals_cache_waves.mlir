@@ -0,0 +1,124 @@
+// RUN: rm -rf %t
+// RUN: iree-opt --split-input-file --pass-pipeline='builtin.module(iree-consteval-jit-globals{cache-path=%t})' --iree-consteval-jit-debug -o /dev/null %s 2>&1 | FileCheck %s --check-prefix=DEBUG
+// RUN: iree-opt --split-input-file --pass-pipeline='builtin.module(iree-consteval-jit-globals{cache-path=%t})' %s | FileCheck %s
+
+// Tests partial cache hits when initializers are evaluated concurrently in
+// waves. @lhs and @rhs are independent and evaluated together in the first
+// wave while @product depends on both and is evaluated in the second. Each
+// input is evaluated against the entries populated by the prior ones.
+
+// DEBUG: ::: COMPILING JIT
+// DEBUG-DAG: ::: Invoking jit_eval{{$}}
+// DEBUG-DAG: ::: Invoking jit_eval_0{{$}}
+// DEBUG: ::: Invoking jit_eval_1{{$}}
+
+// CHECK-LABEL: @populate
+module @populate {
+  // CHECK: util.global private @lhs = dense<4.000000e+00> : tensor<4xf32>
+  util.global private @lhs : tensor<4xf32>
+  // CHECK: util.global private @rhs = dense<9.000000e+00> : tensor<4xf32>
+  util.global private @rhs : tensor<4xf32>
+  // CHECK: util.global private @product = dense<3.600000e+01> : tensor<4xf32>
+  util.global private @product : tensor<4xf32>
+  util.initializer {
+    %cst = arith.constant dense<2.0> : tensor<4xf32>
+    %0 = arith.mulf %cst, %cst : tensor<4xf32>
+    util.global.store %0, @lhs : tensor<4xf32>
+    util.return
+  }
+  util.initializer {
+    %cst = arith.constant dense<3.0> : tensor<4xf32>
+    %0 = arith.mulf %cst, %cst : tensor<4xf32>
+    util.global.store %0, @rhs : tensor<4xf32>
+    util.return
+  }
+  util.initializer {
+    %0 = util.global.load @lhs : tensor<4xf32>
+    %1 = util.global.load @rhs : tensor<4xf32>
+    %2 = arith.mulf %0, %1 : tensor<4xf32>
+    util.global.store %2, @product : tensor<4xf32>
+    util.return
+  }
+}
+
+// -----
+
+// @lhs hits before compilation and is not invoked. @rhs changed and misses,
+// which in turn makes @product miss in the second wave.
+
+// DEBUG: ::: Loaded cached jit_eval:
+// DEBUG: ::: COMPILING JIT
+// DEBUG-NOT: ::: Invoking jit_eval{{$}}
+// DEBUG: ::: Invoking jit_eval_0{{$}}
+// DEBUG-NOT: ::: Invoking jit_eval{{$}}
+// DEBUG: ::: Invoking jit_eval_1{{$}}
+
+// CHECK-LABEL: @partial_miss
+module @partial_miss {
+  // CHECK: util.global private @lhs = dense<4.000000e+00> : tensor<4xf32>
+  util.global private @lhs : tensor<4xf32>
+  // CHECK: util.global private @rhs = dense<2.500000e+01> : tensor<4xf32>
+  util.global private @rhs : tensor<4xf32>
+  // CHECK: util.global private @product = dense<1.000000e+02> : tensor<4xf32>
+  util.global private @product : tensor<4xf32>
+  util.initializer {
+    %cst = arith.constant dense<2.0> : tensor<4xf32>
+    %0 = arith.mulf %cst, %cst : tensor<4xf32>
+    util.global.store %0, @lhs : tensor<4xf32>
+    util.return
+  }
+  util.initializer {
+    %cst = arith.constant dense<5.0> : tensor<4xf32>
+    %0 = arith.mulf %cst, %cst : tensor<4xf32>
+    util.global.store %0, @rhs : tensor<4xf32>
+    util.return
+  }
+  util.initializer {
+    %0 = util.global.load @lhs : tensor<4xf32>
+    %1 = util.global.load @rhs : tensor<4xf32>
+    %2 = arith.mulf %0, %1 : tensor<4xf32>
+    util.global.store %2, @product : tensor<4xf32>
+    util.return
+  }
+}
+
+// -----
+
+// @rhs hits before compilation. @lhs changed and misses but produces the same
+// value as before, so once it has been invoked in the first wave @product hits
+// in the second wave without being invoked.
+
+// DEBUG: ::: Loaded cached jit_eval_0:
+// DEBUG: ::: COMPILING JIT
+// DEBUG: ::: Invoking jit_eval{{$}}
+// DEBUG: ::: Loaded cached jit_eval_1:
+// DEBUG-NOT: ::: Invoking
+
+// CHECK-LABEL: @partial_hit
+module @partial_hit {
+  // CHECK: util.global private @lhs = dense<4.000000e+00> : tensor<4xf32>
+  util.global private @lhs : tensor<4xf32>
+  // CHECK: util.global private @rhs = dense<2.500000e+01> : tensor<4xf32>
+  util.global private @rhs : tensor<4xf32>
+  // CHECK: util.global private @product = dense<1.000000e+02> : tensor<4xf32>
+  util.global private @product : tensor<4xf32>
+  util.initializer {
+    %cst = arith.constant dense<-2.0> : tensor<4xf32>
+    %0 = arith.mulf %cst, %cst : tensor<4xf32>
+    util.global.store %0, @lhs : tensor<4xf32>
+    util.return
+  }
+  util.initializer {
+    %cst = arith.constant dense<5.0> : tensor<4xf32>
+    %0 = arith.mulf %cst, %cst : tensor<4xf32>
+    util.global.store %0, @rhs : tensor<4xf32>
+    util.return
+  }
+  util.initializer {
+    %0 = util.global.load @lhs : tensor<4xf32>
+    %1 = util.global.load @rhs : tensor<4xf32>
+    %2 = arith.mulf %0, %1 : tensor<4xf32>
+    util.global.store %2, @product : tensor<4xf32>
+    util.return
+  }
+}
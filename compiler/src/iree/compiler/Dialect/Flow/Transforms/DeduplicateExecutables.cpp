@@ -6,7 +6,12 @@
 
 #include "iree/compiler/Dialect/Flow/Transforms/Passes.h"
 #include "iree/compiler/Utils/EquivalenceUtils.h"
+#include "llvm/ADT/BitVector.h"
+#include "mlir/Dialect/Arith/IR/Arith.h"
 #include "mlir/IR/Builders.h"
+#include "mlir/IR/OwningOpRef.h"
+#include "mlir/IR/SymbolTable.h"
+#include "mlir/Interfaces/LoopLikeInterface.h"
 #include "mlir/Pass/Pass.h"
 
 namespace mlir::iree_compiler::IREE::Flow {
@@ -79,26 +84,34 @@ replaceSymbolRefs(Operation *scopeOp,
   }
 }
 
-// Returns the total number of objects deduplicated, if any.
-// The provided |objects| array may have dead ops upon return.
-static int deduplicateObjects(Operation *scopeOp,
-                              ArrayRef<Operation *> allObjectOps) {
+// Returns a hash used to bucket objects that may be equivalent.
+// The hash only includes op names and result types and is independent of any
+// attribute values (such as constants).
+static uint32_t hashObjectForBucketing(Operation *objectOp) {
   // Bucket based on the hash of the names of at most the first 5 ops.
   // 5 was randomly chosen to be small enough to not increase overhead much,
   // but giving at least enough of a sample that there is some bucketing. This
   // was not empirically determined.
   constexpr int kMaxHashedOps = 5;
+  int count = 0;
+  llvm::hash_code hash(1);
+  objectOp->walk([&](Operation *it) {
+    hash = llvm::hash_combine(hash, it->getName());
+    hash = llvm::hash_combine(hash, it->getResultTypes());
+    return (++count >= kMaxHashedOps) ? WalkResult::interrupt()
+                                      : WalkResult::advance();
+  });
+  return hash_value(hash);
+}
+
+// Returns the total number of objects deduplicated, if any.
+// The provided |objects| array may have dead ops upon return.
+static int deduplicateObjects(Operation *scopeOp,
+                              ArrayRef<Operation *> allObjectOps) {
   llvm::MapVector<uint32_t, SmallVector<SymbolOpInterface>> objectMap;
   for (auto objectOp : allObjectOps) {
-    int count = 0;
-    llvm::hash_code hash(1);
-    objectOp->walk([&](Operation *it) {
-      hash = llvm::hash_combine(hash, it->getName());
-      hash = llvm::hash_combine(hash, it->getResultTypes());
-      return (++count >= kMaxHashedOps) ? WalkResult::interrupt()
-                                        : WalkResult::advance();
-    });
-    objectMap[hash_value(hash)].push_back(cast<SymbolOpInterface>(objectOp));
+    objectMap[hashObjectForBucketing(objectOp)].push_back(
+        cast<SymbolOpInterface>(objectOp));
   }
 
   // For each object find the first object which it is equivalent to and record
@@ -146,6 +159,338 @@ static int deduplicateObjects(Operation *scopeOp,
   return deadOps.size();
 }
 
+//===----------------------------------------------------------------------===//
+// Deduplication with hoisted constants
+//===----------------------------------------------------------------------===//
+
+// Returns the function exported by |executableOp| if it has exactly one export.
+static mlir::FunctionOpInterface
+getSingleExportedFunc(IREE::Flow::ExecutableOp executableOp) {
+  auto exportOps =
+      llvm::to_vector(executableOp.getOps<IREE::Flow::ExecutableExportOp>());
+  auto innerModuleOp = executableOp.getInnerModule();
+  if (exportOps.size() != 1 || !innerModuleOp) {
+    return {};
+  }
+  return innerModuleOp.lookupSymbol<mlir::FunctionOpInterface>(
+      exportOps.front().getFunctionRef());
+}
+
+// Returns true if |value| is used (directly or through arith ops) to compute
+// an index or a loop bound. Integer constants feeding shapes, offsets, and
+// loop bounds after an index_cast must remain static the same as index
+// constants.
+static bool feedsIndexComputation(Value value) {
+  SmallVector<Value> worklist = {value};
+  DenseSet<Value> visitedValues;
+  while (!worklist.empty()) {
+    Value currentValue = worklist.pop_back_val();
+    if (!visitedValues.insert(currentValue).second) {
+      continue;
+    }
+    for (Operation *userOp : currentValue.getUsers()) {
+      if (llvm::any_of(userOp->getResultTypes(), llvm::IsaPred<IndexType>)) {
+        return true;
+      }
+      if (auto loopOp = dyn_cast<LoopLikeOpInterface>(userOp)) {
+        for (auto bounds :
+             {loopOp.getLoopLowerBounds(), loopOp.getLoopUpperBounds(),
+              loopOp.getLoopSteps()}) {
+          if (bounds && llvm::any_of(*bounds, [&](OpFoldResult bound) {
+                return dyn_cast<Value>(bound) == currentValue;
+              })) {
+            return true;
+          }
+        }
+      }
+      if (isa_and_nonnull<arith::ArithDialect>(userOp->getDialect())) {
+        llvm::append_range(worklist, userOp->getResults());
+      }
+    }
+  }
+  return false;
+}
+
+// Returns true if |constantOp| within |funcOp| can be replaced with a dispatch
+// operand. Index constants and integer constants feeding index computation
+// are not hoisted as they commonly define shapes, offsets, and loop bounds
+// that codegen relies on being static.
+static bool isHoistableConstant(arith::ConstantOp constantOp,
+                                mlir::FunctionOpInterface funcOp) {
+  Type type = constantOp.getType();
+  if (!isa<IntegerType, FloatType>(type) ||
+      type.getIntOrFloatBitWidth() <= 1 || type.getIntOrFloatBitWidth() > 64) {
+    return false;
+  }
+  if (isa<IntegerType>(type) && feedsIndexComputation(constantOp.getResult())) {
+    return false;
+  }
+  // Function arguments are only visible to ops not isolated from above.
+  for (Operation *parentOp = constantOp->getParentOp();
+       parentOp != funcOp.getOperation(); parentOp = parentOp->getParentOp()) {
+    if (parentOp->hasTrait<OpTrait::IsIsolatedFromAbove>()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Returns all hoistable constants in |funcOp| in walk order.
+static SmallVector<arith::ConstantOp>
+gatherHoistableConstants(mlir::FunctionOpInterface funcOp) {
+  SmallVector<arith::ConstantOp> constantOps;
+  funcOp.walk([&](arith::ConstantOp constantOp) {
+    if (isHoistableConstant(constantOp, funcOp)) {
+      constantOps.push_back(constantOp);
+    }
+  });
+  return constantOps;
+}
+
+// An executable that may be merged with other executables differing only in
+// the values of scalar constants.
+struct HoistingCandidate {
+  IREE::Flow::ExecutableOp executableOp;
+  mlir::FunctionOpInterface funcOp;
+  // All dispatches of the executable. Each references only this executable.
+  SmallVector<IREE::Flow::DispatchOp> dispatchOps;
+  // Hoistable constants in the exported function in walk order.
+  SmallVector<arith::ConstantOp> constantOps;
+  // Clone of the executable with all hoistable constants set to zero used to
+  // compare executables independent of the constant values.
+  OwningOpRef<Operation *> normalizedOp;
+};
+
+// A reference executable and the executables that will be merged into it.
+struct HoistingGroup {
+  HoistingCandidate *reference = nullptr;
+  SmallVector<HoistingCandidate *> duplicates;
+  // Indices into the constantOps of each candidate that differ from the
+  // reference in at least one duplicate.
+  llvm::BitVector hoistedConstants;
+};
+
+// Gathers all executables that are only used by single-entry-point dispatches
+// and have hoistable constants into |candidates|.
+static void
+gatherHoistingCandidates(mlir::ModuleOp moduleOp,
+                         SmallVectorImpl<HoistingCandidate> &candidates) {
+  DenseMap<StringAttr, SmallVector<IREE::Flow::DispatchOp>> dispatchOpsMap;
+  DenseSet<StringAttr> ineligibleSymbols;
+  for (auto &op : moduleOp.getOps()) {
+    if (op.hasTrait<OpTrait::IREE::Util::ObjectLike>()) {
+      continue;
+    }
+    auto symbolUses = SymbolTable::getSymbolUses(&op);
+    if (!symbolUses) {
+      return; // unknown uses
+    }
+    for (auto &use : *symbolUses) {
+      auto rootRefAttr = use.getSymbolRef().getRootReference();
+      auto dispatchOp = dyn_cast<IREE::Flow::DispatchOp>(use.getUser());
+      if (dispatchOp && dispatchOp.getEntryPoints().size() == 1) {
+        dispatchOpsMap[rootRefAttr].push_back(dispatchOp);
+      } else {
+        ineligibleSymbols.insert(rootRefAttr);
+      }
+    }
+  }
+
+  for (auto executableOp : moduleOp.getOps<IREE::Flow::ExecutableOp>()) {
+    auto symNameAttr = executableOp.getSymNameAttr();
+    auto dispatchOpsIt = dispatchOpsMap.find(symNameAttr);
+    if (ineligibleSymbols.contains(symNameAttr) ||
+        dispatchOpsIt == dispatchOpsMap.end()) {
+      continue;
+    }
+    auto funcOp = getSingleExportedFunc(executableOp);
+    if (!funcOp) {
+      continue;
+    }
+    auto &dispatchOps = dispatchOpsIt->second;
+    size_t argumentCount = dispatchOps.front().getArguments().size();
+    if (llvm::any_of(dispatchOps, [&](IREE::Flow::DispatchOp dispatchOp) {
+          return dispatchOp.getArguments().size() != argumentCount;
+        })) {
+      continue;
+    }
+    auto constantOps = gatherHoistableConstants(funcOp);
+    if (constantOps.empty()) {
+      continue;
+    }
+
+    HoistingCandidate candidate;
+    candidate.executableOp = executableOp;
+    candidate.funcOp = funcOp;
+    candidate.dispatchOps = std::move(dispatchOps);
+    candidate.constantOps = std::move(constantOps);
+    candidate.normalizedOp = executableOp->clone();
+    auto normalizedFuncOp = getSingleExportedFunc(
+        cast<IREE::Flow::ExecutableOp>(candidate.normalizedOp.get()));
+    Builder builder(executableOp.getContext());
+    for (auto constantOp : gatherHoistableConstants(normalizedFuncOp)) {
+      constantOp.setValueAttr(builder.getZeroAttr(constantOp.getType()));
+    }
+    candidates.push_back(std::move(candidate));
+  }
+}
+
+// Returns true if |duplicate| can be merged into |group| and updates the set of
+// hoisted constants if so. At most |maxHoistedConstants| may be hoisted.
+static bool tryAddToGroup(OperationEquivalenceCache &equivalenceCache,
+                          HoistingGroup &group, HoistingCandidate &duplicate,
+                          unsigned maxHoistedConstants) {
+  HoistingCandidate &reference = *group.reference;
+  if (reference.constantOps.size() != duplicate.constantOps.size() ||
+      reference.dispatchOps.front().getArguments().size() !=
+          duplicate.dispatchOps.front().getArguments().size()) {
+    return false;
+  }
+  llvm::BitVector hoistedConstants = group.hoistedConstants;
+  for (auto [index, referenceOp, duplicateOp] : llvm::enumerate(
+           reference.constantOps, duplicate.constantOps)) {
+    if (referenceOp.getValue() != duplicateOp.getValue()) {
+      hoistedConstants.set(index);
+    }
+  }
+  if (hoistedConstants.count() > maxHoistedConstants) {
+    return false;
+  }
+  if (!isStructurallyEquivalentTo(equivalenceCache, *duplicate.normalizedOp,
+                                  *reference.normalizedOp)) {
+    return false;
+  }
+  group.hoistedConstants = std::move(hoistedConstants);
+  group.duplicates.push_back(&duplicate);
+  return true;
+}
+
+// Hoists the constants that differ within |group| into dispatch operands of
+// the reference executable and redirects all dispatches to it.
+static LogicalResult
+mergeHoistingGroup(HoistingGroup &group,
+                   DenseMap<Attribute, SymbolRefAttr> &symbolReplacements,
+                   SmallVectorImpl<Operation *> &deadOps) {
+  HoistingCandidate &reference = *group.reference;
+  auto funcOp = reference.funcOp;
+
+  // New function arguments are inserted after those corresponding to the
+  // dispatch operands and before any result bindings.
+  unsigned argIndex = reference.dispatchOps.front().getArguments().size();
+  SmallVector<unsigned> argIndices;
+  SmallVector<Type> argTypes;
+  SmallVector<DictionaryAttr> argAttrs;
+  SmallVector<Location> argLocs;
+  for (unsigned index : group.hoistedConstants.set_bits()) {
+    auto constantOp = reference.constantOps[index];
+    argIndices.push_back(argIndex);
+    argTypes.push_back(constantOp.getType());
+    argAttrs.push_back(DictionaryAttr::get(funcOp.getContext()));
+    argLocs.push_back(constantOp.getLoc());
+  }
+  if (failed(funcOp.insertArguments(argIndices, argTypes, argAttrs, argLocs))) {
+    return failure();
+  }
+
+  // Pass the original constant values of each executable at its dispatch
+  // sites.
+  auto appendDispatchOperands = [&](HoistingCandidate &candidate) {
+    for (auto dispatchOp : candidate.dispatchOps) {
+      OpBuilder builder(dispatchOp);
+      SmallVector<Value> operands;
+      for (unsigned index : group.hoistedConstants.set_bits()) {
+        auto constantOp = candidate.constantOps[index];
+        operands.push_back(builder.create<arith::ConstantOp>(
+            constantOp.getLoc(), constantOp.getValue()));
+      }
+      dispatchOp.getArgumentsMutable().append(operands);
+    }
+  };
+  appendDispatchOperands(reference);
+  for (auto *duplicate : group.duplicates) {
+    appendDispatchOperands(*duplicate);
+  }
+
+  for (auto [argOffset, index] :
+       llvm::enumerate(group.hoistedConstants.set_bits())) {
+    auto constantOp = reference.constantOps[index];
+    constantOp.replaceAllUsesWith(funcOp.getArgument(argIndex + argOffset));
+    constantOp.erase();
+  }
+
+  for (auto *duplicate : group.duplicates) {
+    auto duplicateOp =
+        cast<SymbolOpInterface>(duplicate->executableOp.getOperation());
+    auto referenceOp =
+        cast<SymbolOpInterface>(reference.executableOp.getOperation());
+    gatherReplacements(SymbolRefAttr::get(duplicateOp),
+                       duplicateOp->getRegions(),
+                       SymbolRefAttr::get(referenceOp),
+                       referenceOp->getRegions(), symbolReplacements);
+    deadOps.push_back(duplicateOp);
+  }
+  return success();
+}
+
+// Merges executables that differ only in the values of scalar constants by
+// hoisting the differing constants into dispatch operands. Transformer models
+// in particular produce many dispatches that only differ in scale factors or
+// epsilon values. At most |maxHoistedConstants| are hoisted per executable.
+// Returns the total number of objects deduplicated, if any.
+static FailureOr<int>
+deduplicateObjectsWithHoistedConstants(mlir::ModuleOp moduleOp,
+                                       unsigned maxHoistedConstants) {
+  SmallVector<HoistingCandidate> candidates;
+  gatherHoistingCandidates(moduleOp, candidates);
+  if (candidates.size() < 2) {
+    return 0;
+  }
+
+  llvm::MapVector<uint32_t, SmallVector<HoistingCandidate *>> candidateMap;
+  for (auto &candidate : candidates) {
+    candidateMap[hashObjectForBucketing(candidate.executableOp)].push_back(
+        &candidate);
+  }
+
+  OperationEquivalenceCache equivalenceCache(moduleOp.getContext());
+  DenseMap<Attribute, SymbolRefAttr> symbolReplacements;
+  SmallVector<Operation *> deadOps;
+  for (auto &[key, bucketCandidates] : candidateMap) {
+    (void)key;
+    SmallVector<HoistingGroup> groups;
+    for (auto *candidate : bucketCandidates) {
+      bool didAdd = false;
+      for (auto &group : groups) {
+        if (tryAddToGroup(equivalenceCache, group, *candidate,
+                          maxHoistedConstants)) {
+          didAdd = true;
+          break;
+        }
+      }
+      if (!didAdd) {
+        HoistingGroup group;
+        group.reference = candidate;
+        group.hoistedConstants.resize(candidate->constantOps.size());
+        groups.push_back(std::move(group));
+      }
+    }
+    for (auto &group : groups) {
+      if (group.duplicates.empty()) {
+        continue;
+      }
+      if (failed(mergeHoistingGroup(group, symbolReplacements, deadOps))) {
+        return failure();
+      }
+    }
+  }
+
+  replaceSymbolRefs(moduleOp, symbolReplacements);
+  for (auto *op : deadOps) {
+    op->erase();
+  }
+  return static_cast<int>(deadOps.size());
+}
+
 } // namespace
 
 class DeduplicateExecutablesPass
@@ -162,6 +507,11 @@ class DeduplicateExecutablesPass
     if (allObjects.empty())
       return;
     (void)deduplicateObjects(moduleOp, allObjects);
+    if (maxHoistedConstants > 0 &&
+        failed(deduplicateObjectsWithHoistedConstants(moduleOp,
+                                                      maxHoistedConstants))) {
+      return signalPassFailure();
+    }
     // totalObjects = allObjects.size();
     // objectsDeduplicated = deduplicateObjects(moduleOp, allObjects);
     // remainingObjects = totalObjects - objectsDeduplicated;
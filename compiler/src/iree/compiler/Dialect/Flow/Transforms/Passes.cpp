@@ -63,6 +63,14 @@ static llvm::cl::opt<std::string> clDumpDispatchGraphOutputFile(
     llvm::cl::desc("Output file name for a dispatch graph dump."),
     llvm::cl::init("dispatch.dot"));
 
+static llvm::cl::opt<unsigned> clDeduplicateMaxHoistedConstants(
+    "iree-flow-deduplicate-max-hoisted-constants",
+    llvm::cl::desc(
+        "Maximum number of differing scalar constants hoisted into dispatch "
+        "operands to merge executables that are otherwise identical. 0 only "
+        "merges identical executables."),
+    llvm::cl::init(0));
+
 static llvm::cl::opt<bool> clZeroFillEmptyTensors(
     "iree-flow-zero-fill-empty-tensors",
     llvm::cl::desc(
@@ -158,10 +166,12 @@ void buildFlowTransformPassPipeline(OpPassManager &passManager,
   FunctionLikeNest(passManager).addPass(IREE::Flow::createCanonicalizePass);
 
   // Deduplicate executables created from dispatch regions.
-  // Note: this only deduplicates equivalent executables. We could in addition
-  // generalize executables to prune further (e.g. by promoting a dimension to
-  // an argument if two executables differ only in that one dimension).
-  passManager.addPass(IREE::Flow::createDeduplicateExecutablesPass());
+  // Note: this deduplicates equivalent executables and those differing only in
+  // scalar constants. We could in addition generalize executables to prune
+  // further (e.g. by promoting a dimension to an argument if two executables
+  // differ only in that one dimension).
+  passManager.addPass(IREE::Flow::createDeduplicateExecutablesPass(
+      DeduplicateExecutablesPassOptions{clDeduplicateMaxHoistedConstants}));
 
   // Create one function per exported program entry point that can be used with
   // iree-benchmark-module to benchmark each function individually. Whether
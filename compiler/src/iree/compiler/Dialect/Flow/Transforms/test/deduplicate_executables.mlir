@@ -1,4 +1,5 @@
-// RUN: iree-opt --split-input-file --iree-flow-deduplicate-executables %s | FileCheck %s
+// RUN: iree-opt --split-input-file --iree-flow-deduplicate-executables="max-hoisted-constants=4" %s | FileCheck %s
+// RUN: iree-opt --split-input-file --iree-flow-deduplicate-executables %s | FileCheck %s --check-prefix=DEFAULT
 
 // CHECK-LABEL: flow.executable public @single_executable_ex_0
 flow.executable public @single_executable_ex_0 {
@@ -421,3 +422,180 @@ util.func public @dispatch_variants(%arg0: tensor<4xf32>) -> tensor<4xf32> {
   %1 = flow.dispatch @ex1::@variant::@dispatch[%c4](%arg0) : (tensor<4xf32>) -> tensor<4xf32>
   util.return %1 : tensor<4xf32>
 }
+
+// -----
+
+// Executables differing only in scalar constants are merged by hoisting the
+// differing constants into dispatch operands inserted before result bindings.
+
+// Constants are only hoisted when enabled.
+// DEFAULT-LABEL: flow.executable private @hoisted_constants_ex_0
+// DEFAULT: flow.executable private @hoisted_constants_ex_1
+
+// CHECK-LABEL: flow.executable private @hoisted_constants_ex_0
+flow.executable private @hoisted_constants_ex_0 {
+  flow.executable.export public @hoisted_constants_entry_0
+  builtin.module {
+    // CHECK: func.func @hoisted_constants_entry_0(
+    // CHECK-SAME: %[[INPUT:[a-z0-9]+]]: !iree_tensor_ext.dispatch.tensor<readonly:tensor<4xf32>>
+    // CHECK-SAME: %[[SCALE:[a-z0-9]+]]: f32
+    // CHECK-SAME: %[[OUTPUT:[a-z0-9]+]]: !iree_tensor_ext.dispatch.tensor<writeonly:tensor<4xf32>>
+    func.func @hoisted_constants_entry_0(%arg0: !iree_tensor_ext.dispatch.tensor<readonly:tensor<4xf32>>, %arg1: !iree_tensor_ext.dispatch.tensor<writeonly:tensor<4xf32>>) {
+      // CHECK: %[[BIAS:.+]] = arith.constant 1.000000e+00 : f32
+      // CHECK-NOT: arith.constant 2.000000e+00
+      %scale = arith.constant 2.000000e+00 : f32
+      %bias = arith.constant 1.000000e+00 : f32
+      %0 = iree_tensor_ext.dispatch.tensor.load %arg0, offsets = [0], sizes = [4], strides = [1] : !iree_tensor_ext.dispatch.tensor<readonly:tensor<4xf32>> -> tensor<4xf32>
+      // CHECK: tensor.splat %[[SCALE]]
+      %1 = tensor.splat %scale : tensor<4xf32>
+      %2 = tensor.splat %bias : tensor<4xf32>
+      %3 = arith.mulf %0, %1 : tensor<4xf32>
+      %4 = arith.addf %3, %2 : tensor<4xf32>
+      iree_tensor_ext.dispatch.tensor.store %4, %arg1, offsets = [0], sizes = [4], strides = [1] : tensor<4xf32> -> !iree_tensor_ext.dispatch.tensor<writeonly:tensor<4xf32>>
+      return
+    }
+  }
+}
+// CHECK-NOT: flow.executable private @hoisted_constants_ex_1
+flow.executable private @hoisted_constants_ex_1 {
+  flow.executable.export public @hoisted_constants_entry_1
+  builtin.module {
+    func.func @hoisted_constants_entry_1(%arg0: !iree_tensor_ext.dispatch.tensor<readonly:tensor<4xf32>>, %arg1: !iree_tensor_ext.dispatch.tensor<writeonly:tensor<4xf32>>) {
+      %scale = arith.constant 3.000000e+00 : f32
+      %bias = arith.constant 1.000000e+00 : f32
+      %0 = iree_tensor_ext.dispatch.tensor.load %arg0, offsets = [0], sizes = [4], strides = [1] : !iree_tensor_ext.dispatch.tensor<readonly:tensor<4xf32>> -> tensor<4xf32>
+      %1 = tensor.splat %scale : tensor<4xf32>
+      %2 = tensor.splat %bias : tensor<4xf32>
+      %3 = arith.mulf %0, %1 : tensor<4xf32>
+      %4 = arith.addf %3, %2 : tensor<4xf32>
+      iree_tensor_ext.dispatch.tensor.store %4, %arg1, offsets = [0], sizes = [4], strides = [1] : tensor<4xf32> -> !iree_tensor_ext.dispatch.tensor<writeonly:tensor<4xf32>>
+      return
+    }
+  }
+}
+// Index constants are not hoisted.
+// CHECK-LABEL: flow.executable private @hoisted_constants_ex_2
+flow.executable private @hoisted_constants_ex_2 {
+  flow.executable.export public @hoisted_constants_entry_2
+  builtin.module {
+    func.func @hoisted_constants_entry_2(%arg0: !iree_tensor_ext.dispatch.tensor<readonly:tensor<8xf32>>, %arg1: !iree_tensor_ext.dispatch.tensor<writeonly:tensor<4xf32>>) {
+      %offset = arith.constant 4 : index
+      %0 = iree_tensor_ext.dispatch.tensor.load %arg0, offsets = [%offset], sizes = [4], strides = [1] : !iree_tensor_ext.dispatch.tensor<readonly:tensor<8xf32>> -> tensor<4xf32>
+      iree_tensor_ext.dispatch.tensor.store %0, %arg1, offsets = [0], sizes = [4], strides = [1] : tensor<4xf32> -> !iree_tensor_ext.dispatch.tensor<writeonly:tensor<4xf32>>
+      return
+    }
+  }
+}
+// CHECK-LABEL: flow.executable private @hoisted_constants_ex_3
+flow.executable private @hoisted_constants_ex_3 {
+  flow.executable.export public @hoisted_constants_entry_3
+  builtin.module {
+    func.func @hoisted_constants_entry_3(%arg0: !iree_tensor_ext.dispatch.tensor<readonly:tensor<8xf32>>, %arg1: !iree_tensor_ext.dispatch.tensor<writeonly:tensor<4xf32>>) {
+      %offset = arith.constant 2 : index
+      %0 = iree_tensor_ext.dispatch.tensor.load %arg0, offsets = [%offset], sizes = [4], strides = [1] : !iree_tensor_ext.dispatch.tensor<readonly:tensor<8xf32>> -> tensor<4xf32>
+      iree_tensor_ext.dispatch.tensor.store %0, %arg1, offsets = [0], sizes = [4], strides = [1] : tensor<4xf32> -> !iree_tensor_ext.dispatch.tensor<writeonly:tensor<4xf32>>
+      return
+    }
+  }
+}
+// CHECK-LABEL: util.func public @hoisted_constants
+// CHECK-SAME: (%[[ARG0:.+]]: tensor<4xf32>, %[[ARG1:.+]]: tensor<8xf32>)
+util.func public @hoisted_constants(%arg0: tensor<4xf32>, %arg1: tensor<8xf32>) {
+  %c4 = arith.constant 4 : index
+  // CHECK: %[[SCALE0:.+]] = arith.constant 2.000000e+00 : f32
+  // CHECK: flow.dispatch @hoisted_constants_ex_0::@hoisted_constants_entry_0[%c4](%[[ARG0]], %[[SCALE0]]) : (tensor<4xf32>, f32) -> tensor<4xf32>
+  %0 = flow.dispatch @hoisted_constants_ex_0::@hoisted_constants_entry_0[%c4](%arg0) : (tensor<4xf32>) -> tensor<4xf32>
+  // CHECK: %[[SCALE1:.+]] = arith.constant 3.000000e+00 : f32
+  // CHECK: flow.dispatch @hoisted_constants_ex_0::@hoisted_constants_entry_0[%c4](%[[ARG0]], %[[SCALE1]]) : (tensor<4xf32>, f32) -> tensor<4xf32>
+  %1 = flow.dispatch @hoisted_constants_ex_1::@hoisted_constants_entry_1[%c4](%arg0) : (tensor<4xf32>) -> tensor<4xf32>
+  // CHECK: flow.dispatch @hoisted_constants_ex_2::@hoisted_constants_entry_2[%c4](%[[ARG1]]) : (tensor<8xf32>) -> tensor<4xf32>
+  %2 = flow.dispatch @hoisted_constants_ex_2::@hoisted_constants_entry_2[%c4](%arg1) : (tensor<8xf32>) -> tensor<4xf32>
+  // CHECK: flow.dispatch @hoisted_constants_ex_3::@hoisted_constants_entry_3[%c4](%[[ARG1]]) : (tensor<8xf32>) -> tensor<4xf32>
+  %3 = flow.dispatch @hoisted_constants_ex_3::@hoisted_constants_entry_3[%c4](%arg1) : (tensor<8xf32>) -> tensor<4xf32>
+  util.return
+}
+
+// -----
+
+// Integer constants only used as data are hoisted.
+
+// CHECK-LABEL: flow.executable private @hoisted_int_ex_0
+flow.executable private @hoisted_int_ex_0 {
+  flow.executable.export public @hoisted_int_entry_0
+  builtin.module {
+    // CHECK: func.func @hoisted_int_entry_0(
+    // CHECK-SAME: %[[INPUT:[a-z0-9]+]]: !iree_tensor_ext.dispatch.tensor<readonly:tensor<4xi32>>
+    // CHECK-SAME: %[[BIAS:[a-z0-9]+]]: i32
+    // CHECK-SAME: %[[OUTPUT:[a-z0-9]+]]: !iree_tensor_ext.dispatch.tensor<writeonly:tensor<4xi32>>
+    func.func @hoisted_int_entry_0(%arg0: !iree_tensor_ext.dispatch.tensor<readonly:tensor<4xi32>>, %arg1: !iree_tensor_ext.dispatch.tensor<writeonly:tensor<4xi32>>) {
+      // CHECK-NOT: arith.constant 7 : i32
+      %bias = arith.constant 7 : i32
+      %0 = iree_tensor_ext.dispatch.tensor.load %arg0, offsets = [0], sizes = [4], strides = [1] : !iree_tensor_ext.dispatch.tensor<readonly:tensor<4xi32>> -> tensor<4xi32>
+      // CHECK: tensor.splat %[[BIAS]]
+      %1 = tensor.splat %bias : tensor<4xi32>
+      %2 = arith.addi %0, %1 : tensor<4xi32>
+      iree_tensor_ext.dispatch.tensor.store %2, %arg1, offsets = [0], sizes = [4], strides = [1] : tensor<4xi32> -> !iree_tensor_ext.dispatch.tensor<writeonly:tensor<4xi32>>
+      return
+    }
+  }
+}
+// CHECK-NOT: flow.executable private @hoisted_int_ex_1
+flow.executable private @hoisted_int_ex_1 {
+  flow.executable.export public @hoisted_int_entry_1
+  builtin.module {
+    func.func @hoisted_int_entry_1(%arg0: !iree_tensor_ext.dispatch.tensor<readonly:tensor<4xi32>>, %arg1: !iree_tensor_ext.dispatch.tensor<writeonly:tensor<4xi32>>) {
+      %bias = arith.constant 9 : i32
+      %0 = iree_tensor_ext.dispatch.tensor.load %arg0, offsets = [0], sizes = [4], strides = [1] : !iree_tensor_ext.dispatch.tensor<readonly:tensor<4xi32>> -> tensor<4xi32>
+      %1 = tensor.splat %bias : tensor<4xi32>
+      %2 = arith.addi %0, %1 : tensor<4xi32>
+      iree_tensor_ext.dispatch.tensor.store %2, %arg1, offsets = [0], sizes = [4], strides = [1] : tensor<4xi32> -> !iree_tensor_ext.dispatch.tensor<writeonly:tensor<4xi32>>
+      return
+    }
+  }
+}
+// Integer constants feeding offsets through an index_cast are not hoisted.
+// CHECK-LABEL: flow.executable private @hoisted_int_ex_2
+flow.executable private @hoisted_int_ex_2 {
+  flow.executable.export public @hoisted_int_entry_2
+  builtin.module {
+    // CHECK: func.func @hoisted_int_entry_2(%{{.+}}: !iree_tensor_ext.dispatch.tensor<readonly:tensor<8xi32>>, %{{.+}}: !iree_tensor_ext.dispatch.tensor<writeonly:tensor<4xi32>>)
+    // CHECK: arith.constant 4 : i32
+    func.func @hoisted_int_entry_2(%arg0: !iree_tensor_ext.dispatch.tensor<readonly:tensor<8xi32>>, %arg1: !iree_tensor_ext.dispatch.tensor<writeonly:tensor<4xi32>>) {
+      %c4_i32 = arith.constant 4 : i32
+      %offset = arith.index_cast %c4_i32 : i32 to index
+      %0 = iree_tensor_ext.dispatch.tensor.load %arg0, offsets = [%offset], sizes = [4], strides = [1] : !iree_tensor_ext.dispatch.tensor<readonly:tensor<8xi32>> -> tensor<4xi32>
+      iree_tensor_ext.dispatch.tensor.store %0, %arg1, offsets = [0], sizes = [4], strides = [1] : tensor<4xi32> -> !iree_tensor_ext.dispatch.tensor<writeonly:tensor<4xi32>>
+      return
+    }
+  }
+}
+// CHECK-LABEL: flow.executable private @hoisted_int_ex_3
+flow.executable private @hoisted_int_ex_3 {
+  flow.executable.export public @hoisted_int_entry_3
+  builtin.module {
+    // CHECK: arith.constant 2 : i32
+    func.func @hoisted_int_entry_3(%arg0: !iree_tensor_ext.dispatch.tensor<readonly:tensor<8xi32>>, %arg1: !iree_tensor_ext.dispatch.tensor<writeonly:tensor<4xi32>>) {
+      %c2_i32 = arith.constant 2 : i32
+      %offset = arith.index_cast %c2_i32 : i32 to index
+      %0 = iree_tensor_ext.dispatch.tensor.load %arg0, offsets = [%offset], sizes = [4], strides = [1] : !iree_tensor_ext.dispatch.tensor<readonly:tensor<8xi32>> -> tensor<4xi32>
+      iree_tensor_ext.dispatch.tensor.store %0, %arg1, offsets = [0], sizes = [4], strides = [1] : tensor<4xi32> -> !iree_tensor_ext.dispatch.tensor<writeonly:tensor<4xi32>>
+      return
+    }
+  }
+}
+// CHECK-LABEL: util.func public @hoisted_int
+// CHECK-SAME: (%[[ARG0:.+]]: tensor<4xi32>, %[[ARG1:.+]]: tensor<8xi32>)
+util.func public @hoisted_int(%arg0: tensor<4xi32>, %arg1: tensor<8xi32>) {
+  %c4 = arith.constant 4 : index
+  // CHECK: %[[BIAS0:.+]] = arith.constant 7 : i32
+  // CHECK: flow.dispatch @hoisted_int_ex_0::@hoisted_int_entry_0[%c4](%[[ARG0]], %[[BIAS0]]) : (tensor<4xi32>, i32) -> tensor<4xi32>
+  %0 = flow.dispatch @hoisted_int_ex_0::@hoisted_int_entry_0[%c4](%arg0) : (tensor<4xi32>) -> tensor<4xi32>
+  // CHECK: %[[BIAS1:.+]] = arith.constant 9 : i32
+  // CHECK: flow.dispatch @hoisted_int_ex_0::@hoisted_int_entry_0[%c4](%[[ARG0]], %[[BIAS1]]) : (tensor<4xi32>, i32) -> tensor<4xi32>
+  %1 = flow.dispatch @hoisted_int_ex_1::@hoisted_int_entry_1[%c4](%arg0) : (tensor<4xi32>) -> tensor<4xi32>
+  // CHECK: flow.dispatch @hoisted_int_ex_2::@hoisted_int_entry_2[%c4](%[[ARG1]]) : (tensor<8xi32>) -> tensor<4xi32>
+  %2 = flow.dispatch @hoisted_int_ex_2::@hoisted_int_entry_2[%c4](%arg1) : (tensor<8xi32>) -> tensor<4xi32>
+  // CHECK: flow.dispatch @hoisted_int_ex_3::@hoisted_int_entry_3[%c4](%[[ARG1]]) : (tensor<8xi32>) -> tensor<4xi32>
+  %3 = flow.dispatch @hoisted_int_ex_3::@hoisted_int_entry_3[%c4](%arg1) : (tensor<8xi32>) -> tensor<4xi32>
+  util.return
+}
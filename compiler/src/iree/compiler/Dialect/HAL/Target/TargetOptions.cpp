@@ -93,6 +93,26 @@ void TargetOptions::bindOptions(OptionsBinder &binder) {
       llvm::cl::desc(
           "Path to write translated and serialized executable binaries into."),
       llvm::cl::cat(halTargetOptionsCategory));
+
+  binder.opt<std::string>(
+      "iree-hal-executable-cache-dir", executableCachePath,
+      llvm::cl::desc(
+          "Directory of a content-addressed cache of translated and serialized "
+          "executables. Executables identical to ones translated in previous "
+          "compilations with the same compiler build, flags, and flag input "
+          "files reuse the cached results. Debug locations in cached results "
+          "refer to the compilation that populated the cache. Ignored if the "
+          "compiler build or a flag input file cannot be identified."),
+      llvm::cl::cat(halTargetOptionsCategory));
+
+  binder.opt<std::string>(
+      "iree-hal-executable-cache-key", executableCacheKey,
+      llvm::cl::desc(
+          "Additional key mixed into all executable cache entries. The "
+          "compiler build and flags are included automatically when "
+          "compiling through the compiler API and this only needs to capture "
+          "state outside of the compiler (such as linked tool versions)."),
+      llvm::cl::cat(halTargetOptionsCategory));
 }
 
 } // namespace mlir::iree_compiler::IREE::HAL
@@ -76,6 +76,15 @@ struct TargetOptions {
   // A path to write translated and serialized executable binaries into.
   std::string executableBinariesPath;
 
+  // A directory holding a content-addressed cache of translated and serialized
+  // executables shared across compilations. Disabled if empty.
+  std::string executableCachePath;
+
+  // Key mixed into all executable cache entries. Must capture anything that
+  // changes translation and serialization results outside of the executable
+  // IR itself such as the compiler revision and flags.
+  std::string executableCacheKey;
+
   void bindOptions(OptionsBinder &binder);
   using FromFlags = OptionsFromFlags<TargetOptions>;
 };
@@ -4,6 +4,7 @@
 // See https://llvm.org/LICENSE.txt for license information.
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
+#include <deque>
 #include <utility>
 
 #include "iree/compiler/Dialect/HAL/Analysis/Captures.h"
@@ -12,6 +13,7 @@
 #include "iree/compiler/Dialect/HAL/IR/HALOps.h"
 #include "iree/compiler/Dialect/HAL/Transforms/Passes.h"
 #include "iree/compiler/Dialect/Util/IR/UtilDialect.h"
+#include "iree/compiler/Utils/EquivalenceUtils.h"
 #include "iree/compiler/Utils/StringUtils.h"
 #include "llvm/Support/Debug.h"
 #include "mlir/Dialect/Arith/IR/Arith.h"
@@ -508,52 +510,111 @@ static void replaceMemoizeOpWithLookup(IREE::HAL::DeviceMemoizeOp memoizeOp,
   memoizeOp.erase();
 }
 
+// A hal.device.memoize op that can be memoized at initialization time.
+struct MemoizeSite {
+  IREE::HAL::DeviceMemoizeOp memoizeOp;
+  MemoizeAnalysis memoizeAnalysis;
+  // All devices the op may be memoized for.
+  SmallVector<IREE::Util::GlobalOpInterface> deviceGlobals;
+};
+
+// Returns true if the captured |lhs| and |rhs| values are guaranteed to have
+// the same value at initialization time.
+static bool isEquivalentCapturedValue(Value lhs, Value rhs) {
+  if (lhs.getType() != rhs.getType()) {
+    return false;
+  }
+  Attribute lhsAttr;
+  Attribute rhsAttr;
+  if (matchPattern(lhs, m_Constant(&lhsAttr)) &&
+      matchPattern(rhs, m_Constant(&rhsAttr))) {
+    return lhsAttr == rhsAttr;
+  }
+  auto lhsLoadOp = lhs.getDefiningOp<IREE::Util::GlobalLoadOpInterface>();
+  auto rhsLoadOp = rhs.getDefiningOp<IREE::Util::GlobalLoadOpInterface>();
+  return lhsLoadOp && rhsLoadOp &&
+         lhsLoadOp.getGlobalName() == rhsLoadOp.getGlobalName();
+}
+
+// Returns true if |lhs| and |rhs| would produce the same results when
+// memoized: they must be memoized for the same devices and affinity, capture
+// the same constants and globals, and have structurally equivalent regions.
+//
+// This is what allows the command buffers of repeated execution regions (such
+// as the layers of a model) to be recorded once: resources that differ
+// between the sites are passed via binding tables at queue execution time and
+// are not captured by the memoize region.
+static bool isEquivalentMemoizeSite(OperationEquivalenceCache &cache,
+                                    MemoizeSite &lhs, MemoizeSite &rhs) {
+  auto lhsOp = lhs.memoizeOp;
+  auto rhsOp = rhs.memoizeOp;
+  if (!llvm::equal(lhsOp.getResultTypes(), rhsOp.getResultTypes()) ||
+      lhs.memoizeAnalysis.queueAffinity != rhs.memoizeAnalysis.queueAffinity ||
+      lhs.deviceGlobals != rhs.deviceGlobals ||
+      lhs.memoizeAnalysis.constantValues.size() !=
+          rhs.memoizeAnalysis.constantValues.size() ||
+      lhs.memoizeAnalysis.globalValues.size() !=
+          rhs.memoizeAnalysis.globalValues.size()) {
+    return false;
+  }
+
+  // Seed the mapping with the captured values so that their uses within the
+  // regions can be compared.
+  auto mapping = cache.acquireMapping();
+  mapping->map(lhsOp.getDevice(), rhsOp.getDevice());
+  mapping->map(lhsOp.getQueueAffinity(), rhsOp.getQueueAffinity());
+  auto mapCapturedValues = [&](const SetVector<Value> &lhsValues,
+                               const SetVector<Value> &rhsValues) {
+    for (auto [lhsValue, rhsValue] : llvm::zip_equal(lhsValues, rhsValues)) {
+      if (!isEquivalentCapturedValue(lhsValue, rhsValue)) {
+        return false;
+      }
+      mapping->map(lhsValue, rhsValue);
+    }
+    return true;
+  };
+  if (!mapCapturedValues(lhs.memoizeAnalysis.constantValues,
+                         rhs.memoizeAnalysis.constantValues) ||
+      !mapCapturedValues(lhs.memoizeAnalysis.globalValues,
+                         rhs.memoizeAnalysis.globalValues)) {
+    return false;
+  }
+  return isStructurallyEquivalentTo(cache, lhsOp.getBody(), rhsOp.getBody(),
+                                    *mapping);
+}
+// Outlines a |memoizeOp| that cannot be memoized and replaces it with an
+// inline call to the outlined apply function.
+static void outlineRegionOp(IREE::HAL::DeviceMemoizeOp memoizeOp,
+                            MemoizeAnalysis &memoizeAnalysis,
+                            SymbolTable &moduleSymbolTable) {
+  auto parentFuncOp = memoizeOp->getParentOfType<FunctionOpInterface>();
+  OpBuilder moduleBuilder(parentFuncOp);
+  auto applyFuncOp = outlineMemoizeRegionBody(memoizeOp, memoizeAnalysis,
+                                              moduleSymbolTable, moduleBuilder);
+  replaceMemoizeOpWithApply(memoizeOp, memoizeAnalysis, applyFuncOp);
+}
+
 // Creates globals to store memoized per-device results, an initializer to
 // perform the memoization by calling an outlined apply function, and replaces
-// the |memoizeOp| with a lookup function that can be used to get the
-// appropriate per-device results. If the op cannot be memoized then it is
-// replaced with an inline call to the outlined apply function.
-static void memoizeRegionOp(IREE::HAL::DeviceMemoizeOp memoizeOp,
-                            DeviceAnalysis &deviceAnalysis,
-                            SymbolTable &moduleSymbolTable) {
+// all |sites| with a lookup function that can be used to get the appropriate
+// per-device results. All sites must be equivalent and share the results
+// memoized for the first.
+static void memoizeRegionOps(ArrayRef<MemoizeSite *> sites,
+                             SymbolTable &moduleSymbolTable) {
   // Outline the memoize region to a function.
-  auto memoizeAnalysis = computeMemoizeAnalysis(memoizeOp);
+  auto &leaderSite = *sites.front();
+  auto memoizeOp = leaderSite.memoizeOp;
+  auto &memoizeAnalysis = leaderSite.memoizeAnalysis;
   auto parentFuncOp = memoizeOp->getParentOfType<FunctionOpInterface>();
   OpBuilder moduleBuilder(parentFuncOp);
   auto applyFuncOp = outlineMemoizeRegionBody(memoizeOp, memoizeAnalysis,
                                               moduleSymbolTable, moduleBuilder);
 
-  // If we can't memoize the resources at initialization time then we need
-  // to do it on-demand.
-  if (!memoizeAnalysis.canRunAtInitializationTime()) {
-    LLVM_DEBUG({
-      llvm::dbgs()
-          << "memoization failed: dynamic values captured at the call site\n";
-      memoizeOp.dump();
-    });
-    replaceMemoizeOpWithApply(memoizeOp, memoizeAnalysis, applyFuncOp);
-    return;
-  }
-
-  // To memoize we must be able to figure out which devices the op is being
-  // memoized for.
-  auto deviceGlobals =
-      deviceAnalysis.lookupDeviceGlobals(memoizeOp.getDevice());
-  if (!deviceGlobals) {
-    LLVM_DEBUG({
-      llvm::dbgs() << "memoization failed: unable to analyze devices that may "
-                      "be used with memoized region\n";
-      memoizeOp.dump();
-    });
-    replaceMemoizeOpWithApply(memoizeOp, memoizeAnalysis, applyFuncOp);
-    return;
-  }
-
   // Create globals storing the memoized results for each device and an
   // initializer per device that runs the apply function to produce their
   // values.
   DeviceResultMap deviceResultMap;
-  for (auto deviceGlobal : deviceGlobals.value()) {
+  for (auto deviceGlobal : leaderSite.deviceGlobals) {
     deviceResultMap[deviceGlobal] = createMemoizedDeviceGlobals(
         memoizeOp, memoizeAnalysis, applyFuncOp, deviceGlobal,
         moduleSymbolTable, moduleBuilder);
@@ -564,8 +625,11 @@ static void memoizeRegionOp(IREE::HAL::DeviceMemoizeOp memoizeOp,
       createLookupFunc(memoizeOp, memoizeAnalysis, applyFuncOp, deviceResultMap,
                        moduleSymbolTable, moduleBuilder);
 
-  // Replace the memoize op with a call to the lookup function.
-  replaceMemoizeOpWithLookup(memoizeOp, memoizeAnalysis, lookupFuncOp);
+  // Replace the memoize ops with calls to the lookup function.
+  for (auto *site : sites) {
+    replaceMemoizeOpWithLookup(site->memoizeOp, site->memoizeAnalysis,
+                               lookupFuncOp);
+  }
 }
 
 struct OutlineMemoizeRegionsPass
@@ -589,11 +653,73 @@ struct OutlineMemoizeRegionsPass
       });
     }
 
-    // Try to outline all memoize ops. Some may fail analysis and be inlined.
+    // Analyze all memoize ops. Those that fail analysis are outlined and
+    // called inline each time they are reached.
     auto &moduleSymbolTable =
         deviceAnalysis.getExplorer().getSymbolTables().getSymbolTable(moduleOp);
+    std::deque<MemoizeSite> sites;
     for (auto memoizeOp : memoizeOps) {
-      memoizeRegionOp(memoizeOp, deviceAnalysis, moduleSymbolTable);
+      auto memoizeAnalysis = computeMemoizeAnalysis(memoizeOp);
+
+      // If we can't memoize the resources at initialization time then we need
+      // to do it on-demand.
+      if (!memoizeAnalysis.canRunAtInitializationTime()) {
+        LLVM_DEBUG({
+          llvm::dbgs() << "memoization failed: dynamic values captured at the "
+                          "call site\n";
+          memoizeOp.dump();
+        });
+        outlineRegionOp(memoizeOp, memoizeAnalysis, moduleSymbolTable);
+        continue;
+      }
+
+      // To memoize we must be able to figure out which devices the op is being
+      // memoized for.
+      auto deviceGlobals =
+          deviceAnalysis.lookupDeviceGlobals(memoizeOp.getDevice());
+      if (!deviceGlobals) {
+        LLVM_DEBUG({
+          llvm::dbgs() << "memoization failed: unable to analyze devices that "
+                          "may be used with memoized region\n";
+          memoizeOp.dump();
+        });
+        outlineRegionOp(memoizeOp, memoizeAnalysis, moduleSymbolTable);
+        continue;
+      }
+
+      sites.push_back(MemoizeSite{memoizeOp, std::move(memoizeAnalysis),
+                                  std::move(deviceGlobals).value()});
+    }
+
+    // Group equivalent memoize sites so that they share a single memoized
+    // result per device. Grouping must complete before any IR is modified as
+    // the equivalence cache holds references to the regions.
+    SmallVector<SmallVector<MemoizeSite *>> siteGroups;
+    {
+      OperationEquivalenceCache equivalenceCache(moduleOp.getContext());
+      for (auto &site : sites) {
+        auto it = llvm::find_if(siteGroups, [&](auto &siteGroup) {
+          return isEquivalentMemoizeSite(equivalenceCache, *siteGroup.front(),
+                                         site);
+        });
+        if (it != siteGroups.end()) {
+          it->push_back(&site);
+        } else {
+          siteGroups.push_back({&site});
+        }
+      }
+    }
+
+    // Memoize each group of sites.
+    for (auto &siteGroup : siteGroups) {
+      LLVM_DEBUG({
+        if (siteGroup.size() > 1) {
+          llvm::dbgs() << "sharing memoized results across "
+                       << siteGroup.size() << " equivalent sites:\n";
+          siteGroup.front()->memoizeOp.dump();
+        }
+      });
+      memoizeRegionOps(siteGroup, moduleSymbolTable);
     }
   }
 };
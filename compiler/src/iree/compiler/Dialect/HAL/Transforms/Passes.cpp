@@ -421,7 +421,9 @@ void buildHALTransformPassPipeline(OpPassManager &passManager,
 
   if (compileFrom < PipelinePhase::ExecutableTargets) {
     passManager.addNestedPass<IREE::HAL::ExecutableOp>(
-        IREE::HAL::createTranslateAllExecutablesPass({targetRegistry}));
+        IREE::HAL::createTranslateAllExecutablesPass(
+            {targetRegistry, targetOptions.executableCachePath,
+             targetOptions.executableCacheKey}));
   }
 
   // If debug information is requested capture the translated MLIR source text
@@ -564,7 +566,9 @@ void buildHALTransformPassPipeline(OpPassManager &passManager,
         IREE::HAL::createSerializeAllExecutablesPass(
             {&targetRegistry, targetOptions.debugLevel,
              targetOptions.executableIntermediatesPath,
-             targetOptions.executableBinariesPath}));
+             targetOptions.executableBinariesPath,
+             targetOptions.executableCachePath,
+             targetOptions.executableCacheKey}));
 
     // NOTE: symbol DCE will destroy executable target contents, so only run
     // it if we serialized things.
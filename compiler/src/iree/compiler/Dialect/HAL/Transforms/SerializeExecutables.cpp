@@ -12,6 +12,7 @@
 #include "iree/compiler/Dialect/HAL/Target/TargetBackend.h"
 #include "iree/compiler/Dialect/HAL/Target/TargetRegistry.h"
 #include "iree/compiler/Dialect/HAL/Transforms/Passes.h"
+#include "iree/compiler/Dialect/HAL/Utils/ExecutableCache.h"
 #include "iree/compiler/Utils/TracingUtils.h"
 #include "llvm/ADT/StringSet.h"
 #include "llvm/Support/FileSystem.h"
@@ -75,12 +76,36 @@ struct SerializeTargetExecutablesPass
       llvm::sys::fs::create_directories(dumpBinariesPath);
     }
 
+    // Cached binaries would not produce any of the requested dump files.
+    ExecutableCache cache(
+        dumpIntermediatesPath.empty() && dumpBinariesPath.empty() ? cachePath
+                                                                  : "",
+        cacheKey);
+
     auto variantOps = llvm::to_vector(
         executableOp.getBlock().getOps<IREE::HAL::ExecutableVariantOp>());
     for (auto variantOp : variantOps) {
       if (variantOp.getTarget().getBackend().getValue() != target)
         continue;
+
+      // Reuse the binaries from a previous serialization of an identical
+      // variant if available. Executable and export names may be embedded in
+      // the binaries and are part of the key.
+      std::optional<std::string> key;
+      if (cache.isEnabled()) {
+        std::string stage = (llvm::Twine("serialize:") + target + ":" +
+                             executableOp.getName() + ":" +
+                             llvm::Twine(debugLevel))
+                                .str();
+        key = cache.computeKey(variantOp, stage);
+        if (key && succeeded(loadCachedBinaries(cache, *key, variantOp))) {
+          variantOp.erase();
+          continue;
+        }
+      }
+
       OpBuilder executableBuilder(variantOp);
+      Operation *prevOp = variantOp->getPrevNode();
       // Ask the target backend to serialize the executable. Note that it
       // may create one or more hal.executable.binary ops in the case of
       // multi-architecture binaries.
@@ -90,9 +115,39 @@ struct SerializeTargetExecutablesPass
             << "failed to serialize executable for target backend " << target;
         return signalPassFailure();
       }
+
+      if (key) {
+        SmallVector<Operation *> binaryOps;
+        for (Operation *op = prevOp ? prevOp->getNextNode()
+                                    : &executableOp.getBlock().front();
+             op != variantOp.getOperation(); op = op->getNextNode()) {
+          binaryOps.push_back(op);
+        }
+        (void)cache.store(*key, binaryOps);
+      }
+
       variantOp.erase();
     }
   }
+
+  // Clones the cached binaries for |variantOp| before it.
+  LogicalResult loadCachedBinaries(const ExecutableCache &cache, StringRef key,
+                                   IREE::HAL::ExecutableVariantOp variantOp) {
+    auto cachedModuleOp = cache.load(variantOp.getContext(), key);
+    if (!cachedModuleOp) {
+      return failure();
+    }
+    auto cachedBinaryOps = llvm::to_vector(
+        cachedModuleOp->getOps<IREE::HAL::ExecutableBinaryOp>());
+    if (cachedBinaryOps.empty()) {
+      return failure();
+    }
+    OpBuilder executableBuilder(variantOp);
+    for (auto binaryOp : cachedBinaryOps) {
+      executableBuilder.clone(*binaryOp.getOperation());
+    }
+    return success();
+  }
 };
 
 //===----------------------------------------------------------------------===//
@@ -110,7 +165,7 @@ struct SerializeAllExecutablesPass
     for (const auto &targetName : gatherExecutableTargetNames(executableOp)) {
       passManager.addPass(IREE::HAL::createSerializeTargetExecutablesPass(
           {targetRegistry, targetName, debugLevel, dumpIntermediatesPath,
-           dumpBinariesPath}));
+           dumpBinariesPath, cachePath, cacheKey}));
     }
 
     IREE_COMPILER_TRACE_MESSAGE_DYNAMIC(INFO, executableOp.getSymName().str());
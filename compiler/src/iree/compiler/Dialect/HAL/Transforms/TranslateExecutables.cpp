@@ -12,8 +12,10 @@
 #include "iree/compiler/Dialect/HAL/Target/TargetBackend.h"
 #include "iree/compiler/Dialect/HAL/Target/TargetRegistry.h"
 #include "iree/compiler/Dialect/HAL/Transforms/Passes.h"
+#include "iree/compiler/Dialect/HAL/Utils/ExecutableCache.h"
 #include "iree/compiler/Utils/TracingUtils.h"
 #include "llvm/ADT/StringSet.h"
+#include "llvm/Support/Debug.h"
 #include "mlir/Dialect/Bufferization/IR/Bufferization.h"
 #include "mlir/IR/Attributes.h"
 #include "mlir/IR/Builders.h"
@@ -21,6 +23,8 @@
 #include "mlir/Pass/Pass.h"
 #include "mlir/Pass/PassManager.h"
 
+#define DEBUG_TYPE "iree-hal-translate-executables"
+
 namespace mlir::iree_compiler::IREE::HAL {
 
 #define GEN_PASS_DEF_TRANSLATEALLEXECUTABLESPASS
@@ -63,6 +67,23 @@ struct TranslateTargetExecutableVariantsPass
       return signalPassFailure();
     }
 
+    // Reuse a previous translation of an identical variant if available.
+    ExecutableCache cache(cachePath, cacheKey);
+    std::optional<std::string> key;
+    SmallVector<StringAttr> exportNames;
+    if (cache.isEnabled()) {
+      OwningOpRef<IREE::HAL::ExecutableVariantOp> canonicalOp =
+          cast<IREE::HAL::ExecutableVariantOp>(variantOp->clone());
+      exportNames = canonicalizeExportNames(*canonicalOp);
+      key = cache.computeKey(*canonicalOp, "translate:" + target);
+      if (key && succeeded(loadCachedVariant(cache, *key, exportNames))) {
+        LLVM_DEBUG(llvm::dbgs() << "translation cache hit for "
+                                << variantOp.getSymName() << ": " << *key
+                                << "\n");
+        return;
+      }
+    }
+
     OpPassManager passManager(variantOp.getOperationName());
     targetBackend->buildTranslationPassPipeline(variantOp.getTargetAttr(),
                                                 passManager);
@@ -73,6 +94,41 @@ struct TranslateTargetExecutableVariantsPass
           << variantOp.getTarget();
       return signalPassFailure();
     }
+
+    if (key) {
+      OwningOpRef<IREE::HAL::ExecutableVariantOp> canonicalOp =
+          cast<IREE::HAL::ExecutableVariantOp>(variantOp->clone());
+      auto translatedNames = canonicalizeExportNames(*canonicalOp);
+      // Translation is not expected to change exports but if it does the
+      // cached names could not be restored.
+      if (translatedNames == exportNames &&
+          failed(cache.store(*key, {canonicalOp->getOperation()}))) {
+        LLVM_DEBUG(llvm::dbgs() << "failed to store translation of "
+                                << variantOp.getSymName() << "\n");
+      }
+    }
+  }
+
+  // Replaces the contents of the variant with the cached translation.
+  LogicalResult loadCachedVariant(const ExecutableCache &cache, StringRef key,
+                                  ArrayRef<StringAttr> exportNames) {
+    auto variantOp = getOperation();
+    auto cachedModuleOp = cache.load(variantOp.getContext(), key);
+    if (!cachedModuleOp) {
+      return failure();
+    }
+    auto cachedVariantOps =
+        cachedModuleOp->getOps<IREE::HAL::ExecutableVariantOp>();
+    if (!llvm::hasSingleElement(cachedVariantOps)) {
+      return failure();
+    }
+    auto cachedVariantOp = *cachedVariantOps.begin();
+    if (failed(restoreExportNames(cachedVariantOp, exportNames))) {
+      return failure();
+    }
+    variantOp->setAttrs(cachedVariantOp->getAttrDictionary());
+    variantOp.getBody().takeBody(cachedVariantOp.getBody());
+    return success();
   }
 };
 
@@ -102,7 +158,7 @@ struct TranslateAllExecutablesPass
     for (const auto &targetName : gatherExecutableTargetNames(executableOp)) {
       passManager.addNestedPass<IREE::HAL::ExecutableVariantOp>(
           IREE::HAL::createTranslateTargetExecutableVariantsPass(
-              {targetRegistry, targetName}));
+              {targetRegistry, targetName, cachePath, cacheKey}));
     }
 
     IREE_COMPILER_TRACE_MESSAGE_DYNAMIC(INFO, executableOp.getSymName().str());
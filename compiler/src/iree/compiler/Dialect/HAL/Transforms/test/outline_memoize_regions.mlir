@@ -242,3 +242,102 @@ util.func public @memoize_command_buffer() -> !hal.command_buffer {
   // CHECK: util.return %[[CMD]]
   util.return %result : !hal.command_buffer
 }
+
+// -----
+
+// Tests that structurally equivalent memoize regions capturing the same values
+// share a single memoized command buffer. This happens with repeated execution
+// regions (such as model layers) that only differ in the resources they
+// reference indirectly via binding tables. Regions capturing different values
+// must still be memoized independently.
+
+util.global private @device = #hal.device.target<"local"> : !hal.device
+util.global private @executable : !hal.executable
+
+// CHECK: util.func private @__layer_0_memoize_apply
+// CHECK-NOT: util.func private @__layer_1_memoize_apply
+// CHECK: util.global private @__layer_0_memoize_result_0_device : !hal.command_buffer
+// CHECK-NOT: util.global private @__layer_1_memoize_result_0_device
+// CHECK: util.func private @__layer_0_memoize_lookup
+
+// CHECK-LABEL: util.func public @layer_0
+util.func public @layer_0() -> !hal.command_buffer {
+  %device = util.global.load immutable @device : !hal.device
+  %affinity = arith.constant -1 : i64
+  %executable = util.global.load immutable @executable : !hal.executable
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  %c128 = arith.constant 128 : index
+  // CHECK-NOT: hal.device.memoize
+  // CHECK: util.call @__layer_0_memoize_lookup
+  %result = hal.device.memoize<%device : !hal.device> affinity(%affinity) -> !hal.command_buffer {
+    %cmd = hal.command_buffer.create device(%device : !hal.device) mode(None) categories("Transfer|Dispatch") affinity(%affinity) bindings(%c1) : !hal.command_buffer
+    %dispatch_ordinal = arith.constant 0 : index
+    hal.command_buffer.dispatch<%cmd : !hal.command_buffer>
+        target(%executable : !hal.executable)[%dispatch_ordinal]
+        workgroups([%c1, %c1, %c1])
+        bindings([
+          (%c0 : index)[%c0, %c128]
+        ])
+        flags(None)
+    hal.command_buffer.finalize<%cmd : !hal.command_buffer>
+    hal.return %cmd : !hal.command_buffer
+  }
+  util.return %result : !hal.command_buffer
+}
+
+// CHECK-LABEL: util.func public @layer_1
+util.func public @layer_1() -> !hal.command_buffer {
+  %device = util.global.load immutable @device : !hal.device
+  %affinity = arith.constant -1 : i64
+  %executable = util.global.load immutable @executable : !hal.executable
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  %c128 = arith.constant 128 : index
+  // CHECK-NOT: hal.device.memoize
+  // CHECK: util.call @__layer_0_memoize_lookup
+  %result = hal.device.memoize<%device : !hal.device> affinity(%affinity) -> !hal.command_buffer {
+    %cmd = hal.command_buffer.create device(%device : !hal.device) mode(None) categories("Transfer|Dispatch") affinity(%affinity) bindings(%c1) : !hal.command_buffer
+    %dispatch_ordinal = arith.constant 0 : index
+    hal.command_buffer.dispatch<%cmd : !hal.command_buffer>
+        target(%executable : !hal.executable)[%dispatch_ordinal]
+        workgroups([%c1, %c1, %c1])
+        bindings([
+          (%c0 : index)[%c0, %c128]
+        ])
+        flags(None)
+    hal.command_buffer.finalize<%cmd : !hal.command_buffer>
+    hal.return %cmd : !hal.command_buffer
+  }
+  util.return %result : !hal.command_buffer
+}
+
+// CHECK: util.func private @__layer_with_different_ordinal_memoize_apply
+// CHECK: util.global private @__layer_with_different_ordinal_memoize_result_0_device
+// CHECK: util.func private @__layer_with_different_ordinal_memoize_lookup
+
+// CHECK-LABEL: util.func public @layer_with_different_ordinal
+util.func public @layer_with_different_ordinal() -> !hal.command_buffer {
+  %device = util.global.load immutable @device : !hal.device
+  %affinity = arith.constant -1 : i64
+  %executable = util.global.load immutable @executable : !hal.executable
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  %c128 = arith.constant 128 : index
+  // CHECK-NOT: hal.device.memoize
+  // CHECK: util.call @__layer_with_different_ordinal_memoize_lookup
+  %result = hal.device.memoize<%device : !hal.device> affinity(%affinity) -> !hal.command_buffer {
+    %cmd = hal.command_buffer.create device(%device : !hal.device) mode(None) categories("Transfer|Dispatch") affinity(%affinity) bindings(%c1) : !hal.command_buffer
+    %dispatch_ordinal = arith.constant 1 : index
+    hal.command_buffer.dispatch<%cmd : !hal.command_buffer>
+        target(%executable : !hal.executable)[%dispatch_ordinal]
+        workgroups([%c1, %c1, %c1])
+        bindings([
+          (%c0 : index)[%c0, %c128]
+        ])
+        flags(None)
+    hal.command_buffer.finalize<%cmd : !hal.command_buffer>
+    hal.return %cmd : !hal.command_buffer
+  }
+  util.return %result : !hal.command_buffer
+}
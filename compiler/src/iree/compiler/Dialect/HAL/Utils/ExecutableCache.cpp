@@ -0,0 +1,190 @@
+// Copyright 2025 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/compiler/Dialect/HAL/Utils/ExecutableCache.h"
+
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/SHA256.h"
+#include "llvm/Support/raw_ostream.h"
+#include "mlir/Bytecode/BytecodeWriter.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/BuiltinAttributes.h"
+#include "mlir/IR/SymbolTable.h"
+#include "mlir/Parser/Parser.h"
+
+namespace mlir::iree_compiler::IREE::HAL {
+
+// Bumped whenever the entry format or key derivation changes so that stale
+// entries are never loaded.
+static constexpr StringLiteral kCacheFormatVersion = "iree-executable-cache-v1";
+
+static std::string getEntryPath(StringRef cachePath, StringRef key) {
+  SmallString<256> entryPath(cachePath);
+  llvm::sys::path::append(entryPath, key + ".mlirbc");
+  return entryPath.str().str();
+}
+
+std::optional<std::string>
+ExecutableCache::computeKey(Operation *op, StringRef stage) const {
+  // Dialect resources are printed by handle only and the handle does not
+  // change when the contents do. Executable objects referencing files are
+  // printed by path and are keyed by the file contents instead.
+  bool hasResources = false;
+  SmallVector<IREE::HAL::ExecutableObjectAttr> fileObjectAttrs;
+  op->walk([&](Operation *nestedOp) {
+    for (auto attr : nestedOp->getAttrs()) {
+      attr.getValue().walk([&](Attribute nestedAttr) {
+        if (isa<DenseResourceElementsAttr>(nestedAttr)) {
+          hasResources = true;
+          return WalkResult::interrupt();
+        }
+        auto objectAttr = dyn_cast<IREE::HAL::ExecutableObjectAttr>(nestedAttr);
+        if (objectAttr && objectAttr.getPath()) {
+          fileObjectAttrs.push_back(objectAttr);
+        }
+        return WalkResult::advance();
+      });
+    }
+    return hasResources ? WalkResult::interrupt() : WalkResult::advance();
+  });
+  if (hasResources) {
+    return std::nullopt;
+  }
+
+  llvm::SHA256 hasher;
+  auto update = [&](StringRef value) {
+    hasher.update(value);
+    hasher.update(StringRef("\0", 1));
+  };
+  update(kCacheFormatVersion);
+  update(salt);
+  update(stage);
+  {
+    std::string str;
+    llvm::raw_string_ostream os(str);
+    OpPrintingFlags flags;
+    flags.printGenericOpForm().enableDebugInfo(false).useLocalScope();
+    op->print(os, flags);
+    update(os.str());
+  }
+  for (auto objectAttr : fileObjectAttrs) {
+    std::optional<std::string> data = objectAttr.loadData();
+    if (!data) {
+      return std::nullopt;
+    }
+    update(*data);
+  }
+  return llvm::toHex(hasher.final(), /*LowerCase=*/true);
+}
+
+OwningOpRef<ModuleOp> ExecutableCache::load(MLIRContext *context,
+                                            StringRef key) const {
+  std::string entryPath = getEntryPath(path, key);
+  if (!llvm::sys::fs::exists(entryPath)) {
+    return {};
+  }
+  ParserConfig parserConfig(context);
+  return parseSourceFile<ModuleOp>(entryPath, parserConfig);
+}
+
+LogicalResult ExecutableCache::store(StringRef key,
+                                     ArrayRef<Operation *> ops) const {
+  if (ops.empty()) {
+    return failure();
+  }
+  if (llvm::sys::fs::create_directories(path)) {
+    return failure();
+  }
+
+  auto moduleOp = OwningOpRef<ModuleOp>(
+      ModuleOp::create(UnknownLoc::get(ops.front()->getContext())));
+  auto builder = OpBuilder::atBlockBegin(moduleOp->getBody());
+  for (auto *op : ops) {
+    builder.clone(*op);
+  }
+
+  // Write to a unique temporary file and move it into place so concurrent
+  // readers never observe partially written entries.
+  SmallString<256> tempPattern(path);
+  llvm::sys::path::append(tempPattern, key + "-%%%%%%%%.tmp");
+  int tempFd = -1;
+  SmallString<256> tempPath;
+  if (llvm::sys::fs::createUniqueFile(tempPattern, tempFd, tempPath)) {
+    return failure();
+  }
+  bool didWrite = false;
+  {
+    llvm::raw_fd_ostream os(tempFd, /*shouldClose=*/true);
+    didWrite = succeeded(writeBytecodeToFile(*moduleOp, os));
+    os.flush();
+    didWrite = didWrite && !os.has_error();
+    os.clear_error();
+  }
+  if (!didWrite ||
+      llvm::sys::fs::rename(tempPath, getEntryPath(path, key))) {
+    llvm::sys::fs::remove(tempPath);
+    return failure();
+  }
+  return success();
+}
+
+static StringAttr getCanonicalExportName(MLIRContext *context,
+                                         unsigned ordinal) {
+  return StringAttr::get(context,
+                         "__cached_export_" + std::to_string(ordinal));
+}
+
+// Renames |exportOp| and the inner module symbol with the same name.
+static void renameExport(IREE::HAL::ExecutableVariantOp variantOp,
+                         IREE::HAL::ExecutableExportOp exportOp,
+                         StringAttr newName) {
+  StringAttr oldName = exportOp.getSymNameAttr();
+  if (oldName == newName) {
+    return;
+  }
+  if (auto innerModuleOp = variantOp.getInnerModule()) {
+    if (auto *symbolOp = SymbolTable::lookupSymbolIn(innerModuleOp, oldName)) {
+      (void)SymbolTable::replaceAllSymbolUses(symbolOp, newName,
+                                              innerModuleOp);
+      SymbolTable::setSymbolName(symbolOp, newName);
+    }
+  }
+  exportOp.setSymNameAttr(newName);
+}
+
+SmallVector<StringAttr>
+canonicalizeExportNames(IREE::HAL::ExecutableVariantOp variantOp) {
+  SmallVector<StringAttr> names;
+  for (auto [ordinal, exportOp] : llvm::enumerate(
+           llvm::to_vector(variantOp.getExportOps()))) {
+    names.push_back(exportOp.getSymNameAttr());
+    renameExport(variantOp, exportOp,
+                 getCanonicalExportName(variantOp.getContext(), ordinal));
+  }
+  return names;
+}
+
+LogicalResult restoreExportNames(IREE::HAL::ExecutableVariantOp variantOp,
+                                 ArrayRef<StringAttr> names) {
+  auto exportOps = llvm::to_vector(variantOp.getExportOps());
+  if (exportOps.size() != names.size()) {
+    return failure();
+  }
+  for (auto [ordinal, exportOp] : llvm::enumerate(exportOps)) {
+    if (exportOp.getSymNameAttr() !=
+        getCanonicalExportName(variantOp.getContext(), ordinal)) {
+      return failure();
+    }
+  }
+  for (auto [exportOp, name] : llvm::zip_equal(exportOps, names)) {
+    renameExport(variantOp, exportOp, name);
+  }
+  return success();
+}
+
+} // namespace mlir::iree_compiler::IREE::HAL
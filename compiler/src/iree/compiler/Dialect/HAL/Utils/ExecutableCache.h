@@ -0,0 +1,69 @@
+// Copyright 2025 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_COMPILER_DIALECT_HAL_UTILS_EXECUTABLECACHE_H_
+#define IREE_COMPILER_DIALECT_HAL_UTILS_EXECUTABLECACHE_H_
+
+#include <optional>
+#include <string>
+
+#include "iree/compiler/Dialect/HAL/IR/HALOps.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/OwningOpRef.h"
+
+namespace mlir::iree_compiler::IREE::HAL {
+
+// An on-disk cache of executable IR keyed by the content of the IR it was
+// produced from. Entries are stored as MLIR bytecode files named by their key
+// in a flat directory that may be shared by concurrent compiler processes.
+//
+// Keys are derived from the generic printed form of the source IR without
+// locations, the contents of any files referenced by executable objects, and a
+// |salt| that must capture everything else the cached result depends on
+// (compiler build, flags, files named by flags, etc). The cache is
+// best-effort: any failure to read or write an entry is treated as a miss.
+class ExecutableCache {
+public:
+  ExecutableCache(StringRef path, StringRef salt) : path(path), salt(salt) {}
+
+  // Returns true if the cache has a directory to read/write entries from.
+  bool isEnabled() const { return !path.empty(); }
+
+  // Computes the key of |op| for a particular |stage| (translation,
+  // serialization, etc) producing the cached entry. Returns std::nullopt if the
+  // op cannot be keyed by its printed form (such as when it references
+  // external dialect resources whose contents are not printed) or references
+  // object files that cannot be read.
+  std::optional<std::string> computeKey(Operation *op, StringRef stage) const;
+
+  // Loads the ops stored under |key| into a new module. Returns nullptr if the
+  // entry does not exist or cannot be loaded.
+  OwningOpRef<ModuleOp> load(MLIRContext *context, StringRef key) const;
+
+  // Stores clones of |ops| under |key|, replacing any existing entry.
+  LogicalResult store(StringRef key, ArrayRef<Operation *> ops) const;
+
+private:
+  std::string path;
+  std::string salt;
+};
+
+// Renames all exports in |variantOp| and the inner module symbols they refer
+// to with names derived from their ordinal position so that executables that
+// only differ in naming (such as dispatches renumbered after changes to the
+// rest of the program) share cache entries. Returns the original names in
+// export order for use with restoreExportNames.
+SmallVector<StringAttr>
+canonicalizeExportNames(IREE::HAL::ExecutableVariantOp variantOp);
+
+// Restores the export |names| previously returned by canonicalizeExportNames.
+// Fails if |variantOp| does not have the same number of exports.
+LogicalResult restoreExportNames(IREE::HAL::ExecutableVariantOp variantOp,
+                                 ArrayRef<StringAttr> names);
+
+} // namespace mlir::iree_compiler::IREE::HAL
+
+#endif // IREE_COMPILER_DIALECT_HAL_UTILS_EXECUTABLECACHE_H_
@@ -6,9 +6,13 @@
 
 #include "iree/compiler/Dialect/Stream/Analysis/Partitioning.h"
 
+#include "iree/compiler/Dialect/Stream/IR/StreamOps.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/TypeSwitch.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/MathExtras.h"
 #include "mlir/IR/AsmState.h"
+#include "mlir/IR/Matchers.h"
 #include "mlir/IR/PatternMatch.h"
 
 #define DEBUG_TYPE "iree-stream-partitioning"
@@ -23,6 +27,7 @@ void dumpPartition(Partition &partition, AsmState &asmState) {
     partition.affinity.dump();
     llvm::dbgs() << "\n";
   }
+  llvm::dbgs() << " ESTIMATED COST: " << partition.estimatedCost << "\n";
   llvm::dbgs() << " INS:\n    ";
   llvm::interleave(
       partition.ins, llvm::dbgs(),
@@ -53,6 +58,52 @@ void Partition::dump(AsmState &asmState) {}
 void PartitionSet::dump(AsmState &asmState) {}
 #endif // !NDEBUG
 
+//===----------------------------------------------------------------------===//
+// Cost model
+//===----------------------------------------------------------------------===//
+
+// Returns the product of |values| if all are constant.
+static std::optional<int64_t> getStaticProduct(ValueRange values) {
+  int64_t product = 1;
+  for (auto value : values) {
+    APInt constantValue;
+    if (!matchPattern(value, m_ConstantInt(&constantValue))) {
+      return std::nullopt;
+    }
+    product = llvm::SaturatingMultiply(
+        product, std::max<int64_t>(constantValue.getSExtValue(), 1));
+  }
+  return product;
+}
+
+// Returns the cost of transferring |length| bytes if static.
+static std::optional<int64_t> getTransferCost(Value length) {
+  auto byteLength = getStaticProduct(length);
+  if (!byteLength) {
+    return std::nullopt;
+  }
+  return llvm::divideCeil(*byteLength, sizeof(int32_t));
+}
+
+std::optional<int64_t> estimateOpCost(Operation *op) {
+  return TypeSwitch<Operation *, std::optional<int64_t>>(op)
+      .Case<IREE::Stream::AsyncDispatchOp, IREE::Stream::CmdDispatchOp>(
+          [](auto op) { return getStaticProduct(op.getWorkload()); })
+      .Case<IREE::Stream::AsyncFillOp, IREE::Stream::CmdFillOp>(
+          [](auto op) { return getTransferCost(op.getTargetLength()); })
+      .Case<IREE::Stream::AsyncCopyOp, IREE::Stream::CmdCopyOp>(
+          [](auto op) { return getTransferCost(op.getLength()); })
+      .Case<IREE::Stream::AsyncSplatOp>(
+          [](auto op) { return getTransferCost(op.getResultSize()); })
+      .Case<IREE::Stream::AsyncCloneOp>(
+          [](auto op) { return getTransferCost(op.getResultSize()); })
+      .Default([](Operation *) { return std::nullopt; });
+}
+
+int64_t estimateWorkersRequired(int64_t estimatedCost) {
+  return llvm::divideCeil(estimatedCost, kEstimatedCostPerWorker);
+}
+
 LogicalResult Partition::verify(Location loc) {
   // Ensure all ops are compatible with the partition affinity.
   for (auto *op : ops) {
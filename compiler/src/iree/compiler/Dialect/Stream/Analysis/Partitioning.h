@@ -7,6 +7,8 @@
 #ifndef IREE_COMPILER_DIALECT_STREAM_ANALYSIS_PARTITIONING_H_
 #define IREE_COMPILER_DIALECT_STREAM_ANALYSIS_PARTITIONING_H_
 
+#include <optional>
+
 #include "iree/compiler/Dialect/Stream/IR/StreamTypes.h"
 #include "mlir/IR/Operation.h"
 #include "mlir/Support/LLVM.h"
@@ -33,6 +35,9 @@ struct Partition {
   // partitions in cases where the op is to be duplicated. Not all ops are
   // streamable (such as constants and arithmetic).
   SetVector<Operation *> ops;
+  // Estimated work of all ops in the partition as returned by
+  // estimateOpCost. Ops with unknown costs are not included.
+  int64_t estimatedCost = 0;
 
   void dump(AsmState &asmState);
 
@@ -59,6 +64,26 @@ struct PartitionSet {
   void topologicalSort();
 };
 
+//===----------------------------------------------------------------------===//
+// Cost model
+//===----------------------------------------------------------------------===//
+
+// Estimated work one worker is expected to perform in a concurrency wave in
+// the units of estimateOpCost. Waves are considered saturated when their total
+// cost reaches this times the worker count of the partitioning config.
+constexpr int64_t kEstimatedCostPerWorker = 64 * 1024;
+
+// Returns the estimated work performed by |op| in abstract units roughly
+// corresponding to the number of elements processed. Dispatches are estimated
+// from their static workload and transfers from their length in 32-bit
+// elements. Returns std::nullopt if the op performs no device work or its cost
+// depends on dynamic values.
+std::optional<int64_t> estimateOpCost(Operation *op);
+
+// Returns the number of workers required to execute work of |estimatedCost|
+// without exceeding kEstimatedCostPerWorker each.
+int64_t estimateWorkersRequired(int64_t estimatedCost);
+
 //===----------------------------------------------------------------------===//
 // Stream partitioning algorithms
 //===----------------------------------------------------------------------===//
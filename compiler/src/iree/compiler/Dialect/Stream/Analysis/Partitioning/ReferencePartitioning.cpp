@@ -448,6 +448,9 @@ partitionStreamableOpsReference(IREE::Stream::PartitioningConfigAttr config,
     partition.affinity = builder->affinity;
     partition.ins = consumedValues;
     partition.outs = escapingValues;
+    for (auto *op : builder->ops) {
+      partition.estimatedCost += estimateOpCost(op).value_or(0);
+    }
 
     partition.ops = std::move(builder->ops);
     partitionSet.partitions.push_back(std::move(partition));
@@ -475,9 +478,22 @@ partitionRegionConcurrencyReference(IREE::Stream::PartitioningConfigAttr config,
     unsigned ordinal;
     // Ops present in the wave; ops may be present in multiple waves.
     SetVector<Operation *> ops;
+    // Estimated cost of all ops in the wave.
+    int64_t estimatedCost = 0;
   };
   SmallVector<std::unique_ptr<PartitionBuilder>> builders;
 
+  // When the number of workers on the target is known we limit the amount of
+  // work placed into each wave so that concurrently executing work fills the
+  // workers without oversubscribing them. Work that already saturates all
+  // workers on its own gets a wave to itself.
+  int64_t waveCapacity = config.getWorkerCount() * kEstimatedCostPerWorker;
+  auto isWaveSaturated = [&](unsigned ordinal, int64_t opCost) {
+    int64_t waveCost = builders[ordinal]->estimatedCost;
+    return waveCapacity > 0 && waveCost > 0 &&
+           waveCost + opCost > waveCapacity;
+  };
+
   struct OpInfo {
     // Which waves the op is contained within.
     llvm::BitVector membership;
@@ -614,13 +630,32 @@ partitionRegionConcurrencyReference(IREE::Stream::PartitioningConfigAttr config,
     opInfo.membership.resize(builders.size(), /*t=*/false);
 
     // No consumers - if there's any candidate then we'll go into that.
-    int firstCandidateOrdinal = favor == IREE::Stream::Favor::MaxConcurrency
-                                    ? candidates.find_first()
-                                    : candidates.find_last();
+    // Candidates are tried in the order preferred by the favor and skipped if
+    // they are already saturated.
+    int64_t opCost = estimateOpCost(&op).value_or(0);
+    int firstCandidateOrdinal = -1;
+    if (favor == IREE::Stream::Favor::MaxConcurrency) {
+      for (int ordinal = candidates.find_first(); ordinal != -1;
+           ordinal = candidates.find_next(ordinal)) {
+        if (!isWaveSaturated(ordinal, opCost)) {
+          firstCandidateOrdinal = ordinal;
+          break;
+        }
+      }
+    } else {
+      for (int ordinal = candidates.find_last(); ordinal != -1;
+           ordinal = candidates.find_prev(ordinal)) {
+        if (!isWaveSaturated(ordinal, opCost)) {
+          firstCandidateOrdinal = ordinal;
+          break;
+        }
+      }
+    }
     if (firstCandidateOrdinal != -1) {
       LLVM_DEBUG(llvm::dbgs() << "Moving to last candidate wave "
                               << firstCandidateOrdinal << " (continue)\n");
       builders[firstCandidateOrdinal]->ops.insert(&op);
+      builders[firstCandidateOrdinal]->estimatedCost += opCost;
       opInfo.membership.set(firstCandidateOrdinal);
       opInfo.hazards.set(0, firstCandidateOrdinal);
       opInfo.hazards.reset(firstCandidateOrdinal);
@@ -635,6 +670,7 @@ partitionRegionConcurrencyReference(IREE::Stream::PartitioningConfigAttr config,
     auto builder = std::make_unique<PartitionBuilder>();
     builder->ordinal = builders.size();
     builder->ops.insert(&op);
+    builder->estimatedCost = opCost;
     LLVM_DEBUG(llvm::dbgs() << "Created wave " << builder->ordinal << "\n");
     builders.push_back(std::move(builder));
   }
@@ -664,6 +700,7 @@ partitionRegionConcurrencyReference(IREE::Stream::PartitioningConfigAttr config,
     consumedValues.set_subtract(producedValues);
     wave.ins = consumedValues;
     wave.outs = escapingValues;
+    wave.estimatedCost = builder->estimatedCost;
 
     wave.ops = std::move(builder->ops);
     waveSet.partitions.push_back(std::move(wave));
@@ -36,6 +36,15 @@ static llvm::cl::opt<Favor> clPartitioningFavor(
                    "Favor maximizing concurrency at the cost of additional "
                    "memory consumption.")));
 
+static llvm::cl::opt<int64_t> clPartitioningWorkerCount(
+    "iree-stream-partitioning-worker-count",
+    llvm::cl::desc(
+        "Default number of workers available on the target to execute "
+        "concurrent work (such as the local-task executor worker count). When "
+        "non-zero concurrency waves are sized to keep all workers busy "
+        "without oversubscribing them."),
+    llvm::cl::init(0));
+
 // TODO(#8042): properly choose this value based on target devices. We don't
 // yet have the device information up in stream and thus for targets that have
 // high alignment requirements (128/256/etc) we are not picking the right
@@ -421,6 +430,13 @@ Attribute PartitioningConfigAttr::parse(AsmParser &p, Type type) {
   } else if (failed(p.parseString(&favorStr))) {
     return {};
   }
+  int64_t workerCount = 0;
+  if (succeeded(p.parseOptionalComma())) {
+    if (failed(p.parseKeyword("workers")) || failed(p.parseEqual()) ||
+        failed(p.parseInteger(workerCount))) {
+      return {};
+    }
+  }
   if (failed(p.parseGreater()))
     return {};
   auto favor = symbolizeFavor(favorStr);
@@ -429,13 +445,16 @@ Attribute PartitioningConfigAttr::parse(AsmParser &p, Type type) {
     return {};
   }
   return PartitioningConfigAttr::get(
-      FavorAttr::get(p.getContext(), favor.value()));
+      FavorAttr::get(p.getContext(), favor.value()), workerCount);
 }
 
 void PartitioningConfigAttr::print(AsmPrinter &p) const {
   p << "<";
   p << "favor-";
   p << stringifyFavor(getFavor().getValue());
+  if (getWorkerCount() > 0) {
+    p << ", workers = " << getWorkerCount();
+  }
   p << ">";
 }
 
@@ -449,7 +468,7 @@ PartitioningConfigAttr PartitioningConfigAttr::lookup(Operation *op) {
   }
   // No config found; use defaults.
   auto favorAttr = FavorAttr::get(attrId.getContext(), clPartitioningFavor);
-  return PartitioningConfigAttr::get(favorAttr);
+  return PartitioningConfigAttr::get(favorAttr, clPartitioningWorkerCount);
 }
 
 //===----------------------------------------------------------------------===//
@@ -541,6 +560,7 @@ Value ResourceType::createSubrangeOp(Location loc, Value resource,
 void StreamDialect::registerAttributes() {
   // Register command line flags:
   (void)clPartitioningFavor;
+  (void)clPartitioningWorkerCount;
   (void)clResourceMaxAllocationSize;
   (void)clResourceMinOffsetAlignment;
   (void)clResourceMaxRange;
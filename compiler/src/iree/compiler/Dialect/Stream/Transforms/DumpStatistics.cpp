@@ -4,8 +4,10 @@
 // See https://llvm.org/LICENSE.txt for license information.
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
+#include <optional>
 #include <utility>
 
+#include "iree/compiler/Dialect/Stream/Analysis/Partitioning.h"
 #include "iree/compiler/Dialect/Stream/IR/StreamDialect.h"
 #include "iree/compiler/Dialect/Stream/IR/StreamOps.h"
 #include "iree/compiler/Dialect/Stream/IR/StreamTraits.h"
@@ -95,6 +97,40 @@ struct UsageInfo {
   }
 };
 
+// Static slice packing statistics attributed to an allocation by
+// --iree-stream-layout-slices when run with `annotate-statistics`.
+struct PackStatistics {
+  int64_t sliceCount = 0;
+  // Size of the static slice layout.
+  int64_t size = 0;
+  // Smallest possible size given the slice lifetimes.
+  int64_t lowerBound = 0;
+  // Strategy that produced the layout.
+  StringRef strategy;
+
+  int64_t getWastedSize() const { return size - lowerBound; }
+
+  static std::optional<PackStatistics>
+  lookup(IREE::Stream::ResourceAllocaOp allocaOp) {
+    auto dictAttr =
+        allocaOp->getAttrOfType<DictionaryAttr>("stream.pack_statistics");
+    if (!dictAttr)
+      return std::nullopt;
+    auto slicesAttr = dictAttr.getAs<IntegerAttr>("slices");
+    auto sizeAttr = dictAttr.getAs<IntegerAttr>("size");
+    auto lowerBoundAttr = dictAttr.getAs<IntegerAttr>("lower_bound");
+    auto strategyAttr = dictAttr.getAs<StringAttr>("strategy");
+    if (!slicesAttr || !sizeAttr || !lowerBoundAttr || !strategyAttr)
+      return std::nullopt;
+    PackStatistics stats;
+    stats.sliceCount = slicesAttr.getInt();
+    stats.size = sizeAttr.getInt();
+    stats.lowerBound = lowerBoundAttr.getInt();
+    stats.strategy = strategyAttr.getValue();
+    return stats;
+  }
+};
+
 // TODO(benvanik): StaticSize helper or something for the dynamic bit.
 struct Statistics {
   // Globals:
@@ -112,6 +148,10 @@ struct Statistics {
   size_t submissionCount = 0;
   int64_t transientSize = 0;
   bool transientSizeDynamic = false;
+  // Only populated for allocations with pack statistics.
+  size_t transientPackCount = 0;
+  int64_t transientPackedSize = 0;
+  int64_t transientWastedSize = 0;
   // TODO(benvanik): add fill/copy sizes (when possible).
   size_t fillCount = 0;
   size_t copyCount = 0;
@@ -160,6 +200,11 @@ struct Statistics {
       } else {
         transientSizeDynamic = true;
       }
+      if (auto packStats = PackStatistics::lookup(allocaOp)) {
+        ++transientPackCount;
+        transientPackedSize += packStats->size;
+        transientWastedSize += packStats->getWastedSize();
+      }
     }
     for (auto executeOp : usageInfo.executeOps) {
       executeOp.walk([&](Operation *op) {
@@ -242,6 +287,13 @@ static void prettyPrintStatistics(const UsageInfo &usageInfo,
   os << llvm::formatv(
       "{}{} B ({:F2} MiB)\n", stats.transientSizeDynamic ? "minimum " : "",
       stats.transientSize, stats.transientSize / (1 * 1024 * 1024.0f));
+  if (stats.transientPackedSize > 0) {
+    os << llvm::formatv("//  Transients: {} packs, {} B packed, ",
+                        stats.transientPackCount, stats.transientPackedSize);
+    os << llvm::formatv("{} B ({:F2}%) wasted\n", stats.transientWastedSize,
+                        stats.transientWastedSize /
+                            (float)stats.transientPackedSize * 100.0f);
+  }
 
   os << llvm::formatv("//   DMA Fills: {}\n", stats.fillCount);
   os << llvm::formatv("//  DMA Copies: {}\n", stats.copyCount);
@@ -249,10 +301,13 @@ static void prettyPrintStatistics(const UsageInfo &usageInfo,
   os << llvm::formatv("//  Dispatches: {}\n", stats.dispatchCount);
   os << llvm::formatv("// Async Calls: {}\n", stats.callCount);
 
+  int executableReuse = 0;
+  if (stats.dispatchCount > 0) {
+    executableReuse = (int)std::roundf(
+        (1.0f - (stats.executableCount / (float)stats.dispatchCount)) * 100.0f);
+  }
   os << llvm::formatv("// Executables: {}, {}% reuse\n", stats.executableCount,
-                      (int)std::roundf((1.0f - (stats.executableCount /
-                                                (float)stats.dispatchCount)) *
-                                       100.0f));
+                      executableReuse);
 
   os << "//\n";
 }
@@ -286,6 +341,75 @@ static void prettyPrintSyncInfo(const UsageInfo &usageInfo, bool verbose,
   os << "//\n";
 }
 
+static void prettyPrintTransientInfo(const UsageInfo &usageInfo, bool verbose,
+                                     llvm::raw_fd_ostream &os) {
+  prettyPrintSectionHeader("Transients", os);
+  os << "//\n";
+
+  // Packs are listed in program order; wasted bytes are those laid out above
+  // the peak concurrently live size of the packed slices.
+  bool anyPacks = false;
+  for (auto allocaOp : usageInfo.allocaOps) {
+    auto packStats = PackStatistics::lookup(allocaOp);
+    if (!packStats)
+      continue;
+    anyPacks = true;
+    os << "// ";
+    prettyPrintOpBreadcrumb(allocaOp, os);
+    os << "\n";
+    os << llvm::formatv("//   {} slices packed into {} B with {}, ",
+                        packStats->sliceCount, packStats->size,
+                        packStats->strategy);
+    os << llvm::formatv("{} B wasted above lower bound {} B\n",
+                        packStats->getWastedSize(), packStats->lowerBound);
+  }
+  if (!anyPacks) {
+    os << "// (no pack statistics; run with "
+          "iree-stream-layout-slices{annotate-statistics})\n";
+  }
+
+  os << "//\n";
+}
+
+// Estimated work of a set of commands as computed by estimateOpCost.
+struct CostEstimate {
+  int64_t cost = 0;
+  // Number of commands performing work with a dynamic cost not included.
+  size_t dynamicCount = 0;
+};
+
+static CostEstimate estimateNestedCost(Operation *rootOp) {
+  CostEstimate estimate;
+  rootOp->walk([&](Operation *op) {
+    if (auto cost = IREE::Stream::estimateOpCost(op)) {
+      estimate.cost += *cost;
+    } else if (isa<IREE::Stream::CmdDispatchOp, IREE::Stream::CmdFillOp,
+                   IREE::Stream::CmdCopyOp>(op)) {
+      ++estimate.dynamicCount;
+    }
+  });
+  return estimate;
+}
+
+static void prettyPrintCostEstimate(StringRef label,
+                                    const CostEstimate &estimate,
+                                    int64_t workerCount,
+                                    llvm::raw_fd_ostream &os) {
+  os << llvm::formatv("// {}: {} units", label, estimate.cost);
+  if (estimate.dynamicCount > 0) {
+    os << llvm::formatv(" (+{} dynamic)", estimate.dynamicCount);
+  }
+  int64_t workersRequired =
+      IREE::Stream::estimateWorkersRequired(estimate.cost);
+  if (workerCount > 0) {
+    os << llvm::formatv(", fills {}/{} workers",
+                        std::min(workersRequired, workerCount), workerCount);
+  } else {
+    os << llvm::formatv(", ~{} workers", workersRequired);
+  }
+  os << "\n";
+}
+
 static void prettyPrintStreamInfo(const UsageInfo &usageInfo,
                                   IREE::Stream::CmdExecuteOp executeOp,
                                   llvm::raw_fd_ostream &os) {
@@ -299,6 +423,18 @@ static void prettyPrintStreamInfo(const UsageInfo &usageInfo,
   os << "\n";
   os << "//\n";
 
+  // Estimated work per partition as used when scheduling concurrency.
+  int64_t workerCount =
+      IREE::Stream::PartitioningConfigAttr::lookup(executeOp).getWorkerCount();
+  prettyPrintCostEstimate("Estimated work", estimateNestedCost(executeOp),
+                          workerCount, os);
+  unsigned waveOrdinal = 0;
+  executeOp.walk([&](IREE::Stream::CmdConcurrentOp concurrentOp) {
+    prettyPrintCostEstimate(llvm::formatv("  Wave {}", waveOrdinal++).str(),
+                            estimateNestedCost(concurrentOp), workerCount, os);
+  });
+  os << "//\n";
+
   // TODO(benvanik): print stream information (for each stream.cmd.execute):
   // - number of unique resources captured
   // - number of commands of each type
@@ -387,6 +523,7 @@ static void prettyPrintUsageInfo(const UsageInfo &usageInfo, bool verbose,
   prettyPrintStatistics(usageInfo, os);
   prettyPrintGlobalInfo(usageInfo, verbose, os);
   prettyPrintSyncInfo(usageInfo, verbose, os);
+  prettyPrintTransientInfo(usageInfo, verbose, os);
   prettyPrintAllStreamInfo(usageInfo, verbose, os);
   prettyPrintAllExecutableInfo(usageInfo, verbose, os);
 }
@@ -534,6 +671,9 @@ static void dumpAggregateJSONStructure(const UsageInfo &usageInfo,
   os << "  \"execution\": {\n";
   os << llvm::formatv(kvPair, "submission-count", stats.submissionCount);
   os << llvm::formatv(kvPair, "transient-memory-size", stats.transientSize);
+  os << llvm::formatv(kvPair, "transient-pack-count", stats.transientPackCount);
+  os << llvm::formatv(kvPair, "transient-wasted-size",
+                      stats.transientWastedSize);
   os << llvm::formatv(kvPair, "fill-count", stats.fillCount);
   os << llvm::formatv(kvPair, "copy-count", stats.copyCount);
   os << llvm::formatv(kvPair, "dispatch-count", stats.dispatchCount);
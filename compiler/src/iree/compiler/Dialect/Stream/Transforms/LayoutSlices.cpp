@@ -4,7 +4,8 @@
 // See https://llvm.org/LICENSE.txt for license information.
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
-#include <list>
+#include <tuple>
+#include <utility>
 
 #include "iree/compiler/Dialect/Stream/IR/StreamDialect.h"
 #include "iree/compiler/Dialect/Stream/IR/StreamOps.h"
@@ -14,6 +15,8 @@
 #include "iree/compiler/Dialect/Util/IR/UtilOps.h"
 #include "iree/compiler/Dialect/Util/IR/UtilTypes.h"
 #include "iree/compiler/Utils/IntegerSet.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/Sequence.h"
 #include "llvm/Support/Debug.h"
 #include "mlir/Dialect/Arith/IR/Arith.h"
 #include "mlir/IR/AsmState.h"
@@ -34,96 +37,343 @@ namespace {
 
 using Slice = IREE::Stream::ResourcePackOp::Slice;
 
-// Packs a set of statically-sized slices by greedy strip packing.
+//===----------------------------------------------------------------------===//
+// Static slice packing
+//===----------------------------------------------------------------------===//
+
+// A statically-sized slice with its size aligned to the range alignment.
+struct StaticSlice {
+  int64_t lifetimeStart = 0;
+  int64_t lifetimeEnd = 0;
+  int64_t size = 0;
+  bool intersects(const StaticSlice &rhs) const {
+    return lifetimeEnd >= rhs.lifetimeStart && rhs.lifetimeEnd >= lifetimeStart;
+  }
+};
+
+// Static offsets assigned to each slice by a packing strategy.
+struct StaticLayout {
+  // Name of the strategy that produced the layout (for statistics).
+  StringRef strategy;
+  // Offset of each slice in the original slice order.
+  SmallVector<int64_t> offsets;
+  // Total size of the layout (highwater mark aligned to the range alignment).
+  int64_t size = INT64_MAX;
+};
+
+// How a slice is placed among the existing reservations it overlaps with.
+enum class Placement {
+  // Places the slice in the smallest gap that fits or at the end.
+  SmallestGap,
+  // Places the slice at whichever candidate offset keeps the highwater mark
+  // lowest, breaking ties by the lowest offset.
+  LowestHighwater,
+};
+
+// Packs |slices| in the given |order| by greedy strip packing.
 //
 // This is the same algorithm used in tflite here:
 // https://github.com/tensorflow/tensorflow/blob/master/tensorflow/lite/simple_memory_arena.cc
-// It's not fantastic and can end up with a significant amount of wastage.
-// They do the packing at runtime and as such care more about performance than
-// we do while doing the packing here offline. For this initial version I
-// wanted to ensure we matched apples/apples their implementation.
-//
-// We should use a set of heuristics and pick the smallest one. There are also
-// some really great papers that have approximations (as all of these are -
-// 2D strip packing is NP-hard) such as
+// Depending on the slice order and placement policy it can end up with a
+// significant amount of wastage and callers should try several and keep the
+// best. 2D strip packing is NP-hard; there are papers with better
+// approximations such as
 // https://www.sciencedirect.com/science/article/pii/S0925772113001016 that
-// someone with a brain able to parse mathy papers can try implementing.
-//
-// Slice packed offset SSA values will be updated and start at the given
-// |baseOffset|. Returns |baseOffset| + the total size of the allocation
-// aligned to the requirements of |resourceConfig|.
-static Value
-packStaticSlicesGreedily(IREE::Stream::ResourcePackOp packOp, Value baseOffset,
-                         MutableArrayRef<Slice> slices,
-                         IREE::Stream::ResourceConfigAttr resourceConfig,
-                         IndexSet &indexSet, OpBuilder &builder) {
-  int64_t offsetAlignment = resourceConfig.getMinBufferOffsetAlignment();
-  int64_t rangeAlignment = resourceConfig.getMinBufferRangeAlignment();
-
+// could be added as additional strategies.
+static StaticLayout packStaticSlicesGreedily(ArrayRef<StaticSlice> slices,
+                                             ArrayRef<unsigned> order,
+                                             Placement placement,
+                                             int64_t offsetAlignment,
+                                             int64_t rangeAlignment) {
   struct Reservation {
-    const Slice *slice = nullptr;
+    unsigned sliceIndex = 0;
     int64_t staticOffset = 0;
     int64_t staticSize = 0;
   };
   static constexpr int64_t UNASSIGNED = INT64_MAX;
 
-  std::list<Reservation> reservations;
+  StaticLayout layout;
+  layout.offsets.resize(slices.size(), 0);
+
+  // Sorted by ascending offset.
+  SmallVector<Reservation> reservations;
+  reservations.reserve(slices.size());
   int64_t highwaterMark = 0;
-  for (auto &slice : slices) {
+  for (unsigned sliceIndex : order) {
+    const StaticSlice &slice = slices[sliceIndex];
     int64_t bestOffset = UNASSIGNED;
-    int64_t bestOffsetFit = UNASSIGNED;
-    int64_t staticSize =
-        cast<arith::ConstantIndexOp>(slice.dynamicSize.getDefiningOp()).value();
-    int64_t alignedSize = IREE::Util::align(staticSize, rangeAlignment);
-
-    // Iterate through reservations (sorted by ascending offset) and identify
-    // gaps in which the slice will fit. To reduce wastage we want to find the
-    // smallest gap.
-    int64_t currentOffset = 0;
-    for (auto &reservation : reservations) {
-      if (!reservation.slice->intersects(slice)) {
-        // Non-overlapping - we can reuse the currentOffset (assuming we find
-        // no better place).
-        continue;
-      }
+    if (placement == Placement::SmallestGap) {
+      // Iterate through reservations (sorted by ascending offset) and identify
+      // gaps in which the slice will fit. To reduce wastage we want to find the
+      // smallest gap.
+      int64_t bestOffsetFit = UNASSIGNED;
+      int64_t currentOffset = 0;
+      for (auto &reservation : reservations) {
+        if (!slices[reservation.sliceIndex].intersects(slice)) {
+          // Non-overlapping - we can reuse the currentOffset (assuming we find
+          // no better place).
+          continue;
+        }
 
-      // If we found a gap >= the required size and smaller than
-      // previous best fit take it.
-      int64_t alignedOffset = IREE::Util::align(currentOffset, offsetAlignment);
-      if (alignedOffset + alignedSize <= reservation.staticOffset &&
-          reservation.staticOffset - alignedOffset < bestOffsetFit) {
-        bestOffset = alignedOffset;
-        bestOffsetFit = reservation.staticOffset - currentOffset;
+        // If we found a gap >= the required size and smaller than
+        // previous best fit take it.
+        int64_t alignedOffset =
+            IREE::Util::align(currentOffset, offsetAlignment);
+        if (alignedOffset + slice.size <= reservation.staticOffset &&
+            reservation.staticOffset - alignedOffset < bestOffsetFit) {
+          bestOffset = alignedOffset;
+          bestOffsetFit = reservation.staticOffset - currentOffset;
+        }
+        currentOffset = std::max(currentOffset, reservation.staticOffset +
+                                                    reservation.staticSize);
+      }
+      if (bestOffset == UNASSIGNED) {
+        bestOffset = IREE::Util::align(currentOffset, offsetAlignment);
+      }
+    } else {
+      // Candidate offsets are the start of the slab and the (aligned) end of
+      // every overlapping reservation; any optimal placement can be slid down
+      // to one of them.
+      int64_t bestHighwater = UNASSIGNED;
+      auto tryOffset = [&](int64_t offset) {
+        for (auto &reservation : reservations) {
+          if (reservation.staticOffset >= offset + slice.size)
+            break;
+          if (reservation.staticOffset + reservation.staticSize > offset &&
+              slices[reservation.sliceIndex].intersects(slice)) {
+            return;
+          }
+        }
+        int64_t newHighwater = std::max(highwaterMark, offset + slice.size);
+        if (newHighwater < bestHighwater ||
+            (newHighwater == bestHighwater && offset < bestOffset)) {
+          bestHighwater = newHighwater;
+          bestOffset = offset;
+        }
+      };
+      tryOffset(0);
+      for (auto &reservation : reservations) {
+        if (slices[reservation.sliceIndex].intersects(slice)) {
+          tryOffset(IREE::Util::align(
+              reservation.staticOffset + reservation.staticSize,
+              offsetAlignment));
+        }
       }
-      currentOffset = std::max(currentOffset, reservation.staticOffset +
-                                                  reservation.staticSize);
-    }
-    if (bestOffset == UNASSIGNED) {
-      bestOffset = IREE::Util::align(currentOffset, offsetAlignment);
     }
 
     // Reserve the memory.
     Reservation reservation;
-    reservation.slice = &slice;
+    reservation.sliceIndex = sliceIndex;
     reservation.staticOffset = bestOffset;
-    reservation.staticSize = alignedSize;
+    reservation.staticSize = slice.size;
     auto insertionIt = reservations.begin();
     while (insertionIt != reservations.end() &&
            insertionIt->staticOffset < reservation.staticOffset) {
       ++insertionIt;
     }
     reservations.insert(insertionIt, reservation);
-    slice.packedOffset.replaceAllUsesWith(builder.createOrFold<arith::AddIOp>(
-        packOp.getLoc(), baseOffset, indexSet.get(bestOffset)));
+    layout.offsets[sliceIndex] = bestOffset;
 
     // Update highwater mark indicating how much memory needs to be allocated
     // for the entire slab.
-    highwaterMark = std::max(highwaterMark, bestOffset + alignedSize);
+    highwaterMark = std::max(highwaterMark, bestOffset + slice.size);
+  }
+
+  layout.size = IREE::Util::align(highwaterMark, rangeAlignment);
+  return layout;
+}
+
+// Returns the maximum total size of slices live at the same time. No layout
+// can be smaller than this.
+static int64_t computeStaticLowerBound(ArrayRef<StaticSlice> slices) {
+  // Lifetimes are inclusive so starts sort before ends at the same point.
+  SmallVector<std::tuple<int64_t, bool, int64_t>> events;
+  events.reserve(slices.size() * 2);
+  for (auto &slice : slices) {
+    events.emplace_back(slice.lifetimeStart, false, slice.size);
+    events.emplace_back(slice.lifetimeEnd, true, slice.size);
+  }
+  llvm::sort(events);
+  int64_t liveSize = 0;
+  int64_t maxLiveSize = 0;
+  for (auto [point, isEnd, size] : events) {
+    if (isEnd) {
+      liveSize -= size;
+    } else {
+      liveSize += size;
+      maxLiveSize = std::max(maxLiveSize, liveSize);
+    }
+  }
+  return maxLiveSize;
+}
+
+// Returns the maximum total size of slices live at the same time as each
+// slice. Slices in the most crowded parts of the program are the hardest to
+// place and packing them first tends to reduce wastage.
+static SmallVector<int64_t>
+computeStaticSliceBreadths(ArrayRef<StaticSlice> slices) {
+  SmallVector<int64_t> breadths(slices.size(), 0);
+  for (unsigned i = 0; i < slices.size(); ++i) {
+    // Interval cliques are found at the start of one of their members.
+    for (unsigned j = 0; j < slices.size(); ++j) {
+      const StaticSlice &point = slices[j];
+      if (!slices[i].intersects(point) ||
+          point.lifetimeStart < slices[i].lifetimeStart) {
+        continue;
+      }
+      int64_t liveSize = 0;
+      for (auto &slice : slices) {
+        if (slice.lifetimeStart <= point.lifetimeStart &&
+            slice.lifetimeEnd >= point.lifetimeStart) {
+          liveSize += slice.size;
+        }
+      }
+      breadths[i] = std::max(breadths[i], liveSize);
+    }
+  }
+  return breadths;
+}
+
+// Slice counts above which the more expensive strategies are skipped to keep
+// compilation time bounded. Greedy packing is O(n^2), breadth computation and
+// offset search O(n^3) and the local search runs up to
+// |kLocalSearchEvaluations| greedy packings.
+static constexpr size_t kMaxBreadthSlices = 256;
+static constexpr size_t kMaxOffsetSearchSlices = 512;
+static constexpr size_t kMaxLocalSearchSlices = 256;
+static constexpr int kLocalSearchEvaluations = 256;
+
+// Packs |slices| with several strategies and returns the smallest layout.
+// Ties prefer the earlier strategy so the result is deterministic and matches
+// the plain greedy packing whenever nothing better is found.
+static StaticLayout computeStaticLayout(ArrayRef<StaticSlice> slices,
+                                        int64_t offsetAlignment,
+                                        int64_t rangeAlignment) {
+  StaticLayout bestLayout;
+  SmallVector<unsigned> bestOrder;
+  auto tryLayout = [&](StringRef strategy, ArrayRef<unsigned> order,
+                       Placement placement) {
+    StaticLayout layout = packStaticSlicesGreedily(
+        slices, order, placement, offsetAlignment, rangeAlignment);
+    if (layout.size < bestLayout.size) {
+      layout.strategy = strategy;
+      bestLayout = std::move(layout);
+      if (placement == Placement::SmallestGap)
+        bestOrder.assign(order.begin(), order.end());
+      return true;
+    }
+    return false;
+  };
+
+  // Slices in the order they were defined (ascending lifetime).
+  SmallVector<unsigned> lifetimeOrder =
+      llvm::to_vector(llvm::seq<unsigned>(0, slices.size()));
+  tryLayout("greedy", lifetimeOrder, Placement::SmallestGap);
+
+  // Largest slices first.
+  SmallVector<unsigned> sizeOrder = lifetimeOrder;
+  llvm::stable_sort(sizeOrder, [&](unsigned lhs, unsigned rhs) {
+    return slices[lhs].size > slices[rhs].size;
+  });
+  tryLayout("greedy-by-size", sizeOrder, Placement::SmallestGap);
+
+  // Slices live during the most crowded points first, then largest first.
+  if (slices.size() <= kMaxBreadthSlices) {
+    SmallVector<int64_t> breadths = computeStaticSliceBreadths(slices);
+    SmallVector<unsigned> breadthOrder = lifetimeOrder;
+    llvm::stable_sort(breadthOrder, [&](unsigned lhs, unsigned rhs) {
+      return std::make_pair(breadths[lhs], slices[lhs].size) >
+             std::make_pair(breadths[rhs], slices[rhs].size);
+    });
+    tryLayout("greedy-by-breadth", breadthOrder, Placement::SmallestGap);
+  }
+
+  // Search all candidate offsets for each slice instead of taking the
+  // smallest gap.
+  if (slices.size() <= kMaxOffsetSearchSlices) {
+    tryLayout("offset-search", sizeOrder, Placement::LowestHighwater);
+  }
+
+  // Bounded local search: swap adjacent slices in the best greedy order and
+  // keep any swap that shrinks the layout.
+  if (slices.size() > 1 && slices.size() <= kMaxLocalSearchSlices &&
+      !bestOrder.empty()) {
+    int64_t lowerBound = computeStaticLowerBound(slices);
+    SmallVector<unsigned> order = bestOrder;
+    int evaluations = 0;
+    bool improved = true;
+    while (improved && evaluations < kLocalSearchEvaluations &&
+           bestLayout.size > lowerBound) {
+      improved = false;
+      for (unsigned i = 0; i + 1 < order.size() &&
+                           evaluations < kLocalSearchEvaluations &&
+                           bestLayout.size > lowerBound;
+           ++i, ++evaluations) {
+        std::swap(order[i], order[i + 1]);
+        if (tryLayout("local-search", order, Placement::SmallestGap)) {
+          improved = true;
+        } else {
+          std::swap(order[i], order[i + 1]);
+        }
+      }
+    }
+  }
+
+  return bestLayout;
+}
+
+// Statistics about how well a pack was laid out.
+struct PackStatistics {
+  size_t staticSliceCount = 0;
+  // Total size of the static slices as laid out.
+  int64_t staticSize = 0;
+  // Size no layout could go below given the slice lifetimes.
+  int64_t staticLowerBound = 0;
+  // Strategy that produced the layout.
+  StringRef strategy;
+};
+
+// Packs a set of statically-sized slices using the best of several strategies.
+//
+// Slice packed offset SSA values will be updated and start at the given
+// |baseOffset|. Returns |baseOffset| + the total size of the allocation
+// aligned to the requirements of |resourceConfig|.
+static Value packStaticSlices(IREE::Stream::ResourcePackOp packOp,
+                              Value baseOffset, MutableArrayRef<Slice> slices,
+                              IREE::Stream::ResourceConfigAttr resourceConfig,
+                              IndexSet &indexSet, OpBuilder &builder,
+                              PackStatistics &statistics) {
+  int64_t offsetAlignment = resourceConfig.getMinBufferOffsetAlignment();
+  int64_t rangeAlignment = resourceConfig.getMinBufferRangeAlignment();
+
+  SmallVector<StaticSlice> staticSlices;
+  staticSlices.reserve(slices.size());
+  for (auto &slice : slices) {
+    int64_t staticSize =
+        cast<arith::ConstantIndexOp>(slice.dynamicSize.getDefiningOp()).value();
+    staticSlices.push_back({slice.lifetimeStart, slice.lifetimeEnd,
+                            IREE::Util::align(staticSize, rangeAlignment)});
   }
 
-  highwaterMark = IREE::Util::align(highwaterMark, rangeAlignment);
+  StaticLayout layout =
+      computeStaticLayout(staticSlices, offsetAlignment, rangeAlignment);
+  LLVM_DEBUG(llvm::dbgs() << "packed " << slices.size() << " static slices "
+                          << "into " << layout.size << " bytes using "
+                          << layout.strategy << "\n");
+
+  for (auto [slice, offset] : llvm::zip_equal(slices, layout.offsets)) {
+    slice.packedOffset.replaceAllUsesWith(builder.createOrFold<arith::AddIOp>(
+        packOp.getLoc(), baseOffset, indexSet.get(offset)));
+  }
+
+  statistics.staticSliceCount = slices.size();
+  statistics.staticSize = layout.size;
+  statistics.staticLowerBound = IREE::Util::align(
+      computeStaticLowerBound(staticSlices), rangeAlignment);
+  statistics.strategy = layout.strategy;
+
   return builder.createOrFold<arith::AddIOp>(packOp.getLoc(), baseOffset,
-                                             indexSet.get(highwaterMark));
+                                             indexSet.get(layout.size));
 }
 
 // Packs a set of dynamically-sized slices based on the structural information
@@ -218,8 +468,33 @@ packDynamicSlicesConservatively(IREE::Stream::ResourcePackOp packOp,
 // --iree-stream-layout-slices
 //===----------------------------------------------------------------------===//
 
+// Attributes the packing statistics of |packOp| to the allocations sized by
+// it so that they survive the pack being erased and can be reported by
+// --iree-stream-dump-statistics.
+static void annotatePackStatistics(IREE::Stream::ResourcePackOp packOp,
+                                   const PackStatistics &statistics) {
+  Builder builder(packOp.getContext());
+  auto statisticsAttr = builder.getDictionaryAttr({
+      builder.getNamedAttr(
+          "slices", builder.getIndexAttr(statistics.staticSliceCount)),
+      builder.getNamedAttr("size",
+                           builder.getIndexAttr(statistics.staticSize)),
+      builder.getNamedAttr(
+          "lower_bound", builder.getIndexAttr(statistics.staticLowerBound)),
+      builder.getNamedAttr("strategy",
+                           builder.getStringAttr(statistics.strategy)),
+  });
+  for (auto *user : packOp.getTotalLength().getUsers()) {
+    if (isa<IREE::Stream::ResourceAllocaOp>(user)) {
+      user->setAttr("stream.pack_statistics", statisticsAttr);
+    }
+  }
+}
+
 struct LayoutSlicesPass
     : public IREE::Stream::impl::LayoutSlicesPassBase<LayoutSlicesPass> {
+  using IREE::Stream::impl::LayoutSlicesPassBase<
+      LayoutSlicesPass>::LayoutSlicesPassBase;
   void runOnOperation() override {
     auto parentOp = getOperation();
     if (!parentOp.getCallableRegion() ||
@@ -227,9 +502,6 @@ struct LayoutSlicesPass
       return;
     }
 
-    // NOTE: we could try several algorithms and compute which packs best. For
-    // now we just pack greedily as it's fast and what most existing ML
-    // frameworks do.
     parentOp.walk([&](IREE::Stream::ResourcePackOp packOp) {
       // Derive resource constraints based on pack affinity.
       auto resourceConfig = IREE::Stream::ResourceConfigAttr::lookup(packOp);
@@ -256,9 +528,16 @@ struct LayoutSlicesPass
       // First pack all static slices as these are entirely knowable here at
       // compile time.
       auto offset = packOp.getOffset() ? packOp.getOffset() : indexSet.get(0);
+      PackStatistics statistics;
       if (!staticSlices.empty()) {
-        offset = packStaticSlicesGreedily(packOp, offset, staticSlices,
-                                          resourceConfig, indexSet, builder);
+        offset = packStaticSlices(packOp, offset, staticSlices, resourceConfig,
+                                  indexSet, builder, statistics);
+        packedStaticBytes += statistics.staticSize;
+        wastedStaticBytes +=
+            statistics.staticSize - statistics.staticLowerBound;
+        if (statistics.strategy != "greedy") {
+          ++improvedPacks;
+        }
 
         // TODO(benvanik): make this an option; it can be useful for debugging
         // this code.
@@ -274,6 +553,10 @@ struct LayoutSlicesPass
             packOp, offset, dynamicSlices, resourceConfig, indexSet, builder);
       }
 
+      if (annotateStatistics && !staticSlices.empty()) {
+        annotatePackStatistics(packOp, statistics);
+      }
+
       // Total packed length is the current offset after all slices are
       // allocated. This should be aligned to the range constraints.
       packOp.getTotalLength().replaceAllUsesWith(offset);
@@ -13,6 +13,7 @@
 #include "iree/compiler/Dialect/Util/IR/UtilTypes.h"
 #include "iree/compiler/Utils/IntegerSet.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/MathExtras.h"
 #include "mlir/Dialect/SCF/IR/SCF.h"
 #include "mlir/IR/AsmState.h"
 #include "mlir/IR/Attributes.h"
@@ -85,22 +86,58 @@ struct StorageResource {
   // It must be written with an alignment as required by the constraints.
   // If not set then each span may have unique storage.
   IREE::Util::CompositeAttr packedData;
+  // Required alignment of the storage in bytes. Defaults to the minimum buffer
+  // offset alignment of the resource configuration when 0.
+  uint64_t alignment = 0;
 };
 
+// Returns true if |slice| should be placed on its own pages when packing with
+// |pageSize|. Only constants of at least a page are worth the padding.
+static bool isPageAlignedSlice(const ConstantSlice &slice, uint64_t pageSize) {
+  return pageSize > 0 && slice.getStorageSize() >= pageSize;
+}
+
 // Buckets |slices| into 1+ storage resources based on |resourceConfig|.
+//
+// If |pageSize| is non-zero then all constants of at least a page in size are
+// placed after the smaller constants at page-aligned offsets and padded to
+// page boundaries. Together with page-aligned storage this allows the runtime
+// to alias each large constant directly from the mapped module (or archive)
+// without pulling in neighboring data or performing upload copies.
 static SmallVector<StorageResource> bucketValuesIntoStorageResources(
     ArrayRef<ConstantSlice> slices,
-    IREE::Stream::ResourceConfigAttr resourceConfig) {
+    IREE::Stream::ResourceConfigAttr resourceConfig, uint64_t pageSize) {
+  // Small constants are kept densely packed at the head of the storage where
+  // they share pages. The relative order of slices within each group is
+  // preserved as it reflects locality established by prior passes.
+  SmallVector<ConstantSlice> orderedSlices;
+  orderedSlices.reserve(slices.size());
+  for (auto &slice : slices) {
+    if (!isPageAlignedSlice(slice, pageSize)) {
+      orderedSlices.push_back(slice);
+    }
+  }
+  for (auto &slice : slices) {
+    if (isPageAlignedSlice(slice, pageSize)) {
+      orderedSlices.push_back(slice);
+    }
+  }
+
   // TODO(benvanik): replace with a better strategy (best-fit, etc).
   SmallVector<StorageResource> storageBuffers;
   storageBuffers.push_back({UnknownLoc::get(resourceConfig.getContext())});
   StorageResource *currentBuffer = &storageBuffers.back();
-  for (auto slice : slices) {
-    uint64_t offset = IREE::Util::align(
-        currentBuffer->totalSize, resourceConfig.getMinBufferOffsetAlignment());
+  for (auto slice : orderedSlices) {
+    uint64_t offsetAlignment = resourceConfig.getMinBufferOffsetAlignment();
+    uint64_t rangeAlignment = resourceConfig.getMinBufferRangeAlignment();
+    if (isPageAlignedSlice(slice, pageSize)) {
+      offsetAlignment = std::max<uint64_t>(offsetAlignment, pageSize);
+      rangeAlignment = std::max<uint64_t>(rangeAlignment, pageSize);
+    }
+    uint64_t offset =
+        IREE::Util::align(currentBuffer->totalSize, offsetAlignment);
     uint64_t unpaddedLength = slice.getStorageSize();
-    uint64_t paddedLength = IREE::Util::align(
-        unpaddedLength, resourceConfig.getMinBufferRangeAlignment());
+    uint64_t paddedLength = IREE::Util::align(unpaddedLength, rangeAlignment);
     if (offset + unpaddedLength > resourceConfig.getMaxAllocationSize()) {
       // Spilling buffer; make a new one.
       storageBuffers.push_back({UnknownLoc::get(resourceConfig.getContext())});
@@ -110,6 +147,9 @@ static SmallVector<StorageResource> bucketValuesIntoStorageResources(
     currentBuffer->spans.push_back({slice, offset, unpaddedLength});
     currentBuffer->totalSize =
         std::max(currentBuffer->totalSize, offset + paddedLength);
+    if (offsetAlignment > currentBuffer->alignment) {
+      currentBuffer->alignment = offsetAlignment;
+    }
   }
   if (storageBuffers.back().spans.empty()) {
     storageBuffers.pop_back();
@@ -192,7 +232,7 @@ static void packStorageResourceData(StorageResource &storageBuffer,
 static SmallVector<StorageResource>
 computePackingMap(ArrayRef<ConstantSlice> slices,
                   IREE::Stream::ResourceConfigAttr resourceConfig,
-                  MLIRContext *context) {
+                  uint64_t pageSize, MLIRContext *context) {
   // This is literally all my brain has brain for right now. The ideal here is
   // that we have a basic static (and ideally profile-guided) sorting pass
   // that keeps constant values that are accessed sorted together.
@@ -226,7 +266,7 @@ computePackingMap(ArrayRef<ConstantSlice> slices,
 
   // Build a list of resources and spans (append to current or spill to new).
   auto storageBuffers =
-      bucketValuesIntoStorageResources(slices, resourceConfig);
+      bucketValuesIntoStorageResources(slices, resourceConfig, pageSize);
 
   // Pack each storage resource bucket into a single data blob.
   for (auto &storageBuffer : storageBuffers) {
@@ -457,12 +497,12 @@ static TimepointResource buildTryMapConstantResource(
 static Value generateSerializedUpload(
     Value awaitTimepoint, IREE::Stream::AffinityAttr affinityAttr,
     IREE::Stream::ResourceConfigAttr resourceConfig,
-    ArrayRef<ConstantSlice> slices, IntegerSet<int64_t> &i64Set,
-    IndexSet &indexSet, OpBuilder &builder) {
+    ArrayRef<ConstantSlice> slices, uint64_t pageSize,
+    IntegerSet<int64_t> &i64Set, IndexSet &indexSet, OpBuilder &builder) {
   // Perform the packing of dense values to compute the storage resources we
   // will need and where each value will be placed.
-  auto storageResources =
-      computePackingMap(slices, resourceConfig, builder.getContext());
+  auto storageResources = computePackingMap(slices, resourceConfig, pageSize,
+                                            builder.getContext());
   if (storageResources.empty())
     return nullptr;
 
@@ -481,7 +521,9 @@ static Value generateSerializedUpload(
     // Serialized resources are stored as packed host data.
     Value storageBuffer = builder.create<IREE::Util::BufferConstantOp>(
         storageResource.loc, /*name=*/nullptr, storageResource.packedData,
-        builder.getIndexAttr(resourceConfig.getMinBufferOffsetAlignment()),
+        builder.getIndexAttr(
+            std::max<uint64_t>(storageResource.alignment,
+                               resourceConfig.getMinBufferOffsetAlignment())),
         /*mimeType=*/nullptr);
 
     // If this is producing constants (vs variables) we can try to go on a
@@ -517,8 +559,8 @@ static Value generateSerializedUpload(
 static Value generateParameterUpload(
     Value awaitTimepoint, IREE::Stream::AffinityAttr affinityAttr,
     IREE::Stream::ResourceConfigAttr resourceConfig,
-    ArrayRef<ConstantSlice> slices, IntegerSet<int64_t> &i64Set,
-    IndexSet &indexSet, OpBuilder &builder) {
+    ArrayRef<ConstantSlice> slices, uint64_t pageSize,
+    IntegerSet<int64_t> &i64Set, IndexSet &indexSet, OpBuilder &builder) {
   auto anyResult = slices.front().result;
   auto resourceType =
       llvm::cast<IREE::Stream::ResourceType>(anyResult.getType());
@@ -529,11 +571,18 @@ static Value generateParameterUpload(
   // emit one resource per parameter for loading _or_ we gather everything) but
   // could be refined to only try loading large resources while we pack the
   // small resources. e.g. try to reuse a 1GB parameter but pack 1000 128B
-  // parameters together.
+  // parameters together. When packing for mapping with a |pageSize| only
+  // parameters of at least a page are loaded directly while smaller ones are
+  // gathered together.
   SmallVector<StorageResource> storageResources;
   if (resourceType.getLifetime() == IREE::Stream::Lifetime::Constant &&
       resourceConfig.getMemoryModel() == IREE::Stream::MemoryModel::Unified) {
+    SmallVector<ConstantSlice> gatheredSlices;
     for (auto &slice : slices) {
+      if (pageSize > 0 && !isPageAlignedSlice(slice, pageSize)) {
+        gatheredSlices.push_back(slice);
+        continue;
+      }
       uint64_t sliceSize = slice.getStorageSize();
       storageResources.push_back(StorageResource{slice.result.getLoc(),
                                                  sliceSize,
@@ -545,9 +594,17 @@ static Value generateParameterUpload(
                                                      },
                                                  }});
     }
+    if (!gatheredSlices.empty()) {
+      llvm::append_range(storageResources,
+                         computePackingMap(gatheredSlices, resourceConfig,
+                                           /*pageSize=*/0,
+                                           builder.getContext()));
+    }
   } else {
-    storageResources =
-        computePackingMap(slices, resourceConfig, builder.getContext());
+    // Gathers always copy into a new allocation and gain nothing from page
+    // alignment.
+    storageResources = computePackingMap(
+        slices, resourceConfig, /*pageSize=*/0, builder.getContext());
   }
   if (storageResources.empty())
     return nullptr;
@@ -596,8 +653,8 @@ static Value generateParameterUpload(
 static Value generateUploads(Value awaitTimepoint,
                              IREE::Stream::ResourceConstantsOp constantsOp,
                              IREE::Stream::ResourceConfigAttr resourceConfig,
-                             IntegerSet<int64_t> &i64Set, IndexSet &indexSet,
-                             OpBuilder &builder) {
+                             uint64_t pageSize, IntegerSet<int64_t> &i64Set,
+                             IndexSet &indexSet, OpBuilder &builder) {
   // Split the slices based on whether they are sourced from serialized data or
   // externally-defined parameters.
   // TODO(benvanik): remove stream.resource.constants and this coupling;
@@ -625,12 +682,12 @@ static Value generateUploads(Value awaitTimepoint,
   if (!serializedSlices.empty()) {
     uploadTimepoints.push_back(generateSerializedUpload(
         awaitTimepoint, constantsOp.getAffinityAttr(), resourceConfig,
-        serializedSlices, i64Set, indexSet, builder));
+        serializedSlices, pageSize, i64Set, indexSet, builder));
   }
   if (!parameterSlices.empty()) {
     uploadTimepoints.push_back(generateParameterUpload(
         awaitTimepoint, constantsOp.getAffinityAttr(), resourceConfig,
-        parameterSlices, i64Set, indexSet, builder));
+        parameterSlices, pageSize, i64Set, indexSet, builder));
   }
   return IREE::Stream::TimepointJoinOp::join(uploadTimepoints, builder);
 }
@@ -651,6 +708,9 @@ static Value generateUploads(Value awaitTimepoint,
 
 struct PackConstantsPass
     : public IREE::Stream::impl::PackConstantsPassBase<PackConstantsPass> {
+  using IREE::Stream::impl::PackConstantsPassBase<
+      PackConstantsPass>::PackConstantsPassBase;
+
   void runOnOperation() override {
     auto parentOp = getOperation();
     if (!parentOp || !parentOp.getCallableRegion() ||
@@ -658,6 +718,15 @@ struct PackConstantsPass
       return;
     }
 
+    // Offsets and lengths are aligned to the page size with IREE::Util::align
+    // which requires a power of two.
+    if (pageSize < 0 || (pageSize > 0 && !llvm::isPowerOf2_64(pageSize))) {
+      parentOp.emitError() << "constant page size must be zero or a power of "
+                              "two; got "
+                           << pageSize;
+      return signalPassFailure();
+    }
+
     parentOp.walk([&](IREE::Stream::ResourceConstantsOp constantsOp) {
       // Derive resource constraints based on pack affinity.
       auto resourceConfig =
@@ -675,8 +744,9 @@ struct PackConstantsPass
       Value awaitTimepoint = builder.create<IREE::Stream::TimepointImmediateOp>(
           constantsOp.getLoc());
       auto uploadTimepoint =
-          generateUploads(awaitTimepoint, constantsOp, resourceConfig, i64Set,
-                          indexSet, builder);
+          generateUploads(awaitTimepoint, constantsOp, resourceConfig,
+                          static_cast<uint64_t>(pageSize), i64Set, indexSet,
+                          builder);
       constantsOp.getResultTimepoint().replaceAllUsesWith(uploadTimepoint);
 
       constantsOp.erase();
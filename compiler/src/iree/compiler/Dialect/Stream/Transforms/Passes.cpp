@@ -229,10 +229,10 @@ void buildStreamAsyncPassPipeline(OpPassManager &passManager,
   // for partitioning/placement before turning them into opaque dispatches.
   passManager.addPass(IREE::Stream::createMaterializeBuiltinsPass());
 
-  // TODO(benvanik): outline streams (ala dispatch regions). Note that we may
-  // want to do this earlier to enable better deduplication but that makes the
-  // above passes trickier. Outlining may be more like "find chunks of streams
-  // useful to move into secondary command buffers."
+  // TODO(benvanik): outline partial streams (ala dispatch regions). Whole
+  // execution regions are deduplicated during HAL memoization but outlining
+  // may be more like "find chunks of streams useful to move into secondary
+  // command buffers."
 
   buildStreamCleanupPassPipeline(passManager, transformOptions);
 
@@ -254,12 +254,22 @@ void buildStreamCmdPassPipeline(OpPassManager &passManager,
       // Allocate backing storage for fused constant resources.
       // This expands packed constants into explicit forms with partitioned
       // storage buffers and upload logic.
-      .addPass(IREE::Stream::createPackConstantsPass)
+      .addPass([&]() {
+        IREE::Stream::PackConstantsPassOptions options;
+        options.pageSize = transformOptions.constantPageSize;
+        return IREE::Stream::createPackConstantsPass(options);
+      })
 
       // Layout packed slices to emit the arithmetic required for all resource
       // offsets. This enables us to propagate the subviews across the program
       // below.
-      .addPass(IREE::Stream::createLayoutSlicesPass)
+      .addPass([&]() {
+        // Statistics dumping reports how well transients were packed.
+        LayoutSlicesPassOptions options;
+        options.annotateStatistics = transformOptions.dumpStatisticsFormat !=
+                                     DumpOutputFormat::None;
+        return IREE::Stream::createLayoutSlicesPass(options);
+      })
 
       // Apply canonicalization patterns to clean up subview ops prior to
       // propagating subranges.
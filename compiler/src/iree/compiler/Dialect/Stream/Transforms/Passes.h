@@ -80,6 +80,14 @@ struct TransformOptions : public PassPipelineOptions<TransformOptions> {
       llvm::cl::init(true),
   };
 
+  Option<int64_t> constantPageSize{
+      *this,
+      "constant-page-size",
+      llvm::cl::desc("Page size in bytes used to align large constants for "
+                     "zero-copy mapping or 0 to pack all constants densely."),
+      llvm::cl::init(0),
+  };
+
   Option<DumpOutputFormat> dumpStatisticsFormat{
       *this,
       "dump-statistics-format",
@@ -11,6 +11,11 @@
 // CHECK-PRETTY: Collectives: 0
 // CHECK-PRETTY:  Dispatches: 3
 // CHECK-PRETTY: Executables: 2, 33% reuse
+// CHECK-PRETTY: Streams
+// CHECK-PRETTY: stream.cmd.execute
+// CHECK-PRETTY: Estimated work: 4 units, ~1 workers
+// CHECK-PRETTY: stream.cmd.execute
+// CHECK-PRETTY: Estimated work: 12 units, ~1 workers
 
 // CHECK-CSV: ; Aggregate Statistics
 // CHECK-CSV: "Constants","Constant Size","Variables","Variable Size","Awaits","Submissions","Transient Size","Fills","Copies","Dispatches","Async Calls","Executables"
@@ -146,3 +151,17 @@ util.func public @func_a() -> (tensor<4xi32>, tensor<4xi32>) {
   %7 = stream.tensor.export %6 : tensor<4xi32> in !stream.resource<external>{%c16} -> tensor<4xi32>
   util.return %5, %7 : tensor<4xi32>, tensor<4xi32>
 }
+
+// -----
+
+// CHECK-PRETTY: Aggregate Statistics
+// CHECK-PRETTY:  Transients: 1 packs, 128 B packed, 48 B (37.50%) wasted
+// CHECK-PRETTY: Transients
+// CHECK-PRETTY: util.func @transientPackStatistics > stream.resource.alloca
+// CHECK-PRETTY-NEXT: 3 slices packed into 128 B with greedy, 48 B wasted above lower bound 80 B
+
+util.func public @transientPackStatistics() -> !stream.resource<transient> {
+  %c128 = arith.constant 128 : index
+  %resource, %timepoint = stream.resource.alloca uninitialized {stream.pack_statistics = {lower_bound = 80 : index, size = 128 : index, slices = 3 : index, strategy = "greedy"}} : !stream.resource<transient>{%c128} => !stream.timepoint
+  util.return %resource : !stream.resource<transient>
+}
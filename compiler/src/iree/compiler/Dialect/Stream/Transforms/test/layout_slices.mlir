@@ -1,4 +1,5 @@
 // RUN: iree-opt --split-input-file --pass-pipeline='builtin.module(util.func(iree-stream-layout-slices, cse))' %s | FileCheck %s
+// RUN: iree-opt --split-input-file --pass-pipeline='builtin.module(util.func(iree-stream-layout-slices{annotate-statistics}, cse))' %s | FileCheck %s --check-prefix=ANNOTATE
 
 #layoutStaticConfig = #stream.resource_config<{
   max_allocation_size = 1073741824,
@@ -29,6 +30,36 @@ util.func public @layoutStatic() -> (index, index, index, index, index, index, i
 
 // -----
 
+#layoutStaticReorderedConfig = #stream.resource_config<{
+  max_allocation_size = 1073741824,
+  min_buffer_offset_alignment = 16,
+  max_buffer_range = 1073741824,
+  min_buffer_range_alignment = 16,
+  index_bits = 32
+}>
+
+// Greedy packing in slice order places [3, 4] after both earlier slices and
+// needs 128 bytes; packing the largest slices first reaches the lower bound.
+
+// CHECK-LABEL: @layoutStaticReordered
+util.func public @layoutStaticReordered() -> (index, index, index, index)
+    attributes {stream.resources = #layoutStaticReorderedConfig} {
+  %c16 = arith.constant 16 : index
+  %c48 = arith.constant 48 : index
+  %c64 = arith.constant 64 : index
+  %t:4 = stream.resource.pack slices({
+    [0, 2] = %c48,  // +0
+    [2, 4] = %c16,  // +64 (after [3, 4])
+    [3, 4] = %c64,  // +0 (reuse [0, 2])
+  }) : index
+  // 64 + 16 = 80 total bytes required
+  // CHECK: util.return %c80
+  // CHECK-SAME: %c0, %c64, %c0
+  util.return %t#0, %t#1, %t#2, %t#3 : index, index, index, index
+}
+
+// -----
+
 #layoutDynamicConfig = #stream.resource_config<{
   max_allocation_size = 1073741824,
   min_buffer_offset_alignment = 16,
@@ -92,3 +123,34 @@ util.func public @layoutMixedStaticDynamic(%size_a: index, %size_b: index) -> (i
   // CHECK: util.return %3, %c0, %c208, %1, %c0
   util.return %t#0, %t#1, %t#2, %t#3, %t#4 : index, index, index, index, index
 }
+
+// -----
+
+#layoutAnnotateStatisticsConfig = #stream.resource_config<{
+  max_allocation_size = 1073741824,
+  min_buffer_offset_alignment = 16,
+  max_buffer_range = 1073741824,
+  min_buffer_range_alignment = 16,
+  index_bits = 32
+}>
+
+// Tests that allocations sized by a pack are annotated with the packing
+// statistics when requested.
+
+// CHECK-LABEL: @layoutAnnotateStatistics
+// ANNOTATE-LABEL: @layoutAnnotateStatistics
+util.func public @layoutAnnotateStatistics() -> (!stream.resource<transient>, index, index)
+    attributes {stream.resources = #layoutAnnotateStatisticsConfig} {
+  %c100 = arith.constant 100 : index
+  %c200 = arith.constant 200 : index
+  %t:3 = stream.resource.pack slices({
+    [0, 1] = %c100,
+    [1, 2] = %c200,
+  }) : index
+  // CHECK: stream.resource.alloca
+  // CHECK-NOT: stream.pack_statistics
+  // ANNOTATE: stream.resource.alloca
+  // ANNOTATE-SAME: stream.pack_statistics = {lower_bound = 320 : index, size = 320 : index, slices = 2 : index, strategy = "greedy"}
+  %resource, %timepoint = stream.resource.alloca uninitialized : !stream.resource<transient>{%t#0} => !stream.timepoint
+  util.return %resource, %t#1, %t#2 : !stream.resource<transient>, index, index
+}
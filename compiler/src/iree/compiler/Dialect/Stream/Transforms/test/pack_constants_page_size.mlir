@@ -0,0 +1,155 @@
+// RUN: iree-opt --split-input-file --pass-pipeline='builtin.module(util.func(iree-stream-pack-constants{page-size=4096}))' %s | FileCheck %s
+// RUN: not iree-opt --pass-pipeline='builtin.module(util.func(iree-stream-pack-constants{page-size=3000}))' %s 2>&1 | FileCheck %s --check-prefix=INVALID
+
+// INVALID: error: constant page size must be zero or a power of two; got 3000
+
+// Tests that constants of at least a page are moved after the smaller ones and
+// placed at page-aligned offsets within page-aligned storage.
+
+#pageSizeConfig = #stream.resource_config<{
+  max_allocation_size = 1073741824,
+  min_buffer_offset_alignment = 16,
+  max_buffer_range = 1073741824,
+  min_buffer_range_alignment = 16,
+  index_bits = 32
+}>
+
+//      CHECK: #composite_of_12288b = #util.composite<12288xi8, [
+// CHECK-NEXT:   dense<100> : tensor<1xi32>,
+// CHECK-NEXT:   dense<0> : vector<12xi8>,
+// CHECK-NEXT:   dense<[101, 102]> : tensor<2xi32>,
+// CHECK-NEXT:   dense<0> : vector<4072xi8>,
+// CHECK-NEXT:   dense<103> : tensor<2048xi32>,
+// CHECK-NEXT: ]>
+
+// CHECK-LABEL: @pageAlignedConstants
+util.func public @pageAlignedConstants() -> (!stream.resource<constant>, !stream.resource<constant>, !stream.resource<constant>, !stream.timepoint)
+    attributes {stream.resources = #pageSizeConfig} {
+  %c4 = arith.constant 4 : index
+  %c8 = arith.constant 8 : index
+  %c8192 = arith.constant 8192 : index
+
+  // CHECK: %[[RODATA:.+]] = util.buffer.constant {alignment = 4096 : index} : !util.buffer = #composite_of_12288b
+  // CHECK: %[[DID_MAP:.+]], %[[TRY_MAP:.+]] = stream.resource.try_map %[[RODATA]][%c0] :
+  // CHECK-SAME: !util.buffer -> i1, !stream.resource<constant>{%c12288}
+  // CHECK: %[[IF:.+]]:2 = scf.if %[[DID_MAP]]
+  %0:4 = stream.resource.constants :
+    !stream.resource<constant>{%c8192} = dense<103> : tensor<2048xi32>,
+    !stream.resource<constant>{%c4} = dense<100> : tensor<1xi32>,
+    !stream.resource<constant>{%c8} = dense<[101, 102]> : tensor<2xi32>
+    => !stream.timepoint
+
+  // CHECK-DAG: %[[RES0:.+]] = stream.resource.subview %[[IF]]#1[%c4096] : !stream.resource<constant>{%c12288} -> !stream.resource<constant>{%c8192}
+  // CHECK-DAG: %[[RES1:.+]] = stream.resource.subview %[[IF]]#1[%c0] : !stream.resource<constant>{%c12288} -> !stream.resource<constant>{%c4}
+  // CHECK-DAG: %[[RES2:.+]] = stream.resource.subview %[[IF]]#1[%c16] : !stream.resource<constant>{%c12288} -> !stream.resource<constant>{%c8}
+
+  // CHECK: util.return %[[RES0]], %[[RES1]], %[[RES2]], %[[IF]]#0
+  util.return %0#0, %0#1, %0#2, %0#3 : !stream.resource<constant>, !stream.resource<constant>, !stream.resource<constant>, !stream.timepoint
+}
+
+// -----
+
+// Tests that storage holding only constants smaller than a page is packed as
+// it would be without a page size.
+
+#smallConstantsConfig = #stream.resource_config<{
+  max_allocation_size = 1073741824,
+  min_buffer_offset_alignment = 16,
+  max_buffer_range = 1073741824,
+  min_buffer_range_alignment = 16,
+  index_bits = 32
+}>
+
+// CHECK: #composite_of_32b = #util.composite<32xi8, [
+
+// CHECK-LABEL: @smallConstants
+util.func public @smallConstants() -> (!stream.resource<constant>, !stream.resource<constant>, !stream.timepoint)
+    attributes {stream.resources = #smallConstantsConfig} {
+  %c4 = arith.constant 4 : index
+  %c8 = arith.constant 8 : index
+  // CHECK: util.buffer.constant {alignment = 16 : index} : !util.buffer = #composite_of_32b
+  %0:3 = stream.resource.constants :
+    !stream.resource<constant>{%c4} = dense<100> : tensor<1xi32>,
+    !stream.resource<constant>{%c8} = dense<[101, 102]> : tensor<2xi32>
+    => !stream.timepoint
+  util.return %0#0, %0#1, %0#2 : !stream.resource<constant>, !stream.resource<constant>, !stream.timepoint
+}
+
+// -----
+
+// Tests that on unified memory only parameters of at least a page are loaded
+// directly while smaller parameters are gathered into a shared allocation.
+
+#unifiedParameterConfig = #stream.resource_config<{
+  max_allocation_size = 1073741824,
+  min_buffer_offset_alignment = 16,
+  max_buffer_range = 1073741824,
+  min_buffer_range_alignment = 16,
+  index_bits = 32,
+  memory_model = Unified
+}>
+
+// CHECK-LABEL: @unifiedParameters
+util.func public @unifiedParameters() -> (!stream.resource<constant>, !stream.resource<constant>, !stream.resource<constant>, !stream.timepoint)
+    attributes {stream.resources = #unifiedParameterConfig} {
+  %c4 = arith.constant 4 : index
+  %c8 = arith.constant 8 : index
+  %c8192 = arith.constant 8192 : index
+
+  // CHECK: %[[LOAD:.+]], %[[LOAD_TIMEPOINT:.+]] = stream.parameter.load
+  // CHECK-NEXT: "scope"::"large"[%{{.+}}] : !stream.resource<constant>{%c8192}
+  // CHECK-NEXT: } => !stream.timepoint
+  // CHECK-NOT: stream.parameter.load
+  // CHECK: %[[ALLOC:.+]] = stream.resource.alloc uninitialized : !stream.resource<constant>{%c32}
+  // CHECK: %[[GATHER_TIMEPOINT:.+]] = stream.parameter.gather
+  // CHECK-NEXT: "scope"::"small0"[%{{.+}}] -> %[[ALLOC]][%c0 for %c4] : !stream.resource<constant>{%c32},
+  // CHECK-NEXT: "scope"::"small1"[%{{.+}}] -> %[[ALLOC]][%c16 for %c8] : !stream.resource<constant>{%c32}
+  // CHECK-NEXT: } => !stream.timepoint
+  // CHECK-NOT: stream.parameter.load
+  %0:4 = stream.resource.constants :
+    !stream.resource<constant>{%c8192} = #stream.parameter.named<"scope"::"large"> : tensor<2048xi32>,
+    !stream.resource<constant>{%c4} = #stream.parameter.named<"scope"::"small0"> : tensor<1xi32>,
+    !stream.resource<constant>{%c8} = #stream.parameter.named<"scope"::"small1"> : tensor<2xi32>
+    => !stream.timepoint
+
+  // CHECK-DAG: %[[RES0:.+]] = stream.resource.subview %[[LOAD]][%c0] : !stream.resource<constant>{%c8192} -> !stream.resource<constant>{%c8192}
+  // CHECK-DAG: %[[RES1:.+]] = stream.resource.subview %[[ALLOC]][%c0] : !stream.resource<constant>{%c32} -> !stream.resource<constant>{%c4}
+  // CHECK-DAG: %[[RES2:.+]] = stream.resource.subview %[[ALLOC]][%c16] : !stream.resource<constant>{%c32} -> !stream.resource<constant>{%c8}
+  // CHECK-DAG: %[[READY:.+]] = stream.timepoint.join max(%[[LOAD_TIMEPOINT]], %[[GATHER_TIMEPOINT]])
+
+  // CHECK: util.return %[[RES0]], %[[RES1]], %[[RES2]], %[[READY]]
+  util.return %0#0, %0#1, %0#2, %0#3 : !stream.resource<constant>, !stream.resource<constant>, !stream.resource<constant>, !stream.timepoint
+}
+
+// -----
+
+// Tests that on discrete memory all parameters are gathered regardless of the
+// page size as gathers always copy into a new allocation.
+
+#discreteParameterConfig = #stream.resource_config<{
+  max_allocation_size = 1073741824,
+  min_buffer_offset_alignment = 16,
+  max_buffer_range = 1073741824,
+  min_buffer_range_alignment = 16,
+  index_bits = 32,
+  memory_model = Discrete
+}>
+
+// CHECK-LABEL: @discreteParameters
+util.func public @discreteParameters() -> (!stream.resource<constant>, !stream.resource<constant>, !stream.timepoint)
+    attributes {stream.resources = #discreteParameterConfig} {
+  %c4 = arith.constant 4 : index
+  %c8192 = arith.constant 8192 : index
+  // CHECK-NOT: stream.parameter.load
+  // CHECK: %[[ALLOC:.+]] = stream.resource.alloc uninitialized : !stream.resource<constant>
+  // CHECK: stream.parameter.gather
+  // CHECK-NEXT: "scope"::"large"[%{{.+}}] -> %[[ALLOC]]
+  // CHECK-NEXT: "scope"::"small"[%{{.+}}] -> %[[ALLOC]]
+  // CHECK-NEXT: } => !stream.timepoint
+  // CHECK-NOT: stream.parameter.load
+  %0:3 = stream.resource.constants :
+    !stream.resource<constant>{%c8192} = #stream.parameter.named<"scope"::"large"> : tensor<2048xi32>,
+    !stream.resource<constant>{%c4} = #stream.parameter.named<"scope"::"small"> : tensor<1xi32>
+    => !stream.timepoint
+  util.return %0#0, %0#1, %0#2 : !stream.resource<constant>, !stream.resource<constant>, !stream.timepoint
+}
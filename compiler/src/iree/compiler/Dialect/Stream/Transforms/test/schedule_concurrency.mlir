@@ -103,6 +103,60 @@ util.func public @partitioningForMaxConcurrency(%arg0: !stream.resource<external
 
 // -----
 
+// Tests that when the worker count is known work that saturates all workers is
+// not scheduled concurrently with other work.
+
+// CHECK-LABEL: @partitioningForSaturatedWorkers
+util.func public @partitioningForSaturatedWorkers(%arg0: !stream.resource<external>) -> !stream.resource<external>
+    attributes {stream.partitioning = #stream.partitioning_config<"max-concurrency", workers = 1>} {
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  %c4 = arith.constant 4 : index
+  %c256 = arith.constant 256 : index
+  // CHECK: stream.async.execute
+  %results, %result_timepoint = stream.async.execute with(%arg0 as %capture: !stream.resource<external>{%c4}) -> !stream.resource<external>{%c4} {
+    // CHECK-NOT: stream.async.concurrent
+    // CHECK: stream.async.dispatch @ex::@dispatch_0
+    %0 = stream.async.dispatch @ex::@dispatch_0[%c256, %c256, %c1](%capture[%c0 to %c4 for %c4]) : (!stream.resource<external>{%c4}) -> !stream.resource<transient>{%c4}
+    // CHECK-NEXT: stream.async.dispatch @ex::@dispatch_1
+    %1 = stream.async.dispatch @ex::@dispatch_1[%c256, %c256, %c1](%capture[%c0 to %c4 for %c4]) : (!stream.resource<external>{%c4}) -> !stream.resource<transient>{%c4}
+    // CHECK-NEXT: stream.async.dispatch @ex::@dispatch_2
+    %2 = stream.async.dispatch @ex::@dispatch_2[%c1, %c1, %c1](%0[%c0 to %c4 for %c4], %1[%c0 to %c4 for %c4]) : (!stream.resource<transient>{%c4}, !stream.resource<transient>{%c4}) -> !stream.resource<external>{%c4}
+    stream.yield %2 : !stream.resource<external>{%c4}
+  } => !stream.timepoint
+  %0 = stream.timepoint.await %result_timepoint => %results : !stream.resource<external>{%c4}
+  util.return %0 : !stream.resource<external>
+}
+
+// -----
+
+// Tests that work that does not saturate all workers is scheduled concurrently.
+
+// CHECK-LABEL: @partitioningForUnsaturatedWorkers
+util.func public @partitioningForUnsaturatedWorkers(%arg0: !stream.resource<external>) -> !stream.resource<external>
+    attributes {stream.partitioning = #stream.partitioning_config<"max-concurrency", workers = 4>} {
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  %c4 = arith.constant 4 : index
+  %c256 = arith.constant 256 : index
+  // CHECK: stream.async.execute
+  %results, %result_timepoint = stream.async.execute with(%arg0 as %capture: !stream.resource<external>{%c4}) -> !stream.resource<external>{%c4} {
+    // CHECK: stream.async.concurrent
+    // CHECK-NEXT: stream.async.dispatch @ex::@dispatch_0
+    %0 = stream.async.dispatch @ex::@dispatch_0[%c256, %c256, %c1](%capture[%c0 to %c4 for %c4]) : (!stream.resource<external>{%c4}) -> !stream.resource<transient>{%c4}
+    // CHECK-NEXT: stream.async.dispatch @ex::@dispatch_1
+    %1 = stream.async.dispatch @ex::@dispatch_1[%c256, %c256, %c1](%capture[%c0 to %c4 for %c4]) : (!stream.resource<external>{%c4}) -> !stream.resource<transient>{%c4}
+    // CHECK-NEXT: stream.yield
+    // CHECK: stream.async.dispatch @ex::@dispatch_2
+    %2 = stream.async.dispatch @ex::@dispatch_2[%c1, %c1, %c1](%0[%c0 to %c4 for %c4], %1[%c0 to %c4 for %c4]) : (!stream.resource<transient>{%c4}, !stream.resource<transient>{%c4}) -> !stream.resource<external>{%c4}
+    stream.yield %2 : !stream.resource<external>{%c4}
+  } => !stream.timepoint
+  %0 = stream.timepoint.await %result_timepoint => %results : !stream.resource<external>{%c4}
+  util.return %0 : !stream.resource<external>
+}
+
+// -----
+
 // Tests that tied operands properly trigger hazard detection.
 // Here @dispatch_1 has a read/write hazard on %capture0 with @dispatch_0 and
 // should not be placed into the same concurrency group.
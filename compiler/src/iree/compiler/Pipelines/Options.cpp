@@ -166,6 +166,16 @@ void GlobalOptimizationOptions::bindOptions(OptionsBinder &binder) {
       llvm::cl::desc("Enables eager evaluation of constants using the full "
                      "compiler and runtime (on by default)."),
       llvm::cl::cat(category));
+  binder.opt<std::string>(
+      "iree-opt-const-eval-cache-dir", constEvalCachePath,
+      llvm::cl::desc(
+          "Directory of a content-addressed cache of globals evaluated by "
+          "constant evaluation. Initializers identical to ones evaluated in "
+          "previous compilations with the same compiler build, flags, and flag "
+          "input files reuse the cached values instead of being compiled and "
+          "run. Ignored if the compiler build or a flag input file cannot be "
+          "identified."),
+      llvm::cl::cat(category));
   binder.opt<bool>(
       "iree-opt-const-expr-hoisting", constExprHoisting,
       llvm::cl::desc(
@@ -278,6 +288,14 @@ void SchedulingOptions::bindOptions(OptionsBinder &binder) {
           "Enables binding fusion and dispatch site specialization."),
       llvm::cl::cat(category));
 
+  binder.opt<int64_t>(
+      "iree-scheduling-constant-page-size", constantPageSize,
+      llvm::cl::desc("Page size in bytes used to align constants of at least "
+                     "a page so that they can be mapped from the module or "
+                     "parameter archives without copies (e.g. 4096). Must be "
+                     "a power of two; 0 packs all constants densely."),
+      llvm::cl::cat(category));
+
   binder.opt<DumpOutputFormat>(
       "iree-scheduling-dump-statistics-format", dumpStatisticsFormat,
       llvm::cl::desc("Dumps statistics in the specified output format."),
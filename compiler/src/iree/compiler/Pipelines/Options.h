@@ -131,6 +131,10 @@ struct GlobalOptimizationOptions {
   // and runtime.
   bool constEval = true;
 
+  // A directory holding a content-addressed cache of globals evaluated by
+  // constant evaluation shared across compilations. Disabled if empty.
+  std::string constEvalCachePath;
+
   // Optimizations to reduce numeric precision where it is safe to do so.
   bool numericPrecisionReduction = false;
 
@@ -189,6 +193,10 @@ struct SchedulingOptions {
   // Enables fusing bindings with the same underlying storage.
   bool optimizeBindings = true;
 
+  // Page size in bytes used to align large constants such that they can be
+  // mapped from the module or parameter archives without copies. 0 disables.
+  int64_t constantPageSize = 0;
+
   // TODO(benvanik): find a way to share this with
   // Stream/Transforms/Passes.h w/o circular deps.
   // Defines the output format of a dump pass.
@@ -267,6 +267,7 @@ void buildIREEVMTransformPassPipeline(
   streamOptions.initializationMode =
       (IREE::Stream::InitializationMode)schedulingOptions.initializationMode;
   streamOptions.optimizeBindings = schedulingOptions.optimizeBindings;
+  streamOptions.constantPageSize = schedulingOptions.constantPageSize;
   streamOptions.dumpStatisticsFormat =
       (IREE::Stream::DumpOutputFormat)schedulingOptions.dumpStatisticsFormat;
   streamOptions.dumpStatisticsFile = schedulingOptions.dumpStatisticsFile;
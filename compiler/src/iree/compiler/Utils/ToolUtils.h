@@ -39,6 +39,10 @@ std::string findToolInEnvironment(SmallVector<std::string> toolNames);
 std::string findTool(SmallVector<std::string> toolNames);
 std::string findTool(std::string toolName);
 
+// Returns the path of the shared library (or executable) hosting the compiler
+// or empty string if the platform cannot resolve it.
+std::string getCurrentDylibPath();
+
 // Finds a bundled directory containing platform libraries for the given
 // platform name, returning an empty string if not found. We store bundled
 // platform libraries in a directory like:
@@ -141,6 +141,15 @@ typedef IREE_DEVICE_SIZE_T iree_device_size_t;
 #define IREE_SYNCHRONIZATION_DISABLE_UNSAFE 0
 #endif  // !IREE_SYNCHRONIZATION_DISABLE_UNSAFE
 
+#if !defined(IREE_SYNCHRONIZATION_PROFILE_LOCKS)
+// Records acquire counts and wait times for every iree_mutex_t and
+// iree_slim_mutex_t aggregated by the source location that initialized them.
+// This adds an atomic increment to every lock acquisition and a pointer to
+// every lock and should only be enabled when looking for contention. Results
+// can be dumped with iree_lock_profile_fprint.
+#define IREE_SYNCHRONIZATION_PROFILE_LOCKS 0
+#endif  // !IREE_SYNCHRONIZATION_PROFILE_LOCKS
+
 //===----------------------------------------------------------------------===//
 // File I/O
 //===----------------------------------------------------------------------===//
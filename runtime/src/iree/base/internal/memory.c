@@ -26,21 +26,54 @@ iree_memory_info_t iree_memory_query_info(void) {
 
 #elif defined(IREE_PLATFORM_ANDROID) || defined(IREE_PLATFORM_LINUX)
 
+#include <fcntl.h>
+#include <stdlib.h>
 #include <unistd.h>
 
+#include "iree/base/internal/call_once.h"
+
+// PMD-level transparent huge page size or 0 if the kernel does not support
+// transparent huge pages. Queried once as reading sysfs is too expensive to do
+// on every iree_memory_query_info call.
+static iree_once_flag iree_memory_transparent_huge_page_size_flag_ =
+    IREE_ONCE_FLAG_INIT;
+static iree_host_size_t iree_memory_transparent_huge_page_size_ = 0;
+
+static void iree_memory_query_transparent_huge_page_size_once(void) {
+  int fd = open("/sys/kernel/mm/transparent_hugepage/hpage_pmd_size", O_RDONLY);
+  if (fd < 0) return;
+  char buffer[32] = {0};
+  ssize_t read_length = read(fd, buffer, sizeof(buffer) - 1);
+  close(fd);
+  if (read_length <= 0) return;
+  iree_memory_transparent_huge_page_size_ =
+      (iree_host_size_t)strtoull(buffer, NULL, 10);
+}
+
+// Returns the PMD-level transparent huge page size or 0 if the kernel does not
+// support transparent huge pages.
+static iree_host_size_t iree_memory_query_transparent_huge_page_size(void) {
+  iree_call_once(&iree_memory_transparent_huge_page_size_flag_,
+                 iree_memory_query_transparent_huge_page_size_once);
+  return iree_memory_transparent_huge_page_size_;
+}
+
 iree_memory_info_t iree_memory_query_info(void) {
   const int page_size = sysconf(_SC_PAGESIZE);
+  // Large pages are exposed via transparent huge pages (THP) and must be
+  // requested with madvise on each committed range. If THP is disabled then
+  // we fall back to normal pages.
+  // NOTE: hugetlbfs pages are not used as they require the system
+  // administrator to reserve a pool ahead of time.
+  iree_host_size_t large_page_size =
+      iree_memory_query_transparent_huge_page_size();
+  if (large_page_size < (iree_host_size_t)page_size) {
+    large_page_size = page_size;
+  }
   return (iree_memory_info_t){
       .normal_page_size = page_size,
       .normal_page_granularity = page_size,
-      // Large pages arent't currently used so we aren't introducing the build
-      // goo to detect and use them yet.
-      // https://linux.die.net/man/3/gethugepagesizes
-      // http://manpages.ubuntu.com/manpages/bionic/man3/gethugepagesize.3.html
-      // Would be:
-      //   #include <hugetlbfs.h>
-      //   out_info->large_page_granularity = gethugepagesize();
-      .large_page_granularity = page_size,
+      .large_page_granularity = large_page_size,
       .supported_features = IREE_MEMORY_FEATURE_ALLOCATABLE_EXECUTABLE_PAGES,
   };
 }
@@ -0,0 +1,540 @@
+// Copyright 2025 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/base/internal/object_pool.h"
+
+#include <string.h>
+
+#include "iree/base/internal/call_once.h"
+
+#if IREE_SYNCHRONIZATION_DISABLE_UNSAFE
+// Only a single thread exists so per-thread state is just global state.
+#define iree_thread_local
+#elif defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 201102L) && \
+    !__STDC_NO_THREADS__
+#define iree_thread_local _Thread_local
+#elif defined(IREE_COMPILER_MSVC)
+#define iree_thread_local __declspec(thread)
+#else
+// No thread-local storage: all threads share shard 0 and nothing is cached.
+#define iree_thread_local
+#define IREE_OBJECT_POOL_NO_THREAD_LOCAL 1
+#endif  // IREE_SYNCHRONIZATION_DISABLE_UNSAFE
+
+#if IREE_SYNCHRONIZATION_DISABLE_UNSAFE || \
+    defined(IREE_OBJECT_POOL_NO_THREAD_LOCAL)
+// No thread exit notification is required.
+#elif defined(IREE_PLATFORM_WINDOWS)
+#include <windows.h>
+#define IREE_OBJECT_POOL_THREAD_EXIT_WIN32 1
+#else
+#include <pthread.h>
+#define IREE_OBJECT_POOL_THREAD_EXIT_PTHREAD 1
+#endif  // IREE_SYNCHRONIZATION_DISABLE_UNSAFE
+
+// Maximum number of blocks of each size class cached per thread.
+#define IREE_OBJECT_POOL_THREAD_CACHE_CAPACITY 32
+
+// Size class of allocations made directly from the block allocator.
+#define IREE_OBJECT_POOL_SIZE_CLASS_OVERSIZED IREE_OBJECT_POOL_SIZE_CLASS_COUNT
+
+// Total block size of the smallest size class.
+#define IREE_OBJECT_POOL_MIN_BLOCK_SIZE 64
+
+// Prefix of every allocation used to route frees back to the right size class
+// and type without requiring the caller to pass the size.
+typedef iree_alignas(iree_max_align_t) struct iree_object_pool_header_t {
+  // Type the allocation is counted against.
+  iree_object_pool_type_t* type;
+  // Size class index or IREE_OBJECT_POOL_SIZE_CLASS_OVERSIZED.
+  iree_host_size_t size_class;
+} iree_object_pool_header_t;
+
+//===----------------------------------------------------------------------===//
+// iree_object_pool_type_t
+//===----------------------------------------------------------------------===//
+
+// Head of the process type list (iree_object_pool_type_t*).
+static iree_atomic_intptr_t iree_object_pool_type_list_head =
+    IREE_ATOMIC_VAR_INIT(0);
+
+static void iree_object_pool_type_register(iree_object_pool_type_t* type) {
+  if (IREE_LIKELY(
+          iree_atomic_load(&type->registered, iree_memory_order_acquire))) {
+    return;
+  }
+  int32_t expected = 0;
+  if (!iree_atomic_compare_exchange_strong(
+          &type->registered, &expected, 1, iree_memory_order_acq_rel,
+          iree_memory_order_relaxed /* expected is unused */)) {
+    return;  // registered by another thread
+  }
+  intptr_t head = iree_atomic_load(&iree_object_pool_type_list_head,
+                                   iree_memory_order_relaxed);
+  do {
+    type->next = (iree_object_pool_type_t*)head;
+  } while (!iree_atomic_compare_exchange_weak(
+      &iree_object_pool_type_list_head, &head, (intptr_t)type,
+      iree_memory_order_release, iree_memory_order_relaxed));
+}
+
+iree_object_pool_type_stats_t iree_object_pool_type_query_stats(
+    iree_object_pool_type_t* type) {
+  iree_object_pool_type_stats_t stats;
+  stats.allocation_count =
+      iree_atomic_load(&type->allocation_count, iree_memory_order_relaxed);
+  stats.reuse_count =
+      iree_atomic_load(&type->reuse_count, iree_memory_order_relaxed);
+  stats.oversized_count =
+      iree_atomic_load(&type->oversized_count, iree_memory_order_relaxed);
+  stats.live_count =
+      iree_atomic_load(&type->live_count, iree_memory_order_relaxed);
+  return stats;
+}
+
+void iree_object_pool_enumerate_types(
+    void(IREE_API_PTR* callback)(void* user_data,
+                                 iree_object_pool_type_t* type),
+    void* user_data) {
+  iree_object_pool_type_t* type =
+      (iree_object_pool_type_t*)iree_atomic_load(
+          &iree_object_pool_type_list_head, iree_memory_order_acquire);
+  while (type) {
+    callback(user_data, type);
+    type = type->next;
+  }
+}
+
+static iree_status_t iree_object_pool_allocator_ctl(
+    void* self, iree_allocator_command_t command, const void* params,
+    void** inout_ptr) {
+  iree_object_pool_type_t* type = (iree_object_pool_type_t*)self;
+  iree_object_pool_t* pool = iree_object_pool_global();
+  switch (command) {
+    case IREE_ALLOCATOR_COMMAND_MALLOC:
+    case IREE_ALLOCATOR_COMMAND_CALLOC: {
+      iree_host_size_t byte_length =
+          ((const iree_allocator_alloc_params_t*)params)->byte_length;
+      IREE_RETURN_IF_ERROR(
+          iree_object_pool_allocate(pool, type, byte_length, inout_ptr));
+      if (command == IREE_ALLOCATOR_COMMAND_CALLOC) {
+        memset(*inout_ptr, 0, byte_length);
+      }
+      return iree_ok_status();
+    }
+    case IREE_ALLOCATOR_COMMAND_REALLOC: {
+      iree_host_size_t byte_length =
+          ((const iree_allocator_alloc_params_t*)params)->byte_length;
+      if (!*inout_ptr) {
+        return iree_object_pool_allocate(pool, type, byte_length, inout_ptr);
+      }
+      return iree_object_pool_reallocate(pool, byte_length, inout_ptr);
+    }
+    case IREE_ALLOCATOR_COMMAND_FREE: {
+      iree_object_pool_free(pool, *inout_ptr);
+      return iree_ok_status();
+    }
+    default:
+      return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                              "unsupported object pool allocator command");
+  }
+}
+
+iree_allocator_t iree_object_pool_type_allocator(
+    iree_object_pool_type_t* type, iree_allocator_t base_allocator) {
+#if defined(IREE_ALLOCATOR_SYSTEM_CTL)
+  // The process pool allocates its blocks from the system allocator so it can
+  // only stand in for it and not for user allocators that may be tracking or
+  // limiting their allocations.
+  if (base_allocator.ctl == IREE_ALLOCATOR_SYSTEM_CTL &&
+      base_allocator.self == IREE_ALLOCATOR_SYSTEM_SELF) {
+    iree_allocator_t allocator = {
+        .self = type,
+        .ctl = iree_object_pool_allocator_ctl,
+    };
+    return allocator;
+  }
+#endif  // IREE_ALLOCATOR_SYSTEM_CTL
+  return base_allocator;
+}
+
+//===----------------------------------------------------------------------===//
+// iree_object_pool_t
+//===----------------------------------------------------------------------===//
+
+// Counter used to assign shards to threads round-robin.
+static iree_atomic_int32_t iree_object_pool_next_shard =
+    IREE_ATOMIC_VAR_INIT(0);
+
+// Per-thread state used with pools that allow thread caching.
+// Blocks freed on a thread are kept here and reused by the same thread without
+// touching the shared free lists until the cache overflows or the thread exits.
+typedef struct iree_object_pool_thread_cache_t {
+  // Shard index of the thread or -1 if not yet assigned.
+  int32_t shard;
+  // True if the thread exit callback that flushes the cache is registered.
+  bool exit_registered;
+  // Number of cached blocks in each size class.
+  uint32_t count[IREE_OBJECT_POOL_SIZE_CLASS_COUNT];
+  // Cached blocks in each size class, most recently freed last.
+  iree_object_pool_header_t* headers[IREE_OBJECT_POOL_SIZE_CLASS_COUNT]
+                                    [IREE_OBJECT_POOL_THREAD_CACHE_CAPACITY];
+} iree_object_pool_thread_cache_t;
+
+static iree_thread_local iree_object_pool_thread_cache_t
+    iree_object_pool_thread_cache = {.shard = -1};
+
+// Returns the shard index of the current thread, assigning one if needed.
+static iree_host_size_t iree_object_pool_current_shard(void) {
+  int32_t shard = iree_object_pool_thread_cache.shard;
+  if (IREE_UNLIKELY(shard < 0)) {
+    shard = (int32_t)((uint32_t)iree_atomic_fetch_add(
+                          &iree_object_pool_next_shard, 1,
+                          iree_memory_order_relaxed) %
+                      IREE_OBJECT_POOL_SHARD_COUNT);
+    iree_object_pool_thread_cache.shard = shard;
+  }
+  return (iree_host_size_t)shard;
+}
+
+// Returns |count| blocks of |size_class| from the end of the thread |cache| to
+// the thread's shard in |pool| with a single list operation.
+static void iree_object_pool_thread_cache_flush(
+    iree_object_pool_t* pool, iree_object_pool_thread_cache_t* cache,
+    iree_host_size_t size_class, iree_host_size_t count) {
+  if (!count) return;
+  iree_arena_block_pool_t* block_pool =
+      &pool->shards[size_class][iree_object_pool_current_shard()].block_pool;
+  iree_arena_block_t* head = NULL;
+  iree_arena_block_t* tail = NULL;
+  for (iree_host_size_t i = 0; i < count; ++i) {
+    iree_object_pool_header_t* header =
+        cache->headers[size_class][--cache->count[size_class]];
+    iree_arena_block_t* block = iree_arena_block_trailer(block_pool, header);
+    block->next = head;
+    head = block;
+    if (!tail) tail = block;
+  }
+  iree_atomic_arena_block_slist_concat(&block_pool->available_slist, head,
+                                       tail);
+}
+
+#if defined(IREE_OBJECT_POOL_THREAD_EXIT_PTHREAD)
+
+static pthread_key_t iree_object_pool_thread_exit_key;
+static bool iree_object_pool_thread_exit_available = false;
+
+// Flushes the cache of an exiting thread back to the process pool.
+static void iree_object_pool_thread_exit(void* arg) {
+  iree_object_pool_thread_cache_t* cache =
+      (iree_object_pool_thread_cache_t*)arg;
+  for (iree_host_size_t i = 0; i < IREE_OBJECT_POOL_SIZE_CLASS_COUNT; ++i) {
+    iree_object_pool_thread_cache_flush(iree_object_pool_global(), cache, i,
+                                        cache->count[i]);
+  }
+  // Objects freed by later thread exit callbacks will register again.
+  cache->exit_registered = false;
+}
+
+static void iree_object_pool_thread_exit_initialize(void) {
+  iree_object_pool_thread_exit_available =
+      pthread_key_create(&iree_object_pool_thread_exit_key,
+                         iree_object_pool_thread_exit) == 0;
+}
+
+static bool iree_object_pool_thread_exit_register(
+    iree_object_pool_thread_cache_t* cache) {
+  return iree_object_pool_thread_exit_available &&
+         pthread_setspecific(iree_object_pool_thread_exit_key, cache) == 0;
+}
+
+#elif defined(IREE_OBJECT_POOL_THREAD_EXIT_WIN32)
+
+static DWORD iree_object_pool_thread_exit_index = FLS_OUT_OF_INDEXES;
+
+// Flushes the cache of an exiting thread back to the process pool.
+static VOID WINAPI iree_object_pool_thread_exit(PVOID arg) {
+  iree_object_pool_thread_cache_t* cache =
+      (iree_object_pool_thread_cache_t*)arg;
+  for (iree_host_size_t i = 0; i < IREE_OBJECT_POOL_SIZE_CLASS_COUNT; ++i) {
+    iree_object_pool_thread_cache_flush(iree_object_pool_global(), cache, i,
+                                        cache->count[i]);
+  }
+  cache->exit_registered = false;
+}
+
+static void iree_object_pool_thread_exit_initialize(void) {
+  iree_object_pool_thread_exit_index = FlsAlloc(iree_object_pool_thread_exit);
+}
+
+static bool iree_object_pool_thread_exit_register(
+    iree_object_pool_thread_cache_t* cache) {
+  return iree_object_pool_thread_exit_index != FLS_OUT_OF_INDEXES &&
+         FlsSetValue(iree_object_pool_thread_exit_index, cache);
+}
+
+#else
+
+static void iree_object_pool_thread_exit_initialize(void) {}
+
+static bool iree_object_pool_thread_exit_register(
+    iree_object_pool_thread_cache_t* cache) {
+#if defined(IREE_OBJECT_POOL_NO_THREAD_LOCAL)
+  return false;  // the cache would be shared by all threads
+#else
+  return true;  // single-threaded
+#endif  // IREE_OBJECT_POOL_NO_THREAD_LOCAL
+}
+
+#endif  // IREE_OBJECT_POOL_THREAD_EXIT_*
+
+// Returns the total block size of |size_class|.
+static iree_host_size_t iree_object_pool_block_size(
+    iree_host_size_t size_class) {
+  return (iree_host_size_t)IREE_OBJECT_POOL_MIN_BLOCK_SIZE << size_class;
+}
+
+// Returns the number of bytes usable by the object in a |size_class| block.
+static iree_host_size_t iree_object_pool_usable_size(
+    iree_host_size_t size_class) {
+  return iree_object_pool_block_size(size_class) -
+         sizeof(iree_arena_block_t) - sizeof(iree_object_pool_header_t);
+}
+
+// Returns the smallest size class that can hold |byte_length| bytes or
+// IREE_OBJECT_POOL_SIZE_CLASS_OVERSIZED if none can (or pooling is disabled).
+static iree_host_size_t iree_object_pool_select_size_class(
+    iree_host_size_t byte_length) {
+#if IREE_OBJECT_POOL_ENABLE
+  for (iree_host_size_t i = 0; i < IREE_OBJECT_POOL_SIZE_CLASS_COUNT; ++i) {
+    if (byte_length <= iree_object_pool_usable_size(i)) return i;
+  }
+#endif  // IREE_OBJECT_POOL_ENABLE
+  return IREE_OBJECT_POOL_SIZE_CLASS_OVERSIZED;
+}
+
+void iree_object_pool_initialize(iree_allocator_t block_allocator,
+                                 iree_object_pool_t* out_pool) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  memset(out_pool, 0, sizeof(*out_pool));
+  out_pool->block_allocator = block_allocator;
+  out_pool->thread_cached = false;
+  for (iree_host_size_t i = 0; i < IREE_OBJECT_POOL_SIZE_CLASS_COUNT; ++i) {
+    for (iree_host_size_t j = 0; j < IREE_OBJECT_POOL_SHARD_COUNT; ++j) {
+      iree_arena_block_pool_initialize(iree_object_pool_block_size(i),
+                                       block_allocator,
+                                       &out_pool->shards[i][j].block_pool);
+    }
+  }
+  IREE_TRACE_ZONE_END(z0);
+}
+
+void iree_object_pool_deinitialize(iree_object_pool_t* pool) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  for (iree_host_size_t i = 0; i < IREE_OBJECT_POOL_SIZE_CLASS_COUNT; ++i) {
+    for (iree_host_size_t j = 0; j < IREE_OBJECT_POOL_SHARD_COUNT; ++j) {
+      iree_arena_block_pool_deinitialize(&pool->shards[i][j].block_pool);
+    }
+  }
+  IREE_TRACE_ZONE_END(z0);
+}
+
+void iree_object_pool_trim(iree_object_pool_t* pool) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  for (iree_host_size_t i = 0; i < IREE_OBJECT_POOL_SIZE_CLASS_COUNT; ++i) {
+    for (iree_host_size_t j = 0; j < IREE_OBJECT_POOL_SHARD_COUNT; ++j) {
+      iree_arena_block_pool_trim(&pool->shards[i][j].block_pool);
+    }
+  }
+  IREE_TRACE_ZONE_END(z0);
+}
+
+// Acquires a block of |size_class| preferring the thread cache, then the shard
+// of the current thread, and then any other shard with free blocks before
+// allocating a new one. Sets |out_reused| if the block came from a free list.
+static iree_status_t iree_object_pool_acquire_block(
+    iree_object_pool_t* pool, iree_host_size_t size_class, bool* out_reused,
+    void** out_ptr) {
+  iree_object_pool_thread_cache_t* cache = &iree_object_pool_thread_cache;
+  if (pool->thread_cached && cache->count[size_class] > 0) {
+    *out_reused = true;
+    *out_ptr = cache->headers[size_class][--cache->count[size_class]];
+    return iree_ok_status();
+  }
+
+  iree_object_pool_shard_t* shards = pool->shards[size_class];
+  const iree_host_size_t home_shard = iree_object_pool_current_shard();
+  for (iree_host_size_t i = 0; i < IREE_OBJECT_POOL_SHARD_COUNT; ++i) {
+    iree_arena_block_pool_t* block_pool =
+        &shards[(home_shard + i) % IREE_OBJECT_POOL_SHARD_COUNT].block_pool;
+    iree_arena_block_t* block =
+        iree_atomic_arena_block_slist_pop(&block_pool->available_slist);
+    if (block) {
+      *out_reused = true;
+      *out_ptr = iree_arena_block_ptr(block_pool, block);
+      return iree_ok_status();
+    }
+  }
+  *out_reused = false;
+  iree_arena_block_t* block = NULL;
+  return iree_arena_block_pool_acquire(&shards[home_shard].block_pool, &block,
+                                       out_ptr);
+}
+
+iree_status_t iree_object_pool_allocate(iree_object_pool_t* pool,
+                                        iree_object_pool_type_t* type,
+                                        iree_host_size_t byte_length,
+                                        void** out_ptr) {
+  IREE_ASSERT_ARGUMENT(pool);
+  IREE_ASSERT_ARGUMENT(type);
+  IREE_ASSERT_ARGUMENT(out_ptr);
+  *out_ptr = NULL;
+  iree_object_pool_type_register(type);
+
+  const iree_host_size_t size_class =
+      iree_object_pool_select_size_class(byte_length);
+  iree_object_pool_header_t* header = NULL;
+  if (size_class == IREE_OBJECT_POOL_SIZE_CLASS_OVERSIZED) {
+    IREE_RETURN_IF_ERROR(iree_allocator_malloc_uninitialized(
+        pool->block_allocator, sizeof(*header) + byte_length,
+        (void**)&header));
+    IREE_STATISTICS(iree_atomic_fetch_add(&type->oversized_count, 1,
+                                          iree_memory_order_relaxed));
+  } else {
+    bool reused = false;
+    IREE_RETURN_IF_ERROR(iree_object_pool_acquire_block(
+        pool, size_class, &reused, (void**)&header));
+    IREE_STATISTICS({
+      if (reused) {
+        iree_atomic_fetch_add(&type->reuse_count, 1, iree_memory_order_relaxed);
+      }
+    });
+  }
+  header->type = type;
+  header->size_class = size_class;
+  IREE_STATISTICS({
+    iree_atomic_fetch_add(&type->allocation_count, 1,
+                          iree_memory_order_relaxed);
+    iree_atomic_fetch_add(&type->live_count, 1, iree_memory_order_relaxed);
+  });
+
+  *out_ptr = header + 1;
+  return iree_ok_status();
+}
+
+iree_status_t iree_object_pool_reallocate(iree_object_pool_t* pool,
+                                          iree_host_size_t byte_length,
+                                          void** inout_ptr) {
+  IREE_ASSERT_ARGUMENT(pool);
+  IREE_ASSERT_ARGUMENT(inout_ptr);
+  iree_object_pool_header_t* header =
+      (iree_object_pool_header_t*)*inout_ptr - 1;
+  const iree_host_size_t old_size_class = header->size_class;
+  const iree_host_size_t new_size_class =
+      iree_object_pool_select_size_class(byte_length);
+
+  // Shrinking or growing within the existing block is a no-op.
+  if (old_size_class != IREE_OBJECT_POOL_SIZE_CLASS_OVERSIZED &&
+      new_size_class <= old_size_class) {
+    return iree_ok_status();
+  }
+
+  // Oversized allocations stay oversized and can be resized in place.
+  if (old_size_class == IREE_OBJECT_POOL_SIZE_CLASS_OVERSIZED &&
+      new_size_class == IREE_OBJECT_POOL_SIZE_CLASS_OVERSIZED) {
+    IREE_RETURN_IF_ERROR(iree_allocator_realloc(
+        pool->block_allocator, sizeof(*header) + byte_length,
+        (void**)&header));
+    *inout_ptr = header + 1;
+    return iree_ok_status();
+  }
+
+  // Moving between a block and an oversized allocation. When shrinking out of
+  // an oversized allocation the old contents are at least |byte_length|.
+  void* new_ptr = NULL;
+  IREE_RETURN_IF_ERROR(
+      iree_object_pool_allocate(pool, header->type, byte_length, &new_ptr));
+  const iree_host_size_t copy_length =
+      old_size_class == IREE_OBJECT_POOL_SIZE_CLASS_OVERSIZED
+          ? byte_length
+          : iree_min(byte_length, iree_object_pool_usable_size(old_size_class));
+  memcpy(new_ptr, *inout_ptr, copy_length);
+  iree_object_pool_free(pool, *inout_ptr);
+  *inout_ptr = new_ptr;
+  return iree_ok_status();
+}
+
+// Releases a block of |size_class| to the thread cache if possible and
+// otherwise to the shard of the current thread.
+static void iree_object_pool_release_block(iree_object_pool_t* pool,
+                                           iree_host_size_t size_class,
+                                           iree_object_pool_header_t* header) {
+  iree_object_pool_thread_cache_t* cache = &iree_object_pool_thread_cache;
+  if (pool->thread_cached) {
+    if (IREE_UNLIKELY(!cache->exit_registered)) {
+      cache->exit_registered = iree_object_pool_thread_exit_register(cache);
+    }
+    if (IREE_LIKELY(cache->exit_registered)) {
+      // Return the older half of a full cache to the shard in one operation.
+      if (cache->count[size_class] == IREE_OBJECT_POOL_THREAD_CACHE_CAPACITY) {
+        iree_object_pool_thread_cache_flush(
+            pool, cache, size_class,
+            IREE_OBJECT_POOL_THREAD_CACHE_CAPACITY / 2);
+      }
+      cache->headers[size_class][cache->count[size_class]++] = header;
+      return;
+    }
+  }
+  iree_arena_block_pool_t* block_pool =
+      &pool->shards[size_class][iree_object_pool_current_shard()].block_pool;
+  iree_arena_block_t* block = iree_arena_block_trailer(block_pool, header);
+  iree_atomic_arena_block_slist_push(&block_pool->available_slist, block);
+}
+
+void iree_object_pool_free(iree_object_pool_t* pool, void* ptr) {
+  IREE_ASSERT_ARGUMENT(pool);
+  if (!ptr) return;
+  iree_object_pool_header_t* header = (iree_object_pool_header_t*)ptr - 1;
+  IREE_STATISTICS(iree_atomic_fetch_sub(&header->type->live_count, 1,
+                                        iree_memory_order_relaxed));
+  if (header->size_class == IREE_OBJECT_POOL_SIZE_CLASS_OVERSIZED) {
+    iree_allocator_free(pool->block_allocator, header);
+  } else {
+    iree_object_pool_release_block(pool, header->size_class, header);
+  }
+}
+
+static iree_object_pool_t iree_object_pool_global_storage;
+static iree_once_flag iree_object_pool_global_flag = IREE_ONCE_FLAG_INIT;
+
+static void iree_object_pool_global_initialize(void) {
+#if defined(IREE_ALLOCATOR_SYSTEM_CTL)
+  iree_object_pool_initialize(iree_allocator_system(),
+                              &iree_object_pool_global_storage);
+#else
+  iree_object_pool_initialize(iree_allocator_null(),
+                              &iree_object_pool_global_storage);
+#endif  // IREE_ALLOCATOR_SYSTEM_CTL
+  // The process pool is never deinitialized so blocks cached by threads only
+  // need to be returned when the threads exit.
+  iree_object_pool_global_storage.thread_cached = true;
+  iree_object_pool_thread_exit_initialize();
+}
+
+iree_object_pool_t* iree_object_pool_global(void) {
+#if IREE_SYNCHRONIZATION_DISABLE_UNSAFE
+  // iree_call_once is a no-op when synchronization is disabled.
+  static bool initialized = false;
+  if (IREE_UNLIKELY(!initialized)) {
+    iree_object_pool_global_initialize();
+    initialized = true;
+  }
+#else
+  iree_call_once(&iree_object_pool_global_flag,
+                 iree_object_pool_global_initialize);
+#endif  // IREE_SYNCHRONIZATION_DISABLE_UNSAFE
+  return &iree_object_pool_global_storage;
+}
@@ -0,0 +1,181 @@
+// Copyright 2025 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_BASE_INTERNAL_OBJECT_POOL_H_
+#define IREE_BASE_INTERNAL_OBJECT_POOL_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "iree/base/api.h"
+#include "iree/base/internal/arena.h"
+#include "iree/base/internal/atomics.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+//===----------------------------------------------------------------------===//
+// Compile-time configuration
+//===----------------------------------------------------------------------===//
+
+// Enables pooling of small host objects. When disabled every object is
+// allocated individually from the block allocator and only the counters are
+// kept.
+// Pooling is disabled by default under sanitizers so that use-after-free and
+// leaks of individual objects remain visible to them.
+#if !defined(IREE_OBJECT_POOL_ENABLE)
+#if defined(IREE_SANITIZER_ADDRESS) || defined(IREE_SANITIZER_MEMORY) || \
+    defined(IREE_SANITIZER_THREAD)
+#define IREE_OBJECT_POOL_ENABLE 0
+#else
+#define IREE_OBJECT_POOL_ENABLE 1
+#endif  // IREE_SANITIZER_*
+#endif  // !IREE_OBJECT_POOL_ENABLE
+
+// Total number of size classes. Class N holds blocks of 64 << N bytes
+// including the per-object header and block pool trailer.
+#define IREE_OBJECT_POOL_SIZE_CLASS_COUNT 4
+
+// Number of free list shards per size class. Threads are assigned a shard on
+// first use and release objects to it so that threads allocating and freeing
+// their own objects rarely touch the same list head.
+#define IREE_OBJECT_POOL_SHARD_COUNT 8
+
+//===----------------------------------------------------------------------===//
+// iree_object_pool_type_t
+//===----------------------------------------------------------------------===//
+
+// Snapshot of the counters of an iree_object_pool_type_t.
+typedef struct iree_object_pool_type_stats_t {
+  // Total number of allocations made.
+  int64_t allocation_count;
+  // Number of allocations satisfied by reusing a previously pooled object.
+  int64_t reuse_count;
+  // Number of allocations that were too large to pool.
+  int64_t oversized_count;
+  // Number of allocations currently live.
+  int64_t live_count;
+} iree_object_pool_type_stats_t;
+
+// Per-type allocation counters (when IREE_STATISTICS_ENABLE is set).
+// Each type opting into pooling declares one of these statically with
+// IREE_OBJECT_POOL_TYPE_INITIALIZER and passes it to
+// iree_object_pool_type_allocator. Types are registered with the process on
+// their first allocation and can be enumerated with
+// iree_object_pool_enumerate_types.
+//
+// Thread-safe; counters are updated atomically.
+typedef struct iree_object_pool_type_t {
+  // Name of the type used when reporting (such as `iree_hal_buffer_view`).
+  const char* name;
+  iree_atomic_int64_t allocation_count;
+  iree_atomic_int64_t reuse_count;
+  iree_atomic_int64_t oversized_count;
+  iree_atomic_int64_t live_count;
+  // Nonzero once the type has been added to the process type list.
+  iree_atomic_int32_t registered;
+  // Next type in the process type list.
+  struct iree_object_pool_type_t* next;
+} iree_object_pool_type_t;
+
+// Static initializer for an iree_object_pool_type_t named |type_name|.
+#define IREE_OBJECT_POOL_TYPE_INITIALIZER(type_name) {(type_name)}
+
+// Returns a snapshot of the counters of |type|.
+iree_object_pool_type_stats_t iree_object_pool_type_query_stats(
+    iree_object_pool_type_t* type);
+
+// Calls |callback| for each type that has made at least one allocation.
+// Order is unspecified.
+void iree_object_pool_enumerate_types(
+    void(IREE_API_PTR* callback)(void* user_data,
+                                 iree_object_pool_type_t* type),
+    void* user_data);
+
+// Returns an allocator for objects of |type| that allocates from the process
+// object pool when |base_allocator| is the system allocator and otherwise
+// forwards to |base_allocator|. Allocations too large for any size class and
+// realloc growth beyond the largest class also forward to |base_allocator|.
+//
+// Only the process-wide pool is shared across types so that objects of
+// different types with similar sizes reuse each other's blocks. Callers must
+// store the returned allocator and use it to free the object.
+iree_allocator_t iree_object_pool_type_allocator(
+    iree_object_pool_type_t* type, iree_allocator_t base_allocator);
+
+//===----------------------------------------------------------------------===//
+// iree_object_pool_t
+//===----------------------------------------------------------------------===//
+
+// A free list shard padded to avoid false sharing with its neighbors.
+typedef struct iree_object_pool_shard_t {
+  iree_alignas(iree_hardware_destructive_interference_size)
+      iree_arena_block_pool_t block_pool;
+} iree_object_pool_shard_t;
+
+// A size-segregated pool of small host objects.
+// Objects are allocated from one of IREE_OBJECT_POOL_SIZE_CLASS_COUNT size
+// classes, each with IREE_OBJECT_POOL_SHARD_COUNT block pools used as free
+// lists. Threads allocate from and release to their own shard and only
+// scan the other shards of the class when their own is empty before falling
+// back to allocating a new block from |block_allocator|. The process pool
+// additionally caches a small number of freed blocks per thread so that
+// objects created and destroyed on the same thread need no synchronization.
+//
+// Thread-safe; the underlying block allocator must also be thread-safe.
+typedef struct iree_object_pool_t {
+  // Allocator used for blocks and oversized allocations.
+  iree_allocator_t block_allocator;
+  // True if freed blocks may be kept in per-thread caches. Cached blocks are
+  // only returned when their thread exits so this is only used by the process
+  // pool that is never deinitialized.
+  bool thread_cached;
+  // Free list shards for each size class.
+  iree_object_pool_shard_t shards[IREE_OBJECT_POOL_SIZE_CLASS_COUNT]
+                                 [IREE_OBJECT_POOL_SHARD_COUNT];
+} iree_object_pool_t;
+
+// Initializes |out_pool| to allocate blocks from |block_allocator|.
+void iree_object_pool_initialize(iree_allocator_t block_allocator,
+                                 iree_object_pool_t* out_pool);
+
+// Deinitializes |pool| and frees all pooled blocks.
+// All objects allocated from the pool must have already been freed.
+void iree_object_pool_deinitialize(iree_object_pool_t* pool);
+
+// Frees all unused blocks in |pool| back to the block allocator.
+// Live objects are not affected.
+void iree_object_pool_trim(iree_object_pool_t* pool);
+
+// Allocates |byte_length| bytes for an object of |type| from |pool|.
+// The contents are undefined.
+iree_status_t iree_object_pool_allocate(iree_object_pool_t* pool,
+                                        iree_object_pool_type_t* type,
+                                        iree_host_size_t byte_length,
+                                        void** out_ptr);
+
+// Resizes the allocation in |inout_ptr| to |byte_length| bytes. Allocations
+// that still fit in their existing block are returned unchanged. On failure
+// the existing allocation is unmodified.
+iree_status_t iree_object_pool_reallocate(iree_object_pool_t* pool,
+                                          iree_host_size_t byte_length,
+                                          void** inout_ptr);
+
+// Frees |ptr| previously allocated from |pool|.
+void iree_object_pool_free(iree_object_pool_t* pool, void* ptr);
+
+// Returns the process-wide object pool used by
+// iree_object_pool_type_allocator. The pool is created on first use and lives
+// until process exit.
+iree_object_pool_t* iree_object_pool_global(void);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_BASE_INTERNAL_OBJECT_POOL_H_
@@ -0,0 +1,181 @@
+// Copyright 2025 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/base/internal/object_pool.h"
+
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace {
+
+// Expects the |field| counter of |type| to equal |value| when statistics are
+// enabled.
+#if IREE_STATISTICS_ENABLE
+#define EXPECT_STATS(type, field, value) \
+  EXPECT_EQ(iree_object_pool_type_query_stats(&(type)).field, (value))
+#else
+#define EXPECT_STATS(type, field, value)
+#endif  // IREE_STATISTICS_ENABLE
+
+class ObjectPoolTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    iree_object_pool_initialize(iree_allocator_system(), &pool_);
+  }
+  void TearDown() override { iree_object_pool_deinitialize(&pool_); }
+
+  iree_object_pool_t pool_;
+};
+
+TEST_F(ObjectPoolTest, Lifetime) {}
+
+TEST_F(ObjectPoolTest, AllocateFree) {
+  static iree_object_pool_type_t type =
+      IREE_OBJECT_POOL_TYPE_INITIALIZER("AllocateFree");
+  void* ptr = NULL;
+  IREE_ASSERT_OK(iree_object_pool_allocate(&pool_, &type, 32, &ptr));
+  ASSERT_NE(ptr, nullptr);
+  EXPECT_TRUE(iree_host_size_has_alignment((uintptr_t)ptr, iree_max_align_t));
+  memset(ptr, 0xCD, 32);
+  EXPECT_STATS(type, allocation_count, 1);
+  EXPECT_STATS(type, live_count, 1);
+  iree_object_pool_free(&pool_, ptr);
+  EXPECT_STATS(type, live_count, 0);
+}
+
+TEST_F(ObjectPoolTest, ReusesFreedObjects) {
+  static iree_object_pool_type_t type =
+      IREE_OBJECT_POOL_TYPE_INITIALIZER("ReusesFreedObjects");
+  void* ptr0 = NULL;
+  IREE_ASSERT_OK(iree_object_pool_allocate(&pool_, &type, 40, &ptr0));
+  iree_object_pool_free(&pool_, ptr0);
+  void* ptr1 = NULL;
+  IREE_ASSERT_OK(iree_object_pool_allocate(&pool_, &type, 40, &ptr1));
+  iree_object_pool_free(&pool_, ptr1);
+  EXPECT_STATS(type, allocation_count, 2);
+  EXPECT_STATS(type, live_count, 0);
+#if IREE_OBJECT_POOL_ENABLE
+  EXPECT_EQ(ptr0, ptr1);
+  EXPECT_STATS(type, reuse_count, 1);
+#endif  // IREE_OBJECT_POOL_ENABLE
+}
+
+TEST_F(ObjectPoolTest, Oversized) {
+  static iree_object_pool_type_t type =
+      IREE_OBJECT_POOL_TYPE_INITIALIZER("Oversized");
+  void* ptr = NULL;
+  IREE_ASSERT_OK(iree_object_pool_allocate(&pool_, &type, 64 * 1024, &ptr));
+  memset(ptr, 0xCD, 64 * 1024);
+  iree_object_pool_free(&pool_, ptr);
+  EXPECT_STATS(type, oversized_count, 1);
+  EXPECT_STATS(type, live_count, 0);
+}
+
+// Tests growing an allocation through each size class into an oversized
+// allocation and back down while preserving its contents.
+TEST_F(ObjectPoolTest, Reallocate) {
+  static iree_object_pool_type_t type =
+      IREE_OBJECT_POOL_TYPE_INITIALIZER("Reallocate");
+  void* ptr = NULL;
+  IREE_ASSERT_OK(iree_object_pool_allocate(&pool_, &type, 8, &ptr));
+  for (size_t i = 0; i < 8; ++i) ((uint8_t*)ptr)[i] = (uint8_t)i;
+  for (iree_host_size_t length : {16, 100, 400, 4000, 40000, 8}) {
+    IREE_ASSERT_OK(iree_object_pool_reallocate(&pool_, length, &ptr));
+    for (size_t i = 0; i < 8; ++i) {
+      ASSERT_EQ(((uint8_t*)ptr)[i], (uint8_t)i);
+    }
+    memset((uint8_t*)ptr + 8, 0xCD, length - 8);
+  }
+  iree_object_pool_free(&pool_, ptr);
+  EXPECT_STATS(type, live_count, 0);
+}
+
+TEST_F(ObjectPoolTest, ManyObjects) {
+  static iree_object_pool_type_t type =
+      IREE_OBJECT_POOL_TYPE_INITIALIZER("ManyObjects");
+  std::vector<void*> ptrs;
+  for (iree_host_size_t i = 0; i < 1000; ++i) {
+    void* ptr = NULL;
+    IREE_ASSERT_OK(iree_object_pool_allocate(&pool_, &type, i % 400, &ptr));
+    memset(ptr, 0xCD, i % 400);
+    ptrs.push_back(ptr);
+  }
+  for (void* ptr : ptrs) iree_object_pool_free(&pool_, ptr);
+  iree_object_pool_trim(&pool_);
+  EXPECT_STATS(type, allocation_count, 1000);
+  EXPECT_STATS(type, live_count, 0);
+}
+
+TEST(ObjectPoolTypeAllocatorTest, PoolsSystemAllocations) {
+  static iree_object_pool_type_t type =
+      IREE_OBJECT_POOL_TYPE_INITIALIZER("PoolsSystemAllocations");
+  iree_allocator_t allocator =
+      iree_object_pool_type_allocator(&type, iree_allocator_system());
+  void* ptr = NULL;
+  IREE_ASSERT_OK(iree_allocator_malloc(allocator, 48, &ptr));
+  for (size_t i = 0; i < 48; ++i) ASSERT_EQ(((uint8_t*)ptr)[i], 0);
+  IREE_ASSERT_OK(iree_allocator_realloc(allocator, 1000, &ptr));
+  iree_allocator_free(allocator, ptr);
+  EXPECT_STATS(type, live_count, 0);
+
+  // The type is registered on first use and visible to enumeration.
+  bool found = false;
+  iree_object_pool_enumerate_types(
+      [](void* user_data, iree_object_pool_type_t* enumerated_type) {
+        if (enumerated_type == &type) *(bool*)user_data = true;
+      },
+      &found);
+  EXPECT_TRUE(found);
+}
+
+// Tests objects allocated on one thread and freed on others, as happens when
+// results are consumed by a different thread than produced them. Blocks
+// cached by the worker threads are returned to the pool when they exit.
+TEST(ObjectPoolTypeAllocatorTest, CrossThreadFree) {
+  static iree_object_pool_type_t type =
+      IREE_OBJECT_POOL_TYPE_INITIALIZER("CrossThreadFree");
+  iree_allocator_t allocator =
+      iree_object_pool_type_allocator(&type, iree_allocator_system());
+  static constexpr size_t kThreadCount = 4;
+  static constexpr size_t kObjectCount = 256;
+  std::vector<std::vector<void*>> ptrs(kThreadCount);
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < kThreadCount; ++i) {
+    threads.emplace_back([&, i]() {
+      for (size_t j = 0; j < kObjectCount; ++j) {
+        void* ptr = NULL;
+        IREE_CHECK_OK(iree_allocator_malloc(allocator, 16 + j % 200, &ptr));
+        ptrs[i].push_back(ptr);
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+  threads.clear();
+  for (size_t i = 0; i < kThreadCount; ++i) {
+    threads.emplace_back([&, i]() {
+      for (void* ptr : ptrs[(i + 1) % kThreadCount]) {
+        iree_allocator_free(allocator, ptr);
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+  EXPECT_STATS(type, allocation_count, kThreadCount * kObjectCount);
+  EXPECT_STATS(type, live_count, 0);
+}
+
+TEST(ObjectPoolTypeAllocatorTest, ForwardsOtherAllocators) {
+  static iree_object_pool_type_t type =
+      IREE_OBJECT_POOL_TYPE_INITIALIZER("ForwardsOtherAllocators");
+  iree_allocator_t allocator =
+      iree_object_pool_type_allocator(&type, iree_allocator_null());
+  EXPECT_TRUE(iree_allocator_is_null(allocator));
+}
+
+}  // namespace
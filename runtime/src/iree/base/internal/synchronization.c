@@ -7,8 +7,12 @@
 #include "iree/base/internal/synchronization.h"
 
 #include <assert.h>
+#include <inttypes.h>
+#include <stdlib.h>
 #include <string.h>
 
+#include "iree/base/internal/math.h"
+
 #if IREE_SYNCHRONIZATION_DISABLE_UNSAFE
 
 // Disabled.
@@ -192,6 +196,211 @@ static inline void iree_futex_wake(void* address, int32_t count) {
 
 #endif  // IREE_RUNTIME_USE_FUTEX
 
+//==============================================================================
+// Lock contention profiling
+//==============================================================================
+
+// Head of the process site list (iree_lock_site_t*).
+static iree_atomic_intptr_t iree_lock_site_list_head = IREE_ATOMIC_VAR_INIT(0);
+
+#if IREE_SYNCHRONIZATION_PROFILE_LOCKS
+
+static void iree_lock_site_register(iree_lock_site_t* site) {
+  int32_t expected = 0;
+  if (!iree_atomic_compare_exchange_strong(
+          &site->registered, &expected, 1, iree_memory_order_acq_rel,
+          iree_memory_order_relaxed /* expected is unused */)) {
+    return;  // registered by another thread
+  }
+  intptr_t head =
+      iree_atomic_load(&iree_lock_site_list_head, iree_memory_order_relaxed);
+  do {
+    site->next = (iree_lock_site_t*)head;
+  } while (!iree_atomic_compare_exchange_weak(
+      &iree_lock_site_list_head, &head, (intptr_t)site,
+      iree_memory_order_release, iree_memory_order_relaxed));
+}
+
+// Records an acquisition of a lock initialized at |site| that did not wait.
+static void iree_lock_site_record_acquire(iree_lock_site_t* site) {
+  if (IREE_UNLIKELY(
+          !iree_atomic_load(&site->registered, iree_memory_order_relaxed))) {
+    iree_lock_site_register(site);
+  }
+  iree_atomic_fetch_add(&site->acquire_count, 1, iree_memory_order_relaxed);
+}
+
+// Returns the wait histogram bucket for a wait of |wait_ns|.
+static int iree_lock_site_wait_bucket(iree_duration_t wait_ns) {
+  if (wait_ns < 1024) return 0;
+  int bucket = (63 - iree_math_count_leading_zeros_u64((uint64_t)wait_ns)) - 9;
+  return iree_min(bucket, IREE_LOCK_SITE_WAIT_BUCKET_COUNT - 1);
+}
+
+// Records an acquisition of a lock initialized at |site| that waited
+// |wait_ns| for another thread to release it.
+static void iree_lock_site_record_contended_acquire(iree_lock_site_t* site,
+                                                    iree_duration_t wait_ns) {
+  iree_lock_site_record_acquire(site);
+  iree_atomic_fetch_add(&site->contended_count, 1, iree_memory_order_relaxed);
+  iree_atomic_fetch_add(&site->total_wait_ns, wait_ns,
+                        iree_memory_order_relaxed);
+  const int bucket = iree_lock_site_wait_bucket(wait_ns);
+  iree_atomic_fetch_add(&site->wait_buckets[bucket], 1,
+                        iree_memory_order_relaxed);
+  int64_t max_wait_ns =
+      iree_atomic_load(&site->max_wait_ns, iree_memory_order_relaxed);
+  while (wait_ns > max_wait_ns &&
+         !iree_atomic_compare_exchange_weak(&site->max_wait_ns, &max_wait_ns,
+                                            wait_ns, iree_memory_order_relaxed,
+                                            iree_memory_order_relaxed)) {
+  }
+}
+
+#endif  // IREE_SYNCHRONIZATION_PROFILE_LOCKS
+
+iree_lock_site_stats_t iree_lock_site_query_stats(iree_lock_site_t* site) {
+  iree_lock_site_stats_t stats;
+  stats.acquire_count =
+      iree_atomic_load(&site->acquire_count, iree_memory_order_relaxed);
+  stats.contended_count =
+      iree_atomic_load(&site->contended_count, iree_memory_order_relaxed);
+  stats.total_wait_ns =
+      iree_atomic_load(&site->total_wait_ns, iree_memory_order_relaxed);
+  stats.max_wait_ns =
+      iree_atomic_load(&site->max_wait_ns, iree_memory_order_relaxed);
+  for (int i = 0; i < IREE_LOCK_SITE_WAIT_BUCKET_COUNT; ++i) {
+    stats.wait_buckets[i] =
+        iree_atomic_load(&site->wait_buckets[i], iree_memory_order_relaxed);
+  }
+  return stats;
+}
+
+void iree_lock_profile_enumerate_sites(
+    void(IREE_API_PTR* callback)(void* user_data, iree_lock_site_t* site),
+    void* user_data) {
+  iree_lock_site_t* site = (iree_lock_site_t*)iree_atomic_load(
+      &iree_lock_site_list_head, iree_memory_order_acquire);
+  while (site) {
+    callback(user_data, site);
+    site = site->next;
+  }
+}
+
+static void iree_lock_profile_reset_site(void* user_data,
+                                         iree_lock_site_t* site) {
+  iree_atomic_store(&site->acquire_count, 0, iree_memory_order_relaxed);
+  iree_atomic_store(&site->contended_count, 0, iree_memory_order_relaxed);
+  iree_atomic_store(&site->total_wait_ns, 0, iree_memory_order_relaxed);
+  iree_atomic_store(&site->max_wait_ns, 0, iree_memory_order_relaxed);
+  for (int i = 0; i < IREE_LOCK_SITE_WAIT_BUCKET_COUNT; ++i) {
+    iree_atomic_store(&site->wait_buckets[i], 0, iree_memory_order_relaxed);
+  }
+}
+
+void iree_lock_profile_reset(void) {
+  iree_lock_profile_enumerate_sites(iree_lock_profile_reset_site, NULL);
+}
+
+#if IREE_SYNCHRONIZATION_PROFILE_LOCKS
+
+typedef struct iree_lock_profile_entry_t {
+  iree_lock_site_t* site;
+  iree_lock_site_stats_t stats;
+} iree_lock_profile_entry_t;
+
+typedef struct iree_lock_profile_snapshot_t {
+  iree_host_size_t capacity;
+  iree_host_size_t count;
+  iree_lock_profile_entry_t* entries;
+} iree_lock_profile_snapshot_t;
+
+static void iree_lock_profile_count_site(void* user_data,
+                                         iree_lock_site_t* site) {
+  ++((iree_lock_profile_snapshot_t*)user_data)->capacity;
+}
+
+static void iree_lock_profile_snapshot_site(void* user_data,
+                                            iree_lock_site_t* site) {
+  iree_lock_profile_snapshot_t* snapshot =
+      (iree_lock_profile_snapshot_t*)user_data;
+  if (snapshot->count == snapshot->capacity) return;  // registered since
+  iree_lock_profile_entry_t* entry = &snapshot->entries[snapshot->count];
+  entry->site = site;
+  entry->stats = iree_lock_site_query_stats(site);
+  if (entry->stats.acquire_count > 0) ++snapshot->count;
+}
+
+// Orders entries by descending total wait time and then acquire count.
+static int iree_lock_profile_entry_compare(const void* a, const void* b) {
+  const iree_lock_site_stats_t* lhs = &((iree_lock_profile_entry_t*)a)->stats;
+  const iree_lock_site_stats_t* rhs = &((iree_lock_profile_entry_t*)b)->stats;
+  if (lhs->total_wait_ns != rhs->total_wait_ns) {
+    return lhs->total_wait_ns < rhs->total_wait_ns ? 1 : -1;
+  }
+  if (lhs->acquire_count != rhs->acquire_count) {
+    return lhs->acquire_count < rhs->acquire_count ? 1 : -1;
+  }
+  return 0;
+}
+
+static void iree_lock_profile_fprint_entry(
+    FILE* file, const iree_lock_profile_entry_t* entry) {
+  const iree_lock_site_t* site = entry->site;
+  const iree_lock_site_stats_t* stats = &entry->stats;
+  fprintf(file,
+          "%s:%u (%s): %" PRId64 " acquires, %" PRId64
+          " contended (%.2f%%), waited %.3fms total, %.3fms max\n",
+          site->file, site->line, site->function, stats->acquire_count,
+          stats->contended_count,
+          100.0 * stats->contended_count / stats->acquire_count,
+          stats->total_wait_ns / 1000000.0, stats->max_wait_ns / 1000000.0);
+  if (stats->contended_count == 0) return;
+  fprintf(file, "  waits:");
+  for (int i = 0; i < IREE_LOCK_SITE_WAIT_BUCKET_COUNT; ++i) {
+    if (stats->wait_buckets[i] == 0) continue;
+    if (i == 0) {
+      fprintf(file, " <1024ns=%" PRId64, stats->wait_buckets[i]);
+    } else {
+      fprintf(file, " >=%" PRIu64 "ns=%" PRId64, UINT64_C(1) << (i + 9),
+              stats->wait_buckets[i]);
+    }
+  }
+  fprintf(file, "\n");
+}
+
+void iree_lock_profile_fprint(FILE* file) {
+  iree_lock_profile_snapshot_t snapshot = {0};
+  iree_lock_profile_enumerate_sites(iree_lock_profile_count_site, &snapshot);
+  iree_status_t status = iree_allocator_malloc(
+      iree_allocator_system(), snapshot.capacity * sizeof(*snapshot.entries),
+      (void**)&snapshot.entries);
+  if (!iree_status_is_ok(status)) {
+    fprintf(file, "lock profile unavailable: out of memory\n");
+    iree_status_ignore(status);
+    return;
+  }
+  iree_lock_profile_enumerate_sites(iree_lock_profile_snapshot_site,
+                                    &snapshot);
+  qsort(snapshot.entries, snapshot.count, sizeof(*snapshot.entries),
+        iree_lock_profile_entry_compare);
+  fprintf(file, "lock profile (%" PRIhsz " sites):\n", snapshot.count);
+  for (iree_host_size_t i = 0; i < snapshot.count; ++i) {
+    iree_lock_profile_fprint_entry(file, &snapshot.entries[i]);
+  }
+  iree_allocator_free(iree_allocator_system(), snapshot.entries);
+}
+
+#else
+
+void iree_lock_profile_fprint(FILE* file) {
+  fprintf(file,
+          "lock profile unavailable: build with "
+          "IREE_SYNCHRONIZATION_PROFILE_LOCKS=1\n");
+}
+
+#endif  // IREE_SYNCHRONIZATION_PROFILE_LOCKS
+
 //==============================================================================
 // iree_mutex_t
 //==============================================================================
@@ -277,6 +486,41 @@ void iree_mutex_unlock(iree_mutex_t* mutex) {
   iree_tracing_mutex_after_unlock(mutex->lock_id);
 }
 
+#elif IREE_SYNCHRONIZATION_PROFILE_LOCKS
+
+void iree_mutex_initialize_impl(iree_lock_site_t* site,
+                                iree_mutex_t* out_mutex) {
+  memset(out_mutex, 0, sizeof(*out_mutex));
+  out_mutex->site = site;
+  iree_mutex_impl_initialize(out_mutex);
+}
+
+void iree_mutex_deinitialize(iree_mutex_t* mutex) {
+  iree_mutex_impl_deinitialize(mutex);
+  memset(mutex, 0, sizeof(*mutex));
+}
+
+void iree_mutex_lock(iree_mutex_t* mutex) {
+  if (!mutex->site) {
+    iree_mutex_impl_lock(mutex);
+  } else if (iree_mutex_impl_try_lock(mutex)) {
+    iree_lock_site_record_acquire(mutex->site);
+  } else {
+    iree_time_t start_ns = iree_time_now();
+    iree_mutex_impl_lock(mutex);
+    iree_lock_site_record_contended_acquire(mutex->site,
+                                            iree_time_now() - start_ns);
+  }
+}
+
+bool iree_mutex_try_lock(iree_mutex_t* mutex) {
+  bool was_acquired = iree_mutex_impl_try_lock(mutex);
+  if (was_acquired && mutex->site) iree_lock_site_record_acquire(mutex->site);
+  return was_acquired;
+}
+
+void iree_mutex_unlock(iree_mutex_t* mutex) { iree_mutex_impl_unlock(mutex); }
+
 #else
 
 void iree_mutex_initialize(iree_mutex_t* out_mutex) {
@@ -335,6 +579,24 @@ void iree_slim_mutex_unlock(iree_slim_mutex_t* mutex) {
 
 #else
 
+#if IREE_SYNCHRONIZATION_PROFILE_LOCKS
+
+// The platform implementations below are wrapped by profiled versions that
+// record acquisitions against the site of each mutex.
+#undef iree_slim_mutex_initialize
+#define iree_slim_mutex_initialize iree_slim_mutex_platform_initialize
+#define iree_slim_mutex_deinitialize iree_slim_mutex_platform_deinitialize
+#define iree_slim_mutex_lock iree_slim_mutex_platform_lock
+#define iree_slim_mutex_try_lock iree_slim_mutex_platform_try_lock
+#define iree_slim_mutex_unlock iree_slim_mutex_platform_unlock
+static void iree_slim_mutex_platform_initialize(iree_slim_mutex_t* out_mutex);
+static void iree_slim_mutex_platform_deinitialize(iree_slim_mutex_t* mutex);
+static void iree_slim_mutex_platform_lock(iree_slim_mutex_t* mutex);
+static bool iree_slim_mutex_platform_try_lock(iree_slim_mutex_t* mutex);
+static void iree_slim_mutex_platform_unlock(iree_slim_mutex_t* mutex);
+
+#endif  // IREE_SYNCHRONIZATION_PROFILE_LOCKS
+
 #if IREE_SYNCHRONIZATION_DISABLE_UNSAFE
 
 void iree_slim_mutex_initialize(iree_slim_mutex_t* out_mutex) {}
@@ -532,7 +794,12 @@ void iree_slim_mutex_unlock(iree_slim_mutex_t* mutex) {
 // when tracing all slim mutexes will be traced along with the fat mutexes.
 
 void iree_slim_mutex_initialize(iree_slim_mutex_t* out_mutex) {
+#if IREE_SYNCHRONIZATION_PROFILE_LOCKS
+  // Acquisitions are recorded against the site of the slim mutex instead.
+  iree_mutex_initialize_impl(/*site=*/NULL, &out_mutex->impl);
+#else
   iree_mutex_initialize(&out_mutex->impl);
+#endif  // IREE_SYNCHRONIZATION_PROFILE_LOCKS
 }
 
 void iree_slim_mutex_deinitialize(iree_slim_mutex_t* mutex) {
@@ -553,6 +820,49 @@ void iree_slim_mutex_unlock(iree_slim_mutex_t* mutex) {
 
 #endif  // IREE_PLATFORM_*
 
+#if IREE_SYNCHRONIZATION_PROFILE_LOCKS
+
+#undef iree_slim_mutex_initialize
+#undef iree_slim_mutex_deinitialize
+#undef iree_slim_mutex_lock
+#undef iree_slim_mutex_try_lock
+#undef iree_slim_mutex_unlock
+
+void iree_slim_mutex_initialize_impl(iree_lock_site_t* site,
+                                     iree_slim_mutex_t* out_mutex) {
+  iree_slim_mutex_platform_initialize(out_mutex);
+  out_mutex->site = site;
+}
+
+void iree_slim_mutex_deinitialize(iree_slim_mutex_t* mutex) {
+  iree_slim_mutex_platform_deinitialize(mutex);
+}
+
+void iree_slim_mutex_lock(iree_slim_mutex_t* mutex) {
+  if (!mutex->site) {
+    iree_slim_mutex_platform_lock(mutex);
+  } else if (iree_slim_mutex_platform_try_lock(mutex)) {
+    iree_lock_site_record_acquire(mutex->site);
+  } else {
+    iree_time_t start_ns = iree_time_now();
+    iree_slim_mutex_platform_lock(mutex);
+    iree_lock_site_record_contended_acquire(mutex->site,
+                                            iree_time_now() - start_ns);
+  }
+}
+
+bool iree_slim_mutex_try_lock(iree_slim_mutex_t* mutex) {
+  bool was_acquired = iree_slim_mutex_platform_try_lock(mutex);
+  if (was_acquired && mutex->site) iree_lock_site_record_acquire(mutex->site);
+  return was_acquired;
+}
+
+void iree_slim_mutex_unlock(iree_slim_mutex_t* mutex) {
+  iree_slim_mutex_platform_unlock(mutex);
+}
+
+#endif  // IREE_SYNCHRONIZATION_PROFILE_LOCKS
+
 #endif  //  IREE_TRACING_FEATURES & IREE_TRACING_FEATURE_SLOW_LOCKS
 
 //==============================================================================
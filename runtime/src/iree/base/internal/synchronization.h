@@ -14,6 +14,7 @@
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <stdio.h>
 
 #include "iree/base/api.h"
 #include "iree/base/internal/atomics.h"
@@ -85,6 +86,86 @@ extern "C" {
 #define IREE_ALL_WAITERS INT32_MAX
 #define IREE_INFINITE_TIMEOUT_MS UINT32_MAX
 
+//==============================================================================
+// Lock contention profiling
+//==============================================================================
+
+#if IREE_SYNCHRONIZATION_PROFILE_LOCKS
+#if IREE_SYNCHRONIZATION_DISABLE_UNSAFE
+#error "Lock profiling requires synchronization to be enabled."
+#endif  // IREE_SYNCHRONIZATION_DISABLE_UNSAFE
+#if (IREE_TRACING_FEATURES & \
+     (IREE_TRACING_FEATURE_FAST_LOCKS | IREE_TRACING_FEATURE_SLOW_LOCKS))
+#error "Lock profiling cannot be combined with tracy lock tracing."
+#endif  // IREE_TRACING_FEATURE_*_LOCKS
+#endif  // IREE_SYNCHRONIZATION_PROFILE_LOCKS
+
+// Number of wait time histogram buckets tracked per lock site.
+// Bucket 0 holds waits shorter than 1024ns and bucket N holds waits in
+// [2^(N+9), 2^(N+10)) nanoseconds with the last bucket holding all longer
+// waits (16.8ms+).
+#define IREE_LOCK_SITE_WAIT_BUCKET_COUNT 16
+
+// Snapshot of the counters of an iree_lock_site_t.
+typedef struct iree_lock_site_stats_t {
+  // Total number of times locks from the site were acquired.
+  int64_t acquire_count;
+  // Number of acquisitions that had to wait for another thread.
+  int64_t contended_count;
+  // Total and maximum time spent waiting in contended acquisitions.
+  int64_t total_wait_ns;
+  int64_t max_wait_ns;
+  // Histogram of contended acquisition wait times.
+  int64_t wait_buckets[IREE_LOCK_SITE_WAIT_BUCKET_COUNT];
+} iree_lock_site_stats_t;
+
+// The source location that initialized one or more locks and the aggregate
+// counters of all of them (when IREE_SYNCHRONIZATION_PROFILE_LOCKS is set).
+// Declared statically by the iree_mutex_initialize and
+// iree_slim_mutex_initialize macros and registered with the process on first
+// acquisition. Locks that are statically initialized have no site and are not
+// counted.
+//
+// Thread-safe; counters are updated atomically.
+typedef struct iree_lock_site_t {
+  const char* function;
+  const char* file;
+  uint32_t line;
+  iree_atomic_int64_t acquire_count;
+  iree_atomic_int64_t contended_count;
+  iree_atomic_int64_t total_wait_ns;
+  iree_atomic_int64_t max_wait_ns;
+  iree_atomic_int64_t wait_buckets[IREE_LOCK_SITE_WAIT_BUCKET_COUNT];
+  // Nonzero once the site has been added to the process site list.
+  iree_atomic_int32_t registered;
+  // Next site in the process site list.
+  struct iree_lock_site_t* next;
+} iree_lock_site_t;
+
+#define IREE_LOCK_SITE_CONCAT_(x, y) x##y
+#define IREE_LOCK_SITE_CONCAT(x, y) IREE_LOCK_SITE_CONCAT_(x, y)
+
+// Declares a static iree_lock_site_t named |var| for the current location.
+#define IREE_LOCK_SITE_DECLARE(var) \
+  static iree_lock_site_t var = {__FUNCTION__, __FILE__, (uint32_t)__LINE__}
+
+// Returns a snapshot of the counters of |site|.
+iree_lock_site_stats_t iree_lock_site_query_stats(iree_lock_site_t* site);
+
+// Calls |callback| for each site with at least one acquisition.
+// Order is unspecified. No-op unless IREE_SYNCHRONIZATION_PROFILE_LOCKS is set.
+void iree_lock_profile_enumerate_sites(
+    void(IREE_API_PTR* callback)(void* user_data, iree_lock_site_t* site),
+    void* user_data);
+
+// Resets the counters of all sites. Acquisitions made concurrently with the
+// reset may be partially counted.
+void iree_lock_profile_reset(void);
+
+// Prints the counters and wait time histogram of each site to |file| with the
+// sites that spent the most time waiting first.
+void iree_lock_profile_fprint(FILE* file);
+
 //==============================================================================
 // iree_mutex_t
 //==============================================================================
@@ -110,6 +191,9 @@ typedef struct iree_mutex_t IREE_THREAD_ANNOTATION_ATTRIBUTE(
 #if (IREE_TRACING_FEATURES & IREE_TRACING_FEATURE_SLOW_LOCKS)
   uint32_t lock_id;
 #endif  // IREE_TRACING_FEATURE_SLOW_LOCKS
+#if IREE_SYNCHRONIZATION_PROFILE_LOCKS
+  iree_lock_site_t* site;
+#endif  // IREE_SYNCHRONIZATION_PROFILE_LOCKS
 } iree_mutex_t;
 
 #if (IREE_TRACING_FEATURES & IREE_TRACING_FEATURE_SLOW_LOCKS)
@@ -123,6 +207,15 @@ typedef struct iree_mutex_t IREE_THREAD_ANNOTATION_ATTRIBUTE(
                              out_mutex);
 void iree_mutex_initialize_impl(const iree_tracing_location_t* src_loc,
                                 iree_mutex_t* out_mutex);
+#elif IREE_SYNCHRONIZATION_PROFILE_LOCKS
+// Initializes |out_mutex| to the well-defined unlocked contents.
+// Must be called prior to using any other iree_mutex_* method.
+#define iree_mutex_initialize(out_mutex)                                     \
+  IREE_LOCK_SITE_DECLARE(IREE_LOCK_SITE_CONCAT(__iree_lock_site, __LINE__)); \
+  iree_mutex_initialize_impl(                                                \
+      &IREE_LOCK_SITE_CONCAT(__iree_lock_site, __LINE__), out_mutex);
+void iree_mutex_initialize_impl(iree_lock_site_t* site,
+                                iree_mutex_t* out_mutex);
 #else
 // Initializes |out_mutex| to the well-defined unlocked contents.
 // Must be called prior to using any other iree_mutex_* method.
@@ -289,6 +382,9 @@ typedef struct iree_slim_mutex_t IREE_THREAD_ANNOTATION_ATTRIBUTE(
 #else
   iree_mutex_t impl;  // fallback
 #endif  // IREE_PLATFORM_*
+#if IREE_SYNCHRONIZATION_PROFILE_LOCKS
+  iree_lock_site_t* site;
+#endif  // IREE_SYNCHRONIZATION_PROFILE_LOCKS
 } iree_slim_mutex_t;
 
 #if (IREE_TRACING_FEATURES & IREE_TRACING_FEATURE_FAST_LOCKS)
@@ -302,6 +398,15 @@ typedef struct iree_slim_mutex_t IREE_THREAD_ANNOTATION_ATTRIBUTE(
       &TracyConcat(__tracy_source_location, __LINE__), out_mutex);
 void iree_slim_mutex_initialize_impl(const iree_tracing_location_t* src_loc,
                                      iree_slim_mutex_t* out_mutex);
+#elif IREE_SYNCHRONIZATION_PROFILE_LOCKS
+// Initializes |out_mutex| to the well-defined unlocked contents.
+// Must be called prior to using any other iree_slim_mutex_* method.
+#define iree_slim_mutex_initialize(out_mutex)                                \
+  IREE_LOCK_SITE_DECLARE(IREE_LOCK_SITE_CONCAT(__iree_lock_site, __LINE__)); \
+  iree_slim_mutex_initialize_impl(                                           \
+      &IREE_LOCK_SITE_CONCAT(__iree_lock_site, __LINE__), out_mutex);
+void iree_slim_mutex_initialize_impl(iree_lock_site_t* site,
+                                     iree_slim_mutex_t* out_mutex);
 #else
 // Initializes |out_mutex| to the well-defined unlocked contents.
 // Must be called prior to using any other iree_slim_mutex_* method.
@@ -311,7 +416,7 @@ void iree_slim_mutex_initialize_impl(const iree_tracing_location_t* src_loc,
 // also allows us to swap in a non-slim lock for enhanced debugging if we run
 // into threading issues.
 void iree_slim_mutex_initialize(iree_slim_mutex_t* out_mutex);
-#endif  // IREE_TRACING_FEATURES & IREE_TRACING_FEATURE_FAST_LOCKS
+#endif  // IREE_TRACING_FEATURE_FAST_LOCKS
 
 // Deinitializes |mutex| (after a prior call to iree_slim_mutex_initialize).
 // The mutex must not be held by any thread.
@@ -6,7 +6,10 @@
 
 #include "iree/base/internal/synchronization.h"
 
+#include <atomic>
+#include <chrono>
 #include <thread>
+#include <utility>
 
 #include "iree/testing/gtest.h"
 
@@ -171,6 +174,93 @@ TEST(SlimMutexTest, ExclusiveAccessTryLock) {
   TestMutexExclusiveAccessTryLock<iree_slim_mutex_t>();
 }
 
+//==============================================================================
+// Lock contention profiling
+//==============================================================================
+
+#if IREE_SYNCHRONIZATION_PROFILE_LOCKS
+
+// Returns the sum of all wait histogram buckets in |stats|.
+static int64_t SumWaitBuckets(const iree_lock_site_stats_t& stats) {
+  int64_t sum = 0;
+  for (int64_t count : stats.wait_buckets) sum += count;
+  return sum;
+}
+
+// Tests that acquisitions are recorded against the site that initialized the
+// mutex and that waiting on another thread is recorded as contention. The site
+// is shared with all other tests initializing the same mutex type so only the
+// deltas are checked.
+template <typename T>
+void TestMutexProfile() {
+  T mu;
+  Mutex<T>::Initialize(&mu);
+  ASSERT_NE(mu.site, nullptr);
+  iree_lock_site_stats_t initial = iree_lock_site_query_stats(mu.site);
+
+  // Uncontended acquisitions.
+  Mutex<T>::Lock(&mu);
+  Mutex<T>::Unlock(&mu);
+  while (!Mutex<T>::TryLock(&mu)) {
+    // NOTE: functions with try in their name may fail spuriously.
+  }
+  Mutex<T>::Unlock(&mu);
+  iree_lock_site_stats_t uncontended = iree_lock_site_query_stats(mu.site);
+  EXPECT_EQ(uncontended.acquire_count - initial.acquire_count, 2);
+  EXPECT_EQ(uncontended.contended_count, initial.contended_count);
+
+  // Hold the lock while another thread tries to take it.
+  Mutex<T>::Lock(&mu);
+  std::atomic<bool> started(false);
+  std::thread th1([&]() {
+    started = true;
+    Mutex<T>::Lock(&mu);
+    Mutex<T>::Unlock(&mu);
+  });
+  while (!started) std::this_thread::yield();
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  Mutex<T>::Unlock(&mu);
+  th1.join();
+  iree_lock_site_stats_t contended = iree_lock_site_query_stats(mu.site);
+  EXPECT_EQ(contended.acquire_count - uncontended.acquire_count, 2);
+  EXPECT_EQ(contended.contended_count - uncontended.contended_count, 1);
+  EXPECT_GT(contended.total_wait_ns, uncontended.total_wait_ns);
+  EXPECT_EQ(SumWaitBuckets(contended) - SumWaitBuckets(uncontended), 1);
+
+  // The site is registered and visible to enumeration.
+  std::pair<iree_lock_site_t*, bool> state = {mu.site, false};
+  iree_lock_profile_enumerate_sites(
+      +[](void* user_data, iree_lock_site_t* site) {
+        auto* state = (std::pair<iree_lock_site_t*, bool>*)user_data;
+        if (site == state->first) state->second = true;
+      },
+      &state);
+  EXPECT_TRUE(state.second);
+
+  Mutex<T>::Deinitialize(&mu);
+}
+
+TEST(LockProfileTest, Mutex) { TestMutexProfile<iree_mutex_t>(); }
+
+TEST(LockProfileTest, SlimMutex) { TestMutexProfile<iree_slim_mutex_t>(); }
+
+#else
+
+TEST(LockProfileTest, Disabled) {
+  iree_mutex_t mutex;
+  iree_mutex_initialize(&mutex);
+  iree_mutex_lock(&mutex);
+  iree_mutex_unlock(&mutex);
+  iree_mutex_deinitialize(&mutex);
+  int site_count = 0;
+  iree_lock_profile_enumerate_sites(
+      +[](void* user_data, iree_lock_site_t* site) { ++*(int*)user_data; },
+      &site_count);
+  EXPECT_EQ(site_count, 0);
+}
+
+#endif  // IREE_SYNCHRONIZATION_PROFILE_LOCKS
+
 //==============================================================================
 // iree_notification_t
 //==============================================================================
@@ -124,12 +124,21 @@ bool iree_wait_set_is_empty(const iree_wait_set_t* set);
 // Inserts a wait handle into the set.
 // If the handle is already in the set it will be reference counted such that a
 // matching number of iree_wait_set_erase calls are required.
+//
+// Handles must be erased from the set before they are closed. Implementations
+// may keep handles registered with the platform by their fd and a closed fd
+// number can be reused by the next handle created. Inserting a handle that
+// reuses the fd of a closed handle still in the set is invalid and may assert
+// or fail with IREE_STATUS_FAILED_PRECONDITION.
 iree_status_t iree_wait_set_insert(iree_wait_set_t* set,
                                    iree_wait_handle_t handle);
 
 // Erases a single instance of a wait handle from the set.
 // Decrements the reference count; if the same handle was inserted multiple
 // times then it may still remain in the set after the call returns.
+//
+// Erasing a handle that was already closed is allowed so long as no other
+// handle reusing its fd has been inserted in the meantime.
 void iree_wait_set_erase(iree_wait_set_t* set, iree_wait_handle_t handle);
 
 // Clears all handles from the wait set.
@@ -0,0 +1,162 @@
+// Copyright 2025 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+// NOTE: must be first to ensure that we can define settings for all includes.
+#include "iree/base/internal/wait_handle_impl.h"
+
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "iree/base/api.h"
+#include "iree/base/internal/wait_handle.h"
+
+#if defined(IREE_WAIT_API_POSIX_LIKE)
+#include <poll.h>
+#include <sys/resource.h>
+
+#include "iree/base/internal/wait_handle_posix.h"
+#endif  // IREE_WAIT_API_POSIX_LIKE
+
+namespace {
+
+//==============================================================================
+// Utilities
+//==============================================================================
+
+// A set of unsignaled events with one additional signaled event at the end.
+// This models the task poller: many outstanding waits of which one resolves.
+class EventList {
+ public:
+  explicit EventList(int64_t count) {
+#if defined(IREE_WAIT_API_POSIX_LIKE)
+    // The larger handle counts can exceed the default soft fd limit.
+    struct rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 &&
+        limit.rlim_cur < limit.rlim_max) {
+      limit.rlim_cur = limit.rlim_max;
+      setrlimit(RLIMIT_NOFILE, &limit);
+    }
+#endif  // IREE_WAIT_API_POSIX_LIKE
+    events_.reserve(count);
+    for (int64_t i = 0; i < count; ++i) {
+      iree_event_t event;
+      iree_status_t status =
+          iree_event_initialize(/*initial_state=*/i == count - 1, &event);
+      if (!iree_status_is_ok(status)) {
+        iree_status_ignore(status);
+        break;
+      }
+      events_.push_back(event);
+    }
+    ok_ = events_.size() == static_cast<size_t>(count);
+  }
+  ~EventList() {
+    for (auto& event : events_) iree_event_deinitialize(&event);
+  }
+
+  bool ok() const { return ok_; }
+  std::vector<iree_event_t>& events() { return events_; }
+  iree_event_t& signaled_event() { return events_.back(); }
+
+ private:
+  std::vector<iree_event_t> events_;
+  bool ok_ = false;
+};
+
+//==============================================================================
+// iree_wait_set_t
+//==============================================================================
+
+// Waits on a persistent set with one signaled handle.
+void BM_WaitSetWaitAny(benchmark::State& state) {
+  EventList event_list(state.range(0));
+  if (!event_list.ok()) {
+    state.SkipWithError("failed to create events (fd limit?)");
+    return;
+  }
+  iree_wait_set_t* wait_set = NULL;
+  IREE_CHECK_OK(iree_wait_set_allocate(event_list.events().size(),
+                                       iree_allocator_system(), &wait_set));
+  for (auto& event : event_list.events()) {
+    IREE_CHECK_OK(iree_wait_set_insert(wait_set, event));
+  }
+  for (auto _ : state) {
+    iree_wait_handle_t wake_handle;
+    IREE_CHECK_OK(
+        iree_wait_any(wait_set, IREE_TIME_INFINITE_FUTURE, &wake_handle));
+    benchmark::DoNotOptimize(wake_handle);
+  }
+  iree_wait_set_free(wait_set);
+}
+BENCHMARK(BM_WaitSetWaitAny)->RangeMultiplier(2)->Range(8, 1024);
+
+// Inserts a signaled handle, waits for it, and erases it from a set of
+// persistent unsignaled handles. This is the task poller pattern.
+void BM_WaitSetInsertWaitErase(benchmark::State& state) {
+  EventList event_list(state.range(0));
+  if (!event_list.ok()) {
+    state.SkipWithError("failed to create events (fd limit?)");
+    return;
+  }
+  iree_wait_set_t* wait_set = NULL;
+  IREE_CHECK_OK(iree_wait_set_allocate(event_list.events().size(),
+                                       iree_allocator_system(), &wait_set));
+  for (size_t i = 0; i < event_list.events().size() - 1; ++i) {
+    IREE_CHECK_OK(iree_wait_set_insert(wait_set, event_list.events()[i]));
+  }
+  for (auto _ : state) {
+    IREE_CHECK_OK(iree_wait_set_insert(wait_set, event_list.signaled_event()));
+    iree_wait_handle_t wake_handle;
+    IREE_CHECK_OK(
+        iree_wait_any(wait_set, IREE_TIME_INFINITE_FUTURE, &wake_handle));
+    iree_wait_set_erase(wait_set, wake_handle);
+  }
+  iree_wait_set_free(wait_set);
+}
+BENCHMARK(BM_WaitSetInsertWaitErase)->RangeMultiplier(2)->Range(8, 1024);
+
+//==============================================================================
+// ppoll baseline
+//==============================================================================
+
+#if defined(IREE_WAIT_API_POSIX_LIKE) && !defined(IREE_PLATFORM_APPLE)
+
+// Equivalent of BM_WaitSetWaitAny using ppoll as the IREE_WAIT_API_PPOLL
+// implementation does: the full pollfd list is passed to the kernel and
+// scanned for the signaled handle each wait.
+void BM_PpollWaitAny(benchmark::State& state) {
+  EventList event_list(state.range(0));
+  if (!event_list.ok()) {
+    state.SkipWithError("failed to create events (fd limit?)");
+    return;
+  }
+  std::vector<struct pollfd> poll_fds(event_list.events().size());
+  for (size_t i = 0; i < poll_fds.size(); ++i) {
+    poll_fds[i].fd = iree_wait_primitive_get_read_fd(&event_list.events()[i]);
+    poll_fds[i].events = POLLIN | POLLPRI;
+    poll_fds[i].revents = 0;
+  }
+  for (auto _ : state) {
+    int rv = ppoll(poll_fds.data(), poll_fds.size(), NULL, NULL);
+    if (rv <= 0) {
+      state.SkipWithError("ppoll failed");
+      break;
+    }
+    size_t signaled_index = 0;
+    for (size_t i = 0; i < poll_fds.size(); ++i) {
+      if (poll_fds[i].revents & POLLIN) {
+        signaled_index = i;
+        break;
+      }
+    }
+    benchmark::DoNotOptimize(signaled_index);
+  }
+}
+BENCHMARK(BM_PpollWaitAny)->RangeMultiplier(2)->Range(8, 1024);
+
+#endif  // IREE_WAIT_API_POSIX_LIKE && !IREE_PLATFORM_APPLE
+
+}  // namespace
@@ -9,57 +9,518 @@
 
 #if IREE_WAIT_API == IREE_WAIT_API_EPOLL
 
+#include <errno.h>
+#include <limits.h>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <time.h>
+#include <unistd.h>
+
 #include "iree/base/internal/wait_handle_posix.h"
 
+//===----------------------------------------------------------------------===//
+// Platform utilities
+//===----------------------------------------------------------------------===//
+
+// epoll_wait may spuriously wake with an EINTR. We don't do anything with that
+// opportunity (no fancy signal stuff), but we do need to retry the wait and
+// ensure that we do so with an updated timeout based on the deadline. The
+// millisecond timeout is rounded up so we should never wake before the deadline
+// but we double check as the caller expects a timeout to mean the deadline
+// elapsed.
+//
+// Documentation: https://man7.org/linux/man-pages/man2/epoll_wait.2.html
+static iree_status_t iree_syscall_epoll_wait(int epoll_fd,
+                                             struct epoll_event* events,
+                                             int max_events,
+                                             iree_time_t deadline_ns,
+                                             int* out_signaled_count) {
+  *out_signaled_count = 0;
+  int rv = -1;
+  for (;;) {
+    // Timeouts too large to represent (~24 days) wait forever.
+    uint32_t timeout_ms = iree_absolute_deadline_to_timeout_ms(deadline_ns);
+    rv = epoll_wait(epoll_fd, events, max_events,
+                    timeout_ms >= INT_MAX ? -1 : (int)timeout_ms);
+    if (rv < 0 && errno == EINTR) continue;
+    if (rv == 0 && deadline_ns != IREE_TIME_INFINITE_PAST &&
+        iree_time_now() < deadline_ns) {
+      continue;
+    }
+    break;
+  }
+  if (rv > 0) {
+    // One or more events set.
+    *out_signaled_count = rv;
+    return iree_ok_status();
+  } else if (IREE_UNLIKELY(rv < 0)) {
+    return iree_make_status(iree_status_code_from_errno(errno),
+                            "epoll_wait failure %d", errno);
+  }
+  // rv == 0
+  // Timeout; no events set.
+  return iree_status_from_code(IREE_STATUS_DEADLINE_EXCEEDED);
+}
+
+// Single handle waits use ppoll directly as it avoids the need for an epoll fd
+// and has nanosecond timeout granularity.
+//
+// Documentation: http://man7.org/linux/man-pages/man2/poll.2.html
+static iree_status_t iree_syscall_ppoll_one(struct pollfd* fd,
+                                            iree_time_t deadline_ns,
+                                            int* out_signaled_count) {
+  *out_signaled_count = 0;
+  int rv = -1;
+  do {
+    // Convert the deadline into a tmo_p struct for ppoll that controls whether
+    // the call is blocking or non-blocking. Note that we must do this every
+    // iteration of the loop as a previous ppoll may have taken some of the
+    // time.
+    struct timespec timeout_ts;
+    struct timespec* tmo_p = &timeout_ts;
+    if (deadline_ns == IREE_TIME_INFINITE_PAST) {
+      // Block never.
+      memset(&timeout_ts, 0, sizeof(timeout_ts));
+    } else if (deadline_ns == IREE_TIME_INFINITE_FUTURE) {
+      // Block forever (NULL timeout to ppoll).
+      tmo_p = NULL;
+    } else {
+      // Wait only for as much time as we have before the deadline is exceeded.
+      iree_duration_t timeout_ns = deadline_ns - iree_time_now();
+      if (timeout_ns < 0) {
+        memset(&timeout_ts, 0, sizeof(timeout_ts));
+      } else {
+        timeout_ts.tv_sec = (time_t)(timeout_ns / 1000000000ull);
+        timeout_ts.tv_nsec = (long)(timeout_ns % 1000000000ull);
+      }
+    }
+    rv = ppoll(fd, 1, tmo_p, NULL);
+  } while (rv < 0 && errno == EINTR);
+  if (rv > 0) {
+    *out_signaled_count = rv;
+    return iree_ok_status();
+  } else if (rv < 0) {
+    return iree_make_status(iree_status_code_from_errno(errno),
+                            "ppoll failure %d", errno);
+  }
+  return iree_status_from_code(IREE_STATUS_DEADLINE_EXCEEDED);
+}
+
 //===----------------------------------------------------------------------===//
 // iree_wait_set_t
 //===----------------------------------------------------------------------===//
 
-// TODO(benvanik): iree_wait_set_s using an epoll fd.
-// epoll lets us route the wait set operations right to kernel and not need our
-// own duplicate data structure. epoll is great, just not available on mac/ios
-// so we still need poll for that. linux/android/bsd all have epoll, though.
+// A registered handle. Slots are stable for the lifetime of the registration
+// and their index is stored in the epoll event data so that wakes map directly
+// back to the user handle without any scanning.
+typedef struct iree_wait_set_slot_t {
+  // User-provided handle. set_internal.dupe_count tracks the number of
+  // additional times the handle has been inserted.
+  iree_wait_handle_t handle;
+  // fd registered with epoll or -1 if the slot is unused.
+  int fd;
+  // Value of iree_wait_set_t::signal_epoch when the slot was last observed
+  // signaled by iree_wait_all.
+  uint32_t signal_epoch;
+} iree_wait_set_slot_t;
+
+// epoll lets us route the wait set operations right to the kernel: handles are
+// registered once on insert and each wait only returns the ready handles
+// instead of rebuilding and scanning the full list as poll/ppoll need to.
+//
+// We still need to track the user handles to preserve their types, detect
+// duplicates, and erase by value. An open-addressed table keyed by fd maps
+// handles to their slots so that insert and erase are O(1).
 struct iree_wait_set_t {
-  // NOTE: we could in theory use the epoll handle directly (iree_wait_set_s
-  // then is just a pointer). Then allocate/free just go straight to the system.
-  int reserved;
+  iree_allocator_t allocator;
+
+  // epoll instance all unique handles are registered with.
+  int epoll_fd;
+
+  // Total capacity of unique handles.
+  iree_host_size_t handle_capacity;
+
+  // Total number of unique handles registered.
+  iree_host_size_t handle_count;
+
+  // Registered handles indexed by the epoll event data.
+  iree_wait_set_slot_t* slots;
+
+  // Stack of unused slot indices with free_slot_count valid entries.
+  uint16_t* free_slots;
+  iree_host_size_t free_slot_count;
+
+  // fd hash table of slot index + 1 (0 indicates an empty bucket) using linear
+  // probing. Sized to a power of two at least twice the capacity.
+  uint32_t* buckets;
+  uint32_t bucket_mask;
+
+  // Incremented each iree_wait_all pass to track which slots have signaled.
+  uint32_t signal_epoch;
+
+  // Storage for events returned from epoll_wait with handle_capacity entries.
+  struct epoll_event* events;
 };
 
+static uint32_t iree_wait_set_hash_fd(const iree_wait_set_t* set, int fd) {
+  return ((uint32_t)fd * 0x9E3779B1u) & set->bucket_mask;
+}
+
+// Returns the index of the bucket holding |fd| or -1 if not present.
+static int64_t iree_wait_set_find_bucket(const iree_wait_set_t* set, int fd) {
+  for (uint32_t i = iree_wait_set_hash_fd(set, fd);;
+       i = (i + 1) & set->bucket_mask) {
+    uint32_t entry = set->buckets[i];
+    if (!entry) return -1;
+    if (set->slots[entry - 1].fd == fd) return i;
+  }
+}
+
+static void iree_wait_set_insert_bucket(iree_wait_set_t* set, int fd,
+                                        uint32_t slot_index) {
+  uint32_t i = iree_wait_set_hash_fd(set, fd);
+  while (set->buckets[i]) i = (i + 1) & set->bucket_mask;
+  set->buckets[i] = slot_index + 1;
+}
+
+// Removes the entry in |bucket_index| and shifts back any entries in the same
+// probe sequence so that lookups never hit a premature empty bucket.
+static void iree_wait_set_remove_bucket(iree_wait_set_t* set,
+                                        uint32_t bucket_index) {
+  uint32_t i = bucket_index;
+  for (uint32_t j = (i + 1) & set->bucket_mask; set->buckets[j];
+       j = (j + 1) & set->bucket_mask) {
+    uint32_t home =
+        iree_wait_set_hash_fd(set, set->slots[set->buckets[j] - 1].fd);
+    if (((j - home) & set->bucket_mask) >= ((j - i) & set->bucket_mask)) {
+      set->buckets[i] = set->buckets[j];
+      i = j;
+    }
+  }
+  set->buckets[i] = 0;
+}
+
+// Resets all bookkeeping without touching the epoll registrations.
+static void iree_wait_set_reset_slots(iree_wait_set_t* set) {
+  set->handle_count = 0;
+  for (iree_host_size_t i = 0; i < set->handle_capacity; ++i) {
+    set->slots[i].fd = -1;
+    // Pop in increasing order to keep the active slots dense.
+    set->free_slots[i] = (uint16_t)(set->handle_capacity - i - 1);
+  }
+  set->free_slot_count = set->handle_capacity;
+  memset(set->buckets, 0,
+         ((iree_host_size_t)set->bucket_mask + 1) * sizeof(*set->buckets));
+}
+
 iree_status_t iree_wait_set_allocate(iree_host_size_t capacity,
                                      iree_allocator_t allocator,
                                      iree_wait_set_t** out_set) {
-  // TODO(benvanik): epoll_create()
+  IREE_ASSERT_ARGUMENT(out_set);
+  *out_set = NULL;
+
+  // Slot indices are stored in the 16-bit set_internal.index of wake handles.
+  if (capacity >= UINT16_MAX) {
+    return iree_make_status(
+        IREE_STATUS_INVALID_ARGUMENT,
+        "wait set capacity of %" PRIhsz " is unreasonably large", capacity);
+  }
+
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_host_size_t bucket_count = 8;
+  while (bucket_count < capacity * 2) bucket_count <<= 1;
+
+  iree_host_size_t slot_list_size =
+      capacity * iree_sizeof_struct(iree_wait_set_slot_t);
+  iree_host_size_t event_list_size =
+      iree_host_align(capacity * sizeof(struct epoll_event), iree_max_align_t);
+  iree_host_size_t bucket_list_size =
+      iree_host_align(bucket_count * sizeof(uint32_t), iree_max_align_t);
+  iree_host_size_t free_slot_list_size = capacity * sizeof(uint16_t);
+  iree_host_size_t total_size = iree_sizeof_struct(iree_wait_set_t) +
+                                slot_list_size + event_list_size +
+                                bucket_list_size + free_slot_list_size;
+
+  iree_wait_set_t* set = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(allocator, total_size, (void**)&set));
+  set->allocator = allocator;
+  set->handle_capacity = capacity;
+  set->bucket_mask = (uint32_t)(bucket_count - 1);
+  set->signal_epoch = 0;
+
+  uint8_t* ptr = (uint8_t*)set + iree_sizeof_struct(iree_wait_set_t);
+  set->slots = (iree_wait_set_slot_t*)ptr;
+  ptr += slot_list_size;
+  set->events = (struct epoll_event*)ptr;
+  ptr += event_list_size;
+  set->buckets = (uint32_t*)ptr;
+  ptr += bucket_list_size;
+  set->free_slots = (uint16_t*)ptr;
+  iree_wait_set_reset_slots(set);
+
+  // https://man7.org/linux/man-pages/man2/epoll_create.2.html
+  set->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+  if (IREE_UNLIKELY(set->epoll_fd < 0)) {
+    iree_status_t status =
+        iree_make_status(iree_status_code_from_errno(errno),
+                         "failed to create epoll instance (%d)", errno);
+    iree_allocator_free(allocator, set);
+    IREE_TRACE_ZONE_END(z0);
+    return status;
+  }
+
+  *out_set = set;
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
 }
 
 void iree_wait_set_free(iree_wait_set_t* set) {
-  // TODO(benvanik): close()
+  if (!set) return;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  close(set->epoll_fd);
+  iree_allocator_free(set->allocator, set);
+  IREE_TRACE_ZONE_END(z0);
+}
+
+bool iree_wait_set_is_empty(const iree_wait_set_t* set) {
+  return set->handle_count == 0;
 }
 
 iree_status_t iree_wait_set_insert(iree_wait_set_t* set,
                                    iree_wait_handle_t handle) {
-  // TODO(benvanik): epoll_ctl(EPOLL_CTL_ADD)
+  // Handles without an fd (immediate) never need to be waited on.
+  int fd = iree_wait_primitive_get_read_fd(&handle);
+  if (fd < 0) return iree_ok_status();
+
+  // If the handle is already registered we only need to track the duplicate.
+  int64_t bucket_index = iree_wait_set_find_bucket(set, fd);
+  if (bucket_index >= 0) {
+    iree_wait_set_slot_t* slot = &set->slots[set->buckets[bucket_index] - 1];
+    if (IREE_UNLIKELY(slot->handle.set_internal.dupe_count == UINT16_MAX)) {
+      return iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED,
+                              "wait handle inserted too many times");
+    }
+    // epoll keys registrations on the open file and drops them when it is
+    // closed. If the registered handle was closed without being erased and its
+    // fd number reused by this handle then the new file is not registered and
+    // counting it as a duplicate would wait on it forever. Rewriting the
+    // registration fails in that case so we can catch the misuse.
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN | EPOLLPRI;
+    event.data.u32 = set->buckets[bucket_index] - 1;
+    if (IREE_UNLIKELY(epoll_ctl(set->epoll_fd, EPOLL_CTL_MOD, fd, &event) <
+                      0)) {
+      IREE_ASSERT(errno != ENOENT && errno != EBADF,
+                  "wait handles must be erased before being closed");
+      return iree_make_status(
+          IREE_STATUS_FAILED_PRECONDITION,
+          "fd %d was closed while registered with the wait set (%d); wait "
+          "handles must be erased before being closed",
+          fd, errno);
+    }
+    ++slot->handle.set_internal.dupe_count;
+    return iree_ok_status();
+  }
+
+  if (set->handle_count + 1 > set->handle_capacity) {
+    return iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED,
+                            "wait set capacity reached");
+  }
+
+  uint16_t slot_index = set->free_slots[set->free_slot_count - 1];
+
+  // Level-triggered so that handles remain ready until they are reset, matching
+  // the poll/ppoll behavior.
+  // https://man7.org/linux/man-pages/man2/epoll_ctl.2.html
+  struct epoll_event event;
+  memset(&event, 0, sizeof(event));
+  event.events = EPOLLIN | EPOLLPRI;  // implicit EPOLLERR | EPOLLHUP
+  event.data.u32 = slot_index;
+  if (IREE_UNLIKELY(epoll_ctl(set->epoll_fd, EPOLL_CTL_ADD, fd, &event) < 0)) {
+    return iree_make_status(iree_status_code_from_errno(errno),
+                            "failed to register fd %d with epoll (%d)", fd,
+                            errno);
+  }
+
+  --set->free_slot_count;
+  ++set->handle_count;
+  iree_wait_set_slot_t* slot = &set->slots[slot_index];
+  iree_wait_handle_wrap_primitive(handle.type, handle.value, &slot->handle);
+  slot->handle.set_internal.dupe_count = 0;
+  slot->fd = fd;
+  slot->signal_epoch = 0;
+  iree_wait_set_insert_bucket(set, fd, slot_index);
+
+  return iree_ok_status();
 }
 
 void iree_wait_set_erase(iree_wait_set_t* set, iree_wait_handle_t handle) {
-  // TODO(benvanik): epoll_ctl(EPOLL_CTL_DEL)
+  int fd = iree_wait_primitive_get_read_fd(&handle);
+  if (fd < 0) return;
+
+  int64_t bucket_index = iree_wait_set_find_bucket(set, fd);
+  if (IREE_UNLIKELY(bucket_index < 0)) return;
+  uint32_t slot_index = set->buckets[bucket_index] - 1;
+  iree_wait_set_slot_t* slot = &set->slots[slot_index];
+
+  // Duplicates only need their count decremented.
+  if (slot->handle.set_internal.dupe_count > 0) {
+    --slot->handle.set_internal.dupe_count;
+    return;
+  }
+
+  // NOTE: this may fail if the fd was closed before being erased (which
+  // implicitly unregisters it); we only care that it's no longer registered.
+  // That is fine so long as no new handle reused the fd number in between,
+  // which iree_wait_set_insert rejects.
+  epoll_ctl(set->epoll_fd, EPOLL_CTL_DEL, fd, NULL);
+
+  iree_wait_set_remove_bucket(set, (uint32_t)bucket_index);
+  slot->fd = -1;
+  set->free_slots[set->free_slot_count++] = (uint16_t)slot_index;
+  --set->handle_count;
 }
 
 void iree_wait_set_clear(iree_wait_set_t* set) {
-  // TODO(benvanik): close and reopen?
+  if (set->handle_count == 0) return;
+  for (iree_host_size_t i = 0; i < set->handle_capacity; ++i) {
+    if (set->slots[i].fd >= 0) {
+      epoll_ctl(set->epoll_fd, EPOLL_CTL_DEL, set->slots[i].fd, NULL);
+    }
+  }
+  iree_wait_set_reset_slots(set);
+}
+
+// Maps an epoll event bitfield result to a status (on failure) and an
+// indicator of whether the event was signaled.
+static iree_status_t iree_wait_set_resolve_epoll_events(uint32_t events,
+                                                        bool* out_signaled) {
+  if (events & EPOLLERR) {
+    return iree_make_status(IREE_STATUS_INTERNAL, "EPOLLERR on fd");
+  } else if (events & EPOLLHUP) {
+    return iree_make_status(IREE_STATUS_CANCELLED, "EPOLLHUP on fd");
+  }
+  *out_signaled = (events & (EPOLLIN | EPOLLPRI)) != 0;
+  return iree_ok_status();
 }
 
 iree_status_t iree_wait_all(iree_wait_set_t* set, iree_time_t deadline_ns) {
-  // TODO(benvanik): epoll_wait
+  // Make the syscall only when we have at least one valid fd.
+  // Don't use this as a sleep.
+  if (set->handle_count <= 0) {
+    return iree_ok_status();
+  }
+
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Since handles are level-triggered and remain signaled until reset we can
+  // check all of them with a single epoll_wait. If any are unsignaled we block
+  // on one of them and then check again; each pass makes progress by at least
+  // one handle and in the common case where all handles are already signaled
+  // we only need the one syscall.
+  iree_status_t status = iree_ok_status();
+  for (;;) {
+    int signaled_count = 0;
+    status = iree_syscall_epoll_wait(set->epoll_fd, set->events,
+                                     (int)set->handle_count, deadline_ns,
+                                     &signaled_count);
+    if (!iree_status_is_ok(status)) break;
+
+    // Mark all signaled slots with the current epoch.
+    uint32_t signal_epoch = ++set->signal_epoch;
+    iree_host_size_t ready_count = 0;
+    for (int i = 0; i < signaled_count; ++i) {
+      bool signaled = false;
+      status = iree_wait_set_resolve_epoll_events(set->events[i].events,
+                                                  &signaled);
+      if (!iree_status_is_ok(status)) break;
+      if (signaled) {
+        set->slots[set->events[i].data.u32].signal_epoch = signal_epoch;
+        ++ready_count;
+      }
+    }
+    if (!iree_status_is_ok(status) || ready_count == set->handle_count) break;
+
+    // Block on the first unsignaled handle.
+    iree_wait_set_slot_t* unsignaled_slot = NULL;
+    for (iree_host_size_t i = 0; i < set->handle_capacity; ++i) {
+      if (set->slots[i].fd >= 0 && set->slots[i].signal_epoch != signal_epoch) {
+        unsignaled_slot = &set->slots[i];
+        break;
+      }
+    }
+    status = iree_wait_one(&unsignaled_slot->handle, deadline_ns);
+    if (!iree_status_is_ok(status)) break;
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
 }
 
 iree_status_t iree_wait_any(iree_wait_set_t* set, iree_time_t deadline_ns,
                             iree_wait_handle_t* out_wake_handle) {
-  // TODO(benvanik): epoll_wait
+  // Make the syscall only when we have at least one valid fd.
+  // Don't use this as a sleep.
+  if (set->handle_count <= 0) {
+    if (out_wake_handle) {
+      memset(out_wake_handle, 0, sizeof(*out_wake_handle));
+    }
+    return iree_ok_status();
+  }
+
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // We only need a single ready handle and the kernel hands us one from its
+  // ready list without touching any of the others. Level-triggered handles are
+  // requeued at the tail of the ready list so repeated waits rotate fairly
+  // through all signaled handles.
+  struct epoll_event event;
+  int signaled_count = 0;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_syscall_epoll_wait(set->epoll_fd, &event, 1, deadline_ns,
+                                  &signaled_count));
+
+  bool signaled = false;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_wait_set_resolve_epoll_events(event.events, &signaled));
+  if (out_wake_handle) {
+    memset(out_wake_handle, 0, sizeof(*out_wake_handle));
+    if (signaled) {
+      uint32_t slot_index = event.data.u32;
+      memcpy(out_wake_handle, &set->slots[slot_index].handle,
+             sizeof(*out_wake_handle));
+      out_wake_handle->set_internal.index = slot_index;
+    }
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
 }
 
 iree_status_t iree_wait_one(iree_wait_handle_t* handle,
                             iree_time_t deadline_ns) {
-  // TODO(benvanik): just use poll?
+  struct pollfd poll_fds;
+  poll_fds.fd = iree_wait_primitive_get_read_fd(handle);
+  if (poll_fds.fd == -1) {
+    return iree_ok_status();  // no-op wait
+  }
+  poll_fds.events = POLLIN;
+  poll_fds.revents = 0;
+
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Just check for our single handle/event. This doesn't need an epoll
+  // instance and avoids the registration syscalls.
+  int signaled_count = 0;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_syscall_ppoll_one(&poll_fds, deadline_ns, &signaled_count));
+
+  IREE_TRACE_ZONE_END(z0);
+  return signaled_count ? iree_ok_status()
+                        : iree_status_from_code(IREE_STATUS_DEADLINE_EXCEEDED);
 }
 
 #endif  // IREE_WAIT_API == IREE_WAIT_API_EPOLL
@@ -339,6 +339,83 @@ TEST(WaitSet, Clear) {
   iree_event_deinitialize(&ev_dupe);
 }
 
+// Tests that handles closed before being erased can still be erased.
+TEST(WaitSet, EraseAfterClose) {
+  iree_event_t ev_unset, ev_closed;
+  IREE_ASSERT_OK(iree_event_initialize(/*initial_state=*/false, &ev_unset));
+  IREE_ASSERT_OK(iree_event_initialize(/*initial_state=*/true, &ev_closed));
+  iree_wait_set_t* wait_set = NULL;
+  IREE_ASSERT_OK(
+      iree_wait_set_allocate(128, iree_allocator_system(), &wait_set));
+
+  IREE_ASSERT_OK(iree_wait_set_insert(wait_set, ev_unset));
+  IREE_ASSERT_OK(iree_wait_set_insert(wait_set, ev_closed));
+
+  // Closing may reset the handle so keep the value around to erase with.
+  iree_wait_handle_t closed_handle = ev_closed;
+  iree_event_deinitialize(&ev_closed);
+  iree_wait_set_erase(wait_set, closed_handle);
+
+  // Only ev_unset remains in the set.
+  EXPECT_FALSE(iree_wait_set_is_empty(wait_set));
+  iree_wait_handle_t wake_handle;
+  IREE_EXPECT_STATUS_IS(
+      IREE_STATUS_DEADLINE_EXCEEDED,
+      iree_wait_any(wait_set, IREE_TIME_INFINITE_PAST, &wake_handle));
+  iree_wait_set_erase(wait_set, ev_unset);
+  EXPECT_TRUE(iree_wait_set_is_empty(wait_set));
+
+  iree_wait_set_free(wait_set);
+  iree_event_deinitialize(&ev_unset);
+}
+
+// Tests that a new handle reusing the fd of a handle that was closed and then
+// erased is waited on like any other.
+TEST(WaitSet, EraseAfterCloseReuse) {
+  iree_event_t ev_unset, ev_closed;
+  IREE_ASSERT_OK(iree_event_initialize(/*initial_state=*/false, &ev_unset));
+  IREE_ASSERT_OK(iree_event_initialize(/*initial_state=*/false, &ev_closed));
+  iree_wait_set_t* wait_set = NULL;
+  IREE_ASSERT_OK(
+      iree_wait_set_allocate(128, iree_allocator_system(), &wait_set));
+
+  IREE_ASSERT_OK(iree_wait_set_insert(wait_set, ev_unset));
+  IREE_ASSERT_OK(iree_wait_set_insert(wait_set, ev_closed));
+  iree_wait_handle_t closed_handle = ev_closed;
+  iree_event_deinitialize(&ev_closed);
+  iree_wait_set_erase(wait_set, closed_handle);
+
+  // The platform will usually hand back the lowest free fd and so the new
+  // event likely reuses the one just closed.
+  iree_event_t ev_reused;
+  IREE_ASSERT_OK(iree_event_initialize(/*initial_state=*/false, &ev_reused));
+  IREE_ASSERT_OK(iree_wait_set_insert(wait_set, ev_reused));
+  IREE_EXPECT_STATUS_IS(
+      IREE_STATUS_DEADLINE_EXCEEDED,
+      iree_wait_all(wait_set, IREE_TIME_INFINITE_PAST));
+
+  // Signaling the new event from another thread must wake the wait.
+  std::thread thread([&]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    iree_event_set(&ev_reused);
+  });
+  iree_wait_handle_t wake_handle;
+  IREE_ASSERT_OK(iree_wait_any(
+      wait_set, iree_time_now() + kLongTimeoutNS, &wake_handle));
+  EXPECT_EQ(0, memcmp(&ev_reused.value, &wake_handle.value,
+                      sizeof(ev_reused.value)));
+  thread.join();
+
+  iree_wait_set_erase(wait_set, wake_handle);
+  IREE_EXPECT_STATUS_IS(
+      IREE_STATUS_DEADLINE_EXCEEDED,
+      iree_wait_any(wait_set, IREE_TIME_INFINITE_PAST, &wake_handle));
+
+  iree_wait_set_free(wait_set);
+  iree_event_deinitialize(&ev_unset);
+  iree_event_deinitialize(&ev_reused);
+}
+
 // Tests iree_wait_all when polling (deadline_ns = IREE_TIME_INFINITE_PAST).
 TEST(WaitSet, WaitAllPolling) {
   iree_event_t ev_unset_0, ev_unset_1;
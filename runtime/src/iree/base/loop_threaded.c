@@ -0,0 +1,1201 @@
+// Copyright 2025 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/base/loop_threaded.h"
+
+#include "iree/base/internal/synchronization.h"
+#include "iree/base/internal/threading.h"
+#include "iree/base/internal/wait_handle.h"
+
+// NOTE: all callbacks should be at offset 0. This allows for easily converting
+// resolved wait operations into calls and aborting any operation uniformly.
+static_assert(offsetof(iree_loop_call_params_t, callback) == 0,
+              "callback must be at offset 0");
+static_assert(offsetof(iree_loop_dispatch_params_t, callback) == 0,
+              "callback must be at offset 0");
+static_assert(offsetof(iree_loop_wait_until_params_t, callback) == 0,
+              "callback must be at offset 0");
+static_assert(offsetof(iree_loop_wait_one_params_t, callback) == 0,
+              "callback must be at offset 0");
+static_assert(offsetof(iree_loop_wait_multi_params_t, callback) == 0,
+              "callback must be at offset 0");
+
+//===----------------------------------------------------------------------===//
+// iree_loop_threaded_op_t
+//===----------------------------------------------------------------------===//
+
+// A pending operation in either the run list or the wait list.
+// Operations are allocated on demand and recycled through a free list owned by
+// the loop so that steady-state enqueuing does not hit the allocator.
+typedef struct iree_loop_threaded_op_t {
+  // Next operation in whichever list the operation is currently in.
+  struct iree_loop_threaded_op_t* next;
+  union {
+    iree_loop_callback_t callback;  // asserted at offset 0 above
+    union {
+      iree_loop_call_params_t call;
+      iree_loop_dispatch_params_t dispatch;
+      iree_loop_wait_until_params_t wait_until;
+      iree_loop_wait_one_params_t wait_one;
+      iree_loop_wait_multi_params_t wait_multi;
+    } params;
+  };
+  iree_loop_command_t command;
+  iree_loop_threaded_scope_t* scope;
+
+  // Previous operation in the loop wait list while registered.
+  struct iree_loop_threaded_op_t* prev;
+  // Next operation in a poller-local list: either those woken by a single wait
+  // handle or those pending unregistration after being aborted.
+  struct iree_loop_threaded_op_t* poller_next;
+
+  // Number of wait handles the operation has registered with the poller.
+  iree_host_size_t wait_handle_count;
+  // True while the wait handles of the operation are in the poller wait set.
+  bool registered;
+  // True while the operation is in a poller-local woken list.
+  bool woken;
+
+  // Set on calls when we are issuing a callback for a resolved wait.
+  // Unlike other pointers in the params this is owned by the operation.
+  iree_status_t status;
+} iree_loop_threaded_op_t;
+
+// FIFO list of operations.
+typedef struct iree_loop_threaded_op_list_t {
+  iree_loop_threaded_op_t* head;
+  iree_loop_threaded_op_t* tail;
+} iree_loop_threaded_op_list_t;
+
+static void iree_loop_threaded_op_list_push_back(
+    iree_loop_threaded_op_list_t* list, iree_loop_threaded_op_t* op) {
+  op->next = NULL;
+  if (list->tail) {
+    list->tail->next = op;
+  } else {
+    list->head = op;
+  }
+  list->tail = op;
+}
+
+static iree_loop_threaded_op_t* iree_loop_threaded_op_list_pop_front(
+    iree_loop_threaded_op_list_t* list) {
+  iree_loop_threaded_op_t* op = list->head;
+  if (!op) return NULL;
+  list->head = op->next;
+  if (!list->head) list->tail = NULL;
+  op->next = NULL;
+  return op;
+}
+
+// Moves all operations in |list| matching |scope| into |out_list|.
+// A NULL |scope| matches all operations.
+static iree_host_size_t iree_loop_threaded_op_list_take_scope(
+    iree_loop_threaded_op_list_t* list, iree_loop_threaded_scope_t* scope,
+    iree_loop_threaded_op_list_t* out_list) {
+  iree_host_size_t count = 0;
+  iree_loop_threaded_op_list_t remaining = {NULL, NULL};
+  iree_loop_threaded_op_t* op = NULL;
+  while ((op = iree_loop_threaded_op_list_pop_front(list)) != NULL) {
+    if (!scope || op->scope == scope) {
+      iree_loop_threaded_op_list_push_back(out_list, op);
+      ++count;
+    } else {
+      iree_loop_threaded_op_list_push_back(&remaining, op);
+    }
+  }
+  *list = remaining;
+  return count;
+}
+
+//===----------------------------------------------------------------------===//
+// Wait source utilities
+//===----------------------------------------------------------------------===//
+
+// Prepares |wait_source| for polling by exporting it as a wait handle.
+// Immediate wait sources are left as-is and count as already resolved.
+// Increments |inout_wait_handle_count| if the wait source needs polling.
+static iree_status_t iree_loop_threaded_register_wait_source(
+    iree_wait_source_t* wait_source,
+    iree_host_size_t* inout_wait_handle_count) {
+  if (iree_wait_source_is_immediate(*wait_source)) {
+    // Task has been neutered and is treated as an immediately resolved wait.
+    return iree_ok_status();
+  } else if (iree_wait_source_is_delay(*wait_source)) {
+    return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                            "delays must come from wait-until ops");
+  }
+
+  if (!iree_wait_handle_from_source(wait_source)) {
+    // Not a wait handle; export one and swap it in so that the poller can
+    // insert it into its wait set.
+    iree_wait_primitive_t wait_primitive = iree_wait_primitive_immediate();
+    IREE_RETURN_IF_ERROR(iree_wait_source_export(
+        *wait_source, IREE_WAIT_PRIMITIVE_TYPE_ANY, iree_immediate_timeout(),
+        &wait_primitive));
+    IREE_RETURN_IF_ERROR(iree_wait_source_import(wait_primitive, wait_source));
+  }
+
+  ++*inout_wait_handle_count;
+  return iree_ok_status();
+}
+
+// Registers all wait sources used by the wait operation |op|.
+static iree_status_t iree_loop_threaded_op_register_wait_sources(
+    iree_loop_threaded_op_t* op) {
+  switch (op->command) {
+    case IREE_LOOP_COMMAND_WAIT_ONE:
+      return iree_loop_threaded_register_wait_source(
+          &op->params.wait_one.wait_source, &op->wait_handle_count);
+    case IREE_LOOP_COMMAND_WAIT_ANY:
+    case IREE_LOOP_COMMAND_WAIT_ALL:
+      for (iree_host_size_t i = 0; i < op->params.wait_multi.count; ++i) {
+        IREE_RETURN_IF_ERROR(iree_loop_threaded_register_wait_source(
+            &op->params.wait_multi.wait_sources[i], &op->wait_handle_count));
+      }
+      return iree_ok_status();
+    default:
+    case IREE_LOOP_COMMAND_WAIT_UNTIL:
+      return iree_ok_status();
+  }
+}
+
+// Returns the wait sources used by the wait operation |op|, if any.
+static iree_wait_source_t* iree_loop_threaded_op_wait_sources(
+    iree_loop_threaded_op_t* op, iree_host_size_t* out_count) {
+  switch (op->command) {
+    case IREE_LOOP_COMMAND_WAIT_ONE:
+      *out_count = 1;
+      return &op->params.wait_one.wait_source;
+    case IREE_LOOP_COMMAND_WAIT_ANY:
+    case IREE_LOOP_COMMAND_WAIT_ALL:
+      *out_count = op->params.wait_multi.count;
+      return op->params.wait_multi.wait_sources;
+    default:
+    case IREE_LOOP_COMMAND_WAIT_UNTIL:
+      *out_count = 0;
+      return NULL;
+  }
+}
+
+// Returns the deadline of the wait operation |op|.
+static iree_time_t iree_loop_threaded_op_deadline(iree_loop_threaded_op_t* op) {
+  switch (op->command) {
+    case IREE_LOOP_COMMAND_WAIT_UNTIL:
+      return op->params.wait_until.deadline_ns;
+    case IREE_LOOP_COMMAND_WAIT_ONE:
+      return op->params.wait_one.deadline_ns;
+    case IREE_LOOP_COMMAND_WAIT_ANY:
+    case IREE_LOOP_COMMAND_WAIT_ALL:
+      return op->params.wait_multi.deadline_ns;
+    default:
+      return IREE_TIME_INFINITE_FUTURE;
+  }
+}
+
+// Returns true if |lhs| and |rhs| reference the same wait primitive.
+static bool iree_loop_threaded_wait_handle_equal(
+    const iree_wait_handle_t* lhs, const iree_wait_handle_t* rhs) {
+  return lhs->type == rhs->type &&
+         memcmp(&lhs->value, &rhs->value, sizeof(lhs->value)) == 0;
+}
+
+//===----------------------------------------------------------------------===//
+// iree_loop_threaded_t
+//===----------------------------------------------------------------------===//
+
+// A registration of an operation waiting on a wait handle.
+typedef struct iree_loop_threaded_waiter_t {
+  iree_wait_handle_t handle;
+  // Operation waiting on |handle| or NULL if the bucket is empty.
+  iree_loop_threaded_op_t* op;
+} iree_loop_threaded_waiter_t;
+
+typedef struct iree_loop_threaded_t {
+  iree_allocator_t allocator;
+
+  // Guards all loop state below unless otherwise noted.
+  iree_slim_mutex_t mutex;
+
+  // Set when the loop is being freed. New operations are rejected and the
+  // worker and poller threads exit once they have no more work.
+  bool shutting_down;
+
+  // Total number of pending operations across all scopes, including those
+  // that are currently executing.
+  int32_t pending_count;
+
+  // Operations ready to run on any worker in FIFO order.
+  iree_loop_threaded_op_list_t run_list;
+
+  // Wait operations enqueued but not yet registered by the poller.
+  iree_loop_threaded_op_list_t insert_list;
+  // Unordered doubly-linked list of wait operations registered by the poller.
+  iree_loop_threaded_op_list_t wait_list;
+  // Total wait handles used by operations in |insert_list| and |wait_list|.
+  iree_host_size_t wait_handle_count;
+  // Maximum value of |wait_handle_count|.
+  iree_host_size_t max_wait_count;
+  // Earliest deadline of any operation in |wait_list|. Removing operations does
+  // not update this and the poller recomputes it when it is reached.
+  iree_time_t next_deadline_ns;
+
+  // Aborted operations linked by |poller_next| whose wait handles must be
+  // removed from |wait_set| by the poller before their callbacks are issued.
+  iree_loop_threaded_op_t* unregister_list;
+  // Set once the poller has exited and will no longer touch |wait_set|.
+  bool poller_exited;
+
+  // Recycled operations available for reuse.
+  iree_loop_threaded_op_t* free_list;
+
+  // Posted when operations are added to |run_list| or shutdown begins.
+  iree_notification_t work_notification;
+  // Posted when a scope or the whole loop becomes idle.
+  iree_notification_t idle_notification;
+  // Posted when the poller has processed |unregister_list|.
+  iree_notification_t unregister_notification;
+
+  // Event set to interrupt the poller when there are new or aborted waits.
+  iree_event_t poller_event;
+  // Wait set containing |poller_event| and all registered wait handles.
+  // Only accessed by the poller thread until it has exited.
+  iree_wait_set_t* wait_set;
+  // Open-addressed table mapping registered wait handles to the operations
+  // waiting on them so that a wake only polls the operations it affects. Has
+  // |waiter_mask| + 1 buckets, at least twice the maximum wait count, and is
+  // only accessed with the same restrictions as |wait_set|.
+  iree_loop_threaded_waiter_t* waiters;
+  uint32_t waiter_mask;
+
+  iree_thread_t* poller_thread;
+  iree_host_size_t worker_count;
+  iree_thread_t* worker_threads[];
+} iree_loop_threaded_t;
+
+static void iree_loop_threaded_abort_scope(iree_loop_threaded_t* loop_threaded,
+                                           iree_loop_threaded_scope_t* scope);
+
+// Acquires an operation from the free list or allocates a new one.
+static iree_status_t iree_loop_threaded_acquire_op(
+    iree_loop_threaded_t* loop_threaded, iree_loop_threaded_op_t** out_op) {
+  iree_slim_mutex_lock(&loop_threaded->mutex);
+  iree_loop_threaded_op_t* op = loop_threaded->free_list;
+  if (op) loop_threaded->free_list = op->next;
+  iree_slim_mutex_unlock(&loop_threaded->mutex);
+  if (!op) {
+    IREE_RETURN_IF_ERROR(iree_allocator_malloc(loop_threaded->allocator,
+                                               sizeof(*op), (void**)&op));
+  }
+  memset(op, 0, sizeof(*op));
+  *out_op = op;
+  return iree_ok_status();
+}
+
+// Returns |op| to the free list without affecting pending counts.
+static void iree_loop_threaded_recycle_op_locked(
+    iree_loop_threaded_t* loop_threaded, iree_loop_threaded_op_t* op) {
+  op->next = loop_threaded->free_list;
+  loop_threaded->free_list = op;
+}
+
+// Retires a completed or aborted |op| and notifies any waiters if its scope or
+// the whole loop has become idle.
+static void iree_loop_threaded_retire_op_locked(
+    iree_loop_threaded_t* loop_threaded, iree_loop_threaded_op_t* op) {
+  iree_loop_threaded_scope_t* scope = op->scope;
+  iree_loop_threaded_recycle_op_locked(loop_threaded, op);
+  --loop_threaded->pending_count;
+  if (--scope->pending_count == 0 || loop_threaded->pending_count == 0) {
+    iree_notification_post(&loop_threaded->idle_notification,
+                           IREE_ALL_WAITERS);
+  }
+}
+
+// Emits |status| to |scope| and aborts its pending operations.
+static void iree_loop_threaded_emit_error(iree_loop_threaded_scope_t* scope,
+                                          iree_status_t status) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_TEXT(
+      z0, iree_status_code_string(iree_status_code(status)));
+
+  // Mark the scope as failed before reporting so that operations enqueued
+  // concurrently with the abort below are aborted as well.
+  iree_loop_threaded_t* loop_threaded = scope->loop_threaded;
+  iree_slim_mutex_lock(&loop_threaded->mutex);
+  scope->failed = true;
+  iree_slim_mutex_unlock(&loop_threaded->mutex);
+
+  if (scope->error_fn) {
+    scope->error_fn(scope->error_user_data, status);
+  } else {
+    iree_status_ignore(status);
+  }
+
+  iree_loop_threaded_abort_scope(loop_threaded, scope);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+static iree_status_t iree_loop_threaded_run_dispatch(
+    iree_loop_t loop, const iree_loop_dispatch_params_t* params) {
+  // Workgroups of a single dispatch run serially on the worker that dequeued
+  // it; independent operations still run concurrently on other workers. If
+  // any workgroup fails we exit early and pass the failing status back to the
+  // completion handler exactly once.
+  iree_status_t workgroup_status = iree_ok_status();
+  for (uint32_t z = 0; z < params->workgroup_count_xyz[2]; ++z) {
+    for (uint32_t y = 0; y < params->workgroup_count_xyz[1]; ++y) {
+      for (uint32_t x = 0; x < params->workgroup_count_xyz[0]; ++x) {
+        workgroup_status =
+            params->workgroup_fn(params->callback.user_data, loop, x, y, z);
+        if (!iree_status_is_ok(workgroup_status)) goto workgroup_failed;
+      }
+    }
+  }
+workgroup_failed:
+  return params->callback.fn(params->callback.user_data, loop,
+                             workgroup_status);
+}
+
+// Runs |op| on the calling worker thread.
+static void iree_loop_threaded_run_op(iree_loop_threaded_op_t* op) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_loop_t loop = iree_loop_threaded_scope(op->scope);
+  iree_status_t status = iree_ok_status();
+  switch (op->command) {
+    case IREE_LOOP_COMMAND_CALL: {
+      iree_status_t op_status = op->status;
+      op->status = iree_ok_status();
+      status = op->params.call.callback.fn(op->params.call.callback.user_data,
+                                           loop, op_status);
+      break;
+    }
+    case IREE_LOOP_COMMAND_DISPATCH:
+      status = iree_loop_threaded_run_dispatch(loop, &op->params.dispatch);
+      break;
+    default:
+      IREE_ASSERT_UNREACHABLE("only calls and dispatches are runnable");
+      break;
+  }
+  if (!iree_status_is_ok(status)) {
+    iree_loop_threaded_emit_error(op->scope, status);
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+static int iree_loop_threaded_worker_main(
+    iree_loop_threaded_t* loop_threaded) {
+  iree_slim_mutex_lock(&loop_threaded->mutex);
+  for (;;) {
+    // Drain the run list before checking for shutdown so that operations
+    // enqueued by in-flight callbacks are never dropped.
+    iree_loop_threaded_op_t* op =
+        iree_loop_threaded_op_list_pop_front(&loop_threaded->run_list);
+    if (op) {
+      iree_slim_mutex_unlock(&loop_threaded->mutex);
+      iree_loop_threaded_run_op(op);
+      iree_slim_mutex_lock(&loop_threaded->mutex);
+      iree_loop_threaded_retire_op_locked(loop_threaded, op);
+      continue;
+    }
+    if (loop_threaded->shutting_down) break;
+
+    // Park until more work is enqueued. The token is acquired while holding
+    // the lock so that any post made after we release it wakes us.
+    iree_wait_token_t wait_token =
+        iree_notification_prepare_wait(&loop_threaded->work_notification);
+    iree_slim_mutex_unlock(&loop_threaded->mutex);
+    iree_notification_commit_wait(&loop_threaded->work_notification,
+                                  wait_token, IREE_DURATION_ZERO,
+                                  IREE_TIME_INFINITE_FUTURE);
+    iree_slim_mutex_lock(&loop_threaded->mutex);
+  }
+  iree_slim_mutex_unlock(&loop_threaded->mutex);
+  return 0;
+}
+
+//===----------------------------------------------------------------------===//
+// Poller
+//===----------------------------------------------------------------------===//
+
+// The poller keeps every pending wait handle registered in |wait_set| and
+// only updates it incrementally as operations are registered, resolved, or
+// aborted. Wakes are mapped back to the operations waiting on the woken handle
+// through the |waiters| table so that each wake only polls those operations
+// instead of all pending waits. Deadlines are only scanned when the earliest
+// one has been reached.
+
+static uint32_t iree_loop_threaded_waiter_hash(
+    iree_loop_threaded_t* loop_threaded, const iree_wait_handle_t* handle) {
+  // FNV-1a over the primitive identity.
+  uint32_t hash = 2166136261u ^ handle->type;
+  const uint8_t* bytes = (const uint8_t*)&handle->value;
+  for (iree_host_size_t i = 0; i < sizeof(handle->value); ++i) {
+    hash = (hash ^ bytes[i]) * 16777619u;
+  }
+  return hash & loop_threaded->waiter_mask;
+}
+
+// Records that |op| is waiting on |handle|.
+// The table is sized so that it can never fill up.
+static void iree_loop_threaded_waiter_insert(
+    iree_loop_threaded_t* loop_threaded, const iree_wait_handle_t* handle,
+    iree_loop_threaded_op_t* op) {
+  uint32_t i = iree_loop_threaded_waiter_hash(loop_threaded, handle);
+  while (loop_threaded->waiters[i].op) {
+    i = (i + 1) & loop_threaded->waiter_mask;
+  }
+  loop_threaded->waiters[i].handle = *handle;
+  loop_threaded->waiters[i].op = op;
+}
+
+// Removes one record of |op| waiting on |handle| and shifts back any entries
+// in the same probe sequence so that lookups never hit a premature empty
+// bucket.
+static void iree_loop_threaded_waiter_remove(
+    iree_loop_threaded_t* loop_threaded, const iree_wait_handle_t* handle,
+    iree_loop_threaded_op_t* op) {
+  iree_loop_threaded_waiter_t* waiters = loop_threaded->waiters;
+  const uint32_t mask = loop_threaded->waiter_mask;
+  uint32_t i = iree_loop_threaded_waiter_hash(loop_threaded, handle);
+  for (; waiters[i].op; i = (i + 1) & mask) {
+    if (waiters[i].op == op &&
+        iree_loop_threaded_wait_handle_equal(&waiters[i].handle, handle)) {
+      break;
+    }
+  }
+  if (!waiters[i].op) return;
+  for (uint32_t j = (i + 1) & mask; waiters[j].op; j = (j + 1) & mask) {
+    uint32_t home =
+        iree_loop_threaded_waiter_hash(loop_threaded, &waiters[j].handle);
+    if (((j - home) & mask) >= ((j - i) & mask)) {
+      waiters[i] = waiters[j];
+      i = j;
+    }
+  }
+  waiters[i].op = NULL;
+}
+
+static void iree_loop_threaded_wait_list_append(
+    iree_loop_threaded_op_list_t* list, iree_loop_threaded_op_t* op) {
+  op->prev = list->tail;
+  op->next = NULL;
+  if (list->tail) {
+    list->tail->next = op;
+  } else {
+    list->head = op;
+  }
+  list->tail = op;
+}
+
+static void iree_loop_threaded_wait_list_remove(
+    iree_loop_threaded_op_list_t* list, iree_loop_threaded_op_t* op) {
+  if (op->prev) {
+    op->prev->next = op->next;
+  } else {
+    list->head = op->next;
+  }
+  if (op->next) {
+    op->next->prev = op->prev;
+  } else {
+    list->tail = op->prev;
+  }
+  op->prev = NULL;
+  op->next = NULL;
+}
+
+// Removes |wait_handle| used by |op| from the wait set.
+static void iree_loop_threaded_unregister_wait_handle_locked(
+    iree_loop_threaded_t* loop_threaded, iree_loop_threaded_op_t* op,
+    iree_wait_handle_t* wait_handle) {
+  if (!op->registered) return;
+  iree_wait_set_erase(loop_threaded->wait_set, *wait_handle);
+  iree_loop_threaded_waiter_remove(loop_threaded, wait_handle, op);
+}
+
+// Removes all wait handles of |op| from the wait set.
+// The operation must already have been removed from |wait_list|.
+static void iree_loop_threaded_unregister_op_locked(
+    iree_loop_threaded_t* loop_threaded, iree_loop_threaded_op_t* op) {
+  if (!op->registered) return;
+  iree_host_size_t count = 0;
+  iree_wait_source_t* wait_sources =
+      iree_loop_threaded_op_wait_sources(op, &count);
+  for (iree_host_size_t i = 0; i < count; ++i) {
+    iree_wait_handle_t* wait_handle =
+        iree_wait_handle_from_source(&wait_sources[i]);
+    if (wait_handle) {
+      iree_loop_threaded_unregister_wait_handle_locked(loop_threaded, op,
+                                                       wait_handle);
+    }
+  }
+  op->registered = false;
+}
+
+// Adds all wait handles of |op| to the wait set and |wait_list|.
+static iree_status_t iree_loop_threaded_register_op_locked(
+    iree_loop_threaded_t* loop_threaded, iree_loop_threaded_op_t* op) {
+  iree_host_size_t count = 0;
+  iree_wait_source_t* wait_sources =
+      iree_loop_threaded_op_wait_sources(op, &count);
+  op->registered = true;
+  for (iree_host_size_t i = 0; i < count; ++i) {
+    iree_wait_handle_t* wait_handle =
+        iree_wait_handle_from_source(&wait_sources[i]);
+    if (!wait_handle) continue;
+    iree_status_t status =
+        iree_wait_set_insert(loop_threaded->wait_set, *wait_handle);
+    if (!iree_status_is_ok(status)) {
+      // Unwind the handles registered so far.
+      for (iree_host_size_t j = 0; j < i; ++j) {
+        iree_wait_handle_t* registered_handle =
+            iree_wait_handle_from_source(&wait_sources[j]);
+        if (registered_handle) {
+          iree_loop_threaded_unregister_wait_handle_locked(
+              loop_threaded, op, registered_handle);
+        }
+      }
+      op->registered = false;
+      return status;
+    }
+    iree_loop_threaded_waiter_insert(loop_threaded, wait_handle, op);
+  }
+  iree_loop_threaded_wait_list_append(&loop_threaded->wait_list, op);
+  loop_threaded->next_deadline_ns = iree_min(
+      loop_threaded->next_deadline_ns, iree_loop_threaded_op_deadline(op));
+  return iree_ok_status();
+}
+
+// Polls the wait operation |op| and returns DEFERRED if unresolved, OK if
+// resolved, and an error otherwise. Resolved wait sources of WAIT_ALL
+// operations are unregistered and neutered so that they are not waited on
+// again.
+static iree_status_t iree_loop_threaded_poll_op_locked(
+    iree_loop_threaded_t* loop_threaded, iree_loop_threaded_op_t* op,
+    iree_time_t now_ns) {
+  bool resolved = false;
+  switch (op->command) {
+    case IREE_LOOP_COMMAND_WAIT_UNTIL:
+      resolved = op->params.wait_until.deadline_ns <= now_ns;
+      break;
+    case IREE_LOOP_COMMAND_WAIT_ONE: {
+      iree_status_code_t wait_status_code = IREE_STATUS_OK;
+      IREE_RETURN_IF_ERROR(iree_wait_source_query(
+          op->params.wait_one.wait_source, &wait_status_code));
+      resolved = wait_status_code == IREE_STATUS_OK;
+      break;
+    }
+    case IREE_LOOP_COMMAND_WAIT_ANY: {
+      iree_loop_wait_multi_params_t* params = &op->params.wait_multi;
+      for (iree_host_size_t i = 0; i < params->count && !resolved; ++i) {
+        iree_status_code_t wait_status_code = IREE_STATUS_OK;
+        IREE_RETURN_IF_ERROR(
+            iree_wait_source_query(params->wait_sources[i], &wait_status_code));
+        resolved = wait_status_code == IREE_STATUS_OK;
+      }
+      break;
+    }
+    case IREE_LOOP_COMMAND_WAIT_ALL: {
+      iree_loop_wait_multi_params_t* params = &op->params.wait_multi;
+      resolved = true;
+      for (iree_host_size_t i = 0; i < params->count; ++i) {
+        iree_wait_source_t* wait_source = &params->wait_sources[i];
+        if (iree_wait_source_is_immediate(*wait_source)) continue;
+        iree_status_code_t wait_status_code = IREE_STATUS_OK;
+        IREE_RETURN_IF_ERROR(
+            iree_wait_source_query(*wait_source, &wait_status_code));
+        if (wait_status_code != IREE_STATUS_OK) {
+          resolved = false;
+          continue;
+        }
+        iree_wait_handle_t* wait_handle =
+            iree_wait_handle_from_source(wait_source);
+        if (wait_handle) {
+          iree_loop_threaded_unregister_wait_handle_locked(loop_threaded, op,
+                                                           wait_handle);
+          --op->wait_handle_count;
+          --loop_threaded->wait_handle_count;
+        }
+        *wait_source = iree_wait_source_immediate();
+      }
+      break;
+    }
+    default:
+      break;
+  }
+  if (resolved) return iree_ok_status();
+  if (iree_loop_threaded_op_deadline(op) <= now_ns) {
+    return iree_status_from_code(IREE_STATUS_DEADLINE_EXCEEDED);
+  }
+  return iree_status_from_code(IREE_STATUS_DEFERRED);
+}
+
+// Unregisters the wait operation |op| and moves it to the run list as a call
+// that receives |wait_status|.
+static void iree_loop_threaded_complete_wait_locked(
+    iree_loop_threaded_t* loop_threaded, iree_loop_threaded_op_t* op,
+    iree_status_t wait_status) {
+  if (op->registered) {
+    iree_loop_threaded_wait_list_remove(&loop_threaded->wait_list, op);
+    iree_loop_threaded_unregister_op_locked(loop_threaded, op);
+  }
+  loop_threaded->wait_handle_count -= op->wait_handle_count;
+  op->wait_handle_count = 0;
+
+  // The callback is at offset 0 of all params and is preserved.
+  op->command = IREE_LOOP_COMMAND_CALL;
+  op->params.call.priority = IREE_LOOP_PRIORITY_DEFAULT;
+  op->status = wait_status;
+  iree_loop_threaded_op_list_push_back(&loop_threaded->run_list, op);
+}
+
+// Removes the wait handles of all aborted operations from the wait set and
+// notifies the threads aborting them.
+static void iree_loop_threaded_process_unregister_list_locked(
+    iree_loop_threaded_t* loop_threaded) {
+  if (!loop_threaded->unregister_list) return;
+  while (loop_threaded->unregister_list) {
+    iree_loop_threaded_op_t* op = loop_threaded->unregister_list;
+    loop_threaded->unregister_list = op->poller_next;
+    op->poller_next = NULL;
+    iree_loop_threaded_unregister_op_locked(loop_threaded, op);
+  }
+  iree_notification_post(&loop_threaded->unregister_notification,
+                         IREE_ALL_WAITERS);
+}
+
+// Registers all newly enqueued wait operations, completing those that have
+// already resolved. Returns the number of operations completed.
+static iree_host_size_t iree_loop_threaded_process_insert_list_locked(
+    iree_loop_threaded_t* loop_threaded, iree_time_t now_ns) {
+  iree_host_size_t woken_count = 0;
+  iree_loop_threaded_op_t* op = NULL;
+  while ((op = iree_loop_threaded_op_list_pop_front(
+              &loop_threaded->insert_list)) != NULL) {
+    iree_status_t wait_status =
+        iree_loop_threaded_poll_op_locked(loop_threaded, op, now_ns);
+    if (iree_status_is_deferred(wait_status)) {
+      wait_status = iree_loop_threaded_register_op_locked(loop_threaded, op);
+      if (iree_status_is_ok(wait_status)) continue;
+    }
+    iree_loop_threaded_complete_wait_locked(loop_threaded, op, wait_status);
+    ++woken_count;
+  }
+  return woken_count;
+}
+
+// Polls only the operations waiting on |wake_handle| and completes those that
+// have resolved. Returns the number of operations completed.
+static iree_host_size_t iree_loop_threaded_process_wake_locked(
+    iree_loop_threaded_t* loop_threaded, const iree_wait_handle_t* wake_handle,
+    iree_time_t now_ns) {
+  if (iree_wait_handle_is_immediate(*wake_handle)) return 0;
+
+  // Gather the waiting operations first as completing them mutates the table.
+  // An operation may wait on the same handle multiple times but is only
+  // polled once.
+  iree_loop_threaded_op_t* woken_list = NULL;
+  iree_loop_threaded_waiter_t* waiters = loop_threaded->waiters;
+  for (uint32_t i = iree_loop_threaded_waiter_hash(loop_threaded, wake_handle);
+       waiters[i].op; i = (i + 1) & loop_threaded->waiter_mask) {
+    iree_loop_threaded_op_t* op = waiters[i].op;
+    if (op->woken ||
+        !iree_loop_threaded_wait_handle_equal(&waiters[i].handle,
+                                              wake_handle)) {
+      continue;
+    }
+    op->woken = true;
+    op->poller_next = woken_list;
+    woken_list = op;
+  }
+
+  iree_host_size_t woken_count = 0;
+  while (woken_list) {
+    iree_loop_threaded_op_t* op = woken_list;
+    woken_list = op->poller_next;
+    op->poller_next = NULL;
+    op->woken = false;
+    iree_status_t wait_status =
+        iree_loop_threaded_poll_op_locked(loop_threaded, op, now_ns);
+    if (iree_status_is_deferred(wait_status)) continue;
+    iree_loop_threaded_complete_wait_locked(loop_threaded, op, wait_status);
+    ++woken_count;
+  }
+  return woken_count;
+}
+
+// Completes all registered operations whose deadline has been reached and
+// recomputes the earliest pending deadline. When |poll_all| is set all
+// operations are polled regardless of their deadline. Returns the number of
+// operations completed.
+static iree_host_size_t iree_loop_threaded_scan_waits_locked(
+    iree_loop_threaded_t* loop_threaded, iree_time_t now_ns, bool poll_all) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_time_t next_deadline_ns = IREE_TIME_INFINITE_FUTURE;
+  iree_host_size_t woken_count = 0;
+  iree_loop_threaded_op_t* next_op = loop_threaded->wait_list.head;
+  while (next_op) {
+    iree_loop_threaded_op_t* op = next_op;
+    next_op = op->next;
+    iree_time_t deadline_ns = iree_loop_threaded_op_deadline(op);
+    if (poll_all || deadline_ns <= now_ns) {
+      iree_status_t wait_status =
+          iree_loop_threaded_poll_op_locked(loop_threaded, op, now_ns);
+      if (!iree_status_is_deferred(wait_status)) {
+        iree_loop_threaded_complete_wait_locked(loop_threaded, op,
+                                                wait_status);
+        ++woken_count;
+        continue;
+      }
+    }
+    next_deadline_ns = iree_min(next_deadline_ns, deadline_ns);
+  }
+  loop_threaded->next_deadline_ns = next_deadline_ns;
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, (int64_t)woken_count);
+  IREE_TRACE_ZONE_END(z0);
+  return woken_count;
+}
+
+static int iree_loop_threaded_poller_main(
+    iree_loop_threaded_t* loop_threaded) {
+  iree_wait_handle_t wake_handle = iree_wait_handle_immediate();
+  bool poll_all = false;
+  iree_slim_mutex_lock(&loop_threaded->mutex);
+  for (;;) {
+    // Aborted operations are unregistered even when shutting down so that the
+    // threads aborting them can make progress.
+    iree_loop_threaded_process_unregister_list_locked(loop_threaded);
+    if (loop_threaded->shutting_down) break;
+
+    iree_time_t now_ns = iree_time_now();
+    iree_host_size_t woken_count = iree_loop_threaded_process_wake_locked(
+        loop_threaded, &wake_handle, now_ns);
+    woken_count +=
+        iree_loop_threaded_process_insert_list_locked(loop_threaded, now_ns);
+    if (poll_all || loop_threaded->next_deadline_ns <= now_ns) {
+      woken_count +=
+          iree_loop_threaded_scan_waits_locked(loop_threaded, now_ns, poll_all);
+    }
+    iree_time_t deadline_ns = loop_threaded->next_deadline_ns;
+    iree_slim_mutex_unlock(&loop_threaded->mutex);
+
+    if (woken_count) {
+      iree_notification_post(&loop_threaded->work_notification,
+                             (int32_t)woken_count);
+    }
+
+    // Wait until any handle resolves, the earliest deadline is reached, or
+    // there are new or aborted waits. Failed waits don't identify which handle
+    // failed and all operations are polled to find it.
+    // The event is reset before processing under the lock so that any change
+    // made prior to the reset is observed and any made after interrupts the
+    // next wait.
+    IREE_TRACE_ZONE_BEGIN_NAMED(z0, "iree_loop_threaded_poller_wait");
+    wake_handle = iree_wait_handle_immediate();
+    iree_status_t wait_status =
+        iree_wait_any(loop_threaded->wait_set, deadline_ns, &wake_handle);
+    poll_all = !iree_status_is_ok(wait_status) &&
+               !iree_status_is_deadline_exceeded(wait_status);
+    iree_status_ignore(wait_status);
+    iree_event_reset(&loop_threaded->poller_event);
+    IREE_TRACE_ZONE_END(z0);
+
+    iree_slim_mutex_lock(&loop_threaded->mutex);
+  }
+  loop_threaded->poller_exited = true;
+  iree_slim_mutex_unlock(&loop_threaded->mutex);
+  return 0;
+}
+
+static iree_status_t iree_loop_threaded_create_thread(
+    const char* name, iree_thread_entry_t entry,
+    iree_loop_threaded_t* loop_threaded, iree_host_size_t stack_size,
+    iree_thread_t** out_thread) {
+  iree_thread_create_params_t thread_params;
+  memset(&thread_params, 0, sizeof(thread_params));
+  thread_params.name = iree_make_cstring_view(name);
+  thread_params.stack_size = stack_size;
+  thread_params.priority_class = IREE_THREAD_PRIORITY_CLASS_NORMAL;
+  return iree_thread_create(entry, loop_threaded, thread_params,
+                            loop_threaded->allocator, out_thread);
+}
+
+IREE_API_EXPORT iree_status_t iree_loop_threaded_allocate(
+    iree_loop_threaded_options_t options, iree_allocator_t allocator,
+    iree_loop_threaded_t** out_loop_threaded) {
+  IREE_ASSERT_ARGUMENT(out_loop_threaded);
+  *out_loop_threaded = NULL;
+  if (IREE_UNLIKELY(options.worker_count == 0)) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "at least one worker is required");
+  }
+  if (IREE_UNLIKELY(options.max_wait_count > UINT16_MAX)) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "wait list depth exceeds maximum");
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, (int64_t)options.worker_count);
+
+  iree_loop_threaded_t* loop_threaded = NULL;
+  const iree_host_size_t total_size =
+      sizeof(*loop_threaded) +
+      options.worker_count * sizeof(loop_threaded->worker_threads[0]);
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(allocator, total_size, (void**)&loop_threaded));
+  loop_threaded->allocator = allocator;
+  iree_slim_mutex_initialize(&loop_threaded->mutex);
+  loop_threaded->max_wait_count = options.max_wait_count;
+  iree_notification_initialize(&loop_threaded->work_notification);
+  iree_notification_initialize(&loop_threaded->idle_notification);
+  iree_notification_initialize(&loop_threaded->unregister_notification);
+  loop_threaded->next_deadline_ns = IREE_TIME_INFINITE_FUTURE;
+  loop_threaded->poller_event = iree_wait_handle_immediate();
+
+  // One extra wait set slot is reserved for the poller event, which stays
+  // registered for the lifetime of the loop.
+  iree_status_t status = iree_event_initialize(
+      /*initial_state=*/false, &loop_threaded->poller_event);
+  if (iree_status_is_ok(status)) {
+    status = iree_wait_set_allocate(options.max_wait_count + 1, allocator,
+                                    &loop_threaded->wait_set);
+  }
+  if (iree_status_is_ok(status)) {
+    status = iree_wait_set_insert(loop_threaded->wait_set,
+                                  loop_threaded->poller_event);
+  }
+  if (iree_status_is_ok(status)) {
+    iree_host_size_t waiter_count = 8;
+    while (waiter_count < options.max_wait_count * 2) waiter_count <<= 1;
+    loop_threaded->waiter_mask = (uint32_t)(waiter_count - 1);
+    status = iree_allocator_malloc(
+        allocator, waiter_count * sizeof(loop_threaded->waiters[0]),
+        (void**)&loop_threaded->waiters);
+  }
+  if (iree_status_is_ok(status)) {
+    status = iree_loop_threaded_create_thread(
+        "iree-loop-poller",
+        (iree_thread_entry_t)iree_loop_threaded_poller_main, loop_threaded,
+        /*stack_size=*/0, &loop_threaded->poller_thread);
+  }
+  for (iree_host_size_t i = 0;
+       i < options.worker_count && iree_status_is_ok(status); ++i) {
+    status = iree_loop_threaded_create_thread(
+        "iree-loop-worker",
+        (iree_thread_entry_t)iree_loop_threaded_worker_main, loop_threaded,
+        options.worker_stack_size, &loop_threaded->worker_threads[i]);
+    if (iree_status_is_ok(status)) ++loop_threaded->worker_count;
+  }
+
+  if (iree_status_is_ok(status)) {
+    *out_loop_threaded = loop_threaded;
+  } else {
+    iree_loop_threaded_free(loop_threaded);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+IREE_API_EXPORT void iree_loop_threaded_free(
+    iree_loop_threaded_t* loop_threaded) {
+  IREE_ASSERT_ARGUMENT(loop_threaded);
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_allocator_t allocator = loop_threaded->allocator;
+
+  // Prevent new work from being enqueued and abort all pending operations.
+  // This will issue callbacks for each operation that was aborted directly
+  // with IREE_STATUS_ABORTED.
+  iree_slim_mutex_lock(&loop_threaded->mutex);
+  loop_threaded->shutting_down = true;
+  iree_slim_mutex_unlock(&loop_threaded->mutex);
+  iree_loop_threaded_abort_scope(loop_threaded, /*scope=*/NULL);
+
+  // Wake all threads so they observe the shutdown and join them. Workers will
+  // finish any callbacks they are currently executing first.
+  iree_notification_post(&loop_threaded->work_notification, IREE_ALL_WAITERS);
+  if (!iree_wait_handle_is_immediate(loop_threaded->poller_event)) {
+    iree_event_set(&loop_threaded->poller_event);
+  }
+  iree_thread_release(loop_threaded->poller_thread);
+  for (iree_host_size_t i = 0; i < loop_threaded->worker_count; ++i) {
+    iree_thread_release(loop_threaded->worker_threads[i]);
+  }
+  IREE_ASSERT_EQ(loop_threaded->pending_count, 0);
+
+  while (loop_threaded->free_list) {
+    iree_loop_threaded_op_t* op = loop_threaded->free_list;
+    loop_threaded->free_list = op->next;
+    iree_allocator_free(allocator, op);
+  }
+  iree_allocator_free(allocator, loop_threaded->waiters);
+  if (loop_threaded->wait_set) iree_wait_set_free(loop_threaded->wait_set);
+  iree_event_deinitialize(&loop_threaded->poller_event);
+  iree_notification_deinitialize(&loop_threaded->unregister_notification);
+  iree_notification_deinitialize(&loop_threaded->idle_notification);
+  iree_notification_deinitialize(&loop_threaded->work_notification);
+  iree_slim_mutex_deinitialize(&loop_threaded->mutex);
+  iree_allocator_free(allocator, loop_threaded);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+// Aborts all pending operations in the loop attributed to |scope|.
+// A NULL |scope| indicates all operations from all scopes should be aborted.
+// Operations currently executing on workers are unaffected.
+static void iree_loop_threaded_abort_scope(iree_loop_threaded_t* loop_threaded,
+                                           iree_loop_threaded_scope_t* scope) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_loop_threaded_op_list_t aborted_list = {NULL, NULL};
+  iree_loop_threaded_op_list_t aborted_wait_list = {NULL, NULL};
+  iree_slim_mutex_lock(&loop_threaded->mutex);
+  iree_loop_threaded_op_list_take_scope(&loop_threaded->run_list, scope,
+                                        &aborted_list);
+  iree_loop_threaded_op_list_take_scope(&loop_threaded->insert_list, scope,
+                                        &aborted_wait_list);
+
+  // Registered waits have their handles removed from the wait set by the
+  // poller; if it has already exited the set is no longer in use and we can
+  // remove them ourselves.
+  bool any_unregistering = false;
+  iree_loop_threaded_op_t* next_op = loop_threaded->wait_list.head;
+  while (next_op) {
+    iree_loop_threaded_op_t* op = next_op;
+    next_op = op->next;
+    if (scope && op->scope != scope) continue;
+    iree_loop_threaded_wait_list_remove(&loop_threaded->wait_list, op);
+    if (loop_threaded->poller_exited) {
+      iree_loop_threaded_unregister_op_locked(loop_threaded, op);
+    } else {
+      op->poller_next = loop_threaded->unregister_list;
+      loop_threaded->unregister_list = op;
+      any_unregistering = true;
+    }
+    iree_loop_threaded_op_list_push_back(&aborted_wait_list, op);
+  }
+  iree_loop_threaded_op_t* op = NULL;
+  for (op = aborted_wait_list.head; op; op = op->next) {
+    loop_threaded->wait_handle_count -= op->wait_handle_count;
+    op->wait_handle_count = 0;
+  }
+  iree_slim_mutex_unlock(&loop_threaded->mutex);
+
+  // Wait for the poller to drop the handles of any aborted waits. Callbacks
+  // may close the handles they were waiting on and handles must be removed
+  // from the wait set before they are closed.
+  if (any_unregistering) {
+    iree_event_set(&loop_threaded->poller_event);
+    iree_slim_mutex_lock(&loop_threaded->mutex);
+    for (;;) {
+      bool any_registered = false;
+      for (op = aborted_wait_list.head; op && !any_registered; op = op->next) {
+        any_registered = op->registered;
+      }
+      if (!any_registered) break;
+      iree_wait_token_t wait_token = iree_notification_prepare_wait(
+          &loop_threaded->unregister_notification);
+      iree_slim_mutex_unlock(&loop_threaded->mutex);
+      iree_notification_commit_wait(&loop_threaded->unregister_notification,
+                                    wait_token, IREE_DURATION_ZERO,
+                                    IREE_TIME_INFINITE_FUTURE);
+      iree_slim_mutex_lock(&loop_threaded->mutex);
+    }
+    iree_slim_mutex_unlock(&loop_threaded->mutex);
+  }
+  while ((op = iree_loop_threaded_op_list_pop_front(&aborted_wait_list)) !=
+         NULL) {
+    iree_loop_threaded_op_list_push_back(&aborted_list, op);
+  }
+
+  // Issue the completion callback of each op to notify it of the abort.
+  // To prevent enqueuing more work while aborting we pass in a NULL loop.
+  // We can't do anything with the errors so we ignore them.
+  for (iree_loop_threaded_op_t* op = aborted_list.head; op; op = op->next) {
+    iree_status_ignore(op->status);
+    op->status = iree_ok_status();
+    iree_status_ignore(op->callback.fn(op->callback.user_data,
+                                       iree_loop_null(),
+                                       iree_make_status(IREE_STATUS_ABORTED)));
+  }
+
+  iree_slim_mutex_lock(&loop_threaded->mutex);
+  while ((op = iree_loop_threaded_op_list_pop_front(&aborted_list)) != NULL) {
+    iree_loop_threaded_retire_op_locked(loop_threaded, op);
+  }
+  iree_slim_mutex_unlock(&loop_threaded->mutex);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+// Waits until all work in |scope| has completed.
+// A NULL |scope| indicates all work from all scopes should be waited on.
+static iree_status_t iree_loop_threaded_wait_scope_idle(
+    iree_loop_threaded_t* loop_threaded, iree_loop_threaded_scope_t* scope,
+    iree_time_t deadline_ns) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_status_t status = iree_ok_status();
+  iree_slim_mutex_lock(&loop_threaded->mutex);
+  while ((scope ? scope->pending_count : loop_threaded->pending_count) > 0) {
+    iree_wait_token_t wait_token =
+        iree_notification_prepare_wait(&loop_threaded->idle_notification);
+    iree_slim_mutex_unlock(&loop_threaded->mutex);
+    bool notified =
+        iree_notification_commit_wait(&loop_threaded->idle_notification,
+                                      wait_token, IREE_DURATION_ZERO,
+                                      deadline_ns);
+    iree_slim_mutex_lock(&loop_threaded->mutex);
+    if (!notified) {
+      if ((scope ? scope->pending_count : loop_threaded->pending_count) > 0) {
+        status = iree_status_from_code(IREE_STATUS_DEADLINE_EXCEEDED);
+      }
+      break;
+    }
+  }
+  iree_slim_mutex_unlock(&loop_threaded->mutex);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+IREE_API_EXPORT iree_status_t iree_loop_threaded_wait_idle(
+    iree_loop_threaded_t* loop_threaded, iree_timeout_t timeout) {
+  IREE_ASSERT_ARGUMENT(loop_threaded);
+  return iree_loop_threaded_wait_scope_idle(
+      loop_threaded, /*scope=*/NULL, iree_timeout_as_deadline_ns(timeout));
+}
+
+// Enqueues a new operation of |command| with |params| against |scope|.
+static iree_status_t iree_loop_threaded_enqueue(
+    iree_loop_threaded_scope_t* scope, iree_loop_command_t command,
+    const void* params, iree_host_size_t params_size) {
+  iree_loop_threaded_t* loop_threaded = scope->loop_threaded;
+
+  // Copy the operation in; the params are on the stack and won't be valid after
+  // the caller returns.
+  iree_loop_threaded_op_t* op = NULL;
+  IREE_RETURN_IF_ERROR(iree_loop_threaded_acquire_op(loop_threaded, &op));
+  memcpy(&op->params, params, params_size);
+  op->command = command;
+  op->scope = scope;
+  bool is_wait = command != IREE_LOOP_COMMAND_CALL &&
+                       command != IREE_LOOP_COMMAND_DISPATCH;
+
+  // Export wait handles outside of the lock as it may be expensive.
+  iree_status_t status = iree_ok_status();
+  if (is_wait) {
+    status = iree_loop_threaded_op_register_wait_sources(op);
+  }
+
+  iree_slim_mutex_lock(&loop_threaded->mutex);
+  if (iree_status_is_ok(status) &&
+      IREE_UNLIKELY(loop_threaded->shutting_down)) {
+    status = iree_make_status(
+        IREE_STATUS_FAILED_PRECONDITION,
+        "new work cannot be enqueued while the loop is shutting down");
+  }
+  if (iree_status_is_ok(status) && is_wait &&
+      loop_threaded->wait_handle_count + op->wait_handle_count >
+          loop_threaded->max_wait_count) {
+    status = iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED,
+                              "wait handle capacity %" PRIhsz " reached",
+                              loop_threaded->max_wait_count);
+  }
+  if (iree_status_is_ok(status) && scope->failed) {
+    // The scope has failed; issue the callback with an abort status from a
+    // worker instead of running the operation. The callback is at offset 0 of
+    // all params and is preserved.
+    op->wait_handle_count = 0;
+    op->command = IREE_LOOP_COMMAND_CALL;
+    op->params.call.priority = IREE_LOOP_PRIORITY_DEFAULT;
+    op->status = iree_status_from_code(IREE_STATUS_ABORTED);
+    is_wait = false;
+  }
+  if (iree_status_is_ok(status)) {
+    if (is_wait) {
+      loop_threaded->wait_handle_count += op->wait_handle_count;
+      iree_loop_threaded_op_list_push_back(&loop_threaded->insert_list, op);
+    } else {
+      iree_loop_threaded_op_list_push_back(&loop_threaded->run_list, op);
+    }
+    ++scope->pending_count;
+    ++loop_threaded->pending_count;
+  } else {
+    iree_loop_threaded_recycle_op_locked(loop_threaded, op);
+  }
+  iree_slim_mutex_unlock(&loop_threaded->mutex);
+  if (!iree_status_is_ok(status)) return status;
+
+  if (is_wait) {
+    iree_event_set(&loop_threaded->poller_event);
+  } else {
+    iree_notification_post(&loop_threaded->work_notification, 1);
+  }
+  return iree_ok_status();
+}
+
+//===----------------------------------------------------------------------===//
+// iree_loop_threaded_scope_t
+//===----------------------------------------------------------------------===//
+
+IREE_API_EXPORT void iree_loop_threaded_scope_initialize(
+    iree_loop_threaded_t* loop_threaded, iree_loop_threaded_error_fn_t error_fn,
+    void* error_user_data, iree_loop_threaded_scope_t* out_scope) {
+  memset(out_scope, 0, sizeof(*out_scope));
+  out_scope->loop_threaded = loop_threaded;
+  out_scope->pending_count = 0;
+  out_scope->error_fn = error_fn;
+  out_scope->error_user_data = error_user_data;
+}
+
+IREE_API_EXPORT void iree_loop_threaded_scope_deinitialize(
+    iree_loop_threaded_scope_t* scope) {
+  IREE_ASSERT_ARGUMENT(scope);
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  if (scope->loop_threaded) {
+    iree_loop_threaded_abort_scope(scope->loop_threaded, scope);
+    iree_status_ignore(iree_loop_threaded_wait_scope_idle(
+        scope->loop_threaded, scope, IREE_TIME_INFINITE_FUTURE));
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+// Control function for the threaded loop.
+// |self| must be an iree_loop_threaded_scope_t.
+IREE_API_EXPORT iree_status_t iree_loop_threaded_ctl(
+    void* self, iree_loop_command_t command, const void* params,
+    void** inout_ptr) {
+  IREE_ASSERT_ARGUMENT(self);
+  iree_loop_threaded_scope_t* scope = (iree_loop_threaded_scope_t*)self;
+
+  switch (command) {
+    case IREE_LOOP_COMMAND_CALL:
+      return iree_loop_threaded_enqueue(scope, command, params,
+                                        sizeof(iree_loop_call_params_t));
+    case IREE_LOOP_COMMAND_DISPATCH:
+      return iree_loop_threaded_enqueue(scope, command, params,
+                                        sizeof(iree_loop_dispatch_params_t));
+    case IREE_LOOP_COMMAND_WAIT_UNTIL:
+      return iree_loop_threaded_enqueue(scope, command, params,
+                                        sizeof(iree_loop_wait_until_params_t));
+    case IREE_LOOP_COMMAND_WAIT_ONE:
+      return iree_loop_threaded_enqueue(scope, command, params,
+                                        sizeof(iree_loop_wait_one_params_t));
+    case IREE_LOOP_COMMAND_WAIT_ALL:
+    case IREE_LOOP_COMMAND_WAIT_ANY:
+      return iree_loop_threaded_enqueue(scope, command, params,
+                                        sizeof(iree_loop_wait_multi_params_t));
+    case IREE_LOOP_COMMAND_DRAIN:
+      return iree_loop_threaded_wait_scope_idle(
+          scope->loop_threaded, scope,
+          ((const iree_loop_drain_params_t*)params)->deadline_ns);
+    default:
+      return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                              "unimplemented loop command");
+  }
+}
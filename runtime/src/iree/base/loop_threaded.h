@@ -0,0 +1,134 @@
+// Copyright 2025 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_BASE_LOOP_THREADED_H_
+#define IREE_BASE_LOOP_THREADED_H_
+
+#include "iree/base/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+//===----------------------------------------------------------------------===//
+// iree_loop_threaded_t
+//===----------------------------------------------------------------------===//
+
+// Configuration options for the threaded loop implementation.
+typedef struct iree_loop_threaded_options_t {
+  // Number of worker threads executing callbacks concurrently.
+  // Must be at least 1.
+  iree_host_size_t worker_count;
+
+  // Specifies how many wait handles may be pending at the same time across
+  // all wait operations. Growth is not currently supported and if the
+  // capacity is reached then IREE_STATUS_RESOURCE_EXHAUSTED will be returned
+  // when new waits are enqueued.
+  iree_host_size_t max_wait_count;
+
+  // Stack size of each worker thread in bytes or 0 for the platform default.
+  iree_host_size_t worker_stack_size;
+} iree_loop_threaded_options_t;
+
+// A loop that runs operations on a pool of worker threads as they become
+// ready. A single poller thread multiplexes all pending waits and timers over
+// one OS wait set and hands resolved operations to the workers so that waits,
+// I/O completions, and callbacks all overlap.
+//
+// Callbacks may run concurrently with any other callback (including others
+// from the same scope) and must synchronize access to any shared user data.
+// Ordering is FIFO per loop but operations are dequeued by whichever worker
+// is available and may complete in any order.
+//
+// Thread-safe: operations may be enqueued from any thread, including from
+// within callbacks running on the loop.
+typedef struct iree_loop_threaded_t iree_loop_threaded_t;
+
+// Allocates a threaded loop using |allocator| stored into |out_loop_threaded|.
+// All worker threads and the poller thread are started before returning.
+IREE_API_EXPORT iree_status_t iree_loop_threaded_allocate(
+    iree_loop_threaded_options_t options, iree_allocator_t allocator,
+    iree_loop_threaded_t** out_loop_threaded);
+
+// Frees a threaded |loop_threaded|, aborting all pending operations.
+// Callbacks already executing on worker threads are allowed to complete and
+// any new work they attempt to enqueue will fail. Must not be called from a
+// loop callback.
+IREE_API_EXPORT void iree_loop_threaded_free(
+    iree_loop_threaded_t* loop_threaded);
+
+// Waits until the loop is idle (all operations in all scopes have retired).
+// Returns IREE_STATUS_DEADLINE_EXCEEDED if |timeout| is reached before the
+// loop is idle. Must not be called from a loop callback as the callback
+// itself keeps the loop from becoming idle.
+IREE_API_EXPORT iree_status_t iree_loop_threaded_wait_idle(
+    iree_loop_threaded_t* loop_threaded, iree_timeout_t timeout);
+
+// Handles scope errors returned from loop callback operations.
+// Ownership of |status| is passed to the handler and must be freed.
+// All operations of the same scope will be aborted. May be called
+// concurrently from multiple worker threads.
+typedef void(IREE_API_PTR* iree_loop_threaded_error_fn_t)(void* user_data,
+                                                          iree_status_t status);
+
+// A scope of execution within a loop.
+// Each scope has a dedicated error handler that is notified when an error
+// propagates from a loop operation scheduled against the scope. When an error
+// arises all other pending operations in the same scope will be aborted.
+//
+// As operations begin executing as soon as they are enqueued failure is
+// sticky: once an error has been reported all operations subsequently
+// enqueued against the scope are aborted as well. The scope must be
+// deinitialized and initialized again to be reused.
+typedef struct iree_loop_threaded_scope_t {
+  // Target loop for execution.
+  iree_loop_threaded_t* loop_threaded;
+
+  // Total number of pending operations in the scope, including those that
+  // are currently executing. When 0 the scope is considered idle.
+  // Guarded by the loop and must not be accessed directly.
+  int32_t pending_count;
+
+  // Set once an error has been reported from an operation in the scope.
+  // Guarded by the loop and must not be accessed directly.
+  bool failed;
+
+  // Optional function used to report errors that occur during execution.
+  iree_loop_threaded_error_fn_t error_fn;
+  void* error_user_data;
+} iree_loop_threaded_scope_t;
+
+// Initializes a loop scope that runs operations against |loop_threaded|.
+IREE_API_EXPORT void iree_loop_threaded_scope_initialize(
+    iree_loop_threaded_t* loop_threaded, iree_loop_threaded_error_fn_t error_fn,
+    void* error_user_data, iree_loop_threaded_scope_t* out_scope);
+
+// Deinitializes a loop |scope|, aborting any pending operations and waiting
+// for those currently executing to complete.
+IREE_API_EXPORT void iree_loop_threaded_scope_deinitialize(
+    iree_loop_threaded_scope_t* scope);
+
+IREE_API_EXPORT iree_status_t iree_loop_threaded_ctl(
+    void* self, iree_loop_command_t command, const void* params,
+    void** inout_ptr);
+
+// Returns a loop that schedules operations against |scope|.
+// The scope must remain valid until all operations scheduled against it have
+// completed.
+static inline iree_loop_t iree_loop_threaded_scope(
+    iree_loop_threaded_scope_t* scope) {
+  iree_loop_t loop = {
+      scope,
+      iree_loop_threaded_ctl,
+  };
+  return loop;
+}
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_BASE_LOOP_THREADED_H_
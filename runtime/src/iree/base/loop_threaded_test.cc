@@ -0,0 +1,283 @@
+// Copyright 2025 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/base/loop_threaded.h"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+#include "iree/base/api.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+// Contains the test definitions applied to all loop implementations:
+#include "iree/base/loop_test.h"
+
+namespace {
+
+struct ThreadedLoop {
+  iree_loop_threaded_t* loop_threaded = NULL;
+  iree_loop_threaded_scope_t scope;
+  // Errors may be reported concurrently from multiple workers.
+  std::mutex status_mutex;
+  iree_status_t* status_ptr = NULL;
+};
+
+ThreadedLoop* CreateThreadedLoop(iree_host_size_t worker_count,
+                                 iree_status_t* out_status) {
+  iree_loop_threaded_options_t options = {0};
+  options.worker_count = worker_count;
+  options.max_wait_count = 32;
+
+  ThreadedLoop* loop = new ThreadedLoop();
+  loop->status_ptr = out_status;
+  IREE_CHECK_OK(iree_loop_threaded_allocate(options, iree_allocator_system(),
+                                            &loop->loop_threaded));
+  iree_loop_threaded_scope_initialize(
+      loop->loop_threaded,
+      +[](void* user_data, iree_status_t status) {
+        ThreadedLoop* loop = (ThreadedLoop*)user_data;
+        std::lock_guard<std::mutex> lock(loop->status_mutex);
+        if (iree_status_is_ok(*loop->status_ptr)) {
+          *loop->status_ptr = status;
+        } else {
+          iree_status_ignore(status);
+        }
+      },
+      loop, &loop->scope);
+  return loop;
+}
+
+void DestroyThreadedLoop(ThreadedLoop* loop) {
+  iree_loop_threaded_scope_deinitialize(&loop->scope);
+  iree_loop_threaded_free(loop->loop_threaded);
+  delete loop;
+}
+
+}  // namespace
+
+void AllocateLoop(iree_status_t* out_status, iree_allocator_t allocator,
+                  iree_loop_t* out_loop) {
+  ThreadedLoop* loop = CreateThreadedLoop(/*worker_count=*/2, out_status);
+  *out_loop = iree_loop_threaded_scope(&loop->scope);
+}
+
+void FreeLoop(iree_allocator_t allocator, iree_loop_t loop) {
+  iree_loop_threaded_scope_t* scope = (iree_loop_threaded_scope_t*)loop.self;
+  DestroyThreadedLoop(reinterpret_cast<ThreadedLoop*>(scope->error_user_data));
+}
+
+namespace iree {
+namespace testing {
+namespace {
+
+// Tests that calls run concurrently on different workers: each call blocks
+// until the other has started and would deadlock on a serial loop.
+TEST(LoopThreadedTest, CallsRunConcurrently) {
+  iree_status_t loop_status = iree_ok_status();
+  ThreadedLoop* threaded_loop =
+      CreateThreadedLoop(/*worker_count=*/2, &loop_status);
+  iree_loop_t loop = iree_loop_threaded_scope(&threaded_loop->scope);
+
+  struct UserData {
+    std::atomic<int> started_count = {0};
+    std::atomic<int> rendezvous_count = {0};
+  } user_data;
+  auto call_fn = +[](void* user_data_ptr, iree_loop_t loop,
+                     iree_status_t status) {
+    IREE_EXPECT_OK(status);
+    auto* user_data = reinterpret_cast<UserData*>(user_data_ptr);
+    user_data->started_count.fetch_add(1);
+    iree_time_t deadline_ns = iree_time_now() + 5000000000ll;
+    while (user_data->started_count.load() < 2) {
+      if (iree_time_now() > deadline_ns) return iree_ok_status();
+      std::this_thread::yield();
+    }
+    user_data->rendezvous_count.fetch_add(1);
+    return iree_ok_status();
+  };
+  IREE_ASSERT_OK(
+      iree_loop_call(loop, IREE_LOOP_PRIORITY_DEFAULT, call_fn, &user_data));
+  IREE_ASSERT_OK(
+      iree_loop_call(loop, IREE_LOOP_PRIORITY_DEFAULT, call_fn, &user_data));
+  IREE_ASSERT_OK(iree_loop_drain(loop, iree_infinite_timeout()));
+  IREE_ASSERT_OK(loop_status);
+  EXPECT_EQ(user_data.rendezvous_count.load(), 2);
+
+  DestroyThreadedLoop(threaded_loop);
+}
+
+// Tests that calls keep running while a wait is pending on the poller.
+TEST(LoopThreadedTest, CallsOverlapWaits) {
+  iree_status_t loop_status = iree_ok_status();
+  ThreadedLoop* threaded_loop =
+      CreateThreadedLoop(/*worker_count=*/1, &loop_status);
+  iree_loop_t loop = iree_loop_threaded_scope(&threaded_loop->scope);
+
+  iree_event_t event;
+  IREE_ASSERT_OK(iree_event_initialize(/*initial_state=*/false, &event));
+  struct UserData {
+    iree_event_t* event = NULL;
+    std::atomic<bool> did_wait_callback = {false};
+  } user_data;
+  user_data.event = &event;
+
+  // The wait only resolves when the call below signals it.
+  IREE_ASSERT_OK(iree_loop_wait_one(
+      loop, iree_event_await(&event), iree_make_timeout_ms(5000),
+      +[](void* user_data_ptr, iree_loop_t loop, iree_status_t status) {
+        IREE_EXPECT_OK(status);
+        auto* user_data = reinterpret_cast<UserData*>(user_data_ptr);
+        user_data->did_wait_callback = true;
+        return iree_ok_status();
+      },
+      &user_data));
+  IREE_ASSERT_OK(iree_loop_call(
+      loop, IREE_LOOP_PRIORITY_DEFAULT,
+      +[](void* user_data_ptr, iree_loop_t loop, iree_status_t status) {
+        IREE_EXPECT_OK(status);
+        auto* user_data = reinterpret_cast<UserData*>(user_data_ptr);
+        iree_event_set(user_data->event);
+        return iree_ok_status();
+      },
+      &user_data));
+  IREE_ASSERT_OK(iree_loop_drain(loop, iree_infinite_timeout()));
+  IREE_ASSERT_OK(loop_status);
+  EXPECT_TRUE(user_data.did_wait_callback);
+
+  DestroyThreadedLoop(threaded_loop);
+  iree_event_deinitialize(&event);
+}
+
+// Tests that freeing the loop aborts pending waits.
+TEST(LoopThreadedTest, FreeAbortsWaits) {
+  iree_status_t loop_status = iree_ok_status();
+  ThreadedLoop* threaded_loop =
+      CreateThreadedLoop(/*worker_count=*/1, &loop_status);
+  iree_loop_t loop = iree_loop_threaded_scope(&threaded_loop->scope);
+
+  bool did_abort = false;
+  IREE_ASSERT_OK(iree_loop_wait_until(
+      loop, iree_make_timeout_ms(1 * 60 * 1000),
+      +[](void* user_data_ptr, iree_loop_t loop, iree_status_t status) {
+        IREE_EXPECT_STATUS_IS(IREE_STATUS_ABORTED, status);
+        iree_status_ignore(status);
+        *reinterpret_cast<bool*>(user_data_ptr) = true;
+        return iree_ok_status();
+      },
+      &did_abort));
+  IREE_EXPECT_STATUS_IS(IREE_STATUS_DEADLINE_EXCEEDED,
+                        iree_loop_drain(loop, iree_make_timeout_ms(10)));
+
+  DestroyThreadedLoop(threaded_loop);
+  EXPECT_TRUE(did_abort);
+  IREE_EXPECT_OK(loop_status);
+}
+
+// Tests that each wait resolves when only its own handle is signaled, that
+// duplicate waits on one handle both resolve, and that waits on unsignaled
+// handles stay pending.
+TEST(LoopThreadedTest, WaitsResolveIndependently) {
+  iree_status_t loop_status = iree_ok_status();
+  ThreadedLoop* threaded_loop =
+      CreateThreadedLoop(/*worker_count=*/2, &loop_status);
+  iree_loop_t loop = iree_loop_threaded_scope(&threaded_loop->scope);
+
+  static constexpr int kEventCount = 16;
+  iree_event_t events[kEventCount];
+  struct Waiter {
+    std::atomic<int> resolve_count = {0};
+  } waiters[kEventCount + 1];
+  auto callback = +[](void* user_data_ptr, iree_loop_t loop,
+                      iree_status_t status) {
+    IREE_EXPECT_OK(status);
+    ++reinterpret_cast<Waiter*>(user_data_ptr)->resolve_count;
+    return iree_ok_status();
+  };
+  for (int i = 0; i < kEventCount; ++i) {
+    IREE_ASSERT_OK(iree_event_initialize(/*initial_state=*/false, &events[i]));
+    IREE_ASSERT_OK(iree_loop_wait_one(loop, iree_event_await(&events[i]),
+                                      iree_make_timeout_ms(5000), callback,
+                                      &waiters[i]));
+  }
+  // A second wait on the first event shares its handle.
+  IREE_ASSERT_OK(iree_loop_wait_one(loop, iree_event_await(&events[0]),
+                                    iree_make_timeout_ms(5000), callback,
+                                    &waiters[kEventCount]));
+
+  // Signal in reverse order and ensure only the signaled waits resolve.
+  for (int i = kEventCount - 1; i >= 0; --i) {
+    iree_event_set(&events[i]);
+    while (waiters[i].resolve_count.load() == 0) std::this_thread::yield();
+    for (int j = 0; j < i; ++j) {
+      EXPECT_EQ(waiters[j].resolve_count.load(), 0) << j;
+    }
+  }
+  IREE_ASSERT_OK(iree_loop_drain(loop, iree_infinite_timeout()));
+  IREE_ASSERT_OK(loop_status);
+  for (int i = 0; i < kEventCount + 1; ++i) {
+    EXPECT_EQ(waiters[i].resolve_count.load(), 1) << i;
+  }
+
+  DestroyThreadedLoop(threaded_loop);
+  for (int i = 0; i < kEventCount; ++i) iree_event_deinitialize(&events[i]);
+}
+
+// Tests that aborted waits are removed from the poller before their callbacks
+// run so that callbacks may close the handles they were waiting on and new
+// handles reusing the same platform resources can be waited on.
+TEST(LoopThreadedTest, AbortedWaitHandlesMayBeClosed) {
+  iree_status_t loop_status = iree_ok_status();
+  ThreadedLoop* threaded_loop =
+      CreateThreadedLoop(/*worker_count=*/1, &loop_status);
+
+  iree_loop_threaded_scope_t scope;
+  iree_loop_threaded_scope_initialize(threaded_loop->loop_threaded,
+                                      /*error_fn=*/NULL,
+                                      /*error_user_data=*/NULL, &scope);
+  iree_event_t event;
+  IREE_ASSERT_OK(iree_event_initialize(/*initial_state=*/false, &event));
+  IREE_ASSERT_OK(iree_loop_wait_one(
+      iree_loop_threaded_scope(&scope), iree_event_await(&event),
+      iree_make_timeout_ms(5000),
+      +[](void* user_data_ptr, iree_loop_t loop, iree_status_t status) {
+        IREE_EXPECT_STATUS_IS(IREE_STATUS_ABORTED, status);
+        iree_status_ignore(status);
+        iree_event_deinitialize(reinterpret_cast<iree_event_t*>(user_data_ptr));
+        return iree_ok_status();
+      },
+      &event));
+  // Let the poller register the wait before aborting it.
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  iree_loop_threaded_scope_deinitialize(&scope);
+
+  // The new event will likely reuse the platform resources of the old one.
+  iree_event_t new_event;
+  IREE_ASSERT_OK(iree_event_initialize(/*initial_state=*/false, &new_event));
+  iree_loop_t loop = iree_loop_threaded_scope(&threaded_loop->scope);
+  std::atomic<bool> did_wait_callback = {false};
+  IREE_ASSERT_OK(iree_loop_wait_one(
+      loop, iree_event_await(&new_event), iree_make_timeout_ms(5000),
+      +[](void* user_data_ptr, iree_loop_t loop, iree_status_t status) {
+        IREE_EXPECT_OK(status);
+        *reinterpret_cast<std::atomic<bool>*>(user_data_ptr) = true;
+        return iree_ok_status();
+      },
+      &did_wait_callback));
+  iree_event_set(&new_event);
+  IREE_ASSERT_OK(iree_loop_drain(loop, iree_infinite_timeout()));
+  IREE_ASSERT_OK(loop_status);
+  EXPECT_TRUE(did_wait_callback);
+
+  DestroyThreadedLoop(threaded_loop);
+  iree_event_deinitialize(&new_event);
+}
+
+}  // namespace
+}  // namespace testing
+}  // namespace iree
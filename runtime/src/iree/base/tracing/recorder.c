@@ -0,0 +1,1168 @@
+// Copyright 2025 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <assert.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "iree/base/alignment.h"
+#include "iree/base/internal/atomics.h"
+#include "iree/base/internal/time.h"
+#include "iree/base/tracing.h"
+
+#if IREE_TRACING_RECORDER_SIGNAL
+#include <signal.h>
+#endif  // IREE_TRACING_RECORDER_SIGNAL
+
+// NOTE: threading support is optional.
+#if IREE_SYNCHRONIZATION_DISABLE_UNSAFE
+
+#define iree_thread_local
+#define iree_thread_id() 0
+
+#else
+
+#if defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 201102L) && \
+    !__STDC_NO_THREADS__
+#define iree_thread_local _Thread_local
+#elif defined(IREE_COMPILER_MSVC)
+#define iree_thread_local __declspec(thread)
+#else
+#define iree_thread_local
+#endif  // __STDC_NO_THREADS__
+
+#if defined(IREE_PLATFORM_ANDROID)
+#include <unistd.h>
+#define iree_thread_id() ((uint64_t)gettid())
+#elif defined(IREE_PLATFORM_APPLE)
+#include <pthread.h>
+#define iree_thread_id() ((uint64_t)pthread_mach_thread_np(pthread_self()))
+#elif defined(IREE_PLATFORM_LINUX)
+#include <sys/syscall.h>
+#include <unistd.h>
+#define iree_thread_id() ((uint64_t)syscall(__NR_gettid))
+#elif defined(IREE_PLATFORM_WINDOWS)
+#define iree_thread_id() ((uint64_t)GetCurrentThreadId())
+#else
+#define iree_thread_id() 0
+#endif  // IREE_PLATFORM_*
+
+#endif  // IREE_SYNCHRONIZATION_DISABLE_UNSAFE
+
+// Thread exit notifications used to retire the rings of exited threads.
+#if IREE_SYNCHRONIZATION_DISABLE_UNSAFE
+// No thread exit notification is required.
+#elif defined(IREE_PLATFORM_WINDOWS)
+#include <windows.h>
+#define IREE_TRACING_RECORDER_THREAD_EXIT_WIN32 1
+#else
+#include <pthread.h>
+#define IREE_TRACING_RECORDER_THREAD_EXIT_PTHREAD 1
+#endif  // IREE_SYNCHRONIZATION_DISABLE_UNSAFE
+
+// Signal-requested dumps are written by a dedicated thread woken through a
+// pipe. Without one they are only written by iree_tracing_recorder_flush.
+#if IREE_TRACING_RECORDER_SIGNAL && !IREE_SYNCHRONIZATION_DISABLE_UNSAFE
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <unistd.h>
+#define IREE_TRACING_RECORDER_DUMP_THREAD 1
+#endif  // IREE_TRACING_RECORDER_SIGNAL && !IREE_SYNCHRONIZATION_DISABLE_UNSAFE
+
+#if IREE_TRACING_FEATURES
+
+static_assert((IREE_TRACING_RECORDER_CAPACITY &
+               (IREE_TRACING_RECORDER_CAPACITY - 1)) == 0,
+              "recorder capacity must be a power of two");
+
+//===----------------------------------------------------------------------===//
+// Events and per-thread rings
+//===----------------------------------------------------------------------===//
+
+// Maximum zone nesting depth per thread. Zones beyond this depth are dropped.
+#define IREE_TRACING_RECORDER_MAX_DEPTH 128
+
+// Maximum number of unique dynamic strings interned per thread.
+#define IREE_TRACING_RECORDER_STRING_CAPACITY 1024
+
+// Total bytes of dynamic string storage per thread.
+#define IREE_TRACING_RECORDER_STRING_STORAGE_SIZE (32 * 1024)
+
+// Maximum length of a thread name.
+#define IREE_TRACING_RECORDER_MAX_THREAD_NAME_LENGTH 32
+
+// Storage for dynamic strings that could not be interned.
+#define IREE_TRACING_RECORDER_INLINE_NAME_LENGTH 24
+
+typedef enum iree_tracing_recorder_event_type_e {
+  IREE_TRACING_RECORDER_EVENT_ZONE = 0,
+  IREE_TRACING_RECORDER_EVENT_PLOT_I64,
+  IREE_TRACING_RECORDER_EVENT_PLOT_F64,
+  IREE_TRACING_RECORDER_EVENT_FRAME,
+  IREE_TRACING_RECORDER_EVENT_MESSAGE,
+  IREE_TRACING_RECORDER_EVENT_ALLOC,
+  IREE_TRACING_RECORDER_EVENT_FREE,
+  IREE_TRACING_RECORDER_EVENT_ZONE_VALUE,
+  IREE_TRACING_RECORDER_EVENT_ZONE_TEXT,
+} iree_tracing_recorder_event_type_t;
+
+// A dynamic or literal string referenced by an event or zone.
+// When |value| is NULL and |length| is non-zero the string was truncated and
+// copied into the inline storage of the event or zone.
+typedef struct iree_tracing_recorder_name_t {
+  const char* value;
+  uint16_t length;
+} iree_tracing_recorder_name_t;
+
+// A single fixed-size event (64 bytes on 64-bit platforms).
+typedef struct iree_tracing_recorder_event_t {
+  // Time the event was recorded. For zones this is the zone start time.
+  uint64_t timestamp_ns;
+  union {
+    uint64_t duration_ns;  // ZONE
+    int64_t i64;           // PLOT_I64, ZONE_VALUE
+    double f64;            // PLOT_F64
+    uint64_t size;         // ALLOC
+  } value;
+  // ZONE: iree_tracing_location_t or NULL for external zones.
+  // ALLOC/FREE: the allocation pointer.
+  const void* ptr;
+  // ZONE: dynamic name override (if any).
+  // PLOT/FRAME: name literal.
+  // MESSAGE/ZONE_TEXT: text.
+  // ALLOC/FREE: pool name.
+  const char* name;
+  uint8_t type;  // iree_tracing_recorder_event_type_t
+  // ZONE/ZONE_VALUE/ZONE_TEXT: depth of the zone. Values and text appended to
+  // a zone are recorded before the zone event with the same depth.
+  uint8_t depth;
+  uint16_t name_length;
+  // ZONE: source line. MESSAGE: color.
+  uint32_t line_or_color;
+  char inline_name[IREE_TRACING_RECORDER_INLINE_NAME_LENGTH];
+} iree_tracing_recorder_event_t;
+
+typedef struct iree_tracing_recorder_string_t {
+  uint32_t hash;
+  uint16_t length;
+  const char* value;
+} iree_tracing_recorder_string_t;
+
+// A single-producer ring of events owned by one thread.
+// The owning thread is the only writer and publishes events by advancing
+// |write_position| with release semantics. Readers snapshot the ring without
+// blocking the writer and discard any events that may have been overwritten
+// while they were copying (a seqlock keyed on the write position).
+//
+// When the owning thread exits the ring is retired and may be claimed by a new
+// thread. Claiming bumps |generation| so that readers racing with it can
+// discard their copy (as with the write position) and moves |start_position|
+// past the events of the previous owner.
+//
+// NOTE: the copy performed by readers intentionally races with the writer and
+// will be reported by thread sanitizers.
+typedef struct iree_tracing_recorder_thread_t {
+  // Next thread in the global list; immutable once published.
+  struct iree_tracing_recorder_thread_t* next;
+  // Set when the owning thread has exited and the ring can be claimed.
+  iree_atomic_int32_t retired;
+  // Incremented each time the ring is claimed by a new thread.
+  iree_atomic_int32_t generation;
+  // Position of the first event written by the current owner.
+  iree_atomic_int64_t start_position;
+  uint64_t thread_id;
+  char name[IREE_TRACING_RECORDER_MAX_THREAD_NAME_LENGTH];
+  // Total number of events ever written to the ring.
+  iree_alignas(iree_hardware_destructive_interference_size)
+      iree_atomic_int64_t write_position;
+  // Dynamic strings interned by the thread. Only accessed by the owner; the
+  // string storage is immutable once referenced by a published event.
+  iree_host_size_t string_count;
+  iree_tracing_recorder_string_t strings[IREE_TRACING_RECORDER_STRING_CAPACITY];
+  // Bump-allocated storage for the interned string values.
+  iree_host_size_t string_storage_used;
+  char string_storage[IREE_TRACING_RECORDER_STRING_STORAGE_SIZE];
+  iree_tracing_recorder_event_t events[IREE_TRACING_RECORDER_CAPACITY];
+} iree_tracing_recorder_thread_t;
+
+typedef struct iree_tracing_recorder_zone_t {
+  uint64_t start_timestamp_ns;
+  const iree_tracing_location_t* location;
+  iree_tracing_recorder_name_t name;
+  uint32_t line;
+  char inline_name[IREE_TRACING_RECORDER_INLINE_NAME_LENGTH];
+} iree_tracing_recorder_zone_t;
+
+typedef struct iree_tracing_recorder_thread_state_t {
+  // Lazily acquired ring. Retired when the thread exits.
+  iree_tracing_recorder_thread_t* ring;
+  bool ring_failed;
+  uint32_t depth;  // 0 = no zone open
+  iree_tracing_recorder_zone_t stack[IREE_TRACING_RECORDER_MAX_DEPTH];
+} iree_tracing_recorder_thread_state_t;
+static iree_thread_local iree_tracing_recorder_thread_state_t _thread = {0};
+
+typedef struct iree_tracing_recorder_t {
+  // Head of the iree_tracing_recorder_thread_t list. Rings are pushed with a
+  // CAS and never removed; rings of exited threads are reused instead.
+  iree_atomic_intptr_t thread_list_head;
+  // Set when a dump has been requested (usually by a signal).
+  iree_atomic_int32_t dump_requested;
+  // Set while a dump is in progress to prevent concurrent dumps.
+  iree_atomic_int32_t dump_active;
+} iree_tracing_recorder_t;
+
+// Global shared recorder. The rings are process-wide as with the console
+// provider so that apps do not need to manage a tracing context lifetime.
+static iree_tracing_recorder_t _recorder = {0};
+
+// Retires |ring| so that it can be claimed by another thread.
+static void iree_tracing_recorder_retire_ring(
+    iree_tracing_recorder_thread_t* ring) {
+  if (_thread.ring == ring) _thread.ring = NULL;
+  iree_atomic_store(&ring->retired, 1, iree_memory_order_release);
+}
+
+#if defined(IREE_TRACING_RECORDER_THREAD_EXIT_PTHREAD)
+
+static pthread_once_t iree_tracing_recorder_thread_exit_once =
+    PTHREAD_ONCE_INIT;
+static pthread_key_t iree_tracing_recorder_thread_exit_key;
+static bool iree_tracing_recorder_thread_exit_available = false;
+
+static void iree_tracing_recorder_thread_exit(void* arg) {
+  iree_tracing_recorder_retire_ring((iree_tracing_recorder_thread_t*)arg);
+}
+
+static void iree_tracing_recorder_thread_exit_initialize(void) {
+  iree_tracing_recorder_thread_exit_available =
+      pthread_key_create(&iree_tracing_recorder_thread_exit_key,
+                         iree_tracing_recorder_thread_exit) == 0;
+}
+
+static void iree_tracing_recorder_thread_exit_register(
+    iree_tracing_recorder_thread_t* ring) {
+  pthread_once(&iree_tracing_recorder_thread_exit_once,
+               iree_tracing_recorder_thread_exit_initialize);
+  if (iree_tracing_recorder_thread_exit_available) {
+    pthread_setspecific(iree_tracing_recorder_thread_exit_key, ring);
+  }
+}
+
+#elif defined(IREE_TRACING_RECORDER_THREAD_EXIT_WIN32)
+
+static INIT_ONCE iree_tracing_recorder_thread_exit_once = INIT_ONCE_STATIC_INIT;
+static DWORD iree_tracing_recorder_thread_exit_index = FLS_OUT_OF_INDEXES;
+
+static VOID WINAPI iree_tracing_recorder_thread_exit(PVOID arg) {
+  iree_tracing_recorder_retire_ring((iree_tracing_recorder_thread_t*)arg);
+}
+
+static BOOL CALLBACK iree_tracing_recorder_thread_exit_initialize(
+    PINIT_ONCE init_once, PVOID parameter, PVOID* context) {
+  (void)init_once;
+  (void)parameter;
+  (void)context;
+  iree_tracing_recorder_thread_exit_index =
+      FlsAlloc(iree_tracing_recorder_thread_exit);
+  return TRUE;
+}
+
+static void iree_tracing_recorder_thread_exit_register(
+    iree_tracing_recorder_thread_t* ring) {
+  InitOnceExecuteOnce(&iree_tracing_recorder_thread_exit_once,
+                      iree_tracing_recorder_thread_exit_initialize, NULL, NULL);
+  if (iree_tracing_recorder_thread_exit_index != FLS_OUT_OF_INDEXES) {
+    FlsSetValue(iree_tracing_recorder_thread_exit_index, ring);
+  }
+}
+
+#else
+
+static void iree_tracing_recorder_thread_exit_register(
+    iree_tracing_recorder_thread_t* ring) {
+  (void)ring;  // single-threaded
+}
+
+#endif  // IREE_TRACING_RECORDER_THREAD_EXIT_*
+
+// Claims the ring of an exited thread, if any.
+static iree_tracing_recorder_thread_t* iree_tracing_recorder_claim_ring(void) {
+  iree_tracing_recorder_thread_t* ring =
+      (iree_tracing_recorder_thread_t*)iree_atomic_load(
+          &_recorder.thread_list_head, iree_memory_order_acquire);
+  for (; ring; ring = ring->next) {
+    int32_t expected = 1;
+    if (!iree_atomic_load(&ring->retired, iree_memory_order_relaxed) ||
+        !iree_atomic_compare_exchange_strong(&ring->retired, &expected, 0,
+                                             iree_memory_order_acquire,
+                                             iree_memory_order_relaxed)) {
+      continue;
+    }
+    // Invalidate any in-progress reads before changing the owner and drop the
+    // events of the previous owner.
+    iree_atomic_fetch_add(&ring->generation, 1, iree_memory_order_relaxed);
+    iree_atomic_thread_fence(iree_memory_order_release);
+    iree_atomic_store(
+        &ring->start_position,
+        iree_atomic_load(&ring->write_position, iree_memory_order_relaxed),
+        iree_memory_order_relaxed);
+    memset(ring->name, 0, sizeof(ring->name));
+    return ring;
+  }
+  return NULL;
+}
+
+static iree_tracing_recorder_thread_t* iree_tracing_recorder_acquire_ring(
+    void) {
+  if (IREE_LIKELY(_thread.ring)) return _thread.ring;
+  if (_thread.ring_failed) return NULL;
+  iree_tracing_recorder_thread_t* ring = iree_tracing_recorder_claim_ring();
+  if (!ring) {
+    ring = (iree_tracing_recorder_thread_t*)calloc(1, sizeof(*ring));
+    if (!ring) {
+      _thread.ring_failed = true;
+      return NULL;
+    }
+    intptr_t head = iree_atomic_load(&_recorder.thread_list_head,
+                                     iree_memory_order_relaxed);
+    do {
+      ring->next = (iree_tracing_recorder_thread_t*)head;
+    } while (!iree_atomic_compare_exchange_weak(
+        &_recorder.thread_list_head, &head, (intptr_t)ring,
+        iree_memory_order_release, iree_memory_order_relaxed));
+  }
+  ring->thread_id = iree_thread_id();
+  iree_tracing_recorder_thread_exit_register(ring);
+  _thread.ring = ring;
+  return ring;
+}
+
+// Begins writing the next event in the ring. Must be followed by
+// iree_tracing_recorder_commit_event.
+static inline iree_tracing_recorder_event_t* iree_tracing_recorder_next_event(
+    iree_tracing_recorder_thread_t* ring, int64_t* out_position) {
+  const int64_t position =
+      iree_atomic_load(&ring->write_position, iree_memory_order_relaxed);
+  // Orders the publication of the previous position before the stores that
+  // overwrite the oldest event so readers can detect the overwrite.
+  iree_atomic_thread_fence(iree_memory_order_release);
+  *out_position = position;
+  return &ring->events[position & (IREE_TRACING_RECORDER_CAPACITY - 1)];
+}
+
+static inline void iree_tracing_recorder_commit_event(
+    iree_tracing_recorder_thread_t* ring, int64_t position) {
+  iree_atomic_store(&ring->write_position, position + 1,
+                    iree_memory_order_release);
+}
+
+static uint32_t iree_tracing_recorder_hash(const char* value, size_t length) {
+  // FNV-1a.
+  uint32_t hash = 2166136261u;
+  for (size_t i = 0; i < length; ++i) {
+    hash = (hash ^ (uint8_t)value[i]) * 16777619u;
+  }
+  return hash;
+}
+
+// Interns |value| in the thread string table and returns the persistent copy.
+// Returns NULL if the table or its storage is full.
+static const char* iree_tracing_recorder_intern(
+    iree_tracing_recorder_thread_t* ring, const char* value, uint16_t length) {
+  const uint32_t hash = iree_tracing_recorder_hash(value, length);
+  const iree_host_size_t mask = IREE_TRACING_RECORDER_STRING_CAPACITY - 1;
+  for (iree_host_size_t i = hash & mask;; i = (i + 1) & mask) {
+    iree_tracing_recorder_string_t* string = &ring->strings[i];
+    if (!string->value) break;
+    if (string->hash == hash && string->length == length &&
+        memcmp(string->value, value, length) == 0) {
+      return string->value;
+    }
+  }
+  // Keep the table at most 3/4 full to bound probe lengths.
+  if (ring->string_count >= IREE_TRACING_RECORDER_STRING_CAPACITY / 4 * 3 ||
+      length > IREE_ARRAYSIZE(ring->string_storage) -
+                   ring->string_storage_used) {
+    return NULL;
+  }
+  char* copy = ring->string_storage + ring->string_storage_used;
+  ring->string_storage_used += length;
+  memcpy(copy, value, length);
+  for (iree_host_size_t i = hash & mask;; i = (i + 1) & mask) {
+    iree_tracing_recorder_string_t* string = &ring->strings[i];
+    if (string->value) continue;
+    string->hash = hash;
+    string->length = length;
+    string->value = copy;
+    break;
+  }
+  ++ring->string_count;
+  return copy;
+}
+
+// Captures a dynamic string by interning it or truncating it into
+// |inline_name|.
+static iree_tracing_recorder_name_t iree_tracing_recorder_capture_name(
+    iree_tracing_recorder_thread_t* ring, const char* value, size_t length,
+    char inline_name[IREE_TRACING_RECORDER_INLINE_NAME_LENGTH]) {
+  iree_tracing_recorder_name_t name = {NULL, (uint16_t)iree_min(length,
+                                                                UINT16_MAX)};
+  name.value = iree_tracing_recorder_intern(ring, value, name.length);
+  if (!name.value) {
+    name.length = (uint16_t)iree_min(name.length,
+                                     IREE_TRACING_RECORDER_INLINE_NAME_LENGTH);
+    memcpy(inline_name, value, name.length);
+  }
+  return name;
+}
+
+//===----------------------------------------------------------------------===//
+// Recording
+//===----------------------------------------------------------------------===//
+
+#if defined(IREE_TRACING_RECORDER_DUMP_THREAD)
+
+// Write end of the pipe waking the dump thread or -1 if it was never created.
+// The pipe lives for the process lifetime so that signal handlers never write
+// to a closed descriptor. Bytes written while the thread is stopped are
+// drained when it is restarted.
+static iree_atomic_int32_t iree_tracing_recorder_dump_wake_fd =
+    IREE_ATOMIC_VAR_INIT(-1);
+static int iree_tracing_recorder_dump_read_fd = -1;
+static pthread_t iree_tracing_recorder_dump_thread;
+static bool iree_tracing_recorder_dump_thread_running = false;
+static iree_atomic_int32_t iree_tracing_recorder_dump_thread_exit =
+    IREE_ATOMIC_VAR_INIT(0);
+
+// Wakes the dump thread. Async-signal-safe.
+static void iree_tracing_recorder_wake_dump_thread(void) {
+  const int fd = iree_atomic_load(&iree_tracing_recorder_dump_wake_fd,
+                                  iree_memory_order_acquire);
+  if (fd < 0) return;
+  const int saved_errno = errno;
+  const char byte = 0;
+  // A full pipe already has a wake pending.
+  ssize_t result = write(fd, &byte, 1);
+  (void)result;
+  errno = saved_errno;
+}
+
+static void* iree_tracing_recorder_dump_thread_main(void* arg) {
+  (void)arg;
+  // Leave signals to the application threads.
+  sigset_t signals;
+  sigfillset(&signals);
+  pthread_sigmask(SIG_BLOCK, &signals, NULL);
+  for (;;) {
+    char buffer[16];
+    ssize_t result =
+        read(iree_tracing_recorder_dump_read_fd, buffer, sizeof(buffer));
+    if (result < 0 && errno == EINTR) continue;
+    if (result <= 0 || iree_atomic_load(&iree_tracing_recorder_dump_thread_exit,
+                                        iree_memory_order_acquire)) {
+      break;
+    }
+    iree_tracing_recorder_flush();
+  }
+  return NULL;
+}
+
+static void iree_tracing_recorder_start_dump_thread(void) {
+  if (iree_tracing_recorder_dump_thread_running) return;
+  if (iree_tracing_recorder_dump_read_fd < 0) {
+    int fds[2];
+    if (pipe(fds) != 0) return;
+    fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+    fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+    fcntl(fds[1], F_SETFL, fcntl(fds[1], F_GETFL) | O_NONBLOCK);
+    iree_tracing_recorder_dump_read_fd = fds[0];
+    iree_atomic_store(&iree_tracing_recorder_dump_wake_fd, fds[1],
+                      iree_memory_order_release);
+  }
+  iree_atomic_store(&iree_tracing_recorder_dump_thread_exit, 0,
+                    iree_memory_order_relaxed);
+  if (pthread_create(&iree_tracing_recorder_dump_thread, NULL,
+                     iree_tracing_recorder_dump_thread_main, NULL) != 0) {
+    return;
+  }
+  iree_tracing_recorder_dump_thread_running = true;
+  // Service any request made before the thread was started.
+  if (iree_atomic_load(&_recorder.dump_requested, iree_memory_order_relaxed)) {
+    iree_tracing_recorder_wake_dump_thread();
+  }
+}
+
+static void iree_tracing_recorder_stop_dump_thread(void) {
+  if (!iree_tracing_recorder_dump_thread_running) return;
+  iree_atomic_store(&iree_tracing_recorder_dump_thread_exit, 1,
+                    iree_memory_order_release);
+  iree_tracing_recorder_wake_dump_thread();
+  pthread_join(iree_tracing_recorder_dump_thread, NULL);
+  iree_tracing_recorder_dump_thread_running = false;
+}
+
+#else
+
+static void iree_tracing_recorder_wake_dump_thread(void) {}
+static void iree_tracing_recorder_start_dump_thread(void) {}
+static void iree_tracing_recorder_stop_dump_thread(void) {}
+
+#endif  // IREE_TRACING_RECORDER_DUMP_THREAD
+
+#if IREE_TRACING_RECORDER_SIGNAL
+static void iree_tracing_recorder_signal_handler(int signum) {
+  (void)signum;
+  iree_tracing_recorder_request_dump();
+}
+#endif  // IREE_TRACING_RECORDER_SIGNAL
+
+void iree_tracing_recorder_initialize() {
+  // Start the thread before installing the handler so that signals delivered
+  // immediately after are serviced.
+  iree_tracing_recorder_start_dump_thread();
+#if IREE_TRACING_RECORDER_SIGNAL
+  struct sigaction action;
+  memset(&action, 0, sizeof(action));
+  action.sa_handler = iree_tracing_recorder_signal_handler;
+  sigemptyset(&action.sa_mask);
+  action.sa_flags = SA_RESTART;
+  sigaction(IREE_TRACING_RECORDER_SIGNAL, &action, NULL);
+#endif  // IREE_TRACING_RECORDER_SIGNAL
+}
+
+void iree_tracing_recorder_deinitialize() {
+  iree_tracing_recorder_stop_dump_thread();
+  const char* path = getenv(IREE_TRACING_RECORDER_PATH_ENV);
+  if (path && path[0]) iree_tracing_recorder_dump(path);
+}
+
+void iree_tracing_recorder_request_dump(void) {
+  iree_atomic_store(&_recorder.dump_requested, 1, iree_memory_order_relaxed);
+  iree_tracing_recorder_wake_dump_thread();
+}
+
+bool iree_tracing_recorder_flush(void) {
+  if (!iree_atomic_exchange(&_recorder.dump_requested, 0,
+                            iree_memory_order_relaxed)) {
+    return true;
+  }
+  const char* path = getenv(IREE_TRACING_RECORDER_PATH_ENV);
+  if (!path || !path[0]) path = IREE_TRACING_RECORDER_DEFAULT_PATH;
+  return iree_tracing_recorder_dump(path);
+}
+
+void iree_tracing_set_thread_name(const char* name) {
+  iree_tracing_recorder_thread_t* ring = iree_tracing_recorder_acquire_ring();
+  if (!ring) return;
+  size_t name_length = iree_min(strlen(name), IREE_ARRAYSIZE(ring->name) - 1);
+  memcpy(ring->name, name, name_length);
+  ring->name[name_length] = 0;
+}
+
+static iree_zone_id_t iree_tracing_recorder_zone_begin(
+    const iree_tracing_location_t* location, uint32_t line, const char* name,
+    size_t name_length) {
+  iree_tracing_recorder_thread_t* ring = iree_tracing_recorder_acquire_ring();
+  if (!ring || _thread.depth + 1 >= IREE_ARRAYSIZE(_thread.stack)) return 0;
+  iree_zone_id_t zone_id = ++_thread.depth;
+  iree_tracing_recorder_zone_t* zone = &_thread.stack[zone_id];
+  zone->location = location;
+  zone->line = line;
+  if (name) {
+    zone->name = iree_tracing_recorder_capture_name(ring, name, name_length,
+                                                    zone->inline_name);
+  } else {
+    zone->name = (iree_tracing_recorder_name_t){NULL, 0};
+  }
+  // Capture the timestamp last so that we don't measure too much of ourselves.
+  zone->start_timestamp_ns = iree_platform_time_now();
+  return zone_id;
+}
+
+IREE_MUST_USE_RESULT iree_zone_id_t
+iree_tracing_zone_begin_impl(const iree_tracing_location_t* src_loc,
+                             const char* name, size_t name_length) {
+  return iree_tracing_recorder_zone_begin(src_loc, src_loc->line, name,
+                                          name_length);
+}
+
+IREE_MUST_USE_RESULT iree_zone_id_t iree_tracing_zone_begin_external_impl(
+    const char* file_name, size_t file_name_length, uint32_t line,
+    const char* function_name, size_t function_name_length, const char* name,
+    size_t name_length) {
+  // Use the function name for display if no override was provided.
+  if (!name) {
+    name = function_name;
+    name_length = function_name_length;
+  }
+  return iree_tracing_recorder_zone_begin(NULL, line, name, name_length);
+}
+
+void iree_tracing_zone_end(iree_zone_id_t zone_id) {
+  if (!zone_id) return;
+  // Capture timestamp first so that we don't measure too much of ourselves.
+  const uint64_t end_timestamp_ns = iree_platform_time_now();
+
+  assert(_thread.depth == zone_id);
+  iree_tracing_recorder_zone_t* zone = &_thread.stack[zone_id];
+  iree_tracing_recorder_thread_t* ring = _thread.ring;
+  if (IREE_UNLIKELY(!ring)) {
+    // The ring was retired by thread exit while the zone was open.
+    --_thread.depth;
+    return;
+  }
+  int64_t position = 0;
+  iree_tracing_recorder_event_t* event =
+      iree_tracing_recorder_next_event(ring, &position);
+  event->timestamp_ns = zone->start_timestamp_ns;
+  event->value.duration_ns = end_timestamp_ns - zone->start_timestamp_ns;
+  event->ptr = zone->location;
+  event->name = zone->name.value;
+  event->type = IREE_TRACING_RECORDER_EVENT_ZONE;
+  event->depth = (uint8_t)(zone_id - 1);
+  event->name_length = zone->name.length;
+  event->line_or_color = zone->line;
+  if (!zone->name.value && zone->name.length) {
+    memcpy(event->inline_name, zone->inline_name, zone->name.length);
+  }
+  iree_tracing_recorder_commit_event(ring, position);
+  --_thread.depth;
+}
+
+// Records a value or text appended to the open zone |zone_id|.
+static void iree_tracing_recorder_zone_append(
+    iree_zone_id_t zone_id, iree_tracing_recorder_event_type_t type,
+    int64_t value, const char* text, size_t text_length) {
+  iree_tracing_recorder_thread_t* ring = _thread.ring;
+  if (!zone_id || !ring) return;
+  int64_t position = 0;
+  iree_tracing_recorder_event_t* event =
+      iree_tracing_recorder_next_event(ring, &position);
+  event->timestamp_ns = _thread.stack[zone_id].start_timestamp_ns;
+  event->value.i64 = value;
+  event->ptr = NULL;
+  event->type = (uint8_t)type;
+  event->depth = (uint8_t)(zone_id - 1);
+  event->line_or_color = 0;
+  if (text) {
+    iree_tracing_recorder_name_t captured = iree_tracing_recorder_capture_name(
+        ring, text, text_length, event->inline_name);
+    event->name = captured.value;
+    event->name_length = captured.length;
+  } else {
+    event->name = NULL;
+    event->name_length = 0;
+  }
+  iree_tracing_recorder_commit_event(ring, position);
+}
+
+void iree_tracing_zone_append_value_i64(iree_zone_id_t zone_id, int64_t value) {
+  iree_tracing_recorder_zone_append(zone_id,
+                                    IREE_TRACING_RECORDER_EVENT_ZONE_VALUE,
+                                    value, NULL, 0);
+}
+
+void iree_tracing_zone_append_text_string_view(iree_zone_id_t zone_id,
+                                               const char* value,
+                                               size_t value_length) {
+  iree_tracing_recorder_zone_append(
+      zone_id, IREE_TRACING_RECORDER_EVENT_ZONE_TEXT, 0, value, value_length);
+}
+
+static void iree_tracing_recorder_record(
+    iree_tracing_recorder_event_type_t type, const void* ptr, const char* name,
+    size_t name_length, uint32_t line_or_color, uint64_t value_bits,
+    bool copy_name) {
+  iree_tracing_recorder_thread_t* ring = iree_tracing_recorder_acquire_ring();
+  if (!ring) return;
+  const uint64_t timestamp_ns = iree_platform_time_now();
+  int64_t position = 0;
+  iree_tracing_recorder_event_t* event =
+      iree_tracing_recorder_next_event(ring, &position);
+  event->timestamp_ns = timestamp_ns;
+  event->value.size = value_bits;
+  event->ptr = ptr;
+  event->type = (uint8_t)type;
+  event->depth = (uint8_t)_thread.depth;
+  event->line_or_color = line_or_color;
+  if (copy_name) {
+    iree_tracing_recorder_name_t captured = iree_tracing_recorder_capture_name(
+        ring, name, name_length, event->inline_name);
+    event->name = captured.value;
+    event->name_length = captured.length;
+  } else {
+    event->name = name;
+    event->name_length = (uint16_t)iree_min(name_length, UINT16_MAX);
+  }
+  iree_tracing_recorder_commit_event(ring, position);
+}
+
+void iree_tracing_plot_value_i64(const char* name_literal, int64_t value) {
+  iree_tracing_recorder_record(IREE_TRACING_RECORDER_EVENT_PLOT_I64, NULL,
+                               name_literal, strlen(name_literal), 0,
+                               (uint64_t)value, /*copy_name=*/false);
+}
+
+void iree_tracing_plot_value_f64(const char* name_literal, double value) {
+  uint64_t value_bits = 0;
+  memcpy(&value_bits, &value, sizeof(value_bits));
+  iree_tracing_recorder_record(IREE_TRACING_RECORDER_EVENT_PLOT_F64, NULL,
+                               name_literal, strlen(name_literal), 0,
+                               value_bits, /*copy_name=*/false);
+}
+
+void iree_tracing_frame_mark(const char* name_literal) {
+  if (!name_literal) name_literal = "frame";
+  iree_tracing_recorder_record(IREE_TRACING_RECORDER_EVENT_FRAME, NULL,
+                               name_literal, strlen(name_literal), 0, 0,
+                               /*copy_name=*/false);
+}
+
+void iree_tracing_message_cstring(const char* value, uint32_t color) {
+  iree_tracing_message_string_view(value, strlen(value), color);
+}
+
+void iree_tracing_message_string_view(const char* value, size_t value_length,
+                                      uint32_t color) {
+  iree_tracing_recorder_record(IREE_TRACING_RECORDER_EVENT_MESSAGE, NULL,
+                               value, value_length, color, 0,
+                               /*copy_name=*/true);
+}
+
+void iree_tracing_memory_alloc(const char* name, size_t name_length, void* ptr,
+                               size_t size) {
+  iree_tracing_recorder_record(IREE_TRACING_RECORDER_EVENT_ALLOC, ptr, name,
+                               name_length, 0, (uint64_t)size,
+                               /*copy_name=*/false);
+}
+
+void iree_tracing_memory_free(const char* name, size_t name_length, void* ptr) {
+  iree_tracing_recorder_record(IREE_TRACING_RECORDER_EVENT_FREE, ptr, name,
+                               name_length, 0, 0, /*copy_name=*/false);
+}
+
+//===----------------------------------------------------------------------===//
+// Chrome trace event export
+//===----------------------------------------------------------------------===//
+// https://docs.google.com/document/d/1CvAClvFfyA5R-PhYUmn5OOQtYMH4h6I0nSsKchNAySU
+
+// An allocation or free gathered from all threads so that live memory can be
+// computed in timestamp order.
+typedef struct iree_tracing_recorder_memory_event_t {
+  uint64_t timestamp_ns;
+  uint64_t size;
+  const void* ptr;
+  iree_tracing_recorder_name_t pool;
+  bool is_alloc;
+} iree_tracing_recorder_memory_event_t;
+
+typedef struct iree_tracing_recorder_pool_t {
+  iree_tracing_recorder_name_t name;
+  int64_t live_size;
+} iree_tracing_recorder_pool_t;
+
+typedef struct iree_tracing_recorder_allocation_t {
+  const void* ptr;  // NULL if empty; ~0 if deleted
+  uint64_t size;
+  iree_host_size_t pool_index;
+} iree_tracing_recorder_allocation_t;
+
+#define IREE_TRACING_RECORDER_MAX_POOLS 32
+#define IREE_TRACING_RECORDER_DELETED_PTR ((const void*)~(uintptr_t)0)
+
+typedef struct iree_tracing_recorder_export_t {
+  FILE* file;
+  bool needs_separator;
+  // Event snapshot of the ring being exported.
+  iree_tracing_recorder_event_t* snapshot;
+  // Position of the first value or text appended to the open zone at each
+  // depth of the ring being exported, or -1 if none.
+  int64_t zone_args_start[IREE_TRACING_RECORDER_MAX_DEPTH];
+  // Allocations and frees from all threads.
+  iree_tracing_recorder_memory_event_t* memory_events;
+  iree_host_size_t memory_event_count;
+  iree_host_size_t memory_event_capacity;
+} iree_tracing_recorder_export_t;
+
+static void iree_tracing_recorder_write_escaped(FILE* file, const char* value,
+                                                size_t length) {
+  for (size_t i = 0; i < length; ++i) {
+    const unsigned char c = (unsigned char)value[i];
+    if (c == '"' || c == '\\') {
+      fputc('\\', file);
+      fputc(c, file);
+    } else if (c < 0x20) {
+      fprintf(file, "\\u%04x", c);
+    } else {
+      fputc(c, file);
+    }
+  }
+}
+
+static void iree_tracing_recorder_write_string(FILE* file, const char* value,
+                                               size_t length) {
+  fputc('"', file);
+  iree_tracing_recorder_write_escaped(file, value, length);
+  fputc('"', file);
+}
+
+static void iree_tracing_recorder_write_name(
+    FILE* file, const iree_tracing_recorder_event_t* event) {
+  if (event->name) {
+    iree_tracing_recorder_write_string(file, event->name, event->name_length);
+  } else {
+    iree_tracing_recorder_write_string(file, event->inline_name,
+                                       event->name_length);
+  }
+}
+
+// Writes the common prefix of an event object up to the name.
+static void iree_tracing_recorder_begin_event(
+    iree_tracing_recorder_export_t* state, char phase, uint64_t thread_id,
+    uint64_t timestamp_ns) {
+  fprintf(state->file, "%s\n{\"ph\":\"%c\",\"pid\":1,\"tid\":%" PRIu64,
+          state->needs_separator ? "," : "", phase, thread_id);
+  fprintf(state->file, ",\"ts\":%" PRIu64 ".%03u", timestamp_ns / 1000,
+          (unsigned)(timestamp_ns % 1000));
+  fputs(",\"name\":", state->file);
+  state->needs_separator = true;
+}
+
+static const char* iree_tracing_recorder_trim_file_path(
+    const char* file_name, size_t file_name_length, size_t* out_length) {
+  for (size_t i = file_name_length; i > 0; --i) {
+    char c = file_name[i - 1];
+    if (c == '/' || c == '\\') {
+      *out_length = file_name_length - i;
+      return file_name + i;
+    }
+  }
+  *out_length = file_name_length;
+  return file_name;
+}
+
+// Writes the values or text of |type| appended to the zone ending at
+// |position| as a JSON array argument named |key|.
+static void iree_tracing_recorder_write_zone_args(
+    iree_tracing_recorder_export_t* state, int64_t position,
+    iree_tracing_recorder_event_type_t type, const char* key) {
+  const iree_tracing_recorder_event_t* zone_event =
+      &state->snapshot[position & (IREE_TRACING_RECORDER_CAPACITY - 1)];
+  const int64_t start = state->zone_args_start[zone_event->depth];
+  if (start < 0) return;
+  bool first = true;
+  for (int64_t i = start; i < position; ++i) {
+    const iree_tracing_recorder_event_t* event =
+        &state->snapshot[i & (IREE_TRACING_RECORDER_CAPACITY - 1)];
+    if (event->type != type || event->depth != zone_event->depth) continue;
+    if (first) {
+      fprintf(state->file, "\"%s\":[", key);
+      first = false;
+    } else {
+      fputc(',', state->file);
+    }
+    if (type == IREE_TRACING_RECORDER_EVENT_ZONE_VALUE) {
+      fprintf(state->file, "%" PRId64, event->value.i64);
+    } else {
+      iree_tracing_recorder_write_name(state->file, event);
+    }
+  }
+  if (!first) fputs("],", state->file);
+}
+
+static void iree_tracing_recorder_write_zone(
+    iree_tracing_recorder_export_t* state, uint64_t thread_id,
+    int64_t position) {
+  const iree_tracing_recorder_event_t* event =
+      &state->snapshot[position & (IREE_TRACING_RECORDER_CAPACITY - 1)];
+  FILE* file = state->file;
+  const iree_tracing_location_t* location =
+      (const iree_tracing_location_t*)event->ptr;
+  iree_tracing_recorder_begin_event(state, 'X', thread_id,
+                                    event->timestamp_ns);
+  if (event->name_length) {
+    iree_tracing_recorder_write_name(file, event);
+  } else if (location && location->name) {
+    iree_tracing_recorder_write_string(file, location->name,
+                                       location->name_length);
+  } else if (location) {
+    iree_tracing_recorder_write_string(file, location->function_name,
+                                       location->function_name_length);
+  } else {
+    iree_tracing_recorder_write_string(file, "<unknown>", 9);
+  }
+  fprintf(file, ",\"dur\":%" PRIu64 ".%03u,\"args\":{",
+          event->value.duration_ns / 1000,
+          (unsigned)(event->value.duration_ns % 1000));
+  iree_tracing_recorder_write_zone_args(
+      state, position, IREE_TRACING_RECORDER_EVENT_ZONE_VALUE, "values");
+  iree_tracing_recorder_write_zone_args(
+      state, position, IREE_TRACING_RECORDER_EVENT_ZONE_TEXT, "text");
+  state->zone_args_start[event->depth] = -1;
+  if (location) {
+    size_t file_name_length = 0;
+    const char* file_name = iree_tracing_recorder_trim_file_path(
+        location->file_name, location->file_name_length, &file_name_length);
+    fputs("\"file\":", file);
+    iree_tracing_recorder_write_string(file, file_name, file_name_length);
+    fputc(',', file);
+  }
+  fprintf(file, "\"line\":%u}}", event->line_or_color);
+}
+
+static void iree_tracing_recorder_append_memory_event(
+    iree_tracing_recorder_export_t* state,
+    const iree_tracing_recorder_event_t* event) {
+  if (state->memory_event_count == state->memory_event_capacity) {
+    iree_host_size_t new_capacity =
+        iree_max(1024, state->memory_event_capacity * 2);
+    iree_tracing_recorder_memory_event_t* new_events =
+        (iree_tracing_recorder_memory_event_t*)realloc(
+            state->memory_events, new_capacity * sizeof(*new_events));
+    if (!new_events) return;
+    state->memory_events = new_events;
+    state->memory_event_capacity = new_capacity;
+  }
+  iree_tracing_recorder_memory_event_t* memory_event =
+      &state->memory_events[state->memory_event_count++];
+  memory_event->timestamp_ns = event->timestamp_ns;
+  memory_event->size = event->value.size;
+  memory_event->ptr = event->ptr;
+  memory_event->pool.value = event->name;
+  memory_event->pool.length = event->name_length;
+  memory_event->is_alloc = event->type == IREE_TRACING_RECORDER_EVENT_ALLOC;
+}
+
+static void iree_tracing_recorder_export_thread(
+    iree_tracing_recorder_export_t* state,
+    iree_tracing_recorder_thread_t* ring) {
+  FILE* file = state->file;
+
+  // Snapshot the ring and then discard anything that may have been overwritten
+  // while copying. If the ring was claimed by a new thread while copying the
+  // owner may not match the events and the ring is skipped.
+  const int32_t generation =
+      iree_atomic_load(&ring->generation, iree_memory_order_acquire);
+  const uint64_t thread_id = ring->thread_id;
+  char thread_name[IREE_TRACING_RECORDER_MAX_THREAD_NAME_LENGTH];
+  memcpy(thread_name, ring->name, sizeof(thread_name));
+  thread_name[sizeof(thread_name) - 1] = 0;
+  const int64_t end =
+      iree_atomic_load(&ring->write_position, iree_memory_order_acquire);
+  int64_t start = iree_max(
+      iree_atomic_load(&ring->start_position, iree_memory_order_relaxed),
+      end - IREE_TRACING_RECORDER_CAPACITY);
+  for (int64_t i = start; i < end; ++i) {
+    memcpy(&state->snapshot[i & (IREE_TRACING_RECORDER_CAPACITY - 1)],
+           &ring->events[i & (IREE_TRACING_RECORDER_CAPACITY - 1)],
+           sizeof(*state->snapshot));
+  }
+  iree_atomic_thread_fence(iree_memory_order_acquire);
+  const int64_t overwrite_end =
+      iree_atomic_load(&ring->write_position, iree_memory_order_relaxed);
+  start = iree_max(start, overwrite_end - IREE_TRACING_RECORDER_CAPACITY + 1);
+  if (iree_atomic_load(&ring->generation, iree_memory_order_relaxed) !=
+      generation) {
+    return;
+  }
+
+  iree_tracing_recorder_begin_event(state, 'M', thread_id, 0);
+  fputs("\"thread_name\",\"args\":{\"name\":", file);
+  if (thread_name[0]) {
+    iree_tracing_recorder_write_string(file, thread_name, strlen(thread_name));
+  } else {
+    fprintf(file, "\"thread %" PRIu64 "\"", thread_id);
+  }
+  fputs("}}", file);
+
+  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(state->zone_args_start);
+       ++i) {
+    state->zone_args_start[i] = -1;
+  }
+  for (int64_t i = start; i < end; ++i) {
+    const iree_tracing_recorder_event_t* event =
+        &state->snapshot[i & (IREE_TRACING_RECORDER_CAPACITY - 1)];
+    switch (event->type) {
+      case IREE_TRACING_RECORDER_EVENT_ZONE:
+        iree_tracing_recorder_write_zone(state, thread_id, i);
+        break;
+      case IREE_TRACING_RECORDER_EVENT_ZONE_VALUE:
+      case IREE_TRACING_RECORDER_EVENT_ZONE_TEXT:
+        if (state->zone_args_start[event->depth] < 0) {
+          state->zone_args_start[event->depth] = i;
+        }
+        break;
+      case IREE_TRACING_RECORDER_EVENT_PLOT_I64:
+        iree_tracing_recorder_begin_event(state, 'C', thread_id,
+                                          event->timestamp_ns);
+        iree_tracing_recorder_write_name(file, event);
+        fprintf(file, ",\"args\":{\"value\":%" PRId64 "}}", event->value.i64);
+        break;
+      case IREE_TRACING_RECORDER_EVENT_PLOT_F64:
+        iree_tracing_recorder_begin_event(state, 'C', thread_id,
+                                          event->timestamp_ns);
+        iree_tracing_recorder_write_name(file, event);
+        fprintf(file, ",\"args\":{\"value\":%.17g}}", event->value.f64);
+        break;
+      case IREE_TRACING_RECORDER_EVENT_FRAME:
+        iree_tracing_recorder_begin_event(state, 'i', thread_id,
+                                          event->timestamp_ns);
+        iree_tracing_recorder_write_name(file, event);
+        fputs(",\"s\":\"g\"}", file);
+        break;
+      case IREE_TRACING_RECORDER_EVENT_MESSAGE:
+        iree_tracing_recorder_begin_event(state, 'i', thread_id,
+                                          event->timestamp_ns);
+        iree_tracing_recorder_write_name(file, event);
+        fprintf(file, ",\"s\":\"t\",\"args\":{\"color\":\"#%06x\"}}",
+                event->line_or_color & 0xFFFFFFu);
+        break;
+      case IREE_TRACING_RECORDER_EVENT_ALLOC:
+      case IREE_TRACING_RECORDER_EVENT_FREE:
+        iree_tracing_recorder_append_memory_event(state, event);
+        break;
+      default:
+        break;
+    }
+  }
+}
+
+static int iree_tracing_recorder_compare_memory_events(const void* a,
+                                                       const void* b) {
+  const iree_tracing_recorder_memory_event_t* lhs =
+      (const iree_tracing_recorder_memory_event_t*)a;
+  const iree_tracing_recorder_memory_event_t* rhs =
+      (const iree_tracing_recorder_memory_event_t*)b;
+  if (lhs->timestamp_ns != rhs->timestamp_ns) {
+    return lhs->timestamp_ns < rhs->timestamp_ns ? -1 : 1;
+  }
+  // Frees before allocs so that reuse of a pointer at the same timestamp is
+  // tracked correctly.
+  return (int)lhs->is_alloc - (int)rhs->is_alloc;
+}
+
+static iree_host_size_t iree_tracing_recorder_lookup_pool(
+    iree_tracing_recorder_pool_t* pools, iree_host_size_t* pool_count,
+    iree_tracing_recorder_name_t name) {
+  for (iree_host_size_t i = 0; i < *pool_count; ++i) {
+    if (pools[i].name.length == name.length &&
+        memcmp(pools[i].name.value, name.value, name.length) == 0) {
+      return i;
+    }
+  }
+  if (*pool_count == IREE_TRACING_RECORDER_MAX_POOLS) return *pool_count - 1;
+  pools[*pool_count].name = name;
+  pools[*pool_count].live_size = 0;
+  return (*pool_count)++;
+}
+
+// Emits a counter per pool tracking the live bytes allocated within the
+// exported window. Frees of allocations made before the window are ignored.
+static void iree_tracing_recorder_export_memory(
+    iree_tracing_recorder_export_t* state) {
+  if (!state->memory_event_count) return;
+  qsort(state->memory_events, state->memory_event_count,
+        sizeof(*state->memory_events),
+        iree_tracing_recorder_compare_memory_events);
+
+  iree_host_size_t table_capacity = 16;
+  while (table_capacity < state->memory_event_count * 2) table_capacity *= 2;
+  iree_tracing_recorder_allocation_t* table =
+      (iree_tracing_recorder_allocation_t*)calloc(table_capacity,
+                                                  sizeof(*table));
+  if (!table) return;
+  const iree_host_size_t mask = table_capacity - 1;
+
+  iree_tracing_recorder_pool_t pools[IREE_TRACING_RECORDER_MAX_POOLS];
+  iree_host_size_t pool_count = 0;
+  for (iree_host_size_t i = 0; i < state->memory_event_count; ++i) {
+    const iree_tracing_recorder_memory_event_t* event =
+        &state->memory_events[i];
+    if (!event->ptr) continue;
+    const iree_host_size_t hash = (iree_host_size_t)(
+        ((uintptr_t)event->ptr >> 4) * 0x9E3779B97F4A7C15ull);
+    iree_tracing_recorder_allocation_t* slot = NULL;
+    iree_tracing_recorder_allocation_t* free_slot = NULL;
+    for (iree_host_size_t j = hash & mask;; j = (j + 1) & mask) {
+      if (table[j].ptr == event->ptr) {
+        slot = &table[j];
+        break;
+      } else if (table[j].ptr == IREE_TRACING_RECORDER_DELETED_PTR) {
+        if (!free_slot) free_slot = &table[j];
+      } else if (!table[j].ptr) {
+        if (!free_slot) free_slot = &table[j];
+        break;
+      }
+    }
+    iree_host_size_t pool_index = 0;
+    if (event->is_alloc) {
+      if (slot) {
+        // Missed free; replace the previous allocation.
+        pools[slot->pool_index].live_size -= slot->size;
+      } else {
+        slot = free_slot;
+      }
+      pool_index =
+          iree_tracing_recorder_lookup_pool(pools, &pool_count, event->pool);
+      slot->ptr = event->ptr;
+      slot->size = event->size;
+      slot->pool_index = pool_index;
+      pools[pool_index].live_size += event->size;
+    } else {
+      if (!slot) continue;
+      pool_index = slot->pool_index;
+      pools[pool_index].live_size -= slot->size;
+      slot->ptr = IREE_TRACING_RECORDER_DELETED_PTR;
+    }
+    iree_tracing_recorder_begin_event(state, 'C', 0, event->timestamp_ns);
+    fputs("\"memory:", state->file);
+    iree_tracing_recorder_write_escaped(state->file,
+                                        pools[pool_index].name.value,
+                                        pools[pool_index].name.length);
+    fprintf(state->file, "\",\"args\":{\"bytes\":%" PRId64 "}}",
+            pools[pool_index].live_size);
+  }
+  free(table);
+}
+
+bool iree_tracing_recorder_dump(const char* path) {
+  int32_t expected = 0;
+  if (!iree_atomic_compare_exchange_strong(&_recorder.dump_active, &expected, 1,
+                                           iree_memory_order_acquire,
+                                           iree_memory_order_relaxed)) {
+    return false;
+  }
+
+  bool ok = false;
+  iree_tracing_recorder_export_t state;
+  memset(&state, 0, sizeof(state));
+  state.snapshot = (iree_tracing_recorder_event_t*)malloc(
+      IREE_TRACING_RECORDER_CAPACITY * sizeof(*state.snapshot));
+  state.file = state.snapshot ? fopen(path, "wb") : NULL;
+  if (state.file) {
+    fputs("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[", state.file);
+    iree_tracing_recorder_thread_t* ring =
+        (iree_tracing_recorder_thread_t*)iree_atomic_load(
+            &_recorder.thread_list_head, iree_memory_order_acquire);
+    for (; ring; ring = ring->next) {
+      iree_tracing_recorder_export_thread(&state, ring);
+    }
+    iree_tracing_recorder_export_memory(&state);
+    fputs("\n]}\n", state.file);
+    ok = !ferror(state.file);
+    ok = fclose(state.file) == 0 && ok;
+  }
+  free(state.memory_events);
+  free(state.snapshot);
+
+  iree_atomic_store(&_recorder.dump_active, 0, iree_memory_order_release);
+  return ok;
+}
+
+#endif  // IREE_TRACING_FEATURES
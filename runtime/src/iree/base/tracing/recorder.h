@@ -0,0 +1,364 @@
+// Copyright 2025 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "iree/base/attributes.h"
+#include "iree/base/config.h"
+
+#ifndef IREE_BASE_TRACING_RECORDER_H_
+#define IREE_BASE_TRACING_RECORDER_H_
+
+//===----------------------------------------------------------------------===//
+// Recorder tracing configuration
+//===----------------------------------------------------------------------===//
+// The recorder is a low-overhead in-process "flight recorder": each thread
+// appends fixed-size binary events to its own ring buffer with no locks and no
+// formatting. When full the oldest events are overwritten such that the ring
+// always contains the most recent window of activity. The rings are only
+// decoded when a dump is requested via iree_tracing_recorder_dump, the dump
+// signal, or at application exit, and are written as a Chrome trace event JSON
+// file that can be loaded in https://ui.perfetto.dev or chrome://tracing.
+//
+// Zones are recorded as a single event when they end and zones that are still
+// open at the time of a dump are not included. Values and text appended to a
+// zone are recorded as they are appended and exported as arguments of the zone.
+// Zones, plots, frame marks, messages, and allocations are supported.
+//
+// Rings are allocated on the first event recorded by a thread. When a thread
+// exits its ring is retained (so that its history remains available to dumps)
+// until a newly started thread claims it, bounding memory usage to the peak
+// number of concurrently recording threads.
+
+// Filter to only supported features.
+#if !defined(IREE_TRACING_FEATURES)
+#define IREE_TRACING_FEATURES                                                  \
+  ((IREE_TRACING_FEATURES_REQUESTED) &                                         \
+   (IREE_TRACING_FEATURE_INSTRUMENTATION | IREE_TRACING_FEATURE_LOG_MESSAGES | \
+    IREE_TRACING_FEATURE_ALLOCATION_TRACKING))
+#endif  // !IREE_TRACING_FEATURES
+
+// Number of events retained per thread. Must be a power of two. Each event is
+// 64 bytes on 64-bit platforms and the ring is allocated on the first event
+// recorded by a thread.
+#if !defined(IREE_TRACING_RECORDER_CAPACITY)
+#define IREE_TRACING_RECORDER_CAPACITY (16 * 1024)
+#endif  // !IREE_TRACING_RECORDER_CAPACITY
+
+// Environment variable specifying the path that signal- and exit-triggered
+// dumps are written to. When set a dump is also written at application exit.
+#if !defined(IREE_TRACING_RECORDER_PATH_ENV)
+#define IREE_TRACING_RECORDER_PATH_ENV "IREE_TRACING_RECORDER_PATH"
+#endif  // !IREE_TRACING_RECORDER_PATH_ENV
+
+// Path used for signal-triggered dumps when the environment variable is unset.
+#if !defined(IREE_TRACING_RECORDER_DEFAULT_PATH)
+#define IREE_TRACING_RECORDER_DEFAULT_PATH "iree_trace.json"
+#endif  // !IREE_TRACING_RECORDER_DEFAULT_PATH
+
+// Signal that requests a dump on platforms supporting POSIX signals (for
+// example `kill -USR2 <pid>`). The dump is written by a dedicated thread
+// started by IREE_TRACE_APP_ENTER so that no file IO happens inside of the
+// signal handler or on application threads. Builds without threading support
+// must call iree_tracing_recorder_flush to write requested dumps.
+// Define to 0 to disable installing the signal handler.
+#if !defined(IREE_TRACING_RECORDER_SIGNAL)
+#if defined(IREE_PLATFORM_ANDROID) || defined(IREE_PLATFORM_APPLE) || \
+    defined(IREE_PLATFORM_LINUX)
+#include <signal.h>  // must precede any #if on the signal number
+#define IREE_TRACING_RECORDER_SIGNAL SIGUSR2
+#else
+#define IREE_TRACING_RECORDER_SIGNAL 0
+#endif  // IREE_PLATFORM_*
+#endif  // !IREE_TRACING_RECORDER_SIGNAL
+
+//===----------------------------------------------------------------------===//
+// C API used for tracing control
+//===----------------------------------------------------------------------===//
+
+// Local zone ID used for the C IREE_TRACE_ZONE_* macros.
+typedef uint32_t iree_zone_id_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+#if IREE_TRACING_FEATURES
+
+// Writes the current contents of all thread rings to |path| as a Chrome trace
+// event JSON file. Recording continues on all threads while the dump is in
+// progress and events overwritten during the dump are omitted. Returns false
+// if the file could not be written or another dump is in progress.
+bool iree_tracing_recorder_dump(const char* path);
+
+// Requests that a dump to the configured path be performed. The dump is
+// written asynchronously by the dump thread if it is running and otherwise by
+// the next call to iree_tracing_recorder_flush. Safe to call from signal
+// handlers.
+void iree_tracing_recorder_request_dump(void);
+
+// Writes a pending requested dump on the calling thread, if any. Returns false
+// if a dump was pending and could not be written.
+bool iree_tracing_recorder_flush(void);
+
+// These functions are implementation details and should not be called directly.
+// Always use the macros (or C++ RAII types).
+
+#define IREE_TRACE_IMPL_CONCAT(x, y) IREE_TRACE_IMPL_CONCAT2(x, y)
+#define IREE_TRACE_IMPL_CONCAT2(x, y) x##y
+
+#define IREE_TRACE_STRLEN(literal) (sizeof(literal) - 1)
+
+typedef struct iree_tracing_location_t {
+  const char* name;
+  size_t name_length;
+  const char* function_name;
+  size_t function_name_length;
+  const char* file_name;
+  size_t file_name_length;
+  uint32_t line;
+  uint32_t color;
+} iree_tracing_location_t;
+
+#define iree_tracing_make_zone_ctx(zone_id) (zone_id)
+
+void iree_tracing_recorder_initialize();
+void iree_tracing_recorder_deinitialize();
+
+void iree_tracing_set_thread_name(const char* name);
+
+IREE_MUST_USE_RESULT iree_zone_id_t
+iree_tracing_zone_begin_impl(const iree_tracing_location_t* src_loc,
+                             const char* name, size_t name_length);
+IREE_MUST_USE_RESULT iree_zone_id_t iree_tracing_zone_begin_external_impl(
+    const char* file_name, size_t file_name_length, uint32_t line,
+    const char* function_name, size_t function_name_length, const char* name,
+    size_t name_length);
+void iree_tracing_zone_end(iree_zone_id_t zone_id);
+
+void iree_tracing_zone_append_value_i64(iree_zone_id_t zone_id, int64_t value);
+void iree_tracing_zone_append_text_string_view(iree_zone_id_t zone_id,
+                                               const char* value,
+                                               size_t value_length);
+
+void iree_tracing_plot_value_i64(const char* name_literal, int64_t value);
+void iree_tracing_plot_value_f64(const char* name_literal, double value);
+
+void iree_tracing_frame_mark(const char* name_literal);
+
+void iree_tracing_message_cstring(const char* value, uint32_t color);
+void iree_tracing_message_string_view(const char* value, size_t value_length,
+                                      uint32_t color);
+
+void iree_tracing_memory_alloc(const char* name, size_t name_length, void* ptr,
+                               size_t size);
+void iree_tracing_memory_free(const char* name, size_t name_length, void* ptr);
+
+#endif  // IREE_TRACING_FEATURES
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+//===----------------------------------------------------------------------===//
+// Instrumentation macros (C)
+//===----------------------------------------------------------------------===//
+
+#if IREE_TRACING_FEATURES & IREE_TRACING_FEATURE_INSTRUMENTATION
+
+#define IREE_TRACE(expr) expr
+
+#define IREE_TRACE_APP_ENTER() iree_tracing_recorder_initialize()
+#define IREE_TRACE_APP_EXIT(exit_code) iree_tracing_recorder_deinitialize()
+#define IREE_TRACE_SET_APP_INFO(value, value_length)
+#define IREE_TRACE_SET_THREAD_NAME(name) iree_tracing_set_thread_name(name)
+
+#define IREE_TRACE_PUBLISH_SOURCE_FILE(filename, filename_length, content, \
+                                       content_length)                     \
+  (void)filename;                                                          \
+  (void)filename_length;                                                   \
+  (void)content;                                                           \
+  (void)content_length;
+
+// Fibers are not tracked and their zones are attributed to the thread that runs
+// them.
+#define IREE_TRACE_FIBER_ENTER(fiber)
+#define IREE_TRACE_FIBER_LEAVE()
+
+#define IREE_TRACE_ZONE_BEGIN(zone_id) \
+  IREE_TRACE_ZONE_BEGIN_NAMED(zone_id, NULL)
+
+#define IREE_TRACE_ZONE_BEGIN_NAMED(zone_id, name_literal)                     \
+  static const iree_tracing_location_t IREE_TRACE_IMPL_CONCAT(                 \
+      __iree_tracing_source_location, __LINE__) = {                            \
+      name_literal,       IREE_TRACE_STRLEN(name_literal),                     \
+      __FUNCTION__,       IREE_TRACE_STRLEN(__FUNCTION__),                     \
+      __FILE__,           IREE_TRACE_STRLEN(__FILE__),                         \
+      (uint32_t)__LINE__, 0};                                                  \
+  iree_zone_id_t zone_id = iree_tracing_zone_begin_impl(                       \
+      &IREE_TRACE_IMPL_CONCAT(__iree_tracing_source_location, __LINE__), NULL, \
+      0)
+
+#define IREE_TRACE_ZONE_BEGIN_NAMED_DYNAMIC(zone_id, name, name_length)  \
+  static const iree_tracing_location_t IREE_TRACE_IMPL_CONCAT(           \
+      __iree_tracing_source_location, __LINE__) = {                      \
+      NULL,                                                              \
+      0,                                                                 \
+      __FUNCTION__,                                                      \
+      IREE_TRACE_STRLEN(__FUNCTION__),                                   \
+      __FILE__,                                                          \
+      IREE_TRACE_STRLEN(__FILE__),                                       \
+      (uint32_t)__LINE__,                                                \
+      0};                                                                \
+  iree_zone_id_t zone_id = iree_tracing_zone_begin_impl(                 \
+      &IREE_TRACE_IMPL_CONCAT(__iree_tracing_source_location, __LINE__), \
+      (name), (name_length))
+
+#define IREE_TRACE_ZONE_BEGIN_EXTERNAL(                                       \
+    zone_id, file_name, file_name_length, line, function_name,                \
+    function_name_length, name, name_length)                                  \
+  iree_zone_id_t zone_id = iree_tracing_zone_begin_external_impl(             \
+      file_name, file_name_length, line, function_name, function_name_length, \
+      name, name_length)
+
+#define IREE_TRACE_ZONE_END(zone_id) iree_tracing_zone_end(zone_id)
+
+#define IREE_RETURN_AND_END_ZONE_IF_ERROR(zone_id, ...) \
+  IREE_RETURN_AND_EVAL_IF_ERROR(IREE_TRACE_ZONE_END(zone_id), __VA_ARGS__)
+
+#define IREE_TRACE_ZONE_SET_COLOR(zone_id, color_xbgr)
+
+#define IREE_TRACE_ZONE_APPEND_VALUE_I64(zone_id, value) \
+  iree_tracing_zone_append_value_i64(zone_id, (int64_t)(value))
+#define IREE_TRACE_ZONE_APPEND_TEXT(...)                                  \
+  IREE_TRACE_IMPL_GET_VARIADIC_((__VA_ARGS__,                             \
+                                 IREE_TRACE_ZONE_APPEND_TEXT_STRING_VIEW, \
+                                 IREE_TRACE_ZONE_APPEND_TEXT_CSTRING))    \
+  (__VA_ARGS__)
+#define IREE_TRACE_ZONE_APPEND_TEXT_CSTRING(zone_id, value) \
+  IREE_TRACE_ZONE_APPEND_TEXT_STRING_VIEW(zone_id, value, strlen(value))
+#define IREE_TRACE_ZONE_APPEND_TEXT_STRING_VIEW(zone_id, value, value_length) \
+  iree_tracing_zone_append_text_string_view(zone_id, value, value_length)
+
+#define IREE_TRACE_SET_PLOT_TYPE(name_literal, plot_type, step, fill, color) \
+  (void)(name_literal), (void)(plot_type), (void)(step), (void)(fill),       \
+      (void)(color)
+#define IREE_TRACE_PLOT_VALUE_I64(name_literal, value) \
+  iree_tracing_plot_value_i64(name_literal, (int64_t)(value))
+#define IREE_TRACE_PLOT_VALUE_F32(name_literal, value) \
+  iree_tracing_plot_value_f64(name_literal, (double)(value))
+#define IREE_TRACE_PLOT_VALUE_F64(name_literal, value) \
+  iree_tracing_plot_value_f64(name_literal, (double)(value))
+
+#define IREE_TRACE_FRAME_MARK() iree_tracing_frame_mark(NULL)
+#define IREE_TRACE_FRAME_MARK_NAMED(name_literal) \
+  iree_tracing_frame_mark(name_literal)
+// Discontinuous frames are not recorded.
+#define IREE_TRACE_FRAME_MARK_BEGIN_NAMED(name_literal)
+#define IREE_TRACE_FRAME_MARK_END_NAMED(name_literal)
+
+#define IREE_TRACE_MESSAGE(level, value_literal) \
+  iree_tracing_message_cstring(value_literal,    \
+                               IREE_TRACING_MESSAGE_LEVEL_##level)
+#define IREE_TRACE_MESSAGE_COLORED(color, value_literal) \
+  iree_tracing_message_cstring(value_literal, color)
+#define IREE_TRACE_MESSAGE_DYNAMIC(level, value, value_length) \
+  iree_tracing_message_string_view(value, value_length,        \
+                                   IREE_TRACING_MESSAGE_LEVEL_##level)
+#define IREE_TRACE_MESSAGE_DYNAMIC_COLORED(color, value, value_length) \
+  iree_tracing_message_string_view(value, value_length, color)
+
+// Utilities:
+#define IREE_TRACE_IMPL_GET_VARIADIC_HELPER_(_1, _2, _3, NAME, ...) NAME
+#define IREE_TRACE_IMPL_GET_VARIADIC_(args) \
+  IREE_TRACE_IMPL_GET_VARIADIC_HELPER_ args
+
+#endif  // IREE_TRACING_FEATURE_INSTRUMENTATION
+
+//===----------------------------------------------------------------------===//
+// Allocation tracking macros (C/C++)
+//===----------------------------------------------------------------------===//
+
+#if IREE_TRACING_FEATURES & IREE_TRACING_FEATURE_ALLOCATION_TRACKING
+
+static inline void* iree_tracing_obscure_ptr(void* ptr) { return ptr; }
+
+#define IREE_TRACE_ALLOC(ptr, size) \
+  iree_tracing_memory_alloc("heap", 4, (ptr), (size))
+#define IREE_TRACE_FREE(ptr) iree_tracing_memory_free("heap", 4, (ptr))
+#define IREE_TRACE_ALLOC_NAMED(name_literal, ptr, size)                      \
+  iree_tracing_memory_alloc((name_literal), IREE_TRACE_STRLEN(name_literal), \
+                            (ptr), (size))
+#define IREE_TRACE_FREE_NAMED(name_literal, ptr)                            \
+  iree_tracing_memory_free((name_literal), IREE_TRACE_STRLEN(name_literal), \
+                           (ptr))
+
+#endif  // IREE_TRACING_FEATURE_ALLOCATION_TRACKING
+
+//===----------------------------------------------------------------------===//
+// Instrumentation C++ RAII types, wrappers, and macros
+//===----------------------------------------------------------------------===//
+
+#ifdef __cplusplus
+
+#if IREE_TRACING_FEATURES & IREE_TRACING_FEATURE_INSTRUMENTATION
+
+namespace iree {
+
+class ScopedZone {
+ public:
+  ScopedZone(const ScopedZone&) = delete;
+  ScopedZone(ScopedZone&&) = delete;
+  ScopedZone& operator=(const ScopedZone&) = delete;
+  ScopedZone& operator=(ScopedZone&&) = delete;
+
+  IREE_ATTRIBUTE_ALWAYS_INLINE ScopedZone(
+      const iree_tracing_location_t* src_loc) {
+    zone_id_ = iree_tracing_zone_begin_impl(src_loc, NULL, 0);
+  }
+  IREE_ATTRIBUTE_ALWAYS_INLINE ~ScopedZone() { IREE_TRACE_ZONE_END(zone_id_); }
+
+  operator iree_zone_id_t() const noexcept { return zone_id_; }
+
+ private:
+  iree_zone_id_t zone_id_;
+};
+
+}  // namespace iree
+
+#define IREE_TRACE_SCOPE()                                         \
+  static constexpr iree_tracing_location_t IREE_TRACE_IMPL_CONCAT( \
+      __iree_tracing_source_location, __LINE__){                   \
+      nullptr,                                                     \
+      0,                                                           \
+      __FUNCTION__,                                                \
+      IREE_TRACE_STRLEN(__FUNCTION__),                             \
+      __FILE__,                                                    \
+      IREE_TRACE_STRLEN(__FILE__),                                 \
+      (uint32_t)__LINE__,                                          \
+      0};                                                          \
+  ::iree::ScopedZone ___iree_tracing_scoped_zone(                  \
+      &IREE_TRACE_IMPL_CONCAT(__iree_tracing_source_location, __LINE__))
+#define IREE_TRACE_SCOPE_NAMED(name_literal)                       \
+  static constexpr iree_tracing_location_t IREE_TRACE_IMPL_CONCAT( \
+      __iree_tracing_source_location, __LINE__){                   \
+      name_literal,       IREE_TRACE_STRLEN(name_literal),         \
+      __FUNCTION__,       IREE_TRACE_STRLEN(__FUNCTION__),         \
+      __FILE__,           IREE_TRACE_STRLEN(__FILE__),             \
+      (uint32_t)__LINE__, 0};                                      \
+  ::iree::ScopedZone ___iree_tracing_scoped_zone(                  \
+      &IREE_TRACE_IMPL_CONCAT(__iree_tracing_source_location, __LINE__))
+#define IREE_TRACE_SCOPE_ID ___iree_tracing_scoped_zone
+
+#endif  // IREE_TRACING_FEATURE_INSTRUMENTATION
+
+#endif  // __cplusplus
+
+#endif  // IREE_BASE_TRACING_RECORDER_H_
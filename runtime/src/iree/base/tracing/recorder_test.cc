@@ -0,0 +1,436 @@
+// Copyright 2025 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "iree/base/api.h"  // includes the recorder provider
+#include "iree/testing/gtest.h"
+
+namespace {
+
+//===----------------------------------------------------------------------===//
+// Minimal JSON reader
+//===----------------------------------------------------------------------===//
+
+// Just enough JSON to validate and inspect the Chrome trace event files the
+// recorder writes. Parsing fails on any malformed input.
+struct JsonValue {
+  enum class Kind { kNull, kBool, kNumber, kString, kArray, kObject };
+  Kind kind = Kind::kNull;
+  bool boolean = false;
+  double number = 0.0;
+  std::string string;
+  std::vector<JsonValue> array;
+  std::map<std::string, JsonValue> object;
+
+  const JsonValue* Find(const std::string& key) const {
+    auto it = object.find(key);
+    return it == object.end() ? nullptr : &it->second;
+  }
+};
+
+class JsonParser {
+ public:
+  explicit JsonParser(const std::string& text) : text_(text) {}
+
+  bool Parse(JsonValue* out_value) {
+    if (!ParseValue(out_value)) return false;
+    SkipWhitespace();
+    return position_ == text_.size();
+  }
+
+ private:
+  void SkipWhitespace() {
+    while (position_ < text_.size() &&
+           (text_[position_] == ' ' || text_[position_] == '\n' ||
+            text_[position_] == '\r' || text_[position_] == '\t')) {
+      ++position_;
+    }
+  }
+
+  bool Consume(char c) {
+    SkipWhitespace();
+    if (position_ >= text_.size() || text_[position_] != c) return false;
+    ++position_;
+    return true;
+  }
+
+  bool ConsumeLiteral(const char* literal) {
+    size_t length = strlen(literal);
+    if (text_.compare(position_, length, literal) != 0) return false;
+    position_ += length;
+    return true;
+  }
+
+  bool ParseString(std::string* out_string) {
+    if (!Consume('"')) return false;
+    while (position_ < text_.size()) {
+      char c = text_[position_++];
+      if (c == '"') return true;
+      if (static_cast<unsigned char>(c) < 0x20) return false;
+      if (c != '\\') {
+        out_string->push_back(c);
+        continue;
+      }
+      if (position_ >= text_.size()) return false;
+      switch (text_[position_++]) {
+        case '"':
+          out_string->push_back('"');
+          break;
+        case '\\':
+          out_string->push_back('\\');
+          break;
+        case '/':
+          out_string->push_back('/');
+          break;
+        case 'b':
+          out_string->push_back('\b');
+          break;
+        case 'f':
+          out_string->push_back('\f');
+          break;
+        case 'n':
+          out_string->push_back('\n');
+          break;
+        case 'r':
+          out_string->push_back('\r');
+          break;
+        case 't':
+          out_string->push_back('\t');
+          break;
+        case 'u': {
+          if (position_ + 4 > text_.size()) return false;
+          unsigned code = 0;
+          for (int i = 0; i < 4; ++i) {
+            char h = text_[position_++];
+            code <<= 4;
+            if (h >= '0' && h <= '9') {
+              code |= h - '0';
+            } else if (h >= 'a' && h <= 'f') {
+              code |= h - 'a' + 10;
+            } else if (h >= 'A' && h <= 'F') {
+              code |= h - 'A' + 10;
+            } else {
+              return false;
+            }
+          }
+          // Only control characters are escaped by the recorder.
+          if (code >= 0x80) return false;
+          out_string->push_back(static_cast<char>(code));
+          break;
+        }
+        default:
+          return false;
+      }
+    }
+    return false;
+  }
+
+  bool ParseNumber(double* out_number) {
+    const char* begin = text_.c_str() + position_;
+    char* end = nullptr;
+    *out_number = strtod(begin, &end);
+    if (end == begin) return false;
+    position_ += end - begin;
+    return true;
+  }
+
+  bool ParseValue(JsonValue* out_value) {
+    SkipWhitespace();
+    if (position_ >= text_.size()) return false;
+    switch (text_[position_]) {
+      case '{': {
+        out_value->kind = JsonValue::Kind::kObject;
+        ++position_;
+        if (Consume('}')) return true;
+        do {
+          std::string key;
+          if (!ParseString(&key) || !Consume(':')) return false;
+          if (!ParseValue(&out_value->object[key])) return false;
+        } while (Consume(','));
+        return Consume('}');
+      }
+      case '[': {
+        out_value->kind = JsonValue::Kind::kArray;
+        ++position_;
+        if (Consume(']')) return true;
+        do {
+          out_value->array.emplace_back();
+          if (!ParseValue(&out_value->array.back())) return false;
+        } while (Consume(','));
+        return Consume(']');
+      }
+      case '"':
+        out_value->kind = JsonValue::Kind::kString;
+        return ParseString(&out_value->string);
+      case 't':
+        out_value->kind = JsonValue::Kind::kBool;
+        out_value->boolean = true;
+        return ConsumeLiteral("true");
+      case 'f':
+        out_value->kind = JsonValue::Kind::kBool;
+        return ConsumeLiteral("false");
+      case 'n':
+        return ConsumeLiteral("null");
+      default:
+        out_value->kind = JsonValue::Kind::kNumber;
+        return ParseNumber(&out_value->number);
+    }
+  }
+
+  const std::string& text_;
+  size_t position_ = 0;
+};
+
+//===----------------------------------------------------------------------===//
+// Test utilities
+//===----------------------------------------------------------------------===//
+
+// Reads the trace events from the file at |path|. Returns false if the file
+// does not exist or is not (yet) a complete trace.
+static bool ReadTraceEvents(const std::string& path,
+                            std::vector<JsonValue>* out_events) {
+  std::ifstream file(path);
+  if (!file.is_open()) return false;
+  std::stringstream contents;
+  contents << file.rdbuf();
+  const std::string text = contents.str();
+  JsonValue root;
+  JsonParser parser(text);
+  if (!parser.Parse(&root)) return false;
+  const JsonValue* events = root.Find("traceEvents");
+  if (!events || events->kind != JsonValue::Kind::kArray) return false;
+  *out_events = events->array;
+  return true;
+}
+
+// Dumps the recorder to a temporary file and parses the trace events.
+static std::vector<JsonValue> DumpTraceEvents(const char* name) {
+  std::string path = ::testing::TempDir() + "/" + name + ".json";
+  EXPECT_TRUE(iree_tracing_recorder_dump(path.c_str()));
+  std::vector<JsonValue> events;
+  EXPECT_TRUE(ReadTraceEvents(path, &events)) << "malformed trace JSON";
+  std::remove(path.c_str());
+  return events;
+}
+
+static std::string GetString(const JsonValue& value, const char* key) {
+  const JsonValue* field = value.Find(key);
+  return field && field->kind == JsonValue::Kind::kString ? field->string
+                                                          : std::string();
+}
+
+static const JsonValue* GetArg(const JsonValue& event, const char* key) {
+  const JsonValue* args = event.Find("args");
+  return args ? args->Find(key) : nullptr;
+}
+
+// Returns the number of threads with a ring in |events|.
+static int CountThreads(const std::vector<JsonValue>& events) {
+  int count = 0;
+  for (const JsonValue& event : events) {
+    if (GetString(event, "ph") == "M" &&
+        GetString(event, "name") == "thread_name") {
+      ++count;
+    }
+  }
+  return count;
+}
+
+//===----------------------------------------------------------------------===//
+// Tests
+//===----------------------------------------------------------------------===//
+
+// Records zones with appended values and text and plots on several threads.
+// If |exit_barrier| is provided the thread waits for all threads sharing it to
+// finish recording before exiting so that none of their rings are reused.
+static void RecordWorker(int worker_index, int zone_count,
+                         std::atomic<int>* exit_barrier) {
+  std::string thread_name = "recorder_worker_" + std::to_string(worker_index);
+  IREE_TRACE_SET_THREAD_NAME(thread_name.c_str());
+  for (int i = 0; i < zone_count; ++i) {
+    IREE_TRACE_ZONE_BEGIN_NAMED(z0, "recorder_outer");
+    IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, worker_index);
+    IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, i);
+    {
+      IREE_TRACE_ZONE_BEGIN_NAMED(z1, "recorder_inner");
+      // Quotes, backslashes, and control characters must be escaped.
+      IREE_TRACE_ZONE_APPEND_TEXT(z1, "say \"hi\"\\\n");
+      IREE_TRACE_ZONE_END(z1);
+    }
+    IREE_TRACE_PLOT_VALUE_I64("recorder_plot", worker_index * 1000 + i);
+    IREE_TRACE_ZONE_END(z0);
+  }
+  if (exit_barrier) {
+    exit_barrier->fetch_sub(1);
+    while (exit_barrier->load() > 0) std::this_thread::yield();
+  }
+}
+
+TEST(RecorderTest, DumpsZonesAndPlotsFromThreads) {
+  constexpr int kWorkerCount = 4;
+  constexpr int kZoneCount = 16;
+  std::atomic<int> exit_barrier(kWorkerCount);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kWorkerCount; ++i) {
+    threads.emplace_back(RecordWorker, i, kZoneCount, &exit_barrier);
+  }
+  for (auto& thread : threads) thread.join();
+
+  std::vector<JsonValue> events = DumpTraceEvents("recorder_threads");
+
+  // Map thread IDs to the worker that named them.
+  std::map<double, int> workers;
+  for (const JsonValue& event : events) {
+    if (GetString(event, "ph") != "M") continue;
+    const JsonValue* name = GetArg(event, "name");
+    ASSERT_NE(name, nullptr);
+    const std::string prefix = "recorder_worker_";
+    if (name->string.compare(0, prefix.size(), prefix) != 0) continue;
+    workers[event.Find("tid")->number] =
+        std::stoi(name->string.substr(prefix.size()));
+  }
+  ASSERT_EQ(workers.size(), kWorkerCount);
+
+  std::map<int, int> outer_counts;
+  std::map<int, int> inner_counts;
+  std::map<int, int> plot_counts;
+  for (const JsonValue& event : events) {
+    const std::string phase = GetString(event, "ph");
+    const std::string name = GetString(event, "name");
+    const JsonValue* tid = event.Find("tid");
+    ASSERT_NE(tid, nullptr);
+    ASSERT_NE(event.Find("ts"), nullptr);
+    auto worker_it = workers.find(tid->number);
+    if (worker_it == workers.end()) continue;
+    const int worker_index = worker_it->second;
+    if (phase == "X" && name == "recorder_outer") {
+      ASSERT_NE(event.Find("dur"), nullptr);
+      const JsonValue* values = GetArg(event, "values");
+      ASSERT_NE(values, nullptr);
+      ASSERT_EQ(values->array.size(), 2);
+      EXPECT_EQ(values->array[0].number, worker_index);
+      EXPECT_EQ(values->array[1].number, outer_counts[worker_index]);
+      EXPECT_EQ(GetArg(event, "text"), nullptr);
+      ASSERT_NE(GetArg(event, "file"), nullptr);
+      EXPECT_NE(GetArg(event, "file")->string.find("recorder_test.cc"),
+                std::string::npos);
+      ++outer_counts[worker_index];
+    } else if (phase == "X" && name == "recorder_inner") {
+      const JsonValue* text = GetArg(event, "text");
+      ASSERT_NE(text, nullptr);
+      ASSERT_EQ(text->array.size(), 1);
+      EXPECT_EQ(text->array[0].string, "say \"hi\"\\\n");
+      EXPECT_EQ(GetArg(event, "values"), nullptr);
+      ++inner_counts[worker_index];
+    } else if (phase == "C" && name == "recorder_plot") {
+      const JsonValue* value = GetArg(event, "value");
+      ASSERT_NE(value, nullptr);
+      EXPECT_EQ(value->number, worker_index * 1000 + plot_counts[worker_index]);
+      ++plot_counts[worker_index];
+    }
+  }
+  for (int i = 0; i < kWorkerCount; ++i) {
+    EXPECT_EQ(outer_counts[i], kZoneCount);
+    EXPECT_EQ(inner_counts[i], kZoneCount);
+    EXPECT_EQ(plot_counts[i], kZoneCount);
+  }
+}
+
+TEST(RecorderTest, ReusesRingsOfExitedThreads) {
+  // Ensure the rings of any threads from prior tests have been retired.
+  const int initial_thread_count =
+      CountThreads(DumpTraceEvents("recorder_reuse_before"));
+
+  // Each thread exits before the next starts and should claim the ring
+  // retired by the previous one.
+  for (int i = 0; i < 8; ++i) {
+    std::thread thread(RecordWorker, 100 + i, 1, nullptr);
+    thread.join();
+  }
+
+  std::vector<JsonValue> events = DumpTraceEvents("recorder_reuse_after");
+  EXPECT_LE(CountThreads(events), initial_thread_count + 1);
+
+  // Only the events of the last owner of a reused ring are exported.
+  std::vector<std::string> reuse_workers;
+  for (const JsonValue& event : events) {
+    if (GetString(event, "ph") != "M") continue;
+    const JsonValue* name = GetArg(event, "name");
+    if (name && name->string.compare(0, 18, "recorder_worker_10") == 0) {
+      reuse_workers.push_back(name->string);
+    }
+  }
+  EXPECT_EQ(reuse_workers, std::vector<std::string>{"recorder_worker_107"});
+}
+
+TEST(RecorderTest, InternsDynamicNames) {
+  // Longer than the inline storage used when interning fails.
+  const std::string name = "recorder_dynamic_zone_with_a_long_name";
+  for (int i = 0; i < 2; ++i) {
+    IREE_TRACE_ZONE_BEGIN_NAMED_DYNAMIC(z0, name.data(), name.size());
+    IREE_TRACE_ZONE_END(z0);
+  }
+  int count = 0;
+  for (const JsonValue& event : DumpTraceEvents("recorder_dynamic")) {
+    if (GetString(event, "ph") == "X" && GetString(event, "name") == name) {
+      ++count;
+    }
+  }
+  EXPECT_EQ(count, 2);
+}
+
+#if IREE_TRACING_RECORDER_SIGNAL && !IREE_SYNCHRONIZATION_DISABLE_UNSAFE
+
+// Signal-requested dumps are written by the dump thread without requiring any
+// application thread to record events.
+TEST(RecorderTest, DumpsOnSignal) {
+  const std::string path = ::testing::TempDir() + "/recorder_signal.json";
+  std::remove(path.c_str());
+  setenv(IREE_TRACING_RECORDER_PATH_ENV, path.c_str(), 1);
+  iree_tracing_recorder_initialize();
+  {
+    IREE_TRACE_ZONE_BEGIN_NAMED(z0, "recorder_before_signal");
+    IREE_TRACE_ZONE_END(z0);
+  }
+  raise(IREE_TRACING_RECORDER_SIGNAL);
+
+  // The dump completes asynchronously; wait for a complete file.
+  std::vector<JsonValue> events;
+  for (int i = 0; i < 1000 && !ReadTraceEvents(path, &events); ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  unsetenv(IREE_TRACING_RECORDER_PATH_ENV);
+  iree_tracing_recorder_deinitialize();
+  std::remove(path.c_str());
+
+  int count = 0;
+  for (const JsonValue& event : events) {
+    if (GetString(event, "ph") == "X" &&
+        GetString(event, "name") == "recorder_before_signal") {
+      ++count;
+    }
+  }
+  EXPECT_EQ(count, 1);
+
+  // The request was consumed by the dump thread.
+  EXPECT_TRUE(iree_tracing_recorder_flush());
+}
+
+#endif  // IREE_TRACING_RECORDER_SIGNAL && !IREE_SYNCHRONIZATION_DISABLE_UNSAFE
+
+}  // namespace
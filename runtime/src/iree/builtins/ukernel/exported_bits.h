@@ -60,6 +60,11 @@
 #define IREE_UK_FLAG_PACK_TYPE_I32I32 0x03
 #define IREE_UK_FLAG_PACK_TYPE_F16F16 0x04
 #define IREE_UK_FLAG_PACK_TYPE_BF16BF16 0x05
+// Types converting elements while packing. The padding value is interpreted as
+// a value of the output type.
+#define IREE_UK_FLAG_PACK_TYPE_F32BF16 0x06
+#define IREE_UK_FLAG_PACK_TYPE_F32F16 0x07
+#define IREE_UK_FLAG_PACK_TYPE_F32S8 0x08
 
 // bit flags
 #define IREE_UK_FLAG_PACK_TRANSPOSE_INNER 0x100
@@ -59,7 +59,13 @@ static void iree_uk_pack_validate(const iree_uk_pack_params_t* params) {
                  flags_type == IREE_UK_FLAG_PACK_TYPE_I8I8 ||
                  flags_type == IREE_UK_FLAG_PACK_TYPE_I32I32 ||
                  flags_type == IREE_UK_FLAG_PACK_TYPE_F16F16 ||
-                 flags_type == IREE_UK_FLAG_PACK_TYPE_BF16BF16);
+                 flags_type == IREE_UK_FLAG_PACK_TYPE_BF16BF16 ||
+                 flags_type == IREE_UK_FLAG_PACK_TYPE_F32BF16 ||
+                 flags_type == IREE_UK_FLAG_PACK_TYPE_F32F16 ||
+                 flags_type == IREE_UK_FLAG_PACK_TYPE_F32S8);
+  if (flags_type == IREE_UK_FLAG_PACK_TYPE_F32S8) {
+    IREE_UK_ASSERT(params->quantize_scale > 0.0f);
+  }
   IREE_UK_ASSERT(params->in_size0 >= 0);
   IREE_UK_ASSERT(params->in_size1 >= 0);
   IREE_UK_ASSERT(params->out_size0 >= 0);
@@ -95,7 +101,7 @@ static void iree_uk_pack_validate(const iree_uk_pack_params_t* params) {
   // treated as infallible.
   iree_uk_pack_tmpbuf_helper_t helper;
   iree_uk_pack_type_t pack_type = iree_uk_pack_type(params->flags);
-  iree_uk_type_t elem_type = iree_uk_pack_in_type(pack_type);
+  iree_uk_type_t elem_type = iree_uk_pack_out_type(pack_type);
   iree_uk_index_t elem_size = iree_uk_type_size(elem_type);
   iree_uk_pack_tmpbuf_helper_init(tile_size0, tile_size1, elem_size,
                                   params->padding_value, &helper);
@@ -192,126 +198,212 @@ static void iree_uk_copy_1d_strided_to_unstrided(
   }
 }
 
+// Copies |num_elems| elements from a strided source to an unstrided
+// destination converting from the input to the output type of |pack_type|.
+static void iree_uk_convert_1d_strided_to_unstrided(
+    void* IREE_UK_RESTRICT dst, const void* IREE_UK_RESTRICT src,
+    iree_uk_index_t num_elems, iree_uk_index_t stride,
+    iree_uk_pack_type_t pack_type, float quantize_inverse_scale) {
+  const float* IREE_UK_RESTRICT src_f32 = (const float*)src;
+  switch (pack_type) {
+    case iree_uk_pack_type_f32bf16: {
+      iree_uk_uint16_t* IREE_UK_RESTRICT dst_bf16 = (iree_uk_uint16_t*)dst;
+      for (iree_uk_index_t i = 0; i < num_elems; ++i) {
+        dst_bf16[i] = iree_uk_f32_to_bf16(src_f32[i * stride]);
+      }
+      return;
+    }
+    case iree_uk_pack_type_f32f16: {
+      iree_uk_uint16_t* IREE_UK_RESTRICT dst_f16 = (iree_uk_uint16_t*)dst;
+      for (iree_uk_index_t i = 0; i < num_elems; ++i) {
+        dst_f16[i] = iree_uk_f32_to_f16(src_f32[i * stride]);
+      }
+      return;
+    }
+    case iree_uk_pack_type_f32s8: {
+      iree_uk_int8_t* IREE_UK_RESTRICT dst_s8 = (iree_uk_int8_t*)dst;
+      for (iree_uk_index_t i = 0; i < num_elems; ++i) {
+        dst_s8[i] = iree_uk_pack_quantize_f32_to_s8(src_f32[i * stride],
+                                                    quantize_inverse_scale);
+      }
+      return;
+    }
+    default:
+      // Shouldn't happen, validated earlier.
+      IREE_UK_ASSERT(false && "unhandled pack conversion type");
+  }
+}
+
+// Loop-invariant state shared by all rows of a pack.
+typedef struct iree_uk_pack_row_state_t {
+  iree_uk_pack_tile_func_t tile_func;
+  iree_uk_pack_type_t pack_type;
+  // True if the input and output element types differ and elements must be
+  // converted while packing.
+  bool is_converting;
+  float quantize_inverse_scale;
+  iree_uk_index_t in_elem_size;
+  iree_uk_index_t out_elem_size;
+  iree_uk_index_t tile_size0;
+  iree_uk_index_t tile_size1;
+  iree_uk_index_t in_size1;
+  iree_uk_index_t in_stride0;
+  iree_uk_index_t in_stride1;
+  iree_uk_index_t out_stride1;
+  iree_uk_uint64_t padding_value;
+  iree_uk_pack_tmpbuf_helper_t helper;
+} iree_uk_pack_row_state_t;
+
 // Copy from a source 2D buffer to a destination 2D buffer, padding to the
-// destination size.
-static void iree_uk_copy_and_pad(
-    iree_uk_index_t src_size0, iree_uk_index_t src_size1,
-    iree_uk_index_t src_stride0, iree_uk_index_t src_stride1,
-    const char* src_buf, iree_uk_index_t dst_size0, iree_uk_index_t dst_size1,
-    iree_uk_index_t dst_stride0, char* dst_buf, iree_uk_index_t elem_size,
-    bool whole_tiles, iree_uk_uint64_t padding_value,
-    bool is_padding_single_byte) {
+// destination size and converting elements if needed. The destination is
+// always of the output element type.
+static void iree_uk_copy_and_pad(iree_uk_pack_row_state_t* state,
+                                 iree_uk_index_t src_size0,
+                                 iree_uk_index_t src_size1, const char* src_buf,
+                                 iree_uk_index_t dst_size0,
+                                 iree_uk_index_t dst_size1,
+                                 iree_uk_index_t dst_stride0, char* dst_buf,
+                                 bool whole_tiles) {
   if (!whole_tiles) {
-    iree_uk_fill(dst_buf, dst_size1 + (dst_size0 - 1) * dst_stride0, elem_size,
-                 padding_value, is_padding_single_byte);
+    iree_uk_fill(dst_buf, dst_size1 + (dst_size0 - 1) * dst_stride0,
+                 state->out_elem_size, state->padding_value,
+                 state->helper.is_padding_single_byte);
   }
   for (iree_uk_index_t in_i0 = 0; in_i0 < src_size0; in_i0++) {
-    iree_uk_copy_1d_strided_to_unstrided(dst_buf, src_buf, src_size1, elem_size,
-                                         src_stride1);
-    dst_buf += dst_stride0 * elem_size;
-    src_buf += src_stride0 * elem_size;
+    if (state->is_converting) {
+      iree_uk_convert_1d_strided_to_unstrided(
+          dst_buf, src_buf, src_size1, state->in_stride1, state->pack_type,
+          state->quantize_inverse_scale);
+    } else {
+      iree_uk_copy_1d_strided_to_unstrided(dst_buf, src_buf, src_size1,
+                                           state->in_elem_size,
+                                           state->in_stride1);
+    }
+    dst_buf += dst_stride0 * state->out_elem_size;
+    src_buf += state->in_stride0 * state->in_elem_size;
   }
 }
 
-// Pads and packs an entire row. In cases that are known not to require padding,
-// it is more efficient to call tile_func directly.
+// Pads and packs an entire row. In cases that are known not to require padding
+// or conversion, it is more efficient to call tile_func directly.
 static void iree_uk_pad_and_pack_row_using_tile_func(
-    iree_uk_pack_tile_func_t tile_func, iree_uk_index_t dim1_tile_start,
+    iree_uk_pack_row_state_t* state, iree_uk_index_t dim1_tile_start,
     iree_uk_index_t dim1_tile_end, iree_uk_index_t dim0_src_read_size,
-    iree_uk_index_t tile_size0, iree_uk_index_t tile_size1,
-    iree_uk_index_t elem_size, iree_uk_index_t in_size1,
-    iree_uk_index_t in_stride0, iree_uk_index_t in_stride1,
-    iree_uk_index_t out_stride1, bool whole_tiles,
-    iree_uk_uint64_t padding_value, iree_uk_pack_tmpbuf_helper_t* helper,
-    const char* in_buf, char* out_buf) {
-  if (whole_tiles && in_stride1 == 1) {
-    tile_func(out_buf + (dim1_tile_start * out_stride1 * elem_size),
-              in_buf + dim1_tile_start * tile_size1 * elem_size,
-              dim1_tile_end - dim1_tile_start, out_stride1, in_stride0,
-              elem_size, tile_size0, tile_size1);
+    bool whole_tiles, const char* in_buf, char* out_buf) {
+  const iree_uk_index_t tile_size0 = state->tile_size0;
+  const iree_uk_index_t tile_size1 = state->tile_size1;
+  const iree_uk_index_t out_elem_size = state->out_elem_size;
+  if (whole_tiles && state->in_stride1 == 1 && !state->is_converting) {
+    state->tile_func(out_buf + (dim1_tile_start * state->out_stride1 *
+                                out_elem_size),
+                     in_buf + dim1_tile_start * tile_size1 * out_elem_size,
+                     dim1_tile_end - dim1_tile_start, state->out_stride1,
+                     state->in_stride0, out_elem_size, tile_size0, tile_size1);
     return;
   }
   iree_uk_index_t dim1_tile = dim1_tile_start;
   while (dim1_tile < dim1_tile_end) {
     iree_uk_index_t dim1_chunk_tiles = iree_uk_index_clamp(
-        dim1_tile_end - dim1_tile, 0, helper->max_tiles_in_tmp_buf);
+        dim1_tile_end - dim1_tile, 0, state->helper.max_tiles_in_tmp_buf);
     iree_uk_index_t dim1_chunk_src_width = dim1_chunk_tiles * tile_size1;
     iree_uk_index_t dim1_chunk_src_pos = dim1_tile * tile_size1;
     iree_uk_index_t i1_read_size = iree_uk_index_clamp(
-        in_size1 - dim1_chunk_src_pos, 0, dim1_chunk_src_width);
+        state->in_size1 - dim1_chunk_src_pos, 0, dim1_chunk_src_width);
     iree_uk_copy_and_pad(
-        dim0_src_read_size, i1_read_size, in_stride0, in_stride1,
-        in_buf + dim1_chunk_src_pos * in_stride1 * elem_size, tile_size0,
-        dim1_chunk_src_width, dim1_chunk_src_width, helper->tmp_buf, elem_size,
-        whole_tiles, padding_value, helper->is_padding_single_byte);
-    tile_func(out_buf + (dim1_tile * out_stride1 * elem_size), helper->tmp_buf,
-              dim1_chunk_tiles, out_stride1, dim1_chunk_src_width, elem_size,
-              tile_size0, tile_size1);
+        state, dim0_src_read_size, i1_read_size,
+        in_buf + dim1_chunk_src_pos * state->in_stride1 * state->in_elem_size,
+        tile_size0, dim1_chunk_src_width, dim1_chunk_src_width,
+        state->helper.tmp_buf, whole_tiles);
+    state->tile_func(out_buf + (dim1_tile * state->out_stride1 * out_elem_size),
+                     state->helper.tmp_buf, dim1_chunk_tiles,
+                     state->out_stride1, dim1_chunk_src_width, out_elem_size,
+                     tile_size0, tile_size1);
     dim1_tile += dim1_chunk_tiles;
   }
 }
 
-static void iree_uk_pack_using_tile_func(const iree_uk_pack_params_t* params,
-                                         iree_uk_pack_tile_func_t tile_func) {
-  // For now, the input and output element types are always the same.
-  iree_uk_pack_type_t pack_type = iree_uk_pack_type(params->flags);
-  iree_uk_type_t elem_type = iree_uk_pack_in_type(pack_type);
-  iree_uk_index_t elem_size = iree_uk_type_size(elem_type);
-  iree_uk_index_t outer_size0 = params->out_size0;
+// Packs rows of tiles [row_begin, row_end) where rows are along the outer
+// dimension corresponding to input dimension 0.
+static void iree_uk_pack_rows_using_tile_func(
+    const iree_uk_pack_params_t* params, iree_uk_pack_tile_func_t tile_func,
+    iree_uk_index_t row_begin, iree_uk_index_t row_end) {
+  iree_uk_pack_row_state_t state;
+  state.tile_func = tile_func;
+  state.pack_type = iree_uk_pack_type(params->flags);
+  iree_uk_type_t in_type = iree_uk_pack_in_type(state.pack_type);
+  iree_uk_type_t out_type = iree_uk_pack_out_type(state.pack_type);
+  state.is_converting = in_type != out_type;
+  state.quantize_inverse_scale =
+      state.pack_type == iree_uk_pack_type_f32s8 ? 1.0f / params->quantize_scale
+                                                 : 1.0f;
+  state.in_elem_size = iree_uk_type_size(in_type);
+  state.out_elem_size = iree_uk_type_size(out_type);
   iree_uk_index_t outer_size1 = params->out_size1;
-  iree_uk_index_t tile_size0 = params->out_size2;
-  iree_uk_index_t tile_size1 = params->out_size3;
+  state.tile_size0 = params->out_size2;
+  state.tile_size1 = params->out_size3;
   iree_uk_index_t out_stride_l0 = params->out_stride0;
-  iree_uk_index_t out_stride1 = params->out_size3 * params->out_size2;
+  state.out_stride1 = params->out_size3 * params->out_size2;
   if (params->flags & IREE_UK_FLAG_PACK_TRANSPOSE_OUTER) {
-    iree_uk_index_swap(&outer_size0, &outer_size1);
-    iree_uk_index_swap(&out_stride_l0, &out_stride1);
+    outer_size1 = params->out_size0;
+    iree_uk_index_swap(&out_stride_l0, &state.out_stride1);
   }
   if (params->flags & IREE_UK_FLAG_PACK_TRANSPOSE_INNER) {
-    iree_uk_index_swap(&tile_size0, &tile_size1);
+    iree_uk_index_swap(&state.tile_size0, &state.tile_size1);
   }
-  const char* in_buf =
-      (const char*)params->in_buffer + (params->in_offset * elem_size);
-  char* out_buf = (char*)params->out_buffer + (params->out_offset * elem_size);
-  // Prepare for padding.
-  iree_uk_pack_tmpbuf_helper_t helper;
-  iree_uk_pack_tmpbuf_helper_init(tile_size0, tile_size1, elem_size,
-                                  params->padding_value, &helper);
-  // Compute number of tiles along both dimensions that fit entirely within the
+  state.in_size1 = params->in_size1;
+  state.in_stride0 = params->in_stride0;
+  state.in_stride1 = params->in_stride1;
+  state.padding_value = params->padding_value;
+  // Prepare for padding. The temporary buffer holds output elements.
+  iree_uk_pack_tmpbuf_helper_init(state.tile_size0, state.tile_size1,
+                                  state.out_elem_size, params->padding_value,
+                                  &state.helper);
+  const iree_uk_index_t tile_size0 = state.tile_size0;
+  const char* in_buf = (const char*)params->in_buffer +
+                       (params->in_offset + row_begin * tile_size0 *
+                                                params->in_stride0) *
+                           state.in_elem_size;
+  char* out_buf = (char*)params->out_buffer +
+                  (params->out_offset + row_begin * out_stride_l0) *
+                      state.out_elem_size;
+  // Compute number of tiles along dimension 1 that fit entirely within the
   // source buffer's boundaries.
-  int dim1_full_tiles = params->in_size1 >> iree_uk_ceil_log2_u32(tile_size1);
-  iree_uk_index_t i0 = 0;
-  for (; i0 <= params->in_size0 - tile_size0; i0 += tile_size0) {
-    // Pack whole tiles that do not require padding (entirely within the source
-    // buffer's boundaries).
-    iree_uk_pad_and_pack_row_using_tile_func(
-        tile_func, 0, dim1_full_tiles, tile_size0, tile_size0, tile_size1,
-        elem_size, params->in_size1, params->in_stride0, params->in_stride1,
-        out_stride1, /*whole_tiles=*/true, params->padding_value, &helper,
-        in_buf, out_buf);
-    // Right-padding.
-    iree_uk_pad_and_pack_row_using_tile_func(
-        tile_func, dim1_full_tiles, outer_size1, tile_size0, tile_size0,
-        tile_size1, elem_size, params->in_size1, params->in_stride0,
-        params->in_stride1, out_stride1, /*whole_tiles=*/false,
-        params->padding_value, &helper, in_buf, out_buf);
-    out_buf += out_stride_l0 * elem_size;
-    in_buf += tile_size0 * params->in_stride0 * elem_size;
-  }
-  // Bottom-padding.
-  for (; i0 < outer_size0 * tile_size0; i0 += tile_size0) {
-    iree_uk_index_t dim0_src_read_size =
-        iree_uk_index_clamp(params->in_size0 - i0, 0, tile_size0);
-    iree_uk_pad_and_pack_row_using_tile_func(
-        tile_func, 0, outer_size1, dim0_src_read_size, tile_size0, tile_size1,
-        elem_size, params->in_size1, params->in_stride0, params->in_stride1,
-        out_stride1, /*whole_tiles=*/false, params->padding_value, &helper,
-        in_buf, out_buf);
-    out_buf += out_stride_l0 * elem_size;
-    in_buf += tile_size0 * params->in_stride0 * elem_size;
+  int dim1_full_tiles =
+      params->in_size1 >> iree_uk_ceil_log2_u32(state.tile_size1);
+  for (iree_uk_index_t row = row_begin; row < row_end; ++row) {
+    iree_uk_index_t i0 = row * tile_size0;
+    if (i0 + tile_size0 <= params->in_size0) {
+      // Pack whole tiles that do not require padding (entirely within the
+      // source buffer's boundaries).
+      iree_uk_pad_and_pack_row_using_tile_func(&state, 0, dim1_full_tiles,
+                                               tile_size0, /*whole_tiles=*/true,
+                                               in_buf, out_buf);
+      // Right-padding.
+      iree_uk_pad_and_pack_row_using_tile_func(
+          &state, dim1_full_tiles, outer_size1, tile_size0,
+          /*whole_tiles=*/false, in_buf, out_buf);
+    } else {
+      // Bottom-padding.
+      iree_uk_index_t dim0_src_read_size =
+          iree_uk_index_clamp(params->in_size0 - i0, 0, tile_size0);
+      iree_uk_pad_and_pack_row_using_tile_func(&state, 0, outer_size1,
+                                               dim0_src_read_size,
+                                               /*whole_tiles=*/false, in_buf,
+                                               out_buf);
+    }
+    out_buf += out_stride_l0 * state.out_elem_size;
+    in_buf += tile_size0 * params->in_stride0 * state.in_elem_size;
   }
 }
 
+// Returns the number of rows of tiles iterated by the outer loop.
+static iree_uk_index_t iree_uk_pack_row_count(
+    const iree_uk_pack_params_t* params) {
+  return (params->flags & IREE_UK_FLAG_PACK_TRANSPOSE_OUTER)
+             ? params->out_size1
+             : params->out_size0;
+}
+
 void iree_uk_pack_p(const iree_uk_pack_params_t* params) {
   iree_uk_pack_validate(params);
 
@@ -319,7 +411,33 @@ void iree_uk_pack_p(const iree_uk_pack_params_t* params) {
 
   // Select a target-specific tile_func and use that with generic outer loops.
   iree_uk_pack_tile_func_t tile_func = iree_uk_pack_select_tile_func(params);
-  iree_uk_pack_using_tile_func(params, tile_func);
+  iree_uk_pack_rows_using_tile_func(params, tile_func, 0,
+                                    iree_uk_pack_row_count(params));
+}
+
+void iree_uk_pack_p_slice(const iree_uk_pack_params_t* params,
+                          iree_uk_index_t slice_index,
+                          iree_uk_index_t slice_count) {
+  IREE_UK_ASSERT(slice_count > 0);
+  IREE_UK_ASSERT(slice_index >= 0 && slice_index < slice_count);
+  iree_uk_pack_validate(params);
+
+  if (iree_uk_pack_early(params)) return;
+
+  // Distribute rows such that slice sizes differ by at most one row. Each row
+  // of tiles writes a disjoint range of the output buffer.
+  iree_uk_index_t row_count = iree_uk_pack_row_count(params);
+  iree_uk_index_t rows_per_slice = row_count / slice_count;
+  iree_uk_index_t remainder_rows = row_count % slice_count;
+  iree_uk_index_t row_begin =
+      slice_index * rows_per_slice +
+      iree_uk_index_min(slice_index, remainder_rows);
+  iree_uk_index_t row_end =
+      row_begin + rows_per_slice + (slice_index < remainder_rows ? 1 : 0);
+  if (row_begin >= row_end) return;
+
+  iree_uk_pack_tile_func_t tile_func = iree_uk_pack_select_tile_func(params);
+  iree_uk_pack_rows_using_tile_func(params, tile_func, row_begin, row_end);
 }
 
 IREE_UK_EXPORT void iree_uk_pack(
@@ -346,7 +464,40 @@ IREE_UK_EXPORT void iree_uk_pack(
                                   .out_size2 = out_size2,
                                   .out_size3 = out_size3,
                                   .padding_value = padding_value,
+                                  .quantize_scale = 1.0f,
                                   .flags = flags,
                                   .cpu_data = cpu_data};
   iree_uk_pack_p(&params);
 }
+
+IREE_UK_EXPORT void iree_uk_pack_slice(
+    const void* in_buffer, iree_uk_index_t in_offset,
+    iree_uk_index_t in_stride0, iree_uk_index_t in_stride1, void* out_buffer,
+    iree_uk_index_t out_offset, iree_uk_index_t out_stride0,
+    iree_uk_index_t out_stride1, iree_uk_index_t in_size0,
+    iree_uk_index_t in_size1, iree_uk_index_t out_size0,
+    iree_uk_index_t out_size1, iree_uk_index_t out_size2,
+    iree_uk_index_t out_size3, iree_uk_uint64_t padding_value,
+    float quantize_scale, iree_uk_index_t slice_index,
+    iree_uk_index_t slice_count, iree_uk_uint32_t flags,
+    const iree_uk_uint64_t* cpu_data) {
+  iree_uk_pack_params_t params = {.in_buffer = in_buffer,
+                                  .in_offset = in_offset,
+                                  .in_stride0 = in_stride0,
+                                  .in_stride1 = in_stride1,
+                                  .out_buffer = out_buffer,
+                                  .out_offset = out_offset,
+                                  .out_stride0 = out_stride0,
+                                  .out_stride1 = out_stride1,
+                                  .in_size0 = in_size0,
+                                  .in_size1 = in_size1,
+                                  .out_size0 = out_size0,
+                                  .out_size1 = out_size1,
+                                  .out_size2 = out_size2,
+                                  .out_size3 = out_size3,
+                                  .padding_value = padding_value,
+                                  .quantize_scale = quantize_scale,
+                                  .flags = flags,
+                                  .cpu_data = cpu_data};
+  iree_uk_pack_p_slice(&params, slice_index, slice_count);
+}
@@ -23,6 +23,13 @@
 // If the element size is more than 64 bits then only repeating 64-bit
 // patterns are supported for padding. This covers most cases as floating
 // point types encode zero as zero bits.
+//
+// Pack types with different input and output element types (such as
+// IREE_UK_FLAG_PACK_TYPE_F32BF16) convert each element as it is packed such
+// that no separate conversion pass over the input is needed. For those types
+// `padding_value` is a value of the output element type. Quantizing pack types
+// (IREE_UK_FLAG_PACK_TYPE_F32S8) use a scale of 1 in iree_uk_pack; use
+// iree_uk_pack_slice to specify the scale.
 IREE_UK_EXPORT void iree_uk_pack(
     const void* in_buffer, iree_uk_index_t in_offset,
     iree_uk_index_t in_stride0, iree_uk_index_t in_stride1, void* out_buffer,
@@ -33,4 +40,27 @@ IREE_UK_EXPORT void iree_uk_pack(
     iree_uk_index_t out_size3, iree_uk_uint64_t padding_value,
     iree_uk_uint32_t flags, const iree_uk_uint64_t* cpu_data);
 
+// Executor entry point for splitting large packs across multiple workers.
+// Performs the |slice_index|-th of |slice_count| slices of the equivalent
+// iree_uk_pack. Slices are contiguous ranges of rows of output tiles balanced
+// to within one row and each slice writes a disjoint range of `out_buffer`,
+// so all slices of a pack may run concurrently without synchronization.
+// Performing all slices produces the same result as iree_uk_pack. Slices in
+// excess of the number of rows of tiles are empty.
+//
+// For IREE_UK_FLAG_PACK_TYPE_F32S8 each element is quantized as
+// `clamp(round(in / quantize_scale), -128, 127)` rounding half away from zero.
+// `quantize_scale` must be positive and is ignored for other pack types.
+IREE_UK_EXPORT void iree_uk_pack_slice(
+    const void* in_buffer, iree_uk_index_t in_offset,
+    iree_uk_index_t in_stride0, iree_uk_index_t in_stride1, void* out_buffer,
+    iree_uk_index_t out_offset, iree_uk_index_t out_stride0,
+    iree_uk_index_t out_stride1, iree_uk_index_t in_size0,
+    iree_uk_index_t in_size1, iree_uk_index_t out_size0,
+    iree_uk_index_t out_size1, iree_uk_index_t out_size2,
+    iree_uk_index_t out_size3, iree_uk_uint64_t padding_value,
+    float quantize_scale, iree_uk_index_t slice_index,
+    iree_uk_index_t slice_count, iree_uk_uint32_t flags,
+    const iree_uk_uint64_t* cpu_data);
+
 #endif  // IREE_BUILTINS_UKERNEL_PACK_H_
@@ -25,12 +25,20 @@ typedef struct iree_uk_pack_params_t {
   iree_uk_index_t out_size2;
   iree_uk_index_t out_size3;
   iree_uk_uint64_t padding_value;
+  // Only used with IREE_UK_FLAG_PACK_TYPE_F32S8. Must be positive.
+  float quantize_scale;
   iree_uk_uint32_t flags;
   const iree_uk_uint64_t* cpu_data;
 } iree_uk_pack_params_t;
 
 void iree_uk_pack_p(const iree_uk_pack_params_t* params);
 
+// Packs the |slice_index|-th of |slice_count| slices of |params|.
+// See iree_uk_pack_slice.
+void iree_uk_pack_p_slice(const iree_uk_pack_params_t* params,
+                          iree_uk_index_t slice_index,
+                          iree_uk_index_t slice_count);
+
 typedef enum iree_uk_pack_type_t {
   iree_uk_pack_type_f32f32 = IREE_UK_TIE_2_TYPES_LITERAL(FLOAT_32, FLOAT_32),
   iree_uk_pack_type_i8i8 = IREE_UK_TIE_2_TYPES_LITERAL(INT_8, INT_8),
@@ -38,6 +46,9 @@ typedef enum iree_uk_pack_type_t {
   iree_uk_pack_type_f16f16 = IREE_UK_TIE_2_TYPES_LITERAL(FLOAT_16, FLOAT_16),
   iree_uk_pack_type_bf16bf16 =
       IREE_UK_TIE_2_TYPES_LITERAL(BFLOAT_16, BFLOAT_16),
+  iree_uk_pack_type_f32bf16 = IREE_UK_TIE_2_TYPES_LITERAL(FLOAT_32, BFLOAT_16),
+  iree_uk_pack_type_f32f16 = IREE_UK_TIE_2_TYPES_LITERAL(FLOAT_32, FLOAT_16),
+  iree_uk_pack_type_f32s8 = IREE_UK_TIE_2_TYPES_LITERAL(FLOAT_32, SINT_8),
 } iree_uk_pack_type_t;
 
 static inline iree_uk_pack_type_t iree_uk_pack_type(iree_uk_uint32_t flags) {
@@ -52,6 +63,12 @@ static inline iree_uk_pack_type_t iree_uk_pack_type(iree_uk_uint32_t flags) {
       return iree_uk_pack_type_f16f16;
     case IREE_UK_FLAG_PACK_TYPE_BF16BF16:
       return iree_uk_pack_type_bf16bf16;
+    case IREE_UK_FLAG_PACK_TYPE_F32BF16:
+      return iree_uk_pack_type_f32bf16;
+    case IREE_UK_FLAG_PACK_TYPE_F32F16:
+      return iree_uk_pack_type_f32f16;
+    case IREE_UK_FLAG_PACK_TYPE_F32S8:
+      return iree_uk_pack_type_f32s8;
     default:
       // Shouldn't happen, validated earlier.
       return (iree_uk_pack_type_t)0;
@@ -66,6 +83,22 @@ static inline iree_uk_type_t iree_uk_pack_out_type(iree_uk_pack_type_t type) {
   return iree_uk_untie_type(1, type);
 }
 
+// Converts a single f32 value to the value quantized to s8 using
+// |inverse_scale| (the reciprocal of the quantization scale). Rounds to nearest
+// with ties away from zero and saturates to the s8 range.
+static inline iree_uk_int8_t iree_uk_pack_quantize_f32_to_s8(
+    float value, float inverse_scale) {
+  float scaled = value * inverse_scale;
+  // NOTE: NaN fails both comparisons and is mapped to zero below.
+  if (scaled >= 127.0f) return 127;
+  if (scaled <= -128.0f) return -128;
+  if (scaled >= 0.0f) return (iree_uk_int8_t)(scaled + 0.5f);
+  if (scaled < 0.0f) return (iree_uk_int8_t)(scaled - 0.5f);
+  return 0;
+}
+
+// Tile functions operate on elements of the output type: any conversion from
+// the input type is performed while copying into the temporary buffer.
 typedef void (*iree_uk_pack_tile_func_t)(
     void* IREE_UK_RESTRICT out_tile_ptr,
     const void* IREE_UK_RESTRICT in_tile_ptr, iree_uk_index_t outer_size1,
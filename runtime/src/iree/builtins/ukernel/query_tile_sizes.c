@@ -40,11 +40,39 @@ static iree_uk_matmul_tile_sizes_t iree_uk_query_matmul_tile_sizes_generic(
   return (iree_uk_matmul_tile_sizes_t){.M = 8, .K = 4, .N = 8};
 }
 
+static bool iree_uk_query_matmul_tile_sizes_tuned(
+    const iree_uk_query_tile_sizes_2d_params_t* params,
+    iree_uk_matmul_tile_sizes_t* out_matmul_tile_sizes) {
+  const iree_uk_matmul_tile_sizes_table_t* table = params->tuned_table;
+  if (!table) return false;
+  iree_uk_uint32_t op = iree_uk_query_tile_sizes_operation(params->flags);
+  iree_uk_uint32_t role = iree_uk_query_tile_sizes_operand_role(params->flags);
+  // Only the LHS and result operands have the row count as their size0. The
+  // RHS query skips row-limited entries; that is fine as those only differ in
+  // M0 which the RHS does not depend on.
+  bool have_rows = role != IREE_UK_FLAG_QUERY_TILE_SIZES_OPERAND_ROLE_RHS &&
+                   params->size0 >= 0;
+  for (iree_uk_index_t i = 0; i < table->count; ++i) {
+    const iree_uk_matmul_tile_sizes_tuned_t* entry = &table->entries[i];
+    if (entry->operation != op) continue;
+    if (entry->max_rows && !(have_rows && params->size0 <= entry->max_rows)) {
+      continue;
+    }
+    *out_matmul_tile_sizes = (iree_uk_matmul_tile_sizes_t){
+        .M = entry->M0, .K = entry->K0, .N = entry->N0};
+    return true;
+  }
+  return false;
+}
+
 static void iree_uk_query_tile_sizes_2d_matmul(
     const iree_uk_query_tile_sizes_2d_params_t* params,
     iree_uk_query_tile_sizes_2d_out_params_t* out_params) {
   iree_uk_matmul_tile_sizes_t matmul_tile_sizes;
-  if (!iree_uk_query_matmul_tile_sizes_arch(params, &matmul_tile_sizes)) {
+  if (iree_uk_query_matmul_tile_sizes_tuned(params, &matmul_tile_sizes)) {
+    // Tuned for this CPU model.
+  } else if (!iree_uk_query_matmul_tile_sizes_arch(params,
+                                                   &matmul_tile_sizes)) {
     matmul_tile_sizes = iree_uk_query_matmul_tile_sizes_generic(params);
   }
   iree_uk_uint32_t role = iree_uk_query_tile_sizes_operand_role(params->flags);
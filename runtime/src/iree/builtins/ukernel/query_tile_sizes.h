@@ -13,12 +13,38 @@
 // is the only place where target information is not known at compile time,
 // forcing deferral of tile-size selection to runtime.
 
+// A matmul tile size measured to be the fastest for an operation on a
+// specific CPU model, overriding the built-in per-architecture choice.
+typedef struct iree_uk_matmul_tile_sizes_tuned_t {
+  // One of IREE_UK_FLAG_QUERY_TILE_SIZES_OPERATION_*.
+  iree_uk_uint32_t operation;
+  // If non-zero the entry only applies to matmuls with at most this many LHS
+  // rows (such as skinny decode matmuls). Since the LHS, RHS and result
+  // operands are queried independently and only the LHS and result queries
+  // know the number of rows, such entries may only differ from the general
+  // entry for the same operation in M0: K0 and N0 must match.
+  iree_uk_index_t max_rows;
+  iree_uk_int32_t M0;
+  iree_uk_int32_t K0;
+  iree_uk_int32_t N0;
+} iree_uk_matmul_tile_sizes_tuned_t;
+
+// Table of tuned matmul tile sizes. Entries are matched in order and the
+// first applicable one is used, so row-limited entries must precede the
+// general entry for the same operation.
+typedef struct iree_uk_matmul_tile_sizes_table_t {
+  iree_uk_index_t count;
+  const iree_uk_matmul_tile_sizes_tuned_t* entries;
+} iree_uk_matmul_tile_sizes_table_t;
+
 // Parameters for a query_tile_sizes operation.
 typedef struct iree_uk_query_tile_sizes_2d_params_t {
   iree_uk_uint32_t flags;
   iree_uk_index_t size0;
   iree_uk_index_t size1;
   const iree_uk_uint64_t* cpu_data;
+  // Optional tuned tile sizes consulted before the built-in choice.
+  const iree_uk_matmul_tile_sizes_table_t* tuned_table;
 } iree_uk_query_tile_sizes_2d_params_t;
 
 typedef struct iree_uk_query_tile_sizes_2d_out_params_t {
@@ -23,6 +23,10 @@ IREE_FLAG(
     "Padding size (same value used for both dimensions, 0 means no padding)");
 IREE_FLAG(int32_t, inner_stride, 1,
           "Inner stride of the pack input buffers. Default 1 means unstrided.");
+IREE_FLAG(int32_t, slice_count, 1,
+          "Number of slices to split each pack into, as when distributing it "
+          "across workers. Slices are run back to back on the calling thread "
+          "so this measures the per-slice overhead.");
 
 static iree_status_t iree_uk_benchmark_pack(
     const iree_benchmark_def_t* benchmark_def,
@@ -85,11 +89,19 @@ static iree_status_t iree_uk_benchmark_pack(
   params.in_buffer = in_buffer;
   params.out_buffer = out_buffer;
   params.padding_value = 0;
+  params.quantize_scale = 1.0f / 64;
+  const int slice_count = iree_max(1, FLAG_slice_count);
   int64_t total_iterations = 0;
   int64_t batch_count = 1;
   while (iree_benchmark_keep_running(benchmark_state, batch_count)) {
     for (int i = 0; i < batch_count; ++i) {
-      iree_uk_pack_p(&params);
+      if (slice_count == 1) {
+        iree_uk_pack_p(&params);
+      } else {
+        for (int slice = 0; slice < slice_count; ++slice) {
+          iree_uk_pack_p_slice(&params, slice, slice_count);
+        }
+      }
     }
     total_iterations += batch_count;
     batch_count *= 2;
@@ -151,6 +163,9 @@ int main(int argc, char** argv) {
   iree_uk_benchmark_register_pack(IREE_UK_FLAG_PACK_TYPE_I8I8, 8, 4, "");
   // Tile size selected with cpu feature "i8mm".
   iree_uk_benchmark_register_pack(IREE_UK_FLAG_PACK_TYPE_I8I8, 8, 8, "");
+  // Packs fused with a conversion from f32.
+  iree_uk_benchmark_register_pack(IREE_UK_FLAG_PACK_TYPE_F32F16, 8, 1, "");
+  iree_uk_benchmark_register_pack(IREE_UK_FLAG_PACK_TYPE_F32S8, 8, 4, "");
 #elif defined(IREE_ARCH_X86_64)
   iree_uk_benchmark_register_pack(IREE_UK_FLAG_PACK_TYPE_F32F32, 8, 1,
                                   "avx2_fma");
@@ -170,11 +185,17 @@ int main(int argc, char** argv) {
                                   "avx2_fma");
   iree_uk_benchmark_register_pack(IREE_UK_FLAG_PACK_TYPE_I32I32, 16, 16,
                                   "avx512_base");
+  // Packs fused with a conversion from f32.
+  iree_uk_benchmark_register_pack(IREE_UK_FLAG_PACK_TYPE_F32BF16, 16, 2,
+                                  "avx512_base");
+  iree_uk_benchmark_register_pack(IREE_UK_FLAG_PACK_TYPE_F32S8, 16, 2,
+                                  "avx512_base");
 #else   // defined(IREE_ARCH_ARM_64)
   // Architectures on which we do not have any optimized ukernel code.
   // Benchmark some arbitrary tile shape.
   iree_uk_benchmark_register_pack(IREE_UK_FLAG_PACK_TYPE_F32F32, 8, 1, "");
   iree_uk_benchmark_register_pack(IREE_UK_FLAG_PACK_TYPE_I8I8, 8, 1, "");
+  iree_uk_benchmark_register_pack(IREE_UK_FLAG_PACK_TYPE_F32S8, 8, 1, "");
 #endif  // defined(IREE_ARCH_ARM_64)
 
   iree_uk_benchmark_run_and_cleanup();
@@ -10,11 +10,34 @@
 #include "iree/builtins/ukernel/tools/test.h"
 #include "iree/builtins/ukernel/tools/util.h"
 
+// Converts a single element from the input to the output type of |pack_type|.
+static void iree_pack_reference_convert(const iree_uk_pack_params_t* params,
+                                        iree_uk_pack_type_t pack_type,
+                                        char* out_ptr, const char* in_ptr,
+                                        iree_uk_index_t elem_size) {
+  switch (pack_type) {
+    case iree_uk_pack_type_f32bf16:
+      *(iree_uk_uint16_t*)out_ptr = iree_uk_f32_to_bf16(*(const float*)in_ptr);
+      break;
+    case iree_uk_pack_type_f32f16:
+      *(iree_uk_uint16_t*)out_ptr = iree_uk_f32_to_f16(*(const float*)in_ptr);
+      break;
+    case iree_uk_pack_type_f32s8:
+      *(iree_uk_int8_t*)out_ptr = iree_uk_pack_quantize_f32_to_s8(
+          *(const float*)in_ptr, 1.0f / params->quantize_scale);
+      break;
+    default:
+      memcpy(out_ptr, in_ptr, elem_size);
+      break;
+  }
+}
+
 static void iree_pack_reference(const iree_uk_pack_params_t* params) {
-  // For now, the input and output element types are always the same.
   iree_uk_pack_type_t pack_type = iree_uk_pack_type(params->flags);
-  iree_uk_type_t elem_type = iree_uk_pack_in_type(pack_type);
-  iree_uk_index_t elem_size = iree_uk_type_size(elem_type);
+  iree_uk_index_t in_elem_size =
+      iree_uk_type_size(iree_uk_pack_in_type(pack_type));
+  iree_uk_index_t elem_size =
+      iree_uk_type_size(iree_uk_pack_out_type(pack_type));
   iree_uk_index_t outer_size0 = params->out_size0;
   iree_uk_index_t outer_size1 = params->out_size1;
   iree_uk_index_t tile_size0 = params->out_size2;
@@ -61,8 +84,9 @@ static void iree_pack_reference(const iree_uk_pack_params_t* params) {
                                         i1 * params->in_stride1 +
                                         i0 * params->in_stride0;
             const char* in_ptr =
-                ((char*)params->in_buffer) + in_offset * elem_size;
-            memcpy(out_ptr, in_ptr, elem_size);
+                ((char*)params->in_buffer) + in_offset * in_elem_size;
+            iree_pack_reference_convert(params, pack_type, out_ptr, in_ptr,
+                                        elem_size);
           }
         }
       }
@@ -114,8 +138,21 @@ static void iree_uk_test_pack_for_shape_params(
   actual_params.out_buffer = (char*)actual_out_buffer -
                              (params.out_offset * iree_uk_type_size(out_type));
 
+  // Slices are run in reverse order to check that they are independent.
+  iree_uk_pack_params_t sliced_params;
+  memcpy(&sliced_params, &params, sizeof sliced_params);
+  void* sliced_out_buffer = malloc(out_buffer_size);
+  memcpy(sliced_out_buffer, actual_out_buffer, out_buffer_size);
+  sliced_params.out_buffer = (char*)sliced_out_buffer -
+                             (params.out_offset * iree_uk_type_size(out_type));
+  iree_uk_index_t slice_count =
+      1 + iree_uk_random_engine_get_0_65535(engine) % 5;
+
   iree_pack_reference(&reference_params);
   iree_uk_pack_p(&actual_params);
+  for (iree_uk_index_t i = slice_count - 1; i >= 0; --i) {
+    iree_uk_pack_p_slice(&sliced_params, i, slice_count);
+  }
 
   if (!iree_uk_2d_buffers_equal(
           actual_out_buffer, reference_out_buffer, out_type, params.out_size0,
@@ -123,9 +160,16 @@ static void iree_uk_test_pack_for_shape_params(
           params.out_stride0, 1)) {
     IREE_UK_TEST_FAIL(test);
   }
+  if (!iree_uk_2d_buffers_equal(
+          sliced_out_buffer, reference_out_buffer, out_type, params.out_size0,
+          params.out_size1 * params.out_size2 * params.out_size3,
+          params.out_stride0, 1)) {
+    IREE_UK_TEST_FAIL(test);
+  }
 
   free(reference_out_buffer);
   free(actual_out_buffer);
+  free(sliced_out_buffer);
   free(in_buffer);
 }
 
@@ -187,6 +231,9 @@ static void iree_uk_test_pack_for_tile_params(iree_uk_test_t* test,
             if (params.in_size1 < 0) params.in_size1 = 0;
           }
           params.padding_value = iree_uk_random_engine_get_uint64(engine);
+          // Small scales exercise saturation of quantized values.
+          params.quantize_scale =
+              iree_uk_random_engine_get_0_1(engine) ? 0.25f : 0.0078125f;
           iree_uk_test_pack_for_shape_params(test, &params);
         }
       }
@@ -217,6 +264,9 @@ int main(int argc, char** argv) {
   iree_uk_test_pack(IREE_UK_FLAG_PACK_TYPE_I32I32, 3, 4, "");
   iree_uk_test_pack(IREE_UK_FLAG_PACK_TYPE_F16F16, 6, 7, "");
   iree_uk_test_pack(IREE_UK_FLAG_PACK_TYPE_BF16BF16, 9, 2, "");
+  iree_uk_test_pack(IREE_UK_FLAG_PACK_TYPE_F32BF16, 5, 3, "");
+  iree_uk_test_pack(IREE_UK_FLAG_PACK_TYPE_F32F16, 3, 6, "");
+  iree_uk_test_pack(IREE_UK_FLAG_PACK_TYPE_F32S8, 7, 4, "");
 
 #if defined(IREE_ARCH_ARM_64)
   iree_uk_test_pack(IREE_UK_FLAG_PACK_TYPE_F32F32, 8, 1, "");
@@ -229,6 +279,8 @@ int main(int argc, char** argv) {
   iree_uk_test_pack(IREE_UK_FLAG_PACK_TYPE_I8I8, 8, 4, "");
   // Tile size selected for CPU feature i8mm. Same comment as for dotprod.
   iree_uk_test_pack(IREE_UK_FLAG_PACK_TYPE_I8I8, 8, 8, "");
+  // Converting packs use the tile functions of the output type.
+  iree_uk_test_pack(IREE_UK_FLAG_PACK_TYPE_F32S8, 8, 4, "");
 #elif defined(IREE_ARCH_X86_64)
   iree_uk_test_pack(IREE_UK_FLAG_PACK_TYPE_F32F32, 8, 1, "avx2_fma");
   iree_uk_test_pack(IREE_UK_FLAG_PACK_TYPE_I8I8, 8, 2, "avx2_fma");
@@ -239,6 +291,9 @@ int main(int argc, char** argv) {
   iree_uk_test_pack(IREE_UK_FLAG_PACK_TYPE_I8I8, 16, 2, "avx512_base");
   iree_uk_test_pack(IREE_UK_FLAG_PACK_TYPE_F32F32, 16, 16, "avx512_base");
   iree_uk_test_pack(IREE_UK_FLAG_PACK_TYPE_I32I32, 16, 16, "avx512_base");
+  // Converting packs use the tile functions of the output type.
+  iree_uk_test_pack(IREE_UK_FLAG_PACK_TYPE_F32BF16, 16, 2, "avx512_base");
+  iree_uk_test_pack(IREE_UK_FLAG_PACK_TYPE_F32S8, 16, 2, "avx512_base");
   // avx512_vnni uses the same tile size and same pack code as avx512_base.
 #endif  // defined(IREE_ARCH_ARM_64)
 
@@ -101,17 +101,36 @@ static void iree_uk_test_unpack_for_shape_params(
   actual_params.out_buffer = (char*)actual_out_buffer -
                              (params.out_offset * iree_uk_type_size(out_type));
 
+  // Slices are run in reverse order to check that they are independent.
+  iree_uk_unpack_params_t sliced_params;
+  memcpy(&sliced_params, &params, sizeof sliced_params);
+  void* sliced_out_buffer = malloc(out_buffer_size);
+  memcpy(sliced_out_buffer, actual_out_buffer, out_buffer_size);
+  sliced_params.out_buffer = (char*)sliced_out_buffer -
+                             (params.out_offset * iree_uk_type_size(out_type));
+  iree_uk_index_t slice_count =
+      1 + iree_uk_random_engine_get_0_65535(engine) % 5;
+
   iree_unpack_reference(&reference_params);
   iree_uk_unpack_p(&actual_params);
+  for (iree_uk_index_t i = slice_count - 1; i >= 0; --i) {
+    iree_uk_unpack_p_slice(&sliced_params, i, slice_count);
+  }
 
   if (!iree_uk_2d_buffers_equal(actual_out_buffer, reference_out_buffer,
                                 out_type, params.out_size0, params.out_size1,
                                 params.out_stride0, params.out_stride1)) {
     IREE_UK_TEST_FAIL(test);
   }
+  if (!iree_uk_2d_buffers_equal(sliced_out_buffer, actual_out_buffer,
+                                out_type, params.out_size0, params.out_size1,
+                                params.out_stride0, params.out_stride1)) {
+    IREE_UK_TEST_FAIL(test);
+  }
 
   free(reference_out_buffer);
   free(actual_out_buffer);
+  free(sliced_out_buffer);
   free(in_buffer);
 }
 
@@ -187,65 +187,78 @@ static void iree_uk_unpack_row_using_tile_func(
   }
 }
 
-static void iree_uk_unpack_using_tile_func(
-    const iree_uk_unpack_params_t* params,
-    iree_uk_unpack_tile_func_t tile_func) {
+// Unpacks rows of tiles [row_begin, row_end) where rows are along the outer
+// dimension corresponding to output dimension 0.
+static void iree_uk_unpack_rows_using_tile_func(
+    const iree_uk_unpack_params_t* params, iree_uk_unpack_tile_func_t tile_func,
+    iree_uk_index_t row_begin, iree_uk_index_t row_end) {
   // For now, the input and output element types are always the same.
   iree_uk_unpack_type_t unpack_type = iree_uk_unpack_type(params->flags);
   iree_uk_type_t elem_type = iree_uk_unpack_in_type(unpack_type);
   iree_uk_index_t elem_size = iree_uk_type_size(elem_type);
-  iree_uk_index_t outer_size0 = params->in_size0;
   iree_uk_index_t outer_size1 = params->in_size1;
   iree_uk_index_t tile_size0 = params->in_size2;
   iree_uk_index_t tile_size1 = params->in_size3;
   iree_uk_index_t in_stride0 = params->in_stride0;
   iree_uk_index_t in_stride1 = params->in_size3 * params->in_size2;
   if (params->flags & IREE_UK_FLAG_UNPACK_TRANSPOSE_OUTER) {
-    iree_uk_index_swap(&outer_size0, &outer_size1);
+    outer_size1 = params->in_size0;
     iree_uk_index_swap(&in_stride0, &in_stride1);
   }
   if (params->flags & IREE_UK_FLAG_UNPACK_TRANSPOSE_INNER) {
     iree_uk_index_swap(&tile_size0, &tile_size1);
   }
-  const char* in_buf =
-      (const char*)params->in_buffer + (params->in_offset * elem_size);
-  char* out_buf = (char*)params->out_buffer + (params->out_offset * elem_size);
+  const char* in_buf = (const char*)params->in_buffer +
+                       (params->in_offset + row_begin * in_stride0) * elem_size;
+  char* out_buf = (char*)params->out_buffer +
+                  (params->out_offset +
+                   row_begin * tile_size0 * params->out_stride0) *
+                      elem_size;
   // Prepare for handling incomplete tiles with a temporary buffer.
   iree_uk_unpack_tmpbuf_helper_t helper;
   iree_uk_unpack_tmpbuf_helper_init(tile_size0, tile_size1, elem_size, &helper);
-  // Compute number of tiles along both dimensions that fit entirely within the
-  // source buffer's boundaries.
+  // Compute number of tiles along dimension 1 that fit entirely within the
+  // destination buffer's boundaries.
   int dim1_full_tiles = params->out_size1 >> iree_uk_ceil_log2_u32(tile_size1);
-  iree_uk_index_t i0 = 0;
-  for (; i0 <= params->out_size0 - tile_size0; i0 += tile_size0) {
-    // Pack whole tiles that do not require padding (entirely within the source
-    // buffer's boundaries).
-    iree_uk_unpack_row_using_tile_func(
-        tile_func, 0, dim1_full_tiles, tile_size0, tile_size0, tile_size1,
-        elem_size, params->out_size1, params->out_stride0, params->out_stride1,
-        in_stride1, /*whole_tiles=*/true, &helper, in_buf, out_buf);
-    // Right-padding.
-    iree_uk_unpack_row_using_tile_func(
-        tile_func, dim1_full_tiles, outer_size1, tile_size0, tile_size0,
-        tile_size1, elem_size, params->out_size1, params->out_stride0,
-        params->out_stride1, in_stride1, /*whole_tiles=*/false, &helper, in_buf,
-        out_buf);
-    out_buf += tile_size0 * params->out_stride0 * elem_size;
-    in_buf += in_stride0 * elem_size;
-  }
-  // Bottom-padding.
-  for (; i0 < outer_size0 * tile_size0; i0 += tile_size0) {
-    iree_uk_index_t dim0_write_size =
-        iree_uk_index_clamp(params->out_size0 - i0, 0, tile_size0);
-    iree_uk_unpack_row_using_tile_func(
-        tile_func, 0, outer_size1, dim0_write_size, tile_size0, tile_size1,
-        elem_size, params->out_size1, params->out_stride0, params->out_stride1,
-        in_stride1, /*whole_tiles=*/false, &helper, in_buf, out_buf);
+  for (iree_uk_index_t row = row_begin; row < row_end; ++row) {
+    iree_uk_index_t i0 = row * tile_size0;
+    if (i0 + tile_size0 <= params->out_size0) {
+      // Unpack whole tiles that do not require padding (entirely within the
+      // destination buffer's boundaries).
+      iree_uk_unpack_row_using_tile_func(
+          tile_func, 0, dim1_full_tiles, tile_size0, tile_size0, tile_size1,
+          elem_size, params->out_size1, params->out_stride0,
+          params->out_stride1, in_stride1, /*whole_tiles=*/true, &helper,
+          in_buf, out_buf);
+      // Right-padding.
+      iree_uk_unpack_row_using_tile_func(
+          tile_func, dim1_full_tiles, outer_size1, tile_size0, tile_size0,
+          tile_size1, elem_size, params->out_size1, params->out_stride0,
+          params->out_stride1, in_stride1, /*whole_tiles=*/false, &helper,
+          in_buf, out_buf);
+    } else {
+      // Bottom-padding.
+      iree_uk_index_t dim0_write_size =
+          iree_uk_index_clamp(params->out_size0 - i0, 0, tile_size0);
+      iree_uk_unpack_row_using_tile_func(
+          tile_func, 0, outer_size1, dim0_write_size, tile_size0, tile_size1,
+          elem_size, params->out_size1, params->out_stride0,
+          params->out_stride1, in_stride1, /*whole_tiles=*/false, &helper,
+          in_buf, out_buf);
+    }
     out_buf += tile_size0 * params->out_stride0 * elem_size;
     in_buf += in_stride0 * elem_size;
   }
 }
 
+// Returns the number of rows of tiles iterated by the outer loop.
+static iree_uk_index_t iree_uk_unpack_row_count(
+    const iree_uk_unpack_params_t* params) {
+  return (params->flags & IREE_UK_FLAG_UNPACK_TRANSPOSE_OUTER)
+             ? params->in_size1
+             : params->in_size0;
+}
+
 void iree_uk_unpack_p(const iree_uk_unpack_params_t* params) {
   iree_uk_unpack_validate(params);
 
@@ -253,7 +266,33 @@ void iree_uk_unpack_p(const iree_uk_unpack_params_t* params) {
 
   // Select a target-specific tile_func and use that with generic outer loops.
   iree_uk_unpack_tile_func_t func = iree_uk_unpack_select_tile_func(params);
-  iree_uk_unpack_using_tile_func(params, func);
+  iree_uk_unpack_rows_using_tile_func(params, func, 0,
+                                      iree_uk_unpack_row_count(params));
+}
+
+void iree_uk_unpack_p_slice(const iree_uk_unpack_params_t* params,
+                            iree_uk_index_t slice_index,
+                            iree_uk_index_t slice_count) {
+  IREE_UK_ASSERT(slice_count > 0);
+  IREE_UK_ASSERT(slice_index >= 0 && slice_index < slice_count);
+  iree_uk_unpack_validate(params);
+
+  if (iree_uk_unpack_early(params)) return;
+
+  // Distribute rows such that slice sizes differ by at most one row. Each row
+  // of tiles writes a disjoint range of the output buffer.
+  iree_uk_index_t row_count = iree_uk_unpack_row_count(params);
+  iree_uk_index_t rows_per_slice = row_count / slice_count;
+  iree_uk_index_t remainder_rows = row_count % slice_count;
+  iree_uk_index_t row_begin =
+      slice_index * rows_per_slice +
+      iree_uk_index_min(slice_index, remainder_rows);
+  iree_uk_index_t row_end =
+      row_begin + rows_per_slice + (slice_index < remainder_rows ? 1 : 0);
+  if (row_begin >= row_end) return;
+
+  iree_uk_unpack_tile_func_t func = iree_uk_unpack_select_tile_func(params);
+  iree_uk_unpack_rows_using_tile_func(params, func, row_begin, row_end);
 }
 
 IREE_UK_EXPORT void iree_uk_unpack(
@@ -283,3 +322,32 @@ IREE_UK_EXPORT void iree_uk_unpack(
                                     .cpu_data = cpu_data};
   iree_uk_unpack_p(&params);
 }
+
+IREE_UK_EXPORT void iree_uk_unpack_slice(
+    const void* in_buffer, iree_uk_index_t in_offset,
+    iree_uk_index_t in_stride0, iree_uk_index_t in_stride1, void* out_buffer,
+    iree_uk_index_t out_offset, iree_uk_index_t out_stride0,
+    iree_uk_index_t out_stride1, iree_uk_index_t in_size0,
+    iree_uk_index_t in_size1, iree_uk_index_t in_size2,
+    iree_uk_index_t in_size3, iree_uk_index_t out_size0,
+    iree_uk_index_t out_size1, iree_uk_index_t slice_index,
+    iree_uk_index_t slice_count, iree_uk_uint32_t flags,
+    const iree_uk_uint64_t* cpu_data) {
+  iree_uk_unpack_params_t params = {.in_buffer = in_buffer,
+                                    .in_offset = in_offset,
+                                    .in_stride0 = in_stride0,
+                                    .in_stride1 = in_stride1,
+                                    .out_buffer = out_buffer,
+                                    .out_offset = out_offset,
+                                    .out_stride0 = out_stride0,
+                                    .out_stride1 = out_stride1,
+                                    .in_size0 = in_size0,
+                                    .in_size1 = in_size1,
+                                    .in_size2 = in_size2,
+                                    .in_size3 = in_size3,
+                                    .out_size0 = out_size0,
+                                    .out_size1 = out_size1,
+                                    .flags = flags,
+                                    .cpu_data = cpu_data};
+  iree_uk_unpack_p_slice(&params, slice_index, slice_count);
+}
@@ -24,4 +24,21 @@ IREE_UK_EXPORT void iree_uk_unpack(
     iree_uk_index_t out_size1, iree_uk_uint32_t flags,
     const iree_uk_uint64_t* cpu_data);
 
+// Executor entry point for splitting large unpacks across multiple workers.
+// Performs the |slice_index|-th of |slice_count| slices of the equivalent
+// iree_uk_unpack. Slices are contiguous ranges of rows of input tiles balanced
+// to within one row and each slice writes a disjoint range of `out_buffer`,
+// so all slices of an unpack may run concurrently without synchronization.
+// Performing all slices produces the same result as iree_uk_unpack.
+IREE_UK_EXPORT void iree_uk_unpack_slice(
+    const void* in_buffer, iree_uk_index_t in_offset,
+    iree_uk_index_t in_stride0, iree_uk_index_t in_stride1, void* out_buffer,
+    iree_uk_index_t out_offset, iree_uk_index_t out_stride0,
+    iree_uk_index_t out_stride1, iree_uk_index_t in_size0,
+    iree_uk_index_t in_size1, iree_uk_index_t in_size2,
+    iree_uk_index_t in_size3, iree_uk_index_t out_size0,
+    iree_uk_index_t out_size1, iree_uk_index_t slice_index,
+    iree_uk_index_t slice_count, iree_uk_uint32_t flags,
+    const iree_uk_uint64_t* cpu_data);
+
 #endif  // IREE_BUILTINS_UKERNEL_UNPACK_H_
@@ -30,6 +30,12 @@ typedef struct iree_uk_unpack_params_t {
 
 void iree_uk_unpack_p(const iree_uk_unpack_params_t* params);
 
+// Unpacks the |slice_index|-th of |slice_count| slices of |params|.
+// See iree_uk_unpack_slice.
+void iree_uk_unpack_p_slice(const iree_uk_unpack_params_t* params,
+                            iree_uk_index_t slice_index,
+                            iree_uk_index_t slice_count);
+
 typedef enum iree_uk_unpack_type_t {
   iree_uk_unpack_type_f32f32 = IREE_UK_TIE_2_TYPES_LITERAL(FLOAT_32, FLOAT_32),
   iree_uk_unpack_type_i32i32 = IREE_UK_TIE_2_TYPES_LITERAL(INT_32, INT_32),
@@ -9,6 +9,7 @@
 #include <string.h>
 
 #include "iree/base/api.h"
+#include "iree/base/internal/object_pool.h"
 #include "iree/hal/allocator.h"
 #include "iree/hal/buffer.h"
 #include "iree/hal/buffer_heap_impl.h"
@@ -55,6 +56,12 @@ typedef struct iree_hal_heap_buffer_t {
 
 static const iree_hal_buffer_vtable_t iree_hal_heap_buffer_vtable;
 
+// Wrapped external buffers are created for every imported host allocation and
+// are pooled when using the system allocator. Allocated buffers are not pooled
+// as their metadata is usually part of the (large) data allocation.
+static iree_object_pool_type_t iree_hal_heap_buffer_wrap_pool_type =
+    IREE_OBJECT_POOL_TYPE_INITIALIZER("iree_hal_heap_buffer_wrap");
+
 // Allocates a buffer with the metadata and storage split.
 // This results in an additional host allocation but allows for user-overridden
 // data storage allocations.
@@ -190,6 +197,8 @@ iree_status_t iree_hal_heap_buffer_wrap(
         (int)IREE_HAL_HEAP_BUFFER_ALIGNMENT, data.data);
   }
 
+  host_allocator = iree_object_pool_type_allocator(
+      &iree_hal_heap_buffer_wrap_pool_type, host_allocator);
   iree_hal_heap_buffer_t* buffer = NULL;
   iree_status_t status =
       iree_allocator_malloc(host_allocator, sizeof(*buffer), (void**)&buffer);
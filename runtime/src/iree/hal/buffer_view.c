@@ -7,6 +7,7 @@
 #include "iree/hal/buffer_view.h"
 
 #include "iree/base/api.h"
+#include "iree/base/internal/object_pool.h"
 #include "iree/hal/allocator.h"
 #include "iree/hal/buffer_view_util.h"
 #include "iree/hal/resource.h"
@@ -22,6 +23,11 @@ struct iree_hal_buffer_view_t {
   iree_hal_dim_t shape[];
 };
 
+// Buffer views are created and destroyed on every invocation and are pooled
+// when using the system allocator.
+static iree_object_pool_type_t iree_hal_buffer_view_pool_type =
+    IREE_OBJECT_POOL_TYPE_INITIALIZER("iree_hal_buffer_view");
+
 IREE_API_EXPORT iree_status_t iree_hal_buffer_view_create(
     iree_hal_buffer_t* buffer, iree_host_size_t shape_rank,
     const iree_hal_dim_t* shape, iree_hal_element_type_t element_type,
@@ -40,6 +46,8 @@ IREE_API_EXPORT iree_status_t iree_hal_buffer_view_create(
 
   // Allocate and initialize the iree_hal_buffer_view_t struct.
   // Note that we have the dynamically-sized shape dimensions on the end.
+  host_allocator = iree_object_pool_type_allocator(
+      &iree_hal_buffer_view_pool_type, host_allocator);
   iree_hal_buffer_view_t* buffer_view = NULL;
   iree_status_t status = iree_allocator_malloc(
       host_allocator,
@@ -30,6 +30,9 @@ typedef struct iree_elf_module_load_state_t {
   iree_elf_addr_t init;               // DT_INIT
   const iree_elf_addr_t* init_array;  // DT_INIT_ARRAY
   iree_host_size_t init_array_count;  // DT_INIT_ARRAYSZ
+
+  // Size of the large pages backing read-only segments or 0 if not used.
+  iree_host_size_t large_page_size;
 } iree_elf_module_load_state_t;
 
 // Verifies the ELF file header and machine class.
@@ -229,22 +232,218 @@ static iree_byte_range_t iree_elf_module_calculate_vaddr_range(
   return byte_range;
 }
 
+// Requests that the whole large pages within the segment |phdr| be backed by
+// large pages. This is a hint and failures are ignored.
+static void iree_elf_module_advise_large_pages(
+    iree_elf_module_t* module, const iree_elf_phdr_t* phdr,
+    iree_host_size_t large_page_size) {
+  uintptr_t segment_start = (uintptr_t)(module->vaddr_bias + phdr->p_vaddr);
+  uintptr_t segment_end = segment_start + (uintptr_t)phdr->p_memsz;
+  uintptr_t range_start = iree_host_align(segment_start, large_page_size);
+  uintptr_t range_end = segment_end & ~(uintptr_t)(large_page_size - 1);
+  if (range_end <= range_start) return;
+  iree_byte_range_t byte_range = {
+      .offset = 0,
+      .length = range_end - range_start,
+  };
+  iree_status_t status =
+      iree_memory_view_advise_large_pages((void*)range_start, 1, &byte_range);
+  if (iree_status_is_ok(status)) {
+    module->large_page_length += byte_range.length;
+  } else {
+    iree_status_ignore(status);
+  }
+}
+
+// DT_FLAGS bit indicating relocations may modify non-writable segments.
+#define IREE_ELF_DF_TEXTREL 0x4
+
+// Returns the PT_LOAD segment containing the |length| bytes at |vaddr| or NULL
+// if the range is not entirely within a single segment.
+static const iree_elf_phdr_t* iree_elf_module_find_segment(
+    iree_elf_module_load_state_t* load_state, iree_elf_addr_t vaddr,
+    iree_host_size_t length) {
+  for (iree_elf_half_t i = 0; i < load_state->ehdr->e_phnum; ++i) {
+    const iree_elf_phdr_t* phdr = &load_state->phdr_table[i];
+    if (phdr->p_type != IREE_ELF_PT_LOAD) continue;
+    if (vaddr >= phdr->p_vaddr && length <= phdr->p_memsz &&
+        vaddr - phdr->p_vaddr <= phdr->p_memsz - length) {
+      return phdr;
+    }
+  }
+  return NULL;
+}
+
+// Returns true if all relocations in the table at |table_vaddr| only modify
+// writable segments.
+static bool iree_elf_module_relocations_are_writable(
+    iree_const_byte_span_t raw_data, iree_elf_module_load_state_t* load_state,
+    iree_elf_addr_t table_vaddr, iree_host_size_t table_size,
+    iree_host_size_t entry_size) {
+  if (!table_size) return true;
+  const iree_elf_phdr_t* table_phdr =
+      iree_elf_module_find_segment(load_state, table_vaddr, table_size);
+  if (!table_phdr || table_vaddr - table_phdr->p_vaddr + table_size >
+                         table_phdr->p_filesz) {
+    return false;
+  }
+  const uint8_t* table = raw_data.data + table_phdr->p_offset +
+                         (table_vaddr - table_phdr->p_vaddr);
+  for (iree_host_size_t offset = 0; offset + entry_size <= table_size;
+       offset += entry_size) {
+    // r_offset is the first field of both iree_elf_rel_t and iree_elf_rela_t.
+    iree_elf_addr_t r_offset = 0;
+    memcpy(&r_offset, table + offset, sizeof(r_offset));
+    const iree_elf_phdr_t* phdr = iree_elf_module_find_segment(
+        load_state, r_offset, sizeof(iree_elf_addr_t));
+    if (!phdr || !(phdr->p_flags & IREE_ELF_PF_W)) return false;
+  }
+  return true;
+}
+
+// Returns true if the read-only segments of the module can be mapped from
+// memory shared with other instances of the same module: they must not be
+// modified by relocations and must not share host pages with any writable
+// segment (which must remain private to each instance).
+static bool iree_elf_module_can_share_segments(
+    iree_const_byte_span_t raw_data, iree_elf_module_load_state_t* load_state) {
+  const iree_host_size_t page_size = load_state->memory_info.normal_page_size;
+  bool any_shared = false;
+  for (iree_elf_half_t i = 0; i < load_state->ehdr->e_phnum; ++i) {
+    const iree_elf_phdr_t* phdr = &load_state->phdr_table[i];
+    if (phdr->p_type != IREE_ELF_PT_LOAD || (phdr->p_flags & IREE_ELF_PF_W)) {
+      continue;
+    }
+    any_shared = true;
+    iree_elf_addr_t start = iree_page_align_start(phdr->p_vaddr, page_size);
+    iree_elf_addr_t end =
+        iree_page_align_end(phdr->p_vaddr + phdr->p_memsz, page_size);
+    for (iree_elf_half_t j = 0; j < load_state->ehdr->e_phnum; ++j) {
+      const iree_elf_phdr_t* other = &load_state->phdr_table[j];
+      if (other->p_type != IREE_ELF_PT_LOAD ||
+          !(other->p_flags & IREE_ELF_PF_W)) {
+        continue;
+      }
+      iree_elf_addr_t other_start =
+          iree_page_align_start(other->p_vaddr, page_size);
+      iree_elf_addr_t other_end =
+          iree_page_align_end(other->p_vaddr + other->p_memsz, page_size);
+      if (start < other_end && other_start < end) return false;
+    }
+  }
+  if (!any_shared) return false;
+
+  // Find the relocation tables in the file. The loaded dynamic table is parsed
+  // again after loading but we need to know before choosing how to load.
+  const iree_elf_dyn_t* dyn_table = NULL;
+  iree_host_size_t dyn_table_count = 0;
+  for (iree_elf_half_t i = 0; i < load_state->ehdr->e_phnum; ++i) {
+    const iree_elf_phdr_t* phdr = &load_state->phdr_table[i];
+    if (phdr->p_type != IREE_ELF_PT_DYNAMIC) continue;
+    if (phdr->p_offset + phdr->p_filesz > raw_data.data_length) return false;
+    dyn_table = (const iree_elf_dyn_t*)(raw_data.data + phdr->p_offset);
+    dyn_table_count = phdr->p_filesz / sizeof(iree_elf_dyn_t);
+    break;
+  }
+  if (!dyn_table) return false;
+  iree_elf_addr_t rel_vaddr = 0, rela_vaddr = 0, jmprel_vaddr = 0;
+  iree_host_size_t rel_size = 0, rela_size = 0, jmprel_size = 0;
+  iree_host_size_t jmprel_entry_size = sizeof(iree_elf_rela_t);
+  for (iree_host_size_t i = 0; i < dyn_table_count; ++i) {
+    const iree_elf_dyn_t* dyn = &dyn_table[i];
+    switch (dyn->d_tag) {
+      case IREE_ELF_DT_TEXTREL:
+        return false;
+      case IREE_ELF_DT_FLAGS:
+        if (dyn->d_un.d_val & IREE_ELF_DF_TEXTREL) return false;
+        break;
+      case IREE_ELF_DT_REL:
+        rel_vaddr = dyn->d_un.d_ptr;
+        break;
+      case IREE_ELF_DT_RELSZ:
+        rel_size = dyn->d_un.d_val;
+        break;
+      case IREE_ELF_DT_RELA:
+        rela_vaddr = dyn->d_un.d_ptr;
+        break;
+      case IREE_ELF_DT_RELASZ:
+        rela_size = dyn->d_un.d_val;
+        break;
+      case IREE_ELF_DT_JMPREL:
+        jmprel_vaddr = dyn->d_un.d_ptr;
+        break;
+      case IREE_ELF_DT_PLTRELSZ:
+        jmprel_size = dyn->d_un.d_val;
+        break;
+      case IREE_ELF_DT_PLTREL:
+        jmprel_entry_size = dyn->d_un.d_val == IREE_ELF_DT_REL
+                                ? sizeof(iree_elf_rel_t)
+                                : sizeof(iree_elf_rela_t);
+        break;
+      default:
+        break;
+    }
+  }
+  return iree_elf_module_relocations_are_writable(
+             raw_data, load_state, rel_vaddr, rel_size,
+             sizeof(iree_elf_rel_t)) &&
+         iree_elf_module_relocations_are_writable(
+             raw_data, load_state, rela_vaddr, rela_size,
+             sizeof(iree_elf_rela_t)) &&
+         iree_elf_module_relocations_are_writable(
+             raw_data, load_state, jmprel_vaddr, jmprel_size,
+             jmprel_entry_size);
+}
+
+// Returns the total length of the module virtual address space reservation.
+static iree_host_size_t iree_elf_module_calculate_vaddr_size(
+    iree_elf_module_load_state_t* load_state, iree_byte_range_t vaddr_range) {
+  return iree_page_align_end(vaddr_range.length,
+                             load_state->memory_info.normal_page_size);
+}
+
 // Allocates space for and loads all DT_LOAD segments into the host virtual
-// address space.
+// address space. If |shared_segments| is provided the read-only segments are
+// mapped from it instead of private pages and either populated from |raw_data|
+// (if |populate_shared_segments|) or verified to match it.
 static iree_status_t iree_elf_module_load_segments(
-    iree_const_byte_span_t raw_data, iree_elf_module_load_state_t* load_state,
+    iree_const_byte_span_t raw_data, iree_elf_module_flags_t flags,
+    iree_elf_module_load_state_t* load_state,
+    const iree_memory_shared_t* shared_segments, bool populate_shared_segments,
     iree_elf_module_t* module) {
   // Calculate the total internally-aligned vaddr range.
   iree_byte_range_t vaddr_range =
       iree_elf_module_calculate_vaddr_range(load_state);
 
+  // Large pages are only useful if the module spans at least one of them. If
+  // used we align the reservation such that the ELF virtual address space is
+  // large page aligned and any large page aligned ranges within the ELF are
+  // also large page aligned in the host.
+  const iree_host_size_t large_page_size =
+      load_state->memory_info.large_page_granularity;
+  // Shared segments are backed by the shared memory object and don't get large
+  // pages.
+  const bool use_large_pages =
+      !shared_segments &&
+      iree_all_bits_set(flags, IREE_ELF_MODULE_FLAG_LARGE_PAGES) &&
+      large_page_size > load_state->memory_info.normal_page_size &&
+      vaddr_range.length >= large_page_size &&
+      (vaddr_range.offset % large_page_size) == 0;
+  load_state->large_page_size = use_large_pages ? large_page_size : 0;
+
   // Reserve virtual address space in the host memory space. This memory is
   // uncommitted by default as the ELF may only sparsely use the address space.
-  module->vaddr_size = iree_page_align_end(
-      vaddr_range.length, load_state->memory_info.normal_page_size);
-  IREE_RETURN_IF_ERROR(iree_memory_view_reserve(
-      IREE_MEMORY_VIEW_FLAG_MAY_EXECUTE, module->vaddr_size,
-      module->host_allocator, (void**)&module->vaddr_base));
+  iree_memory_view_flags_t view_flags = IREE_MEMORY_VIEW_FLAG_MAY_EXECUTE;
+  if (use_large_pages) view_flags |= IREE_MEMORY_VIEW_FLAG_LARGE_PAGES;
+  module->vaddr_size =
+      iree_elf_module_calculate_vaddr_size(load_state, vaddr_range);
+  if (shared_segments && shared_segments->total_length < module->vaddr_size) {
+    return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                            "shared segments smaller than the module");
+  }
+  IREE_RETURN_IF_ERROR(iree_memory_view_reserve(view_flags, module->vaddr_size,
+                                                module->host_allocator,
+                                                (void**)&module->vaddr_base));
   module->vaddr_bias = module->vaddr_base - vaddr_range.offset;
 
   // Commit and load all of the segments.
@@ -252,6 +451,39 @@ static iree_status_t iree_elf_module_load_segments(
     const iree_elf_phdr_t* phdr = &load_state->phdr_table[i];
     if (phdr->p_type != IREE_ELF_PT_LOAD) continue;
 
+    // Read-only segments are mapped from the shared memory at the same offset
+    // they have in the view. Only the instance populating them needs write
+    // access; all others verify that their ELF data matches what was mapped.
+    if (shared_segments && !(phdr->p_flags & IREE_ELF_PF_W)) {
+      iree_byte_range_t shared_range = {
+          .offset = phdr->p_vaddr - vaddr_range.offset,
+          .length = phdr->p_memsz,
+      };
+      IREE_RETURN_IF_ERROR(iree_memory_view_map_shared_ranges(
+          module->vaddr_base, 1, &shared_range, shared_segments,
+          populate_shared_segments
+              ? IREE_MEMORY_ACCESS_READ | IREE_MEMORY_ACCESS_WRITE
+              : IREE_MEMORY_ACCESS_READ));
+      uint8_t* segment = module->vaddr_bias + phdr->p_vaddr;
+      if (populate_shared_segments) {
+        if (phdr->p_filesz > 0) {
+          memcpy(segment, raw_data.data + phdr->p_offset, phdr->p_filesz);
+        }
+        continue;
+      }
+      bool matches = memcmp(segment, raw_data.data + phdr->p_offset,
+                            phdr->p_filesz) == 0;
+      for (iree_host_size_t j = phdr->p_filesz; matches && j < phdr->p_memsz;
+           ++j) {
+        matches = segment[j] == 0;
+      }
+      if (!matches) {
+        return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                                "shared segments do not match the ELF data");
+      }
+      continue;
+    }
+
     // Commit the range of pages used by this segment, initially with write
     // access so that we can modify the pages.
     iree_byte_range_t byte_range = {
@@ -345,6 +577,24 @@ static iree_status_t iree_elf_module_protect_segments(
   return iree_ok_status();
 }
 
+// Requests that the read-only segments (text/rodata) be backed by large pages.
+// This must be performed after protection so that the advice applies to the
+// final mappings: changing the protection of a range splits the mapping and
+// the populated pages are only collapsed into large pages once they are no
+// longer modified. Writable segments are left with normal pages as they are
+// usually small and their pages are dirtied independently.
+static void iree_elf_module_advise_segments(
+    iree_elf_module_load_state_t* load_state, iree_elf_module_t* module) {
+  if (!load_state->large_page_size) return;
+  for (iree_elf_half_t i = 0; i < load_state->ehdr->e_phnum; ++i) {
+    const iree_elf_phdr_t* phdr = &load_state->phdr_table[i];
+    if (phdr->p_type != IREE_ELF_PT_LOAD) continue;
+    if (phdr->p_flags & IREE_ELF_PF_W) continue;
+    iree_elf_module_advise_large_pages(module, phdr,
+                                       load_state->large_page_size);
+  }
+}
+
 // Unloads the ELF segments from memory and releases the host virtual address
 // space reservation.
 static void iree_elf_module_unload_segments(iree_elf_module_t* module) {
@@ -356,6 +606,7 @@ static void iree_elf_module_unload_segments(iree_elf_module_t* module) {
   module->vaddr_base = NULL;
   module->vaddr_bias = NULL;
   module->vaddr_size = 0;
+  module->large_page_length = 0;
 }
 
 //==============================================================================
@@ -570,9 +821,12 @@ static const iree_elf_sym_t* iree_elf_module_lookup_global_symbol(
 // API
 //==============================================================================
 
-iree_status_t iree_elf_module_initialize_from_memory(
+// Initializes |out_module| from |raw_data| with its read-only segments
+// optionally mapped from |shared_segments|.
+static iree_status_t iree_elf_module_initialize(
     iree_const_byte_span_t raw_data,
-    const iree_elf_import_table_t* import_table,
+    const iree_elf_import_table_t* import_table, iree_elf_module_flags_t flags,
+    const iree_memory_shared_t* shared_segments, bool populate_shared_segments,
     iree_allocator_t host_allocator, iree_elf_module_t* out_module) {
   IREE_ASSERT_ARGUMENT(raw_data.data);
   IREE_ASSERT_ARGUMENT(out_module);
@@ -593,10 +847,19 @@ iree_status_t iree_elf_module_initialize_from_memory(
       iree_elf_module_parse_headers(raw_data, &load_state, out_module);
   out_module->host_allocator = host_allocator;
 
+  // Modules can only map shared segments if they don't relocate them.
+  if (iree_status_is_ok(status) && shared_segments &&
+      !iree_elf_module_can_share_segments(raw_data, &load_state)) {
+    status = iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                              "module read-only segments cannot be shared");
+  }
+
   // Allocate and load the ELF into memory.
   iree_memory_jit_context_begin();
   if (iree_status_is_ok(status)) {
-    status = iree_elf_module_load_segments(raw_data, &load_state, out_module);
+    status = iree_elf_module_load_segments(
+        raw_data, flags, &load_state, shared_segments, populate_shared_segments,
+        out_module);
   }
 
   // Parse required dynamic symbol tables in loaded memory. These are used for
@@ -623,6 +886,11 @@ iree_status_t iree_elf_module_initialize_from_memory(
   }
   iree_memory_jit_context_end();
 
+  // Back the final read-only mappings with large pages, if requested.
+  if (iree_status_is_ok(status)) {
+    iree_elf_module_advise_segments(&load_state, out_module);
+  }
+
   // Run initializers prior to returning to the caller.
   if (iree_status_is_ok(status)) {
     status = iree_elf_module_run_initializers(&load_state, out_module);
@@ -637,6 +905,43 @@ iree_status_t iree_elf_module_initialize_from_memory(
   return status;
 }
 
+iree_status_t iree_elf_module_initialize_from_memory(
+    iree_const_byte_span_t raw_data,
+    const iree_elf_import_table_t* import_table, iree_elf_module_flags_t flags,
+    iree_allocator_t host_allocator, iree_elf_module_t* out_module) {
+  return iree_elf_module_initialize(raw_data, import_table, flags,
+                                    /*shared_segments=*/NULL,
+                                    /*populate_shared_segments=*/false,
+                                    host_allocator, out_module);
+}
+
+iree_status_t iree_elf_module_query_shared_segments_length(
+    iree_const_byte_span_t raw_data, iree_host_size_t* out_length) {
+  IREE_ASSERT_ARGUMENT(out_length);
+  *out_length = 0;
+  IREE_RETURN_IF_ERROR(iree_fatelf_select(raw_data, &raw_data));
+  iree_elf_module_load_state_t load_state;
+  iree_elf_module_t module;
+  IREE_RETURN_IF_ERROR(
+      iree_elf_module_parse_headers(raw_data, &load_state, &module));
+  if (iree_elf_module_can_share_segments(raw_data, &load_state)) {
+    *out_length = iree_elf_module_calculate_vaddr_size(
+        &load_state, iree_elf_module_calculate_vaddr_range(&load_state));
+  }
+  return iree_ok_status();
+}
+
+iree_status_t iree_elf_module_initialize_with_shared_segments(
+    iree_const_byte_span_t raw_data,
+    const iree_elf_import_table_t* import_table,
+    const iree_memory_shared_t* shared_segments, bool populate,
+    iree_allocator_t host_allocator, iree_elf_module_t* out_module) {
+  IREE_ASSERT_ARGUMENT(shared_segments);
+  return iree_elf_module_initialize(raw_data, import_table,
+                                    IREE_ELF_MODULE_FLAG_NONE, shared_segments,
+                                    populate, host_allocator, out_module);
+}
+
 void iree_elf_module_deinitialize(iree_elf_module_t* module) {
   IREE_TRACE_ZONE_BEGIN(z0);
 
@@ -12,6 +12,7 @@
 #include "iree/base/api.h"
 #include "iree/hal/local/elf/arch.h"       // IWYU pragma: export
 #include "iree/hal/local/elf/elf_types.h"  // IWYU pragma: export
+#include "iree/hal/local/elf/platform.h"
 
 //==============================================================================
 // ELF symbol import table
@@ -49,6 +50,14 @@ typedef struct iree_elf_module_t {
   // host page granularity was larger than the ELF's defined granularity.
   uint8_t* vaddr_bias;
 
+  // Total size, in bytes, of read-only segments (text/rodata) that were
+  // requested to be backed by large pages. 0 if large pages were not used.
+  iree_host_size_t large_page_length;
+
+  // Registry entry owning the shared read-only segments mapped by the module
+  // or NULL if all segments are private. See iree_elf_module_registry_t.
+  struct iree_elf_shared_segments_t* shared_segments;
+
   // Dynamic symbol string table (.dynstr).
   const char* dynstr;            // DT_STRTAB
   iree_host_size_t dynstr_size;  // DT_STRSZ (bytes)
@@ -58,6 +67,20 @@ typedef struct iree_elf_module_t {
   iree_host_size_t dynsym_count;  // DT_SYMENT (bytes) / sizeof(iree_elf_sym_t)
 } iree_elf_module_t;
 
+// Controls ELF module loading behavior.
+enum iree_elf_module_flag_bits_t {
+  IREE_ELF_MODULE_FLAG_NONE = 0u,
+
+  // Backs the read-only segments (text/rodata) with large pages (2 MiB
+  // transparent huge pages on Linux) when the platform supports it. Large
+  // executables with tens of MB of code can see significant iTLB miss
+  // reductions when their text is mapped with large pages at the cost of higher
+  // resident memory usage for partially touched pages. Modules smaller than a
+  // single large page are unaffected.
+  IREE_ELF_MODULE_FLAG_LARGE_PAGES = 1u << 0,
+};
+typedef uint32_t iree_elf_module_flags_t;
+
 // Initializes an ELF module from the ELF |raw_data| in memory.
 // |raw_data| only needs to remain valid for the initialization of the module
 // and may be discarded afterward.
@@ -67,14 +90,42 @@ typedef struct iree_elf_module_t {
 // system and initialization will fail if any are not present in the provided
 // table.
 //
+// |flags| control how the module is mapped into memory and do not change its
+// behavior.
+//
 // Upon return |out_module| is initialized and ready for use with any present
 // .init initialization functions having been executed. To release memory
 // allocated by the module during loading iree_elf_module_deinitialize must be
 // called to unload when it is safe (no more outstanding pointers into the
 // loaded module, etc).
 iree_status_t iree_elf_module_initialize_from_memory(
+    iree_const_byte_span_t raw_data,
+    const iree_elf_import_table_t* import_table, iree_elf_module_flags_t flags,
+    iree_allocator_t host_allocator, iree_elf_module_t* out_module);
+
+// Returns the length of the shared memory required to hold the read-only
+// segments (text/rodata) of the ELF |raw_data| for use with
+// iree_elf_module_initialize_with_shared_segments or 0 if they cannot be
+// shared. Read-only segments can only be shared if no relocations modify them
+// and they don't share any host pages with writable segments.
+iree_status_t iree_elf_module_query_shared_segments_length(
+    iree_const_byte_span_t raw_data, iree_host_size_t* out_length);
+
+// Initializes an ELF module as with iree_elf_module_initialize_from_memory but
+// maps its read-only segments from |shared_segments| instead of allocating
+// private pages. Writable segments remain private to the module and are
+// relocated and initialized as usual so multiple modules mapping the same
+// shared segments never observe each other's mutable state. Shared segments
+// are never backed by large pages.
+//
+// If |populate| is true the read-only segments are written into the shared
+// memory from |raw_data|. This must complete before any other module maps the
+// same shared memory. Otherwise the mapped contents are compared against
+// |raw_data| and IREE_STATUS_FAILED_PRECONDITION is returned if they differ.
+iree_status_t iree_elf_module_initialize_with_shared_segments(
     iree_const_byte_span_t raw_data,
     const iree_elf_import_table_t* import_table,
+    const iree_memory_shared_t* shared_segments, bool populate,
     iree_allocator_t host_allocator, iree_elf_module_t* out_module);
 
 // Deinitializes a |module|, releasing any allocated executable or data pages.
@@ -0,0 +1,288 @@
+// Copyright 2025 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/local/elf/elf_module_registry.h"
+
+#include "iree/base/internal/call_once.h"
+#include "iree/base/internal/synchronization.h"
+
+//==============================================================================
+// Content keys
+//==============================================================================
+
+// 128-bit content hash plus the length of the data. The hash is not
+// cryptographic and only used to find candidates: the mapped segments of a
+// candidate are compared against the new data before being used.
+typedef struct iree_elf_module_key_t {
+  uint64_t hash[2];
+  iree_host_size_t length;
+} iree_elf_module_key_t;
+
+static inline uint64_t iree_elf_module_key_rotl(uint64_t x, int r) {
+  return (x << r) | (x >> (64 - r));
+}
+
+static inline uint64_t iree_elf_module_key_mix(uint64_t x) {
+  x ^= x >> 33;
+  x *= 0xFF51AFD7ED558CCDull;
+  x ^= x >> 33;
+  x *= 0xC4CEB9FE1A85EC53ull;
+  x ^= x >> 33;
+  return x;
+}
+
+// Hashes |data| 8 bytes at a time; fast enough that hashing multi-MB
+// executables is a small fraction of the cost of loading them.
+static iree_elf_module_key_t iree_elf_module_key_calculate(
+    iree_const_byte_span_t data) {
+  uint64_t h0 = 0xCBF29CE484222325ull;
+  uint64_t h1 = 0x9E3779B97F4A7C15ull;
+  const uint8_t* p = data.data;
+  iree_host_size_t remaining = data.data_length;
+  for (; remaining >= sizeof(uint64_t); remaining -= sizeof(uint64_t)) {
+    uint64_t w = 0;
+    memcpy(&w, p, sizeof(w));
+    p += sizeof(w);
+    h0 = (h0 ^ w) * 0x100000001B3ull;
+    h1 = iree_elf_module_key_rotl(h1 ^ w, 31) * 0x87C37B91114253D5ull;
+  }
+  for (; remaining > 0; --remaining, ++p) {
+    h0 = (h0 ^ *p) * 0x100000001B3ull;
+    h1 = iree_elf_module_key_rotl(h1 ^ *p, 31) * 0x87C37B91114253D5ull;
+  }
+  iree_elf_module_key_t key;
+  key.hash[0] = iree_elf_module_key_mix(h0 ^ data.data_length);
+  key.hash[1] = iree_elf_module_key_mix(h1 + data.data_length);
+  key.length = data.data_length;
+  return key;
+}
+
+static bool iree_elf_module_key_equal(const iree_elf_module_key_t* a,
+                                      const iree_elf_module_key_t* b) {
+  return a->hash[0] == b->hash[0] && a->hash[1] == b->hash[1] &&
+         a->length == b->length;
+}
+
+//==============================================================================
+// iree_elf_module_registry_t
+//==============================================================================
+
+// Read-only segments shared by all modules loaded from the same raw data.
+typedef struct iree_elf_shared_segments_t {
+  struct iree_elf_shared_segments_t* next;
+  iree_elf_module_key_t key;
+  // Guarded by the registry mutex.
+  int32_t ref_count;
+  // Shared memory holding the populated read-only segments at their offsets
+  // in the module virtual address space.
+  iree_memory_shared_t memory;
+} iree_elf_shared_segments_t;
+
+struct iree_elf_module_registry_t {
+  // Allocator used for entries. Entries may outlive whichever user first
+  // loaded them so they cannot use user allocators.
+  iree_allocator_t host_allocator;
+  iree_slim_mutex_t mutex;
+  // Live shared segments. This is expected to be small (one entry per unique
+  // executable in the process) and only walked during loads and unloads.
+  iree_elf_shared_segments_t* head IREE_GUARDED_BY(mutex);
+  iree_host_size_t count IREE_GUARDED_BY(mutex);
+};
+
+static void iree_elf_module_registry_initialize(
+    iree_allocator_t host_allocator, iree_elf_module_registry_t* registry) {
+  memset(registry, 0, sizeof(*registry));
+  registry->host_allocator = host_allocator;
+  iree_slim_mutex_initialize(&registry->mutex);
+}
+
+iree_status_t iree_elf_module_registry_create(
+    iree_allocator_t host_allocator,
+    iree_elf_module_registry_t** out_registry) {
+  IREE_ASSERT_ARGUMENT(out_registry);
+  *out_registry = NULL;
+  iree_elf_module_registry_t* registry = NULL;
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(host_allocator, sizeof(*registry),
+                                             (void**)&registry));
+  iree_elf_module_registry_initialize(host_allocator, registry);
+  *out_registry = registry;
+  return iree_ok_status();
+}
+
+void iree_elf_module_registry_free(iree_elf_module_registry_t* registry) {
+  if (!registry) return;
+  IREE_ASSERT(!registry->head, "modules must be deinitialized first");
+  iree_slim_mutex_deinitialize(&registry->mutex);
+  iree_allocator_free(registry->host_allocator, registry);
+}
+
+static iree_elf_module_registry_t iree_elf_module_registry_default_;
+static iree_once_flag iree_elf_module_registry_default_flag_ =
+    IREE_ONCE_FLAG_INIT;
+static void iree_elf_module_registry_default_initialize(void) {
+  iree_elf_module_registry_initialize(iree_allocator_system(),
+                                      &iree_elf_module_registry_default_);
+}
+
+iree_elf_module_registry_t* iree_elf_module_registry_default(void) {
+  iree_call_once(&iree_elf_module_registry_default_flag_,
+                 iree_elf_module_registry_default_initialize);
+  return &iree_elf_module_registry_default_;
+}
+
+// Returns a live entry with |key| with a new reference, if any.
+// Must be called with the registry mutex held.
+static iree_elf_shared_segments_t* iree_elf_module_registry_try_retain(
+    iree_elf_module_registry_t* registry, const iree_elf_module_key_t* key) {
+  for (iree_elf_shared_segments_t* entry = registry->head; entry;
+       entry = entry->next) {
+    if (iree_elf_module_key_equal(&entry->key, key)) {
+      ++entry->ref_count;
+      return entry;
+    }
+  }
+  return NULL;
+}
+
+static void iree_elf_module_registry_release_entry(
+    iree_elf_module_registry_t* registry, iree_elf_shared_segments_t* entry) {
+  iree_slim_mutex_lock(&registry->mutex);
+  bool unload = --entry->ref_count == 0;
+  if (unload) {
+    iree_elf_shared_segments_t** prev_next = &registry->head;
+    while (*prev_next != entry) prev_next = &(*prev_next)->next;
+    *prev_next = entry->next;
+    --registry->count;
+  }
+  iree_slim_mutex_unlock(&registry->mutex);
+  if (unload) {
+    // Pages remain valid until any modules still mapping them are unloaded.
+    iree_memory_shared_release(&entry->memory);
+    iree_allocator_free(registry->host_allocator, entry);
+  }
+}
+
+// Creates shared segments for |raw_data| and initializes |out_module| with
+// them. Returns NULL in |out_entry| without failing if the module or platform
+// does not support sharing.
+static iree_status_t iree_elf_module_registry_populate(
+    iree_elf_module_registry_t* registry, const iree_elf_module_key_t* key,
+    iree_const_byte_span_t raw_data, iree_allocator_t host_allocator,
+    iree_elf_module_t* out_module, iree_elf_shared_segments_t** out_entry) {
+  *out_entry = NULL;
+
+  iree_host_size_t shared_length = 0;
+  IREE_RETURN_IF_ERROR(
+      iree_elf_module_query_shared_segments_length(raw_data, &shared_length));
+  if (!shared_length) return iree_ok_status();
+
+  iree_elf_shared_segments_t* entry = NULL;
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(
+      registry->host_allocator, sizeof(*entry), (void**)&entry));
+  entry->key = *key;
+  entry->ref_count = 1;
+  iree_status_t status =
+      iree_memory_shared_create(shared_length, &entry->memory);
+  if (iree_status_is_ok(status)) {
+    status = iree_elf_module_initialize_with_shared_segments(
+        raw_data, /*import_table=*/NULL, &entry->memory, /*populate=*/true,
+        host_allocator, out_module);
+  }
+  if (!iree_status_is_ok(status)) {
+    // Sharing is an optimization: callers fall back to private loads which
+    // will report any errors inherent to the module itself.
+    iree_status_ignore(status);
+    iree_memory_shared_release(&entry->memory);
+    iree_allocator_free(registry->host_allocator, entry);
+    return iree_ok_status();
+  }
+
+  // Concurrent loads of the same data may each populate their own entry; both
+  // remain valid and later loads use whichever is found first.
+  iree_slim_mutex_lock(&registry->mutex);
+  entry->next = registry->head;
+  registry->head = entry;
+  ++registry->count;
+  iree_slim_mutex_unlock(&registry->mutex);
+
+  *out_entry = entry;
+  return iree_ok_status();
+}
+
+iree_status_t iree_elf_module_registry_initialize_module(
+    iree_elf_module_registry_t* registry, iree_const_byte_span_t raw_data,
+    iree_elf_module_flags_t flags, iree_allocator_t host_allocator,
+    iree_elf_module_t* out_module) {
+  IREE_ASSERT_ARGUMENT(registry);
+  IREE_ASSERT_ARGUMENT(raw_data.data);
+  IREE_ASSERT_ARGUMENT(out_module);
+  memset(out_module, 0, sizeof(*out_module));
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, raw_data.data_length);
+
+  const iree_elf_module_key_t key = iree_elf_module_key_calculate(raw_data);
+
+  // Fast path: map the segments of a live module with the same key. The
+  // contents are verified against |raw_data| during initialization so that a
+  // key collision falls back to a private load.
+  iree_slim_mutex_lock(&registry->mutex);
+  iree_elf_shared_segments_t* entry =
+      iree_elf_module_registry_try_retain(registry, &key);
+  iree_slim_mutex_unlock(&registry->mutex);
+  if (entry) {
+    iree_status_t status = iree_elf_module_initialize_with_shared_segments(
+        raw_data, /*import_table=*/NULL, &entry->memory, /*populate=*/false,
+        host_allocator, out_module);
+    if (iree_status_is_ok(status)) {
+      IREE_TRACE_ZONE_APPEND_TEXT(z0, "shared");
+      out_module->shared_segments = entry;
+      IREE_TRACE_ZONE_END(z0);
+      return iree_ok_status();
+    }
+    iree_status_ignore(status);
+    iree_elf_module_registry_release_entry(registry, entry);
+    entry = NULL;
+  } else {
+    IREE_RETURN_AND_END_ZONE_IF_ERROR(
+        z0, iree_elf_module_registry_populate(registry, &key, raw_data,
+                                              host_allocator, out_module,
+                                              &entry));
+    if (entry) {
+      out_module->shared_segments = entry;
+      IREE_TRACE_ZONE_END(z0);
+      return iree_ok_status();
+    }
+  }
+
+  // Load a private copy of the module.
+  IREE_TRACE_ZONE_APPEND_TEXT(z0, "private");
+  iree_status_t status = iree_elf_module_initialize_from_memory(
+      raw_data, /*import_table=*/NULL, flags, host_allocator, out_module);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+void iree_elf_module_registry_deinitialize_module(
+    iree_elf_module_registry_t* registry, iree_elf_module_t* module) {
+  IREE_ASSERT_ARGUMENT(registry);
+  if (!module) return;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_elf_shared_segments_t* entry = module->shared_segments;
+  iree_elf_module_deinitialize(module);
+  if (entry) iree_elf_module_registry_release_entry(registry, entry);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+iree_host_size_t iree_elf_module_registry_count(
+    iree_elf_module_registry_t* registry) {
+  IREE_ASSERT_ARGUMENT(registry);
+  iree_slim_mutex_lock(&registry->mutex);
+  iree_host_size_t count = registry->count;
+  iree_slim_mutex_unlock(&registry->mutex);
+  return count;
+}
@@ -0,0 +1,78 @@
+// Copyright 2025 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_LOCAL_ELF_ELF_MODULE_REGISTRY_H_
+#define IREE_HAL_LOCAL_ELF_ELF_MODULE_REGISTRY_H_
+
+#include "iree/base/api.h"
+#include "iree/hal/local/elf/elf_module.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+//==============================================================================
+// Shared ELF module segment registry
+//==============================================================================
+
+// A registry of read-only ELF module segments (text/rodata) keyed by the
+// content hash of the raw ELF data they were loaded from. Loading the same ELF
+// bytes multiple times (such as when N devices or N executable caches prepare
+// the same executable) maps the read-only pages populated by the first load
+// into each new module instead of committing and copying them again.
+//
+// Only read-only segments are shared: each module has its own address space
+// reservation with private writable segments (.data/.bss/.data.rel.ro) that
+// are relocated and initialized independently. Modules whose read-only
+// segments are modified by relocations, or platforms without shared memory
+// support, fall back to fully private loads.
+//
+// The registry does not retain copies of the raw data. Entries with a matching
+// key are verified by comparing the mapped segments against the new raw data
+// outside of the registry lock before being used.
+//
+// Thread-safe.
+typedef struct iree_elf_module_registry_t iree_elf_module_registry_t;
+
+// Creates an empty registry. All modules initialized through it must be
+// deinitialized before it is freed.
+iree_status_t iree_elf_module_registry_create(
+    iree_allocator_t host_allocator, iree_elf_module_registry_t** out_registry);
+
+// Frees a |registry| created with iree_elf_module_registry_create.
+void iree_elf_module_registry_free(iree_elf_module_registry_t* registry);
+
+// Returns the process-wide default registry.
+iree_elf_module_registry_t* iree_elf_module_registry_default(void);
+
+// Initializes |out_module| from |raw_data| mapping the read-only segments of
+// any live module in |registry| initialized from identical data or populating
+// new shared segments for others to use. |raw_data| only needs to remain valid
+// for the duration of the call. |flags| are applied if the module falls back to
+// a private load as its read-only segments cannot be shared.
+//
+// The module must be deinitialized with
+// iree_elf_module_registry_deinitialize_module.
+iree_status_t iree_elf_module_registry_initialize_module(
+    iree_elf_module_registry_t* registry, iree_const_byte_span_t raw_data,
+    iree_elf_module_flags_t flags, iree_allocator_t host_allocator,
+    iree_elf_module_t* out_module);
+
+// Deinitializes a |module| previously initialized with
+// iree_elf_module_registry_initialize_module. Shared segments are released once
+// no modules map them.
+void iree_elf_module_registry_deinitialize_module(
+    iree_elf_module_registry_t* registry, iree_elf_module_t* module);
+
+// Returns the number of unique shared segments currently live in |registry|.
+iree_host_size_t iree_elf_module_registry_count(
+    iree_elf_module_registry_t* registry);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_LOCAL_ELF_ELF_MODULE_REGISTRY_H_
@@ -7,6 +7,7 @@
 #include "iree/base/api.h"
 #include "iree/base/internal/cpu.h"
 #include "iree/hal/local/elf/elf_module.h"
+#include "iree/hal/local/elf/elf_module_registry.h"
 #include "iree/hal/local/executable_environment.h"
 #include "iree/hal/local/executable_library.h"
 
@@ -51,23 +52,17 @@ static iree_status_t query_arch_test_file_data(
                           "the application for the current target platform");
 }
 
-static iree_status_t run_test() {
-  iree_const_byte_span_t file_data;
-  IREE_RETURN_IF_ERROR(query_arch_test_file_data(&file_data));
-
-  iree_elf_import_table_t import_table;
-  memset(&import_table, 0, sizeof(import_table));
-  iree_elf_module_t module;
-  IREE_RETURN_IF_ERROR(iree_elf_module_initialize_from_memory(
-      file_data, &import_table, iree_allocator_system(), &module));
-
+// Queries the library from |module| and dispatches its entry point.
+// Returns the address of the library header pointer in |out_header_ptr|.
+static iree_status_t run_module(iree_elf_module_t* module,
+                                const void** out_header_ptr) {
   iree_hal_executable_environment_v0_t environment;
   iree_hal_executable_environment_initialize(iree_allocator_system(),
                                              &environment);
 
   void* query_fn_ptr = NULL;
   IREE_RETURN_IF_ERROR(iree_elf_module_lookup_export(
-      &module, IREE_HAL_EXECUTABLE_LIBRARY_EXPORT_NAME, &query_fn_ptr));
+      module, IREE_HAL_EXECUTABLE_LIBRARY_EXPORT_NAME, &query_fn_ptr));
 
   union {
     const iree_hal_executable_library_header_t** header;
@@ -81,6 +76,7 @@ static iree_status_t run_test() {
     return iree_make_status(IREE_STATUS_NOT_FOUND,
                             "library header is empty (version mismatch?)");
   }
+  if (out_header_ptr) *out_header_ptr = library.header;
 
   const iree_hal_executable_library_header_t* header = *library.header;
   if (header->version != IREE_HAL_EXECUTABLE_LIBRARY_VERSION_LATEST) {
@@ -140,23 +136,116 @@ static iree_status_t run_test() {
                             "dispatch function returned failure: %d", ret);
   }
 
-  iree_status_t status = iree_ok_status();
   for (int i = 0; i < IREE_ARRAYSIZE(expected); ++i) {
     if (ret0[i] != expected[i]) {
-      status =
-          iree_make_status(IREE_STATUS_INTERNAL,
-                           "output mismatch: ret[%d] = %.1f, expected %.1f", i,
-                           ret0[i], expected[i]);
-      break;
+      return iree_make_status(IREE_STATUS_INTERNAL,
+                              "output mismatch: ret[%d] = %.1f, expected %.1f",
+                              i, ret0[i], expected[i]);
     }
   }
+  return iree_ok_status();
+}
+
+static iree_status_t run_test(iree_elf_module_flags_t flags) {
+  iree_const_byte_span_t file_data;
+  IREE_RETURN_IF_ERROR(query_arch_test_file_data(&file_data));
+
+  iree_elf_import_table_t import_table;
+  memset(&import_table, 0, sizeof(import_table));
+  iree_elf_module_t module;
+  IREE_RETURN_IF_ERROR(iree_elf_module_initialize_from_memory(
+      file_data, &import_table, flags, iree_allocator_system(), &module));
+
+  iree_status_t status = run_module(&module, NULL);
 
   iree_elf_module_deinitialize(&module);
   return status;
 }
 
+static bool module_contains(const iree_elf_module_t* module, const void* ptr) {
+  return (const uint8_t*)ptr >= module->vaddr_base &&
+         (const uint8_t*)ptr < module->vaddr_base + module->vaddr_size;
+}
+
+// Tests that identical ELF data loaded through a registry shares the read-only
+// segments while each module keeps its own writable segments.
+static iree_status_t run_registry_test() {
+  iree_const_byte_span_t file_data;
+  IREE_RETURN_IF_ERROR(query_arch_test_file_data(&file_data));
+
+  iree_elf_module_registry_t* registry = NULL;
+  IREE_RETURN_IF_ERROR(
+      iree_elf_module_registry_create(iree_allocator_system(), &registry));
+
+  iree_elf_module_t module_a;
+  iree_status_t status = iree_elf_module_registry_initialize_module(
+      registry, file_data, IREE_ELF_MODULE_FLAG_NONE, iree_allocator_system(),
+      &module_a);
+  if (!iree_status_is_ok(status)) {
+    iree_elf_module_registry_free(registry);
+    return status;
+  }
+  iree_elf_module_t module_b;
+  status = iree_elf_module_registry_initialize_module(
+      registry, file_data, IREE_ELF_MODULE_FLAG_NONE, iree_allocator_system(),
+      &module_b);
+  if (!iree_status_is_ok(status)) {
+    iree_elf_module_registry_deinitialize_module(registry, &module_a);
+    iree_elf_module_registry_free(registry);
+    return status;
+  }
+
+  // Platforms without shared memory support load both modules privately.
+#if defined(IREE_PLATFORM_LINUX)
+  const bool shared = true;
+#else
+  const bool shared = module_a.shared_segments != NULL;
+#endif  // IREE_PLATFORM_LINUX
+  if (shared && (module_b.shared_segments != module_a.shared_segments ||
+                 iree_elf_module_registry_count(registry) != 1)) {
+    status = iree_make_status(IREE_STATUS_INTERNAL,
+                              "identical modules did not share segments");
+  }
+  if (iree_status_is_ok(status) && module_a.vaddr_base == module_b.vaddr_base) {
+    status = iree_make_status(IREE_STATUS_INTERNAL,
+                              "modules share an address space reservation");
+  }
+
+  // The library header pointers live in each module's relocated writable
+  // segment and must point into that module only.
+  const void* header_ptr_a = NULL;
+  const void* header_ptr_b = NULL;
+  if (iree_status_is_ok(status)) status = run_module(&module_a, &header_ptr_a);
+  if (iree_status_is_ok(status)) status = run_module(&module_b, &header_ptr_b);
+  if (iree_status_is_ok(status) &&
+      (!module_contains(&module_a, header_ptr_a) ||
+       !module_contains(&module_b, header_ptr_b))) {
+    status = iree_make_status(IREE_STATUS_INTERNAL,
+                              "module data is not private to the module");
+  }
+
+  // Dropping the populating module must not affect the one sharing its pages.
+  iree_elf_module_registry_deinitialize_module(registry, &module_a);
+  if (iree_status_is_ok(status)) status = run_module(&module_b, NULL);
+  iree_elf_module_registry_deinitialize_module(registry, &module_b);
+
+  if (iree_status_is_ok(status) &&
+      iree_elf_module_registry_count(registry) != 0) {
+    status = iree_make_status(IREE_STATUS_INTERNAL,
+                              "shared segments not released with last module");
+  }
+  iree_elf_module_registry_free(registry);
+  return status;
+}
+
 int main() {
-  const iree_status_t result = run_test();
+  iree_status_t result = run_test(IREE_ELF_MODULE_FLAG_NONE);
+  if (iree_status_is_ok(result)) result = run_registry_test();
+  if (iree_status_is_ok(result)) {
+    // Modules smaller than a large page must load normally with large pages
+    // requested.
+    result = run_test(IREE_ELF_MODULE_FLAG_LARGE_PAGES);
+  }
   int ret = (int)iree_status_code(result);
   if (!iree_status_is_ok(result)) {
     iree_status_fprint(stderr, result);
@@ -48,6 +48,13 @@ enum iree_memory_view_flag_bits_t {
   // Indicates that the memory may be used to execute code.
   // May be used to ask for special privileges (like MAP_JIT on MacOS).
   IREE_MEMORY_VIEW_FLAG_MAY_EXECUTE = 1u << 10,
+
+  // Indicates that the view should be placed such that it can be backed by
+  // large pages. The base address of the reservation will be aligned to
+  // iree_memory_info_t::large_page_granularity when the platform supports it.
+  // Pages must still be opted in to large page backing with
+  // iree_memory_view_advise_large_pages after they are committed.
+  IREE_MEMORY_VIEW_FLAG_LARGE_PAGES = 1u << 11,
 };
 typedef uint32_t iree_memory_view_flags_t;
 
@@ -89,4 +96,57 @@ iree_status_t iree_memory_view_protect_ranges(void* base_address,
                                               const iree_byte_range_t* ranges,
                                               iree_memory_access_t new_access);
 
+// Hints that the committed pages overlapping |byte_ranges| should be backed by
+// large pages. Only the portions of each range that cover entire large pages
+// (as aligned relative to the process address space) are affected. The hint
+// should be given once the pages have been populated and their final
+// protection applied: already populated pages are collapsed into large pages
+// immediately when the platform supports it and otherwise in the background.
+//
+// Returns IREE_STATUS_UNAVAILABLE if the platform does not support large pages
+// for committed views. Callers should treat failures as non-fatal.
+//
+// Implemented by madvise+MADV_HUGEPAGE followed by MADV_COLLAPSE:
+//  https://www.kernel.org/doc/html/latest/admin-guide/mm/transhuge.html
+iree_status_t iree_memory_view_advise_large_pages(
+    void* base_address, iree_host_size_t range_count,
+    const iree_byte_range_t* ranges);
+
+//===----------------------------------------------------------------------===//
+// Shared memory
+//===----------------------------------------------------------------------===//
+
+// Physical pages that can be mapped into multiple views at the same time.
+// Writes through one view are visible through all others.
+typedef struct iree_memory_shared_t {
+  // Platform handle (such as a file descriptor) of the shared memory object.
+  intptr_t handle;
+  // Total size, in bytes, of the shared memory object.
+  iree_host_size_t total_length;
+} iree_memory_shared_t;
+
+// Creates a zero-initialized shared memory object of |total_length| bytes.
+// Returns IREE_STATUS_UNAVAILABLE if the platform cannot map the same pages
+// into multiple views.
+//
+// Implemented by memfd_create+ftruncate.
+iree_status_t iree_memory_shared_create(iree_host_size_t total_length,
+                                        iree_memory_shared_t* out_shared);
+
+// Releases the |shared| memory object handle. Pages remain valid until all
+// views mapping them have been released.
+void iree_memory_shared_release(iree_memory_shared_t* shared);
+
+// Maps pages of |shared| overlapping the byte ranges defined by |byte_ranges|
+// into the view reserved at |base_address| with |access|. Byte range offsets
+// are relative to both the view base and the start of the shared memory object
+// and will be adjusted to the page granularity of the view. Any pages already
+// committed in the ranges are replaced.
+//
+// Implemented by mmap+MAP_SHARED|MAP_FIXED.
+iree_status_t iree_memory_view_map_shared_ranges(
+    void* base_address, iree_host_size_t range_count,
+    const iree_byte_range_t* ranges, const iree_memory_shared_t* shared,
+    iree_memory_access_t access);
+
 #endif  // IREE_HAL_LOCAL_ELF_PLATFORM_H_
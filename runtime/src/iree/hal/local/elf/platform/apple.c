@@ -136,4 +136,34 @@ iree_status_t iree_memory_view_protect_ranges(void* base_address,
   return status;
 }
 
+iree_status_t iree_memory_view_advise_large_pages(
+    void* base_address, iree_host_size_t range_count,
+    const iree_byte_range_t* ranges) {
+  // NOTE: superpages (VM_FLAGS_SUPERPAGE_SIZE_2MB) are x86_64-only and must be
+  // requested at allocation time so they cannot be applied to views.
+  return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                          "large pages not supported for memory views");
+}
+
+//==============================================================================
+// Shared memory
+//==============================================================================
+
+iree_status_t iree_memory_shared_create(iree_host_size_t total_length,
+                                        iree_memory_shared_t* out_shared) {
+  memset(out_shared, 0, sizeof(*out_shared));
+  return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                          "shared memory views not implemented");
+}
+
+void iree_memory_shared_release(iree_memory_shared_t* shared) {}
+
+iree_status_t iree_memory_view_map_shared_ranges(
+    void* base_address, iree_host_size_t range_count,
+    const iree_byte_range_t* ranges, const iree_memory_shared_t* shared,
+    iree_memory_access_t access) {
+  return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                          "shared memory views not implemented");
+}
+
 #endif  // IREE_PLATFORM_APPLE
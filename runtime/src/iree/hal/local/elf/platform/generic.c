@@ -49,4 +49,33 @@ iree_status_t iree_memory_view_protect_ranges(void* base_address,
   return iree_ok_status();
 }
 
+iree_status_t iree_memory_view_advise_large_pages(
+    void* base_address, iree_host_size_t range_count,
+    const iree_byte_range_t* ranges) {
+  // Memory is allocated from the heap and has no page control.
+  return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                          "large pages not supported for memory views");
+}
+
+//==============================================================================
+// Shared memory
+//==============================================================================
+
+iree_status_t iree_memory_shared_create(iree_host_size_t total_length,
+                                        iree_memory_shared_t* out_shared) {
+  memset(out_shared, 0, sizeof(*out_shared));
+  return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                          "shared memory views not supported");
+}
+
+void iree_memory_shared_release(iree_memory_shared_t* shared) {}
+
+iree_status_t iree_memory_view_map_shared_ranges(
+    void* base_address, iree_host_size_t range_count,
+    const iree_byte_range_t* ranges, const iree_memory_shared_t* shared,
+    iree_memory_access_t access) {
+  return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                          "shared memory views not supported");
+}
+
 #endif  // IREE_PLATFORM_GENERIC
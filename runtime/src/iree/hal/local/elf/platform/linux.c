@@ -10,8 +10,13 @@
 
 #include <errno.h>
 #include <sys/mman.h>
+#include <sys/syscall.h>
 #include <unistd.h>
 
+#if !defined(MFD_CLOEXEC)
+#define MFD_CLOEXEC 0x0001U
+#endif  // !MFD_CLOEXEC
+
 //==============================================================================
 // Virtual address space manipulation
 //==============================================================================
@@ -34,14 +39,35 @@ iree_status_t iree_memory_view_reserve(iree_memory_view_flags_t flags,
   int mmap_prot = PROT_NONE;
   int mmap_flags = MAP_PRIVATE | MAP_ANON | MAP_NORESERVE;
 
+  // When large pages are requested we over-reserve by one large page and trim
+  // the excess from either end so that the base address is aligned.
+  iree_host_size_t alignment = 0;
+  if (flags & IREE_MEMORY_VIEW_FLAG_LARGE_PAGES) {
+    iree_memory_info_t memory_info = iree_memory_query_info();
+    if (memory_info.large_page_granularity > memory_info.normal_page_size) {
+      alignment = memory_info.large_page_granularity;
+    }
+  }
+
   iree_status_t status = iree_ok_status();
-  void* base_address = mmap(NULL, total_length, mmap_prot, mmap_flags, -1, 0);
+  void* base_address =
+      mmap(NULL, total_length + alignment, mmap_prot, mmap_flags, -1, 0);
   if (base_address == MAP_FAILED) {
     status = iree_make_status(iree_status_code_from_errno(errno),
                               "mmap reservation failed");
+  } else if (alignment > 0) {
+    uint8_t* unaligned_base = (uint8_t*)base_address;
+    uint8_t* aligned_base =
+        (uint8_t*)iree_host_align((uintptr_t)unaligned_base, alignment);
+    iree_host_size_t head_length =
+        (iree_host_size_t)(aligned_base - unaligned_base);
+    iree_host_size_t tail_length = alignment - head_length;
+    if (head_length > 0) munmap(unaligned_base, head_length);
+    if (tail_length > 0) munmap(aligned_base + total_length, tail_length);
+    base_address = aligned_base;
   }
 
-  *out_base_address = base_address;
+  *out_base_address = iree_status_is_ok(status) ? base_address : NULL;
   IREE_TRACE_ZONE_END(z0);
   return status;
 }
@@ -109,4 +135,123 @@ iree_status_t iree_memory_view_protect_ranges(void* base_address,
   return status;
 }
 
+iree_status_t iree_memory_view_advise_large_pages(
+    void* base_address, iree_host_size_t range_count,
+    const iree_byte_range_t* ranges) {
+#if defined(MADV_HUGEPAGE)
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_status_t status = iree_ok_status();
+  for (iree_host_size_t i = 0; i < range_count; ++i) {
+    void* range_start = NULL;
+    iree_host_size_t aligned_length = 0;
+    iree_page_align_range(base_address, ranges[i], getpagesize(), &range_start,
+                          &aligned_length);
+    // NOTE: EINVAL is returned if the kernel was built without transparent
+    // huge page support; this is a hint so we report it as unavailable.
+    int ret = madvise(range_start, aligned_length, MADV_HUGEPAGE);
+    if (ret != 0) {
+      status = iree_make_status(errno == EINVAL
+                                    ? IREE_STATUS_UNAVAILABLE
+                                    : iree_status_code_from_errno(errno),
+                                "madvise(MADV_HUGEPAGE) failed");
+      break;
+    }
+#if defined(MADV_COLLAPSE)
+    // Synchronously collapse the populated pages (Linux 6.1+). If unsupported
+    // or the collapse fails khugepaged will collapse them in the background
+    // per the MADV_HUGEPAGE advice above.
+    madvise(range_start, aligned_length, MADV_COLLAPSE);
+#endif  // MADV_COLLAPSE
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+#else
+  return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                          "transparent huge pages not supported");
+#endif  // MADV_HUGEPAGE
+}
+
+//==============================================================================
+// Shared memory
+//==============================================================================
+
+iree_status_t iree_memory_shared_create(iree_host_size_t total_length,
+                                        iree_memory_shared_t* out_shared) {
+  memset(out_shared, 0, sizeof(*out_shared));
+  out_shared->handle = -1;
+#if defined(SYS_memfd_create)
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // NOTE: bionic only exposes memfd_create starting with API 30 so we go
+  // through the syscall directly.
+  int fd = (int)syscall(SYS_memfd_create, "iree-shared", MFD_CLOEXEC);
+  if (fd < 0) {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_make_status(errno == ENOSYS
+                                ? IREE_STATUS_UNAVAILABLE
+                                : iree_status_code_from_errno(errno),
+                            "memfd_create failed");
+  }
+  if (ftruncate(fd, (off_t)total_length) != 0) {
+    iree_status_t status =
+        iree_make_status(iree_status_code_from_errno(errno),
+                         "ftruncate of shared memory failed");
+    close(fd);
+    IREE_TRACE_ZONE_END(z0);
+    return status;
+  }
+  out_shared->handle = fd;
+  out_shared->total_length = total_length;
+
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+#else
+  return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                          "memfd_create not available");
+#endif  // SYS_memfd_create
+}
+
+void iree_memory_shared_release(iree_memory_shared_t* shared) {
+  if (shared->handle >= 0) close((int)shared->handle);
+  shared->handle = -1;
+  shared->total_length = 0;
+}
+
+iree_status_t iree_memory_view_map_shared_ranges(
+    void* base_address, iree_host_size_t range_count,
+    const iree_byte_range_t* ranges, const iree_memory_shared_t* shared,
+    iree_memory_access_t access) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  int mmap_prot = iree_memory_access_to_prot(access);
+  int mmap_flags = MAP_SHARED | MAP_FIXED;
+
+  iree_status_t status = iree_ok_status();
+  for (iree_host_size_t i = 0; i < range_count; ++i) {
+    void* range_start = NULL;
+    iree_host_size_t aligned_length = 0;
+    iree_page_align_range(base_address, ranges[i], getpagesize(), &range_start,
+                          &aligned_length);
+    iree_host_size_t offset =
+        (iree_host_size_t)((uint8_t*)range_start - (uint8_t*)base_address);
+    if (offset + aligned_length > shared->total_length) {
+      status = iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                                "range exceeds the shared memory object");
+      break;
+    }
+    void* result = mmap(range_start, aligned_length, mmap_prot, mmap_flags,
+                        (int)shared->handle, (off_t)offset);
+    if (result == MAP_FAILED) {
+      status = iree_make_status(iree_status_code_from_errno(errno),
+                                "mmap of shared memory failed");
+      break;
+    }
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
 #endif  // IREE_PLATFORM_*
@@ -20,6 +20,13 @@
 #include "iree/io/file_contents.h"
 #include "iree/testing/benchmark.h"
 
+#if defined(IREE_PLATFORM_ANDROID) || defined(IREE_PLATFORM_LINUX)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif  // IREE_PLATFORM_ANDROID || IREE_PLATFORM_LINUX
+
 IREE_FLAG(string, executable_format, "",
           "Format of the executable file being loaded.");
 IREE_FLAG(string, executable_file, "",
@@ -48,6 +55,65 @@ IREE_FLAG(int32_t, workgroup_size_z, 1,
 IREE_FLAG(int32_t, max_concurrency, 1,
           "Maximum available concurrency exposed to the dispatch.");
 
+//===----------------------------------------------------------------------===//
+// iTLB miss counter
+//===----------------------------------------------------------------------===//
+
+// Counts iTLB read misses on the calling thread using perf events, when
+// available. The counter is unavailable (and reported as such) if the platform
+// does not support perf events or the process lacks permission to use them
+// (see /proc/sys/kernel/perf_event_paranoid).
+typedef struct iree_itlb_counter_t {
+  int fd;
+} iree_itlb_counter_t;
+
+static void iree_itlb_counter_initialize(iree_itlb_counter_t* out_counter) {
+  out_counter->fd = -1;
+#if defined(IREE_PLATFORM_ANDROID) || defined(IREE_PLATFORM_LINUX)
+  struct perf_event_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = PERF_TYPE_HW_CACHE;
+  attr.config = PERF_COUNT_HW_CACHE_ITLB |
+                (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+  attr.disabled = 1;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  out_counter->fd = (int)syscall(__NR_perf_event_open, &attr, /*pid=*/0,
+                                 /*cpu=*/-1, /*group_fd=*/-1, /*flags=*/0);
+#endif  // IREE_PLATFORM_ANDROID || IREE_PLATFORM_LINUX
+}
+
+static void iree_itlb_counter_deinitialize(iree_itlb_counter_t* counter) {
+#if defined(IREE_PLATFORM_ANDROID) || defined(IREE_PLATFORM_LINUX)
+  if (counter->fd >= 0) close(counter->fd);
+#endif  // IREE_PLATFORM_ANDROID || IREE_PLATFORM_LINUX
+  counter->fd = -1;
+}
+
+static void iree_itlb_counter_start(iree_itlb_counter_t* counter) {
+#if defined(IREE_PLATFORM_ANDROID) || defined(IREE_PLATFORM_LINUX)
+  if (counter->fd < 0) return;
+  ioctl(counter->fd, PERF_EVENT_IOC_RESET, 0);
+  ioctl(counter->fd, PERF_EVENT_IOC_ENABLE, 0);
+#endif  // IREE_PLATFORM_ANDROID || IREE_PLATFORM_LINUX
+}
+
+// Stops the counter and returns the total misses since it was started or -1 if
+// the counter is unavailable.
+static int64_t iree_itlb_counter_stop(iree_itlb_counter_t* counter) {
+#if defined(IREE_PLATFORM_ANDROID) || defined(IREE_PLATFORM_LINUX)
+  if (counter->fd < 0) return -1;
+  ioctl(counter->fd, PERF_EVENT_IOC_DISABLE, 0);
+  uint64_t value = 0;
+  if (read(counter->fd, &value, sizeof(value)) != sizeof(value)) return -1;
+  return (int64_t)value;
+#else
+  return -1;
+#endif  // IREE_PLATFORM_ANDROID || IREE_PLATFORM_LINUX
+}
+
 // Parsed parameters from flags.
 // Used to construct the dispatch parameters for the benchmark invocation.
 struct {
@@ -228,12 +294,28 @@ static iree_status_t iree_hal_executable_library_run(
   // we are testing the memory access patterns: if we just ran the same single
   // tile processing the same exact region of memory over and over we are not
   // testing cache effects.
+  iree_itlb_counter_t itlb_counter;
+  iree_itlb_counter_initialize(&itlb_counter);
+  iree_itlb_counter_start(&itlb_counter);
   int64_t dispatch_count = 0;
   while (iree_benchmark_keep_running(benchmark_state, /*batch_count=*/1)) {
     IREE_RETURN_IF_ERROR(iree_hal_local_executable_issue_dispatch_inline(
         local_executable, FLAG_entry_point, &dispatch_state, 0, local_memory));
     ++dispatch_count;
   }
+  int64_t itlb_misses = iree_itlb_counter_stop(&itlb_counter);
+  iree_itlb_counter_deinitialize(&itlb_counter);
+
+  // Report the iTLB misses per dispatch. This includes the misses of the
+  // benchmark loop itself and is only useful as a relative measure between
+  // runs (such as with and without --embedded_elf_large_pages).
+  if (itlb_misses >= 0) {
+    iree_benchmark_set_counter(benchmark_state, "itlb_misses",
+                               (double)itlb_misses,
+                               IREE_BENCHMARK_COUNTER_FLAG_AVG_ITERATIONS);
+  } else {
+    iree_benchmark_set_label(benchmark_state, "itlb_misses unavailable");
+  }
 
   // To get a total time per invocation we set the item count to the total
   // invocations dispatched. That gives us both total dispatch and single
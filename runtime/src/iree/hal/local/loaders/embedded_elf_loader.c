@@ -12,6 +12,7 @@
 
 #include "iree/hal/api.h"
 #include "iree/hal/local/elf/elf_module.h"
+#include "iree/hal/local/elf/elf_module_registry.h"
 #include "iree/hal/local/executable_library.h"
 #include "iree/hal/local/executable_library_util.h"
 #include "iree/hal/local/executable_plugin_manager.h"
@@ -24,6 +25,10 @@
 typedef struct iree_hal_elf_executable_t {
   iree_hal_local_executable_t base;
 
+  // Registry the module was initialized through if its read-only segments may
+  // be shared with other executables.
+  iree_elf_module_registry_t* module_registry;
+
   // Loaded ELF module.
   iree_elf_module_t module;
 
@@ -85,7 +90,9 @@ static iree_status_t iree_hal_elf_executable_query_library(
 static iree_status_t iree_hal_elf_executable_create(
     const iree_hal_executable_params_t* executable_params,
     const iree_hal_executable_import_provider_t import_provider,
-    iree_allocator_t host_allocator, iree_hal_executable_t** out_executable) {
+    iree_elf_module_registry_t* module_registry,
+    iree_elf_module_flags_t module_flags, iree_allocator_t host_allocator,
+    iree_hal_executable_t** out_executable) {
   IREE_ASSERT_ARGUMENT(executable_params);
   IREE_ASSERT_ARGUMENT(executable_params->executable_data.data &&
                        executable_params->executable_data.data_length);
@@ -119,11 +126,21 @@ static iree_status_t iree_hal_elf_executable_create(
     executable->base.environment.constants = target_constants;
   }
 
-  // Attempt to load the ELF module.
+  // Attempt to load the ELF module (optionally sharing read-only segments with
+  // identical modules already loaded).
   if (iree_status_is_ok(status)) {
-    status = iree_elf_module_initialize_from_memory(
-        executable_params->executable_data, /*import_table=*/NULL,
-        host_allocator, &executable->module);
+    if (module_registry) {
+      status = iree_elf_module_registry_initialize_module(
+          module_registry, executable_params->executable_data, module_flags,
+          host_allocator, &executable->module);
+      if (iree_status_is_ok(status)) {
+        executable->module_registry = module_registry;
+      }
+    } else {
+      status = iree_elf_module_initialize_from_memory(
+          executable_params->executable_data, /*import_table=*/NULL,
+          module_flags, host_allocator, &executable->module);
+    }
   }
 
   // Query metadata and get the entry point function pointers.
@@ -167,7 +184,12 @@ static void iree_hal_elf_executable_destroy(
   iree_allocator_t host_allocator = executable->base.host_allocator;
   IREE_TRACE_ZONE_BEGIN(z0);
 
-  iree_elf_module_deinitialize(&executable->module);
+  if (executable->module_registry) {
+    iree_elf_module_registry_deinitialize_module(executable->module_registry,
+                                                 &executable->module);
+  } else {
+    iree_elf_module_deinitialize(&executable->module);
+  }
 
   iree_hal_executable_library_deinitialize_imports(
       &executable->base.environment, host_allocator);
@@ -228,15 +250,37 @@ typedef struct iree_hal_embedded_elf_loader_t {
   iree_hal_executable_loader_t base;
   iree_allocator_t host_allocator;
   iree_hal_executable_plugin_manager_t* plugin_manager;
+  // Registry used to share read-only segments or NULL if disabled.
+  iree_elf_module_registry_t* module_registry;
+  // Flags used when initializing ELF modules.
+  iree_elf_module_flags_t module_flags;
 } iree_hal_embedded_elf_loader_t;
 
 static const iree_hal_executable_loader_vtable_t
     iree_hal_embedded_elf_loader_vtable;
 
+void iree_hal_embedded_elf_loader_options_initialize(
+    iree_hal_embedded_elf_loader_options_t* out_options) {
+  IREE_ASSERT_ARGUMENT(out_options);
+  memset(out_options, 0, sizeof(*out_options));
+}
+
 iree_status_t iree_hal_embedded_elf_loader_create(
     iree_hal_executable_plugin_manager_t* plugin_manager,
     iree_allocator_t host_allocator,
     iree_hal_executable_loader_t** out_executable_loader) {
+  iree_hal_embedded_elf_loader_options_t options;
+  iree_hal_embedded_elf_loader_options_initialize(&options);
+  return iree_hal_embedded_elf_loader_create_with_options(
+      &options, plugin_manager, host_allocator, out_executable_loader);
+}
+
+iree_status_t iree_hal_embedded_elf_loader_create_with_options(
+    const iree_hal_embedded_elf_loader_options_t* options,
+    iree_hal_executable_plugin_manager_t* plugin_manager,
+    iree_allocator_t host_allocator,
+    iree_hal_executable_loader_t** out_executable_loader) {
+  IREE_ASSERT_ARGUMENT(options);
   IREE_ASSERT_ARGUMENT(out_executable_loader);
   *out_executable_loader = NULL;
   IREE_TRACE_ZONE_BEGIN(z0);
@@ -251,6 +295,13 @@ iree_status_t iree_hal_embedded_elf_loader_create(
         &executable_loader->base);
     executable_loader->host_allocator = host_allocator;
     executable_loader->plugin_manager = plugin_manager;
+    if (options->flags & IREE_HAL_EMBEDDED_ELF_LOADER_FLAG_SHARE_SEGMENTS) {
+      executable_loader->module_registry = iree_elf_module_registry_default();
+    }
+    executable_loader->module_flags = IREE_ELF_MODULE_FLAG_NONE;
+    if (options->flags & IREE_HAL_EMBEDDED_ELF_LOADER_FLAG_LARGE_PAGES) {
+      executable_loader->module_flags |= IREE_ELF_MODULE_FLAG_LARGE_PAGES;
+    }
     iree_hal_executable_plugin_manager_retain(
         executable_loader->plugin_manager);
     *out_executable_loader = (iree_hal_executable_loader_t*)executable_loader;
@@ -292,6 +343,7 @@ static iree_status_t iree_hal_embedded_elf_loader_try_load(
   // Perform the load of the ELF and wrap it in an executable handle.
   iree_status_t status = iree_hal_elf_executable_create(
       executable_params, base_executable_loader->import_provider,
+      executable_loader->module_registry, executable_loader->module_flags,
       executable_loader->host_allocator, out_executable);
 
   IREE_TRACE_ZONE_END(z0);
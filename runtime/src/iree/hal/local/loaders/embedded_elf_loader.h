@@ -20,6 +20,37 @@ extern "C" {
 typedef struct iree_hal_executable_plugin_manager_t
     iree_hal_executable_plugin_manager_t;
 
+// Controls embedded ELF loader behavior.
+enum iree_hal_embedded_elf_loader_flag_bits_t {
+  IREE_HAL_EMBEDDED_ELF_LOADER_FLAG_NONE = 0u,
+
+  // Shares the read-only segments (text/rodata) of executables loaded from
+  // identical executable data across all loaders in the process with this flag
+  // set, such as when multiple devices or executable caches prepare the same
+  // executable. Each executable still gets private writable segments. Falls
+  // back to private loads when the executable or platform does not support
+  // sharing.
+  IREE_HAL_EMBEDDED_ELF_LOADER_FLAG_SHARE_SEGMENTS = 1u << 0,
+
+  // Backs the read-only segments (text/rodata) of executables loaded by this
+  // loader with large pages when the platform supports it. This reduces iTLB
+  // misses for executables with large amounts of code at the cost of higher
+  // resident memory usage. Segments shared with
+  // IREE_HAL_EMBEDDED_ELF_LOADER_FLAG_SHARE_SEGMENTS are not affected.
+  IREE_HAL_EMBEDDED_ELF_LOADER_FLAG_LARGE_PAGES = 1u << 1,
+};
+typedef uint32_t iree_hal_embedded_elf_loader_flags_t;
+
+// Parameters for creating an embedded ELF loader.
+typedef struct iree_hal_embedded_elf_loader_options_t {
+  // Flags controlling loader behavior.
+  iree_hal_embedded_elf_loader_flags_t flags;
+} iree_hal_embedded_elf_loader_options_t;
+
+// Initializes |out_options| to their default values.
+void iree_hal_embedded_elf_loader_options_initialize(
+    iree_hal_embedded_elf_loader_options_t* out_options);
+
 // Creates an executable loader that can load minimally-featured ELF dynamic
 // libraries on any platform. This allows us to use a single file format across
 // all operating systems at the cost of some missing debugging/profiling
@@ -29,6 +60,13 @@ iree_status_t iree_hal_embedded_elf_loader_create(
     iree_allocator_t host_allocator,
     iree_hal_executable_loader_t** out_executable_loader);
 
+// Creates an embedded ELF executable loader with the given |options|.
+iree_status_t iree_hal_embedded_elf_loader_create_with_options(
+    const iree_hal_embedded_elf_loader_options_t* options,
+    iree_hal_executable_plugin_manager_t* plugin_manager,
+    iree_allocator_t host_allocator,
+    iree_hal_executable_loader_t** out_executable_loader);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
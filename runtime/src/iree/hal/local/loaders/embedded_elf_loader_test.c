@@ -0,0 +1,193 @@
+// Copyright 2025 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/local/loaders/embedded_elf_loader.h"
+
+#include <string.h>
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/hal/local/elf/elf_module_registry.h"
+#include "iree/hal/local/executable_library.h"
+#include "iree/hal/local/executable_loader.h"
+#include "iree/hal/local/local_executable.h"
+
+// ELF modules for various platforms embedded in the binary:
+#include "iree/hal/local/elf/testdata/elementwise_mul.h"
+
+static iree_status_t query_arch_test_file_data(
+    iree_const_byte_span_t* out_file_data) {
+  *out_file_data = iree_make_const_byte_span(NULL, 0);
+  iree_string_view_t pattern = iree_string_view_empty();
+#if defined(IREE_ARCH_ARM_32)
+  pattern = iree_make_cstring_view("*_arm_32.so");
+#elif defined(IREE_ARCH_ARM_64)
+  pattern = iree_make_cstring_view("*_arm_64.so");
+#elif defined(IREE_ARCH_RISCV_32)
+  pattern = iree_make_cstring_view("*_riscv_32.so");
+#elif defined(IREE_ARCH_RISCV_64)
+  pattern = iree_make_cstring_view("*_riscv_64.so");
+#elif defined(IREE_ARCH_X86_32)
+  pattern = iree_make_cstring_view("*_x86_32.so");
+#elif defined(IREE_ARCH_X86_64)
+  pattern = iree_make_cstring_view("*_x86_64.so");
+#endif  // IREE_ARCH_*
+  for (size_t i = 0; i < elementwise_mul_size(); ++i) {
+    const struct iree_file_toc_t* file_toc = &elementwise_mul_create()[i];
+    if (iree_string_view_match_pattern(iree_make_cstring_view(file_toc->name),
+                                       pattern)) {
+      *out_file_data =
+          iree_make_const_byte_span(file_toc->data, file_toc->size);
+      return iree_ok_status();
+    }
+  }
+  return iree_make_status(IREE_STATUS_NOT_FOUND,
+                          "no architecture-specific ELF binary embedded into "
+                          "the application for the current target platform");
+}
+
+static iree_status_t load_executable(iree_hal_executable_loader_t* loader,
+                                     iree_const_byte_span_t file_data,
+                                     iree_hal_executable_t** out_executable) {
+  iree_hal_executable_params_t executable_params;
+  iree_hal_executable_params_initialize(&executable_params);
+  executable_params.caching_mode =
+      IREE_HAL_EXECUTABLE_CACHING_MODE_ALIAS_PROVIDED_DATA;
+  executable_params.executable_format =
+      iree_make_cstring_view("embedded-elf-" IREE_ARCH);
+  executable_params.executable_data = file_data;
+  return iree_hal_executable_loader_try_load(loader, &executable_params,
+                                             /*worker_capacity=*/1,
+                                             out_executable);
+}
+
+// Dispatches the elementwise multiply export and verifies its results.
+static iree_status_t dispatch_executable(iree_hal_executable_t* executable) {
+  // ret0 = arg0 * arg1
+  float arg0[4] = {1.0f, 2.0f, 3.0f, 4.0f};
+  float arg1[4] = {100.0f, 200.0f, 300.0f, 400.0f};
+  float ret0[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+  const float expected[4] = {100.0f, 400.0f, 900.0f, 1600.0f};
+  size_t binding_lengths[3] = {sizeof(arg0), sizeof(arg1), sizeof(ret0)};
+  void* binding_ptrs[3] = {arg0, arg1, ret0};
+  const iree_hal_executable_dispatch_state_v0_t dispatch_state = {
+      .workgroup_size_x = 1,
+      .workgroup_size_y = 1,
+      .workgroup_size_z = 1,
+      .workgroup_count_x = 1,
+      .workgroup_count_y = 1,
+      .workgroup_count_z = 1,
+      .max_concurrency = 1,
+      .binding_count = 1,
+      .binding_lengths = binding_lengths,
+      .binding_ptrs = binding_ptrs,
+  };
+  const iree_hal_executable_workgroup_state_v0_t workgroup_state = {0};
+  IREE_RETURN_IF_ERROR(iree_hal_local_executable_issue_call(
+      iree_hal_local_executable_cast(executable), /*ordinal=*/0,
+      &dispatch_state, &workgroup_state, /*worker_id=*/0));
+  for (int i = 0; i < IREE_ARRAYSIZE(expected); ++i) {
+    if (ret0[i] != expected[i]) {
+      return iree_make_status(IREE_STATUS_INTERNAL,
+                              "output mismatch: ret[%d] = %.1f, expected %.1f",
+                              i, ret0[i], expected[i]);
+    }
+  }
+  return iree_ok_status();
+}
+
+// Loads the same ELF twice with |flags| and verifies that the registry holds
+// |expected_shared_count| entries while both executables are live and that
+// each executable keeps working independently of the other.
+static iree_status_t run_load_twice_test(
+    iree_hal_embedded_elf_loader_flags_t flags,
+    iree_host_size_t expected_shared_count) {
+  iree_const_byte_span_t file_data;
+  IREE_RETURN_IF_ERROR(query_arch_test_file_data(&file_data));
+
+  iree_hal_embedded_elf_loader_options_t options;
+  iree_hal_embedded_elf_loader_options_initialize(&options);
+  options.flags = flags;
+  iree_hal_executable_loader_t* loader = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_embedded_elf_loader_create_with_options(
+      &options, /*plugin_manager=*/NULL, iree_allocator_system(), &loader));
+
+  iree_elf_module_registry_t* registry = iree_elf_module_registry_default();
+  const iree_host_size_t base_count = iree_elf_module_registry_count(registry);
+
+  iree_hal_executable_t* executable_a = NULL;
+  iree_hal_executable_t* executable_b = NULL;
+  iree_status_t status = load_executable(loader, file_data, &executable_a);
+  if (iree_status_is_ok(status)) {
+    status = load_executable(loader, file_data, &executable_b);
+  }
+
+  // Code is shared through a single registry entry.
+  if (iree_status_is_ok(status) &&
+      iree_elf_module_registry_count(registry) !=
+          base_count + expected_shared_count) {
+    status = iree_make_status(
+        IREE_STATUS_INTERNAL,
+        "expected %" PRIhsz " shared segment entries, have %" PRIhsz,
+        expected_shared_count,
+        iree_elf_module_registry_count(registry) - base_count);
+  }
+
+  // Data is private: the library tables are relocated per executable.
+  if (iree_status_is_ok(status)) {
+    const iree_hal_executable_dispatch_attrs_v0_t* attrs_a =
+        iree_hal_local_executable_cast(executable_a)->dispatch_attrs;
+    const iree_hal_executable_dispatch_attrs_v0_t* attrs_b =
+        iree_hal_local_executable_cast(executable_b)->dispatch_attrs;
+    if (attrs_a && attrs_a == attrs_b) {
+      status = iree_make_status(IREE_STATUS_INTERNAL,
+                                "executables alias the same library data");
+    }
+  }
+
+  if (iree_status_is_ok(status)) status = dispatch_executable(executable_a);
+  if (iree_status_is_ok(status)) status = dispatch_executable(executable_b);
+
+  // Releasing the executable that populated the shared segments must not
+  // affect the other.
+  iree_hal_executable_release(executable_a);
+  if (iree_status_is_ok(status)) status = dispatch_executable(executable_b);
+  iree_hal_executable_release(executable_b);
+
+  if (iree_status_is_ok(status) &&
+      iree_elf_module_registry_count(registry) != base_count) {
+    status = iree_make_status(IREE_STATUS_INTERNAL,
+                              "shared segments outlived their executables");
+  }
+
+  iree_hal_executable_loader_release(loader);
+  return status;
+}
+
+int main() {
+  iree_status_t status =
+      run_load_twice_test(IREE_HAL_EMBEDDED_ELF_LOADER_FLAG_NONE,
+                          /*expected_shared_count=*/0);
+  if (iree_status_is_ok(status)) {
+    // Modules smaller than a large page must load normally with large pages
+    // requested.
+    status = run_load_twice_test(IREE_HAL_EMBEDDED_ELF_LOADER_FLAG_LARGE_PAGES,
+                                 /*expected_shared_count=*/0);
+  }
+#if defined(IREE_PLATFORM_LINUX)
+  if (iree_status_is_ok(status)) {
+    status = run_load_twice_test(
+        IREE_HAL_EMBEDDED_ELF_LOADER_FLAG_SHARE_SEGMENTS,
+        /*expected_shared_count=*/1);
+  }
+#endif  // IREE_PLATFORM_LINUX
+  int ret = (int)iree_status_code(status);
+  if (!iree_status_is_ok(status)) {
+    iree_status_fprint(stderr, status);
+    iree_status_free(status);
+  }
+  return ret;
+}
@@ -16,7 +16,32 @@
 #endif  // IREE_HAVE_HAL_EXECUTABLE_LOADER_SYSTEM_LIBRARY
 
 #if defined(IREE_HAVE_HAL_EXECUTABLE_LOADER_EMBEDDED_ELF)
+#include "iree/base/internal/flags.h"
 #include "iree/hal/local/loaders/embedded_elf_loader.h"
+
+IREE_FLAG(bool, embedded_elf_share_segments, false,
+          "Shares the read-only segments (text/rodata) of identical embedded "
+          "ELF executables loaded by multiple devices. Writable segments "
+          "remain private to each executable.");
+IREE_FLAG(bool, embedded_elf_large_pages, false,
+          "Backs the text and rodata of embedded ELF executables with large "
+          "pages (2 MiB transparent huge pages on Linux) when supported.");
+
+static iree_status_t iree_hal_embedded_elf_loader_create_from_flags(
+    iree_hal_executable_plugin_manager_t* plugin_manager,
+    iree_allocator_t host_allocator,
+    iree_hal_executable_loader_t** out_executable_loader) {
+  iree_hal_embedded_elf_loader_options_t options;
+  iree_hal_embedded_elf_loader_options_initialize(&options);
+  if (FLAG_embedded_elf_share_segments) {
+    options.flags |= IREE_HAL_EMBEDDED_ELF_LOADER_FLAG_SHARE_SEGMENTS;
+  }
+  if (FLAG_embedded_elf_large_pages) {
+    options.flags |= IREE_HAL_EMBEDDED_ELF_LOADER_FLAG_LARGE_PAGES;
+  }
+  return iree_hal_embedded_elf_loader_create_with_options(
+      &options, plugin_manager, host_allocator, out_executable_loader);
+}
 #endif  // IREE_HAVE_HAL_EXECUTABLE_LOADER_EMBEDDED_ELF
 
 #if defined(IREE_HAVE_HAL_EXECUTABLE_LOADER_VMVX_MODULE)
@@ -59,8 +84,8 @@ IREE_API_EXPORT iree_status_t iree_hal_create_all_available_executable_loaders(
 
 #if defined(IREE_HAVE_HAL_EXECUTABLE_LOADER_EMBEDDED_ELF)
   if (iree_status_is_ok(status)) {
-    status = iree_hal_embedded_elf_loader_create(plugin_manager, host_allocator,
-                                                 &loaders[count++]);
+    status = iree_hal_embedded_elf_loader_create_from_flags(
+        plugin_manager, host_allocator, &loaders[count++]);
   }
 #endif  // IREE_HAVE_HAL_EXECUTABLE_LOADER_EMBEDDED_ELF
 
@@ -89,8 +114,8 @@ IREE_API_EXPORT iree_status_t iree_hal_create_executable_loader_by_name(
     iree_hal_executable_loader_t** out_executable_loader) {
 #if defined(IREE_HAVE_HAL_EXECUTABLE_LOADER_EMBEDDED_ELF)
   if (iree_string_view_starts_with(name, IREE_SV("embedded-elf"))) {
-    return iree_hal_embedded_elf_loader_create(plugin_manager, host_allocator,
-                                               out_executable_loader);
+    return iree_hal_embedded_elf_loader_create_from_flags(
+        plugin_manager, host_allocator, out_executable_loader);
   }
 #endif  // IREE_HAVE_HAL_EXECUTABLE_LOADER_EMBEDDED_ELF
 
@@ -7,6 +7,20 @@
 #include "iree/hal/utils/resource_set.h"
 
 #include "iree/base/internal/debugging.h"
+#include "iree/base/internal/math.h"
+
+#if defined(IREE_ARCH_X86_64)
+#include <emmintrin.h>
+#elif defined(IREE_ARCH_ARM_64)
+#include <arm_neon.h>
+#endif  // IREE_ARCH_*
+
+// Maximum number of resources processed together by a batched insertion.
+// Each batch is deduplicated against itself and the MRU before any resources
+// are retained. Sized to keep the scratch arrays small enough for the stack.
+#define IREE_HAL_RESOURCE_SET_BATCH_SIZE 32
+static_assert(IREE_HAL_RESOURCE_SET_BATCH_SIZE * 2 == 64,
+              "batch miss table is indexed with a 6-bit hash");
 
 // Computes the total capacity in resources of a chunk allocated with a total
 // |storage_size| (including the header).
@@ -164,6 +178,126 @@ static iree_status_t iree_hal_resource_set_insert_retain(
   return iree_ok_status();
 }
 
+#if defined(IREE_ARCH_X86_64)
+// Returns a 2-bit mask indicating which of the pointers in |pair| match
+// |needle| (splatted to both 64-bit lanes).
+static inline uint32_t iree_hal_resource_set_mru_match_pair(
+    iree_hal_resource_t* const* pair, __m128i needle) {
+  // SSE2 has no 64-bit compare so we compare 32-bit halves and require both
+  // halves of a lane to match.
+  __m128i eq32 = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i*)pair), needle);
+  __m128i eq64 =
+      _mm_and_si128(eq32, _mm_shuffle_epi32(eq32, _MM_SHUFFLE(2, 3, 0, 1)));
+  return (uint32_t)_mm_movemask_pd(_mm_castsi128_pd(eq64));
+}
+#elif defined(IREE_ARCH_ARM_64)
+// Returns a 2-bit mask indicating which of the pointers in |pair| match
+// |needle| (splatted to both 64-bit lanes).
+static inline uint32_t iree_hal_resource_set_mru_match_pair(
+    iree_hal_resource_t* const* pair, uint64x2_t needle) {
+  const uint64x2_t lane_bits = vcombine_u64(vcreate_u64(1), vcreate_u64(2));
+  uint64x2_t eq = vceqq_u64(vld1q_u64((const uint64_t*)pair), needle);
+  return (uint32_t)vaddvq_u64(vandq_u64(eq, lane_bits));
+}
+#endif  // IREE_ARCH_*
+
+// Returns a bitmask with bit i set if |mru|[i] is |resource|.
+// |mru| must have IREE_HAL_RESOURCE_SET_MRU_SIZE entries. As the MRU never
+// contains duplicates at most one bit will be set for non-NULL resources.
+//
+// The MRU is a single cache line and on x86_64 and arm_64 it is compared as
+// four 128-bit registers of pointer pairs without any branches.
+static inline uint32_t iree_hal_resource_set_mru_match(
+    iree_hal_resource_t* const* mru, const iree_hal_resource_t* resource) {
+#if defined(IREE_ARCH_X86_64) || defined(IREE_ARCH_ARM_64)
+  static_assert(IREE_HAL_RESOURCE_SET_MRU_SIZE == 8,
+                "vectorized MRU scan expects 8 64-bit pointers");
+#if defined(IREE_ARCH_X86_64)
+  const __m128i needle = _mm_set1_epi64x((int64_t)(uintptr_t)resource);
+#else
+  const uint64x2_t needle = vdupq_n_u64((uint64_t)(uintptr_t)resource);
+#endif  // IREE_ARCH_X86_64
+  return iree_hal_resource_set_mru_match_pair(&mru[0], needle) |
+         (iree_hal_resource_set_mru_match_pair(&mru[2], needle) << 2) |
+         (iree_hal_resource_set_mru_match_pair(&mru[4], needle) << 4) |
+         (iree_hal_resource_set_mru_match_pair(&mru[6], needle) << 6);
+#else
+  uint32_t mask = 0;
+  for (int i = 0; i < IREE_HAL_RESOURCE_SET_MRU_SIZE; ++i) {
+    mask |= (uint32_t)(mru[i] == resource) << i;
+  }
+  return mask;
+#endif  // IREE_ARCH_*
+}
+
+#if defined(IREE_ARCH_X86_64)
+// Stores (|prev|[1], |pair|[0]) to |pair_ptr| for lanes where |lane_index| is
+// less than |limit| and returns the original |pair| for the next pair.
+static inline __m128i iree_hal_resource_set_mru_shift_pair(
+    iree_hal_resource_t** pair_ptr, __m128i prev, __m128i lane_index,
+    __m128i limit) {
+  __m128i pair = _mm_loadu_si128((const __m128i*)pair_ptr);
+  __m128i shifted = _mm_castpd_si128(
+      _mm_shuffle_pd(_mm_castsi128_pd(prev), _mm_castsi128_pd(pair), 1));
+  __m128i select = _mm_cmplt_epi32(lane_index, limit);
+  _mm_storeu_si128((__m128i*)pair_ptr,
+                   _mm_or_si128(_mm_and_si128(select, shifted),
+                                _mm_andnot_si128(select, pair)));
+  return pair;
+}
+#elif defined(IREE_ARCH_ARM_64)
+// Stores (|prev|[1], |pair|[0]) to |pair_ptr| for lanes where |lane_index| is
+// less than |limit| and returns the original |pair| for the next pair.
+static inline uint64x2_t iree_hal_resource_set_mru_shift_pair(
+    iree_hal_resource_t** pair_ptr, uint64x2_t prev, uint64x2_t lane_index,
+    uint64x2_t limit) {
+  uint64x2_t pair = vld1q_u64((const uint64_t*)pair_ptr);
+  uint64x2_t shifted = vextq_u64(prev, pair, 1);
+  uint64x2_t select = vcltq_u64(lane_index, limit);
+  vst1q_u64((uint64_t*)pair_ptr, vbslq_u64(select, shifted, pair));
+  return pair;
+}
+#endif  // IREE_ARCH_*
+
+// Moves |resource| to the head of the |mru| shifting entries [0, |index|) down
+// by one. |index| is either the current position of |resource| in the MRU or
+// the last entry if it was not present (evicting it).
+//
+// On x86_64 and arm_64 the whole MRU is shifted in registers and blended with
+// the original entries based on |index| such that it is always stored back as
+// full 128-bit vectors. This avoids store-to-load forwarding stalls when the
+// next scan loads the pairs that were otherwise partially written by a
+// memmove.
+static inline void iree_hal_resource_set_mru_promote(
+    iree_hal_resource_t** mru, iree_hal_resource_t* resource, int index) {
+#if defined(IREE_ARCH_X86_64)
+  const __m128i limit = _mm_set1_epi32(index + 1);
+  __m128i prev = _mm_set1_epi64x((int64_t)(uintptr_t)resource);
+  prev = iree_hal_resource_set_mru_shift_pair(
+      &mru[0], prev, _mm_set_epi32(1, 1, 0, 0), limit);
+  prev = iree_hal_resource_set_mru_shift_pair(
+      &mru[2], prev, _mm_set_epi32(3, 3, 2, 2), limit);
+  prev = iree_hal_resource_set_mru_shift_pair(
+      &mru[4], prev, _mm_set_epi32(5, 5, 4, 4), limit);
+  iree_hal_resource_set_mru_shift_pair(&mru[6], prev,
+                                       _mm_set_epi32(7, 7, 6, 6), limit);
+#elif defined(IREE_ARCH_ARM_64)
+  const uint64x2_t limit = vdupq_n_u64((uint64_t)index + 1);
+  uint64x2_t prev = vdupq_n_u64((uint64_t)(uintptr_t)resource);
+  prev = iree_hal_resource_set_mru_shift_pair(
+      &mru[0], prev, vcombine_u64(vcreate_u64(0), vcreate_u64(1)), limit);
+  prev = iree_hal_resource_set_mru_shift_pair(
+      &mru[2], prev, vcombine_u64(vcreate_u64(2), vcreate_u64(3)), limit);
+  prev = iree_hal_resource_set_mru_shift_pair(
+      &mru[4], prev, vcombine_u64(vcreate_u64(4), vcreate_u64(5)), limit);
+  iree_hal_resource_set_mru_shift_pair(
+      &mru[6], prev, vcombine_u64(vcreate_u64(6), vcreate_u64(7)), limit);
+#else
+  memmove(&mru[1], &mru[0], sizeof(mru[0]) * index);
+  mru[0] = resource;
+#endif  // IREE_ARCH_*
+}
+
 // Scans the lookaside for the resource pointer and updates the order if found.
 // If the resource was not found then it will be inserted into the main list as
 // well as the MRU.
@@ -208,56 +342,25 @@ static iree_status_t iree_hal_resource_set_insert_retain(
 // single cache line, do all the scanning and shifting in registers, and then
 // store back to the single cache line.
 //
-// Today, though, we leave this as an exercise to whoever comes across this :)
-// Notes:
-//   As the MRU is a fixed size we can unroll it entirely and avoid any looping.
-//   On a 32-bit system with uint32x4_t we only need 4 registers.
-//   On a 64-bit system with uint64x2_t we also only need 4 registers - though
-//   the MRU has half as many entries and we may want to go >1 cache line.
-//
-//   If we wanted to process more than one resource at a time we can specialize
-//   the code paths to handle 1/2/4/etc resources and process in batches with
-//   an optional remainder. This would increase the ratio of work performed on
-//   the loaded MRU registers before we do the shift/store.
+// This is now implemented with SIMD where available: the scan is performed
+// by iree_hal_resource_set_mru_match and the shift by
+// iree_hal_resource_set_mru_promote, each operating on the 4 128-bit registers
+// that cover the MRU cache line. Lists of resources that exceed the MRU are
+// handled by iree_hal_resource_set_insert_batch which amortizes the MRU update
+// and chunk insertion across the whole batch.
 //
-//   The tree sequence we likely want is something like:
-//    https://developer.arm.com/architectures/instruction-sets/intrinsics/vdupq_n_u32
-//    https://developer.arm.com/architectures/instruction-sets/intrinsics/vceqq_u32
-//    https://developer.arm.com/architectures/instruction-sets/intrinsics/vorrq_u32
-//    https://developer.arm.com/architectures/instruction-sets/intrinsics/vmaxvq_u32
-//    or
-//    https://developer.arm.com/architectures/instruction-sets/intrinsics/vdupq_n_u64
-//    https://developer.arm.com/architectures/instruction-sets/intrinsics/vceqq_u64
-//    https://developer.arm.com/architectures/instruction-sets/intrinsics/vorrq_u64
-//    https://developer.arm.com/architectures/instruction-sets/intrinsics/vreinterpretq_u64_u32
-//    https://developer.arm.com/architectures/instruction-sets/intrinsics/vmaxvq_u32
-//   This would yield whether the pointer was found, but instead of maxing at
-//   the end we can use the produced mask to extract out a single register with
-//   which positions are hits and use that to then permute the registers into
-//   the proper order. At the end we could use a table instruction to remap and
-//   extract out a byte/bitmap of the indices that we need to insert into the
-//   main set.
-//
-//   The shifting can be performed with
-//    https://developer.arm.com/architectures/instruction-sets/intrinsics/vextq_u32
-//    https://developer.arm.com/architectures/instruction-sets/intrinsics/vextq_u64
-//   This takes n low elements of LHS and rest from RHS and we can cascade them
-//   to shift down the whole MRU.
-//
-//   We can use SIMDE as a rosetta stone for getting neon/avx/wasm/etc:
-//   https://github.com/simd-everywhere/simde/blob/master/simde/arm/neon/ceq.h#L591
+// We can use SIMDE as a rosetta stone for porting to other targets:
+// https://github.com/simd-everywhere/simde/blob/master/simde/arm/neon/ceq.h#L591
 static iree_status_t iree_hal_resource_set_insert_1(
     iree_hal_resource_set_t* set, iree_hal_resource_t* resource) {
   // Scan and hope for a hit.
-  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(set->mru); ++i) {
-    if (set->mru[i] != resource) continue;
+  uint32_t match_mask = iree_hal_resource_set_mru_match(set->mru, resource);
+  if (match_mask) {
     // Hit - keep the list sorted by most->least recently used.
     // We shift the MRU down to make room at index 0 and store the
     // resource there.
-    if (i > 0) {
-      memmove(&set->mru[1], &set->mru[0], sizeof(set->mru[0]) * i);
-      set->mru[0] = resource;
-    }
+    int i = iree_math_count_trailing_zeros_u32(match_mask);
+    if (i > 0) iree_hal_resource_set_mru_promote(set->mru, resource, i);
     return iree_ok_status();
   }
 
@@ -267,9 +370,95 @@ static iree_status_t iree_hal_resource_set_insert_1(
   IREE_RETURN_IF_ERROR(iree_hal_resource_set_insert_retain(set, resource));
 
   // Shift the MRU down and insert the new item at the head.
-  memmove(&set->mru[1], &set->mru[0],
-          sizeof(set->mru[0]) * (IREE_ARRAYSIZE(set->mru) - 1));
-  set->mru[0] = resource;
+  iree_hal_resource_set_mru_promote(set->mru, resource,
+                                    IREE_ARRAYSIZE(set->mru) - 1);
+
+  return iree_ok_status();
+}
+
+// Inserts a batch of up to IREE_HAL_RESOURCE_SET_BATCH_SIZE non-NULL
+// |resources| in one pass.
+//
+// Resources are first deduplicated against the MRU and each other so that a
+// binding table referencing the same buffer many times only retains it once.
+// The remaining misses are retained and appended to the chunks with one
+// capacity check per chunk and the MRU is rebuilt once at the end with the
+// batch in most-recently-used order followed by the surviving prior entries.
+// The resulting MRU matches what inserting the resources one at a time would
+// have produced.
+static iree_status_t iree_hal_resource_set_insert_batch(
+    iree_hal_resource_set_t* set, iree_host_size_t count,
+    iree_hal_resource_t* const* resources) {
+  // Gather the unique misses. Misses are deduplicated with a small open
+  // addressing table as tables may reference dozens of unique resources.
+  iree_hal_resource_t* misses[IREE_HAL_RESOURCE_SET_BATCH_SIZE];
+  iree_host_size_t miss_count = 0;
+  iree_hal_resource_t* miss_table[IREE_HAL_RESOURCE_SET_BATCH_SIZE * 2];
+  memset(miss_table, 0, sizeof(miss_table));
+  for (iree_host_size_t i = 0; i < count; ++i) {
+    iree_hal_resource_t* resource = resources[i];
+    if (iree_hal_resource_set_mru_match(set->mru, resource)) continue;
+    // Fibonacci hash of the pointer bits above the allocation alignment.
+    iree_host_size_t slot =
+        (iree_host_size_t)(((uint64_t)(uintptr_t)resource >> 4) *
+                           0x9E3779B97F4A7C15ull >> 58);
+    while (miss_table[slot] && miss_table[slot] != resource) {
+      slot = (slot + 1) % IREE_ARRAYSIZE(miss_table);
+    }
+    if (miss_table[slot]) continue;  // duplicate
+    miss_table[slot] = resource;
+    misses[miss_count++] = resource;
+  }
+
+  // Retain the misses into the main list. Note that we do this before updating
+  // the MRU in case allocation fails - we don't want to keep the pointers
+  // around unless we've really retained them.
+  iree_host_size_t miss_index = 0;
+  while (miss_index < miss_count) {
+    iree_hal_resource_set_chunk_t* chunk = set->chunk_head;
+    if (IREE_UNLIKELY(chunk->count == chunk->capacity)) {
+      iree_arena_block_t* block = NULL;
+      IREE_RETURN_IF_ERROR(iree_arena_block_pool_acquire(
+          set->block_pool, &block, (void**)&chunk));
+      chunk->next_chunk = set->chunk_head;
+      set->chunk_head = chunk;
+      chunk->capacity = iree_hal_resource_set_chunk_capacity(
+          set->block_pool->usable_block_size);
+      chunk->count = 0;
+    }
+    iree_host_size_t run_count =
+        iree_min(miss_count - miss_index,
+                 (iree_host_size_t)(chunk->capacity - chunk->count));
+    for (iree_host_size_t i = 0; i < run_count; ++i) {
+      iree_hal_resource_t* resource = misses[miss_index + i];
+      chunk->resources[chunk->count + i] = resource;
+      iree_hal_resource_retain(resource);
+    }
+    chunk->count += (uint16_t)run_count;
+    miss_index += run_count;
+  }
+
+  // Rebuild the MRU: the batch from last to first occurrence followed by the
+  // prior MRU entries that were not touched by the batch. The new MRU is built
+  // in scratch storage and scanned with scalar loads as it is being written.
+  iree_hal_resource_t* mru[IREE_HAL_RESOURCE_SET_MRU_SIZE] = {NULL};
+  iree_host_size_t mru_count = 0;
+  for (iree_host_size_t i = 0;
+       i < count + IREE_ARRAYSIZE(set->mru) && mru_count < IREE_ARRAYSIZE(mru);
+       ++i) {
+    iree_hal_resource_t* resource =
+        i < count ? resources[count - i - 1] : set->mru[i - count];
+    if (!resource) break;  // end of a partially filled prior MRU
+    bool is_present = false;
+    for (iree_host_size_t j = 0; j < mru_count; ++j) {
+      if (mru[j] == resource) {
+        is_present = true;
+        break;
+      }
+    }
+    if (!is_present) mru[mru_count++] = resource;
+  }
+  memcpy(set->mru, mru, sizeof(set->mru));
 
   return iree_ok_status();
 }
@@ -282,22 +471,57 @@ iree_hal_resource_set_insert(iree_hal_resource_set_t* set,
                                               sizeof(iree_hal_resource_t*));
 }
 
+// Gathers the non-NULL resources from |count| strided |elements| into batches
+// and inserts each batch. Kept out of line so that single insertions do not
+// pay for the batch storage.
+static IREE_ATTRIBUTE_NOINLINE iree_status_t
+iree_hal_resource_set_insert_strided_batched(iree_hal_resource_set_t* set,
+                                             iree_host_size_t count,
+                                             const uint8_t* elements_ptr,
+                                             iree_host_size_t stride) {
+  iree_hal_resource_t* batch[IREE_HAL_RESOURCE_SET_BATCH_SIZE];
+  iree_host_size_t batch_count = 0;
+  for (iree_host_size_t i = 0; i < count; ++i) {
+    iree_hal_resource_t* resource =
+        *(iree_hal_resource_t**)(elements_ptr + i * stride);
+    if (!resource) continue;
+    batch[batch_count++] = resource;
+    if (batch_count == IREE_ARRAYSIZE(batch)) {
+      IREE_RETURN_IF_ERROR(
+          iree_hal_resource_set_insert_batch(set, batch_count, batch));
+      batch_count = 0;
+    }
+  }
+  if (batch_count > 0) {
+    IREE_RETURN_IF_ERROR(
+        iree_hal_resource_set_insert_batch(set, batch_count, batch));
+  }
+  return iree_ok_status();
+}
+
 IREE_API_EXPORT iree_status_t iree_hal_resource_set_insert_strided(
     iree_hal_resource_set_t* set, iree_host_size_t count, const void* elements,
     iree_host_size_t offset, iree_host_size_t stride) {
   IREE_ASSERT_ARGUMENT(set);
-  // For now we process one at a time. We should have a stride that lets us
-  // amortize the cost of doing the MRU update and insertion allocation by
-  // say slicing off 4/8/16/32 resources at a time etc. Today each miss that
-  // requires a full insertion goes down the whole path of checking chunk
-  // capacity and such.
-  const uint8_t* elements_ptr = (const uint8_t*)elements;
-  for (iree_host_size_t i = 0; i < count; ++i) {
-    iree_hal_resource_t* resource =
-        *(iree_hal_resource_t**)(elements_ptr + i * stride + offset);
-    if (resource) {
-      IREE_RETURN_IF_ERROR(iree_hal_resource_set_insert_1(set, resource));
+  const uint8_t* elements_ptr = (const uint8_t*)elements + offset;
+
+  // Single resources (the common case when recording individual commands) and
+  // lists that fit within the MRU go down the fast path that only shifts the
+  // MRU. Any duplicates in such lists are guaranteed to hit.
+  if (count <= IREE_HAL_RESOURCE_SET_MRU_SIZE) {
+    for (iree_host_size_t i = 0; i < count; ++i) {
+      iree_hal_resource_t* resource =
+          *(iree_hal_resource_t**)(elements_ptr + i * stride);
+      if (resource) {
+        IREE_RETURN_IF_ERROR(iree_hal_resource_set_insert_1(set, resource));
+      }
     }
+    return iree_ok_status();
   }
-  return iree_ok_status();
+
+  // Larger binding tables and other lists are gathered into batches that
+  // amortize the MRU update and chunk capacity checks across all resources in
+  // the batch and deduplicate resources referenced multiple times.
+  return iree_hal_resource_set_insert_strided_batched(set, count, elements_ptr,
+                                                      stride);
 }
@@ -131,6 +131,10 @@ iree_hal_resource_set_insert(iree_hal_resource_set_t* set,
 // structure. Each resource will be retained for at least the lifetime of the
 // set. Entries will be ignored if NULL.
 //
+// Prefer this over inserting entries one at a time when recording binding
+// tables or other lists: large lists are processed in batches that retain each
+// unique resource only once and update the MRU once per batch.
+//
 // |elements| should point to the first element of the data structure array,
 // |offset| to the iree_hal_resource_t* pointer within it, and |stride| should
 // be the bytes between that and the subsequent data structure entry. For
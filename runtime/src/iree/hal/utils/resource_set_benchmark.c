@@ -4,6 +4,7 @@
 // See https://llvm.org/LICENSE.txt for license information.
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
+#include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -203,6 +204,121 @@ static iree_status_t iree_hal_resource_set_benchmark_randomized_n(
   return iree_ok_status();
 }
 
+// A binding table entry as stored by command buffers.
+typedef struct iree_hal_test_binding_t {
+  iree_hal_resource_t* buffer;
+  uint64_t offset;
+  uint64_t length;
+} iree_hal_test_binding_t;
+
+// Number of unique buffers bindings are drawn from when simulating dispatches.
+#define IREE_HAL_TEST_DISPATCH_BUFFER_COUNT 16
+// Number of dispatches recorded per benchmark iteration.
+#define IREE_HAL_TEST_DISPATCH_BATCH_COUNT 256
+
+// Simulates recording dispatches into a command buffer: each dispatch inserts
+// its executable and a binding table of buffers randomly drawn from a small
+// pool. Reported times are per dispatch.
+//
+// If |insert_bindings_individually| is true each binding is inserted on its
+// own as some command buffer implementations do instead of inserting the
+// whole table with one strided insertion.
+static iree_status_t iree_hal_resource_set_benchmark_dispatch(
+    const iree_benchmark_def_t* benchmark_def,
+    iree_benchmark_state_t* benchmark_state,
+    bool insert_bindings_individually) {
+  iree_allocator_t host_allocator = benchmark_state->host_allocator;
+
+  // Initialize the block pool we'll be serving from.
+  // Sized like we usually do it in the runtime for ~512-1024 elements.
+  iree_arena_block_pool_t block_pool;
+  iree_arena_block_pool_initialize(4096, host_allocator, &block_pool);
+
+  // Allocate the executable and the buffer pool used by the bindings.
+  iree_hal_resource_t* executable = NULL;
+  IREE_CHECK_OK(iree_hal_test_resource_create(host_allocator, &executable));
+  iree_hal_resource_t* buffers[IREE_HAL_TEST_DISPATCH_BUFFER_COUNT] = {NULL};
+  for (uint32_t i = 0; i < IREE_ARRAYSIZE(buffers); ++i) {
+    IREE_CHECK_OK(iree_hal_test_resource_create(host_allocator, &buffers[i]));
+  }
+
+  // Preassign the binding tables for all dispatches in a batch so that the
+  // PRNG does not factor into the timing.
+  uint32_t binding_count = (uint32_t)(uintptr_t)benchmark_def->user_data;
+  iree_hal_test_binding_t* bindings = NULL;
+  IREE_CHECK_OK(iree_allocator_malloc(
+      host_allocator,
+      sizeof(*bindings) * binding_count * IREE_HAL_TEST_DISPATCH_BATCH_COUNT,
+      (void**)&bindings));
+  iree_prng_xoroshiro128_state_t prng = {0};
+  iree_prng_xoroshiro128_initialize(123ull, &prng);
+  for (uint32_t i = 0; i < binding_count * IREE_HAL_TEST_DISPATCH_BATCH_COUNT;
+       ++i) {
+    uint32_t buffer_idx = iree_prng_xoroshiro128plus_next_uint32(&prng) %
+                          IREE_ARRAYSIZE(buffers);
+    bindings[i].buffer = buffers[buffer_idx];
+    bindings[i].offset = 0;
+    bindings[i].length = 1024;
+  }
+
+  // Each iteration records a batch of dispatches into a fresh set as a command
+  // buffer would.
+  while (iree_benchmark_keep_running(
+      benchmark_state,
+      /*batch_count=*/IREE_HAL_TEST_DISPATCH_BATCH_COUNT)) {
+    iree_hal_resource_set_t* set = NULL;
+    IREE_CHECK_OK(iree_hal_resource_set_allocate(&block_pool, &set));
+    for (uint32_t i = 0; i < IREE_HAL_TEST_DISPATCH_BATCH_COUNT; ++i) {
+      IREE_CHECK_OK(iree_hal_resource_set_insert(set, 1, &executable));
+      const iree_hal_test_binding_t* dispatch_bindings =
+          &bindings[i * binding_count];
+      if (insert_bindings_individually) {
+        for (uint32_t j = 0; j < binding_count; ++j) {
+          IREE_CHECK_OK(iree_hal_resource_set_insert(
+              set, 1, &dispatch_bindings[j].buffer));
+        }
+      } else {
+        IREE_CHECK_OK(iree_hal_resource_set_insert_strided(
+            set, binding_count, dispatch_bindings,
+            offsetof(iree_hal_test_binding_t, buffer),
+            sizeof(iree_hal_test_binding_t)));
+      }
+    }
+    iree_hal_resource_set_free(set);
+  }
+
+  // Cleanup.
+  iree_allocator_free(host_allocator, bindings);
+  for (uint32_t i = 0; i < IREE_ARRAYSIZE(buffers); ++i) {
+    iree_hal_resource_release(buffers[i]);
+  }
+  iree_hal_resource_release(executable);
+  iree_arena_block_pool_deinitialize(&block_pool);
+
+  return iree_ok_status();
+}
+
+// Tests recording dispatches with strided binding table insertion.
+//
+// user_data is the number of bindings per dispatch.
+static iree_status_t iree_hal_resource_set_benchmark_dispatch_n(
+    const iree_benchmark_def_t* benchmark_def,
+    iree_benchmark_state_t* benchmark_state) {
+  return iree_hal_resource_set_benchmark_dispatch(
+      benchmark_def, benchmark_state, /*insert_bindings_individually=*/false);
+}
+
+// Tests recording dispatches with each binding inserted individually.
+// Compare with dispatch_n to see the benefit of batched insertion.
+//
+// user_data is the number of bindings per dispatch.
+static iree_status_t iree_hal_resource_set_benchmark_dispatch_individual_n(
+    const iree_benchmark_def_t* benchmark_def,
+    iree_benchmark_state_t* benchmark_state) {
+  return iree_hal_resource_set_benchmark_dispatch(
+      benchmark_def, benchmark_state, /*insert_bindings_individually=*/true);
+}
+
 int main(int argc, char** argv) {
   iree_benchmark_initialize(&argc, argv);
 
@@ -282,6 +398,38 @@ int main(int argc, char** argv) {
                             &benchmark_def);
   }
 
+  // iree_hal_resource_set_benchmark_dispatch_n
+  // iree_hal_resource_set_benchmark_dispatch_individual_n
+  {
+    iree_benchmark_def_t benchmark_def = {
+        .flags = IREE_BENCHMARK_FLAG_MEASURE_PROCESS_CPU_TIME |
+                 IREE_BENCHMARK_FLAG_USE_REAL_TIME,
+        .time_unit = IREE_BENCHMARK_UNIT_NANOSECOND,
+        .minimum_duration_ns = 0,
+        .iteration_count = 0,
+        .run = iree_hal_resource_set_benchmark_dispatch_n,
+    };
+    benchmark_def.user_data = (void*)4u;
+    iree_benchmark_register(iree_make_cstring_view("dispatch_4"),
+                            &benchmark_def);
+    benchmark_def.user_data = (void*)16u;
+    iree_benchmark_register(iree_make_cstring_view("dispatch_16"),
+                            &benchmark_def);
+    benchmark_def.user_data = (void*)64u;
+    iree_benchmark_register(iree_make_cstring_view("dispatch_64"),
+                            &benchmark_def);
+    benchmark_def.run = iree_hal_resource_set_benchmark_dispatch_individual_n;
+    benchmark_def.user_data = (void*)4u;
+    iree_benchmark_register(iree_make_cstring_view("dispatch_individual_4"),
+                            &benchmark_def);
+    benchmark_def.user_data = (void*)16u;
+    iree_benchmark_register(iree_make_cstring_view("dispatch_individual_16"),
+                            &benchmark_def);
+    benchmark_def.user_data = (void*)64u;
+    iree_benchmark_register(iree_make_cstring_view("dispatch_individual_64"),
+                            &benchmark_def);
+  }
+
   iree_benchmark_run_specified();
   return 0;
 }
@@ -285,6 +285,68 @@ TEST_F(ResourceSetTest, RedundantInsertion) {
   EXPECT_EQ(live_bitmap, 0u);
 }
 
+// Tests inserting a binding table that references the same resources many
+// times (and spans more than one internal batch). Each resource should only be
+// retained once by the set and the MRU should reflect the table order.
+TEST_F(ResourceSetTest, RedundantStridedInsertion) {
+  auto resource_set = make_resource_set(&block_pool);
+
+  iree_hal_resource_t* resources[6] = {NULL};
+  uint32_t live_bitmap = 0u;
+  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(resources); ++i) {
+    IREE_ASSERT_OK(iree_hal_test_resource_create(
+        i, &live_bitmap, host_allocator, &resources[i]));
+  }
+  EXPECT_EQ(live_bitmap, 0x3Fu);
+
+  // Bindings cycle through the resources with some NULL holes. The last
+  // binding references resource 1 such that the MRU ends up:
+  //   1 0 5 4 2 3
+  struct binding_t {
+    uint64_t offset;
+    iree_hal_resource_t* resource;
+  } bindings[50];
+  memset(&bindings, 0, sizeof(bindings));
+  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(bindings); ++i) {
+    bindings[i].offset = i;
+    bindings[i].resource =
+        i % 7 == 3 ? NULL : resources[i % IREE_ARRAYSIZE(resources)];
+  }
+  bindings[IREE_ARRAYSIZE(bindings) - 1].resource = resources[1];
+  IREE_ASSERT_OK(iree_hal_resource_set_insert_strided(
+      resource_set.get(), IREE_ARRAYSIZE(bindings), bindings,
+      offsetof(binding_t, resource), sizeof(binding_t)));
+
+  // Only one reference should have been added per unique resource.
+  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(resources); ++i) {
+    EXPECT_EQ(iree_atomic_ref_count_load(&resources[i]->ref_count), 2);
+  }
+  EXPECT_EQ(resource_set->mru[0], resources[1]);
+  EXPECT_EQ(resource_set->mru[1], resources[0]);
+  EXPECT_EQ(resource_set->mru[2], resources[5]);
+  EXPECT_EQ(resource_set->mru[3], resources[4]);
+  EXPECT_EQ(resource_set->mru[4], resources[2]);
+  EXPECT_EQ(resource_set->mru[5], resources[3]);
+
+  // Inserting the same table again should hit the MRU for every binding.
+  IREE_ASSERT_OK(iree_hal_resource_set_insert_strided(
+      resource_set.get(), IREE_ARRAYSIZE(bindings), bindings,
+      offsetof(binding_t, resource), sizeof(binding_t)));
+  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(resources); ++i) {
+    EXPECT_EQ(iree_atomic_ref_count_load(&resources[i]->ref_count), 2);
+  }
+
+  // Release all of the resources - they should still be owned by the set.
+  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(resources); ++i) {
+    iree_hal_resource_release(resources[i]);
+  }
+  EXPECT_EQ(live_bitmap, 0x3Fu);
+
+  // Ensure the set releases the resources.
+  resource_set.reset();
+  EXPECT_EQ(live_bitmap, 0u);
+}
+
 }  // namespace
 }  // namespace hal
 }  // namespace iree
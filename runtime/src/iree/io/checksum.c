@@ -0,0 +1,206 @@
+// Copyright 2025 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/io/checksum.h"
+
+//===----------------------------------------------------------------------===//
+// iree_io_checksum_t
+//===----------------------------------------------------------------------===//
+
+// Size of each window of the file mapped into memory while checksumming.
+// Bounds the address space consumed when checksumming large ranges.
+#define IREE_IO_CHECKSUM_MAPPING_WINDOW_SIZE (256 * 1024 * 1024)
+
+IREE_API_EXPORT iree_status_t iree_io_checksum_file_range(
+    iree_io_checksum_type_t type, iree_io_file_handle_t* file_handle,
+    uint64_t offset, uint64_t length, iree_allocator_t host_allocator,
+    iree_io_checksum_t* out_checksum) {
+  IREE_ASSERT_ARGUMENT(file_handle);
+  IREE_ASSERT_ARGUMENT(out_checksum);
+  *out_checksum = iree_io_checksum_none();
+  if (type == IREE_IO_CHECKSUM_TYPE_NONE) return iree_ok_status();
+  if (type != IREE_IO_CHECKSUM_TYPE_XXH64) {
+    return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                            "unsupported checksum type %u", (uint32_t)type);
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, length);
+
+  iree_io_xxh64_state_t state;
+  iree_io_xxh64_initialize(0, &state);
+  iree_status_t status = iree_ok_status();
+  uint64_t window_offset = 0;
+  while (iree_status_is_ok(status) && window_offset < length) {
+    const iree_host_size_t window_length = (iree_host_size_t)iree_min(
+        length - window_offset, IREE_IO_CHECKSUM_MAPPING_WINDOW_SIZE);
+    iree_io_file_mapping_t* mapping = NULL;
+    status = iree_io_file_map_view(
+        file_handle, IREE_IO_FILE_ACCESS_READ, offset + window_offset,
+        window_length, IREE_IO_FILE_MAPPING_FLAG_SEQUENTIAL_ACCESS,
+        host_allocator, &mapping);
+    if (iree_status_is_ok(status)) {
+      iree_io_xxh64_update(&state, iree_io_file_mapping_contents_ro(mapping));
+      iree_io_file_mapping_release(mapping);
+    }
+    window_offset += window_length;
+  }
+  if (iree_status_is_ok(status)) {
+    out_checksum->type = type;
+    out_checksum->value = iree_io_xxh64_finalize(&state);
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+//===----------------------------------------------------------------------===//
+// XXH64
+//===----------------------------------------------------------------------===//
+
+#define IREE_IO_XXH64_PRIME_1 0x9E3779B185EBCA87ull
+#define IREE_IO_XXH64_PRIME_2 0xC2B2AE3D27D4EB4Full
+#define IREE_IO_XXH64_PRIME_3 0x165667B19E3779F9ull
+#define IREE_IO_XXH64_PRIME_4 0x85EBCA77C2B2AE63ull
+#define IREE_IO_XXH64_PRIME_5 0x27D4EB2F165667C5ull
+
+static inline uint64_t iree_io_xxh64_rotl(uint64_t value, int amount) {
+  return (value << amount) | (value >> (64 - amount));
+}
+
+static inline uint64_t iree_io_xxh64_load_u64(const uint8_t* ptr) {
+  return iree_unaligned_load_le_u64((const uint64_t*)ptr);
+}
+
+static inline uint32_t iree_io_xxh64_load_u32(const uint8_t* ptr) {
+  return iree_unaligned_load_le_u32((const uint32_t*)ptr);
+}
+
+static inline uint64_t iree_io_xxh64_round(uint64_t accumulator,
+                                           uint64_t input) {
+  accumulator += input * IREE_IO_XXH64_PRIME_2;
+  accumulator = iree_io_xxh64_rotl(accumulator, 31);
+  return accumulator * IREE_IO_XXH64_PRIME_1;
+}
+
+static inline uint64_t iree_io_xxh64_merge_round(uint64_t accumulator,
+                                                 uint64_t value) {
+  accumulator ^= iree_io_xxh64_round(0, value);
+  return accumulator * IREE_IO_XXH64_PRIME_1 + IREE_IO_XXH64_PRIME_4;
+}
+
+// Consumes |stripe_count| 32-byte stripes from |data| into |accumulators|.
+static void iree_io_xxh64_consume_stripes(uint64_t* IREE_RESTRICT accumulators,
+                                          const uint8_t* IREE_RESTRICT data,
+                                          iree_host_size_t stripe_count) {
+  uint64_t v0 = accumulators[0];
+  uint64_t v1 = accumulators[1];
+  uint64_t v2 = accumulators[2];
+  uint64_t v3 = accumulators[3];
+  for (iree_host_size_t i = 0; i < stripe_count; ++i, data += 32) {
+    v0 = iree_io_xxh64_round(v0, iree_io_xxh64_load_u64(data + 0));
+    v1 = iree_io_xxh64_round(v1, iree_io_xxh64_load_u64(data + 8));
+    v2 = iree_io_xxh64_round(v2, iree_io_xxh64_load_u64(data + 16));
+    v3 = iree_io_xxh64_round(v3, iree_io_xxh64_load_u64(data + 24));
+  }
+  accumulators[0] = v0;
+  accumulators[1] = v1;
+  accumulators[2] = v2;
+  accumulators[3] = v3;
+}
+
+IREE_API_EXPORT void iree_io_xxh64_initialize(
+    uint64_t seed, iree_io_xxh64_state_t* out_state) {
+  IREE_ASSERT_ARGUMENT(out_state);
+  memset(out_state, 0, sizeof(*out_state));
+  out_state->seed = seed;
+  out_state->accumulators[0] =
+      seed + IREE_IO_XXH64_PRIME_1 + IREE_IO_XXH64_PRIME_2;
+  out_state->accumulators[1] = seed + IREE_IO_XXH64_PRIME_2;
+  out_state->accumulators[2] = seed;
+  out_state->accumulators[3] = seed - IREE_IO_XXH64_PRIME_1;
+}
+
+IREE_API_EXPORT void iree_io_xxh64_update(iree_io_xxh64_state_t* state,
+                                          iree_const_byte_span_t data) {
+  IREE_ASSERT_ARGUMENT(state);
+  const uint8_t* ptr = data.data;
+  iree_host_size_t remaining = data.data_length;
+  state->total_length += remaining;
+
+  // Top up a partially filled stripe from a prior update.
+  if (state->buffer_length > 0) {
+    const iree_host_size_t fill_length =
+        iree_min(remaining, sizeof(state->buffer) - state->buffer_length);
+    memcpy(state->buffer + state->buffer_length, ptr, fill_length);
+    state->buffer_length += (uint32_t)fill_length;
+    ptr += fill_length;
+    remaining -= fill_length;
+    if (state->buffer_length < sizeof(state->buffer)) return;
+    iree_io_xxh64_consume_stripes(state->accumulators, state->buffer, 1);
+    state->buffer_length = 0;
+  }
+
+  // Consume all whole stripes directly from the input.
+  const iree_host_size_t stripe_count = remaining / 32;
+  iree_io_xxh64_consume_stripes(state->accumulators, ptr, stripe_count);
+  ptr += stripe_count * 32;
+  remaining -= stripe_count * 32;
+
+  // Stash the tail for the next update or finalization.
+  if (remaining > 0) {
+    memcpy(state->buffer, ptr, remaining);
+    state->buffer_length = (uint32_t)remaining;
+  }
+}
+
+IREE_API_EXPORT uint64_t
+iree_io_xxh64_finalize(const iree_io_xxh64_state_t* state) {
+  IREE_ASSERT_ARGUMENT(state);
+  uint64_t hash = 0;
+  if (state->total_length >= 32) {
+    const uint64_t* v = state->accumulators;
+    hash = iree_io_xxh64_rotl(v[0], 1) + iree_io_xxh64_rotl(v[1], 7) +
+           iree_io_xxh64_rotl(v[2], 12) + iree_io_xxh64_rotl(v[3], 18);
+    for (int i = 0; i < 4; ++i) hash = iree_io_xxh64_merge_round(hash, v[i]);
+  } else {
+    hash = state->seed + IREE_IO_XXH64_PRIME_5;
+  }
+  hash += state->total_length;
+
+  const uint8_t* ptr = state->buffer;
+  const uint8_t* end = state->buffer + state->buffer_length;
+  for (; ptr + 8 <= end; ptr += 8) {
+    hash ^= iree_io_xxh64_round(0, iree_io_xxh64_load_u64(ptr));
+    hash = iree_io_xxh64_rotl(hash, 27) * IREE_IO_XXH64_PRIME_1 +
+           IREE_IO_XXH64_PRIME_4;
+  }
+  if (ptr + 4 <= end) {
+    hash ^= (uint64_t)iree_io_xxh64_load_u32(ptr) * IREE_IO_XXH64_PRIME_1;
+    hash = iree_io_xxh64_rotl(hash, 23) * IREE_IO_XXH64_PRIME_2 +
+           IREE_IO_XXH64_PRIME_3;
+    ptr += 4;
+  }
+  for (; ptr < end; ++ptr) {
+    hash ^= (*ptr) * IREE_IO_XXH64_PRIME_5;
+    hash = iree_io_xxh64_rotl(hash, 11) * IREE_IO_XXH64_PRIME_1;
+  }
+
+  // Avalanche.
+  hash ^= hash >> 33;
+  hash *= IREE_IO_XXH64_PRIME_2;
+  hash ^= hash >> 29;
+  hash *= IREE_IO_XXH64_PRIME_3;
+  hash ^= hash >> 32;
+  return hash;
+}
+
+IREE_API_EXPORT uint64_t iree_io_xxh64(iree_const_byte_span_t data,
+                                       uint64_t seed) {
+  iree_io_xxh64_state_t state;
+  iree_io_xxh64_initialize(seed, &state);
+  iree_io_xxh64_update(&state, data);
+  return iree_io_xxh64_finalize(&state);
+}
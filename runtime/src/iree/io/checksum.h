@@ -0,0 +1,93 @@
+// Copyright 2025 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_IO_CHECKSUM_H_
+#define IREE_IO_CHECKSUM_H_
+
+#include <stdint.h>
+
+#include "iree/base/api.h"
+#include "iree/io/file_handle.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+//===----------------------------------------------------------------------===//
+// iree_io_checksum_t
+//===----------------------------------------------------------------------===//
+
+// Identifies the algorithm used to produce a checksum.
+// Values are persisted in files and must not be changed.
+typedef enum iree_io_checksum_type_e {
+  // No checksum is present.
+  IREE_IO_CHECKSUM_TYPE_NONE = 0u,
+  // XXH64 (https://github.com/Cyan4973/xxHash) with a seed of 0.
+  IREE_IO_CHECKSUM_TYPE_XXH64 = 1u,
+} iree_io_checksum_type_t;
+
+// A checksum of some contents produced with a particular algorithm.
+typedef struct iree_io_checksum_t {
+  // Algorithm used to produce the value or IREE_IO_CHECKSUM_TYPE_NONE.
+  iree_io_checksum_type_t type;
+  // Checksum value as produced by the algorithm.
+  uint64_t value;
+} iree_io_checksum_t;
+
+// Returns an empty checksum that verifies against any contents.
+static inline iree_io_checksum_t iree_io_checksum_none(void) {
+  iree_io_checksum_t checksum = {IREE_IO_CHECKSUM_TYPE_NONE, 0};
+  return checksum;
+}
+
+// Returns true if |checksum| has a value.
+static inline bool iree_io_checksum_is_present(iree_io_checksum_t checksum) {
+  return checksum.type != IREE_IO_CHECKSUM_TYPE_NONE;
+}
+
+// Computes a checksum of type |type| over the |length| bytes of |file_handle|
+// starting at |offset| and returns it in |out_checksum|.
+// The file contents are mapped into memory in windows and read sequentially.
+IREE_API_EXPORT iree_status_t iree_io_checksum_file_range(
+    iree_io_checksum_type_t type, iree_io_file_handle_t* file_handle,
+    uint64_t offset, uint64_t length, iree_allocator_t host_allocator,
+    iree_io_checksum_t* out_checksum);
+
+//===----------------------------------------------------------------------===//
+// XXH64
+//===----------------------------------------------------------------------===//
+
+// Streaming XXH64 state.
+typedef struct iree_io_xxh64_state_t {
+  uint64_t total_length;
+  uint64_t seed;
+  uint64_t accumulators[4];
+  uint8_t buffer[32];
+  uint32_t buffer_length;
+} iree_io_xxh64_state_t;
+
+// Initializes |out_state| to hash a new stream with the given |seed|.
+IREE_API_EXPORT void iree_io_xxh64_initialize(uint64_t seed,
+                                              iree_io_xxh64_state_t* out_state);
+
+// Appends |data| to the stream hashed by |state|.
+IREE_API_EXPORT void iree_io_xxh64_update(iree_io_xxh64_state_t* state,
+                                          iree_const_byte_span_t data);
+
+// Returns the hash of all data appended to |state|. The state is not modified
+// and more data may be appended afterward.
+IREE_API_EXPORT uint64_t
+iree_io_xxh64_finalize(const iree_io_xxh64_state_t* state);
+
+// Returns the XXH64 hash of |data| with the given |seed|.
+IREE_API_EXPORT uint64_t iree_io_xxh64(iree_const_byte_span_t data,
+                                       uint64_t seed);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_IO_CHECKSUM_H_
@@ -0,0 +1,76 @@
+// Copyright 2025 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/io/checksum.h"
+
+#include <algorithm>
+#include <string_view>
+#include <vector>
+
+#include "iree/base/api.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace {
+
+static uint64_t HashString(std::string_view value) {
+  return iree_io_xxh64(iree_make_const_byte_span(value.data(), value.size()),
+                       /*seed=*/0);
+}
+
+TEST(ChecksumTest, XXH64ReferenceValues) {
+  EXPECT_EQ(HashString(""), 0xEF46DB3751D8E999ull);
+  EXPECT_EQ(HashString("a"), 0xD24EC4F1A98C6E5Bull);
+  EXPECT_EQ(HashString("abc"), 0x44BC2CF5AD770999ull);
+  EXPECT_EQ(HashString("Nobody inspects the spammish repetition"),
+            0xFBCEA83C8A378BF1ull);
+}
+
+TEST(ChecksumTest, XXH64Streaming) {
+  std::vector<uint8_t> data(1000);
+  for (size_t i = 0; i < data.size(); ++i) data[i] = (uint8_t)(i * 7);
+  const uint64_t expected = iree_io_xxh64(
+      iree_make_const_byte_span(data.data(), data.size()), /*seed=*/0);
+
+  // Feed the data in odd sizes to exercise partial stripe buffering.
+  iree_io_xxh64_state_t state;
+  iree_io_xxh64_initialize(/*seed=*/0, &state);
+  for (size_t i = 0, n = 1; i < data.size(); i += n, n = n % 13 + 1) {
+    n = std::min(n, data.size() - i);
+    iree_io_xxh64_update(&state,
+                         iree_make_const_byte_span(data.data() + i, n));
+  }
+  EXPECT_EQ(iree_io_xxh64_finalize(&state), expected);
+}
+
+TEST(ChecksumTest, FileRange) {
+  std::vector<uint8_t> data(4096);
+  for (size_t i = 0; i < data.size(); ++i) data[i] = (uint8_t)(i * 13);
+  iree_io_file_handle_t* file_handle = NULL;
+  IREE_ASSERT_OK(iree_io_file_handle_wrap_host_allocation(
+      IREE_IO_FILE_ACCESS_READ,
+      iree_make_byte_span(data.data(), data.size()),
+      iree_io_file_handle_release_callback_null(), iree_allocator_system(),
+      &file_handle));
+
+  iree_io_checksum_t checksum;
+  IREE_ASSERT_OK(iree_io_checksum_file_range(
+      IREE_IO_CHECKSUM_TYPE_XXH64, file_handle, /*offset=*/100,
+      /*length=*/1000, iree_allocator_system(), &checksum));
+  EXPECT_EQ(checksum.type, IREE_IO_CHECKSUM_TYPE_XXH64);
+  EXPECT_EQ(checksum.value,
+            iree_io_xxh64(iree_make_const_byte_span(data.data() + 100, 1000),
+                          /*seed=*/0));
+
+  IREE_ASSERT_OK(iree_io_checksum_file_range(
+      IREE_IO_CHECKSUM_TYPE_NONE, file_handle, /*offset=*/0,
+      /*length=*/data.size(), iree_allocator_system(), &checksum));
+  EXPECT_FALSE(iree_io_checksum_is_present(checksum));
+
+  iree_io_file_handle_release(file_handle);
+}
+
+}  // namespace
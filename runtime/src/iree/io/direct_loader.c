@@ -0,0 +1,692 @@
+// Copyright 2025 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+// O_DIRECT is only exposed by glibc with _GNU_SOURCE.
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE 1
+#endif  // _GNU_SOURCE
+
+#include "iree/io/direct_loader.h"
+
+#include <stdlib.h>
+
+#if IREE_FILE_IO_ENABLE && !defined(IREE_PLATFORM_WINDOWS)
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <unistd.h>
+#endif  // IREE_FILE_IO_ENABLE && !IREE_PLATFORM_WINDOWS
+
+// Gaps between requests smaller than this are read through instead of splitting
+// the read. Reading a few extra pages is cheaper than issuing another request.
+#define IREE_IO_DIRECT_LOADER_MAX_COALESCE_GAP (64 * 1024)
+
+//===----------------------------------------------------------------------===//
+// Platform support
+//===----------------------------------------------------------------------===//
+
+#if IREE_FILE_IO_ENABLE && !defined(IREE_PLATFORM_WINDOWS)
+
+// Acquires a descriptor for unbuffered reads from |fd|.
+// Returns |fd| itself if it was already opened with O_DIRECT. Otherwise tries
+// to reopen the underlying file with O_DIRECT and returns the new descriptor
+// with |out_owned| set; the caller must close it. If direct I/O is unavailable
+// (the platform lacks it, the file system does not support it, etc) then |fd|
+// is returned with |out_direct| unset and reads fall back to buffered I/O.
+static int iree_io_direct_loader_acquire_fd(int fd, bool* out_owned,
+                                            bool* out_direct) {
+  *out_owned = false;
+  *out_direct = false;
+#if defined(O_DIRECT)
+  int flags = fcntl(fd, F_GETFL);
+  if (flags != -1 && (flags & O_DIRECT)) {
+    *out_direct = true;
+    return fd;
+  }
+#if defined(IREE_PLATFORM_LINUX)
+  // Descriptors are opened independently of each other and reopening through
+  // procfs gives us a new open file description we can set O_DIRECT on without
+  // changing the behavior of the descriptor owned by the file handle.
+  char path[64];
+  snprintf(path, sizeof(path), "/proc/self/fd/%d", fd);
+  int direct_fd = open(path, O_RDONLY | O_DIRECT | O_CLOEXEC);
+  if (direct_fd != -1) {
+    *out_owned = true;
+    *out_direct = true;
+    return direct_fd;
+  }
+#endif  // IREE_PLATFORM_LINUX
+#endif  // O_DIRECT
+  return fd;
+}
+
+static void iree_io_direct_loader_release_fd(int fd, bool owned) {
+  if (owned) close(fd);
+}
+
+// Reads up to |length| bytes from |fd| at |offset| into |buffer|.
+// Returns the number of bytes read in |out_bytes_read|, which will only be
+// less than |length| if the end of the file was reached.
+static iree_status_t iree_io_direct_loader_pread(
+    int fd, uint8_t* buffer, iree_host_size_t length, uint64_t offset,
+    iree_host_size_t* out_bytes_read) {
+  iree_host_size_t total_read = 0;
+  while (total_read < length) {
+    ssize_t bytes_read = pread(fd, buffer + total_read,
+                               (size_t)(length - total_read),
+                               (off_t)(offset + total_read));
+    if (bytes_read > 0) {
+      total_read += (iree_host_size_t)bytes_read;
+    } else if (bytes_read == 0) {
+      break;  // EOF
+    } else if (errno != EINTR) {
+      return iree_make_status(iree_status_code_from_errno(errno),
+                              "failed to read %" PRIhsz
+                              " bytes at file offset %" PRIu64,
+                              length - total_read, offset + total_read);
+    }
+  }
+  *out_bytes_read = total_read;
+  return iree_ok_status();
+}
+
+#else
+
+static int iree_io_direct_loader_acquire_fd(int fd, bool* out_owned,
+                                            bool* out_direct) {
+  *out_owned = false;
+  *out_direct = false;
+  return fd;
+}
+
+static void iree_io_direct_loader_release_fd(int fd, bool owned) {}
+
+static iree_status_t iree_io_direct_loader_pread(
+    int fd, uint8_t* buffer, iree_host_size_t length, uint64_t offset,
+    iree_host_size_t* out_bytes_read) {
+  *out_bytes_read = 0;
+  return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                          "direct file reads not available on this platform");
+}
+
+#endif  // IREE_FILE_IO_ENABLE && !IREE_PLATFORM_WINDOWS
+
+//===----------------------------------------------------------------------===//
+// iree_io_direct_loader_statistics_t
+//===----------------------------------------------------------------------===//
+
+IREE_API_EXPORT void iree_io_direct_loader_statistics_accumulate(
+    const iree_io_direct_loader_statistics_t* statistics,
+    iree_io_direct_loader_statistics_t* total) {
+  IREE_ASSERT_ARGUMENT(statistics);
+  IREE_ASSERT_ARGUMENT(total);
+  total->request_count += statistics->request_count;
+  total->bytes_requested += statistics->bytes_requested;
+  total->bytes_read += statistics->bytes_read;
+  total->direct_file_count += statistics->direct_file_count;
+  total->read_duration_ns += statistics->read_duration_ns;
+  total->total_duration_ns += statistics->total_duration_ns;
+}
+
+IREE_API_EXPORT double iree_io_direct_loader_statistics_read_gbps(
+    const iree_io_direct_loader_statistics_t* statistics) {
+  IREE_ASSERT_ARGUMENT(statistics);
+  if (statistics->read_duration_ns <= 0) return 0.0;
+  // bytes/ns == GB/s.
+  return (double)statistics->bytes_read /
+         (double)statistics->read_duration_ns;
+}
+
+//===----------------------------------------------------------------------===//
+// iree_io_direct_loader_t
+//===----------------------------------------------------------------------===//
+
+typedef struct iree_io_direct_loader_request_t {
+  // Source file the range is read from.
+  iree_io_file_handle_t* source_file;  // retained
+  // File descriptor of |source_file| cached for sorting.
+  int source_fd;
+  // Offset in bytes into the source file.
+  uint64_t source_offset;
+  // Target buffer the range is copied into.
+  iree_hal_buffer_t* target_buffer;  // retained
+  // Offset in bytes into the target buffer.
+  iree_device_size_t target_offset;
+  // Length in bytes of the range.
+  iree_device_size_t length;
+} iree_io_direct_loader_request_t;
+
+struct iree_io_direct_loader_t {
+  iree_allocator_t host_allocator;
+  iree_hal_device_t* device;  // retained
+  iree_hal_queue_affinity_t queue_affinity;
+  iree_host_size_t staging_buffer_count;
+  iree_device_size_t staging_buffer_size;
+  // Requests recorded since the last flush.
+  iree_host_size_t request_capacity;
+  iree_host_size_t request_count;
+  iree_io_direct_loader_request_t* requests;
+};
+
+IREE_API_EXPORT iree_status_t iree_io_direct_loader_allocate(
+    iree_hal_device_t* device, iree_hal_queue_affinity_t queue_affinity,
+    iree_io_direct_loader_options_t options, iree_allocator_t host_allocator,
+    iree_io_direct_loader_t** out_loader) {
+  IREE_ASSERT_ARGUMENT(device);
+  IREE_ASSERT_ARGUMENT(out_loader);
+  *out_loader = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_io_direct_loader_t* loader = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0,
+      iree_allocator_malloc(host_allocator, sizeof(*loader), (void**)&loader));
+  loader->host_allocator = host_allocator;
+  loader->device = device;
+  iree_hal_device_retain(device);
+  loader->queue_affinity = queue_affinity;
+
+  // At least two staging buffers are required to overlap reads with copies.
+  iree_host_size_t staging_buffer_count =
+      options.staging_buffer_count
+          ? options.staging_buffer_count
+          : IREE_IO_DIRECT_LOADER_DEFAULT_STAGING_BUFFER_COUNT;
+  loader->staging_buffer_count =
+      iree_max(2, iree_min(staging_buffer_count,
+                           IREE_IO_DIRECT_LOADER_MAX_STAGING_BUFFER_COUNT));
+  loader->staging_buffer_size = iree_device_align(
+      options.staging_buffer_size
+          ? options.staging_buffer_size
+          : IREE_IO_DIRECT_LOADER_DEFAULT_STAGING_BUFFER_SIZE,
+      IREE_IO_DIRECT_LOADER_ALIGNMENT);
+
+  *out_loader = loader;
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
+// Releases all pending requests and resets the loader for reuse.
+static void iree_io_direct_loader_reset(iree_io_direct_loader_t* loader) {
+  for (iree_host_size_t i = 0; i < loader->request_count; ++i) {
+    iree_io_file_handle_release(loader->requests[i].source_file);
+    iree_hal_buffer_release(loader->requests[i].target_buffer);
+  }
+  loader->request_count = 0;
+}
+
+IREE_API_EXPORT void iree_io_direct_loader_free(
+    iree_io_direct_loader_t* loader) {
+  if (!loader) return;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_allocator_t host_allocator = loader->host_allocator;
+
+  iree_io_direct_loader_reset(loader);
+  iree_allocator_free(host_allocator, loader->requests);
+  iree_hal_device_release(loader->device);
+  iree_allocator_free(host_allocator, loader);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+IREE_API_EXPORT iree_host_size_t
+iree_io_direct_loader_pending_count(const iree_io_direct_loader_t* loader) {
+  IREE_ASSERT_ARGUMENT(loader);
+  return loader->request_count;
+}
+
+IREE_API_EXPORT iree_status_t iree_io_direct_loader_enqueue_read(
+    iree_io_direct_loader_t* loader, iree_io_file_handle_t* source_file,
+    uint64_t source_offset, iree_hal_buffer_t* target_buffer,
+    iree_device_size_t target_offset, iree_device_size_t length) {
+  IREE_ASSERT_ARGUMENT(loader);
+  IREE_ASSERT_ARGUMENT(source_file);
+  IREE_ASSERT_ARGUMENT(target_buffer);
+  if (length == 0) return iree_ok_status();
+
+  iree_io_file_handle_primitive_t primitive =
+      iree_io_file_handle_primitive(source_file);
+  if (primitive.type != IREE_IO_FILE_HANDLE_TYPE_FD) {
+    return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                            "direct loads are only supported from file "
+                            "descriptors; file handle type %d",
+                            (int)primitive.type);
+  }
+
+  if (loader->request_count == loader->request_capacity) {
+    iree_host_size_t new_capacity = iree_max(64, loader->request_capacity * 2);
+    IREE_RETURN_IF_ERROR(iree_allocator_realloc(
+        loader->host_allocator, new_capacity * sizeof(loader->requests[0]),
+        (void**)&loader->requests));
+    loader->request_capacity = new_capacity;
+  }
+
+  iree_io_direct_loader_request_t* request =
+      &loader->requests[loader->request_count++];
+  request->source_file = source_file;
+  iree_io_file_handle_retain(source_file);
+  request->source_fd = primitive.value.fd;
+  request->source_offset = source_offset;
+  request->target_buffer = target_buffer;
+  iree_hal_buffer_retain(target_buffer);
+  request->target_offset = target_offset;
+  request->length = length;
+  return iree_ok_status();
+}
+
+// Orders requests by file and then by offset within the file so that each file
+// is read front to back.
+static int iree_io_direct_loader_request_compare(const void* lhs_ptr,
+                                                 const void* rhs_ptr) {
+  const iree_io_direct_loader_request_t* lhs =
+      (const iree_io_direct_loader_request_t*)lhs_ptr;
+  const iree_io_direct_loader_request_t* rhs =
+      (const iree_io_direct_loader_request_t*)rhs_ptr;
+  if (lhs->source_fd != rhs->source_fd) {
+    return lhs->source_fd < rhs->source_fd ? -1 : 1;
+  }
+  if (lhs->source_offset != rhs->source_offset) {
+    return lhs->source_offset < rhs->source_offset ? -1 : 1;
+  }
+  return 0;
+}
+
+// A position within the sorted request list.
+typedef struct iree_io_direct_loader_cursor_t {
+  // Index of the current request.
+  iree_host_size_t request_index;
+  // Bytes of the current request covered by prior chunks.
+  iree_device_size_t request_consumed;
+} iree_io_direct_loader_cursor_t;
+
+// A single aligned read from one file into one staging buffer.
+// Covers the requests in [begin, end) with the first and last potentially only
+// partially covered when they span chunks.
+typedef struct iree_io_direct_loader_chunk_t {
+  // Aligned file range read into the staging buffer.
+  uint64_t file_begin;
+  uint64_t file_end;
+  // End of the last byte required by any request in the chunk. The read may
+  // stop short of |file_end| at the end of the file but must reach this.
+  uint64_t data_end;
+  // Number of request pieces copied out of the chunk.
+  iree_host_size_t piece_count;
+  iree_io_direct_loader_cursor_t begin;
+  iree_io_direct_loader_cursor_t end;
+} iree_io_direct_loader_chunk_t;
+
+static uint64_t iree_io_direct_loader_align_down(uint64_t value) {
+  return value & ~((uint64_t)IREE_IO_DIRECT_LOADER_ALIGNMENT - 1);
+}
+
+// Plans the next chunk starting at |begin|. Consecutive requests from the same
+// file are packed into the chunk until either the staging buffer is full or
+// the next request is too far away to be worth reading through.
+static void iree_io_direct_loader_plan_chunk(
+    const iree_io_direct_loader_t* loader, iree_io_direct_loader_cursor_t begin,
+    iree_io_direct_loader_chunk_t* out_chunk) {
+  const iree_io_direct_loader_request_t* first =
+      &loader->requests[begin.request_index];
+  const int fd = first->source_fd;
+  const uint64_t file_begin = iree_io_direct_loader_align_down(
+      first->source_offset + begin.request_consumed);
+  const uint64_t file_limit = file_begin + loader->staging_buffer_size;
+
+  out_chunk->file_begin = file_begin;
+  out_chunk->file_end = file_begin;
+  out_chunk->data_end = file_begin;
+  out_chunk->piece_count = 0;
+  out_chunk->begin = begin;
+
+  iree_io_direct_loader_cursor_t cursor = begin;
+  while (cursor.request_index < loader->request_count) {
+    const iree_io_direct_loader_request_t* request =
+        &loader->requests[cursor.request_index];
+    if (request->source_fd != fd) break;
+    const uint64_t piece_begin =
+        request->source_offset + cursor.request_consumed;
+    // Overlapping requests that start before a split request continuing into
+    // this chunk get their own chunk; this only rereads the overlap.
+    if (piece_begin < file_begin || piece_begin >= file_limit) break;
+    if (iree_io_direct_loader_align_down(piece_begin) >
+        out_chunk->file_end + IREE_IO_DIRECT_LOADER_MAX_COALESCE_GAP) {
+      break;
+    }
+    const uint64_t request_end = request->source_offset + request->length;
+    const uint64_t piece_end = iree_min(request_end, file_limit);
+    out_chunk->data_end = iree_max(out_chunk->data_end, piece_end);
+    out_chunk->file_end =
+        iree_max(out_chunk->file_end,
+                 iree_device_align(piece_end, IREE_IO_DIRECT_LOADER_ALIGNMENT));
+    ++out_chunk->piece_count;
+    if (piece_end < request_end) {
+      // Staging buffer is full; the remainder goes in the next chunk.
+      cursor.request_consumed = piece_end - request->source_offset;
+      break;
+    }
+    ++cursor.request_index;
+    cursor.request_consumed = 0;
+  }
+  out_chunk->end = cursor;
+}
+
+// Per staging buffer state.
+typedef struct iree_io_direct_loader_slot_t {
+  // Signaled when the copies out of the staging buffer have completed.
+  iree_hal_semaphore_t* semaphore;
+  // Last value the semaphore will be signaled to; 0 if the slot is unused.
+  uint64_t value;
+} iree_io_direct_loader_slot_t;
+
+// Enqueues the copies of all request pieces in |chunk| out of the staging
+// buffer at |staging_offset| and signals |slot| when they complete.
+static iree_status_t iree_io_direct_loader_enqueue_chunk_copies(
+    iree_io_direct_loader_t* loader,
+    const iree_io_direct_loader_chunk_t* chunk,
+    iree_hal_buffer_t* staging_buffer, iree_device_size_t staging_offset,
+    iree_io_direct_loader_slot_t* slot) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, chunk->piece_count);
+
+  uint64_t signal_value = slot->value + 1;
+  iree_hal_semaphore_list_t signal_semaphore_list = {
+      .count = 1,
+      .semaphores = &slot->semaphore,
+      .payload_values = &signal_value,
+  };
+
+  // Large parameters usually fill an entire chunk and can use a single queue
+  // copy while many small parameters are batched into a command buffer.
+  iree_hal_command_buffer_t* command_buffer = NULL;
+  if (chunk->piece_count > 1) {
+    IREE_RETURN_AND_END_ZONE_IF_ERROR(
+        z0, iree_hal_command_buffer_create(
+                loader->device, IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT,
+                IREE_HAL_COMMAND_CATEGORY_TRANSFER, loader->queue_affinity, 0,
+                &command_buffer));
+  }
+  iree_status_t status = iree_ok_status();
+  if (command_buffer) {
+    status = iree_hal_command_buffer_begin(command_buffer);
+  }
+
+  for (iree_host_size_t i = chunk->begin.request_index;
+       iree_status_is_ok(status) && i <= chunk->end.request_index &&
+       i < loader->request_count;
+       ++i) {
+    const iree_io_direct_loader_request_t* request = &loader->requests[i];
+    const iree_device_size_t piece_begin =
+        i == chunk->begin.request_index ? chunk->begin.request_consumed : 0;
+    const iree_device_size_t piece_end = i == chunk->end.request_index
+                                             ? chunk->end.request_consumed
+                                             : request->length;
+    if (piece_end <= piece_begin) continue;
+    const iree_device_size_t source_offset =
+        staging_offset +
+        (request->source_offset + piece_begin - chunk->file_begin);
+    const iree_device_size_t target_offset =
+        request->target_offset + piece_begin;
+    const iree_device_size_t length = piece_end - piece_begin;
+    if (command_buffer) {
+      // Targets of a load never overlap and don't require barriers.
+      status = iree_hal_command_buffer_copy_buffer(
+          command_buffer,
+          iree_hal_make_buffer_ref(staging_buffer, source_offset, length),
+          iree_hal_make_buffer_ref(request->target_buffer, target_offset,
+                                   length),
+          IREE_HAL_COPY_FLAG_NONE);
+    } else {
+      status = iree_hal_device_queue_copy(
+          loader->device, loader->queue_affinity,
+          iree_hal_semaphore_list_empty(), signal_semaphore_list,
+          staging_buffer, source_offset, request->target_buffer, target_offset,
+          length, IREE_HAL_COPY_FLAG_NONE);
+    }
+  }
+
+  if (iree_status_is_ok(status) && command_buffer) {
+    status = iree_hal_command_buffer_end(command_buffer);
+    if (iree_status_is_ok(status)) {
+      status = iree_hal_device_queue_execute(
+          loader->device, loader->queue_affinity,
+          iree_hal_semaphore_list_empty(), signal_semaphore_list,
+          command_buffer, iree_hal_buffer_binding_table_empty(),
+          IREE_HAL_EXECUTE_FLAG_NONE);
+    }
+  }
+  iree_hal_command_buffer_release(command_buffer);
+
+  if (iree_status_is_ok(status)) {
+    slot->value = signal_value;
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+// Performs all reads using the given staging |mapping| and |slots|.
+static iree_status_t iree_io_direct_loader_stream(
+    iree_io_direct_loader_t* loader, iree_hal_buffer_t* staging_buffer,
+    iree_hal_buffer_mapping_t* mapping, iree_device_size_t staging_base_offset,
+    iree_io_direct_loader_slot_t* slots,
+    iree_io_direct_loader_statistics_t* statistics) {
+  const bool is_coherent =
+      iree_all_bits_set(iree_hal_buffer_memory_type(staging_buffer),
+                        IREE_HAL_MEMORY_TYPE_HOST_COHERENT);
+
+  int fd = -1;
+  bool fd_owned = false;
+  bool fd_direct = false;
+  int source_fd = -1;
+  iree_host_size_t slot_index = 0;
+  iree_io_direct_loader_cursor_t cursor = {0, 0};
+  iree_status_t status = iree_ok_status();
+  while (iree_status_is_ok(status) &&
+         cursor.request_index < loader->request_count) {
+    iree_io_direct_loader_chunk_t chunk;
+    iree_io_direct_loader_plan_chunk(loader, cursor, &chunk);
+    cursor = chunk.end;
+
+    // Switch files when crossing into the requests of the next file.
+    const int chunk_fd = loader->requests[chunk.begin.request_index].source_fd;
+    if (chunk_fd != source_fd) {
+      if (fd != -1) iree_io_direct_loader_release_fd(fd, fd_owned);
+      source_fd = chunk_fd;
+      fd = iree_io_direct_loader_acquire_fd(source_fd, &fd_owned, &fd_direct);
+      if (fd_direct) ++statistics->direct_file_count;
+    }
+
+    // Wait for the copies out of the staging buffer to complete before
+    // overwriting it. With enough staging buffers in the rotation this only
+    // blocks when the device is slower than storage. The copies were enqueued
+    // without waits so this never depends on work outside of the loader.
+    iree_io_direct_loader_slot_t* slot = &slots[slot_index];
+    const iree_device_size_t staging_offset =
+        staging_base_offset + slot_index * loader->staging_buffer_size;
+    slot_index = (slot_index + 1) % loader->staging_buffer_count;
+    if (slot->value > 0) {
+      IREE_TRACE_ZONE_BEGIN_NAMED(z_wait, "iree_io_direct_loader_wait_slot");
+      status = iree_hal_semaphore_wait(slot->semaphore, slot->value,
+                                       iree_infinite_timeout());
+      IREE_TRACE_ZONE_END(z_wait);
+      if (!iree_status_is_ok(status)) break;
+    }
+
+    // Read the entire chunk in one request.
+    IREE_TRACE_ZONE_BEGIN_NAMED(z_read, "iree_io_direct_loader_read");
+    IREE_TRACE_ZONE_APPEND_VALUE_I64(z_read, chunk.file_end - chunk.file_begin);
+    const iree_host_size_t read_length =
+        (iree_host_size_t)(chunk.file_end - chunk.file_begin);
+    iree_host_size_t bytes_read = 0;
+    iree_time_t read_start_ns = iree_time_now();
+    status = iree_io_direct_loader_pread(
+        fd, mapping->contents.data + staging_offset, read_length,
+        chunk.file_begin, &bytes_read);
+    statistics->read_duration_ns += iree_time_now() - read_start_ns;
+    statistics->bytes_read += bytes_read;
+    IREE_TRACE_ZONE_END(z_read);
+    if (iree_status_is_ok(status) &&
+        chunk.file_begin + bytes_read < chunk.data_end) {
+      status = iree_make_status(
+          IREE_STATUS_OUT_OF_RANGE,
+          "end of file hit during read; requested range [%" PRIu64 ", %" PRIu64
+          ") but file ends at %" PRIu64,
+          chunk.file_begin, chunk.data_end, chunk.file_begin + bytes_read);
+    }
+    if (iree_status_is_ok(status) && !is_coherent) {
+      status = iree_hal_buffer_mapping_flush_range(mapping, staging_offset,
+                                                   read_length);
+    }
+
+    // Copy out to the targets while we move on to the next chunk.
+    if (iree_status_is_ok(status)) {
+      status = iree_io_direct_loader_enqueue_chunk_copies(
+          loader, &chunk, staging_buffer, staging_offset, slot);
+    }
+  }
+  if (fd != -1) iree_io_direct_loader_release_fd(fd, fd_owned);
+  return status;
+}
+
+IREE_API_EXPORT iree_status_t iree_io_direct_loader_flush(
+    iree_io_direct_loader_t* loader,
+    const iree_hal_semaphore_list_t wait_semaphore_list,
+    const iree_hal_semaphore_list_t signal_semaphore_list,
+    iree_io_direct_loader_statistics_t* out_statistics) {
+  IREE_ASSERT_ARGUMENT(loader);
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, loader->request_count);
+  iree_time_t start_ns = iree_time_now();
+
+  iree_io_direct_loader_statistics_t statistics;
+  memset(&statistics, 0, sizeof(statistics));
+  if (out_statistics) memset(out_statistics, 0, sizeof(*out_statistics));
+
+  // Nothing to read; just link the wait->signal semaphore lists.
+  if (loader->request_count == 0) {
+    iree_status_t status = iree_hal_device_queue_barrier(
+        loader->device, loader->queue_affinity, wait_semaphore_list,
+        signal_semaphore_list, IREE_HAL_EXECUTE_FLAG_NONE);
+    IREE_TRACE_ZONE_END(z0);
+    return status;
+  }
+
+  statistics.request_count = loader->request_count;
+  for (iree_host_size_t i = 0; i < loader->request_count; ++i) {
+    statistics.bytes_requested += loader->requests[i].length;
+  }
+
+  // Order all reads by their position in storage.
+  qsort(loader->requests, loader->request_count, sizeof(loader->requests[0]),
+        iree_io_direct_loader_request_compare);
+
+  // Reads are performed by this thread and the target buffers must be ready
+  // (allocations completed, prior users retired) before we copy into them.
+  // Timelines that have not been reached may only be advanced by the caller
+  // after the flush returns and blocking on them would deadlock.
+  iree_status_t status = iree_hal_semaphore_list_wait(wait_semaphore_list,
+                                                      iree_immediate_timeout());
+  if (iree_status_is_deadline_exceeded(status)) {
+    iree_status_ignore(status);
+    status = iree_make_status(
+        IREE_STATUS_FAILED_PRECONDITION,
+        "direct loader flushes are performed synchronously and require all "
+        "wait semaphores to have been reached");
+  }
+
+  // Allocate the staging buffers as one host-local buffer. The allocation is
+  // padded so that we can align the mapping ourselves if the device allocator
+  // does not honor the minimum alignment for host pointers.
+  iree_hal_buffer_t* staging_buffer = NULL;
+  if (iree_status_is_ok(status)) {
+    iree_hal_buffer_params_t staging_buffer_params = {
+        .access = IREE_HAL_MEMORY_ACCESS_ALL,
+        .min_alignment = IREE_IO_DIRECT_LOADER_ALIGNMENT,
+        .queue_affinity = loader->queue_affinity,
+        .type = IREE_HAL_MEMORY_TYPE_OPTIMAL_FOR_HOST |
+                IREE_HAL_MEMORY_TYPE_DEVICE_VISIBLE,
+        .usage = IREE_HAL_BUFFER_USAGE_TRANSFER |
+                 IREE_HAL_BUFFER_USAGE_MAPPING_PERSISTENT |
+                 IREE_HAL_BUFFER_USAGE_MAPPING_ACCESS_SEQUENTIAL_WRITE,
+    };
+    status = iree_hal_allocator_allocate_buffer(
+        iree_hal_device_allocator(loader->device), staging_buffer_params,
+        loader->staging_buffer_count * loader->staging_buffer_size +
+            IREE_IO_DIRECT_LOADER_ALIGNMENT,
+        &staging_buffer);
+  }
+  iree_hal_buffer_mapping_t mapping;
+  memset(&mapping, 0, sizeof(mapping));
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_buffer_map_range(
+        staging_buffer, IREE_HAL_MAPPING_MODE_PERSISTENT,
+        IREE_HAL_MEMORY_ACCESS_WRITE | IREE_HAL_MEMORY_ACCESS_DISCARD, 0,
+        IREE_HAL_WHOLE_BUFFER, &mapping);
+  }
+
+  iree_io_direct_loader_slot_t* slots =
+      (iree_io_direct_loader_slot_t*)iree_alloca(
+          loader->staging_buffer_count * sizeof(*slots));
+  memset(slots, 0, loader->staging_buffer_count * sizeof(*slots));
+  for (iree_host_size_t i = 0;
+       i < loader->staging_buffer_count && iree_status_is_ok(status); ++i) {
+    status = iree_hal_semaphore_create(loader->device, 0ull,
+                                       IREE_HAL_SEMAPHORE_FLAG_NONE,
+                                       &slots[i].semaphore);
+  }
+
+  if (iree_status_is_ok(status)) {
+    const uintptr_t misalignment = (uintptr_t)mapping.contents.data &
+                                   (IREE_IO_DIRECT_LOADER_ALIGNMENT - 1);
+    const iree_device_size_t staging_base_offset =
+        misalignment ? IREE_IO_DIRECT_LOADER_ALIGNMENT - misalignment : 0;
+    status = iree_io_direct_loader_stream(loader, staging_buffer, &mapping,
+                                          staging_base_offset, slots,
+                                          &statistics);
+  }
+
+  // Join all staging buffer timelines into the user signal. Only slots that
+  // were used participate.
+  if (iree_status_is_ok(status)) {
+    iree_hal_semaphore_list_t join_semaphore_list = {
+        .count = 0,
+        .semaphores = (iree_hal_semaphore_t**)iree_alloca(
+            loader->staging_buffer_count * sizeof(iree_hal_semaphore_t*)),
+        .payload_values = (uint64_t*)iree_alloca(loader->staging_buffer_count *
+                                                 sizeof(uint64_t)),
+    };
+    for (iree_host_size_t i = 0; i < loader->staging_buffer_count; ++i) {
+      if (slots[i].value == 0) continue;
+      join_semaphore_list.semaphores[join_semaphore_list.count] =
+          slots[i].semaphore;
+      join_semaphore_list.payload_values[join_semaphore_list.count] =
+          slots[i].value;
+      ++join_semaphore_list.count;
+    }
+    status = iree_hal_device_queue_barrier(
+        loader->device, loader->queue_affinity, join_semaphore_list,
+        signal_semaphore_list, IREE_HAL_EXECUTE_FLAG_NONE);
+  }
+
+  // Resources are safe to release even if there are pending device operations
+  // as the device guarantees the resources remain live.
+  for (iree_host_size_t i = 0; i < loader->staging_buffer_count; ++i) {
+    iree_hal_semaphore_release(slots[i].semaphore);
+  }
+  if (mapping.contents.data) {
+    status = iree_status_join(status, iree_hal_buffer_unmap_range(&mapping));
+  }
+  iree_hal_buffer_release(staging_buffer);
+  iree_io_direct_loader_reset(loader);
+
+  statistics.total_duration_ns = iree_time_now() - start_ns;
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, statistics.bytes_read);
+  IREE_TRACE_PLOT_VALUE_F64("iree_io_direct_loader_read_gbps",
+                            iree_io_direct_loader_statistics_read_gbps(
+                                &statistics));
+  if (out_statistics) *out_statistics = statistics;
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
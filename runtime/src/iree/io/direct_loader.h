@@ -0,0 +1,141 @@
+// Copyright 2025 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_IO_DIRECT_LOADER_H_
+#define IREE_IO_DIRECT_LOADER_H_
+
+#include <stdint.h>
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/io/file_handle.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+//===----------------------------------------------------------------------===//
+// iree_io_direct_loader_t
+//===----------------------------------------------------------------------===//
+
+// Alignment of file offsets, read lengths, and staging memory used for all
+// direct reads. 4096 covers the logical block size of all common devices.
+#define IREE_IO_DIRECT_LOADER_ALIGNMENT 4096
+
+// Default number of staging buffers rotated between disk reads and device
+// copies. Two is the minimum required to overlap the two.
+#define IREE_IO_DIRECT_LOADER_DEFAULT_STAGING_BUFFER_COUNT 4
+
+// Maximum number of staging buffers in the rotation.
+#define IREE_IO_DIRECT_LOADER_MAX_STAGING_BUFFER_COUNT 32
+
+// Default size in bytes of each staging buffer.
+#define IREE_IO_DIRECT_LOADER_DEFAULT_STAGING_BUFFER_SIZE (8 * 1024 * 1024)
+
+// Options controlling direct loader staging.
+typedef struct iree_io_direct_loader_options_t {
+  // Number of staging buffers in the rotation or 0 for the default. Clamped
+  // to [2, IREE_IO_DIRECT_LOADER_MAX_STAGING_BUFFER_COUNT].
+  iree_host_size_t staging_buffer_count;
+  // Size in bytes of each staging buffer or 0 for the default. Rounded up to
+  // IREE_IO_DIRECT_LOADER_ALIGNMENT.
+  iree_device_size_t staging_buffer_size;
+} iree_io_direct_loader_options_t;
+
+// Statistics of a direct loader flush.
+typedef struct iree_io_direct_loader_statistics_t {
+  // Total number of read requests serviced.
+  uint64_t request_count;
+  // Total bytes requested by all reads.
+  uint64_t bytes_requested;
+  // Total bytes read from storage including alignment padding and small gaps
+  // between requests that were coalesced into a single read.
+  uint64_t bytes_read;
+  // Number of files that were read using unbuffered direct I/O.
+  // Files that could not be reopened for direct I/O fall back to buffered
+  // reads and are not counted.
+  uint64_t direct_file_count;
+  // Total time spent blocked on storage reads.
+  iree_duration_t read_duration_ns;
+  // Total time from the start of the flush until all copies were enqueued.
+  iree_duration_t total_duration_ns;
+} iree_io_direct_loader_statistics_t;
+
+// Accumulates |statistics| into |total|.
+IREE_API_EXPORT void iree_io_direct_loader_statistics_accumulate(
+    const iree_io_direct_loader_statistics_t* statistics,
+    iree_io_direct_loader_statistics_t* total);
+
+// Returns the achieved storage read throughput in GB/s (10^9 bytes/second) or
+// 0 if nothing was read.
+IREE_API_EXPORT double iree_io_direct_loader_statistics_read_gbps(
+    const iree_io_direct_loader_statistics_t* statistics);
+
+// Streams file ranges into device buffers through a rotating set of aligned,
+// host-visible staging buffers.
+//
+// Reads are recorded with iree_io_direct_loader_enqueue_read and performed in
+// file offset order across all recorded requests when the loader is flushed so
+// that storage sees large sequential reads regardless of the order parameters
+// were requested in. Where supported files are read with unbuffered direct I/O
+// (O_DIRECT) to bypass the page cache: cold loads of large models are then
+// bound by disk bandwidth instead of the copies through the page cache and the
+// memory pressure of caching data that will only ever be read once.
+//
+// Each staging buffer is filled by a synchronous host read and then copied to
+// the target buffers with queue operations. While the device performs the
+// copies out of one staging buffer the host reads into the next and only
+// blocks when a staging buffer is reused before its copies have completed.
+//
+// Thread-compatible: a loader must only be used by one thread at a time.
+typedef struct iree_io_direct_loader_t iree_io_direct_loader_t;
+
+// Allocates a direct loader that uploads to |device| on |queue_affinity|.
+IREE_API_EXPORT iree_status_t iree_io_direct_loader_allocate(
+    iree_hal_device_t* device, iree_hal_queue_affinity_t queue_affinity,
+    iree_io_direct_loader_options_t options, iree_allocator_t host_allocator,
+    iree_io_direct_loader_t** out_loader);
+
+// Frees |loader| and releases any requests that were not flushed.
+IREE_API_EXPORT void iree_io_direct_loader_free(
+    iree_io_direct_loader_t* loader);
+
+// Returns the number of reads recorded since the last flush.
+IREE_API_EXPORT iree_host_size_t
+iree_io_direct_loader_pending_count(const iree_io_direct_loader_t* loader);
+
+// Records a read of |length| bytes from |source_file| at |source_offset| into
+// |target_buffer| at |target_offset|. Only file handles of type
+// IREE_IO_FILE_HANDLE_TYPE_FD are supported. Both |source_file| and
+// |target_buffer| are retained until the loader is flushed.
+IREE_API_EXPORT iree_status_t iree_io_direct_loader_enqueue_read(
+    iree_io_direct_loader_t* loader, iree_io_file_handle_t* source_file,
+    uint64_t source_offset, iree_hal_buffer_t* target_buffer,
+    iree_device_size_t target_offset, iree_device_size_t length);
+
+// Performs all recorded reads and signals |signal_semaphore_list| once the
+// target buffers have been populated.
+//
+// The storage reads are performed synchronously by the calling thread; only
+// the device copies out of the staging buffers and the final signal are
+// asynchronous. |wait_semaphore_list| must have already been reached as the
+// flush cannot be deferred: fails with IREE_STATUS_FAILED_PRECONDITION instead
+// of blocking on timelines that may only be advanced after the flush returns.
+// Statistics of the flush are returned in |out_statistics| if provided.
+//
+// The loader is reset and may be reused after the flush regardless of whether
+// it succeeds.
+IREE_API_EXPORT iree_status_t iree_io_direct_loader_flush(
+    iree_io_direct_loader_t* loader,
+    const iree_hal_semaphore_list_t wait_semaphore_list,
+    const iree_hal_semaphore_list_t signal_semaphore_list,
+    iree_io_direct_loader_statistics_t* out_statistics);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_IO_DIRECT_LOADER_H_
@@ -0,0 +1,365 @@
+// Copyright 2025 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/io/direct_loader.h"
+
+#include "iree/base/api.h"
+
+#if IREE_FILE_IO_ENABLE && !defined(IREE_PLATFORM_WINDOWS)
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "iree/hal/api.h"
+#include "iree/hal/drivers/local_sync/sync_device.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace iree {
+namespace io {
+namespace {
+
+using ::iree::testing::status::StatusIs;
+
+constexpr uint64_t kAlignment = IREE_IO_DIRECT_LOADER_ALIGNMENT;
+
+// Must match IREE_IO_DIRECT_LOADER_MAX_COALESCE_GAP in direct_loader.c.
+constexpr uint64_t kMaxCoalesceGap = 64 * 1024;
+
+// Offset into each target buffer that reads are written at so that writes
+// before the target range are detected.
+constexpr iree_device_size_t kTargetPadding = 16;
+
+class DirectLoaderTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    iree_allocator_t host_allocator = iree_allocator_system();
+    IREE_ASSERT_OK(iree_hal_allocator_create_heap(
+        IREE_SV("heap"), host_allocator, host_allocator, &device_allocator_));
+    iree_hal_sync_device_params_t params;
+    iree_hal_sync_device_params_initialize(&params);
+    IREE_ASSERT_OK(iree_hal_sync_device_create(
+        IREE_SV("sync"), &params, /*loader_count=*/0, /*loaders=*/NULL,
+        device_allocator_, host_allocator, &device_));
+    IREE_ASSERT_OK(iree_hal_semaphore_create(
+        device_, 0ull, IREE_HAL_SEMAPHORE_FLAG_NONE, &semaphore_));
+  }
+
+  void TearDown() override {
+    ResetTargets();
+    iree_io_file_handle_release(file_handle_);
+    iree_hal_semaphore_release(semaphore_);
+    iree_hal_device_release(device_);
+    iree_hal_allocator_release(device_allocator_);
+    if (!path_.empty()) std::remove(path_.c_str());
+  }
+
+  // Creates a temporary file of |size| bytes with position-dependent contents
+  // and opens it as the source file.
+  void CreateFile(const char* name, uint64_t size) {
+    path_ = ::testing::TempDir() + "/iree_direct_loader_" + name + ".bin";
+    contents_.resize(size);
+    for (uint64_t i = 0; i < size; ++i) {
+      contents_[i] = static_cast<uint8_t>((i * 2654435761u) >> 13);
+    }
+    {
+      std::ofstream file(path_, std::ios::binary | std::ios::trunc);
+      file.write(reinterpret_cast<const char*>(contents_.data()),
+                 contents_.size());
+      ASSERT_TRUE(file.good());
+    }
+    OpenFile(path_.c_str());
+  }
+
+  // Opens an existing file at |path| whose contents are read with buffered
+  // I/O for verification.
+  void OpenFile(const char* path) {
+    if (contents_.empty()) {
+      std::ifstream file(path, std::ios::binary);
+      contents_.assign(std::istreambuf_iterator<char>(file),
+                       std::istreambuf_iterator<char>());
+    }
+    IREE_ASSERT_OK(iree_io_file_handle_open(
+        IREE_IO_FILE_MODE_READ, iree_make_cstring_view(path),
+        iree_allocator_system(), &file_handle_));
+  }
+
+  iree_io_direct_loader_t* AllocateLoader(iree_host_size_t staging_count,
+                                          iree_device_size_t staging_size) {
+    iree_io_direct_loader_options_t options = {};
+    options.staging_buffer_count = staging_count;
+    options.staging_buffer_size = staging_size;
+    iree_io_direct_loader_t* loader = NULL;
+    IREE_CHECK_OK(iree_io_direct_loader_allocate(
+        device_, IREE_HAL_QUEUE_AFFINITY_ANY, options, iree_allocator_system(),
+        &loader));
+    return loader;
+  }
+
+  // Enqueues a read of [offset, offset + length) of the source file into a
+  // new target buffer and returns the index of the request.
+  size_t EnqueueRead(iree_io_direct_loader_t* loader, uint64_t offset,
+                     iree_device_size_t length) {
+    iree_hal_buffer_params_t params = {};
+    params.type =
+        IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL | IREE_HAL_MEMORY_TYPE_HOST_VISIBLE;
+    params.usage =
+        IREE_HAL_BUFFER_USAGE_DEFAULT | IREE_HAL_BUFFER_USAGE_MAPPING;
+    params.access = IREE_HAL_MEMORY_ACCESS_ALL;
+    iree_hal_buffer_t* buffer = NULL;
+    IREE_CHECK_OK(iree_hal_allocator_allocate_buffer(
+        device_allocator_, params, kTargetPadding + length, &buffer));
+    IREE_CHECK_OK(
+        iree_hal_buffer_map_zero(buffer, 0, kTargetPadding + length));
+    IREE_CHECK_OK(iree_io_direct_loader_enqueue_read(
+        loader, file_handle_, offset, buffer, kTargetPadding, length));
+    buffers_.push_back(buffer);
+    ranges_.push_back({offset, length});
+    return buffers_.size() - 1;
+  }
+
+  // Releases all target buffers from prior reads.
+  void ResetTargets() {
+    for (auto* buffer : buffers_) iree_hal_buffer_release(buffer);
+    buffers_.clear();
+    ranges_.clear();
+  }
+
+  // Flushes |loader| and waits for the target buffers to be populated.
+  iree_status_t Flush(iree_io_direct_loader_t* loader,
+                      iree_io_direct_loader_statistics_t* out_statistics) {
+    uint64_t signal_value = ++semaphore_value_;
+    iree_hal_semaphore_list_t signal_semaphore_list = {
+        /*count=*/1,
+        /*semaphores=*/&semaphore_,
+        /*payload_values=*/&signal_value,
+    };
+    IREE_RETURN_IF_ERROR(iree_io_direct_loader_flush(
+        loader, iree_hal_semaphore_list_empty(), signal_semaphore_list,
+        out_statistics));
+    return iree_hal_semaphore_wait(semaphore_, signal_value,
+                                   iree_infinite_timeout());
+  }
+
+  // Verifies that each target buffer contains its file range and nothing was
+  // written outside of it.
+  void ExpectTargetContents() {
+    for (size_t i = 0; i < buffers_.size(); ++i) {
+      const uint64_t offset = ranges_[i].first;
+      const iree_device_size_t length = ranges_[i].second;
+      std::vector<uint8_t> data(kTargetPadding + length);
+      IREE_ASSERT_OK(
+          iree_hal_buffer_map_read(buffers_[i], 0, data.data(), data.size()));
+      for (iree_device_size_t j = 0; j < kTargetPadding; ++j) {
+        ASSERT_EQ(data[j], 0) << "request " << i << " wrote before its target";
+      }
+      ASSERT_TRUE(std::equal(data.begin() + kTargetPadding, data.end(),
+                             contents_.begin() + offset))
+          << "request " << i << " at file offset " << offset << " length "
+          << length << " has incorrect contents";
+    }
+  }
+
+  iree_hal_allocator_t* device_allocator_ = NULL;
+  iree_hal_device_t* device_ = NULL;
+  iree_hal_semaphore_t* semaphore_ = NULL;
+  uint64_t semaphore_value_ = 0;
+  std::string path_;
+  std::vector<uint8_t> contents_;
+  iree_io_file_handle_t* file_handle_ = NULL;
+  std::vector<iree_hal_buffer_t*> buffers_;
+  std::vector<std::pair<uint64_t, iree_device_size_t>> ranges_;
+};
+
+// Empty flushes only link the wait and signal semaphores.
+TEST_F(DirectLoaderTest, EmptyFlush) {
+  CreateFile("empty_flush", kAlignment);
+  iree_io_direct_loader_t* loader = AllocateLoader(2, kAlignment);
+  iree_io_direct_loader_statistics_t statistics;
+  IREE_ASSERT_OK(Flush(loader, &statistics));
+  EXPECT_EQ(statistics.request_count, 0);
+  EXPECT_EQ(statistics.bytes_read, 0);
+  iree_io_direct_loader_free(loader);
+}
+
+// Flushes with wait semaphores that have not been reached fail instead of
+// blocking the calling thread and leave the loader reset for reuse.
+TEST_F(DirectLoaderTest, RejectsPendingWait) {
+  CreateFile("pending_wait", kAlignment);
+  iree_io_direct_loader_t* loader = AllocateLoader(2, kAlignment);
+  EnqueueRead(loader, 0, kAlignment);
+
+  iree_hal_semaphore_t* wait_semaphore = NULL;
+  IREE_ASSERT_OK(iree_hal_semaphore_create(
+      device_, 0ull, IREE_HAL_SEMAPHORE_FLAG_NONE, &wait_semaphore));
+  uint64_t wait_value = 1;
+  iree_hal_semaphore_list_t wait_semaphore_list = {
+      /*count=*/1,
+      /*semaphores=*/&wait_semaphore,
+      /*payload_values=*/&wait_value,
+  };
+  uint64_t signal_value = ++semaphore_value_;
+  iree_hal_semaphore_list_t signal_semaphore_list = {
+      /*count=*/1,
+      /*semaphores=*/&semaphore_,
+      /*payload_values=*/&signal_value,
+  };
+  EXPECT_THAT(Status(iree_io_direct_loader_flush(loader, wait_semaphore_list,
+                                                 signal_semaphore_list,
+                                                 /*out_statistics=*/NULL)),
+              StatusIs(StatusCode::kFailedPrecondition));
+  EXPECT_EQ(iree_io_direct_loader_pending_count(loader), 0);
+
+  // Once reached the same wait list is accepted.
+  IREE_ASSERT_OK(iree_hal_semaphore_signal(wait_semaphore, wait_value));
+  ResetTargets();
+  EnqueueRead(loader, 0, kAlignment);
+  IREE_ASSERT_OK(iree_io_direct_loader_flush(loader, wait_semaphore_list,
+                                             signal_semaphore_list,
+                                             /*out_statistics=*/NULL));
+  IREE_ASSERT_OK(iree_hal_semaphore_wait(semaphore_, signal_value,
+                                         iree_infinite_timeout()));
+  ExpectTargetContents();
+  iree_hal_semaphore_release(wait_semaphore);
+  iree_io_direct_loader_free(loader);
+}
+
+// Ranges that neither start nor end on an alignment boundary are read from the
+// surrounding aligned blocks.
+TEST_F(DirectLoaderTest, UnalignedRanges) {
+  CreateFile("unaligned", 8 * kAlignment);
+  iree_io_direct_loader_t* loader = AllocateLoader(2, 16 * kAlignment);
+  EnqueueRead(loader, 1, 1);
+  EnqueueRead(loader, kAlignment - 3, 7);  // spans a block boundary
+  EnqueueRead(loader, 2 * kAlignment + 100, kAlignment + 1000);
+  EnqueueRead(loader, 5 * kAlignment, 123);  // aligned start only
+  EXPECT_EQ(iree_io_direct_loader_pending_count(loader), 4);
+
+  iree_io_direct_loader_statistics_t statistics;
+  IREE_ASSERT_OK(Flush(loader, &statistics));
+  EXPECT_EQ(iree_io_direct_loader_pending_count(loader), 0);
+  EXPECT_EQ(statistics.request_count, 4);
+  EXPECT_EQ(statistics.bytes_requested, 1 + 7 + kAlignment + 1000 + 123);
+  // All ranges are within one coalescing gap and read as [0, 6 * alignment).
+  EXPECT_EQ(statistics.bytes_read, 6 * kAlignment);
+  ExpectTargetContents();
+  iree_io_direct_loader_free(loader);
+}
+
+// Reads of the last range of a file with an unaligned size stop at the end of
+// the file instead of failing on the partial final block.
+TEST_F(DirectLoaderTest, LastRangeOfFile) {
+  const uint64_t file_size = 3 * kAlignment + 1234;
+  CreateFile("last_range", file_size);
+  iree_io_direct_loader_t* loader = AllocateLoader(2, 16 * kAlignment);
+  EnqueueRead(loader, file_size - 10, 10);
+  EnqueueRead(loader, 0, file_size);  // entire file
+
+  iree_io_direct_loader_statistics_t statistics;
+  IREE_ASSERT_OK(Flush(loader, &statistics));
+  EXPECT_EQ(statistics.bytes_read, file_size);
+  ExpectTargetContents();
+  iree_io_direct_loader_free(loader);
+}
+
+// Reads extending past the end of the file fail instead of producing partially
+// populated buffers.
+TEST_F(DirectLoaderTest, ShortReadAtEndOfFile) {
+  const uint64_t file_size = 2 * kAlignment + 100;
+  CreateFile("short_read", file_size);
+  iree_io_direct_loader_t* loader = AllocateLoader(2, 16 * kAlignment);
+  EnqueueRead(loader, file_size - 50, 100);
+  EXPECT_THAT(Status(Flush(loader, NULL)),
+              StatusIs(StatusCode::kOutOfRange));
+
+  // The loader is reset after a failed flush and can be reused.
+  EXPECT_EQ(iree_io_direct_loader_pending_count(loader), 0);
+  ResetTargets();
+  EnqueueRead(loader, file_size - 50, 50);
+  IREE_ASSERT_OK(Flush(loader, NULL));
+  ExpectTargetContents();
+  iree_io_direct_loader_free(loader);
+}
+
+// Requests separated by small gaps are read through in a single read while
+// distant requests are read separately.
+TEST_F(DirectLoaderTest, CoalescesNearbyRanges) {
+  CreateFile("coalesce", 64 * kAlignment);
+  iree_io_direct_loader_t* loader = AllocateLoader(2, 64 * kAlignment);
+  // Enqueued out of order; reads are performed in file order.
+  EnqueueRead(loader, 40 * kAlignment + 5, 100);
+  EnqueueRead(loader, 2 * kAlignment + 17, 100);
+  EnqueueRead(loader, 100, 100);
+
+  iree_io_direct_loader_statistics_t statistics;
+  IREE_ASSERT_OK(Flush(loader, &statistics));
+  // [0, 3 * alignment) covers the first two ranges and the gap between them.
+  // The last range is more than the coalescing gap away and read on its own.
+  ASSERT_GT(40 * kAlignment - 3 * kAlignment, kMaxCoalesceGap);
+  EXPECT_EQ(statistics.bytes_read, 3 * kAlignment + kAlignment);
+  ExpectTargetContents();
+  iree_io_direct_loader_free(loader);
+}
+
+// Ranges larger than a staging buffer are split across multiple chunks and
+// staging buffers are reused once the copies out of them have completed.
+TEST_F(DirectLoaderTest, ReusesStagingBuffers) {
+  const uint64_t file_size = 37 * kAlignment + 321;
+  CreateFile("staging_reuse", file_size);
+  // Two staging buffers of two blocks each require many rotations.
+  iree_io_direct_loader_t* loader = AllocateLoader(2, 2 * kAlignment);
+  EnqueueRead(loader, 3, file_size - 3);
+  EnqueueRead(loader, 7 * kAlignment + 11, 5 * kAlignment);  // overlaps
+  for (uint64_t i = 0; i < 8; ++i) {
+    EnqueueRead(loader, 20 * kAlignment + i * 300, 200);
+  }
+
+  iree_io_direct_loader_statistics_t statistics;
+  IREE_ASSERT_OK(Flush(loader, &statistics));
+  EXPECT_EQ(statistics.request_count, 10);
+  EXPECT_GE(statistics.bytes_read, file_size);
+  ExpectTargetContents();
+
+  // The loader can be reused for another flush.
+  ResetTargets();
+  EnqueueRead(loader, file_size - 321, 321);
+  IREE_ASSERT_OK(Flush(loader, &statistics));
+  EXPECT_EQ(statistics.request_count, 1);
+  ExpectTargetContents();
+  iree_io_direct_loader_free(loader);
+}
+
+// Files on file systems without direct I/O support (here procfs) are read with
+// buffered I/O.
+TEST_F(DirectLoaderTest, FallsBackToBufferedReads) {
+  const char* path = "/proc/version";
+  {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.good()) GTEST_SKIP() << path << " not available";
+  }
+  OpenFile(path);
+  ASSERT_FALSE(contents_.empty());
+  iree_io_direct_loader_t* loader = AllocateLoader(2, kAlignment);
+  EnqueueRead(loader, 1, contents_.size() - 1);
+
+  iree_io_direct_loader_statistics_t statistics;
+  IREE_ASSERT_OK(Flush(loader, &statistics));
+  EXPECT_EQ(statistics.direct_file_count, 0);
+  ExpectTargetContents();
+  iree_io_direct_loader_free(loader);
+}
+
+}  // namespace
+}  // namespace io
+}  // namespace iree
+
+#endif  // IREE_FILE_IO_ENABLE && !IREE_PLATFORM_WINDOWS
@@ -924,10 +924,17 @@ struct iree_io_file_mapping_t {
   //  - mmap: base pointer returned from mmap
   //  - Win32: HANDLE returned by CreateFileMappingA
   void* impl;
+  // Platform view containing the requested range. May start before the
+  // requested offset as platforms require views to be aligned.
+  iree_byte_span_t view;
   // Mapped contents in host memory. Access matches that requested on mapping.
   iree_byte_span_t contents;
 };
 
+// Alignment of file offsets passed to platform mapping APIs. Covers the page
+// size on all supported platforms and the allocation granularity on Windows.
+#define IREE_IO_FILE_MAPPING_OFFSET_ALIGNMENT (64 * 1024)
+
 IREE_API_EXPORT iree_status_t iree_io_file_map_view(
     iree_io_file_handle_t* handle, iree_io_file_access_t access,
     uint64_t offset, iree_host_size_t length,
@@ -950,6 +957,7 @@ IREE_API_EXPORT iree_status_t iree_io_file_map_view(
   mapping->handle = handle;
   iree_io_file_handle_retain(mapping->handle);
   mapping->flags = flags;
+  mapping->view = iree_byte_span_empty();
   mapping->contents = iree_byte_span_empty();
 
   iree_status_t status = iree_ok_status();
@@ -964,10 +972,23 @@ IREE_API_EXPORT iree_status_t iree_io_file_map_view(
     status = iree_io_file_mapping_from_host_allocation(
         file_buffer, offset, length, &mapping->contents);
   } else {
-    // Use platform APIs to map the file.
-    status =
-        iree_io_platform_map_file_view(primitive, access, offset, length, flags,
-                                       &mapping->impl, &mapping->contents);
+    // Use platform APIs to map the file. Views must start at an aligned offset
+    // so we map from the aligned offset preceding the requested range and
+    // slice the range out of the view.
+    const uint64_t view_offset =
+        offset & ~(uint64_t)(IREE_IO_FILE_MAPPING_OFFSET_ALIGNMENT - 1);
+    const iree_host_size_t view_prefix =
+        (iree_host_size_t)(offset - view_offset);
+    const iree_host_size_t view_length =
+        length == IREE_HOST_SIZE_MAX ? length : length + view_prefix;
+    status = iree_io_platform_map_file_view(primitive, access, view_offset,
+                                            view_length, flags, &mapping->impl,
+                                            &mapping->view);
+    if (iree_status_is_ok(status)) {
+      mapping->contents =
+          iree_make_byte_span(mapping->view.data + view_prefix,
+                              mapping->view.data_length - view_prefix);
+    }
   }
 
   if (iree_status_is_ok(status)) {
@@ -986,7 +1007,7 @@ static void iree_io_file_mapping_destroy(iree_io_file_mapping_t* mapping) {
 
   if (mapping->impl) {
     iree_io_platform_unmap_file_view(mapping->flags, mapping->impl,
-                                     mapping->contents);
+                                     mapping->view);
   }
 
   iree_io_file_handle_release(mapping->handle);
@@ -288,7 +288,8 @@ typedef struct iree_io_file_mapping_t iree_io_file_mapping_t;
 
 // Maps a view of a file into host-accessible memory.
 // The provided file |handle| is retained for the lifetime of the view.
-// To map the entire file specify a range of [0, IREE_HOST_SIZE_MAX].
+// To map the entire file specify a range of [0, IREE_HOST_SIZE_MAX]. The
+// |offset| need not be aligned to the platform page size.
 //
 // If the provided file |handle| is already available for use as a host pointer
 // it is returned directly.
@@ -4,8 +4,28 @@
 // See https://llvm.org/LICENSE.txt for license information.
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
+// syscall is only exposed by glibc with _GNU_SOURCE.
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE 1
+#endif  // _GNU_SOURCE
+
 #include "iree/io/formats/irpa/irpa_builder.h"
 
+#include <stdlib.h>
+
+#include "iree/base/internal/atomics.h"
+#include "iree/base/internal/threading.h"
+
+#if IREE_FILE_IO_ENABLE && !defined(IREE_PLATFORM_WINDOWS)
+#include <errno.h>
+#include <limits.h>
+#include <string.h>
+#include <unistd.h>
+#if defined(IREE_PLATFORM_LINUX)
+#include <sys/syscall.h>
+#endif  // IREE_PLATFORM_LINUX
+#endif  // IREE_FILE_IO_ENABLE && !IREE_PLATFORM_WINDOWS
+
 IREE_API_EXPORT iree_status_t iree_io_parameter_archive_builder_initialize(
     iree_allocator_t host_allocator,
     iree_io_parameter_archive_builder_t* out_builder) {
@@ -48,6 +68,18 @@ iree_io_parameter_archive_builder_storage_offset(
       iree_io_parameter_archive_builder_storage_alignment(builder));
 }
 
+// Returns the size of the table entry for the data |entry| including its
+// optional checksum.
+static iree_io_physical_size_t iree_io_parameter_archive_data_entry_size(
+    const iree_io_parameter_index_entry_t* entry) {
+  iree_io_physical_size_t entry_size =
+      sizeof(iree_io_parameter_archive_data_entry_t);
+  if (iree_io_checksum_is_present(entry->checksum)) {
+    entry_size += sizeof(iree_io_parameter_archive_checksum_t);
+  }
+  return entry_size;
+}
+
 IREE_API_EXPORT iree_io_physical_size_t
 iree_io_parameter_archive_builder_total_size(
     const iree_io_parameter_archive_builder_t* builder) {
@@ -141,6 +173,7 @@ IREE_API_EXPORT iree_status_t iree_io_parameter_archive_builder_write(
         .length = source_entry->length,
         .type = source_entry->type,
         .storage = source_entry->storage,
+        .checksum = source_entry->checksum,
     };
     switch (source_entry->type) {
       case IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_SPLAT: {
@@ -165,12 +198,20 @@ IREE_API_EXPORT iree_status_t iree_io_parameter_archive_builder_write(
         break;
       }
       case IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_FILE: {
+        const bool has_checksum =
+            iree_io_checksum_is_present(source_entry->checksum);
+        iree_io_parameter_archive_entry_flags_t flags =
+            IREE_IO_PARAMETER_ARCHIVE_DATA_ENTRY_FLAG_NONE;
+        if (has_checksum) {
+          flags |= IREE_IO_PARAMETER_ARCHIVE_DATA_ENTRY_FLAG_HAS_CHECKSUM;
+        }
         iree_io_parameter_archive_data_entry_t data_entry = {
             .header =
                 {
-                    .entry_size = sizeof(data_entry),
+                    .entry_size =
+                        iree_io_parameter_archive_data_entry_size(source_entry),
                     .type = IREE_IO_PARAMETER_ARCHIVE_ENTRY_TYPE_DATA,
-                    .flags = 0,
+                    .flags = flags,
                     .name = name_ref,
                     .metadata = metadata_ref,
                     .minimum_alignment =
@@ -186,6 +227,16 @@ IREE_API_EXPORT iree_status_t iree_io_parameter_archive_builder_write(
         target_entry.storage.file.offset += storage_segment.offset;
         IREE_RETURN_AND_END_ZONE_IF_ERROR(
             z0, iree_io_stream_write(stream, sizeof(data_entry), &data_entry));
+        if (has_checksum) {
+          // Only XXH64 is accepted when adding entries.
+          iree_io_parameter_archive_checksum_t checksum = {
+              .type = IREE_IO_PARAMETER_ARCHIVE_CHECKSUM_TYPE_XXH64,
+              .reserved = 0,
+              .value = source_entry->checksum.value,
+          };
+          IREE_RETURN_AND_END_ZONE_IF_ERROR(
+              z0, iree_io_stream_write(stream, sizeof(checksum), &checksum));
+        }
         break;
       }
       default: {
@@ -265,11 +316,28 @@ IREE_API_EXPORT iree_status_t iree_io_parameter_archive_builder_add_splat_entry(
   return iree_ok_status();
 }
 
+
 IREE_API_EXPORT iree_status_t iree_io_parameter_archive_builder_add_data_entry(
     iree_io_parameter_archive_builder_t* builder, iree_string_view_t name,
     iree_const_byte_span_t metadata, iree_io_physical_size_t minimum_alignment,
     iree_io_physical_size_t data_length) {
+  return iree_io_parameter_archive_builder_add_data_entry_with_checksum(
+      builder, name, metadata, minimum_alignment, data_length,
+      iree_io_checksum_none());
+}
+
+IREE_API_EXPORT iree_status_t
+iree_io_parameter_archive_builder_add_data_entry_with_checksum(
+    iree_io_parameter_archive_builder_t* builder, iree_string_view_t name,
+    iree_const_byte_span_t metadata, iree_io_physical_size_t minimum_alignment,
+    iree_io_physical_size_t data_length, iree_io_checksum_t checksum) {
   IREE_ASSERT_ARGUMENT(builder);
+  if (checksum.type != IREE_IO_CHECKSUM_TYPE_NONE &&
+      checksum.type != IREE_IO_CHECKSUM_TYPE_XXH64) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "checksum type %u cannot be stored in archives",
+                            (uint32_t)checksum.type);
+  }
   IREE_TRACE_ZONE_BEGIN(z0);
   IREE_TRACE_ZONE_APPEND_TEXT(z0, name.data, name.size);
   iree_io_parameter_index_entry_t entry = {
@@ -286,13 +354,14 @@ IREE_API_EXPORT iree_status_t iree_io_parameter_archive_builder_add_data_entry(
                                                   minimum_alignment),
                   },
           },
+      .checksum = checksum,
   };
   IREE_RETURN_AND_END_ZONE_IF_ERROR(
       z0, iree_io_parameter_index_add(builder->index, &entry));
   builder->entry_segment_size =
       iree_align_uint64(builder->entry_segment_size,
                         IREE_IO_PARAMETER_ARCHIVE_ENTRY_ALIGNMENT) +
-      sizeof(iree_io_parameter_archive_data_entry_t);
+      iree_io_parameter_archive_data_entry_size(&entry);
   builder->metadata_segment_size += name.size + metadata.data_length;
   builder->storage_segment_size = entry.storage.file.offset + entry.length;
   if (!builder->storage_alignment) {
@@ -303,49 +372,785 @@ IREE_API_EXPORT iree_status_t iree_io_parameter_archive_builder_add_data_entry(
   return iree_ok_status();
 }
 
+IREE_API_EXPORT iree_status_t iree_io_parameter_archive_builder_add_alias_entry(
+    iree_io_parameter_archive_builder_t* builder, iree_string_view_t name,
+    iree_const_byte_span_t metadata, iree_host_size_t storage_entry_ordinal) {
+  IREE_ASSERT_ARGUMENT(builder);
+  const iree_io_parameter_index_entry_t* storage_entry = NULL;
+  IREE_RETURN_IF_ERROR(iree_io_parameter_index_get(
+      builder->index, storage_entry_ordinal, &storage_entry));
+  if (storage_entry->type != IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_FILE) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "entry %" PRIhsz " has no storage to alias",
+                            storage_entry_ordinal);
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_TEXT(z0, name.data, name.size);
+  iree_io_parameter_index_entry_t entry = {
+      .key = name,
+      .metadata = metadata,
+      .length = storage_entry->length,
+      .type = IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_FILE,
+      .storage =
+          {
+              .file =
+                  {
+                      .handle = NULL,  // set on commit
+                      .offset = storage_entry->storage.file.offset,
+                  },
+          },
+      .checksum = storage_entry->checksum,
+  };
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_io_parameter_index_add(builder->index, &entry));
+  builder->entry_segment_size =
+      iree_align_uint64(builder->entry_segment_size,
+                        IREE_IO_PARAMETER_ARCHIVE_ENTRY_ALIGNMENT) +
+      iree_io_parameter_archive_data_entry_size(&entry);
+  builder->metadata_segment_size += name.size + metadata.data_length;
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
+//===----------------------------------------------------------------------===//
+// Parallel work distribution
+//===----------------------------------------------------------------------===//
+
+// Performs the work item at |ordinal|. May be called from any thread.
+typedef iree_status_t (*iree_io_parameter_archive_work_fn_t)(
+    void* user_data, iree_host_size_t ordinal);
+
+typedef struct iree_io_parameter_archive_work_t {
+  iree_io_parameter_archive_work_fn_t fn;
+  void* user_data;
+  iree_host_size_t count;
+  // Next work item ordinal to be claimed by a worker.
+  iree_atomic_int64_t next_ordinal;
+  // Set when any work item fails so that workers stop claiming new items.
+  iree_atomic_int32_t failed;
+} iree_io_parameter_archive_work_t;
+
+typedef struct iree_io_parameter_archive_worker_t {
+  iree_io_parameter_archive_work_t* work;
+  iree_thread_t* thread;
+  iree_status_t status;
+} iree_io_parameter_archive_worker_t;
+
+static iree_status_t iree_io_parameter_archive_work_run(
+    iree_io_parameter_archive_work_t* work) {
+  while (!iree_atomic_load(&work->failed, iree_memory_order_acquire)) {
+    const int64_t ordinal = iree_atomic_fetch_add(&work->next_ordinal, 1,
+                                                  iree_memory_order_relaxed);
+    if (ordinal >= (int64_t)work->count) break;
+    iree_status_t status = work->fn(work->user_data, (iree_host_size_t)ordinal);
+    if (!iree_status_is_ok(status)) {
+      iree_atomic_store(&work->failed, 1, iree_memory_order_release);
+      return status;
+    }
+  }
+  return iree_ok_status();
+}
+
+static int iree_io_parameter_archive_worker_main(void* entry_arg) {
+  iree_io_parameter_archive_worker_t* worker =
+      (iree_io_parameter_archive_worker_t*)entry_arg;
+  worker->status = iree_io_parameter_archive_work_run(worker->work);
+  return 0;
+}
+
+// Calls |fn| for each ordinal in [0, |count|) distributed across up to
+// |worker_count| threads, including the calling thread. Work items are claimed
+// in order but may complete in any order. Returns the first failure (if any)
+// after all threads have stopped.
+static iree_status_t iree_io_parameter_archive_parallel_for(
+    iree_host_size_t worker_count, iree_host_size_t count,
+    iree_io_parameter_archive_work_fn_t fn, void* user_data,
+    iree_allocator_t host_allocator) {
+  if (count == 0) return iree_ok_status();
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, count);
+
+  iree_io_parameter_archive_work_t work = {
+      .fn = fn,
+      .user_data = user_data,
+      .count = count,
+  };
+  iree_atomic_store(&work.next_ordinal, 0, iree_memory_order_relaxed);
+  iree_atomic_store(&work.failed, 0, iree_memory_order_relaxed);
+
+  // The calling thread is one of the workers.
+  iree_host_size_t thread_count = iree_min(worker_count, count);
+  thread_count = thread_count > 0 ? thread_count - 1 : 0;
+  iree_io_parameter_archive_worker_t* workers = NULL;
+  if (thread_count > 0 &&
+      !iree_status_is_ok(iree_allocator_malloc(
+          host_allocator, thread_count * sizeof(*workers), (void**)&workers))) {
+    // Not fatal: all work will run on the calling thread.
+    thread_count = 0;
+  }
+
+  // Launch threads. Threads are an optimization so if we can't create them
+  // (resource limits, threading unavailable on the platform, etc) the calling
+  // thread and whatever threads were created will complete the work.
+  iree_thread_create_params_t thread_params;
+  memset(&thread_params, 0, sizeof(thread_params));
+  thread_params.name = iree_make_cstring_view("iree-irpa-worker");
+  iree_host_size_t launched_count = 0;
+  for (; launched_count < thread_count; ++launched_count) {
+    iree_io_parameter_archive_worker_t* worker = &workers[launched_count];
+    worker->work = &work;
+    worker->thread = NULL;
+    worker->status = iree_ok_status();
+    iree_status_t status =
+        iree_thread_create(iree_io_parameter_archive_worker_main, worker,
+                           thread_params, host_allocator, &worker->thread);
+    if (!iree_status_is_ok(status)) {
+      iree_status_ignore(status);
+      break;
+    }
+  }
+
+  iree_status_t status = iree_io_parameter_archive_work_run(&work);
+
+  for (iree_host_size_t i = 0; i < launched_count; ++i) {
+    iree_thread_join(workers[i].thread);
+    iree_thread_release(workers[i].thread);
+    if (iree_status_is_ok(status)) {
+      status = workers[i].status;
+    } else {
+      iree_status_ignore(workers[i].status);
+    }
+  }
+  iree_allocator_free(host_allocator, workers);
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+//===----------------------------------------------------------------------===//
+// File range operations
+//===----------------------------------------------------------------------===//
+
+// Size of each window of a file mapped into memory while comparing or copying.
+#define IREE_IO_PARAMETER_ARCHIVE_MAPPING_WINDOW_SIZE (64 * 1024 * 1024)
+
+// Maximum size of a single copy work item. Large parameters are split so that
+// they can be copied by multiple threads.
+#define IREE_IO_PARAMETER_ARCHIVE_COPY_CHUNK_SIZE (64 * 1024 * 1024)
+
+// Compares |length| bytes of two file ranges and sets |out_equal| if they are
+// byte-for-byte identical.
+static iree_status_t iree_io_parameter_archive_compare_ranges(
+    iree_io_file_handle_t* lhs_handle, uint64_t lhs_offset,
+    iree_io_file_handle_t* rhs_handle, uint64_t rhs_offset, uint64_t length,
+    iree_allocator_t host_allocator, bool* out_equal) {
+  *out_equal = false;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, length);
+  iree_status_t status = iree_ok_status();
+  bool equal = true;
+  for (uint64_t offset = 0; equal && offset < length;) {
+    const iree_host_size_t window_length = (iree_host_size_t)iree_min(
+        length - offset, IREE_IO_PARAMETER_ARCHIVE_MAPPING_WINDOW_SIZE);
+    iree_io_file_mapping_t* lhs_mapping = NULL;
+    iree_io_file_mapping_t* rhs_mapping = NULL;
+    status = iree_io_file_map_view(
+        lhs_handle, IREE_IO_FILE_ACCESS_READ, lhs_offset + offset,
+        window_length, IREE_IO_FILE_MAPPING_FLAG_SEQUENTIAL_ACCESS,
+        host_allocator, &lhs_mapping);
+    if (iree_status_is_ok(status)) {
+      status = iree_io_file_map_view(
+          rhs_handle, IREE_IO_FILE_ACCESS_READ, rhs_offset + offset,
+          window_length, IREE_IO_FILE_MAPPING_FLAG_SEQUENTIAL_ACCESS,
+          host_allocator, &rhs_mapping);
+    }
+    if (iree_status_is_ok(status)) {
+      equal = memcmp(iree_io_file_mapping_contents_ro(lhs_mapping).data,
+                     iree_io_file_mapping_contents_ro(rhs_mapping).data,
+                     window_length) == 0;
+    }
+    iree_io_file_mapping_release(rhs_mapping);
+    iree_io_file_mapping_release(lhs_mapping);
+    if (!iree_status_is_ok(status)) break;
+    offset += window_length;
+  }
+  if (iree_status_is_ok(status)) *out_equal = equal;
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+#if IREE_FILE_IO_ENABLE && !defined(IREE_PLATFORM_WINDOWS)
+
+// Writes all of |contents| to |fd| at |offset|.
+static iree_status_t iree_io_parameter_archive_pwrite(
+    int fd, uint64_t offset, iree_const_byte_span_t contents) {
+  const uint8_t* ptr = contents.data;
+  iree_host_size_t remaining = contents.data_length;
+  while (remaining > 0) {
+    ssize_t written = pwrite(fd, ptr, remaining, (off_t)offset);
+    if (written < 0) {
+      if (errno == EINTR) continue;
+      return iree_make_status(iree_status_code_from_errno(errno),
+                              "failed to write %" PRIhsz
+                              " bytes at offset %" PRIu64 ": %s",
+                              remaining, offset, strerror(errno));
+    } else if (written == 0) {
+      return iree_make_status(IREE_STATUS_DATA_LOSS,
+                              "short write at offset %" PRIu64, offset);
+    }
+    ptr += written;
+    offset += (uint64_t)written;
+    remaining -= (iree_host_size_t)written;
+  }
+  return iree_ok_status();
+}
+
+// Copies as much of the range as possible between two file descriptors in the
+// kernel. Where supported by the file system this shares the underlying blocks
+// instead of copying them (reflinks). Returns the number of bytes copied in
+// |out_copied_length|; any remainder must be copied by the caller.
+static iree_status_t iree_io_parameter_archive_copy_file_range(
+    int source_fd, uint64_t source_offset, int target_fd,
+    uint64_t target_offset, uint64_t length, uint64_t* out_copied_length) {
+  *out_copied_length = 0;
+#if defined(IREE_PLATFORM_LINUX) && defined(__NR_copy_file_range)
+  uint64_t copied_length = 0;
+  while (copied_length < length) {
+    int64_t source_position = (int64_t)(source_offset + copied_length);
+    int64_t target_position = (int64_t)(target_offset + copied_length);
+    const size_t request_length =
+        (size_t)iree_min(length - copied_length, (uint64_t)SSIZE_MAX);
+    ssize_t result =
+        syscall(__NR_copy_file_range, source_fd, &source_position, target_fd,
+                &target_position, request_length, 0u);
+    if (result < 0) {
+      if (errno == EINTR) continue;
+      switch (errno) {
+        case ENOSYS:      // kernel < 4.5
+        case EXDEV:       // cross-filesystem on kernels < 5.3
+        case EINVAL:      // unsupported file types or flags
+        case EOPNOTSUPP:  // unsupported by the file system
+        case EBADF:       // descriptor not opened for the required access
+          // Fall back to copying through user memory.
+          *out_copied_length = copied_length;
+          return iree_ok_status();
+        default:
+          return iree_make_status(iree_status_code_from_errno(errno),
+                                  "copy_file_range failed: %s",
+                                  strerror(errno));
+      }
+    } else if (result == 0) {
+      break;  // source EOF; caller will report the short read
+    }
+    copied_length += (uint64_t)result;
+  }
+  *out_copied_length = copied_length;
+#endif  // IREE_PLATFORM_LINUX && __NR_copy_file_range
+  return iree_ok_status();
+}
+
+#endif  // IREE_FILE_IO_ENABLE && !IREE_PLATFORM_WINDOWS
+
+// Returns true if ranges can be copied into |target_handle| with
+// iree_io_parameter_archive_copy_range from multiple threads.
+static bool iree_io_parameter_archive_can_copy_range(
+    iree_io_file_handle_t* target_handle) {
+  switch (iree_io_file_handle_primitive(target_handle).type) {
+    case IREE_IO_FILE_HANDLE_TYPE_HOST_ALLOCATION:
+      return true;
+#if IREE_FILE_IO_ENABLE && !defined(IREE_PLATFORM_WINDOWS)
+    case IREE_IO_FILE_HANDLE_TYPE_FD:
+      return true;
+#endif  // IREE_FILE_IO_ENABLE && !IREE_PLATFORM_WINDOWS
+    default:
+      return false;
+  }
+}
+
+// Writes |contents| to |target_handle| at |target_offset|.
+static iree_status_t iree_io_parameter_archive_write_range(
+    iree_io_file_handle_t* target_handle, uint64_t target_offset,
+    iree_const_byte_span_t contents) {
+  iree_io_file_handle_primitive_t target_primitive =
+      iree_io_file_handle_primitive(target_handle);
+  switch (target_primitive.type) {
+    case IREE_IO_FILE_HANDLE_TYPE_HOST_ALLOCATION: {
+      iree_byte_span_t target_span = target_primitive.value.host_allocation;
+      if (target_offset > target_span.data_length ||
+          contents.data_length > target_span.data_length - target_offset) {
+        return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                                "write of %" PRIhsz " bytes at offset %" PRIu64
+                                " exceeds target allocation size %" PRIhsz,
+                                contents.data_length, target_offset,
+                                target_span.data_length);
+      }
+      memcpy(target_span.data + target_offset, contents.data,
+             contents.data_length);
+      return iree_ok_status();
+    }
+#if IREE_FILE_IO_ENABLE && !defined(IREE_PLATFORM_WINDOWS)
+    case IREE_IO_FILE_HANDLE_TYPE_FD:
+      return iree_io_parameter_archive_pwrite(target_primitive.value.fd,
+                                              target_offset, contents);
+#endif  // IREE_FILE_IO_ENABLE && !IREE_PLATFORM_WINDOWS
+    default:
+      return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                              "unsupported target file handle type %d",
+                              (int)target_primitive.type);
+  }
+}
+
+// Copies |length| bytes from |source_handle| at |source_offset| to
+// |target_handle| at |target_offset|. Thread-safe.
+static iree_status_t iree_io_parameter_archive_copy_range(
+    iree_io_file_handle_t* source_handle, uint64_t source_offset,
+    iree_io_file_handle_t* target_handle, uint64_t target_offset,
+    uint64_t length, iree_allocator_t host_allocator) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, length);
+
+  // Try to have the kernel perform the copy without passing through user
+  // memory. This may only copy a prefix (or nothing) and the remainder is
+  // copied by mapping the source.
+  uint64_t copied_length = 0;
+#if IREE_FILE_IO_ENABLE && !defined(IREE_PLATFORM_WINDOWS)
+  iree_io_file_handle_primitive_t source_primitive =
+      iree_io_file_handle_primitive(source_handle);
+  iree_io_file_handle_primitive_t target_primitive =
+      iree_io_file_handle_primitive(target_handle);
+  if (source_primitive.type == IREE_IO_FILE_HANDLE_TYPE_FD &&
+      target_primitive.type == IREE_IO_FILE_HANDLE_TYPE_FD) {
+    IREE_RETURN_AND_END_ZONE_IF_ERROR(
+        z0, iree_io_parameter_archive_copy_file_range(
+                source_primitive.value.fd, source_offset,
+                target_primitive.value.fd, target_offset, length,
+                &copied_length));
+  }
+#endif  // IREE_FILE_IO_ENABLE && !IREE_PLATFORM_WINDOWS
+
+  iree_status_t status = iree_ok_status();
+  while (iree_status_is_ok(status) && copied_length < length) {
+    const iree_host_size_t window_length = (iree_host_size_t)iree_min(
+        length - copied_length, IREE_IO_PARAMETER_ARCHIVE_MAPPING_WINDOW_SIZE);
+    iree_io_file_mapping_t* source_mapping = NULL;
+    status = iree_io_file_map_view(
+        source_handle, IREE_IO_FILE_ACCESS_READ, source_offset + copied_length,
+        window_length, IREE_IO_FILE_MAPPING_FLAG_SEQUENTIAL_ACCESS,
+        host_allocator, &source_mapping);
+    if (iree_status_is_ok(status)) {
+      status = iree_io_parameter_archive_write_range(
+          target_handle, target_offset + copied_length,
+          iree_io_file_mapping_contents_ro(source_mapping));
+    }
+    iree_io_file_mapping_release(source_mapping);
+    copied_length += window_length;
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+//===----------------------------------------------------------------------===//
+// iree_io_build_parameter_archive
+//===----------------------------------------------------------------------===//
+
+IREE_API_EXPORT void iree_io_parameter_archive_build_options_initialize(
+    iree_io_parameter_archive_build_options_t* out_options) {
+  IREE_ASSERT_ARGUMENT(out_options);
+  memset(out_options, 0, sizeof(*out_options));
+  out_options->data_alignment =
+      IREE_IO_PARAMETER_ARCHIVE_DEFAULT_DATA_ALIGNMENT;
+  out_options->worker_count =
+      IREE_IO_PARAMETER_ARCHIVE_BUILD_DEFAULT_WORKER_COUNT;
+}
+
 IREE_API_EXPORT iree_status_t iree_io_build_parameter_archive(
     iree_io_parameter_index_t* source_index,
     iree_io_parameter_index_t* target_index,
     iree_io_parameter_archive_file_open_callback_t target_file_open,
     iree_io_physical_offset_t target_file_offset,
     iree_allocator_t host_allocator) {
-  IREE_ASSERT_ARGUMENT(source_index);
-  IREE_ASSERT_ARGUMENT(target_index);
-  IREE_ASSERT_ARGUMENT(target_file_open.fn);
+  iree_io_parameter_archive_build_options_t options;
+  iree_io_parameter_archive_build_options_initialize(&options);
+  return iree_io_build_parameter_archive_with_options(
+      source_index, target_index, target_file_open, target_file_offset,
+      &options, host_allocator);
+}
+
+// Per-entry state tracked while building an archive.
+typedef struct iree_io_parameter_archive_build_entry_t {
+  // Source entry being added to the archive. Owned by the source index.
+  const iree_io_parameter_index_entry_t* source_entry;
+  // Ordinal of the entry whose storage this entry shares or its own ordinal if
+  // it has unique contents.
+  iree_host_size_t storage_ordinal;
+  // Hash of the source contents if they were hashed.
+  iree_io_checksum_t checksum;
+} iree_io_parameter_archive_build_entry_t;
+
+// A range of data copied from a source file into the archive.
+typedef struct iree_io_parameter_archive_copy_t {
+  iree_io_file_handle_t* source_handle;
+  uint64_t source_offset;
+  uint64_t target_offset;
+  uint64_t length;
+} iree_io_parameter_archive_copy_t;
+
+typedef struct iree_io_parameter_archive_build_state_t {
+  iree_allocator_t host_allocator;
+  // One entry per source index entry.
+  iree_io_parameter_archive_build_entry_t* entries;
+  // Ordinals of entries that need their contents hashed.
+  iree_host_size_t* hash_ordinals;
+  // Ranges to copy into the target file.
+  iree_io_parameter_archive_copy_t* copies;
+  // Target file all copies are written to.
+  iree_io_file_handle_t* target_handle;
+} iree_io_parameter_archive_build_state_t;
+
+static iree_status_t iree_io_parameter_archive_hash_entry(
+    void* user_data, iree_host_size_t ordinal) {
+  iree_io_parameter_archive_build_state_t* state =
+      (iree_io_parameter_archive_build_state_t*)user_data;
+  iree_io_parameter_archive_build_entry_t* entry =
+      &state->entries[state->hash_ordinals[ordinal]];
+  return iree_io_checksum_file_range(
+      IREE_IO_CHECKSUM_TYPE_XXH64, entry->source_entry->storage.file.handle,
+      entry->source_entry->storage.file.offset, entry->source_entry->length,
+      state->host_allocator, &entry->checksum);
+}
+
+static iree_status_t iree_io_parameter_archive_copy_chunk(
+    void* user_data, iree_host_size_t ordinal) {
+  iree_io_parameter_archive_build_state_t* state =
+      (iree_io_parameter_archive_build_state_t*)user_data;
+  const iree_io_parameter_archive_copy_t* copy = &state->copies[ordinal];
+  return iree_io_parameter_archive_copy_range(
+      copy->source_handle, copy->source_offset, state->target_handle,
+      copy->target_offset, copy->length, state->host_allocator);
+}
+
+// Orders entries by length and then content hash so that entries that may be
+// identical are adjacent. Ties are broken by ordinal so that the first entry
+// with some contents is the one that stores them.
+static int iree_io_parameter_archive_build_entry_compare(const void* lhs_ptr,
+                                                         const void* rhs_ptr) {
+  const iree_io_parameter_archive_build_entry_t* lhs =
+      *(const iree_io_parameter_archive_build_entry_t* const*)lhs_ptr;
+  const iree_io_parameter_archive_build_entry_t* rhs =
+      *(const iree_io_parameter_archive_build_entry_t* const*)rhs_ptr;
+  if (lhs->source_entry->length != rhs->source_entry->length) {
+    return lhs->source_entry->length < rhs->source_entry->length ? -1 : 1;
+  }
+  if (lhs->checksum.value != rhs->checksum.value) {
+    return lhs->checksum.value < rhs->checksum.value ? -1 : 1;
+  }
+  return lhs < rhs ? -1 : (lhs > rhs ? 1 : 0);
+}
+
+// Hashes entries as required by |flags| and deduplicates identical entries by
+// updating their storage ordinals.
+static iree_status_t iree_io_parameter_archive_build_hash_entries(
+    iree_io_parameter_archive_build_state_t* state, iree_host_size_t count,
+    iree_io_parameter_archive_build_flags_t flags,
+    iree_host_size_t worker_count) {
+  const bool deduplicate = iree_all_bits_set(
+      flags, IREE_IO_PARAMETER_ARCHIVE_BUILD_FLAG_DEDUPLICATE);
+  const bool checksum =
+      iree_all_bits_set(flags, IREE_IO_PARAMETER_ARCHIVE_BUILD_FLAG_CHECKSUM);
+  if (count == 0 || (!deduplicate && !checksum)) return iree_ok_status();
   IREE_TRACE_ZONE_BEGIN(z0);
 
-  iree_io_parameter_archive_builder_t builder;
-  iree_io_parameter_archive_builder_initialize(host_allocator, &builder);
+  // Gather file-backed entries sorted by length. Only entries sharing a length
+  // with another entry can be duplicates and need to be hashed for
+  // deduplication; checksumming requires hashing everything.
+  iree_io_parameter_archive_build_entry_t** sorted_entries = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(state->host_allocator,
+                                count * sizeof(sorted_entries[0]),
+                                (void**)&sorted_entries));
+  iree_host_size_t sorted_count = 0;
+  for (iree_host_size_t i = 0; i < count; ++i) {
+    if (state->entries[i].source_entry->type ==
+        IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_FILE) {
+      sorted_entries[sorted_count++] = &state->entries[i];
+    }
+  }
+  qsort(sorted_entries, sorted_count, sizeof(sorted_entries[0]),
+        iree_io_parameter_archive_build_entry_compare);
+  iree_host_size_t hash_count = 0;
+  for (iree_host_size_t i = 0; i < sorted_count; ++i) {
+    const uint64_t length = sorted_entries[i]->source_entry->length;
+    const bool has_twin =
+        (i > 0 && sorted_entries[i - 1]->source_entry->length == length) ||
+        (i + 1 < sorted_count &&
+         sorted_entries[i + 1]->source_entry->length == length);
+    if (checksum || (deduplicate && length > 0 && has_twin)) {
+      state->hash_ordinals[hash_count++] =
+          (iree_host_size_t)(sorted_entries[i] - state->entries);
+    }
+  }
 
-  // Declare a parameter for each entry in the index.
-  // This lets us calculate the size we require to store the entry metadata and
-  // its contents (if any). No data is accessed yet.
-  iree_status_t status = iree_ok_status();
-  for (iree_host_size_t i = 0; i < iree_io_parameter_index_count(source_index);
-       ++i) {
-    const iree_io_parameter_index_entry_t* source_entry = NULL;
-    status = iree_io_parameter_index_get(source_index, i, &source_entry);
-    if (!iree_status_is_ok(status)) break;
+  // Hash entry contents in parallel.
+  iree_status_t status = iree_io_parameter_archive_parallel_for(
+      worker_count, hash_count, iree_io_parameter_archive_hash_entry, state,
+      state->host_allocator);
+
+  // Find runs of entries with matching length and hash and confirm they are
+  // identical before sharing storage. Entries that were not hashed have no
+  // other entries of the same length and are skipped.
+  if (iree_status_is_ok(status) && deduplicate) {
+    qsort(sorted_entries, sorted_count, sizeof(sorted_entries[0]),
+          iree_io_parameter_archive_build_entry_compare);
+    iree_host_size_t run_start = 0;
+    for (iree_host_size_t i = 0; i < sorted_count && iree_status_is_ok(status);
+         ++i) {
+      iree_io_parameter_archive_build_entry_t* entry = sorted_entries[i];
+      const iree_io_parameter_archive_build_entry_t* run_entry =
+          sorted_entries[run_start];
+      if (entry->source_entry->length != run_entry->source_entry->length ||
+          entry->checksum.value != run_entry->checksum.value ||
+          !iree_io_checksum_is_present(entry->checksum)) {
+        run_start = i;
+        continue;
+      }
+      // Compare against each entry in the run that stores its own contents.
+      // Hash collisions are rare enough that runs almost always have one.
+      for (iree_host_size_t j = run_start; j < i; ++j) {
+        iree_io_parameter_archive_build_entry_t* candidate = sorted_entries[j];
+        const iree_host_size_t candidate_ordinal =
+            (iree_host_size_t)(candidate - state->entries);
+        if (candidate->storage_ordinal != candidate_ordinal) continue;
+        bool equal = false;
+        status = iree_io_parameter_archive_compare_ranges(
+            candidate->source_entry->storage.file.handle,
+            candidate->source_entry->storage.file.offset,
+            entry->source_entry->storage.file.handle,
+            entry->source_entry->storage.file.offset,
+            entry->source_entry->length, state->host_allocator, &equal);
+        if (!iree_status_is_ok(status)) break;
+        if (equal) {
+          entry->storage_ordinal = candidate_ordinal;
+          break;
+        }
+      }
+    }
+  }
+
+  iree_allocator_free(state->host_allocator, sorted_entries);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+// Declares all entries in |builder| based on the build |state|.
+static iree_status_t iree_io_parameter_archive_build_declare_entries(
+    iree_io_parameter_archive_build_state_t* state, iree_host_size_t count,
+    const iree_io_parameter_archive_build_options_t* options,
+    iree_io_parameter_archive_builder_t* builder) {
+  iree_io_physical_size_t data_alignment = options->data_alignment;
+  if (!data_alignment) {
+    data_alignment = IREE_IO_PARAMETER_ARCHIVE_DEFAULT_DATA_ALIGNMENT;
+  }
+  const bool checksum = iree_all_bits_set(
+      options->flags, IREE_IO_PARAMETER_ARCHIVE_BUILD_FLAG_CHECKSUM);
+  for (iree_host_size_t i = 0; i < count; ++i) {
+    const iree_io_parameter_archive_build_entry_t* entry = &state->entries[i];
+    const iree_io_parameter_index_entry_t* source_entry = entry->source_entry;
     switch (source_entry->type) {
       case IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_SPLAT:
-        status = iree_io_parameter_archive_builder_add_splat_entry(
-            &builder, source_entry->key, source_entry->metadata,
+        IREE_RETURN_IF_ERROR(iree_io_parameter_archive_builder_add_splat_entry(
+            builder, source_entry->key, source_entry->metadata,
             source_entry->storage.splat.pattern,
-            source_entry->storage.splat.pattern_length, source_entry->length);
+            source_entry->storage.splat.pattern_length, source_entry->length));
         break;
       case IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_FILE:
-        status = iree_io_parameter_archive_builder_add_data_entry(
-            &builder, source_entry->key, source_entry->metadata,
-            IREE_IO_PARAMETER_ARCHIVE_DEFAULT_DATA_ALIGNMENT,
-            source_entry->length);
+        if (entry->storage_ordinal != i) {
+          IREE_RETURN_IF_ERROR(
+              iree_io_parameter_archive_builder_add_alias_entry(
+                  builder, source_entry->key, source_entry->metadata,
+                  entry->storage_ordinal));
+        } else {
+          IREE_RETURN_IF_ERROR(
+              iree_io_parameter_archive_builder_add_data_entry_with_checksum(
+                  builder, source_entry->key, source_entry->metadata,
+                  data_alignment, source_entry->length,
+                  checksum ? entry->checksum : iree_io_checksum_none()));
+        }
         break;
       default:
-        status = iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
-                                  "unhandled index entry storage type %d",
-                                  (int)source_entry->type);
-        break;
+        return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                                "unhandled index entry storage type %d",
+                                (int)source_entry->type);
+    }
+  }
+  return iree_ok_status();
+}
+
+// Copies the contents of all entries with unique storage from their source
+// files into the archive entries at |target_base_ordinal| in |target_index|.
+static iree_status_t iree_io_parameter_archive_build_copy_entries(
+    iree_io_parameter_archive_build_state_t* state, iree_host_size_t count,
+    iree_io_parameter_index_t* target_index,
+    iree_host_size_t target_base_ordinal,
+    iree_io_physical_offset_t target_file_offset,
+    iree_host_size_t worker_count) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Split the copies into chunks so that large parameters are copied by
+  // multiple threads.
+  const uint64_t chunk_size = IREE_IO_PARAMETER_ARCHIVE_COPY_CHUNK_SIZE;
+  iree_host_size_t copy_count = 0;
+  for (iree_host_size_t i = 0; i < count; ++i) {
+    const iree_io_parameter_archive_build_entry_t* entry = &state->entries[i];
+    if (entry->source_entry->type !=
+            IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_FILE ||
+        entry->storage_ordinal != i) {
+      continue;
     }
+    const uint64_t length = entry->source_entry->length;
+    copy_count += (iree_host_size_t)((length + chunk_size - 1) / chunk_size);
+  }
+  if (copy_count == 0) {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_ok_status();
+  }
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(state->host_allocator,
+                                copy_count * sizeof(state->copies[0]),
+                                (void**)&state->copies));
+  iree_status_t status = iree_ok_status();
+  iree_host_size_t copy_ordinal = 0;
+  for (iree_host_size_t i = 0; i < count; ++i) {
+    const iree_io_parameter_archive_build_entry_t* entry = &state->entries[i];
+    const iree_io_parameter_index_entry_t* source_entry = entry->source_entry;
+    if (source_entry->type != IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_FILE ||
+        entry->storage_ordinal != i) {
+      continue;
+    }
+    const iree_io_parameter_index_entry_t* target_entry = NULL;
+    status = iree_io_parameter_index_get(target_index, target_base_ordinal + i,
+                                         &target_entry);
     if (!iree_status_is_ok(status)) break;
+    for (uint64_t offset = 0; offset < source_entry->length;
+         offset += chunk_size) {
+      iree_io_parameter_archive_copy_t* copy = &state->copies[copy_ordinal++];
+      copy->source_handle = source_entry->storage.file.handle;
+      copy->source_offset = source_entry->storage.file.offset + offset;
+      copy->target_offset =
+          target_file_offset + target_entry->storage.file.offset + offset;
+      copy->length = iree_min(source_entry->length - offset, chunk_size);
+    }
+  }
+
+  if (iree_status_is_ok(status)) {
+    status = iree_io_parameter_archive_parallel_for(
+        worker_count, copy_ordinal, iree_io_parameter_archive_copy_chunk, state,
+        state->host_allocator);
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+// Copies the contents of all entries with unique storage through |stream|.
+// Used when the target file cannot be written from multiple threads.
+static iree_status_t iree_io_parameter_archive_build_stream_entries(
+    iree_io_parameter_archive_build_state_t* state, iree_host_size_t count,
+    iree_io_parameter_index_t* target_index,
+    iree_host_size_t target_base_ordinal,
+    iree_io_physical_offset_t target_file_offset, iree_io_stream_t* stream) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_status_t status = iree_ok_status();
+  for (iree_host_size_t i = 0; i < count; ++i) {
+    const iree_io_parameter_archive_build_entry_t* entry = &state->entries[i];
+    const iree_io_parameter_index_entry_t* source_entry = entry->source_entry;
+    if (source_entry->type != IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_FILE ||
+        entry->storage_ordinal != i) {
+      continue;
+    }
+    const iree_io_parameter_index_entry_t* target_entry = NULL;
+    status = iree_io_parameter_index_get(target_index, target_base_ordinal + i,
+                                         &target_entry);
+    if (!iree_status_is_ok(status)) break;
+    status = iree_io_stream_seek(
+        stream, IREE_IO_STREAM_SEEK_SET,
+        target_file_offset + target_entry->storage.file.offset);
+    if (!iree_status_is_ok(status)) break;
+    status = iree_io_stream_write_file(
+        stream, source_entry->storage.file.handle,
+        source_entry->storage.file.offset, target_entry->length,
+        state->host_allocator);
+    if (!iree_status_is_ok(status)) break;
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+IREE_API_EXPORT iree_status_t iree_io_build_parameter_archive_with_options(
+    iree_io_parameter_index_t* source_index,
+    iree_io_parameter_index_t* target_index,
+    iree_io_parameter_archive_file_open_callback_t target_file_open,
+    iree_io_physical_offset_t target_file_offset,
+    const iree_io_parameter_archive_build_options_t* options,
+    iree_allocator_t host_allocator) {
+  IREE_ASSERT_ARGUMENT(source_index);
+  IREE_ASSERT_ARGUMENT(target_index);
+  IREE_ASSERT_ARGUMENT(target_file_open.fn);
+  IREE_ASSERT_ARGUMENT(options);
+  if (options->data_alignment &&
+      !iree_is_power_of_two_uint64(options->data_alignment)) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "data alignment %" PRIu64
+                            " must be a power of two",
+                            options->data_alignment);
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+  const iree_host_size_t worker_count =
+      options->worker_count
+          ? options->worker_count
+          : IREE_IO_PARAMETER_ARCHIVE_BUILD_DEFAULT_WORKER_COUNT;
+
+  iree_io_parameter_archive_builder_t builder;
+  iree_io_parameter_archive_builder_initialize(host_allocator, &builder);
+
+  // Snapshot the source entries. Each entry initially stores its own contents.
+  iree_io_parameter_archive_build_state_t state;
+  memset(&state, 0, sizeof(state));
+  state.host_allocator = host_allocator;
+  const iree_host_size_t entry_count =
+      iree_io_parameter_index_count(source_index);
+  iree_status_t status = iree_ok_status();
+  if (entry_count > 0) {
+    status = iree_allocator_malloc(host_allocator,
+                                   entry_count * sizeof(state.entries[0]),
+                                   (void**)&state.entries);
+  }
+  if (iree_status_is_ok(status) && entry_count > 0) {
+    status = iree_allocator_malloc(host_allocator,
+                                   entry_count * sizeof(state.hash_ordinals[0]),
+                                   (void**)&state.hash_ordinals);
+  }
+  for (iree_host_size_t i = 0; i < entry_count && iree_status_is_ok(status);
+       ++i) {
+    status = iree_io_parameter_index_get(source_index, i,
+                                         &state.entries[i].source_entry);
+    state.entries[i].storage_ordinal = i;
+    state.entries[i].checksum = iree_io_checksum_none();
+  }
+
+  // Hash entry contents for checksums and deduplication (if requested).
+  // This is the only pass that reads parameter contents prior to copying.
+  if (iree_status_is_ok(status)) {
+    status = iree_io_parameter_archive_build_hash_entries(
+        &state, entry_count, options->flags, worker_count);
+  }
+
+  // Declare a parameter for each entry in the index.
+  // This lets us calculate the size we require to store the entry metadata and
+  // its contents (if any).
+  if (iree_status_is_ok(status)) {
+    status = iree_io_parameter_archive_build_declare_entries(
+        &state, entry_count, options, &builder);
   }
 
   // Open a file of sufficient size (now that we know it) for writing.
@@ -353,62 +1158,40 @@ IREE_API_EXPORT iree_status_t iree_io_build_parameter_archive(
       target_file_offset, IREE_IO_PARAMETER_ARCHIVE_HEADER_ALIGNMENT);
   iree_io_physical_size_t archive_length =
       iree_io_parameter_archive_builder_total_size(&builder);
-  iree_io_file_handle_t* target_file_handle = NULL;
   if (iree_status_is_ok(status)) {
     status = target_file_open.fn(target_file_open.user_data, archive_offset,
-                                 archive_length, &target_file_handle);
+                                 archive_length, &state.target_handle);
   }
 
   // Wrap the target file in a stream.
   iree_io_stream_t* target_stream = NULL;
   if (iree_status_is_ok(status)) {
     status =
-        iree_io_stream_open(IREE_IO_STREAM_MODE_WRITABLE, target_file_handle,
+        iree_io_stream_open(IREE_IO_STREAM_MODE_WRITABLE, state.target_handle,
                             target_file_offset, host_allocator, &target_stream);
   }
 
   // Commit the archive header to the file and produce an index referencing it.
-  // This will allow us to know where to copy file contents.
+  // This will allow us to know where to copy file contents. Entries are added
+  // to the target index in the same order as the source index.
+  const iree_host_size_t target_base_ordinal =
+      iree_io_parameter_index_count(target_index);
   if (iree_status_is_ok(status)) {
     status = iree_io_parameter_archive_builder_write(
-        &builder, target_file_handle, target_file_offset, target_stream,
+        &builder, state.target_handle, target_file_offset, target_stream,
         target_index);
   }
 
   // Copy over parameter entry file contents (if any).
-  // This is a slow operation and something we could optimize with lower-level
-  // platform primitives.
   if (iree_status_is_ok(status)) {
-    for (iree_host_size_t i = 0;
-         i < iree_io_parameter_index_count(source_index); ++i) {
-      const iree_io_parameter_index_entry_t* source_entry = NULL;
-      status = iree_io_parameter_index_get(source_index, i, &source_entry);
-      if (!iree_status_is_ok(status)) break;
-      const iree_io_parameter_index_entry_t* target_entry = NULL;
-      status = iree_io_parameter_index_lookup(target_index, source_entry->key,
-                                              &target_entry);
-      if (!iree_status_is_ok(status)) break;
-      switch (source_entry->type) {
-        case IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_SPLAT:
-          // No work to do.
-          break;
-        case IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_FILE:
-          status = iree_io_stream_seek(
-              target_stream, IREE_IO_STREAM_SEEK_SET,
-              target_file_offset + target_entry->storage.file.offset);
-          if (!iree_status_is_ok(status)) break;
-          status = iree_io_stream_write_file(
-              target_stream, source_entry->storage.file.handle,
-              source_entry->storage.file.offset, target_entry->length,
-              host_allocator);
-          break;
-        default:
-          status = iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
-                                    "unhandled index entry storage type %d",
-                                    (int)source_entry->type);
-          break;
-      }
-      if (!iree_status_is_ok(status)) break;
+    if (iree_io_parameter_archive_can_copy_range(state.target_handle)) {
+      status = iree_io_parameter_archive_build_copy_entries(
+          &state, entry_count, target_index, target_base_ordinal,
+          target_file_offset, worker_count);
+    } else {
+      status = iree_io_parameter_archive_build_stream_entries(
+          &state, entry_count, target_index, target_base_ordinal,
+          target_file_offset, target_stream);
     }
   }
 
@@ -417,10 +1200,13 @@ IREE_API_EXPORT iree_status_t iree_io_build_parameter_archive(
   // Flush file contents before returning to the caller (in case they open the
   // file via a different handle).
   if (iree_status_is_ok(status)) {
-    status = iree_io_file_handle_flush(target_file_handle);
+    status = iree_io_file_handle_flush(state.target_handle);
   }
 
-  iree_io_file_handle_release(target_file_handle);
+  iree_io_file_handle_release(state.target_handle);
+  iree_allocator_free(host_allocator, state.copies);
+  iree_allocator_free(host_allocator, state.hash_ordinals);
+  iree_allocator_free(host_allocator, state.entries);
   iree_io_parameter_archive_builder_deinitialize(&builder);
 
   IREE_TRACE_ZONE_END(z0);
@@ -8,6 +8,7 @@
 #define IREE_IO_FORMATS_IRPA_IRPA_BUILDER_H_
 
 #include "iree/base/api.h"
+#include "iree/io/checksum.h"
 #include "iree/io/file_handle.h"
 #include "iree/io/parameter_index.h"
 #include "iree/io/stream.h"
@@ -92,6 +93,25 @@ IREE_API_EXPORT iree_status_t iree_io_parameter_archive_builder_add_data_entry(
     iree_const_byte_span_t metadata, iree_io_physical_size_t minimum_alignment,
     iree_io_physical_size_t data_length);
 
+// Adds a new data entry to |builder| with a |checksum| of its contents.
+// The checksum is stored in the archive alongside the entry and may be used to
+// verify the contents when loaded. See
+// iree_io_parameter_archive_builder_add_data_entry.
+IREE_API_EXPORT iree_status_t
+iree_io_parameter_archive_builder_add_data_entry_with_checksum(
+    iree_io_parameter_archive_builder_t* builder, iree_string_view_t name,
+    iree_const_byte_span_t metadata, iree_io_physical_size_t minimum_alignment,
+    iree_io_physical_size_t data_length, iree_io_checksum_t checksum);
+
+// Adds a new data entry to |builder| that references the physical storage of
+// the data entry previously added at |storage_entry_ordinal|.
+// No additional storage is allocated and the new entry has the same length and
+// checksum as the referenced entry. Used to store parameters with identical
+// contents only once.
+IREE_API_EXPORT iree_status_t iree_io_parameter_archive_builder_add_alias_entry(
+    iree_io_parameter_archive_builder_t* builder, iree_string_view_t name,
+    iree_const_byte_span_t metadata, iree_host_size_t storage_entry_ordinal);
+
 // Callback for opening a file for writing.
 // Implementations need to ensure that at least |archive_length| bytes are
 // available in the file starting at |archive_offset|.
@@ -121,6 +141,57 @@ IREE_API_EXPORT iree_status_t iree_io_build_parameter_archive(
     iree_io_physical_offset_t target_file_offset,
     iree_allocator_t host_allocator);
 
+// Default maximum number of threads used to build an archive.
+#define IREE_IO_PARAMETER_ARCHIVE_BUILD_DEFAULT_WORKER_COUNT 8
+
+// Flags controlling how parameter archives are built.
+typedef uint32_t iree_io_parameter_archive_build_flags_t;
+enum iree_io_parameter_archive_build_flag_bits_t {
+  IREE_IO_PARAMETER_ARCHIVE_BUILD_FLAG_NONE = 0u,
+  // Stores parameters with identical contents only once. Parameters of equal
+  // length are hashed and those with matching hashes are compared
+  // byte-for-byte before their entries are pointed at the same storage.
+  IREE_IO_PARAMETER_ARCHIVE_BUILD_FLAG_DEDUPLICATE = 1u << 0,
+  // Stores a checksum of each data entry in the archive that can be used to
+  // verify parameter contents when they are loaded.
+  IREE_IO_PARAMETER_ARCHIVE_BUILD_FLAG_CHECKSUM = 1u << 1,
+};
+
+// Options for iree_io_build_parameter_archive_with_options.
+typedef struct iree_io_parameter_archive_build_options_t {
+  // Flags controlling the archive contents.
+  iree_io_parameter_archive_build_flags_t flags;
+  // Alignment of each data entry in the storage segment or 0 for
+  // IREE_IO_PARAMETER_ARCHIVE_DEFAULT_DATA_ALIGNMENT. Aligning to the file
+  // system block size (commonly 4096) allows copies between files on file
+  // systems supporting it to share blocks with the source file (reflinks)
+  // instead of copying the data when the source is similarly aligned.
+  iree_io_physical_size_t data_alignment;
+  // Maximum number of threads used to hash and copy parameter contents,
+  // including the calling thread, or 0 for
+  // IREE_IO_PARAMETER_ARCHIVE_BUILD_DEFAULT_WORKER_COUNT.
+  iree_host_size_t worker_count;
+} iree_io_parameter_archive_build_options_t;
+
+// Initializes |out_options| to their defaults.
+IREE_API_EXPORT void iree_io_parameter_archive_build_options_initialize(
+    iree_io_parameter_archive_build_options_t* out_options);
+
+// Builds a parameter archive as with iree_io_build_parameter_archive using
+// the provided |options|.
+//
+// Parameter contents are copied by multiple threads. Where the platform
+// supports it copies between files are performed by the kernel
+// (copy_file_range) without passing through user memory and may share blocks
+// with the source file.
+IREE_API_EXPORT iree_status_t iree_io_build_parameter_archive_with_options(
+    iree_io_parameter_index_t* source_index,
+    iree_io_parameter_index_t* target_index,
+    iree_io_parameter_archive_file_open_callback_t target_file_open,
+    iree_io_physical_offset_t target_file_offset,
+    const iree_io_parameter_archive_build_options_t* options,
+    iree_allocator_t host_allocator);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
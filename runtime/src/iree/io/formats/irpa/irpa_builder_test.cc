@@ -0,0 +1,225 @@
+// Copyright 2025 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/io/formats/irpa/irpa_builder.h"
+
+#include <cstring>
+#include <vector>
+
+#include "iree/io/formats/irpa/irpa_parser.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace iree {
+namespace {
+
+// Target archive storage in host memory.
+struct TargetArchive {
+  std::vector<uint8_t> storage;
+  iree_io_file_handle_t* file_handle = NULL;
+
+  ~TargetArchive() { iree_io_file_handle_release(file_handle); }
+
+  static iree_status_t Open(void* user_data,
+                            iree_io_physical_offset_t archive_offset,
+                            iree_io_physical_size_t archive_length,
+                            iree_io_file_handle_t** out_file_handle) {
+    auto* archive = reinterpret_cast<TargetArchive*>(user_data);
+    archive->storage.resize(archive_offset + archive_length);
+    IREE_RETURN_IF_ERROR(iree_io_file_handle_wrap_host_allocation(
+        IREE_IO_FILE_ACCESS_READ | IREE_IO_FILE_ACCESS_WRITE,
+        iree_make_byte_span(archive->storage.data(), archive->storage.size()),
+        iree_io_file_handle_release_callback_null(), iree_allocator_system(),
+        &archive->file_handle));
+    iree_io_file_handle_retain(archive->file_handle);
+    *out_file_handle = archive->file_handle;
+    return iree_ok_status();
+  }
+};
+
+class IrpaBuilderTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    // Three entries with the same contents, one with the same length and
+    // different contents, and one with a unique length.
+    source_data_.resize(4 * 4096);
+    for (size_t i = 0; i < source_data_.size(); ++i) {
+      source_data_[i] = (uint8_t)(i * 31 + (i >> 8));
+    }
+    memcpy(&source_data_[4096], &source_data_[0], 1000);
+    memcpy(&source_data_[8192], &source_data_[0], 1000);
+    source_data_[8192 + 999] ^= 0xFF;
+    IREE_ASSERT_OK(iree_io_file_handle_wrap_host_allocation(
+        IREE_IO_FILE_ACCESS_READ,
+        iree_make_byte_span(source_data_.data(), source_data_.size()),
+        iree_io_file_handle_release_callback_null(), iree_allocator_system(),
+        &source_handle_));
+    IREE_ASSERT_OK(iree_io_parameter_index_create(iree_allocator_system(),
+                                                  &source_index_));
+    AddSourceEntry("a", 0, 1000);
+    AddSourceEntry("b", 4096, 1000);
+    AddSourceEntry("c", 8192, 1000);
+    AddSourceEntry("d", 12288, 123);
+    AddSourceEntry("e", 0, 1000);
+  }
+
+  void TearDown() override {
+    iree_io_parameter_index_release(source_index_);
+    iree_io_file_handle_release(source_handle_);
+  }
+
+  void AddSourceEntry(const char* key, uint64_t offset, uint64_t length) {
+    iree_io_parameter_index_entry_t entry = {};
+    entry.key = iree_make_cstring_view(key);
+    entry.length = length;
+    entry.type = IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_FILE;
+    entry.storage.file.handle = source_handle_;
+    entry.storage.file.offset = offset;
+    IREE_ASSERT_OK(iree_io_parameter_index_add(source_index_, &entry));
+  }
+
+  // Builds an archive with |options| and parses it back into |out_index|.
+  void BuildAndParse(const iree_io_parameter_archive_build_options_t& options,
+                     TargetArchive* archive,
+                     iree_io_parameter_index_t** out_index) {
+    iree_io_parameter_index_t* target_index = NULL;
+    IREE_ASSERT_OK(
+        iree_io_parameter_index_create(iree_allocator_system(), &target_index));
+    IREE_ASSERT_OK(iree_io_build_parameter_archive_with_options(
+        source_index_, target_index, {TargetArchive::Open, archive},
+        /*target_file_offset=*/0, &options, iree_allocator_system()));
+    iree_io_parameter_index_release(target_index);
+    IREE_ASSERT_OK(
+        iree_io_parameter_index_create(iree_allocator_system(), out_index));
+    IREE_ASSERT_OK(iree_io_parse_irpa_index(archive->file_handle, *out_index,
+                                            iree_allocator_system()));
+  }
+
+  const iree_io_parameter_index_entry_t* Lookup(
+      iree_io_parameter_index_t* index, const char* key) {
+    const iree_io_parameter_index_entry_t* entry = NULL;
+    IREE_CHECK_OK(iree_io_parameter_index_lookup(
+        index, iree_make_cstring_view(key), &entry));
+    return entry;
+  }
+
+  // Returns true if the archived contents of |key| match the source.
+  bool ContentsMatch(iree_io_parameter_index_t* index, TargetArchive* archive,
+                     const char* key) {
+    const iree_io_parameter_index_entry_t* source_entry =
+        Lookup(source_index_, key);
+    const iree_io_parameter_index_entry_t* target_entry = Lookup(index, key);
+    return source_entry->length == target_entry->length &&
+           memcmp(&source_data_[source_entry->storage.file.offset],
+                  &archive->storage[target_entry->storage.file.offset],
+                  source_entry->length) == 0;
+  }
+
+  std::vector<uint8_t> source_data_;
+  iree_io_file_handle_t* source_handle_ = NULL;
+  iree_io_parameter_index_t* source_index_ = NULL;
+};
+
+TEST_F(IrpaBuilderTest, Default) {
+  iree_io_parameter_archive_build_options_t options;
+  iree_io_parameter_archive_build_options_initialize(&options);
+  TargetArchive archive;
+  iree_io_parameter_index_t* index = NULL;
+  BuildAndParse(options, &archive, &index);
+  ASSERT_EQ(5, iree_io_parameter_index_count(index));
+  for (const char* key : {"a", "b", "c", "d", "e"}) {
+    EXPECT_TRUE(ContentsMatch(index, &archive, key)) << key;
+    EXPECT_FALSE(iree_io_checksum_is_present(Lookup(index, key)->checksum));
+  }
+  EXPECT_NE(Lookup(index, "a")->storage.file.offset,
+            Lookup(index, "b")->storage.file.offset);
+  iree_io_parameter_index_release(index);
+}
+
+TEST_F(IrpaBuilderTest, Deduplicate) {
+  iree_io_parameter_archive_build_options_t options;
+  iree_io_parameter_archive_build_options_initialize(&options);
+  options.flags |= IREE_IO_PARAMETER_ARCHIVE_BUILD_FLAG_DEDUPLICATE;
+  options.data_alignment = 4096;
+  TargetArchive archive;
+  iree_io_parameter_index_t* index = NULL;
+  BuildAndParse(options, &archive, &index);
+  ASSERT_EQ(5, iree_io_parameter_index_count(index));
+  for (const char* key : {"a", "b", "c", "d", "e"}) {
+    EXPECT_TRUE(ContentsMatch(index, &archive, key)) << key;
+    EXPECT_EQ(0, Lookup(index, key)->storage.file.offset % 4096) << key;
+  }
+  const uint64_t a_offset = Lookup(index, "a")->storage.file.offset;
+  EXPECT_EQ(a_offset, Lookup(index, "b")->storage.file.offset);
+  EXPECT_EQ(a_offset, Lookup(index, "e")->storage.file.offset);
+  EXPECT_NE(a_offset, Lookup(index, "c")->storage.file.offset);
+  iree_io_parameter_index_release(index);
+}
+
+TEST_F(IrpaBuilderTest, Checksum) {
+  iree_io_parameter_archive_build_options_t options;
+  iree_io_parameter_archive_build_options_initialize(&options);
+  options.flags |= IREE_IO_PARAMETER_ARCHIVE_BUILD_FLAG_CHECKSUM;
+  TargetArchive archive;
+  iree_io_parameter_index_t* index = NULL;
+  BuildAndParse(options, &archive, &index);
+  ASSERT_EQ(5, iree_io_parameter_index_count(index));
+  for (const char* key : {"a", "b", "c", "d", "e"}) {
+    const iree_io_parameter_index_entry_t* entry = Lookup(index, key);
+    EXPECT_TRUE(ContentsMatch(index, &archive, key)) << key;
+    EXPECT_EQ(IREE_IO_CHECKSUM_TYPE_XXH64, entry->checksum.type) << key;
+    IREE_EXPECT_OK(
+        iree_io_parameter_index_entry_verify(entry, iree_allocator_system()));
+  }
+
+  // Corrupt the stored contents and ensure verification catches it.
+  const iree_io_parameter_index_entry_t* entry = Lookup(index, "d");
+  archive.storage[entry->storage.file.offset + 7] ^= 0x01;
+  iree_status_t status =
+      iree_io_parameter_index_entry_verify(entry, iree_allocator_system());
+  IREE_EXPECT_STATUS_IS(IREE_STATUS_DATA_LOSS, status);
+  iree_status_free(status);
+  iree_io_parameter_index_release(index);
+}
+
+TEST_F(IrpaBuilderTest, VerifyDeduplicatedStorageOnce) {
+  iree_io_parameter_archive_build_options_t options;
+  iree_io_parameter_archive_build_options_initialize(&options);
+  options.flags |= IREE_IO_PARAMETER_ARCHIVE_BUILD_FLAG_DEDUPLICATE |
+                   IREE_IO_PARAMETER_ARCHIVE_BUILD_FLAG_CHECKSUM;
+  TargetArchive archive;
+  iree_io_parameter_index_t* index = NULL;
+  BuildAndParse(options, &archive, &index);
+  ASSERT_EQ(5, iree_io_parameter_index_count(index));
+  IREE_EXPECT_OK(iree_io_parameter_index_verify(index, Lookup(index, "a"),
+                                                iree_allocator_system()));
+
+  // Corrupt the shared storage after verifying it: aliases of the verified
+  // entry are not read again while unverified entries are.
+  const iree_io_parameter_index_entry_t* entry = Lookup(index, "a");
+  archive.storage[entry->storage.file.offset + 7] ^= 0x01;
+  for (const char* key : {"a", "b", "e"}) {
+    IREE_EXPECT_OK(iree_io_parameter_index_verify(index, Lookup(index, key),
+                                                  iree_allocator_system()))
+        << key;
+  }
+  IREE_EXPECT_OK(iree_io_parameter_index_verify(index, Lookup(index, "c"),
+                                                iree_allocator_system()));
+
+  // Failures are reported on every call.
+  entry = Lookup(index, "d");
+  archive.storage[entry->storage.file.offset + 7] ^= 0x01;
+  for (int i = 0; i < 2; ++i) {
+    iree_status_t status =
+        iree_io_parameter_index_verify(index, entry, iree_allocator_system());
+    IREE_EXPECT_STATUS_IS(IREE_STATUS_DATA_LOSS, status);
+    iree_status_free(status);
+  }
+  iree_io_parameter_index_release(index);
+}
+
+}  // namespace
+}  // namespace iree
@@ -150,7 +150,27 @@ static iree_status_t iree_io_parse_irpa_v0_data_entry(
                       .offset = storage_offset,
                   },
           },
+      .checksum = iree_io_checksum_none(),
   };
+  if (iree_all_bits_set(
+          data_entry->header.flags,
+          IREE_IO_PARAMETER_ARCHIVE_DATA_ENTRY_FLAG_HAS_CHECKSUM)) {
+    if (data_entry->header.entry_size <
+        sizeof(*data_entry) + sizeof(iree_io_parameter_archive_checksum_t)) {
+      return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                              "data entry checksum length underflow");
+    }
+    const iree_io_parameter_archive_checksum_t* checksum =
+        (const iree_io_parameter_archive_checksum_t*)((const uint8_t*)
+                                                          data_entry +
+                                                      sizeof(*data_entry));
+    // Checksums of unknown types are ignored so that newer archives can still
+    // be loaded; they just won't be verifiable.
+    if (checksum->type == IREE_IO_PARAMETER_ARCHIVE_CHECKSUM_TYPE_XXH64) {
+      entry.checksum.type = IREE_IO_CHECKSUM_TYPE_XXH64;
+      entry.checksum.value = checksum->value;
+    }
+  }
   return iree_io_parameter_index_add(index, &entry);
 }
 
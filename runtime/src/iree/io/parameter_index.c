@@ -9,6 +9,55 @@
 #include "iree/base/internal/atomics.h"
 #include "iree/base/internal/synchronization.h"
 
+IREE_API_EXPORT iree_status_t iree_io_parameter_index_entry_verify(
+    const iree_io_parameter_index_entry_t* entry,
+    iree_allocator_t host_allocator) {
+  IREE_ASSERT_ARGUMENT(entry);
+  if (entry->type != IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_FILE ||
+      !iree_io_checksum_is_present(entry->checksum)) {
+    return iree_ok_status();
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_TEXT(z0, entry->key.data, entry->key.size);
+
+  iree_io_checksum_t checksum = iree_io_checksum_none();
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_io_checksum_file_range(
+              entry->checksum.type, entry->storage.file.handle,
+              entry->storage.file.offset, entry->length, host_allocator,
+              &checksum));
+  iree_status_t status = iree_ok_status();
+  if (checksum.value != entry->checksum.value) {
+    status = iree_make_status(
+        IREE_STATUS_DATA_LOSS,
+        "parameter '%.*s' contents are corrupt; checksum 0x%016" PRIx64
+        " does not match expected 0x%016" PRIx64,
+        (int)entry->key.size, entry->key.data, checksum.value,
+        entry->checksum.value);
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+//===----------------------------------------------------------------------===//
+// iree_io_parameter_index_t
+//===----------------------------------------------------------------------===//
+
+// Index-owned storage of an entry. Entries returned from the index point at
+// the |entry| field.
+typedef struct iree_io_parameter_index_record_t {
+  // Public entry; must be first so that entries can be cast to records.
+  iree_io_parameter_index_entry_t entry;
+  // Record holding the verification state of the storage range and checksum
+  // of the entry. This is the first record added with a matching range (such
+  // as the original of deduplicated parameters) and may be this record.
+  struct iree_io_parameter_index_record_t* storage_record;
+  // Nonzero once the contents of the storage range have been verified against
+  // the checksum. Only used on storage records.
+  iree_atomic_int32_t verified;
+} iree_io_parameter_index_record_t;
+
 struct iree_io_parameter_index_t {
   iree_atomic_ref_count_t ref_count;
   iree_allocator_t host_allocator;
@@ -23,7 +72,14 @@ struct iree_io_parameter_index_t {
   // Currently used entry count in elements.
   iree_host_size_t entry_count;
   // Dense list of entries in the index. Grows as needed.
-  iree_io_parameter_index_entry_t** entries;
+  iree_io_parameter_index_record_t** entries;
+
+  // Open-addressed hash set of storage records keyed by the storage range and
+  // checksum of file entries with checksums. Used to share verification state
+  // across entries aliasing the same storage. Capacity is a power of two.
+  iree_host_size_t storage_slot_capacity;
+  iree_host_size_t storage_slot_count;
+  iree_io_parameter_index_record_t** storage_slots;
 };
 
 IREE_API_EXPORT iree_status_t iree_io_parameter_index_create(
@@ -46,6 +102,9 @@ IREE_API_EXPORT iree_status_t iree_io_parameter_index_create(
   index->entry_capacity = 0;
   index->entry_count = 0;
   index->entries = NULL;
+  index->storage_slot_capacity = 0;
+  index->storage_slot_count = 0;
+  index->storage_slots = NULL;
 
   *out_index = index;
   IREE_TRACE_ZONE_END(z0);
@@ -58,19 +117,20 @@ static void iree_io_parameter_index_destroy(iree_io_parameter_index_t* index) {
   iree_allocator_t host_allocator = index->host_allocator;
 
   for (iree_host_size_t i = 0; i < index->entry_count; ++i) {
-    iree_io_parameter_index_entry_t* entry = index->entries[i];
-    switch (entry->type) {
+    iree_io_parameter_index_record_t* record = index->entries[i];
+    switch (record->entry.type) {
       default:
         break;
       case IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_FILE:
-        iree_io_file_handle_release(entry->storage.file.handle);
+        iree_io_file_handle_release(record->entry.storage.file.handle);
         break;
     }
-    iree_allocator_free(host_allocator, entry);
+    iree_allocator_free(host_allocator, record);
   }
   if (index->entries) {
     iree_allocator_free(host_allocator, index->entries);
   }
+  iree_allocator_free(host_allocator, index->storage_slots);
 
   iree_slim_mutex_deinitialize(&index->mutex);
 
@@ -109,7 +169,7 @@ static iree_status_t iree_io_parameter_index_reserve_unsafe(
   IREE_TRACE_ZONE_BEGIN(z0);
   IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, new_capacity);
 
-  iree_io_parameter_index_entry_t** new_entries = index->entries;
+  iree_io_parameter_index_record_t** new_entries = index->entries;
   iree_status_t status = iree_allocator_realloc(
       index->host_allocator, new_capacity * sizeof(index->entries[0]),
       (void**)&new_entries);
@@ -132,6 +192,74 @@ IREE_API_EXPORT iree_status_t iree_io_parameter_index_reserve(
   return status;
 }
 
+// Returns true if verification of |entry| can be shared by entries aliasing
+// its storage range.
+static bool iree_io_parameter_index_entry_has_verifiable_storage(
+    const iree_io_parameter_index_entry_t* entry) {
+  return entry->type == IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_FILE &&
+         iree_io_checksum_is_present(entry->checksum);
+}
+
+static bool iree_io_parameter_index_entry_storage_equal(
+    const iree_io_parameter_index_entry_t* lhs,
+    const iree_io_parameter_index_entry_t* rhs) {
+  return lhs->storage.file.handle == rhs->storage.file.handle &&
+         lhs->storage.file.offset == rhs->storage.file.offset &&
+         lhs->length == rhs->length &&
+         lhs->checksum.type == rhs->checksum.type &&
+         lhs->checksum.value == rhs->checksum.value;
+}
+
+static iree_host_size_t iree_io_parameter_index_entry_storage_hash(
+    const iree_io_parameter_index_entry_t* entry) {
+  uint64_t hash = (uint64_t)(uintptr_t)entry->storage.file.handle;
+  hash = (hash ^ entry->storage.file.offset) * 0x9E3779B97F4A7C15ull;
+  hash = (hash ^ entry->length) * 0x9E3779B97F4A7C15ull;
+  hash ^= entry->checksum.value;
+  return (iree_host_size_t)(hash ^ (hash >> 32));
+}
+
+// Returns the slot in |slots| holding the storage record matching |entry| or
+// the empty slot where it would be inserted.
+static iree_io_parameter_index_record_t** iree_io_parameter_index_find_storage(
+    iree_io_parameter_index_record_t** slots, iree_host_size_t capacity,
+    const iree_io_parameter_index_entry_t* entry) {
+  const iree_host_size_t mask = capacity - 1;
+  iree_host_size_t i = iree_io_parameter_index_entry_storage_hash(entry) & mask;
+  while (slots[i]) {
+    if (iree_io_parameter_index_entry_storage_equal(&slots[i]->entry, entry)) {
+      break;
+    }
+    i = (i + 1) & mask;
+  }
+  return &slots[i];
+}
+
+// Ensures the storage set has room for one more record.
+static iree_status_t iree_io_parameter_index_reserve_storage_unsafe(
+    iree_io_parameter_index_t* index) {
+  // Kept at most half full so probe sequences stay short.
+  if ((index->storage_slot_count + 1) * 2 <= index->storage_slot_capacity) {
+    return iree_ok_status();
+  }
+  const iree_host_size_t new_capacity =
+      iree_max(32, index->storage_slot_capacity * 2);
+  iree_io_parameter_index_record_t** new_slots = NULL;
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(
+      index->host_allocator, new_capacity * sizeof(new_slots[0]),
+      (void**)&new_slots));
+  for (iree_host_size_t i = 0; i < index->storage_slot_capacity; ++i) {
+    iree_io_parameter_index_record_t* record = index->storage_slots[i];
+    if (!record) continue;
+    *iree_io_parameter_index_find_storage(new_slots, new_capacity,
+                                          &record->entry) = record;
+  }
+  iree_allocator_free(index->host_allocator, index->storage_slots);
+  index->storage_slot_capacity = new_capacity;
+  index->storage_slots = new_slots;
+  return iree_ok_status();
+}
+
 IREE_API_EXPORT iree_status_t
 iree_io_parameter_index_add(iree_io_parameter_index_t* index,
                             const iree_io_parameter_index_entry_t* entry) {
@@ -147,20 +275,26 @@ iree_io_parameter_index_add(iree_io_parameter_index_t* index,
     status = iree_io_parameter_index_reserve_unsafe(
         index, iree_max(16, index->entry_capacity * 2));
   }
+  const bool has_verifiable_storage =
+      iree_io_parameter_index_entry_has_verifiable_storage(entry);
+  if (iree_status_is_ok(status) && has_verifiable_storage) {
+    status = iree_io_parameter_index_reserve_storage_unsafe(index);
+  }
 
   // Clone the entry memory. We allocate it as a single slab and stash the
   // pointers for easier access by callers. Entries themselves are never
   // reallocated so the pointers are safe to embed.
-  iree_io_parameter_index_entry_t* cloned_entry = NULL;
+  iree_io_parameter_index_record_t* record = NULL;
   if (iree_status_is_ok(status)) {
     iree_host_size_t total_size =
-        sizeof(*cloned_entry) + entry->key.size + entry->metadata.data_length;
+        sizeof(*record) + entry->key.size + entry->metadata.data_length;
     status = iree_allocator_malloc(index->host_allocator, total_size,
-                                   (void**)&cloned_entry);
+                                   (void**)&record);
   }
   if (iree_status_is_ok(status)) {
-    cloned_entry->key = iree_make_string_view(
-        (char*)cloned_entry + sizeof(*cloned_entry), entry->key.size);
+    iree_io_parameter_index_entry_t* cloned_entry = &record->entry;
+    cloned_entry->key = iree_make_string_view((char*)record + sizeof(*record),
+                                              entry->key.size);
     cloned_entry->metadata =
         iree_const_byte_span_is_empty(entry->metadata)
             ? iree_const_byte_span_empty()
@@ -169,6 +303,7 @@ iree_io_parameter_index_add(iree_io_parameter_index_t* index,
                   entry->metadata.data_length);
     cloned_entry->length = entry->length;
     cloned_entry->type = entry->type;
+    cloned_entry->checksum = entry->checksum;
     switch (entry->type) {
       default:
         break;
@@ -184,8 +319,23 @@ iree_io_parameter_index_add(iree_io_parameter_index_t* index,
     memcpy((void*)cloned_entry->metadata.data, entry->metadata.data,
            entry->metadata.data_length);
 
+    // Entries aliasing the storage of an existing entry share its
+    // verification state.
+    record->storage_record = record;
+    if (has_verifiable_storage) {
+      iree_io_parameter_index_record_t** slot =
+          iree_io_parameter_index_find_storage(
+              index->storage_slots, index->storage_slot_capacity, cloned_entry);
+      if (*slot) {
+        record->storage_record = *slot;
+      } else {
+        *slot = record;
+        ++index->storage_slot_count;
+      }
+    }
+
     // Append the entry to the file index.
-    index->entries[index->entry_count++] = cloned_entry;
+    index->entries[index->entry_count++] = record;
   }
 
   iree_slim_mutex_unlock(&index->mutex);
@@ -203,7 +353,7 @@ IREE_API_EXPORT iree_status_t iree_io_parameter_index_get(
 
   iree_status_t status = iree_ok_status();
   if (i < index->entry_count) {
-    *out_entry = index->entries[i];
+    *out_entry = &index->entries[i]->entry;
   } else {
     status = iree_make_status(IREE_STATUS_OUT_OF_RANGE,
                               "entry %" PRIhsz " out of range (have %" PRIhsz
@@ -227,7 +377,7 @@ IREE_API_EXPORT iree_status_t iree_io_parameter_index_lookup(
 
   iree_status_t status = iree_ok_status();
   for (iree_host_size_t i = 0; i < index->entry_count; ++i) {
-    const iree_io_parameter_index_entry_t* entry = index->entries[i];
+    const iree_io_parameter_index_entry_t* entry = &index->entries[i]->entry;
     if (iree_string_view_equal(key, entry->key)) {
       *out_entry = entry;
       break;
@@ -244,6 +394,30 @@ IREE_API_EXPORT iree_status_t iree_io_parameter_index_lookup(
   return status;
 }
 
+IREE_API_EXPORT iree_status_t iree_io_parameter_index_verify(
+    iree_io_parameter_index_t* index,
+    const iree_io_parameter_index_entry_t* entry,
+    iree_allocator_t host_allocator) {
+  IREE_ASSERT_ARGUMENT(index);
+  IREE_ASSERT_ARGUMENT(entry);
+  if (!iree_io_parameter_index_entry_has_verifiable_storage(entry)) {
+    return iree_ok_status();
+  }
+  iree_io_parameter_index_record_t* storage_record =
+      ((const iree_io_parameter_index_record_t*)entry)->storage_record;
+  if (iree_atomic_load(&storage_record->verified, iree_memory_order_acquire)) {
+    return iree_ok_status();
+  }
+
+  // Verification happens without synchronization so that concurrent first
+  // reads of different parameters are not serialized; racing first reads of
+  // the same storage may each verify it.
+  IREE_RETURN_IF_ERROR(
+      iree_io_parameter_index_entry_verify(entry, host_allocator));
+  iree_atomic_store(&storage_record->verified, 1, iree_memory_order_release);
+  return iree_ok_status();
+}
+
 IREE_API_EXPORT iree_status_t iree_io_parameter_index_dump(
     iree_string_view_t scope, iree_io_parameter_index_t* index,
     iree_string_builder_t* builder) {
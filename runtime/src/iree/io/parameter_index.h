@@ -8,6 +8,7 @@
 #define IREE_IO_PARAMETER_INDEX_H_
 
 #include "iree/base/api.h"
+#include "iree/io/checksum.h"
 #include "iree/io/file_handle.h"
 
 #ifdef __cplusplus
@@ -65,8 +66,21 @@ typedef struct iree_io_parameter_index_entry_t {
       uint64_t offset;
     } file;
   } storage;
+  // Optional checksum of the stored contents of a file-backed parameter.
+  // Checksums are not verified when the entry is used unless requested.
+  // See iree_io_parameter_index_entry_verify and
+  // iree_io_parameter_index_verify.
+  iree_io_checksum_t checksum;
 } iree_io_parameter_index_entry_t;
 
+// Verifies the stored contents of |entry| match its checksum (if any).
+// The full contents of the entry are read from its backing file. Returns
+// IREE_STATUS_DATA_LOSS if the contents do not match. Entries without a
+// checksum and splat entries always verify.
+IREE_API_EXPORT iree_status_t iree_io_parameter_index_entry_verify(
+    const iree_io_parameter_index_entry_t* entry,
+    iree_allocator_t host_allocator);
+
 // An in-memory file index mapping keys to byte ranges in referenced files.
 // A single index may contain entries from multiple files. Each parameter is
 // backed by a contiguous range in a single file.
@@ -120,6 +134,16 @@ IREE_API_EXPORT iree_status_t iree_io_parameter_index_lookup(
     iree_io_parameter_index_t* index, iree_string_view_t key,
     const iree_io_parameter_index_entry_t** out_entry);
 
+// Verifies the stored contents of |entry| from |index| match its checksum as
+// with iree_io_parameter_index_entry_verify. Successful verification is
+// recorded for the storage range of the entry and the range is not read again
+// for this or any other entry in |index| aliasing it (such as deduplicated
+// parameters). Failures are not recorded and are reported on each call.
+IREE_API_EXPORT iree_status_t iree_io_parameter_index_verify(
+    iree_io_parameter_index_t* index,
+    const iree_io_parameter_index_entry_t* entry,
+    iree_allocator_t host_allocator);
+
 // Formats a textual dump of the parameter |index| to |builder|.
 // An optional |scope| name can be provided to include in the dump.
 IREE_API_EXPORT iree_status_t iree_io_parameter_index_dump(
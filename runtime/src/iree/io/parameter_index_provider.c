@@ -6,6 +6,7 @@
 
 #include "iree/io/parameter_index_provider.h"
 
+#include "iree/base/internal/synchronization.h"
 #include "iree/hal/utils/file_cache.h"
 
 // Limit concurrent operations to avoid blowing the stack. This is arbitrary and
@@ -16,10 +17,16 @@
 typedef struct iree_io_parameter_index_provider_t {
   iree_io_parameter_provider_t base;
   iree_allocator_t host_allocator;
+  iree_io_parameter_index_provider_flags_t flags;
   iree_host_size_t max_concurrent_operations;
+  iree_io_direct_loader_options_t direct_loader_options;
   iree_string_view_t scope;
   iree_io_parameter_index_t* index;
   iree_hal_file_cache_t* file_cache;
+  // Guards direct_io_statistics as operations may run concurrently.
+  iree_slim_mutex_t statistics_mutex;
+  // Statistics accumulated over all direct I/O loader flushes.
+  iree_io_direct_loader_statistics_t direct_io_statistics;
 } iree_io_parameter_index_provider_t;
 
 static const iree_io_parameter_provider_vtable_t
@@ -31,18 +38,40 @@ iree_io_parameter_index_provider_cast(
   return (iree_io_parameter_index_provider_t*)base_provider;
 }
 
+IREE_API_EXPORT void iree_io_parameter_index_provider_options_initialize(
+    iree_io_parameter_index_provider_options_t* out_options) {
+  IREE_ASSERT_ARGUMENT(out_options);
+  memset(out_options, 0, sizeof(*out_options));
+  out_options->max_concurrent_operations =
+      IREE_IO_PARAMETER_INDEX_PROVIDER_DEFAULT_MAX_CONCURRENT_OPERATIONS;
+}
+
 IREE_API_EXPORT iree_status_t iree_io_parameter_index_provider_create(
     iree_string_view_t scope, iree_io_parameter_index_t* index,
     iree_host_size_t max_concurrent_operations, iree_allocator_t host_allocator,
     iree_io_parameter_provider_t** out_provider) {
+  iree_io_parameter_index_provider_options_t options;
+  iree_io_parameter_index_provider_options_initialize(&options);
+  options.max_concurrent_operations = max_concurrent_operations;
+  return iree_io_parameter_index_provider_create_with_options(
+      scope, index, &options, host_allocator, out_provider);
+}
+
+IREE_API_EXPORT iree_status_t
+iree_io_parameter_index_provider_create_with_options(
+    iree_string_view_t scope, iree_io_parameter_index_t* index,
+    const iree_io_parameter_index_provider_options_t* options,
+    iree_allocator_t host_allocator,
+    iree_io_parameter_provider_t** out_provider) {
   IREE_ASSERT_ARGUMENT(index);
+  IREE_ASSERT_ARGUMENT(options);
   IREE_ASSERT_ARGUMENT(out_provider);
   *out_provider = NULL;
   IREE_TRACE_ZONE_BEGIN(z0);
   IREE_TRACE_ZONE_APPEND_TEXT(z0, scope.data, scope.size);
 
-  max_concurrent_operations =
-      iree_max(1, iree_min(max_concurrent_operations,
+  const iree_host_size_t max_concurrent_operations =
+      iree_max(1, iree_min(options->max_concurrent_operations,
                            IREE_IO_PARAMETER_OP_BATCH_MAX_CONCURRENCY));
 
   iree_io_parameter_index_provider_t* provider = NULL;
@@ -52,7 +81,10 @@ IREE_API_EXPORT iree_status_t iree_io_parameter_index_provider_create(
   iree_atomic_ref_count_init(&provider->base.ref_count);
   provider->base.vtable = &iree_io_parameter_index_provider_vtable;
   provider->host_allocator = host_allocator;
+  provider->flags = options->flags;
   provider->max_concurrent_operations = max_concurrent_operations;
+  provider->direct_loader_options = options->direct_loader;
+  iree_slim_mutex_initialize(&provider->statistics_mutex);
 
   provider->scope = iree_make_string_view(
       (const char*)provider + sizeof(*provider), scope.size);
@@ -82,12 +114,32 @@ static void iree_io_parameter_index_provider_destroy(
 
   iree_hal_file_cache_release(provider->file_cache);
   iree_io_parameter_index_release(provider->index);
+  iree_slim_mutex_deinitialize(&provider->statistics_mutex);
 
   iree_allocator_free(host_allocator, provider);
 
   IREE_TRACE_ZONE_END(z0);
 }
 
+IREE_API_EXPORT iree_status_t
+iree_io_parameter_index_provider_query_direct_io_statistics(
+    iree_io_parameter_provider_t* base_provider,
+    iree_io_direct_loader_statistics_t* out_statistics) {
+  IREE_ASSERT_ARGUMENT(base_provider);
+  IREE_ASSERT_ARGUMENT(out_statistics);
+  memset(out_statistics, 0, sizeof(*out_statistics));
+  if (base_provider->vtable != &iree_io_parameter_index_provider_vtable) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "provider is not a parameter index provider");
+  }
+  iree_io_parameter_index_provider_t* provider =
+      iree_io_parameter_index_provider_cast(base_provider);
+  iree_slim_mutex_lock(&provider->statistics_mutex);
+  *out_statistics = provider->direct_io_statistics;
+  iree_slim_mutex_unlock(&provider->statistics_mutex);
+  return iree_ok_status();
+}
+
 static iree_status_t iree_io_parameter_index_provider_notify(
     iree_io_parameter_provider_t* base_provider,
     iree_io_parameter_provider_signal_t signal) {
@@ -137,6 +189,17 @@ static iree_status_t iree_io_parameter_index_provider_resolve(
   IREE_RETURN_AND_END_ZONE_IF_ERROR(
       z0, iree_io_parameter_index_lookup(provider->index, key, &entry));
 
+  // Verify the parameter contents on first read if requested. The index
+  // records the result so only the first read of each storage range pays.
+  const bool verify_checksums = iree_all_bits_set(
+      provider->flags, IREE_IO_PARAMETER_INDEX_PROVIDER_FLAG_VERIFY_CHECKSUMS);
+  if (verify_checksums &&
+      !iree_any_bit_set(access, IREE_HAL_MEMORY_ACCESS_WRITE)) {
+    IREE_RETURN_AND_END_ZONE_IF_ERROR(
+        z0, iree_io_parameter_index_verify(provider->index, entry,
+                                           provider->host_allocator));
+  }
+
   // Get (or import) the HAL file backing the entry.
   // NOTE: file is retained!
   iree_hal_file_t* file = NULL;
@@ -248,6 +311,11 @@ typedef struct iree_io_parameter_op_batch_t {
   // Semaphores that must be signaled after all operations complete.
   iree_hal_semaphore_list_t signal_semaphore_list;
 
+  // True if file reads may be routed to the direct loader. Only set when the
+  // provider has IREE_IO_PARAMETER_INDEX_PROVIDER_FLAG_DIRECT_IO and the wait
+  // semaphores had been reached when the batch began.
+  bool use_direct_io;
+
   // Number of concurrent timelines available for processing the batch.
   // Expects 0 < concurrency <= IREE_IO_PARAMETER_OP_BATCH_MAX_CONCURRENCY.
   // Not all timelines may be used and timeline_live_count should be checked to
@@ -276,6 +344,12 @@ typedef struct iree_io_parameter_op_batch_t {
   // operations to be cheaper than file I/O operations but are not trying to be
   // precise here.
   uint64_t transfer_bytes_outstanding;
+
+  // On-demand allocated loader used for direct I/O reads when the provider has
+  // IREE_IO_PARAMETER_INDEX_PROVIDER_FLAG_DIRECT_IO set. All reads are
+  // performed when the batch is flushed after all other operations have been
+  // enqueued.
+  iree_io_direct_loader_t* direct_loader;
 } iree_io_parameter_op_batch_t;
 
 // Begins a parameter operation batch against the given |provider|.
@@ -304,6 +378,18 @@ static void iree_io_parameter_op_batch_begin(
   out_batch->wait_semaphore_list = wait_semaphore_list;
   out_batch->signal_semaphore_list = signal_semaphore_list;
 
+  // Direct reads are performed synchronously by the calling thread. If the
+  // wait semaphores have not been reached they may only be signaled by the
+  // caller after this operation returns and blocking on them would deadlock;
+  // in that case reads are issued as asynchronous queue operations instead.
+  if (iree_all_bits_set(provider->flags,
+                        IREE_IO_PARAMETER_INDEX_PROVIDER_FLAG_DIRECT_IO)) {
+    iree_status_t wait_status = iree_hal_semaphore_list_wait(
+        wait_semaphore_list, iree_immediate_timeout());
+    out_batch->use_direct_io = iree_status_is_ok(wait_status);
+    iree_status_ignore(wait_status);
+  }
+
   // We could limit the concurrency from the max based on the batch size but
   // since the compiler batches everything and most models go over the default
   // max concurrency this is fine for now.
@@ -542,6 +628,81 @@ static iree_status_t iree_io_parameter_op_batch_enqueue_file_read(
   return status;
 }
 
+// Returns true if reads from |entry| should be routed to the direct loader.
+static bool iree_io_parameter_op_batch_use_direct_read(
+    const iree_io_parameter_op_batch_t* batch,
+    const iree_io_parameter_index_entry_t* entry) {
+  return batch->use_direct_io &&
+         entry->type == IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_FILE &&
+         iree_io_file_handle_type(entry->storage.file.handle) ==
+             IREE_IO_FILE_HANDLE_TYPE_FD;
+}
+
+// Enqueues a direct file read operation in the batch. The read is deferred
+// until the batch is flushed so that all reads in the batch can be ordered.
+// The |target_buffer| must be ready for use by the time all timelines in the
+// batch have completed.
+static iree_status_t iree_io_parameter_op_batch_enqueue_direct_read(
+    iree_io_parameter_op_batch_t* batch, iree_io_file_handle_t* source_file,
+    uint64_t source_file_offset, iree_hal_buffer_t* target_buffer,
+    iree_device_size_t target_buffer_offset, iree_device_size_t length) {
+  IREE_ASSERT_ARGUMENT(batch);
+  IREE_ASSERT_ARGUMENT(source_file);
+  IREE_ASSERT_ARGUMENT(target_buffer);
+  if (!batch->direct_loader) {
+    IREE_RETURN_IF_ERROR(iree_io_direct_loader_allocate(
+        batch->device, batch->queue_affinity,
+        batch->provider->direct_loader_options,
+        batch->provider->host_allocator, &batch->direct_loader));
+  }
+  return iree_io_direct_loader_enqueue_read(
+      batch->direct_loader, source_file, source_file_offset, target_buffer,
+      target_buffer_offset, length);
+}
+
+// Flushes all direct reads in the batch and signals the user timeline.
+// All other batch operations must have been enqueued as the loader waits for
+// all live timelines before reading.
+static iree_status_t iree_io_parameter_op_batch_flush_direct_reads(
+    iree_io_parameter_op_batch_t* batch) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // The target buffers must be allocated before the loader copies into them.
+  // Direct reads are only used when the user wait list had been reached when
+  // the batch began so the timelines only depend on operations that have
+  // already been enqueued and waiting on them cannot deadlock.
+  iree_status_t status = iree_ok_status();
+  if (batch->timeline_live_count > 0) {
+    iree_hal_semaphore_list_t timeline_semaphore_list = {
+        .count = batch->timeline_live_count,
+        .semaphores = batch->timeline_semaphores,
+        .payload_values = batch->timeline_values,
+    };
+    IREE_TRACE_ZONE_BEGIN_NAMED(z_wait, "iree_io_parameter_op_batch_wait");
+    status = iree_hal_semaphore_list_wait(timeline_semaphore_list,
+                                          iree_infinite_timeout());
+    IREE_TRACE_ZONE_END(z_wait);
+  }
+
+  iree_io_direct_loader_statistics_t statistics;
+  memset(&statistics, 0, sizeof(statistics));
+  if (iree_status_is_ok(status)) {
+    status = iree_io_direct_loader_flush(
+        batch->direct_loader, batch->wait_semaphore_list,
+        batch->signal_semaphore_list, &statistics);
+  }
+
+  iree_io_parameter_index_provider_t* provider = batch->provider;
+  iree_slim_mutex_lock(&provider->statistics_mutex);
+  iree_io_direct_loader_statistics_accumulate(
+      &statistics, &provider->direct_io_statistics);
+  iree_slim_mutex_unlock(&provider->statistics_mutex);
+
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, statistics.bytes_read);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
 // Enqueues a file write operation in the batch.
 static iree_status_t iree_io_parameter_op_batch_enqueue_file_write(
     iree_io_parameter_op_batch_t* batch, iree_hal_buffer_t* source_buffer,
@@ -599,7 +760,12 @@ static iree_status_t iree_io_parameter_op_batch_flush(
   }
 
   // Join all concurrent timelines and continue the user-provided timeline.
-  if (iree_status_is_ok(status)) {
+  if (iree_status_is_ok(status) && batch->direct_loader &&
+      iree_io_direct_loader_pending_count(batch->direct_loader) > 0) {
+    // Direct reads join all timelines themselves.
+    IREE_TRACE_ZONE_APPEND_TEXT(z0, "direct read join");
+    status = iree_io_parameter_op_batch_flush_direct_reads(batch);
+  } else if (iree_status_is_ok(status)) {
     // If no queue operations were performed (all load imports, 0 entries, etc)
     // we need to issue a barrier to link the wait->signal semaphore lists.
     if (batch->timeline_live_count == 0) {
@@ -667,6 +833,7 @@ static iree_status_t iree_io_parameter_op_batch_end(
     iree_hal_semaphore_release(batch->timeline_semaphores[i]);
   }
   iree_hal_command_buffer_release(batch->transfer_command_buffer);
+  iree_io_direct_loader_free(batch->direct_loader);
 
   IREE_TRACE_ZONE_END(z0);
   return status;
@@ -794,10 +961,18 @@ static iree_status_t iree_io_parameter_index_provider_load(
           }
           case IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_FILE: {
             IREE_ASSERT(source_file);
-            status = iree_io_parameter_op_batch_enqueue_file_read(
-                &batch, source_file,
-                source_entry->storage.file.offset + span.parameter_offset,
-                target_buffer, span.buffer_offset, span.length, 0);
+            if (iree_io_parameter_op_batch_use_direct_read(&batch,
+                                                           source_entry)) {
+              status = iree_io_parameter_op_batch_enqueue_direct_read(
+                  &batch, source_entry->storage.file.handle,
+                  source_entry->storage.file.offset + span.parameter_offset,
+                  target_buffer, span.buffer_offset, span.length);
+            } else {
+              status = iree_io_parameter_op_batch_enqueue_file_read(
+                  &batch, source_file,
+                  source_entry->storage.file.offset + span.parameter_offset,
+                  target_buffer, span.buffer_offset, span.length, 0);
+            }
             break;
           }
           default: {
@@ -884,10 +1059,18 @@ static iree_status_t iree_io_parameter_index_provider_gather(
         }
         case IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_FILE: {
           IREE_ASSERT(source_file);
-          status = iree_io_parameter_op_batch_enqueue_file_read(
-              &batch, source_file,
-              source_entry->storage.file.offset + span.parameter_offset,
-              target_buffer, span.buffer_offset, span.length, 0);
+          if (iree_io_parameter_op_batch_use_direct_read(&batch,
+                                                         source_entry)) {
+            status = iree_io_parameter_op_batch_enqueue_direct_read(
+                &batch, source_entry->storage.file.handle,
+                source_entry->storage.file.offset + span.parameter_offset,
+                target_buffer, span.buffer_offset, span.length);
+          } else {
+            status = iree_io_parameter_op_batch_enqueue_file_read(
+                &batch, source_file,
+                source_entry->storage.file.offset + span.parameter_offset,
+                target_buffer, span.buffer_offset, span.length, 0);
+          }
           break;
         }
         default: {
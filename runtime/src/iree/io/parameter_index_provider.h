@@ -11,6 +11,7 @@
 
 #include "iree/base/api.h"
 #include "iree/hal/api.h"
+#include "iree/io/direct_loader.h"
 #include "iree/io/parameter_index.h"
 #include "iree/io/parameter_provider.h"
 
@@ -21,6 +22,43 @@ extern "C" {
 // Reasonable default for the `max_concurrent_operations` parameter.
 #define IREE_IO_PARAMETER_INDEX_PROVIDER_DEFAULT_MAX_CONCURRENT_OPERATIONS 16
 
+// Flags controlling parameter index provider behavior.
+typedef uint32_t iree_io_parameter_index_provider_flags_t;
+enum iree_io_parameter_index_provider_flag_bits_t {
+  IREE_IO_PARAMETER_INDEX_PROVIDER_FLAG_NONE = 0u,
+  // Loads and gathers from file descriptor-backed parameters are streamed
+  // through an iree_io_direct_loader_t instead of being issued as HAL queue
+  // file reads. Reads of all parameters in an operation are ordered by their
+  // file offset and performed with unbuffered direct I/O where supported so
+  // that cold loads are bound by storage bandwidth instead of the page cache.
+  // The thread issuing the operation blocks until all reads have completed.
+  // Direct I/O is only used by operations whose wait semaphores have been
+  // reached when the operation is issued; others use HAL queue file reads so
+  // that they do not block on timelines the caller advances afterward.
+  IREE_IO_PARAMETER_INDEX_PROVIDER_FLAG_DIRECT_IO = 1u << 0,
+  // File-backed parameters that carry a checksum have their contents verified
+  // the first time they are resolved for reading. Verification reads the
+  // entire parameter from its file on the calling thread and corrupt
+  // parameters fail with IREE_STATUS_DATA_LOSS. Each storage range is only
+  // verified once per index (see iree_io_parameter_index_verify).
+  IREE_IO_PARAMETER_INDEX_PROVIDER_FLAG_VERIFY_CHECKSUMS = 1u << 1,
+};
+
+// Options for parameter index providers.
+typedef struct iree_io_parameter_index_provider_options_t {
+  // Flags controlling provider behavior.
+  iree_io_parameter_index_provider_flags_t flags;
+  // Limits how many file operations as part of a gather or scatter are allowed
+  // to be in-flight at a time. See iree_io_parameter_index_provider_create.
+  iree_host_size_t max_concurrent_operations;
+  // Staging options used with IREE_IO_PARAMETER_INDEX_PROVIDER_FLAG_DIRECT_IO.
+  iree_io_direct_loader_options_t direct_loader;
+} iree_io_parameter_index_provider_options_t;
+
+// Initializes |out_options| to their defaults.
+IREE_API_EXPORT void iree_io_parameter_index_provider_options_initialize(
+    iree_io_parameter_index_provider_options_t* out_options);
+
 // Creates a parameter provider serving from the provided |index|.
 // As parameters are operated on their files will be registered with the devices
 // they are used on and cached for future requests.
@@ -35,6 +73,24 @@ IREE_API_EXPORT iree_status_t iree_io_parameter_index_provider_create(
     iree_host_size_t max_concurrent_operations, iree_allocator_t host_allocator,
     iree_io_parameter_provider_t** out_provider);
 
+// Creates a parameter provider serving from the provided |index| with the
+// given |options|. See iree_io_parameter_index_provider_create.
+IREE_API_EXPORT iree_status_t
+iree_io_parameter_index_provider_create_with_options(
+    iree_string_view_t scope, iree_io_parameter_index_t* index,
+    const iree_io_parameter_index_provider_options_t* options,
+    iree_allocator_t host_allocator,
+    iree_io_parameter_provider_t** out_provider);
+
+// Returns the statistics accumulated over all direct I/O loads performed by
+// |provider| when created with IREE_IO_PARAMETER_INDEX_PROVIDER_FLAG_DIRECT_IO.
+// iree_io_direct_loader_statistics_read_gbps can be used to derive the achieved
+// read throughput. Fails if |provider| is not a parameter index provider.
+IREE_API_EXPORT iree_status_t
+iree_io_parameter_index_provider_query_direct_io_statistics(
+    iree_io_parameter_provider_t* provider,
+    iree_io_direct_loader_statistics_t* out_statistics);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
@@ -0,0 +1,200 @@
+// Copyright 2025 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/io/parameter_index_provider.h"
+
+#include "iree/base/api.h"
+
+#if IREE_FILE_IO_ENABLE && !defined(IREE_PLATFORM_WINDOWS)
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <future>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "iree/hal/api.h"
+#include "iree/hal/drivers/local_sync/sync_device.h"
+#include "iree/io/file_handle.h"
+#include "iree/io/parameter_index.h"
+#include "iree/io/parameter_provider.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace iree {
+namespace io {
+namespace {
+
+constexpr iree_host_size_t kParameterLength = 64 * 1024;
+
+class ParameterIndexProviderTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    iree_allocator_t host_allocator = iree_allocator_system();
+    IREE_ASSERT_OK(iree_hal_allocator_create_heap(
+        IREE_SV("heap"), host_allocator, host_allocator, &device_allocator_));
+    iree_hal_sync_device_params_t params;
+    iree_hal_sync_device_params_initialize(&params);
+    IREE_ASSERT_OK(iree_hal_sync_device_create(
+        IREE_SV("sync"), &params, /*loader_count=*/0, /*loaders=*/NULL,
+        device_allocator_, host_allocator, &device_));
+
+    // Single parameter backed by a file descriptor so that it is eligible for
+    // direct I/O.
+    path_ = ::testing::TempDir() + "/iree_parameter_index_provider.bin";
+    contents_.resize(kParameterLength);
+    for (iree_host_size_t i = 0; i < contents_.size(); ++i) {
+      contents_[i] = static_cast<uint8_t>((i * 2654435761u) >> 13);
+    }
+    {
+      std::ofstream file(path_, std::ios::binary | std::ios::trunc);
+      file.write(reinterpret_cast<const char*>(contents_.data()),
+                 contents_.size());
+      ASSERT_TRUE(file.good());
+    }
+    iree_io_file_handle_t* file_handle = NULL;
+    IREE_ASSERT_OK(iree_io_file_handle_open(
+        IREE_IO_FILE_MODE_READ, iree_make_cstring_view(path_.c_str()),
+        host_allocator, &file_handle));
+    IREE_ASSERT_OK(iree_io_parameter_index_create(host_allocator, &index_));
+    iree_io_parameter_index_entry_t entry = {};
+    entry.key = IREE_SV("param");
+    entry.length = kParameterLength;
+    entry.type = IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_FILE;
+    entry.storage.file.handle = file_handle;
+    entry.storage.file.offset = 0;
+    iree_status_t status = iree_io_parameter_index_add(index_, &entry);
+    iree_io_file_handle_release(file_handle);
+    IREE_ASSERT_OK(status);
+
+    iree_io_parameter_index_provider_options_t options;
+    iree_io_parameter_index_provider_options_initialize(&options);
+    options.flags |= IREE_IO_PARAMETER_INDEX_PROVIDER_FLAG_DIRECT_IO;
+    IREE_ASSERT_OK(iree_io_parameter_index_provider_create_with_options(
+        IREE_SV("scope"), index_, &options, host_allocator, &provider_));
+
+    iree_hal_buffer_params_t buffer_params = {};
+    buffer_params.type =
+        IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL | IREE_HAL_MEMORY_TYPE_HOST_VISIBLE;
+    buffer_params.usage =
+        IREE_HAL_BUFFER_USAGE_DEFAULT | IREE_HAL_BUFFER_USAGE_MAPPING;
+    buffer_params.access = IREE_HAL_MEMORY_ACCESS_ALL;
+    IREE_ASSERT_OK(iree_hal_allocator_allocate_buffer(
+        device_allocator_, buffer_params, kParameterLength, &target_buffer_));
+    IREE_ASSERT_OK(
+        iree_hal_buffer_map_zero(target_buffer_, 0, kParameterLength));
+
+    IREE_ASSERT_OK(iree_hal_semaphore_create(
+        device_, 0ull, IREE_HAL_SEMAPHORE_FLAG_NONE, &wait_semaphore_));
+    IREE_ASSERT_OK(iree_hal_semaphore_create(
+        device_, 0ull, IREE_HAL_SEMAPHORE_FLAG_NONE, &signal_semaphore_));
+  }
+
+  void TearDown() override {
+    iree_hal_semaphore_release(signal_semaphore_);
+    iree_hal_semaphore_release(wait_semaphore_);
+    iree_hal_buffer_release(target_buffer_);
+    iree_io_parameter_provider_release(provider_);
+    iree_io_parameter_index_release(index_);
+    iree_hal_device_release(device_);
+    iree_hal_allocator_release(device_allocator_);
+    if (!path_.empty()) std::remove(path_.c_str());
+  }
+
+  // Gathers the parameter into the target buffer once |wait_semaphore_| has
+  // reached 1. |on_enumerate| is called after the operation has begun.
+  iree_status_t Gather(std::function<void()> on_enumerate) {
+    uint64_t wait_value = 1;
+    iree_hal_semaphore_list_t wait_semaphore_list = {
+        /*count=*/1,
+        /*semaphores=*/&wait_semaphore_,
+        /*payload_values=*/&wait_value,
+    };
+    uint64_t signal_value = 1;
+    iree_hal_semaphore_list_t signal_semaphore_list = {
+        /*count=*/1,
+        /*semaphores=*/&signal_semaphore_,
+        /*payload_values=*/&signal_value,
+    };
+    iree_io_parameter_enumerator_t enumerator = {
+        +[](void* user_data, iree_host_size_t i, iree_string_view_t* out_key,
+            iree_io_parameter_span_t* out_span) {
+          (*static_cast<std::function<void()>*>(user_data))();
+          *out_key = IREE_SV("param");
+          out_span->parameter_offset = 0;
+          out_span->buffer_offset = 0;
+          out_span->length = kParameterLength;
+          return iree_ok_status();
+        },
+        &on_enumerate,
+    };
+    return iree_io_parameter_provider_gather(
+        provider_, device_, IREE_HAL_QUEUE_AFFINITY_ANY, wait_semaphore_list,
+        signal_semaphore_list, IREE_SV("scope"), target_buffer_,
+        /*count=*/1, enumerator);
+  }
+
+  void ExpectTargetContents() {
+    IREE_ASSERT_OK(iree_hal_semaphore_wait(signal_semaphore_, 1ull,
+                                           iree_infinite_timeout()));
+    std::vector<uint8_t> data(kParameterLength);
+    IREE_ASSERT_OK(iree_hal_buffer_map_read(target_buffer_, 0, data.data(),
+                                            data.size()));
+    EXPECT_EQ(data, contents_);
+  }
+
+  iree_io_direct_loader_statistics_t QueryStatistics() {
+    iree_io_direct_loader_statistics_t statistics;
+    IREE_CHECK_OK(iree_io_parameter_index_provider_query_direct_io_statistics(
+        provider_, &statistics));
+    return statistics;
+  }
+
+  iree_hal_allocator_t* device_allocator_ = NULL;
+  iree_hal_device_t* device_ = NULL;
+  std::string path_;
+  std::vector<uint8_t> contents_;
+  iree_io_parameter_index_t* index_ = NULL;
+  iree_io_parameter_provider_t* provider_ = NULL;
+  iree_hal_buffer_t* target_buffer_ = NULL;
+  iree_hal_semaphore_t* wait_semaphore_ = NULL;
+  iree_hal_semaphore_t* signal_semaphore_ = NULL;
+};
+
+// Operations whose wait semaphores have been reached are serviced by the
+// direct loader on the calling thread.
+TEST_F(ParameterIndexProviderTest, ReachedWaitUsesDirectIO) {
+  IREE_ASSERT_OK(iree_hal_semaphore_signal(wait_semaphore_, 1ull));
+  IREE_ASSERT_OK(Gather([] {}));
+  ExpectTargetContents();
+  EXPECT_EQ(QueryStatistics().request_count, 1);
+}
+
+// Operations whose wait semaphores are signaled after the operation has been
+// issued must not block on them in the direct loader and instead use queue
+// reads that are ordered after the wait. The local-sync device performs queue
+// reads inline so the wait is signaled from another thread once the operation
+// has begun.
+TEST_F(ParameterIndexProviderTest, PendingWaitUsesQueueReads) {
+  std::promise<void> enumerated;
+  std::thread signaler([&] {
+    enumerated.get_future().wait();
+    IREE_CHECK_OK(iree_hal_semaphore_signal(wait_semaphore_, 1ull));
+  });
+  IREE_ASSERT_OK(Gather([&] { enumerated.set_value(); }));
+  signaler.join();
+  ExpectTargetContents();
+  EXPECT_EQ(QueryStatistics().request_count, 0);
+}
+
+}  // namespace
+}  // namespace io
+}  // namespace iree
+
+#endif  // IREE_FILE_IO_ENABLE && !IREE_PLATFORM_WINDOWS
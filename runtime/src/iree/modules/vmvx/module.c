@@ -22,6 +22,7 @@
 
 // Additional ukernel code specific to VMVX.
 #include "iree/modules/vmvx/elementwise.h"
+#include "iree/modules/vmvx/tile_sizes.h"
 
 #define IREE_VMVX_MODULE_VERSION_0_0 0x00000000u
 #define IREE_VMVX_MODULE_VERSION_LATEST IREE_VMVX_MODULE_VERSION_0_0
@@ -726,16 +727,14 @@ IREE_VMVX_ABI_DEFINE_SHIM(query_tile_sizes_2d, II);
 
 IREE_VMVX_ABI_EXPORT(iree_vmvx_query_tile_sizes_2d, query_tile_sizes_2d, II) {
   IREE_TRACE_ZONE_BEGIN(z0);
-  iree_uk_query_tile_sizes_2d_params_t ukernel_params = {
-      .size0 = args->size0,
-      .size1 = args->size1,
-      .flags = args->flags,
-      .cpu_data = (const iree_uk_uint64_t*)iree_cpu_data_fields(),
-  };
-  iree_uk_query_tile_sizes_2d_out_params_t ukernel_out_params;
-  iree_uk_query_tile_sizes_2d(&ukernel_params, &ukernel_out_params);
-  rets->i0 = ukernel_out_params.tile_size0;
-  rets->i1 = ukernel_out_params.tile_size1;
+  // Tile sizes tuned for this CPU model take precedence when available.
+  int64_t tile_size0 = 0;
+  int64_t tile_size1 = 0;
+  iree_vmvx_tile_sizes_table_query_2d(
+      iree_vmvx_tile_sizes_table(), args->flags, args->size0, args->size1,
+      iree_cpu_data_fields(), &tile_size0, &tile_size1);
+  rets->i0 = tile_size0;
+  rets->i1 = tile_size1;
   IREE_TRACE_ZONE_END(z0);
   return iree_ok_status();
 }
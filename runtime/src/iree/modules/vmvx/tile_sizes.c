@@ -0,0 +1,589 @@
+// Copyright 2025 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/modules/vmvx/tile_sizes.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "iree/base/internal/atomics.h"
+#include "iree/base/internal/cpu.h"
+#include "iree/builtins/ukernel/api.h"
+
+//===----------------------------------------------------------------------===//
+// Matmul operations
+//===----------------------------------------------------------------------===//
+
+typedef struct iree_vmvx_matmul_operation_t {
+  const char* name;
+  // IREE_UK_FLAG_QUERY_TILE_SIZES_OPERATION_* queried by programs.
+  iree_uk_uint32_t operation;
+  // IREE_UK_FLAG_MMT4D_TYPE_* run when tuning.
+  iree_uk_uint32_t mmt4d_type;
+  iree_host_size_t in_element_size;
+  iree_host_size_t out_element_size;
+} iree_vmvx_matmul_operation_t;
+
+static const iree_vmvx_matmul_operation_t iree_vmvx_matmul_operations[] = {
+    {"f32f32f32", IREE_UK_FLAG_QUERY_TILE_SIZES_OPERATION_MATMUL_F32F32F32,
+     IREE_UK_FLAG_MMT4D_TYPE_F32F32F32, 4, 4},
+    {"i8i8i32", IREE_UK_FLAG_QUERY_TILE_SIZES_OPERATION_MATMUL_I8I8I32,
+     IREE_UK_FLAG_MMT4D_TYPE_S8S8S32, 1, 4},
+    {"f16f16f32", IREE_UK_FLAG_QUERY_TILE_SIZES_OPERATION_MATMUL_F16F16F32,
+     IREE_UK_FLAG_MMT4D_TYPE_F16F16F32, 2, 4},
+    {"f16f16f16", IREE_UK_FLAG_QUERY_TILE_SIZES_OPERATION_MATMUL_F16F16F16,
+     IREE_UK_FLAG_MMT4D_TYPE_F16F16F16, 2, 2},
+    {"bf16bf16f32", IREE_UK_FLAG_QUERY_TILE_SIZES_OPERATION_MATMUL_BF16BF16F32,
+     IREE_UK_FLAG_MMT4D_TYPE_BF16BF16F32, 2, 4},
+    {"bf16bf16bf16",
+     IREE_UK_FLAG_QUERY_TILE_SIZES_OPERATION_MATMUL_BF16BF16BF16,
+     IREE_UK_FLAG_MMT4D_TYPE_BF16BF16BF16, 2, 2},
+};
+
+static const iree_vmvx_matmul_operation_t* iree_vmvx_matmul_operation_by_name(
+    iree_string_view_t name) {
+  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(iree_vmvx_matmul_operations);
+       ++i) {
+    const iree_vmvx_matmul_operation_t* operation =
+        &iree_vmvx_matmul_operations[i];
+    if (iree_string_view_equal(name, iree_make_cstring_view(operation->name))) {
+      return operation;
+    }
+  }
+  return NULL;
+}
+
+static const iree_vmvx_matmul_operation_t* iree_vmvx_matmul_operation_by_flag(
+    iree_uk_uint32_t operation) {
+  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(iree_vmvx_matmul_operations);
+       ++i) {
+    if (iree_vmvx_matmul_operations[i].operation == operation) {
+      return &iree_vmvx_matmul_operations[i];
+    }
+  }
+  return NULL;
+}
+
+//===----------------------------------------------------------------------===//
+// iree_vmvx_tile_sizes_table_t
+//===----------------------------------------------------------------------===//
+
+void iree_vmvx_tile_sizes_table_initialize(
+    iree_vmvx_tile_sizes_table_t* out_table) {
+  memset(out_table, 0, sizeof(*out_table));
+}
+
+static iree_status_t iree_vmvx_tile_sizes_table_append(
+    iree_vmvx_tile_sizes_table_t* table,
+    const iree_vmvx_tile_sizes_entry_t* entry) {
+  if (entry->M0 <= 0 || entry->K0 <= 0 || entry->N0 <= 0 ||
+      entry->max_rows < 0) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "invalid tile sizes %dx%dx%d (max_rows %" PRId64
+                            ")",
+                            entry->M0, entry->K0, entry->N0,
+                            (int64_t)entry->max_rows);
+  }
+  if (table->count >= IREE_ARRAYSIZE(table->entries)) {
+    return iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED,
+                            "tile sizes table capacity %" PRIhsz " exceeded",
+                            IREE_ARRAYSIZE(table->entries));
+  }
+  table->entries[table->count++] = *entry;
+  return iree_ok_status();
+}
+
+// Orders row-limited entries first (narrowest first) so that lookups, which
+// take the first applicable entry, prefer them over general ones and verifies
+// that they are compatible with the general entry for their operation.
+static iree_status_t iree_vmvx_tile_sizes_table_finalize(
+    iree_vmvx_tile_sizes_table_t* table) {
+  // Stable insertion sort; tables are tiny.
+  for (iree_host_size_t i = 1; i < table->count; ++i) {
+    iree_vmvx_tile_sizes_entry_t entry = table->entries[i];
+    // General entries (max_rows == 0) sort last.
+    uint64_t key = (uint64_t)(entry.max_rows - 1);
+    iree_host_size_t j = i;
+    for (; j > 0 && (uint64_t)(table->entries[j - 1].max_rows - 1) > key; --j) {
+      table->entries[j] = table->entries[j - 1];
+    }
+    table->entries[j] = entry;
+  }
+
+  for (iree_host_size_t i = 0; i < table->count; ++i) {
+    const iree_vmvx_tile_sizes_entry_t* entry = &table->entries[i];
+    const iree_vmvx_tile_sizes_entry_t* general = NULL;
+    for (iree_host_size_t j = 0; j < table->count; ++j) {
+      if (table->entries[j].operation != entry->operation ||
+          table->entries[j].max_rows != entry->max_rows || j == i) {
+        continue;
+      }
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                              "duplicate tile sizes for operation 0x%04X "
+                              "(max_rows %" PRId64 ")",
+                              entry->operation, (int64_t)entry->max_rows);
+    }
+    for (iree_host_size_t j = 0; j < table->count; ++j) {
+      if (table->entries[j].operation == entry->operation &&
+          table->entries[j].max_rows == 0) {
+        general = &table->entries[j];
+      }
+    }
+    if (entry->max_rows == 0) continue;
+    // The RHS operand is queried without knowing the row count and always gets
+    // the general entry so K0 and N0 must agree for the packed layouts of the
+    // operands to match.
+    if (!general) {
+      return iree_make_status(
+          IREE_STATUS_INVALID_ARGUMENT,
+          "skinny tile sizes for operation 0x%04X require a general entry",
+          entry->operation);
+    }
+    if (general->K0 != entry->K0 || general->N0 != entry->N0) {
+      return iree_make_status(
+          IREE_STATUS_INVALID_ARGUMENT,
+          "skinny tile sizes %dx%dx%d for operation 0x%04X must share K0/N0 "
+          "with the general tile sizes %dx%dx%d",
+          entry->M0, entry->K0, entry->N0, entry->operation, general->M0,
+          general->K0, general->N0);
+    }
+  }
+  return iree_ok_status();
+}
+
+//===----------------------------------------------------------------------===//
+// CPU model identification
+//===----------------------------------------------------------------------===//
+
+#if IREE_FILE_IO_ENABLE && defined(IREE_PLATFORM_LINUX)
+
+// Appends the value of the first /proc/cpuinfo line starting with |key|.
+static bool iree_vmvx_append_cpuinfo_value(FILE* file, const char* key,
+                                           iree_string_builder_t* builder,
+                                           iree_status_t* out_status) {
+  rewind(file);
+  char line[256];
+  while (fgets(line, sizeof(line), file)) {
+    iree_string_view_t lhs = iree_string_view_empty();
+    iree_string_view_t rhs = iree_string_view_empty();
+    if (iree_string_view_split(iree_make_cstring_view(line), ':', &lhs, &rhs) <
+        0) {
+      continue;
+    }
+    if (!iree_string_view_equal(iree_string_view_trim(lhs),
+                                iree_make_cstring_view(key))) {
+      continue;
+    }
+    *out_status = iree_string_builder_append_string(
+        builder, iree_string_view_trim(rhs));
+    return true;
+  }
+  return false;
+}
+
+static iree_status_t iree_vmvx_query_cpu_model_platform(
+    iree_string_builder_t* builder, bool* out_found) {
+  *out_found = false;
+  FILE* file = fopen("/proc/cpuinfo", "r");
+  if (!file) return iree_ok_status();
+  iree_status_t status = iree_ok_status();
+  // x86 and RISC-V report a marketing name while ARM reports the
+  // implementer/part pair identifying the core microarchitecture.
+  if (iree_vmvx_append_cpuinfo_value(file, "model name", builder, &status)) {
+    *out_found = true;
+  } else if (iree_vmvx_append_cpuinfo_value(file, "CPU implementer", builder,
+                                            &status)) {
+    *out_found = true;
+    if (iree_status_is_ok(status)) {
+      status = iree_string_builder_append_cstring(builder, "/");
+    }
+    if (iree_status_is_ok(status)) {
+      iree_vmvx_append_cpuinfo_value(file, "CPU part", builder, &status);
+    }
+  }
+  fclose(file);
+  return status;
+}
+
+#else
+
+static iree_status_t iree_vmvx_query_cpu_model_platform(
+    iree_string_builder_t* builder, bool* out_found) {
+  *out_found = false;
+  return iree_ok_status();
+}
+
+#endif  // IREE_FILE_IO_ENABLE && IREE_PLATFORM_LINUX
+
+iree_status_t iree_vmvx_query_cpu_model(iree_string_builder_t* builder) {
+  IREE_ASSERT_ARGUMENT(builder);
+  IREE_RETURN_IF_ERROR(
+      iree_string_builder_append_cstring(builder, IREE_ARCH " "));
+  bool found = false;
+  IREE_RETURN_IF_ERROR(iree_vmvx_query_cpu_model_platform(builder, &found));
+  if (!found) {
+    // No model information available; fall back to the feature bits, which at
+    // least distinguish the tile functions available.
+    const uint64_t* cpu_data = iree_cpu_data_fields();
+    IREE_RETURN_IF_ERROR(iree_string_builder_append_format(
+        builder, "features=%016" PRIx64, cpu_data[0]));
+  }
+  return iree_ok_status();
+}
+
+//===----------------------------------------------------------------------===//
+// Textual format
+//===----------------------------------------------------------------------===//
+
+// Consumes the next whitespace-delimited token from |line|.
+static iree_string_view_t iree_vmvx_consume_token(iree_string_view_t* line) {
+  *line = iree_string_view_trim(*line);
+  iree_host_size_t length = 0;
+  while (length < line->size && line->data[length] != ' ' &&
+         line->data[length] != '\t') {
+    ++length;
+  }
+  iree_string_view_t token = iree_make_string_view(line->data, length);
+  *line = iree_string_view_substr(*line, length, IREE_HOST_SIZE_MAX);
+  return token;
+}
+
+static iree_status_t iree_vmvx_tile_sizes_table_parse_line(
+    iree_string_view_t line, iree_string_view_t cpu_model,
+    iree_vmvx_tile_sizes_table_t* table) {
+  iree_string_view_t operation_name = iree_vmvx_consume_token(&line);
+  int32_t values[4] = {0};
+  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(values); ++i) {
+    iree_string_view_t token = iree_vmvx_consume_token(&line);
+    if (!iree_string_view_atoi_int32(token, &values[i])) {
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                              "malformed tile sizes value '%.*s'",
+                              (int)token.size, token.data);
+    }
+  }
+  // The CPU model is the rest of the line and may contain spaces.
+  if (!iree_string_view_equal(iree_string_view_trim(line), cpu_model)) {
+    return iree_ok_status();
+  }
+  const iree_vmvx_matmul_operation_t* operation =
+      iree_vmvx_matmul_operation_by_name(operation_name);
+  if (!operation) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "unknown matmul operation '%.*s'",
+                            (int)operation_name.size, operation_name.data);
+  }
+  const iree_vmvx_tile_sizes_entry_t entry = {
+      .operation = operation->operation,
+      .M0 = values[0],
+      .K0 = values[1],
+      .N0 = values[2],
+      .max_rows = values[3],
+  };
+  return iree_vmvx_tile_sizes_table_append(table, &entry);
+}
+
+iree_status_t iree_vmvx_tile_sizes_table_parse(
+    iree_string_view_t contents, iree_string_view_t cpu_model,
+    iree_vmvx_tile_sizes_table_t* out_table) {
+  IREE_ASSERT_ARGUMENT(out_table);
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_vmvx_tile_sizes_table_initialize(out_table);
+  cpu_model = iree_string_view_trim(cpu_model);
+
+  iree_status_t status = iree_ok_status();
+  while (iree_status_is_ok(status) && !iree_string_view_is_empty(contents)) {
+    iree_string_view_t line = iree_string_view_empty();
+    iree_string_view_split(contents, '\n', &line, &contents);
+    line = iree_string_view_trim(line);
+    if (iree_string_view_is_empty(line) ||
+        iree_string_view_starts_with(line, IREE_SV("#"))) {
+      continue;
+    }
+    status = iree_vmvx_tile_sizes_table_parse_line(line, cpu_model, out_table);
+  }
+  if (iree_status_is_ok(status)) {
+    status = iree_vmvx_tile_sizes_table_finalize(out_table);
+  }
+  if (!iree_status_is_ok(status)) {
+    iree_vmvx_tile_sizes_table_initialize(out_table);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+iree_status_t iree_vmvx_tile_sizes_table_format(
+    const iree_vmvx_tile_sizes_table_t* table, iree_string_view_t cpu_model,
+    iree_string_builder_t* builder) {
+  IREE_ASSERT_ARGUMENT(table);
+  IREE_ASSERT_ARGUMENT(builder);
+  for (iree_host_size_t i = 0; i < table->count; ++i) {
+    const iree_vmvx_tile_sizes_entry_t* entry = &table->entries[i];
+    const iree_vmvx_matmul_operation_t* operation =
+        iree_vmvx_matmul_operation_by_flag(entry->operation);
+    if (!operation) {
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                              "unknown matmul operation 0x%04X",
+                              entry->operation);
+    }
+    IREE_RETURN_IF_ERROR(iree_string_builder_append_format(
+        builder, "%s %d %d %d %" PRId64 " %.*s\n", operation->name, entry->M0,
+        entry->K0, entry->N0, (int64_t)entry->max_rows, (int)cpu_model.size,
+        cpu_model.data));
+  }
+  return iree_ok_status();
+}
+
+//===----------------------------------------------------------------------===//
+// Tuning
+//===----------------------------------------------------------------------===//
+
+// Unpacked problem sizes used to rank candidates. Prefill-like matmuls are
+// large enough to be bound by the tile function throughput while skinny ones
+// are dominated by padding LHS rows up to M0.
+#define IREE_VMVX_TUNE_ROWS 128
+#define IREE_VMVX_TUNE_COLS 128
+#define IREE_VMVX_TUNE_DEPTH 256
+// Each measurement is the fastest of this many runs to reject noise.
+#define IREE_VMVX_TUNE_REPETITIONS 3
+
+typedef struct iree_vmvx_tune_candidate_t {
+  int32_t M0;
+  int32_t K0;
+  int32_t N0;
+} iree_vmvx_tune_candidate_t;
+
+typedef struct iree_vmvx_tune_buffers_t {
+  void* lhs;
+  void* rhs;
+  void* out;
+} iree_vmvx_tune_buffers_t;
+
+// Returns the size of the buffers required for any candidate tile size.
+static void iree_vmvx_tune_buffer_sizes(
+    const iree_vmvx_matmul_operation_t* operation, int32_t max_tile,
+    iree_host_size_t* out_lhs_size, iree_host_size_t* out_rhs_size,
+    iree_host_size_t* out_out_size) {
+  // Rounding each dimension up to the tile size adds at most one tile.
+  iree_host_size_t rows = IREE_VMVX_TUNE_ROWS + max_tile;
+  iree_host_size_t cols = IREE_VMVX_TUNE_COLS + max_tile;
+  iree_host_size_t depth = IREE_VMVX_TUNE_DEPTH + max_tile;
+  *out_lhs_size = rows * depth * operation->in_element_size;
+  *out_rhs_size = cols * depth * operation->in_element_size;
+  *out_out_size = rows * cols * operation->out_element_size;
+}
+
+// Returns the fastest time in nanoseconds to multiply |rows| x depth x cols
+// with the given tile sizes.
+static iree_duration_t iree_vmvx_tune_measure(
+    const iree_vmvx_matmul_operation_t* operation,
+    const iree_vmvx_tune_candidate_t* candidate, iree_host_size_t rows,
+    const uint64_t* cpu_data, const iree_vmvx_tune_buffers_t* buffers) {
+  const iree_uk_index_t M = iree_host_size_ceil_div(rows, candidate->M0);
+  const iree_uk_index_t N =
+      iree_host_size_ceil_div(IREE_VMVX_TUNE_COLS, candidate->N0);
+  const iree_uk_index_t K =
+      iree_host_size_ceil_div(IREE_VMVX_TUNE_DEPTH, candidate->K0);
+  iree_duration_t best = IREE_DURATION_INFINITE;
+  for (int i = 0; i < IREE_VMVX_TUNE_REPETITIONS; ++i) {
+    iree_time_t start = iree_time_now();
+    iree_uk_mmt4d(buffers->lhs, 0, K * candidate->M0 * candidate->K0,
+                  buffers->rhs, 0, K * candidate->N0 * candidate->K0,
+                  buffers->out, 0, N * candidate->M0 * candidate->N0, M, N, K,
+                  candidate->M0, candidate->N0, candidate->K0,
+                  operation->mmt4d_type, (const iree_uk_uint64_t*)cpu_data);
+    best = iree_min(best, iree_time_now() - start);
+  }
+  return best;
+}
+
+// Tunes |operation| and appends up to two entries to |table|.
+static iree_status_t iree_vmvx_tile_sizes_table_tune_operation(
+    const iree_vmvx_matmul_operation_t* operation, const uint64_t* cpu_data,
+    iree_allocator_t host_allocator, iree_vmvx_tile_sizes_table_t* table) {
+  // Only tile sizes with architecture-specific tile functions are candidates:
+  // the generic fallback is never competitive and programs may not allow it.
+  static const int32_t kTileSizes[] = {1, 2, 4, 8, 16, 32};
+  iree_vmvx_tune_candidate_t candidates[IREE_ARRAYSIZE(kTileSizes) *
+                                        IREE_ARRAYSIZE(kTileSizes) *
+                                        IREE_ARRAYSIZE(kTileSizes)];
+  iree_host_size_t candidate_count = 0;
+  for (iree_host_size_t m = 0; m < IREE_ARRAYSIZE(kTileSizes); ++m) {
+    for (iree_host_size_t k = 0; k < IREE_ARRAYSIZE(kTileSizes); ++k) {
+      for (iree_host_size_t n = 0; n < IREE_ARRAYSIZE(kTileSizes); ++n) {
+        iree_uk_uint32_t info =
+            iree_uk_mmt4d_info(kTileSizes[m], kTileSizes[n], kTileSizes[k],
+                               operation->mmt4d_type,
+                               (const iree_uk_uint64_t*)cpu_data);
+        if (info &
+            IREE_UK_FLAG_MMT4D_INFO_HAVE_ARCHITECTURE_SPECIFIC_TILE_FUNCTION) {
+          candidates[candidate_count++] = (iree_vmvx_tune_candidate_t){
+              .M0 = kTileSizes[m], .K0 = kTileSizes[k], .N0 = kTileSizes[n]};
+        }
+      }
+    }
+  }
+  if (candidate_count == 0) return iree_ok_status();
+
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_TEXT(z0, operation->name);
+
+  iree_host_size_t lhs_size = 0, rhs_size = 0, out_size = 0;
+  iree_vmvx_tune_buffer_sizes(operation,
+                              kTileSizes[IREE_ARRAYSIZE(kTileSizes) - 1],
+                              &lhs_size, &rhs_size, &out_size);
+  uint8_t* storage = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(host_allocator, lhs_size + rhs_size + out_size,
+                                (void**)&storage));
+  // Zeros avoid denormal slowdowns skewing the measurements.
+  memset(storage, 0, lhs_size + rhs_size + out_size);
+  const iree_vmvx_tune_buffers_t buffers = {
+      .lhs = storage,
+      .rhs = storage + lhs_size,
+      .out = storage + lhs_size + rhs_size,
+  };
+
+  // General (prefill-like) entry: all tile sizes compete.
+  iree_host_size_t best_index = 0;
+  iree_duration_t best_time = IREE_DURATION_INFINITE;
+  for (iree_host_size_t i = 0; i < candidate_count; ++i) {
+    iree_duration_t time =
+        iree_vmvx_tune_measure(operation, &candidates[i], IREE_VMVX_TUNE_ROWS,
+                               cpu_data, &buffers);
+    if (time < best_time) {
+      best_time = time;
+      best_index = i;
+    }
+  }
+  const iree_vmvx_tune_candidate_t general = candidates[best_index];
+
+  // Skinny (decode-like) entry: only M0 may vary, see
+  // iree_vmvx_tile_sizes_entry_t. Both a single row and the largest
+  // skinny row count are measured so that neither extreme dominates.
+  iree_vmvx_tune_candidate_t skinny = general;
+  iree_duration_t skinny_time = IREE_DURATION_INFINITE;
+  for (iree_host_size_t i = 0; i < candidate_count; ++i) {
+    if (candidates[i].K0 != general.K0 || candidates[i].N0 != general.N0) {
+      continue;
+    }
+    iree_duration_t time =
+        iree_vmvx_tune_measure(operation, &candidates[i], 1, cpu_data,
+                               &buffers) +
+        iree_vmvx_tune_measure(operation, &candidates[i],
+                               IREE_VMVX_TILE_SIZES_SKINNY_MAX_ROWS, cpu_data,
+                               &buffers);
+    if (time < skinny_time) {
+      skinny_time = time;
+      skinny = candidates[i];
+    }
+  }
+
+  iree_allocator_free(host_allocator, storage);
+
+  iree_status_t status = iree_ok_status();
+  if (skinny.M0 != general.M0) {
+    const iree_vmvx_tile_sizes_entry_t entry = {
+        .operation = operation->operation,
+        .max_rows = IREE_VMVX_TILE_SIZES_SKINNY_MAX_ROWS,
+        .M0 = skinny.M0,
+        .K0 = skinny.K0,
+        .N0 = skinny.N0,
+    };
+    status = iree_vmvx_tile_sizes_table_append(table, &entry);
+  }
+  if (iree_status_is_ok(status)) {
+    const iree_vmvx_tile_sizes_entry_t entry = {
+        .operation = operation->operation,
+        .max_rows = 0,
+        .M0 = general.M0,
+        .K0 = general.K0,
+        .N0 = general.N0,
+    };
+    status = iree_vmvx_tile_sizes_table_append(table, &entry);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+iree_status_t iree_vmvx_tile_sizes_table_tune(
+    const uint64_t* cpu_data, iree_allocator_t host_allocator,
+    iree_vmvx_tile_sizes_table_t* out_table) {
+  IREE_ASSERT_ARGUMENT(cpu_data);
+  IREE_ASSERT_ARGUMENT(out_table);
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_vmvx_tile_sizes_table_initialize(out_table);
+  iree_status_t status = iree_ok_status();
+  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(iree_vmvx_matmul_operations);
+       ++i) {
+    status = iree_vmvx_tile_sizes_table_tune_operation(
+        &iree_vmvx_matmul_operations[i], cpu_data, host_allocator, out_table);
+    if (!iree_status_is_ok(status)) break;
+  }
+  if (iree_status_is_ok(status)) {
+    status = iree_vmvx_tile_sizes_table_finalize(out_table);
+  }
+  if (!iree_status_is_ok(status)) {
+    iree_vmvx_tile_sizes_table_initialize(out_table);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+//===----------------------------------------------------------------------===//
+// Queries
+//===----------------------------------------------------------------------===//
+
+void iree_vmvx_tile_sizes_table_query_2d(
+    const iree_vmvx_tile_sizes_table_t* table, uint32_t flags, int64_t size0,
+    int64_t size1, const uint64_t* cpu_data, int64_t* out_tile_size0,
+    int64_t* out_tile_size1) {
+  iree_uk_matmul_tile_sizes_tuned_t
+      entries[IREE_VMVX_TILE_SIZES_TABLE_CAPACITY];
+  iree_uk_matmul_tile_sizes_table_t ukernel_table = {
+      .count = 0,
+      .entries = entries,
+  };
+  if (table) {
+    for (iree_host_size_t i = 0; i < table->count; ++i) {
+      entries[i] = (iree_uk_matmul_tile_sizes_tuned_t){
+          .operation = table->entries[i].operation,
+          .max_rows = table->entries[i].max_rows,
+          .M0 = table->entries[i].M0,
+          .K0 = table->entries[i].K0,
+          .N0 = table->entries[i].N0,
+      };
+    }
+    ukernel_table.count = table->count;
+  }
+  const iree_uk_query_tile_sizes_2d_params_t params = {
+      .flags = flags,
+      .size0 = size0,
+      .size1 = size1,
+      .cpu_data = (const iree_uk_uint64_t*)cpu_data,
+      .tuned_table = table ? &ukernel_table : NULL,
+  };
+  iree_uk_query_tile_sizes_2d_out_params_t out_params;
+  iree_uk_query_tile_sizes_2d(&params, &out_params);
+  *out_tile_size0 = out_params.tile_size0;
+  *out_tile_size1 = out_params.tile_size1;
+}
+
+//===----------------------------------------------------------------------===//
+// Process-wide table
+//===----------------------------------------------------------------------===//
+
+static iree_atomic_intptr_t iree_vmvx_tile_sizes_table_ =
+    IREE_ATOMIC_VAR_INIT(0);
+
+void iree_vmvx_set_tile_sizes_table(const iree_vmvx_tile_sizes_table_t* table) {
+  iree_atomic_store(&iree_vmvx_tile_sizes_table_, (intptr_t)table,
+                    iree_memory_order_release);
+}
+
+const iree_vmvx_tile_sizes_table_t* iree_vmvx_tile_sizes_table(void) {
+  return (const iree_vmvx_tile_sizes_table_t*)iree_atomic_load(
+      &iree_vmvx_tile_sizes_table_, iree_memory_order_acquire);
+}
@@ -0,0 +1,120 @@
+// Copyright 2025 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_MODULES_VMVX_TILE_SIZES_H_
+#define IREE_MODULES_VMVX_TILE_SIZES_H_
+
+#include <stdint.h>
+
+#include "iree/base/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+//===----------------------------------------------------------------------===//
+// Tuned matmul tile sizes
+//===----------------------------------------------------------------------===//
+
+// Maximum number of entries in a table. Tuning produces at most one general
+// and one skinny entry per matmul operation.
+#define IREE_VMVX_TILE_SIZES_TABLE_CAPACITY 32
+
+// Matmuls with at most this many LHS rows are tuned as skinny (decode-like)
+// matmuls separately from larger (prefill-like) ones.
+#define IREE_VMVX_TILE_SIZES_SKINNY_MAX_ROWS 8
+
+// Matmul tile sizes for an operation on a particular CPU model.
+// Mirrors iree_uk_matmul_tile_sizes_tuned_t without requiring the ukernel
+// headers, which are C-only.
+typedef struct iree_vmvx_tile_sizes_entry_t {
+  // One of IREE_UK_FLAG_QUERY_TILE_SIZES_OPERATION_*.
+  uint32_t operation;
+  // If non-zero the entry only applies to matmuls with at most this many LHS
+  // rows and must share K0 and N0 with the general entry for the operation.
+  int64_t max_rows;
+  int32_t M0;
+  int32_t K0;
+  int32_t N0;
+} iree_vmvx_tile_sizes_entry_t;
+
+// Table of matmul tile sizes tuned for a particular CPU model.
+// The built-in tile sizes selected by iree_uk_query_tile_sizes_2d are chosen
+// per architecture and CPU feature set while the fastest tiles vary across
+// microarchitectures implementing the same features. A table measured on (or
+// loaded for) the host CPU model lets a single build pick the best tiles for
+// each machine it runs on.
+//
+// Tables are persisted as text with one entry per line:
+//   <operation> <M0> <K0> <N0> <max_rows> <cpu model>
+// where |operation| is the matmul type (such as `f32f32f32` or `i8i8i32`),
+// |max_rows| is 0 for entries applying to all shapes and the CPU model is the
+// remainder of the line as returned by iree_vmvx_query_cpu_model. Lines
+// starting with `#` are comments. A single file may hold tables for any
+// number of CPU models.
+//
+// The compiler reads the same format with --iree-llvmcpu-tuned-tile-sizes and
+// --iree-llvmcpu-tuned-tile-sizes-cpu-model to use tuned tiles when
+// materializing LLVMCPU data-tiling encodings for a known deployment CPU.
+typedef struct iree_vmvx_tile_sizes_table_t {
+  iree_host_size_t count;
+  iree_vmvx_tile_sizes_entry_t entries[IREE_VMVX_TILE_SIZES_TABLE_CAPACITY];
+} iree_vmvx_tile_sizes_table_t;
+
+// Initializes |out_table| to an empty table.
+void iree_vmvx_tile_sizes_table_initialize(
+    iree_vmvx_tile_sizes_table_t* out_table);
+
+// Appends the string identifying the host CPU model to |builder|.
+// Tuned tables are only valid for the CPU model they were measured on.
+iree_status_t iree_vmvx_query_cpu_model(iree_string_builder_t* builder);
+
+// Parses the entries for |cpu_model| from the textual table |contents| into
+// |out_table|. Entries for other CPU models are ignored. Fails if the entries
+// are inconsistent (such as skinny entries whose K0/N0 differ from the
+// general entry for the same operation).
+iree_status_t iree_vmvx_tile_sizes_table_parse(
+    iree_string_view_t contents, iree_string_view_t cpu_model,
+    iree_vmvx_tile_sizes_table_t* out_table);
+
+// Appends |table| to |builder| in the textual format for |cpu_model|.
+iree_status_t iree_vmvx_tile_sizes_table_format(
+    const iree_vmvx_tile_sizes_table_t* table, iree_string_view_t cpu_model,
+    iree_string_builder_t* builder);
+
+// Tunes |out_table| by timing mmt4d with every tile size that has an
+// architecture-specific tile function for |cpu_data| on the calling thread.
+// Prefill-like shapes select the general entry for each operation and
+// decode-like shapes select an M0 override for skinny matmuls when one is
+// faster. This takes on the order of a second and is intended to be run once
+// per CPU model with the result persisted.
+iree_status_t iree_vmvx_tile_sizes_table_tune(
+    const uint64_t* cpu_data, iree_allocator_t host_allocator,
+    iree_vmvx_tile_sizes_table_t* out_table);
+
+// Queries the tile sizes of a matmul operand as vmvx.query_tile_sizes.2d.
+// |flags| are IREE_UK_FLAG_QUERY_TILE_SIZES_* bits and |size0|/|size1| are the
+// operand dimensions (INT64_MIN if dynamic). Entries in |table| take precedence
+// over the built-in tile sizes for |cpu_data|; |table| may be NULL.
+void iree_vmvx_tile_sizes_table_query_2d(
+    const iree_vmvx_tile_sizes_table_t* table, uint32_t flags, int64_t size0,
+    int64_t size1, const uint64_t* cpu_data, int64_t* out_tile_size0,
+    int64_t* out_tile_size1);
+
+// Sets the process-wide tuned table consulted when VMVX programs query tile
+// sizes or NULL to use the built-in tile sizes. The table must remain valid
+// until it is replaced. Only programs materializing encodings after the call
+// are affected.
+void iree_vmvx_set_tile_sizes_table(const iree_vmvx_tile_sizes_table_t* table);
+
+// Returns the process-wide tuned table or NULL if none is set.
+const iree_vmvx_tile_sizes_table_t* iree_vmvx_tile_sizes_table(void);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_MODULES_VMVX_TILE_SIZES_H_
@@ -0,0 +1,269 @@
+// Copyright 2025 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/modules/vmvx/tile_sizes.h"
+
+#include <cstdint>
+#include <string>
+
+#include "iree/base/api.h"
+#include "iree/builtins/ukernel/exported_bits.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace {
+
+using iree::Status;
+using iree::StatusCode;
+using iree::testing::status::StatusIs;
+
+constexpr uint32_t kF32 =
+    IREE_UK_FLAG_QUERY_TILE_SIZES_OPERATION_MATMUL_F32F32F32;
+constexpr uint32_t kI8 =
+    IREE_UK_FLAG_QUERY_TILE_SIZES_OPERATION_MATMUL_I8I8I32;
+
+Status Parse(const char* contents, const char* cpu_model,
+             iree_vmvx_tile_sizes_table_t* out_table) {
+  return Status(iree_vmvx_tile_sizes_table_parse(
+      iree_make_cstring_view(contents), iree_make_cstring_view(cpu_model),
+      out_table));
+}
+
+std::string Format(const iree_vmvx_tile_sizes_table_t* table,
+                   const char* cpu_model) {
+  iree_string_builder_t builder;
+  iree_string_builder_initialize(iree_allocator_system(), &builder);
+  IREE_CHECK_OK(iree_vmvx_tile_sizes_table_format(
+      table, iree_make_cstring_view(cpu_model), &builder));
+  std::string result(iree_string_builder_buffer(&builder),
+                     iree_string_builder_size(&builder));
+  iree_string_builder_deinitialize(&builder);
+  return result;
+}
+
+struct TileSizes {
+  int64_t tile_size0 = 0;
+  int64_t tile_size1 = 0;
+};
+
+// Queries the matmul tile sizes for |operand_role| with |size0| rows (or
+// columns for the RHS) using |table| as the tuned table.
+TileSizes Query(const iree_vmvx_tile_sizes_table_t* table, uint32_t operation,
+                uint32_t operand_role, int64_t size0) {
+  static const uint64_t cpu_data[1] = {0};
+  TileSizes tile_sizes;
+  iree_vmvx_tile_sizes_table_query_2d(table, operation | operand_role, size0,
+                                      /*size1=*/64, cpu_data,
+                                      &tile_sizes.tile_size0,
+                                      &tile_sizes.tile_size1);
+  return tile_sizes;
+}
+
+TEST(TileSizesTest, ParseSelectsCpuModel) {
+  iree_vmvx_tile_sizes_table_t table;
+  IREE_ASSERT_OK(Parse(
+      "# comment\n"
+      "\n"
+      "f32f32f32 8 1 8 0 x86_64 Some CPU @ 3.00GHz\n"
+      "f32f32f32 16 1 16 0 x86_64 Other CPU\n"
+      "  i8i8i32 4 2 16 0   x86_64 Some CPU @ 3.00GHz  \n",
+      "x86_64 Some CPU @ 3.00GHz", &table));
+  ASSERT_EQ(table.count, 2);
+  EXPECT_EQ(table.entries[0].operation, kF32);
+  EXPECT_EQ(table.entries[0].M0, 8);
+  EXPECT_EQ(table.entries[0].K0, 1);
+  EXPECT_EQ(table.entries[0].N0, 8);
+  EXPECT_EQ(table.entries[0].max_rows, 0);
+  EXPECT_EQ(table.entries[1].operation, kI8);
+  EXPECT_EQ(table.entries[1].M0, 4);
+  EXPECT_EQ(table.entries[1].K0, 2);
+  EXPECT_EQ(table.entries[1].N0, 16);
+}
+
+TEST(TileSizesTest, ParseUnknownCpuModel) {
+  iree_vmvx_tile_sizes_table_t table;
+  IREE_ASSERT_OK(Parse("f32f32f32 8 1 8 0 x86_64 Other CPU\n",
+                       "x86_64 Some CPU", &table));
+  EXPECT_EQ(table.count, 0);
+}
+
+TEST(TileSizesTest, ParseOrdersSkinnyEntriesFirst) {
+  iree_vmvx_tile_sizes_table_t table;
+  IREE_ASSERT_OK(Parse(
+      "f32f32f32 16 1 16 0 cpu\n"
+      "f32f32f32 4 1 16 8 cpu\n"
+      "f32f32f32 1 1 16 1 cpu\n",
+      "cpu", &table));
+  ASSERT_EQ(table.count, 3);
+  EXPECT_EQ(table.entries[0].max_rows, 1);
+  EXPECT_EQ(table.entries[1].max_rows, 8);
+  EXPECT_EQ(table.entries[2].max_rows, 0);
+}
+
+TEST(TileSizesTest, FormatRoundTrip) {
+  iree_vmvx_tile_sizes_table_t table;
+  IREE_ASSERT_OK(Parse(
+      "f32f32f32 16 1 16 0 x86_64 Some CPU\n"
+      "f32f32f32 2 1 16 8 x86_64 Some CPU\n"
+      "bf16bf16f32 16 2 16 0 x86_64 Some CPU\n",
+      "x86_64 Some CPU", &table));
+  std::string formatted = Format(&table, "x86_64 Some CPU");
+  EXPECT_EQ(formatted,
+            "f32f32f32 2 1 16 8 x86_64 Some CPU\n"
+            "f32f32f32 16 1 16 0 x86_64 Some CPU\n"
+            "bf16bf16f32 16 2 16 0 x86_64 Some CPU\n");
+
+  iree_vmvx_tile_sizes_table_t reparsed;
+  IREE_ASSERT_OK(Parse(formatted.c_str(), "x86_64 Some CPU", &reparsed));
+  ASSERT_EQ(reparsed.count, table.count);
+  for (iree_host_size_t i = 0; i < table.count; ++i) {
+    EXPECT_EQ(reparsed.entries[i].operation, table.entries[i].operation);
+    EXPECT_EQ(reparsed.entries[i].max_rows, table.entries[i].max_rows);
+    EXPECT_EQ(reparsed.entries[i].M0, table.entries[i].M0);
+    EXPECT_EQ(reparsed.entries[i].K0, table.entries[i].K0);
+    EXPECT_EQ(reparsed.entries[i].N0, table.entries[i].N0);
+  }
+}
+
+TEST(TileSizesTest, FormatEmpty) {
+  iree_vmvx_tile_sizes_table_t table;
+  iree_vmvx_tile_sizes_table_initialize(&table);
+  EXPECT_EQ(Format(&table, "cpu"), "");
+}
+
+TEST(TileSizesTest, ParseMalformed) {
+  struct {
+    const char* contents;
+    StatusCode code;
+  } cases[] = {
+      // Missing and non-numeric values.
+      {"f32f32f32 8 1 8 cpu\n", StatusCode::kInvalidArgument},
+      {"f32f32f32 8 x 8 0 cpu\n", StatusCode::kInvalidArgument},
+      {"f32f32f32\n", StatusCode::kInvalidArgument},
+      // Unknown operation for the selected CPU model.
+      {"f64f64f64 8 1 8 0 cpu\n", StatusCode::kInvalidArgument},
+      // Non-positive tile sizes and negative row limits.
+      {"f32f32f32 0 1 8 0 cpu\n", StatusCode::kInvalidArgument},
+      {"f32f32f32 8 -1 8 0 cpu\n", StatusCode::kInvalidArgument},
+      {"f32f32f32 8 1 8 -4 cpu\n", StatusCode::kInvalidArgument},
+      // Duplicate entries.
+      {"f32f32f32 8 1 8 0 cpu\nf32f32f32 16 1 16 0 cpu\n",
+       StatusCode::kInvalidArgument},
+      // Skinny entries without a general entry or with a different K0/N0.
+      {"f32f32f32 1 1 8 8 cpu\n", StatusCode::kInvalidArgument},
+      {"f32f32f32 8 1 8 0 cpu\nf32f32f32 1 1 16 8 cpu\n",
+       StatusCode::kInvalidArgument},
+      {"f32f32f32 8 1 8 0 cpu\nf32f32f32 1 2 8 8 cpu\n",
+       StatusCode::kInvalidArgument},
+  };
+  for (const auto& test_case : cases) {
+    SCOPED_TRACE(test_case.contents);
+    iree_vmvx_tile_sizes_table_t table;
+    EXPECT_THAT(Parse(test_case.contents, "cpu", &table),
+                StatusIs(test_case.code));
+    // Failed parses leave the table empty.
+    EXPECT_EQ(table.count, 0);
+  }
+}
+
+TEST(TileSizesTest, ParseCapacityExceeded) {
+  std::string contents;
+  for (int i = 0; i <= IREE_VMVX_TILE_SIZES_TABLE_CAPACITY; ++i) {
+    contents += "f32f32f32 " + std::to_string(i + 1) + " 1 8 " +
+                std::to_string(i + 1) + " cpu\n";
+  }
+  iree_vmvx_tile_sizes_table_t table;
+  EXPECT_THAT(Parse(contents.c_str(), "cpu", &table),
+              StatusIs(StatusCode::kResourceExhausted));
+}
+
+TEST(TileSizesTest, QueryPrefersSkinnyEntriesForFewRows) {
+  iree_vmvx_tile_sizes_table_t table;
+  IREE_ASSERT_OK(Parse(
+      "f32f32f32 16 1 8 0 cpu\n"
+      "f32f32f32 2 1 8 8 cpu\n"
+      "f32f32f32 1 1 8 1 cpu\n",
+      "cpu", &table));
+
+  // The narrowest applicable row-limited entry wins.
+  auto lhs = Query(&table, kF32, IREE_UK_FLAG_QUERY_TILE_SIZES_OPERAND_ROLE_LHS,
+                   /*size0=*/1);
+  EXPECT_EQ(lhs.tile_size0, 1);
+  EXPECT_EQ(lhs.tile_size1, 1);
+  lhs = Query(&table, kF32, IREE_UK_FLAG_QUERY_TILE_SIZES_OPERAND_ROLE_LHS,
+              /*size0=*/8);
+  EXPECT_EQ(lhs.tile_size0, 2);
+  lhs = Query(&table, kF32, IREE_UK_FLAG_QUERY_TILE_SIZES_OPERAND_ROLE_LHS,
+              /*size0=*/9);
+  EXPECT_EQ(lhs.tile_size0, 16);
+
+  auto result =
+      Query(&table, kF32, IREE_UK_FLAG_QUERY_TILE_SIZES_OPERAND_ROLE_RESULT,
+            /*size0=*/4);
+  EXPECT_EQ(result.tile_size0, 2);
+  EXPECT_EQ(result.tile_size1, 8);
+
+  // Dynamic row counts can't use row-limited entries.
+  lhs = Query(&table, kF32, IREE_UK_FLAG_QUERY_TILE_SIZES_OPERAND_ROLE_LHS,
+              /*size0=*/INT64_MIN);
+  EXPECT_EQ(lhs.tile_size0, 16);
+
+  // The RHS has no row count and always gets the general entry, which shares
+  // K0/N0 with the skinny entries.
+  auto rhs = Query(&table, kF32, IREE_UK_FLAG_QUERY_TILE_SIZES_OPERAND_ROLE_RHS,
+                   /*size0=*/1);
+  EXPECT_EQ(rhs.tile_size0, 8);
+  EXPECT_EQ(rhs.tile_size1, 1);
+}
+
+TEST(TileSizesTest, QueryFallsBackForOtherOperations) {
+  auto builtin = Query(/*table=*/nullptr, kI8,
+                       IREE_UK_FLAG_QUERY_TILE_SIZES_OPERAND_ROLE_RESULT, 64);
+
+  // Entries for other operations don't affect the built-in choice.
+  iree_vmvx_tile_sizes_table_t table;
+  IREE_ASSERT_OK(Parse("f32f32f32 3 5 7 0 cpu\n", "cpu", &table));
+  auto queried =
+      Query(&table, kI8, IREE_UK_FLAG_QUERY_TILE_SIZES_OPERAND_ROLE_RESULT, 64);
+  EXPECT_EQ(queried.tile_size0, builtin.tile_size0);
+  EXPECT_EQ(queried.tile_size1, builtin.tile_size1);
+
+  queried = Query(&table, kF32,
+                  IREE_UK_FLAG_QUERY_TILE_SIZES_OPERAND_ROLE_RESULT, 64);
+  EXPECT_EQ(queried.tile_size0, 3);
+  EXPECT_EQ(queried.tile_size1, 7);
+}
+
+TEST(TileSizesTest, ProcessWideTable) {
+  EXPECT_EQ(iree_vmvx_tile_sizes_table(), nullptr);
+  iree_vmvx_tile_sizes_table_t table;
+  IREE_ASSERT_OK(Parse("f32f32f32 8 1 8 0 cpu\n", "cpu", &table));
+  iree_vmvx_set_tile_sizes_table(&table);
+  EXPECT_EQ(iree_vmvx_tile_sizes_table(), &table);
+  iree_vmvx_set_tile_sizes_table(nullptr);
+  EXPECT_EQ(iree_vmvx_tile_sizes_table(), nullptr);
+}
+
+TEST(TileSizesTest, QueryCpuModel) {
+  iree_string_builder_t builder;
+  iree_string_builder_initialize(iree_allocator_system(), &builder);
+  IREE_ASSERT_OK(iree_vmvx_query_cpu_model(&builder));
+  iree_string_view_t cpu_model = iree_string_builder_view(&builder);
+  EXPECT_TRUE(iree_string_view_starts_with(cpu_model, IREE_SV(IREE_ARCH " ")));
+
+  // The model must survive a round-trip through the textual format.
+  iree_vmvx_tile_sizes_table_t table;
+  IREE_ASSERT_OK(Parse("f32f32f32 8 1 8 0 cpu\n", "cpu", &table));
+  std::string cpu_model_string(cpu_model.data, cpu_model.size);
+  std::string formatted = Format(&table, cpu_model_string.c_str());
+  iree_vmvx_tile_sizes_table_t reparsed;
+  IREE_ASSERT_OK(
+      Parse(formatted.c_str(), cpu_model_string.c_str(), &reparsed));
+  EXPECT_EQ(reparsed.count, 1);
+  iree_string_builder_deinitialize(&builder);
+}
+
+}  // namespace
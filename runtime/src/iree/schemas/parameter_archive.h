@@ -214,9 +214,19 @@ typedef struct iree_io_parameter_archive_splat_entry_t {
   uint8_t pattern_length;
 } iree_io_parameter_archive_splat_entry_t;
 
+// Flag bits used in the header of data entries.
+enum iree_io_parameter_archive_data_entry_flag_bits_e {
+  IREE_IO_PARAMETER_ARCHIVE_DATA_ENTRY_FLAG_NONE = 0ull,
+  // The data entry is immediately followed by an
+  // iree_io_parameter_archive_checksum_t of its stored data. The entry size
+  // includes the checksum.
+  IREE_IO_PARAMETER_ARCHIVE_DATA_ENTRY_FLAG_HAS_CHECKSUM = 1ull << 0,
+};
+
 // An entry referencing a span of data in the archive data storage segment.
 // Multiple entries with distinct virtual ranges may reference the same or
-// overlapping physical ranges.
+// overlapping physical ranges. Archive builders use this to store identical
+// parameter contents only once.
 typedef struct iree_io_parameter_archive_data_entry_t {
   // Entry header with type IREE_IO_PARAMETER_ARCHIVE_ENTRY_TYPE_DATA.
   iree_io_parameter_archive_entry_header_t header;
@@ -226,6 +236,28 @@ typedef struct iree_io_parameter_archive_data_entry_t {
   iree_io_parameter_archive_storage_ref_t storage;
 } iree_io_parameter_archive_data_entry_t;
 
+enum iree_io_parameter_archive_checksum_type_e {
+  // No checksum is present.
+  IREE_IO_PARAMETER_ARCHIVE_CHECKSUM_TYPE_NONE = 0,
+  // XXH64 (https://github.com/Cyan4973/xxHash) with a seed of 0.
+  IREE_IO_PARAMETER_ARCHIVE_CHECKSUM_TYPE_XXH64 = 1,
+};
+// Defines the algorithm used to produce a checksum.
+typedef uint32_t iree_io_parameter_archive_checksum_type_t;
+
+// Checksum of the stored data of an entry.
+// Follows an iree_io_parameter_archive_data_entry_t that has the
+// IREE_IO_PARAMETER_ARCHIVE_DATA_ENTRY_FLAG_HAS_CHECKSUM flag set. Readers that
+// do not understand the flag skip it by way of the entry size.
+typedef struct iree_io_parameter_archive_checksum_t {
+  // Algorithm used to produce the value.
+  iree_io_parameter_archive_checksum_type_t type;
+  // Reserved for future use. Must be zero.
+  uint32_t reserved;
+  // Checksum of the stored data range (excluding any zero padding).
+  uint64_t value;
+} iree_io_parameter_archive_checksum_t;
+
 // An entry referencing data in an external file.
 typedef struct iree_io_parameter_archive_external_entry_t {
   // Entry header with type IREE_IO_PARAMETER_ARCHIVE_ENTRY_TYPE_EXTERNAL.
@@ -24,6 +24,12 @@ IREE_FLAG(
     "when latency is the #1 priority (vs. thermals, system-wide scheduling,\n"
     "etc).");
 
+IREE_FLAG(
+    bool, task_worker_spin_adaptive, false,
+    "Only spins for up to --task_worker_spin_us when work has recently been\n"
+    "arriving quickly enough for spinning to catch it. Workers park\n"
+    "immediately while work arrives slowly and resume spinning in bursts.");
+
 IREE_FLAG(
     int32_t, task_worker_stack_size, 128 * 1024,
     "Minimum size in bytes of each worker thread stack.\n"
@@ -50,6 +56,9 @@ iree_status_t iree_task_executor_options_initialize_from_flags(
   iree_task_executor_options_initialize(out_options);
   out_options->worker_spin_ns =
       (iree_duration_t)FLAG_task_worker_spin_us * 1000;
+  out_options->worker_spin_mode = FLAG_task_worker_spin_adaptive
+                                      ? IREE_TASK_WORKER_SPIN_MODE_ADAPTIVE
+                                      : IREE_TASK_WORKER_SPIN_MODE_FIXED;
   out_options->worker_stack_size =
       (iree_host_size_t)FLAG_task_worker_stack_size;
   out_options->worker_local_memory_size =
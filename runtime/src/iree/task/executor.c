@@ -97,6 +97,7 @@ iree_status_t iree_task_executor_create(iree_task_executor_options_t options,
   executor->allocator = allocator;
   executor->scheduling_mode = options.scheduling_mode;
   executor->worker_spin_ns = options.worker_spin_ns;
+  executor->worker_spin_mode = options.worker_spin_mode;
   iree_atomic_task_slist_initialize(&executor->incoming_ready_slist);
   iree_slim_mutex_initialize(&executor->coordinator_mutex);
 
@@ -274,6 +275,28 @@ iree_host_size_t iree_task_executor_worker_count(
   return executor->worker_count;
 }
 
+void iree_task_executor_query_statistics(
+    iree_task_executor_t* executor,
+    iree_task_executor_statistics_t* out_statistics) {
+  memset(out_statistics, 0, sizeof(*out_statistics));
+  IREE_STATISTICS({
+    for (iree_host_size_t i = 0; i < executor->worker_count; ++i) {
+      iree_task_worker_statistics_t* statistics =
+          &executor->workers[i].statistics;
+      out_statistics->spin_count += iree_atomic_load(
+          &statistics->spin_count, iree_memory_order_relaxed);
+      out_statistics->spin_wake_count += iree_atomic_load(
+          &statistics->spin_wake_count, iree_memory_order_relaxed);
+      out_statistics->spin_ns +=
+          iree_atomic_load(&statistics->spin_ns, iree_memory_order_relaxed);
+      out_statistics->park_count += iree_atomic_load(
+          &statistics->park_count, iree_memory_order_relaxed);
+      out_statistics->park_ns +=
+          iree_atomic_load(&statistics->park_ns, iree_memory_order_relaxed);
+    }
+  });
+}
+
 iree_event_pool_t* iree_task_executor_event_pool(
     iree_task_executor_t* executor) {
   return executor->event_pool;
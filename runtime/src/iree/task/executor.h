@@ -268,6 +268,19 @@ enum iree_task_scheduling_mode_bits_t {
 };
 typedef uint32_t iree_task_scheduling_mode_t;
 
+// Specifies how workers spin waiting for new work before parking in the OS.
+// Spinning trades CPU time for lower wake latency when work arrives shortly
+// after a worker runs out; parking is always used once the spin expires.
+typedef enum iree_task_worker_spin_mode_e {
+  // Workers spin for the full worker_spin_ns each time they run out of work.
+  IREE_TASK_WORKER_SPIN_MODE_FIXED = 0u,
+  // Workers track how long they have recently been idle before new work
+  // arrived and only spin (for up to worker_spin_ns) when work has been
+  // arriving quickly enough for spinning to catch it. Workers stop spinning
+  // when work arrives slowly and resume when bursts begin.
+  IREE_TASK_WORKER_SPIN_MODE_ADAPTIVE = 1u,
+} iree_task_worker_spin_mode_t;
+
 // Options controlling task executor behavior.
 typedef struct iree_task_executor_options_t {
   // Specifies the schedule mode used for worker and workload balancing.
@@ -288,6 +301,9 @@ typedef struct iree_task_executor_options_t {
   // scheduling, and the environment).
   iree_duration_t worker_spin_ns;
 
+  // Specifies how workers use worker_spin_ns when they run out of work.
+  iree_task_worker_spin_mode_t worker_spin_mode;
+
   // Minimum size in bytes of each worker thread stack.
   // The underlying platform may allocate more stack space but _should_
   // guarantee that the available stack space is near this amount. Note that the
@@ -336,6 +352,29 @@ void iree_task_executor_trim(iree_task_executor_t* executor);
 iree_host_size_t iree_task_executor_worker_count(
     iree_task_executor_t* executor);
 
+// Aggregate worker idling statistics of an executor.
+// Used to tune worker_spin_ns and worker_spin_mode by comparing the CPU time
+// spent spinning with how often spinning avoided parking.
+typedef struct iree_task_executor_statistics_t {
+  // Number of times workers spun waiting for new work.
+  int64_t spin_count;
+  // Number of spins that ended with new work arriving before parking.
+  int64_t spin_wake_count;
+  // Total time spent spinning.
+  int64_t spin_ns;
+  // Number of times workers parked in the OS and were later woken.
+  int64_t park_count;
+  // Total time spent parked.
+  int64_t park_ns;
+} iree_task_executor_statistics_t;
+
+// Queries the aggregate worker idling statistics of |executor|.
+// Statistics are only tracked when IREE_STATISTICS_ENABLE is set and are
+// otherwise all zero.
+void iree_task_executor_query_statistics(
+    iree_task_executor_t* executor,
+    iree_task_executor_statistics_t* out_statistics);
+
 // Returns an iree_event_t pool managed by the executor.
 // Users of the task system should acquire their transient events from this.
 // Long-lived events should be allocated on their own in order to avoid
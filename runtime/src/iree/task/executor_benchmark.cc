@@ -0,0 +1,118 @@
+// Copyright 2025 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <cstddef>
+
+#include "benchmark/benchmark.h"
+#include "iree/base/api.h"
+#include "iree/task/executor.h"
+
+namespace {
+
+// Busy-waits for |duration_ns| to simulate the caller doing other work between
+// submissions. Sleeping would add the OS timer slack to each gap.
+static void BusyWait(iree_duration_t duration_ns) {
+  const iree_time_t deadline_ns = iree_time_now() + duration_ns;
+  while (iree_time_now() < deadline_ns) {
+  }
+}
+
+// Submits a single call task to an idle executor and waits for it to complete.
+// The time between submissions is controlled by the first argument in
+// microseconds: workers have been idle for about that long when each
+// submission arrives and the latency measured is dominated by how quickly they
+// wake. Statistics report how often workers caught the work while spinning
+// versus parking in the OS and how much CPU time they spent spinning.
+static void RunSubmitLatency(benchmark::State& state,
+                             iree_duration_t worker_spin_ns,
+                             iree_task_worker_spin_mode_t worker_spin_mode) {
+  const iree_duration_t gap_ns = state.range(0) * 1000;
+
+  iree_task_topology_t topology;
+  iree_task_topology_initialize_from_group_count(/*group_count=*/2, &topology);
+  iree_task_executor_options_t options;
+  iree_task_executor_options_initialize(&options);
+  options.worker_spin_ns = worker_spin_ns;
+  options.worker_spin_mode = worker_spin_mode;
+  options.worker_local_memory_size = 0;
+  iree_task_executor_t* executor = NULL;
+  IREE_CHECK_OK(iree_task_executor_create(options, &topology,
+                                          iree_allocator_system(), &executor));
+  iree_task_topology_deinitialize(&topology);
+  iree_task_scope_t scope;
+  iree_task_scope_initialize(iree_make_cstring_view("benchmark"),
+                             IREE_TASK_SCOPE_FLAG_NONE, &scope);
+
+  iree_task_executor_statistics_t initial_statistics;
+  iree_task_executor_query_statistics(executor, &initial_statistics);
+
+  for (auto _ : state) {
+    BusyWait(gap_ns);
+
+    iree_time_t start_ns = iree_time_now();
+    iree_task_call_t call;
+    iree_task_call_initialize(
+        &scope,
+        iree_task_make_call_closure(
+            [](void* user_context, iree_task_t* task,
+               iree_task_submission_t* pending_submission) {
+              return iree_ok_status();
+            },
+            NULL),
+        &call);
+    iree_task_fence_t* fence = NULL;
+    IREE_CHECK_OK(iree_task_executor_acquire_fence(executor, &scope, &fence));
+    iree_task_set_completion_task(&call.header, &fence->header);
+    iree_task_submission_t submission;
+    iree_task_submission_initialize(&submission);
+    iree_task_submission_enqueue(&submission, &call.header);
+    iree_task_executor_submit(executor, &submission);
+    iree_task_executor_flush(executor);
+    IREE_CHECK_OK(iree_task_scope_wait_idle(&scope, IREE_TIME_INFINITE_FUTURE));
+    state.SetIterationTime((iree_time_now() - start_ns) / 1e9);
+  }
+
+  iree_task_executor_statistics_t statistics;
+  iree_task_executor_query_statistics(executor, &statistics);
+  state.counters["spin_wakes"] = benchmark::Counter(
+      statistics.spin_wake_count - initial_statistics.spin_wake_count,
+      benchmark::Counter::kAvgIterations);
+  state.counters["parks"] =
+      benchmark::Counter(statistics.park_count - initial_statistics.park_count,
+                         benchmark::Counter::kAvgIterations);
+  state.counters["spin_us"] = benchmark::Counter(
+      (statistics.spin_ns - initial_statistics.spin_ns) / 1000.0,
+      benchmark::Counter::kAvgIterations);
+
+  iree_task_scope_deinitialize(&scope);
+  iree_task_executor_release(executor);
+}
+
+void BM_SubmitLatencyPark(benchmark::State& state) {
+  RunSubmitLatency(state, IREE_DURATION_ZERO,
+                   IREE_TASK_WORKER_SPIN_MODE_FIXED);
+}
+BENCHMARK(BM_SubmitLatencyPark)->Arg(0)->Arg(20)->Arg(200)->UseManualTime();
+
+void BM_SubmitLatencyFixedSpin(benchmark::State& state) {
+  RunSubmitLatency(state, 50 * 1000, IREE_TASK_WORKER_SPIN_MODE_FIXED);
+}
+BENCHMARK(BM_SubmitLatencyFixedSpin)
+    ->Arg(0)
+    ->Arg(20)
+    ->Arg(200)
+    ->UseManualTime();
+
+void BM_SubmitLatencyAdaptiveSpin(benchmark::State& state) {
+  RunSubmitLatency(state, 50 * 1000, IREE_TASK_WORKER_SPIN_MODE_ADAPTIVE);
+}
+BENCHMARK(BM_SubmitLatencyAdaptiveSpin)
+    ->Arg(0)
+    ->Arg(20)
+    ->Arg(200)
+    ->UseManualTime();
+
+}  // namespace
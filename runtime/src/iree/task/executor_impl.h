@@ -42,6 +42,9 @@ struct iree_task_executor_t {
   // IREE_DURATION_ZERO is used to disable spinning.
   iree_duration_t worker_spin_ns;
 
+  // Specifies how workers use worker_spin_ns when they run out of work.
+  iree_task_worker_spin_mode_t worker_spin_mode;
+
   // State used by the work-stealing operations performed by donated threads.
   // This is **NOT SYNCHRONIZED** and relies on the fact that we actually don't
   // much care about the precise selection of workers enough to mind any tears
@@ -6,8 +6,13 @@
 
 #include "iree/task/executor.h"
 
+#include <atomic>
+#include <chrono>
 #include <cstddef>
+#include <thread>
 
+#include "iree/task/executor_impl.h"
+#include "iree/task/worker.h"
 #include "iree/testing/gtest.h"
 #include "iree/testing/status_matchers.h"
 
@@ -135,4 +140,138 @@ TEST(ExecutorTest, SubmissionStress) {
   iree_task_topology_deinitialize(&topology);
 }
 
+// Tests that workers spinning before parking still pick up all work and that
+// their idling is reflected in the executor statistics.
+TEST(ExecutorTest, AdaptiveSpin) {
+  iree_task_executor_options_t options;
+  iree_task_executor_options_initialize(&options);
+  options.worker_local_memory_size = 64 * 1024;
+  options.worker_spin_ns = 100 * 1000;
+  options.worker_spin_mode = IREE_TASK_WORKER_SPIN_MODE_ADAPTIVE;
+  iree_task_topology_t topology;
+  iree_task_topology_initialize_from_group_count(/*group_count=*/2, &topology);
+  iree_task_executor_t* executor = NULL;
+  IREE_ASSERT_OK(iree_task_executor_create(options, &topology,
+                                           iree_allocator_system(), &executor));
+  iree_task_scope_t scope;
+  iree_task_scope_initialize(iree_make_cstring_view("scope"),
+                             IREE_TASK_SCOPE_FLAG_NONE, &scope);
+
+  for (int i = 0; i < 100; ++i) {
+    static std::atomic<int> received_value = {0};
+    iree_task_call_t call;
+    iree_task_call_initialize(
+        &scope,
+        iree_task_make_call_closure(
+            [](void* user_context, iree_task_t* task,
+               iree_task_submission_t* pending_submission) {
+              received_value = (int)(uintptr_t)user_context;
+              return iree_ok_status();
+            },
+            (void*)(uintptr_t)i),
+        &call);
+
+    iree_task_fence_t* fence = NULL;
+    IREE_ASSERT_OK(iree_task_executor_acquire_fence(executor, &scope, &fence));
+    iree_task_set_completion_task(&call.header, &fence->header);
+
+    iree_task_submission_t submission;
+    iree_task_submission_initialize(&submission);
+    iree_task_submission_enqueue(&submission, &call.header);
+    iree_task_executor_submit(executor, &submission);
+    iree_task_executor_flush(executor);
+    IREE_ASSERT_OK(
+        iree_task_scope_wait_idle(&scope, IREE_TIME_INFINITE_FUTURE));
+
+    EXPECT_EQ(received_value, i) << "call did not correlate to loop";
+  }
+
+  iree_task_executor_statistics_t statistics;
+  iree_task_executor_query_statistics(executor, &statistics);
+#if IREE_STATISTICS_ENABLE
+  EXPECT_GT(statistics.spin_count + statistics.park_count, 0);
+#endif  // IREE_STATISTICS_ENABLE
+  EXPECT_LE(statistics.spin_wake_count, statistics.spin_count);
+
+  iree_task_scope_deinitialize(&scope);
+  iree_task_executor_release(executor);
+  iree_task_topology_deinitialize(&topology);
+}
+
+// Tests that a worker that finds work after its spin expired (but before it
+// parked) spins again the next time it runs out of work instead of parking
+// immediately with the idle state of the previous period.
+TEST(ExecutorTest, SpinExpiredThenWorkThenIdle) {
+#if !IREE_STATISTICS_ENABLE
+  GTEST_SKIP() << "worker statistics are required to observe spins";
+#endif  // !IREE_STATISTICS_ENABLE
+  const iree_duration_t spin_ns = 200 * 1000000ll;
+  iree_task_executor_options_t options;
+  iree_task_executor_options_initialize(&options);
+  options.worker_local_memory_size = 64 * 1024;
+  options.worker_spin_ns = spin_ns;
+  options.worker_spin_mode = IREE_TASK_WORKER_SPIN_MODE_FIXED;
+  iree_task_topology_t topology;
+  iree_task_topology_initialize_from_group_count(/*group_count=*/1, &topology);
+  iree_task_executor_t* executor = NULL;
+  IREE_ASSERT_OK(iree_task_executor_create(options, &topology,
+                                           iree_allocator_system(), &executor));
+  iree_task_worker_t* worker = &executor->workers[0];
+  iree_task_scope_t scope;
+  iree_task_scope_initialize(iree_make_cstring_view("scope"),
+                             IREE_TASK_SCOPE_FLAG_NONE, &scope);
+  std::atomic<int> run_count = {0};
+  const iree_task_call_closure_t closure = iree_task_make_call_closure(
+      [](void* user_context, iree_task_t* task,
+         iree_task_submission_t* pending_submission) {
+        ++*(std::atomic<int>*)user_context;
+        return iree_ok_status();
+      },
+      &run_count);
+
+  // Run some work to ensure the worker is live and then give it time to run
+  // out of work and begin spinning.
+  iree_task_call_t warmup_call;
+  iree_task_call_initialize(&scope, closure, &warmup_call);
+  iree_task_fence_t* fence = NULL;
+  IREE_ASSERT_OK(iree_task_executor_acquire_fence(executor, &scope, &fence));
+  iree_task_set_completion_task(&warmup_call.header, &fence->header);
+  iree_task_submission_t submission;
+  iree_task_submission_initialize(&submission);
+  iree_task_submission_enqueue(&submission, &warmup_call.header);
+  iree_task_executor_submit(executor, &submission);
+  iree_task_executor_flush(executor);
+  IREE_ASSERT_OK(iree_task_scope_wait_idle(&scope, IREE_TIME_INFINITE_FUTURE));
+  std::this_thread::sleep_for(std::chrono::nanoseconds(spin_ns / 10));
+  iree_task_executor_statistics_t base_statistics;
+  iree_task_executor_query_statistics(executor, &base_statistics);
+
+  // Post work without waking the worker so that it is only found after the
+  // spin expires. The call has no completion task so that running it leaves
+  // nothing else for the worker to do.
+  iree_task_call_t call;
+  iree_task_call_initialize(&scope, closure, &call);
+  iree_task_list_t list;
+  iree_task_list_initialize(&list);
+  iree_task_list_push_back(&list, &call.header);
+  iree_task_worker_post_tasks(worker, &list);
+
+  // The first spin expires without a wake, the work runs, and the worker must
+  // then spin again before parking.
+  const iree_time_t deadline_ns = iree_time_now() + 10 * spin_ns;
+  iree_task_executor_statistics_t statistics;
+  do {
+    std::this_thread::sleep_for(std::chrono::nanoseconds(spin_ns / 10));
+    iree_task_executor_query_statistics(executor, &statistics);
+  } while (statistics.spin_count - base_statistics.spin_count < 2 &&
+           iree_time_now() < deadline_ns);
+  EXPECT_EQ(run_count, 2);
+  EXPECT_EQ(statistics.spin_count - base_statistics.spin_count, 2);
+  EXPECT_EQ(statistics.spin_wake_count, base_statistics.spin_wake_count);
+
+  iree_task_executor_release(executor);
+  iree_task_scope_deinitialize(&scope);
+  iree_task_topology_deinitialize(&topology);
+}
+
 }  // namespace
@@ -80,6 +80,17 @@ extern "C" {
 #define IREE_TASK_EXECUTOR_MAX_THEFT_TASK_COUNT \
   IREE_TASK_EXECUTOR_MAX_WORKER_COUNT
 
+// Weight of each new idle interval sample in the moving average used by
+// IREE_TASK_WORKER_SPIN_MODE_ADAPTIVE expressed as a shift (1/2^N).
+// Smaller values react faster to changes in arrival rate while larger values
+// are less sensitive to individual outliers.
+#define IREE_TASK_WORKER_IDLE_INTERVAL_SHIFT (2)
+
+// Multiple of the average idle interval that adaptive spinning will spin for.
+// Spinning a bit longer than the average catches most arrivals in a burst
+// without spinning for the full duration when arrivals are regular.
+#define IREE_TASK_WORKER_ADAPTIVE_SPIN_SCALE (2)
+
 // Number of tiles that will be batched into a single reservation from the grid.
 // This is a maximum; if there are fewer tiles that would otherwise allow for
 // maximum parallelism then this may be ignored.
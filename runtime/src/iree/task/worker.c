@@ -41,6 +41,9 @@ iree_status_t iree_task_worker_initialize(
   out_worker->local_memory = local_memory;
   out_worker->processor_id = 0;
   out_worker->processor_tag = 0;
+  out_worker->idle_interval_ns = executor->worker_spin_ns;
+  IREE_STATISTICS(memset(&out_worker->statistics, 0,
+                         sizeof(out_worker->statistics)));
 
   iree_notification_initialize(&out_worker->wake_notification);
   iree_notification_initialize(&out_worker->state_notification);
@@ -287,6 +290,114 @@ static void iree_task_worker_update_processor_id(iree_task_worker_t* worker) {
   iree_cpu_requery_processor_id(&worker->processor_tag, &worker->processor_id);
 }
 
+// Tracks the current idle period of a worker (from when it runs out of work
+// until new work arrives).
+typedef struct iree_task_worker_idle_t {
+  // Time the idle period began or 0 if the worker is not idle or idle periods
+  // are not being timed.
+  iree_time_t start_ns;
+  // True if the worker has already spun during the idle period.
+  bool has_spun;
+} iree_task_worker_idle_t;
+
+// Returns true if idle periods need to be timed for spinning or statistics.
+static bool iree_task_worker_is_idle_timed(iree_task_worker_t* worker) {
+  return IREE_STATISTICS_ENABLE || worker->executor->worker_spin_ns > 0;
+}
+
+// Returns the duration the worker should spin waiting for new work before
+// parking or IREE_DURATION_ZERO to park immediately.
+static iree_duration_t iree_task_worker_spin_duration(
+    iree_task_worker_t* worker) {
+  const iree_duration_t max_spin_ns = worker->executor->worker_spin_ns;
+  if (max_spin_ns <= 0) return IREE_DURATION_ZERO;
+  switch (worker->executor->worker_spin_mode) {
+    default:
+    case IREE_TASK_WORKER_SPIN_MODE_FIXED:
+      return max_spin_ns;
+    case IREE_TASK_WORKER_SPIN_MODE_ADAPTIVE: {
+      // Intervals measured after parking include the OS wake latency so we
+      // keep spinning until the average is well beyond what we could catch.
+      const iree_duration_t interval_ns = worker->idle_interval_ns;
+      if (interval_ns > max_spin_ns * IREE_TASK_WORKER_ADAPTIVE_SPIN_SCALE) {
+        return IREE_DURATION_ZERO;
+      }
+      return iree_min(max_spin_ns,
+                      interval_ns * IREE_TASK_WORKER_ADAPTIVE_SPIN_SCALE);
+    }
+  }
+}
+
+// Ends the current idle period of the worker at |end_ns| (if it was timed) and
+// folds its duration into the moving average of recent idle intervals.
+static void iree_task_worker_end_idle(iree_task_worker_t* worker,
+                                      iree_task_worker_idle_t* idle,
+                                      iree_time_t end_ns) {
+  if (idle->start_ns) {
+    const iree_duration_t interval_ns = end_ns - idle->start_ns;
+    worker->idle_interval_ns +=
+        (interval_ns - worker->idle_interval_ns) /
+        (1 << IREE_TASK_WORKER_IDLE_INTERVAL_SHIFT);
+  }
+  idle->start_ns = 0;
+  idle->has_spun = false;
+}
+
+// Waits for new work to be posted to the worker after it has run out.
+// Depending on the executor configuration the worker may spin for a short
+// duration before parking in the OS. Returns false if the worker spun and no
+// work arrived; callers must then check for work again with a new wait token
+// before calling back in to park.
+static bool iree_task_worker_wait_for_work(iree_task_worker_t* worker,
+                                           iree_wait_token_t wait_token,
+                                           iree_task_worker_idle_t* idle) {
+  const bool is_timed = iree_task_worker_is_idle_timed(worker);
+  if (is_timed && !idle->start_ns) idle->start_ns = iree_time_now();
+
+  // Spin once per idle period. The spin consumes the wait token so if it
+  // expires we return to the caller to recheck for work with a new one.
+  const iree_duration_t spin_ns =
+      idle->has_spun ? IREE_DURATION_ZERO
+                     : iree_task_worker_spin_duration(worker);
+  if (spin_ns > 0) {
+    idle->has_spun = true;
+    const bool did_wake = iree_notification_commit_wait(
+        &worker->wake_notification, wait_token, spin_ns,
+        /*deadline_ns=*/IREE_TIME_INFINITE_PAST);
+    const iree_time_t spin_end_ns = iree_time_now();
+    IREE_STATISTICS({
+      iree_atomic_fetch_add(&worker->statistics.spin_count, 1,
+                            iree_memory_order_relaxed);
+      iree_atomic_fetch_add(&worker->statistics.spin_wake_count,
+                            did_wake ? 1 : 0, iree_memory_order_relaxed);
+      iree_atomic_fetch_add(&worker->statistics.spin_ns,
+                            spin_end_ns - idle->start_ns,
+                            iree_memory_order_relaxed);
+    });
+    if (did_wake) iree_task_worker_end_idle(worker, idle, spin_end_ns);
+    return did_wake;
+  }
+
+  // Wait in the kernel. We don't care if the condition fails as we're just
+  // using it as a pulse.
+  IREE_TRACE_ZONE_BEGIN_NAMED(z_wait, "iree_task_worker_main_pump_wake_wait");
+  IREE_STATISTICS(const iree_time_t park_start_ns = iree_time_now();)
+  iree_notification_commit_wait(&worker->wake_notification, wait_token,
+                                /*spin_ns=*/IREE_DURATION_ZERO,
+                                /*deadline_ns=*/IREE_TIME_INFINITE_FUTURE);
+  const iree_time_t park_end_ns = is_timed ? iree_time_now() : 0;
+  IREE_TRACE_ZONE_END(z_wait);
+  IREE_STATISTICS({
+    iree_atomic_fetch_add(&worker->statistics.park_count, 1,
+                          iree_memory_order_relaxed);
+    iree_atomic_fetch_add(&worker->statistics.park_ns,
+                          park_end_ns - park_start_ns,
+                          iree_memory_order_relaxed);
+  });
+  iree_task_worker_end_idle(worker, idle, park_end_ns);
+  return true;
+}
+
 // Alternates between pumping ready tasks in the worker queue and waiting
 // for more tasks to arrive. Only returns when the worker has been asked by
 // the executor to exit.
@@ -296,6 +407,8 @@ static void iree_task_worker_pump_until_exit(iree_task_worker_t* worker) {
   // be able to process it with the proper processor ID immediately.
   iree_task_worker_update_processor_id(worker);
 
+  iree_task_worker_idle_t idle = {0};
+
   // Pump the thread loop to process more tasks.
   while (true) {
     // If we fail to find any work to do we'll wait at the end of this loop.
@@ -324,9 +437,16 @@ static void iree_task_worker_pump_until_exit(iree_task_worker_t* worker) {
     iree_task_submission_t pending_submission;
     iree_task_submission_initialize(&pending_submission);
 
+    // Any work found ends the current idle period (such as when work was
+    // posted after a spin expired but before the worker parked) so that the
+    // worker gets a fresh spin the next time it runs out of work.
+    const iree_time_t pump_start_ns = idle.start_ns ? iree_time_now() : 0;
+    bool did_work = false;
     while (iree_task_worker_pump_once(worker, &pending_submission)) {
       // All work done ^, which will return false when the worker should wait.
+      did_work = true;
     }
+    if (did_work) iree_task_worker_end_idle(worker, &idle, pump_start_ns);
 
     bool schedule_dirty = false;
     if (!iree_task_submission_is_empty(&pending_submission)) {
@@ -357,20 +477,17 @@ static void iree_task_worker_pump_until_exit(iree_task_worker_t* worker) {
         !iree_task_queue_is_empty(&worker->local_task_queue)) {
       // Have more work to do; loop around to try another pump.
       iree_notification_cancel_wait(&worker->wake_notification);
-    } else {
-      // Spin/wait in the kernel. We don't care if the condition fails as we're
-      // just using it as a pulse.
-      IREE_TRACE_ZONE_BEGIN_NAMED(z_wait,
-                                  "iree_task_worker_main_pump_wake_wait");
-      iree_notification_commit_wait(
-          &worker->wake_notification, wait_token,
-          /*spin_ns=*/worker->executor->worker_spin_ns,
-          /*deadline_ns=*/IREE_TIME_INFINITE_FUTURE);
-      IREE_TRACE_ZONE_END(z_wait);
-
+      if (idle.start_ns) {
+        // Work arrived after a spin expired but before we parked.
+        iree_task_worker_end_idle(worker, &idle, iree_time_now());
+      }
+    } else if (iree_task_worker_wait_for_work(worker, wait_token, &idle)) {
       // Woke from a wait - query the processor ID in case we migrated during
       // the sleep.
       iree_task_worker_update_processor_id(worker);
+    } else {
+      // Spun without being woken; loop around to check for work that may have
+      // arrived before the spin ended and then park.
     }
 
     // Wait completed.
@@ -47,6 +47,16 @@ typedef enum iree_task_worker_state_e {
   IREE_TASK_WORKER_STATE_ZOMBIE = 2,
 } iree_task_worker_state_t;
 
+// Counters tracking how a worker waits for new work.
+// See iree_task_executor_statistics_t for details.
+typedef struct iree_task_worker_statistics_t {
+  iree_atomic_int64_t spin_count;
+  iree_atomic_int64_t spin_wake_count;
+  iree_atomic_int64_t spin_ns;
+  iree_atomic_int64_t park_count;
+  iree_atomic_int64_t park_ns;
+} iree_task_worker_statistics_t;
+
 // A worker within the executor pool.
 //
 // NOTE: fields in here are touched from multiple threads with lock-free
@@ -120,6 +130,16 @@ typedef struct iree_task_worker_t {
   // An opaque tag used to reduce the cost of processor ID queries.
   iree_cpu_processor_tag_t processor_tag;
 
+  // Moving average of how long the worker has recently been idle before new
+  // work arrived. Used to select the spin duration when the executor is using
+  // IREE_TASK_WORKER_SPIN_MODE_ADAPTIVE.
+  // Only ever touched by the worker thread.
+  iree_duration_t idle_interval_ns;
+
+  // Idling statistics (when IREE_STATISTICS_ENABLE is set).
+  // Only updated by the worker thread but may be read from any thread.
+  IREE_STATISTICS(iree_task_worker_statistics_t statistics;)
+
   // Destructive interference padding between the mailbox and local task queue
   // to ensure that the worker - who is pounding on local_task_queue - doesn't
   // contend with submissions or coordinators dropping new tasks in the mailbox.
@@ -177,6 +177,21 @@ void iree_benchmark_set_bytes_processed(iree_benchmark_state_t* state,
 void iree_benchmark_set_items_processed(iree_benchmark_state_t* state,
                                         int64_t items);
 
+enum iree_benchmark_counter_flag_bits_t {
+  IREE_BENCHMARK_COUNTER_FLAG_NONE = 0u,
+  // Reports the value divided by the number of benchmark iterations.
+  IREE_BENCHMARK_COUNTER_FLAG_AVG_ITERATIONS = 1u << 0,
+};
+typedef uint32_t iree_benchmark_counter_flags_t;
+
+// Sets a user counter |name| to |value| that will be reported as its own
+// column alongside the currently executing benchmark.
+//
+// REQUIRES: must only be called outside of the benchmark step loop.
+void iree_benchmark_set_counter(iree_benchmark_state_t* state,
+                                const char* name, double value,
+                                iree_benchmark_counter_flags_t flags);
+
 //===----------------------------------------------------------------------===//
 // iree_benchmark_def_t
 //===----------------------------------------------------------------------===//
@@ -77,6 +77,17 @@ void iree_benchmark_set_items_processed(iree_benchmark_state_t* state,
   s.SetItemsProcessed(items);
 }
 
+void iree_benchmark_set_counter(iree_benchmark_state_t* state,
+                                const char* name, double value,
+                                iree_benchmark_counter_flags_t flags) {
+  auto& s = GetBenchmarkState(state);
+  benchmark::Counter::Flags counter_flags = benchmark::Counter::kDefaults;
+  if (flags & IREE_BENCHMARK_COUNTER_FLAG_AVG_ITERATIONS) {
+    counter_flags = benchmark::Counter::kAvgIterations;
+  }
+  s.counters[name] = benchmark::Counter(value, counter_flags);
+}
+
 //===----------------------------------------------------------------------===//
 // iree_benchmark_def_t
 //===----------------------------------------------------------------------===//
@@ -9,6 +9,7 @@
 #include <memory.h>
 #include <string.h>
 
+#include "iree/base/internal/cpu.h"
 #include "iree/base/internal/flags.h"
 #include "iree/base/internal/path.h"
 #include "iree/hal/local/loaders/registration/init.h"
@@ -17,6 +18,7 @@
 #include "iree/modules/hal/inline/module.h"
 #include "iree/modules/hal/loader/module.h"
 #include "iree/modules/hal/module.h"
+#include "iree/modules/vmvx/tile_sizes.h"
 #include "iree/tooling/device_util.h"
 #include "iree/tooling/modules/resolver.h"
 #include "iree/tooling/parameter_util.h"
@@ -43,6 +45,11 @@ IREE_FLAG(
     "        warm-up time and variance as mapped pages are swapped\n"
     "        by the OS.");
 
+IREE_FLAG(bool, module_lazy_verification, false,
+          "Defers verification of bytecode module functions until each\n"
+          "function is first called instead of verifying all functions on\n"
+          "load. Reduces startup time of modules with many unused functions.");
+
 static iree_status_t iree_tooling_load_bytecode_module(
     iree_vm_instance_t* instance, iree_string_view_t path,
     iree_allocator_t host_allocator, iree_vm_module_t** out_module) {
@@ -73,9 +80,13 @@ static iree_status_t iree_tooling_load_bytecode_module(
   // Try to load the module as bytecode (all we have today that we can use).
   // We could sniff the file ID and switch off to other module types.
   // The module takes ownership of the file contents (when successful).
+  iree_vm_bytecode_module_flags_t module_flags =
+      FLAG_module_lazy_verification
+          ? IREE_VM_BYTECODE_MODULE_FLAG_LAZY_VERIFICATION
+          : IREE_VM_BYTECODE_MODULE_FLAG_NONE;
   iree_vm_module_t* module = NULL;
-  iree_status_t status = iree_vm_bytecode_module_create(
-      instance, file_contents->const_buffer,
+  iree_status_t status = iree_vm_bytecode_module_create_with_flags(
+      instance, module_flags, file_contents->const_buffer,
       iree_io_file_contents_deallocator(file_contents), host_allocator,
       &module);
 
@@ -593,6 +604,92 @@ iree_status_t iree_tooling_find_single_exported_function(
 
 IREE_FLAG(bool, trace_execution, false, "Traces VM execution to stderr.");
 
+IREE_FLAG(
+    string, vmvx_tile_sizes, "",
+    "Path to a table of VMVX matmul tile sizes tuned per CPU model.\n"
+    "Entries for the host CPU model are used when materializing encodings.\n"
+    "Combined with --vmvx_tune_tile_sizes the table is tuned and appended to\n"
+    "the file if it has no entries for the host CPU model.");
+IREE_FLAG(bool, vmvx_tune_tile_sizes, false,
+          "Tunes VMVX matmul tile sizes for the host CPU on startup.");
+
+// Process-wide table referenced by iree_vmvx_set_tile_sizes_table.
+static iree_vmvx_tile_sizes_table_t iree_tooling_vmvx_tile_sizes_table;
+
+static iree_status_t iree_tooling_configure_vmvx_tile_sizes_from_flags(
+    iree_allocator_t host_allocator) {
+  iree_string_view_t path = iree_make_cstring_view(FLAG_vmvx_tile_sizes);
+  if (iree_string_view_is_empty(path) && !FLAG_vmvx_tune_tile_sizes) {
+    return iree_ok_status();
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_string_builder_t cpu_model_builder;
+  iree_string_builder_initialize(host_allocator, &cpu_model_builder);
+  iree_status_t status = iree_vmvx_query_cpu_model(&cpu_model_builder);
+  iree_string_view_t cpu_model = iree_string_builder_view(&cpu_model_builder);
+  iree_string_builder_t builder;
+  iree_string_builder_initialize(host_allocator, &builder);
+
+  // Load existing entries for this CPU model, if any.
+  iree_io_file_contents_t* file_contents = NULL;
+  iree_vmvx_tile_sizes_table_t* table = &iree_tooling_vmvx_tile_sizes_table;
+  iree_vmvx_set_tile_sizes_table(NULL);
+  iree_vmvx_tile_sizes_table_initialize(table);
+  if (iree_status_is_ok(status) && !iree_string_view_is_empty(path)) {
+    status = iree_io_file_contents_read(path, host_allocator, &file_contents);
+    if (iree_status_is_not_found(status) && FLAG_vmvx_tune_tile_sizes) {
+      // Created below after tuning.
+      status = iree_status_ignore(status);
+    }
+  }
+  if (iree_status_is_ok(status) && file_contents) {
+    status = iree_vmvx_tile_sizes_table_parse(
+        iree_make_string_view((const char*)file_contents->const_buffer.data,
+                              file_contents->const_buffer.data_length),
+        cpu_model, table);
+  }
+
+  // Tune if requested and not already tuned for this CPU model.
+  if (iree_status_is_ok(status) && FLAG_vmvx_tune_tile_sizes &&
+      table->count == 0) {
+    status = iree_vmvx_tile_sizes_table_tune(iree_cpu_data_fields(),
+                                             host_allocator, table);
+    if (iree_status_is_ok(status) && !iree_string_view_is_empty(path)) {
+      if (file_contents) {
+        status = iree_string_builder_append_string(
+            &builder, iree_make_string_view(
+                          (const char*)file_contents->const_buffer.data,
+                          file_contents->const_buffer.data_length));
+      } else {
+        status = iree_string_builder_append_cstring(
+            &builder,
+            "# VMVX matmul tile sizes:\n"
+            "# <operation> <M0> <K0> <N0> <max_rows> <cpu model>\n");
+      }
+      if (iree_status_is_ok(status)) {
+        status = iree_vmvx_tile_sizes_table_format(table, cpu_model, &builder);
+      }
+      if (iree_status_is_ok(status)) {
+        status = iree_io_file_contents_write(
+            path,
+            iree_make_const_byte_span(iree_string_builder_buffer(&builder),
+                                      iree_string_builder_size(&builder)),
+            host_allocator);
+      }
+    }
+  }
+
+  if (iree_status_is_ok(status) && table->count > 0) {
+    iree_vmvx_set_tile_sizes_table(table);
+  }
+  iree_io_file_contents_free(file_contents);
+  iree_string_builder_deinitialize(&builder);
+  iree_string_builder_deinitialize(&cpu_model_builder);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
 iree_status_t iree_tooling_create_instance(iree_allocator_t host_allocator,
                                            iree_vm_instance_t** out_instance) {
   IREE_ASSERT_ARGUMENT(out_instance);
@@ -610,6 +707,9 @@ iree_status_t iree_tooling_create_instance(iree_allocator_t host_allocator,
   if (iree_status_is_ok(status)) {
     status = iree_tooling_register_all_module_types(instance);
   }
+  if (iree_status_is_ok(status)) {
+    status = iree_tooling_configure_vmvx_tile_sizes_from_flags(host_allocator);
+  }
 
   if (iree_status_is_ok(status)) {
     *out_instance = instance;
@@ -6,6 +6,8 @@
 
 #include "iree/tooling/function_io.h"
 
+#include "iree/io/file_contents.h"
+#include "iree/io/memory_stream.h"
 #include "iree/io/stdio_stream.h"
 #include "iree/io/stream.h"
 #include "iree/modules/hal/module.h"
@@ -21,6 +23,33 @@
 // kind of registry that the main iree_io_stream_open uses or allow
 // iree_io_file_handle_t to carry a factory function for opening the handles of
 // certain types. For now we shim things here at the leaf.
+
+static void iree_io_file_contents_stream_release(void* user_data,
+                                                 iree_io_stream_t* stream) {
+  iree_io_file_contents_free((iree_io_file_contents_t*)user_data);
+}
+
+// Maps the file at |path| into host memory and wraps it in a mappable stream.
+// Ranges of the stream can be imported as HAL buffers without copying on
+// devices that can access host memory.
+static iree_status_t iree_io_stream_map_path(iree_string_view_t path,
+                                             iree_allocator_t host_allocator,
+                                             iree_io_stream_t** out_stream) {
+  iree_io_file_contents_t* contents = NULL;
+  IREE_RETURN_IF_ERROR(iree_io_file_contents_map(
+      path, IREE_IO_FILE_ACCESS_READ, host_allocator, &contents));
+  iree_io_stream_release_callback_t release_callback = {
+      .fn = iree_io_file_contents_stream_release,
+      .user_data = contents,
+  };
+  iree_status_t status = iree_io_memory_stream_wrap(
+      IREE_IO_STREAM_MODE_READABLE | IREE_IO_STREAM_MODE_SEEKABLE |
+          IREE_IO_STREAM_MODE_MAPPABLE,
+      contents->buffer, release_callback, host_allocator, out_stream);
+  if (!iree_status_is_ok(status)) iree_io_file_contents_free(contents);
+  return status;
+}
+
 static iree_status_t iree_io_stream_open_path(iree_io_stdio_stream_mode_t mode,
                                               iree_string_view_t path,
                                               uint64_t file_offset,
@@ -34,7 +63,20 @@ static iree_status_t iree_io_stream_open_path(iree_io_stdio_stream_mode_t mode,
   iree_status_t status = iree_ok_status();
   iree_io_stream_t* stream = NULL;
 
-  status = iree_io_stdio_stream_open(mode, path, host_allocator, &stream);
+  // Prefer mapping files that are only read so that their contents can be
+  // imported directly. Mapping fails on empty files, special files, and
+  // binaries without file IO support and we fall back to stdio for those.
+  if (mode == IREE_IO_STDIO_STREAM_MODE_READ) {
+    status = iree_io_stream_map_path(path, host_allocator, &stream);
+    if (!iree_status_is_ok(status)) {
+      status = iree_status_ignore(status);
+      stream = NULL;
+    }
+  }
+
+  if (!stream) {
+    status = iree_io_stdio_stream_open(mode, path, host_allocator, &stream);
+  }
   if (iree_status_is_ok(status) && file_offset > 0) {
     status = iree_io_stream_seek(stream, IREE_IO_STREAM_SEEK_SET, file_offset);
   }
@@ -405,11 +447,13 @@ static iree_status_t iree_tooling_parse_buffer_view_file_callback(
 // from the file reference in |string| which has the prefix `@` to indicate
 // the contents starting from 0 and `+` for the next contents in an already
 // opened stream.
-// The file contents are directly read in to memory with no processing.
+// The file contents are directly read in to memory with no processing. If
+// |allow_import| is true and the device can access the mapped file in place
+// the buffer view will reference the (read-only) file contents directly.
 static iree_status_t iree_tooling_parse_buffer_view_file(
-    iree_string_view_t metadata, iree_string_view_t string,
+    iree_string_view_t metadata, iree_string_view_t string, bool allow_import,
     iree_hal_device_t* device, iree_hal_allocator_t* device_allocator,
-    iree_io_stream_list_t* stream_list,
+    iree_io_stream_list_t* stream_list, iree_allocator_t host_allocator,
     iree_hal_buffer_view_t** out_buffer_view) {
   IREE_TRACE_ZONE_BEGIN(z0);
   IREE_TRACE_ZONE_APPEND_TEXT(z0, string.data, string.size);
@@ -437,24 +481,48 @@ static iree_status_t iree_tooling_parse_buffer_view_file(
   IREE_RETURN_AND_END_ZONE_IF_ERROR(
       z0, iree_io_stream_list_open(stream_list, path, is_append, &stream));
 
-  // TODO(benvanik): support mapping on allocators that can handle importing
-  // host memory. We only want to do this when it won't hurt performance
-  // (unified memory systems and where the mapped memory meets alignment
-  // requirements). For now we always wire new device memory to read into.
-  // A real application would want to either do the import or use
-  // iree_hal_file_t to stream the file contents into device memory without
-  // going through host memory.
+  // Try to import the mapped file contents directly. This only happens when it
+  // won't hurt performance (unified memory systems and where the mapped memory
+  // meets alignment requirements). Imported buffers are read-only as the file
+  // is mapped read-only.
+  iree_status_t status = iree_ok_status();
+  iree_hal_buffer_t* imported_buffer = NULL;
+  if (allow_import) {
+    iree_device_size_t byte_length = 0;
+    status = iree_hal_buffer_compute_view_size(
+        shape_rank, shape, element_type, encoding_type, &byte_length);
+    if (iree_status_is_ok(status)) {
+      iree_hal_buffer_params_t import_params = {
+          .usage = IREE_HAL_BUFFER_USAGE_DEFAULT,
+          .access = IREE_HAL_MEMORY_ACCESS_READ,
+          .type = IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL,
+      };
+      status = iree_numpy_try_import_contents(
+          stream, byte_length, import_params, device_allocator,
+          &imported_buffer);
+    }
+    if (iree_status_is_ok(status) && imported_buffer) {
+      IREE_TRACE_ZONE_APPEND_TEXT(z0, "imported");
+      status = iree_hal_buffer_view_create(imported_buffer, shape_rank, shape,
+                                           element_type, encoding_type,
+                                           host_allocator, out_buffer_view);
+    }
+  }
 
-  // Read the stream contents into the buffer.
-  iree_hal_buffer_params_t buffer_params = {
-      .usage = IREE_HAL_BUFFER_USAGE_DEFAULT,
-      .access = IREE_HAL_MEMORY_ACCESS_ALL,
-      .type = IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL,
-  };
-  iree_status_t status = iree_hal_buffer_view_generate_buffer(
-      device, device_allocator, shape_rank, shape, element_type, encoding_type,
-      buffer_params, iree_tooling_parse_buffer_view_file_callback, stream,
-      out_buffer_view);
+  // Read the stream contents into a new buffer.
+  if (iree_status_is_ok(status) && !imported_buffer) {
+    iree_hal_buffer_params_t buffer_params = {
+        .usage = IREE_HAL_BUFFER_USAGE_DEFAULT,
+        .access = IREE_HAL_MEMORY_ACCESS_ALL,
+        .type = IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL,
+    };
+    status = iree_hal_buffer_view_generate_buffer(
+        device, device_allocator, shape_rank, shape, element_type,
+        encoding_type, buffer_params,
+        iree_tooling_parse_buffer_view_file_callback, stream, out_buffer_view);
+  }
+
+  iree_hal_buffer_release(imported_buffer);
 
   iree_io_stream_release(stream);
   IREE_TRACE_ZONE_END(z0);
@@ -462,8 +530,10 @@ static iree_status_t iree_tooling_parse_buffer_view_file(
 }
 
 // Parses a shaped tensor type into a HAL buffer view.
+// If |allow_import| is true file contents may be referenced in place and the
+// resulting buffer may be read-only.
 static iree_status_t iree_tooling_parse_tensor(
-    iree_string_view_t string, iree_hal_device_t* device,
+    iree_string_view_t string, bool allow_import, iree_hal_device_t* device,
     iree_hal_allocator_t* device_allocator, iree_io_stream_list_t* stream_list,
     iree_allocator_t host_allocator, iree_hal_buffer_view_t** out_buffer_view) {
   // If contents are sourced from a file then route to that, and otherwise
@@ -472,9 +542,9 @@ static iree_status_t iree_tooling_parse_tensor(
   if (iree_string_view_split(string, '=', &metadata, &contents) != -1) {
     if (iree_string_view_starts_with(contents, IREE_SV("@")) ||
         iree_string_view_starts_with(contents, IREE_SV("+"))) {
-      return iree_tooling_parse_buffer_view_file(metadata, contents, device,
-                                                 device_allocator, stream_list,
-                                                 out_buffer_view);
+      return iree_tooling_parse_buffer_view_file(
+          metadata, contents, allow_import, device, device_allocator,
+          stream_list, host_allocator, out_buffer_view);
     }
   }
 
@@ -512,8 +582,9 @@ static iree_status_t iree_tooling_parse_tensor_into(
   // Parse the tensor contents.
   iree_hal_buffer_view_t* buffer_view = NULL;
   IREE_RETURN_AND_END_ZONE_IF_ERROR(
-      z0, iree_tooling_parse_tensor(string, device, device_allocator,
-                                    stream_list, host_allocator, &buffer_view));
+      z0, iree_tooling_parse_tensor(string, /*allow_import=*/true, device,
+                                    device_allocator, stream_list,
+                                    host_allocator, &buffer_view));
 
   // Add buffer view to list.
   iree_vm_ref_t buffer_view_ref = iree_hal_buffer_view_move_ref(buffer_view);
@@ -535,11 +606,13 @@ static iree_status_t iree_tooling_parse_storage_into(
   // Expect a ref holding the buffer.
   IREE_RETURN_AND_END_ZONE_IF_ERROR(z0, iree_tooling_consume_cconv(cconv, 'r'));
 
-  // Parse the tensor contents.
+  // Parse the tensor contents. Storage is written by the program and must not
+  // reference the read-only file contents.
   iree_hal_buffer_view_t* buffer_view = NULL;
   IREE_RETURN_AND_END_ZONE_IF_ERROR(
-      z0, iree_tooling_parse_tensor(string, device, device_allocator,
-                                    stream_list, host_allocator, &buffer_view));
+      z0, iree_tooling_parse_tensor(string, /*allow_import=*/false, device,
+                                    device_allocator, stream_list,
+                                    host_allocator, &buffer_view));
 
   // Add just the storage buffer to the list - we don't need the metadata.
   iree_vm_ref_t buffer_ref =
@@ -568,7 +641,7 @@ static iree_status_t iree_tooling_parse_ndarray_into(
   };
   iree_hal_buffer_view_t* buffer_view = NULL;
   iree_status_t status = iree_numpy_npy_load_ndarray(
-      stream, IREE_NUMPY_NPY_LOAD_OPTION_DEFAULT, buffer_params, device,
+      stream, IREE_NUMPY_NPY_LOAD_OPTION_MAP_FILE, buffer_params, device,
       device_allocator, &buffer_view);
 
   if (iree_status_is_ok(status)) {
@@ -679,6 +752,12 @@ static iree_status_t iree_tooling_parse_variants_into(
   // Parse each variant string. Note that some strings may expand to zero or
   // more variants and so we need to consume the cconv based on how many were
   // parsed.
+  //
+  // NOTE: inputs are loaded one at a time. Arrays that can be imported from a
+  // mapped file cost nothing to load but arrays that fall back to copying
+  // (discrete devices, unaligned contents) are read sequentially: the offset
+  // of each array in a concatenated .npy file is only known after parsing the
+  // header of the one before it. .npz archives are not supported.
   iree_status_t status = iree_ok_status();
   for (iree_host_size_t i = 0; i < specs.count; ++i) {
     iree_string_view_t string = iree_string_view_trim(specs.values[i]);
@@ -1075,21 +1154,14 @@ static iree_status_t iree_tooling_write_variant_to_binary_file(
   iree_hal_buffer_view_t* buffer_view = NULL;
   IREE_RETURN_IF_ERROR(iree_tooling_create_buffer_view_from_variant(
       variant, device_allocator, host_allocator, &buffer_view));
+  iree_hal_buffer_t* buffer = iree_hal_buffer_view_buffer(buffer_view);
   iree_device_size_t byte_length =
       iree_hal_buffer_view_byte_length(buffer_view);
 
-  // Map the buffer memory into a host pointer so we can access it.
-  iree_hal_buffer_mapping_t mapping;
-  iree_status_t status = iree_hal_buffer_map_range(
-      iree_hal_buffer_view_buffer(buffer_view), IREE_HAL_MAPPING_MODE_SCOPED,
-      IREE_HAL_MEMORY_ACCESS_READ, 0, IREE_HAL_WHOLE_BUFFER, &mapping);
-
-  // Write to the file from the mapped memory.
-  if (iree_status_is_ok(status)) {
-    status = iree_io_stream_write(stream, byte_length, mapping.contents.data);
-  }
-
-  iree_status_ignore(iree_hal_buffer_unmap_range(&mapping));
+  // Map the buffer memory into a host pointer in chunks and write each to the
+  // file so that we never need the entire buffer mapped at once.
+  iree_status_t status = iree_numpy_write_contents(
+      stream, buffer, /*offset=*/0, byte_length, /*chunk_size=*/0);
 
   iree_hal_buffer_view_release(buffer_view);
   return status;
@@ -356,10 +356,31 @@ IREE_API_EXPORT iree_status_t iree_numpy_npy_load_ndarray(
     if (!iree_status_is_ok(status)) break;
   }
 
+  // If mapping was requested try to use the stream contents directly. This is
+  // zero-copy when the stream is backed by a mapped file and the device can
+  // access host memory.
+  iree_hal_buffer_t* imported_buffer = NULL;
+  if (iree_status_is_ok(status) &&
+      iree_all_bits_set(options, IREE_NUMPY_NPY_LOAD_OPTION_MAP_FILE)) {
+    iree_device_size_t byte_length = 0;
+    status = iree_hal_buffer_compute_view_size(
+        shape_rank, shape, element_type, encoding_type, &byte_length);
+    if (iree_status_is_ok(status)) {
+      status = iree_numpy_try_import_contents(
+          stream, byte_length, buffer_params, device_allocator,
+          &imported_buffer);
+    }
+    if (iree_status_is_ok(status) && imported_buffer) {
+      status = iree_hal_buffer_view_create(imported_buffer, shape_rank, shape,
+                                           element_type, encoding_type,
+                                           host_allocator, out_buffer_view);
+    }
+  }
+
   // Allocate the buffer view and directly read into the allocated memory.
   // On targets where we can perform host mapping this will be zero-copy; on
   // others it'll at least be _somewhat_ efficient.
-  if (iree_status_is_ok(status)) {
+  if (iree_status_is_ok(status) && !imported_buffer) {
     iree_numpy_npy_read_params_t read_params = {
         .stream = stream,
     };
@@ -370,6 +391,7 @@ IREE_API_EXPORT iree_status_t iree_numpy_npy_load_ndarray(
         &read_params, out_buffer_view);
   }
 
+  iree_hal_buffer_release(imported_buffer);
   iree_allocator_free(host_allocator, header_buffer);
   IREE_TRACE_ZONE_END(z0);
   return status;
@@ -551,26 +573,6 @@ static iree_status_t iree_numpy_npy_write_header(
   return iree_ok_status();
 }
 
-// Writes |buffer_view| contents to |stream|.
-static iree_status_t iree_numpy_npy_write_bytes(
-    iree_io_stream_t* stream, iree_hal_buffer_view_t* buffer_view) {
-  iree_hal_buffer_t* buffer = iree_hal_buffer_view_buffer(buffer_view);
-  iree_device_size_t write_length =
-      iree_hal_buffer_view_byte_length(buffer_view);
-
-  iree_hal_buffer_mapping_t mapping;
-  IREE_RETURN_IF_ERROR(iree_hal_buffer_map_range(
-      buffer, IREE_HAL_MAPPING_MODE_SCOPED, IREE_HAL_MEMORY_ACCESS_READ, 0,
-      write_length, &mapping));
-
-  iree_status_t status = iree_status_annotate(
-      iree_io_stream_write(stream, write_length, mapping.contents.data),
-      IREE_SV("failed to write buffer contents"));
-
-  IREE_IGNORE_ERROR(iree_hal_buffer_unmap_range(&mapping));
-  return status;
-}
-
 IREE_API_EXPORT iree_status_t iree_numpy_npy_save_ndarray(
     iree_io_stream_t* stream, iree_numpy_npy_save_options_t options,
     iree_hal_buffer_view_t* buffer_view, iree_allocator_t host_allocator) {
@@ -592,10 +594,118 @@ IREE_API_EXPORT iree_status_t iree_numpy_npy_save_ndarray(
 
   // Write buffer contents.
   if (iree_status_is_ok(status)) {
-    status = iree_numpy_npy_write_bytes(stream, buffer_view);
+    status = iree_numpy_write_contents(
+        stream, iree_hal_buffer_view_buffer(buffer_view), /*offset=*/0,
+        iree_hal_buffer_view_byte_length(buffer_view), /*chunk_size=*/0);
   }
 
   iree_string_builder_deinitialize(&builder);
   IREE_TRACE_ZONE_END(z0);
   return status;
 }
+
+//===----------------------------------------------------------------------===//
+// Raw contents
+//===----------------------------------------------------------------------===//
+
+// Maximum number of bytes mapped at a time when writing contents.
+#if !defined(IREE_NUMPY_WRITE_CHUNK_SIZE)
+#define IREE_NUMPY_WRITE_CHUNK_SIZE (64 * 1024 * 1024)
+#endif  // !IREE_NUMPY_WRITE_CHUNK_SIZE
+
+static void iree_numpy_mapped_stream_buffer_release(
+    void* user_data, iree_hal_buffer_t* buffer) {
+  iree_io_stream_release((iree_io_stream_t*)user_data);
+}
+
+IREE_API_EXPORT iree_status_t iree_numpy_try_import_contents(
+    iree_io_stream_t* stream, iree_device_size_t length,
+    iree_hal_buffer_params_t buffer_params,
+    iree_hal_allocator_t* device_allocator, iree_hal_buffer_t** out_buffer) {
+  IREE_ASSERT_ARGUMENT(stream);
+  IREE_ASSERT_ARGUMENT(device_allocator);
+  IREE_ASSERT_ARGUMENT(out_buffer);
+  *out_buffer = NULL;
+  if (!length ||
+      !iree_all_bits_set(iree_io_stream_mode(stream),
+                         IREE_IO_STREAM_MODE_MAPPABLE) ||
+      iree_any_bit_set(buffer_params.access, IREE_HAL_MEMORY_ACCESS_WRITE)) {
+    return iree_ok_status();
+  }
+
+  // Only import if the device can use the host memory directly without a
+  // performance penalty; otherwise it's better to read into device memory.
+  iree_hal_buffer_params_t compat_params = buffer_params;
+  iree_device_size_t allocation_size = length;
+  iree_hal_buffer_compatibility_t compatibility =
+      iree_hal_allocator_query_buffer_compatibility(
+          device_allocator, buffer_params, length, &compat_params,
+          &allocation_size);
+  if (!iree_all_bits_set(compatibility,
+                         IREE_HAL_BUFFER_COMPATIBILITY_IMPORTABLE) ||
+      iree_any_bit_set(compatibility,
+                       IREE_HAL_BUFFER_COMPATIBILITY_LOW_PERFORMANCE)) {
+    return iree_ok_status();
+  }
+
+  iree_const_byte_span_t span = iree_const_byte_span_empty();
+  IREE_RETURN_IF_ERROR(
+      iree_io_stream_map_read(stream, (iree_host_size_t)length, &span));
+  iree_hal_external_buffer_t external_buffer = {
+      .type = IREE_HAL_EXTERNAL_BUFFER_TYPE_HOST_ALLOCATION,
+      .flags = IREE_HAL_EXTERNAL_BUFFER_FLAG_NONE,
+      .size = length,
+      .handle =
+          {
+              .host_allocation =
+                  {
+                      .ptr = (void*)span.data,
+                  },
+          },
+  };
+  iree_hal_buffer_release_callback_t release_callback = {
+      .fn = iree_numpy_mapped_stream_buffer_release,
+      .user_data = stream,
+  };
+  iree_io_stream_retain(stream);
+  iree_status_t status = iree_hal_allocator_import_buffer(
+      device_allocator, buffer_params, &external_buffer, release_callback,
+      out_buffer);
+  if (!iree_status_is_ok(status)) {
+    // Import may fail if the contents are not sufficiently aligned (arrays
+    // following the first in a concatenated file usually aren't). Rewind so
+    // the caller can read the contents instead.
+    iree_status_ignore(status);
+    status = iree_io_stream_seek(stream, IREE_IO_STREAM_SEEK_FROM_CURRENT,
+                                 -(iree_io_stream_pos_t)length);
+    iree_io_stream_release(stream);
+  }
+  return status;
+}
+
+IREE_API_EXPORT iree_status_t iree_numpy_write_contents(
+    iree_io_stream_t* stream, iree_hal_buffer_t* buffer,
+    iree_device_size_t offset, iree_device_size_t length,
+    iree_device_size_t chunk_size) {
+  IREE_ASSERT_ARGUMENT(stream);
+  IREE_ASSERT_ARGUMENT(buffer);
+  if (!chunk_size) chunk_size = IREE_NUMPY_WRITE_CHUNK_SIZE;
+  iree_status_t status = iree_ok_status();
+  for (iree_device_size_t written = 0;
+       iree_status_is_ok(status) && written < length;) {
+    iree_device_size_t chunk_length = iree_min(length - written, chunk_size);
+    iree_hal_buffer_mapping_t mapping;
+    status = iree_hal_buffer_map_range(buffer, IREE_HAL_MAPPING_MODE_SCOPED,
+                                       IREE_HAL_MEMORY_ACCESS_READ,
+                                       offset + written, chunk_length,
+                                       &mapping);
+    if (!iree_status_is_ok(status)) break;
+    status = iree_status_annotate(
+        iree_io_stream_write(stream, (iree_host_size_t)chunk_length,
+                             mapping.contents.data),
+        IREE_SV("failed to write buffer contents"));
+    IREE_IGNORE_ERROR(iree_hal_buffer_unmap_range(&mapping));
+    written += chunk_length;
+  }
+  return status;
+}
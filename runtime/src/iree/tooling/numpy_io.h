@@ -16,10 +16,11 @@
 // Pickled objects are not supported (similar to using `allow_pickle=False`) and
 // not all dtypes are supported.
 //
-// .npy and uncompressed .npz files can be mapped into host memory with
+// .npy files can be mapped into host memory with
 // IREE_NUMPY_NPY_LOAD_OPTION_MAP_FILE if the HAL device allocator
 // supports using such memory. On devices with discrete memory the contents will
-// be loaded into host memory and copied to the device.
+// be loaded into host memory and copied to the device. .npz archives are not
+// yet supported.
 //
 // This current implementation is very basic; in the future it'd be nice to
 // support an iree_io_stream_t to allow for externalizing the file access.
@@ -56,7 +57,10 @@ enum iree_numpy_npy_load_options_bits_t {
   // file system. Only available if the HAL device supports accessing mapped
   // data.
   // Like providing `mmap_mode` to `numpy.load`.
-  // May be ignored if the implementation does not support mapping.
+  // Requires a stream with IREE_IO_STREAM_MODE_MAPPABLE (such as a memory
+  // stream wrapping a mapped file) and buffer params without write access.
+  // The returned buffer view retains the stream. Ignored if the contents
+  // cannot be used in place (unaligned, discrete device memory, etc).
   IREE_NUMPY_NPY_LOAD_OPTION_MAP_FILE = 1u << 0,
 };
 typedef uint32_t iree_numpy_npy_load_options_t;
@@ -90,6 +94,7 @@ IREE_API_EXPORT iree_status_t iree_numpy_npy_load_ndarray(
 
 // Saves |buffer_view| to a .npy |stream|.
 // The ndarray will be appended to the stream to produce a concatenated file.
+// The buffer contents are mapped and written incrementally in bounded chunks.
 //
 // See `numpy.save`:
 // https://numpy.org/doc/stable/reference/generated/numpy.save.html
@@ -97,6 +102,35 @@ IREE_API_EXPORT iree_status_t iree_numpy_npy_save_ndarray(
     iree_io_stream_t* stream, iree_numpy_npy_save_options_t options,
     iree_hal_buffer_view_t* buffer_view, iree_allocator_t host_allocator);
 
+//===----------------------------------------------------------------------===//
+// Raw contents
+//===----------------------------------------------------------------------===//
+
+// Tries to import |length| bytes at the current position of |stream| as a
+// buffer that directly references the stream memory. The stream is retained
+// by the buffer and positioned immediately following the contents.
+//
+// Returns NULL in |out_buffer| with the stream position unchanged if the
+// contents cannot be used in place: the stream is not
+// IREE_IO_STREAM_MODE_MAPPABLE, |buffer_params| requests write access, the
+// device cannot use host memory without a performance penalty, or the
+// contents do not meet the allocator's alignment requirements. Callers are
+// expected to fall back to reading the contents into a new allocation.
+IREE_API_EXPORT iree_status_t iree_numpy_try_import_contents(
+    iree_io_stream_t* stream, iree_device_size_t length,
+    iree_hal_buffer_params_t buffer_params,
+    iree_hal_allocator_t* device_allocator, iree_hal_buffer_t** out_buffer);
+
+// Writes |length| bytes of |buffer| starting at |offset| to |stream|.
+// Contents are mapped and written in chunks of at most |chunk_size| bytes so
+// that large buffers are streamed instead of requiring the entire buffer be
+// mapped at once (which may require a staging copy on some devices). A
+// |chunk_size| of 0 uses a default of IREE_NUMPY_WRITE_CHUNK_SIZE.
+IREE_API_EXPORT iree_status_t iree_numpy_write_contents(
+    iree_io_stream_t* stream, iree_hal_buffer_t* buffer,
+    iree_device_size_t offset, iree_device_size_t length,
+    iree_device_size_t chunk_size);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
@@ -40,19 +40,27 @@ class NumpyIOTest : public ::testing::Test {
 
   virtual void TearDown() { iree_hal_device_release(device_); }
 
-  StreamPtr OpenInputFile(const char* name) {
+  iree_const_byte_span_t InputFileContents(const char* name) {
     const struct iree_file_toc_t* file_toc = iree_numpy_npy_files_create();
     for (size_t i = 0; i < iree_numpy_npy_files_size(); ++i) {
       if (strcmp(file_toc[i].name, name) != 0) continue;
-      iree_io_stream_t* stream = NULL;
-      IREE_CHECK_OK(iree_io_memory_stream_wrap(
-          IREE_IO_STREAM_MODE_READABLE | IREE_IO_STREAM_MODE_SEEKABLE,
-          iree_make_byte_span((void*)file_toc[i].data, file_toc[i].size),
-          iree_io_stream_release_callback_null(), iree_allocator_system(),
-          &stream));
-      return StreamPtr(stream, iree_io_stream_release);
+      return iree_make_const_byte_span(file_toc[i].data, file_toc[i].size);
     }
-    return StreamPtr{nullptr, iree_io_stream_release};
+    return iree_const_byte_span_empty();
+  }
+
+  StreamPtr OpenInputFile(const char* name,
+                          iree_io_stream_mode_t extra_mode = 0) {
+    iree_const_byte_span_t contents = InputFileContents(name);
+    if (!contents.data) return StreamPtr{nullptr, iree_io_stream_release};
+    iree_io_stream_t* stream = NULL;
+    IREE_CHECK_OK(iree_io_memory_stream_wrap(
+        IREE_IO_STREAM_MODE_READABLE | IREE_IO_STREAM_MODE_SEEKABLE |
+            extra_mode,
+        iree_make_byte_span((void*)contents.data, contents.data_length),
+        iree_io_stream_release_callback_null(), iree_allocator_system(),
+        &stream));
+    return StreamPtr(stream, iree_io_stream_release);
   }
 
   StreamPtr OpenOutputFile(const char* name) {
@@ -94,6 +102,21 @@ static void AssertBufferViewContents(iree_hal_buffer_view_t* buffer_view,
   ASSERT_THAT(actual_contents, ElementsAreArray(expected_contents));
 }
 
+// Asserts that the contents of |buffer| are stored within |source| (and thus
+// were imported instead of copied).
+static void AssertBufferAliases(iree_hal_buffer_t* buffer,
+                                iree_const_byte_span_t source) {
+  iree_hal_buffer_mapping_t mapping;
+  IREE_ASSERT_OK(iree_hal_buffer_map_range(
+      buffer, IREE_HAL_MAPPING_MODE_SCOPED, IREE_HAL_MEMORY_ACCESS_READ, 0,
+      IREE_HAL_WHOLE_BUFFER, &mapping));
+  const uint8_t* data = mapping.contents.data;
+  const iree_host_size_t data_length = mapping.contents.data_length;
+  IREE_ASSERT_OK(iree_hal_buffer_unmap_range(&mapping));
+  EXPECT_GE(data, source.data);
+  EXPECT_LE(data + data_length, source.data + source.data_length);
+}
+
 template <typename T>
 static void LoadArrayAndAssertContents(iree_io_stream_t* stream,
                                        iree_hal_device_t* device,
@@ -101,17 +124,25 @@ static void LoadArrayAndAssertContents(iree_io_stream_t* stream,
                                        std::vector<iree_hal_dim_t> shape,
                                        iree_hal_element_type_t element_type,
                                        iree_hal_encoding_type_t encoding_type,
-                                       std::vector<T> contents) {
+                                       std::vector<T> contents,
+                                       iree_numpy_npy_load_options_t options =
+                                           IREE_NUMPY_NPY_LOAD_OPTION_DEFAULT,
+                                       iree_const_byte_span_t imported_from =
+                                           iree_const_byte_span_empty()) {
   iree_hal_buffer_params_t buffer_params = {};
   buffer_params.usage = IREE_HAL_BUFFER_USAGE_TRANSFER;
   buffer_params.access = IREE_HAL_MEMORY_ACCESS_READ;
   buffer_params.type = IREE_HAL_MEMORY_TYPE_HOST_LOCAL;
   iree_hal_buffer_view_t* buffer_view = NULL;
-  IREE_ASSERT_OK(iree_numpy_npy_load_ndarray(
-      stream, IREE_NUMPY_NPY_LOAD_OPTION_DEFAULT, buffer_params, device,
-      device_allocator, &buffer_view));
+  IREE_ASSERT_OK(iree_numpy_npy_load_ndarray(stream, options, buffer_params,
+                                             device, device_allocator,
+                                             &buffer_view));
   AssertBufferViewContents<T>(buffer_view, shape, element_type, encoding_type,
                               contents);
+  if (imported_from.data && !contents.empty()) {
+    AssertBufferAliases(iree_hal_buffer_view_buffer(buffer_view),
+                        imported_from);
+  }
   iree_hal_buffer_view_release(buffer_view);
 }
 
@@ -177,6 +208,73 @@ TEST_F(NumpyIOTest, LoadMultipleArrays) {
   ASSERT_TRUE(iree_io_stream_is_eos(stream.get()));
 }
 
+// Tests loading multiple arrays from a mappable stream. The first array is
+// aligned within the file and is imported in place while the others are not
+// sufficiently aligned for the heap allocator and fall back to copying.
+TEST_F(NumpyIOTest, LoadMultipleArraysMapped) {
+  iree_const_byte_span_t file_contents = InputFileContents("multiple.npy");
+  auto stream = OpenInputFile("multiple.npy", IREE_IO_STREAM_MODE_MAPPABLE);
+
+  // np.array([1.1, 2.2, 3.3], dtype=np.float32)
+  LoadArrayAndAssertContents<float>(
+      stream.get(), device_, device_allocator_, {3},
+      IREE_HAL_ELEMENT_TYPE_FLOAT_32, IREE_HAL_ENCODING_TYPE_DENSE_ROW_MAJOR,
+      {1.1f, 2.2f, 3.3f}, IREE_NUMPY_NPY_LOAD_OPTION_MAP_FILE, file_contents);
+
+  // np.array([[0, 1], [2, 3]], dtype=np.int32)
+  LoadArrayAndAssertContents<int32_t>(
+      stream.get(), device_, device_allocator_, {2, 2},
+      IREE_HAL_ELEMENT_TYPE_SINT_32, IREE_HAL_ENCODING_TYPE_DENSE_ROW_MAJOR,
+      {0, 1, 2, 3}, IREE_NUMPY_NPY_LOAD_OPTION_MAP_FILE);
+
+  // np.array(42, dtype=np.int32)
+  LoadArrayAndAssertContents<int32_t>(
+      stream.get(), device_, device_allocator_, {},
+      IREE_HAL_ELEMENT_TYPE_SINT_32, IREE_HAL_ENCODING_TYPE_DENSE_ROW_MAJOR,
+      {42}, IREE_NUMPY_NPY_LOAD_OPTION_MAP_FILE);
+
+  // Should have hit EOF.
+  ASSERT_TRUE(iree_io_stream_is_eos(stream.get()));
+}
+
+// Tests that contents are only imported when they can be used in place and
+// that the stream is left untouched otherwise.
+TEST_F(NumpyIOTest, TryImportContents) {
+  iree_const_byte_span_t file_contents = InputFileContents("single.npy");
+  iree_hal_buffer_params_t buffer_params = {};
+  buffer_params.usage = IREE_HAL_BUFFER_USAGE_TRANSFER;
+  buffer_params.access = IREE_HAL_MEMORY_ACCESS_READ;
+  buffer_params.type = IREE_HAL_MEMORY_TYPE_HOST_LOCAL;
+  const iree_device_size_t length = 16;
+  iree_hal_buffer_t* buffer = NULL;
+
+  // Streams that cannot be mapped are not imported.
+  auto unmappable_stream = OpenInputFile("single.npy");
+  IREE_ASSERT_OK(iree_numpy_try_import_contents(
+      unmappable_stream.get(), length, buffer_params, device_allocator_,
+      &buffer));
+  EXPECT_EQ(buffer, nullptr);
+  EXPECT_EQ(iree_io_stream_offset(unmappable_stream.get()), 0);
+
+  // Mapped files are read-only and cannot be imported for writing.
+  auto stream = OpenInputFile("single.npy", IREE_IO_STREAM_MODE_MAPPABLE);
+  iree_hal_buffer_params_t write_params = buffer_params;
+  write_params.access |= IREE_HAL_MEMORY_ACCESS_WRITE;
+  IREE_ASSERT_OK(iree_numpy_try_import_contents(
+      stream.get(), length, write_params, device_allocator_, &buffer));
+  EXPECT_EQ(buffer, nullptr);
+  EXPECT_EQ(iree_io_stream_offset(stream.get()), 0);
+
+  // Read-only imports reference the stream memory and advance the stream.
+  IREE_ASSERT_OK(iree_numpy_try_import_contents(
+      stream.get(), length, buffer_params, device_allocator_, &buffer));
+  ASSERT_NE(buffer, nullptr);
+  EXPECT_EQ(iree_io_stream_offset(stream.get()), length);
+  EXPECT_EQ(iree_hal_buffer_byte_length(buffer), length);
+  AssertBufferAliases(buffer, file_contents);
+  iree_hal_buffer_release(buffer);
+}
+
 // Tests loading arrays with various shapes.
 TEST_F(NumpyIOTest, ArrayShapes) {
   auto stream = OpenInputFile("array_shapes.npy");
@@ -400,5 +498,39 @@ TEST_F(NumpyIOTest, RoundTripArrayTypes) {
   CompareStreams(source_stream.get(), target_stream.get());
 }
 
+// Tests writing a subrange of a buffer in chunks smaller than the range,
+// including a trailing partial chunk.
+TEST_F(NumpyIOTest, WriteContentsInChunks) {
+  std::vector<uint8_t> source_data(16);
+  for (size_t i = 0; i < source_data.size(); ++i) source_data[i] = (uint8_t)i;
+  iree_hal_buffer_params_t buffer_params = {};
+  buffer_params.usage =
+      IREE_HAL_BUFFER_USAGE_TRANSFER | IREE_HAL_BUFFER_USAGE_MAPPING;
+  buffer_params.access = IREE_HAL_MEMORY_ACCESS_ALL;
+  buffer_params.type =
+      IREE_HAL_MEMORY_TYPE_HOST_LOCAL | IREE_HAL_MEMORY_TYPE_DEVICE_VISIBLE;
+  iree_hal_buffer_t* buffer = NULL;
+  IREE_ASSERT_OK(iree_hal_allocator_allocate_buffer(
+      device_allocator_, buffer_params, source_data.size(), &buffer));
+  IREE_ASSERT_OK(iree_hal_buffer_map_write(buffer, 0, source_data.data(),
+                                           source_data.size()));
+
+  // 14 bytes starting at offset 1 in 3 byte chunks is 4 full chunks and a
+  // 2 byte chunk.
+  auto stream = OpenOutputFile("chunks.bin");
+  IREE_ASSERT_OK(iree_numpy_write_contents(stream.get(), buffer, /*offset=*/1,
+                                           /*length=*/14, /*chunk_size=*/3));
+  iree_hal_buffer_release(buffer);
+
+  ASSERT_EQ(iree_io_stream_length(stream.get()), 14);
+  IREE_ASSERT_OK(iree_io_stream_seek(stream.get(), IREE_IO_STREAM_SEEK_SET, 0));
+  std::vector<uint8_t> target_data(14);
+  IREE_ASSERT_OK(iree_io_stream_read(stream.get(), target_data.size(),
+                                     target_data.data(), NULL));
+  EXPECT_THAT(target_data,
+              ElementsAreArray(source_data.begin() + 1,
+                               source_data.begin() + 1 + target_data.size()));
+}
+
 }  // namespace
 }  // namespace iree
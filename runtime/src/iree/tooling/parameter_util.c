@@ -20,9 +20,15 @@
 
 IREE_FLAG(
     string, parameter_mode, "file",
-    "A parameter I/O mode of ['preload', 'file'].\n"
+    "A parameter I/O mode of ['preload', 'file', 'direct'].\n"
     "  preload: read entire parameter files into wired memory on startup.\n"
-    "  file: uses platform file APIs to read/write the file as needed.");
+    "  file: uses platform file APIs to read/write the file as needed.\n"
+    "  direct: like file but streams loads in file order with unbuffered\n"
+    "          direct I/O (where supported) to bypass the page cache.");
+
+IREE_FLAG(bool, parameter_verify_checksums, false,
+          "Verifies the contents of parameters that carry checksums the first\n"
+          "time they are read and fails if they are corrupt.");
 
 // Opens the parameter file at |path| with the mode specified by the
 // --parameter_mode flag and returns its handle.
@@ -39,7 +45,10 @@ static iree_status_t iree_io_open_parameter_file(
   if (strcmp(FLAG_parameter_mode, "preload") == 0) {
     status = iree_io_file_handle_preload(IREE_IO_FILE_MODE_READ, path,
                                          host_allocator, &file_handle);
-  } else if (strcmp(FLAG_parameter_mode, "file") == 0) {
+  } else if (strcmp(FLAG_parameter_mode, "file") == 0 ||
+             strcmp(FLAG_parameter_mode, "direct") == 0) {
+    // Direct I/O requires aligned reads and the parsers don't perform any; the
+    // direct loader reopens the file for direct I/O itself.
     status = iree_io_file_handle_open(IREE_IO_FILE_MODE_READ, path,
                                       host_allocator, &file_handle);
   } else {
@@ -137,16 +146,24 @@ iree_status_t iree_tooling_create_parameters_module_from_flags(
       iree_tooling_build_parameter_indices_from_flags(&scope_map);
 
   // Create one provider per scope.
+  iree_io_parameter_index_provider_options_t provider_options;
+  iree_io_parameter_index_provider_options_initialize(&provider_options);
+  if (strcmp(FLAG_parameter_mode, "direct") == 0) {
+    provider_options.flags |= IREE_IO_PARAMETER_INDEX_PROVIDER_FLAG_DIRECT_IO;
+  }
+  if (FLAG_parameter_verify_checksums) {
+    provider_options.flags |=
+        IREE_IO_PARAMETER_INDEX_PROVIDER_FLAG_VERIFY_CHECKSUMS;
+  }
   iree_host_size_t provider_count = 0;
   iree_io_parameter_provider_t** providers =
       (iree_io_parameter_provider_t**)iree_alloca(
           scope_map.count * sizeof(iree_io_parameter_provider_t*));
   if (iree_status_is_ok(status)) {
     for (iree_host_size_t i = 0; i < scope_map.count; ++i) {
-      status = iree_io_parameter_index_provider_create(
+      status = iree_io_parameter_index_provider_create_with_options(
           scope_map.entries[i]->scope, scope_map.entries[i]->index,
-          IREE_IO_PARAMETER_INDEX_PROVIDER_DEFAULT_MAX_CONCURRENT_OPERATIONS,
-          host_allocator, &providers[i]);
+          &provider_options, host_allocator, &providers[i]);
       if (!iree_status_is_ok(status)) break;
       ++provider_count;
     }
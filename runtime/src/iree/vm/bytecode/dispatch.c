@@ -102,6 +102,14 @@ static iree_status_t iree_vm_bytecode_function_enter(
     return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
                             "import ordinal out of range");
   }
+#if IREE_VM_BYTECODE_VERIFICATION_ENABLE
+  // Functions in modules with deferred verification are verified on first use
+  // prior to trusting any of their descriptor information.
+  if (IREE_UNLIKELY(module->function_verified_flags)) {
+    IREE_RETURN_IF_ERROR(iree_vm_bytecode_module_verify_function_lazily(
+        module, (uint16_t)function.ordinal));
+  }
+#endif  // IREE_VM_BYTECODE_VERIFICATION_ENABLE
   const iree_vm_FunctionDescriptor_t* target_descriptor =
       &module->function_descriptor_table[function.ordinal];
 
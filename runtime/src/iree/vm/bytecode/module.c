@@ -858,10 +858,40 @@ static iree_status_t iree_vm_bytecode_module_resume_call(
   return iree_vm_bytecode_dispatch_resume(stack, module, call_results);  // tail
 }
 
+iree_status_t iree_vm_bytecode_module_verify_function_lazily(
+    iree_vm_bytecode_module_t* module, uint16_t function_ordinal) {
+  iree_atomic_int32_t* verified_flag =
+      &module->function_verified_flags[function_ordinal];
+  if (IREE_LIKELY(
+          iree_atomic_load(verified_flag, iree_memory_order_acquire) != 0)) {
+    return iree_ok_status();
+  }
+
+  // Verification has no side effects so concurrent first calls from multiple
+  // threads may each verify the function before one publishes the result.
+  IREE_TRACE_ZONE_BEGIN_NAMED(z0, "iree_vm_bytecode_function_verify");
+  iree_status_t status = iree_vm_bytecode_function_verify(
+      module, function_ordinal, module->allocator);
+  if (iree_status_is_ok(status)) {
+    iree_atomic_store(verified_flag, 1, iree_memory_order_release);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
 IREE_API_EXPORT iree_status_t iree_vm_bytecode_module_create(
     iree_vm_instance_t* instance, iree_const_byte_span_t archive_contents,
     iree_allocator_t archive_allocator, iree_allocator_t allocator,
     iree_vm_module_t** out_module) {
+  return iree_vm_bytecode_module_create_with_flags(
+      instance, IREE_VM_BYTECODE_MODULE_FLAG_NONE, archive_contents,
+      archive_allocator, allocator, out_module);
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_bytecode_module_create_with_flags(
+    iree_vm_instance_t* instance, iree_vm_bytecode_module_flags_t flags,
+    iree_const_byte_span_t archive_contents, iree_allocator_t archive_allocator,
+    iree_allocator_t allocator, iree_vm_module_t** out_module) {
   IREE_TRACE_ZONE_BEGIN(z0);
   IREE_ASSERT_ARGUMENT(out_module);
   *out_module = NULL;
@@ -902,19 +932,36 @@ IREE_API_EXPORT iree_status_t iree_vm_bytecode_module_create(
   size_t rodata_ref_table_size =
       iree_host_align(rodata_ref_count * sizeof(iree_vm_buffer_t), 16);
 
+  iree_vm_FunctionDescriptor_vec_t function_descriptors =
+      iree_vm_BytecodeModuleDef_function_descriptors(module_def);
+  iree_host_size_t function_descriptor_count =
+      iree_vm_FunctionDescriptor_vec_len(function_descriptors);
+  bool verify_lazily = false;
+#if IREE_VM_BYTECODE_VERIFICATION_ENABLE
+  verify_lazily =
+      iree_all_bits_set(flags, IREE_VM_BYTECODE_MODULE_FLAG_LAZY_VERIFICATION);
+#endif  // IREE_VM_BYTECODE_VERIFICATION_ENABLE
+  size_t function_verified_flags_size =
+      verify_lazily ? function_descriptor_count * sizeof(iree_atomic_int32_t)
+                    : 0;
+
   iree_vm_bytecode_module_t* module = NULL;
   IREE_RETURN_AND_END_ZONE_IF_ERROR(
-      z0,
-      iree_allocator_malloc(
-          allocator, sizeof(*module) + type_table_size + rodata_ref_table_size,
-          (void**)&module));
+      z0, iree_allocator_malloc(allocator,
+                                sizeof(*module) + type_table_size +
+                                    rodata_ref_table_size +
+                                    function_verified_flags_size,
+                                (void**)&module));
   module->allocator = allocator;
 
-  iree_vm_FunctionDescriptor_vec_t function_descriptors =
-      iree_vm_BytecodeModuleDef_function_descriptors(module_def);
-  module->function_descriptor_count =
-      iree_vm_FunctionDescriptor_vec_len(function_descriptors);
+  module->function_descriptor_count = function_descriptor_count;
   module->function_descriptor_table = function_descriptors;
+  if (verify_lazily) {
+    // Zero-initialized by the allocation to indicate unverified functions.
+    module->function_verified_flags =
+        (iree_atomic_int32_t*)((uint8_t*)module + sizeof(*module) +
+                               type_table_size + rodata_ref_table_size);
+  }
 
   flatbuffers_uint8_vec_t bytecode_data =
       iree_vm_BytecodeModuleDef_bytecode_data(module_def);
@@ -987,10 +1034,12 @@ IREE_API_EXPORT iree_status_t iree_vm_bytecode_module_create(
   }
 
   // Verify functions in the module now that we've verified the metadata that we
-  // need to do so.
+  // need to do so. When deferred each function is instead verified when it is
+  // first called.
   iree_status_t verify_status = iree_ok_status();
 #if IREE_VM_BYTECODE_VERIFICATION_ENABLE
-  for (uint16_t i = 0; i < module->function_descriptor_count; ++i) {
+  for (uint16_t i = 0; !verify_lazily && i < module->function_descriptor_count;
+       ++i) {
     IREE_TRACE_ZONE_BEGIN_NAMED(z1, "iree_vm_bytecode_function_verify");
     verify_status = iree_vm_bytecode_function_verify(module, i, allocator);
     IREE_TRACE_ZONE_END(z1);
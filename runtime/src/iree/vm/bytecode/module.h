@@ -14,6 +14,21 @@
 extern "C" {
 #endif  // __cplusplus
 
+// Controls bytecode module loading behavior.
+enum iree_vm_bytecode_module_flag_bits_t {
+  IREE_VM_BYTECODE_MODULE_FLAG_NONE = 0u,
+
+  // Defers verification of function bytecode until each function is first
+  // called instead of verifying all functions when the module is created.
+  // Modules with many rarely used functions (debug entry points, export
+  // variants, etc) only pay for verifying the functions that are executed.
+  // Module metadata is always verified on creation and malformed functions
+  // fail the call that first reaches them instead of module creation.
+  // Has no effect if IREE_VM_BYTECODE_VERIFICATION_ENABLE is disabled.
+  IREE_VM_BYTECODE_MODULE_FLAG_LAZY_VERIFICATION = 1u << 0,
+};
+typedef uint32_t iree_vm_bytecode_module_flags_t;
+
 // Creates a VM module from an in-memory ModuleDef FlatBuffer archive.
 // If a |archive_allocator| is provided then it will be used to free the
 // |archive_contents| when the module is destroyed and otherwise the ownership
@@ -23,6 +38,13 @@ IREE_API_EXPORT iree_status_t iree_vm_bytecode_module_create(
     iree_allocator_t archive_allocator, iree_allocator_t allocator,
     iree_vm_module_t** out_module);
 
+// Creates a VM module as with iree_vm_bytecode_module_create using |flags| to
+// control loading behavior.
+IREE_API_EXPORT iree_status_t iree_vm_bytecode_module_create_with_flags(
+    iree_vm_instance_t* instance, iree_vm_bytecode_module_flags_t flags,
+    iree_const_byte_span_t archive_contents, iree_allocator_t archive_allocator,
+    iree_allocator_t allocator, iree_vm_module_t** out_module);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
@@ -133,7 +133,9 @@ static iree_status_t RunFunction(iree_benchmark_state_t* benchmark_state,
   return iree_ok_status();
 }
 
-IREE_BENCHMARK_FN(BM_ModuleCreate) {
+// Benchmarks module creation and verification with the given |flags|.
+static iree_status_t RunModuleCreate(iree_benchmark_state_t* benchmark_state,
+                                     iree_vm_bytecode_module_flags_t flags) {
   iree_vm_instance_t* instance = NULL;
   IREE_CHECK_OK(iree_vm_instance_create(IREE_VM_TYPE_CAPACITY_DEFAULT,
                                         iree_allocator_system(), &instance));
@@ -142,8 +144,8 @@ IREE_BENCHMARK_FN(BM_ModuleCreate) {
     const auto* module_file_toc =
         iree_vm_bytecode_module_benchmark_module_create();
     iree_vm_module_t* module = nullptr;
-    IREE_CHECK_OK(iree_vm_bytecode_module_create(
-        instance,
+    IREE_CHECK_OK(iree_vm_bytecode_module_create_with_flags(
+        instance, flags,
         iree_const_byte_span_t{
             reinterpret_cast<const uint8_t*>(module_file_toc->data),
             static_cast<iree_host_size_t>(module_file_toc->size)},
@@ -158,8 +160,18 @@ IREE_BENCHMARK_FN(BM_ModuleCreate) {
   iree_vm_instance_release(instance);
   return iree_ok_status();
 }
+
+IREE_BENCHMARK_FN(BM_ModuleCreate) {
+  return RunModuleCreate(benchmark_state, IREE_VM_BYTECODE_MODULE_FLAG_NONE);
+}
 IREE_BENCHMARK_REGISTER(BM_ModuleCreate);
 
+IREE_BENCHMARK_FN(BM_ModuleCreateLazyVerification) {
+  return RunModuleCreate(benchmark_state,
+                         IREE_VM_BYTECODE_MODULE_FLAG_LAZY_VERIFICATION);
+}
+IREE_BENCHMARK_REGISTER(BM_ModuleCreateLazyVerification);
+
 IREE_BENCHMARK_FN(BM_ModuleCreateState) {
   iree_vm_instance_t* instance = NULL;
   IREE_CHECK_OK(iree_vm_instance_create(IREE_VM_TYPE_CAPACITY_DEFAULT,
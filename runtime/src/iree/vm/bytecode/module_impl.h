@@ -11,6 +11,7 @@
 #include <string.h>
 
 #include "iree/base/api.h"
+#include "iree/base/internal/atomics.h"
 #include "iree/vm/api.h"
 #include "iree/vm/bytecode/utils/isa.h"
 
@@ -34,6 +35,12 @@ typedef struct iree_vm_bytecode_module_t {
   // A pointer to the bytecode data embedded within the module.
   iree_const_byte_span_t bytecode_data;
 
+  // Per-function flags indicating whether the function bytecode has been
+  // verified, mapped 1:1 with |function_descriptor_table|. Only allocated when
+  // verification is deferred until first call and otherwise NULL as all
+  // functions are verified on creation.
+  iree_atomic_int32_t* function_verified_flags;
+
   // Allocator this module was allocated with and must be freed with.
   iree_allocator_t allocator;
 
@@ -96,6 +103,11 @@ typedef struct iree_vm_bytecode_module_state_t {
   iree_allocator_t allocator;
 } iree_vm_bytecode_module_state_t;
 
+// Verifies the bytecode of |function_ordinal| if it has not yet been verified.
+// Only valid to call when |module| has deferred verification.
+iree_status_t iree_vm_bytecode_module_verify_function_lazily(
+    iree_vm_bytecode_module_t* module, uint16_t function_ordinal);
+
 // Begins execution of the current frame and continues until either a yield or
 // return.
 iree_status_t iree_vm_bytecode_dispatch_begin(
@@ -10,13 +10,17 @@
 
 #include "iree/vm/bytecode/module.h"
 
+#include <cstring>
 #include <memory>
+#include <string>
 #include <vector>
 
 #include "iree/base/api.h"
 #include "iree/testing/gtest.h"
+#include "iree/schemas/bytecode_module_def_reader.h"
 #include "iree/testing/status_matchers.h"
 #include "iree/vm/api.h"
+#include "iree/vm/bytecode/archive.h"
 #include "iree/vm/bytecode/module_test_module_c.h"
 
 static bool operator==(const iree_vm_value_t& lhs,
@@ -107,15 +111,18 @@ using iree::testing::status::StatusIs;
 using iree::vm::ref;
 using testing::Eq;
 
-class VMBytecodeModuleTest : public ::testing::Test {
+// Parameterized on the module creation flags so that all tests run with both
+// eager and lazy function verification.
+class VMBytecodeModuleTest
+    : public ::testing::TestWithParam<iree_vm_bytecode_module_flags_t> {
  protected:
   virtual void SetUp() {
     IREE_CHECK_OK(iree_vm_instance_create(IREE_VM_TYPE_CAPACITY_DEFAULT,
                                           iree_allocator_system(), &instance_));
 
     const auto* module_file_toc = iree_vm_bytecode_module_test_module_create();
-    IREE_CHECK_OK(iree_vm_bytecode_module_create(
-        instance_,
+    IREE_CHECK_OK(iree_vm_bytecode_module_create_with_flags(
+        instance_, GetParam(),
         iree_const_byte_span_t{
             reinterpret_cast<const uint8_t*>(module_file_toc->data),
             static_cast<iree_host_size_t>(module_file_toc->size)},
@@ -208,24 +215,168 @@ class VMBytecodeModuleTest : public ::testing::Test {
   iree_vm_module_t* bytecode_module_ = nullptr;
 };
 
-TEST_F(VMBytecodeModuleTest, FuncIOEmpty) {
+TEST_P(VMBytecodeModuleTest, FuncIOEmpty) {
   EXPECT_THAT(RunFunction("FuncIOEmpty", std::vector<iree_vm_value_t>()),
               IsOkAndHolds(Eq(std::vector<iree_vm_value_t>())));
 }
 
-TEST_F(VMBytecodeModuleTest, FuncIO1) {
+TEST_P(VMBytecodeModuleTest, FuncIO1) {
   EXPECT_THAT(RunFunction("FuncIO1", MakeValuesList({1})),
               IsOkAndHolds(Eq(MakeValuesList({1}))));
 }
 
-TEST_F(VMBytecodeModuleTest, FuncIO8) {
+TEST_P(VMBytecodeModuleTest, FuncIO8) {
   EXPECT_THAT(RunFunction("FuncIO8", MakeValueRangeList(0, 7)),
               IsOkAndHolds(Eq(MakeValueRangeList(7, 0))));
 }
 
-TEST_F(VMBytecodeModuleTest, FuncIO600) {
+TEST_P(VMBytecodeModuleTest, FuncIO600) {
   EXPECT_THAT(RunFunction("FuncIO600", MakeNullRefList(600)),
               IsOkAndHolds(Eq(MakeNullRefList(600))));
 }
 
+TEST_P(VMBytecodeModuleTest, RepeatedCalls) {
+  // Lazily verified functions are only verified on the first call but must
+  // continue to execute on all subsequent ones.
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_THAT(RunFunction("FuncIO8", MakeValueRangeList(0, 7)),
+                IsOkAndHolds(Eq(MakeValueRangeList(7, 0))));
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    VMBytecodeModuleTest, VMBytecodeModuleTest,
+    ::testing::Values(IREE_VM_BYTECODE_MODULE_FLAG_NONE,
+                      IREE_VM_BYTECODE_MODULE_FLAG_LAZY_VERIFICATION),
+    [](const ::testing::TestParamInfo<iree_vm_bytecode_module_flags_t>& info) {
+      return info.param == IREE_VM_BYTECODE_MODULE_FLAG_LAZY_VERIFICATION
+                 ? std::string("LazyVerification")
+                 : std::string("EagerVerification");
+    });
+
+// Tests modules with a function that fails bytecode verification. The test
+// module is copied and the bytecode of one function is replaced with a reserved
+// opcode while leaving the module metadata intact.
+class VMBytecodeModuleMalformedTest : public ::testing::Test {
+ protected:
+  // IREE_VM_OP_CORE_RSV_0x85.
+  static constexpr uint8_t kReservedOpcode = 0x85;
+
+  virtual void SetUp() {
+    IREE_CHECK_OK(iree_vm_instance_create(IREE_VM_TYPE_CAPACITY_DEFAULT,
+                                          iree_allocator_system(), &instance_));
+
+    // The archive must retain the alignment of the embedded file.
+    const auto* module_file_toc = iree_vm_bytecode_module_test_module_create();
+    archive_size_ = static_cast<iree_host_size_t>(module_file_toc->size);
+    IREE_CHECK_OK(iree_allocator_malloc_aligned(
+        iree_allocator_system(), archive_size_,
+        IREE_VM_ARCHIVE_SEGMENT_ALIGNMENT, 0, (void**)&archive_data_));
+    memcpy(archive_data_, module_file_toc->data, archive_size_);
+    CorruptFunction("FuncIOEmpty");
+  }
+
+  virtual void TearDown() {
+    iree_vm_context_release(context_);
+    iree_vm_module_release(bytecode_module_);
+    iree_allocator_free_aligned(iree_allocator_system(), archive_data_);
+    iree_vm_instance_release(instance_);
+  }
+
+  iree_const_byte_span_t archive() const {
+    return iree_make_const_byte_span(archive_data_, archive_size_);
+  }
+
+  // Replaces the bytecode of the exported |function_name| with an opcode that
+  // is reserved and rejected by the verifier.
+  void CorruptFunction(const char* function_name) {
+    iree_const_byte_span_t flatbuffer_contents = iree_const_byte_span_empty();
+    iree_host_size_t rodata_offset = 0;
+    IREE_CHECK_OK(iree_vm_bytecode_archive_parse_header(
+        archive(), &flatbuffer_contents, &rodata_offset));
+    iree_vm_BytecodeModuleDef_table_t module_def =
+        iree_vm_BytecodeModuleDef_as_root(flatbuffer_contents.data);
+    iree_vm_ExportFunctionDef_vec_t exported_functions =
+        iree_vm_BytecodeModuleDef_exported_functions(module_def);
+    iree_vm_FunctionDescriptor_vec_t function_descriptors =
+        iree_vm_BytecodeModuleDef_function_descriptors(module_def);
+    flatbuffers_uint8_vec_t bytecode_data =
+        iree_vm_BytecodeModuleDef_bytecode_data(module_def);
+    size_t export_count = iree_vm_ExportFunctionDef_vec_len(exported_functions);
+    for (size_t i = 0; i < export_count; ++i) {
+      iree_vm_ExportFunctionDef_table_t export_def =
+          iree_vm_ExportFunctionDef_vec_at(exported_functions, i);
+      if (strcmp(iree_vm_ExportFunctionDef_local_name(export_def),
+                 function_name) != 0) {
+        continue;
+      }
+      const iree_vm_FunctionDescriptor_t* function_descriptor =
+          iree_vm_FunctionDescriptor_vec_at(
+              function_descriptors,
+              iree_vm_ExportFunctionDef_internal_ordinal(export_def));
+      // The flatbuffer views point into our mutable copy of the archive.
+      memset(const_cast<uint8_t*>(bytecode_data) +
+                 function_descriptor->bytecode_offset,
+             kReservedOpcode, function_descriptor->bytecode_length);
+      return;
+    }
+    FAIL() << "function " << function_name << " not found";
+  }
+
+  iree::Status CreateModule(iree_vm_bytecode_module_flags_t flags) {
+    IREE_RETURN_IF_ERROR(iree_vm_bytecode_module_create_with_flags(
+        instance_, flags, archive(), iree_allocator_null(),
+        iree_allocator_system(), &bytecode_module_));
+    std::vector<iree_vm_module_t*> modules = {bytecode_module_};
+    return iree_vm_context_create_with_modules(
+        instance_, IREE_VM_CONTEXT_FLAG_NONE, modules.size(), modules.data(),
+        iree_allocator_system(), &context_);
+  }
+
+  iree::Status InvokeFunction(const char* function_name,
+                              iree_vm_list_t* inputs, iree_vm_list_t* outputs) {
+    iree_vm_function_t function;
+    IREE_RETURN_IF_ERROR(iree_vm_module_lookup_function_by_name(
+        bytecode_module_, IREE_VM_FUNCTION_LINKAGE_EXPORT,
+        iree_make_cstring_view(function_name), &function));
+    return iree_vm_invoke(context_, function, IREE_VM_INVOCATION_FLAG_NONE,
+                          /*policy=*/nullptr, inputs, outputs,
+                          iree_allocator_system());
+  }
+
+  iree_vm_instance_t* instance_ = nullptr;
+  uint8_t* archive_data_ = nullptr;
+  iree_host_size_t archive_size_ = 0;
+  iree_vm_module_t* bytecode_module_ = nullptr;
+  iree_vm_context_t* context_ = nullptr;
+};
+
+TEST_F(VMBytecodeModuleMalformedTest, EagerVerificationFailsCreation) {
+  EXPECT_THAT(CreateModule(IREE_VM_BYTECODE_MODULE_FLAG_NONE),
+              StatusIs(StatusCode::kInvalidArgument));
+  EXPECT_EQ(bytecode_module_, nullptr);
+}
+
+TEST_F(VMBytecodeModuleMalformedTest, LazyVerificationFailsFirstCall) {
+  IREE_ASSERT_OK(CreateModule(IREE_VM_BYTECODE_MODULE_FLAG_LAZY_VERIFICATION));
+
+  // Well-formed functions in the module remain callable.
+  ref<iree_vm_list_t> inputs;
+  IREE_ASSERT_OK(iree_vm_list_create(iree_vm_make_undefined_type_def(), 1,
+                                     iree_allocator_system(), &inputs));
+  iree_vm_value_t input = iree_vm_value_make_i32(1);
+  IREE_ASSERT_OK(iree_vm_list_push_value(inputs.get(), &input));
+  ref<iree_vm_list_t> outputs;
+  IREE_ASSERT_OK(iree_vm_list_create(iree_vm_make_undefined_type_def(), 1,
+                                     iree_allocator_system(), &outputs));
+  IREE_EXPECT_OK(InvokeFunction("FuncIO1", inputs.get(), outputs.get()));
+
+  // Failed verification is not cached as success so every call fails.
+  for (int i = 0; i < 2; ++i) {
+    EXPECT_THAT(InvokeFunction("FuncIOEmpty", /*inputs=*/nullptr,
+                               /*outputs=*/nullptr),
+                StatusIs(StatusCode::kInvalidArgument));
+  }
+}
+
 }  // namespace
@@ -0,0 +1,991 @@
+// Copyright 2025 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/vm/fiber_scheduler.h"
+
+#include "iree/base/internal/atomic_slist.h"
+#include "iree/base/internal/atomics.h"
+#include "iree/base/internal/synchronization.h"
+#include "iree/base/internal/threading.h"
+#include "iree/base/internal/wait_handle.h"
+#include "iree/vm/stack.h"
+
+// Number of wait handles that can be tracked per fiber without allocating.
+// Most waits emitted by the compiler are on a single fence with a small number
+// of unique timepoints.
+#define IREE_VM_FIBER_INLINE_WAIT_CAPACITY 4
+
+//===----------------------------------------------------------------------===//
+// iree_vm_fiber_t
+//===----------------------------------------------------------------------===//
+
+typedef struct iree_vm_fiber_t {
+  // Intrusive link used by whichever list the fiber is currently in (ready
+  // queue, poller mailbox, or poller wait list). A fiber is only ever in one.
+  struct iree_vm_fiber_t* next;
+  // Previous fiber in the doubly-linked poller wait lists; unused otherwise.
+  struct iree_vm_fiber_t* prev;
+
+  // Parameters for beginning the invocation. Only valid until |begun| is set.
+  iree_vm_context_t* context;
+  iree_vm_function_t function;
+  iree_vm_invocation_flags_t flags;
+  const iree_vm_invocation_policy_t* policy;
+  iree_vm_list_t* inputs;
+
+  // Retained output list passed to the callback upon completion.
+  iree_vm_list_t* outputs;
+  iree_vm_fiber_callback_fn_t callback;
+  void* user_data;
+
+  // True once iree_vm_begin_invoke has been called and |state| is valid.
+  bool begun;
+
+  // Wait tracking owned by the poller thread.
+  struct {
+    // Wait frame on the top of the fiber stack.
+    iree_vm_wait_frame_t* frame;
+    // Absolute deadline for the wait; combines the wait frame deadline.
+    iree_time_t deadline_ns;
+    // True if wait handles have been exported and inserted into the wait set.
+    bool exported;
+    // True if one or more sources could not be inserted into the wait set and
+    // must be queried by the poller every poll interval. Polled fibers are
+    // linked into the poller |poll_list| instead of its |wait_list|.
+    bool polled;
+    // True if the fiber is linked into one of the poller wait lists.
+    bool registered;
+    // True if the fiber is in the list of fibers woken by the current wake.
+    bool woken;
+    // Link in the list of fibers woken by the current wake.
+    struct iree_vm_fiber_t* woken_next;
+    // Handles inserted into the poller wait set, one per wait source. Sources
+    // that were resolved prior to export or could not be exported have an
+    // immediate handle.
+    iree_wait_handle_t* handles;
+    iree_host_size_t handle_capacity;
+    iree_wait_handle_t inline_handles[IREE_VM_FIBER_INLINE_WAIT_CAPACITY];
+  } wait;
+
+  // Invocation state holding the VM stack. Must be last as it is large.
+  iree_vm_invoke_state_t state;
+} iree_vm_fiber_t;
+
+IREE_TYPED_ATOMIC_SLIST_WRAPPER(iree_vm_fiber, iree_vm_fiber_t,
+                                offsetof(iree_vm_fiber_t, next));
+
+// Doubly-linked list of fibers waiting in the poller.
+typedef struct iree_vm_fiber_list_t {
+  iree_vm_fiber_t* head;
+  iree_vm_fiber_t* tail;
+} iree_vm_fiber_list_t;
+
+static void iree_vm_fiber_list_append(iree_vm_fiber_list_t* list,
+                                      iree_vm_fiber_t* fiber) {
+  fiber->prev = list->tail;
+  fiber->next = NULL;
+  if (list->tail) {
+    list->tail->next = fiber;
+  } else {
+    list->head = fiber;
+  }
+  list->tail = fiber;
+}
+
+static void iree_vm_fiber_list_remove(iree_vm_fiber_list_t* list,
+                                      iree_vm_fiber_t* fiber) {
+  if (fiber->prev) {
+    fiber->prev->next = fiber->next;
+  } else {
+    list->head = fiber->next;
+  }
+  if (fiber->next) {
+    fiber->next->prev = fiber->prev;
+  } else {
+    list->tail = fiber->prev;
+  }
+  fiber->prev = NULL;
+  fiber->next = NULL;
+}
+
+//===----------------------------------------------------------------------===//
+// iree_vm_fiber_scheduler_t
+//===----------------------------------------------------------------------===//
+
+// A registration of a fiber waiting on a wait handle.
+typedef struct iree_vm_fiber_waiter_t {
+  iree_wait_handle_t handle;
+  // Fiber waiting on |handle| or NULL if the bucket is empty.
+  iree_vm_fiber_t* fiber;
+} iree_vm_fiber_waiter_t;
+
+struct iree_vm_fiber_scheduler_t {
+  iree_atomic_ref_count_t ref_count;
+  iree_allocator_t host_allocator;
+  iree_vm_fiber_scheduler_options_t options;
+
+  // Set when the scheduler is being destroyed and all threads should exit.
+  iree_atomic_int32_t exit_requested;
+
+  // Total number of fibers submitted that have not yet completed.
+  iree_atomic_int32_t fiber_count;
+  // Posted whenever |fiber_count| reaches zero.
+  iree_notification_t idle_notification;
+
+  // FIFO queue of fibers ready to run. Workers pop from the head and both
+  // new and woken fibers are appended to the tail.
+  iree_slim_mutex_t ready_mutex;
+  iree_vm_fiber_t* ready_head IREE_GUARDED_BY(ready_mutex);
+  iree_vm_fiber_t* ready_tail IREE_GUARDED_BY(ready_mutex);
+  // Number of fibers in the ready queue; used by workers without the lock.
+  iree_atomic_int32_t ready_count;
+  // Posted when fibers are added to the ready queue or exit is requested.
+  iree_notification_t ready_notification;
+
+  // LIFO mailbox used by workers to hand suspended fibers to the poller.
+  iree_vm_fiber_slist_t mailbox_slist;
+  // Event used to wake the poller from its system wait when new fibers arrive
+  // in the mailbox or exit is requested.
+  iree_event_t wake_event;
+
+  // Fibers waiting in the poller on registered handles or deadlines.
+  // Only accessed by the poller thread.
+  iree_vm_fiber_list_t wait_list;
+  // Fibers waiting in the poller with one or more sources that must be queried
+  // every poll interval. Only accessed by the poller thread.
+  iree_vm_fiber_list_t poll_list;
+  // Earliest deadline of any waiting fiber. Removing fibers does not update
+  // this and the poller recomputes it when it is reached.
+  iree_time_t next_deadline_ns;
+  // Time at which the fibers in |poll_list| must next be queried.
+  iree_time_t next_poll_ns;
+  // Wait set with the handles of all waiting fibers that could be exported
+  // along with the |wake_event|. Only accessed by the poller thread.
+  iree_wait_set_t* wait_set;
+  // Open-addressed table mapping registered wait handles to the fibers waiting
+  // on them so that a wake only queries the fibers it affects. Has
+  // |waiter_mask| + 1 buckets, at least twice |max_outstanding_waits|, and
+  // holds at most |max_outstanding_waits| registrations (|waiter_count|).
+  // Only accessed by the poller thread.
+  iree_vm_fiber_waiter_t* waiters;
+  uint32_t waiter_mask;
+  iree_host_size_t waiter_count;
+
+  // Poller thread performing the system multi-wait.
+  iree_thread_t* poller_thread;
+
+  // Worker threads running ready fibers.
+  iree_host_size_t worker_count;
+  iree_thread_t* worker_threads[];
+};
+
+static void iree_vm_fiber_scheduler_destroy(
+    iree_vm_fiber_scheduler_t* scheduler);
+static int iree_vm_fiber_scheduler_worker_main(void* entry_arg);
+static int iree_vm_fiber_scheduler_poller_main(void* entry_arg);
+
+IREE_API_EXPORT void iree_vm_fiber_scheduler_options_initialize(
+    iree_vm_fiber_scheduler_options_t* out_options) {
+  IREE_ASSERT_ARGUMENT(out_options);
+  memset(out_options, 0, sizeof(*out_options));
+  out_options->worker_count = 1;
+  out_options->max_outstanding_waits = 1024;
+  out_options->poll_interval_ns = 100000;  // 100us
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_fiber_scheduler_create(
+    const iree_vm_fiber_scheduler_options_t* options,
+    iree_allocator_t host_allocator,
+    iree_vm_fiber_scheduler_t** out_scheduler) {
+  IREE_ASSERT_ARGUMENT(options);
+  IREE_ASSERT_ARGUMENT(out_scheduler);
+  *out_scheduler = NULL;
+  if (IREE_UNLIKELY(options->worker_count == 0)) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "at least one worker is required");
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, options->worker_count);
+
+  iree_vm_fiber_scheduler_t* scheduler = NULL;
+  iree_host_size_t total_size =
+      sizeof(*scheduler) +
+      options->worker_count * sizeof(scheduler->worker_threads[0]);
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0,
+      iree_allocator_malloc(host_allocator, total_size, (void**)&scheduler));
+  memset(scheduler, 0, total_size);
+  iree_atomic_ref_count_init(&scheduler->ref_count);
+  scheduler->host_allocator = host_allocator;
+  scheduler->options = *options;
+  iree_notification_initialize(&scheduler->idle_notification);
+  iree_slim_mutex_initialize(&scheduler->ready_mutex);
+  iree_notification_initialize(&scheduler->ready_notification);
+  iree_vm_fiber_slist_initialize(&scheduler->mailbox_slist);
+  scheduler->wake_event = iree_wait_handle_immediate();
+  scheduler->next_deadline_ns = IREE_TIME_INFINITE_FUTURE;
+  scheduler->next_poll_ns = IREE_TIME_INFINITE_FUTURE;
+
+  iree_status_t status =
+      iree_event_initialize(/*initial_state=*/false, &scheduler->wake_event);
+  if (iree_status_is_ok(status)) {
+    iree_host_size_t waiter_capacity = 8;
+    while (waiter_capacity < options->max_outstanding_waits * 2) {
+      waiter_capacity <<= 1;
+    }
+    scheduler->waiter_mask = (uint32_t)(waiter_capacity - 1);
+    status = iree_allocator_malloc(
+        host_allocator, waiter_capacity * sizeof(scheduler->waiters[0]),
+        (void**)&scheduler->waiters);
+  }
+  if (iree_status_is_ok(status)) {
+    // +1 for the wake event.
+    status = iree_wait_set_allocate(options->max_outstanding_waits + 1,
+                                    host_allocator, &scheduler->wait_set);
+  }
+  if (iree_status_is_ok(status)) {
+    status = iree_wait_set_insert(scheduler->wait_set, scheduler->wake_event);
+  }
+
+  iree_thread_create_params_t thread_params;
+  memset(&thread_params, 0, sizeof(thread_params));
+  thread_params.priority_class = IREE_THREAD_PRIORITY_CLASS_NORMAL;
+  if (iree_status_is_ok(status)) {
+    thread_params.name = iree_make_cstring_view("iree-vm-poller");
+    status = iree_thread_create(iree_vm_fiber_scheduler_poller_main, scheduler,
+                                thread_params, host_allocator,
+                                &scheduler->poller_thread);
+  }
+  for (iree_host_size_t i = 0;
+       i < options->worker_count && iree_status_is_ok(status); ++i) {
+    thread_params.name = iree_make_cstring_view("iree-vm-worker");
+    status = iree_thread_create(iree_vm_fiber_scheduler_worker_main, scheduler,
+                                thread_params, host_allocator,
+                                &scheduler->worker_threads[i]);
+    if (iree_status_is_ok(status)) ++scheduler->worker_count;
+  }
+
+  if (iree_status_is_ok(status)) {
+    *out_scheduler = scheduler;
+  } else {
+    iree_vm_fiber_scheduler_destroy(scheduler);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+IREE_API_EXPORT void iree_vm_fiber_scheduler_retain(
+    iree_vm_fiber_scheduler_t* scheduler) {
+  if (IREE_LIKELY(scheduler)) {
+    iree_atomic_ref_count_inc(&scheduler->ref_count);
+  }
+}
+
+IREE_API_EXPORT void iree_vm_fiber_scheduler_release(
+    iree_vm_fiber_scheduler_t* scheduler) {
+  if (IREE_LIKELY(scheduler) &&
+      iree_atomic_ref_count_dec(&scheduler->ref_count) == 1) {
+    iree_vm_fiber_scheduler_destroy(scheduler);
+  }
+}
+
+IREE_API_EXPORT iree_host_size_t
+iree_vm_fiber_scheduler_fiber_count(iree_vm_fiber_scheduler_t* scheduler) {
+  IREE_ASSERT_ARGUMENT(scheduler);
+  return (iree_host_size_t)iree_atomic_load(&scheduler->fiber_count,
+                                            iree_memory_order_acquire);
+}
+
+//===----------------------------------------------------------------------===//
+// Fiber lifetime
+//===----------------------------------------------------------------------===//
+
+// Releases wait handle storage and frees |fiber|.
+static void iree_vm_fiber_free(iree_vm_fiber_scheduler_t* scheduler,
+                               iree_vm_fiber_t* fiber) {
+  if (fiber->wait.handles != fiber->wait.inline_handles) {
+    iree_allocator_free(scheduler->host_allocator, fiber->wait.handles);
+  }
+  iree_allocator_free(scheduler->host_allocator, fiber);
+}
+
+// Completes |fiber| by issuing the user callback with |status| and freeing the
+// fiber. If the invocation failed any invocation state is released.
+static void iree_vm_fiber_complete(iree_vm_fiber_scheduler_t* scheduler,
+                                   iree_vm_fiber_t* fiber,
+                                   iree_status_t status) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_vm_list_t* outputs = fiber->outputs;
+  fiber->outputs = NULL;
+  if (!iree_status_is_ok(status)) {
+    if (fiber->begun) {
+      iree_vm_abort_invoke(&fiber->state);
+    } else {
+      iree_vm_list_release(fiber->inputs);
+      iree_vm_context_release(fiber->context);
+    }
+    iree_vm_list_release(outputs);
+    outputs = NULL;
+  }
+
+  // Ownership of the status and outputs passes to the callback.
+  fiber->callback(fiber->user_data, status, outputs);
+  iree_vm_fiber_free(scheduler, fiber);
+
+  if (iree_atomic_fetch_sub(&scheduler->fiber_count, 1,
+                            iree_memory_order_acq_rel) == 1) {
+    iree_notification_post(&scheduler->idle_notification, IREE_ALL_WAITERS);
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+// Appends |fiber| to the tail of the ready queue and wakes a worker.
+static void iree_vm_fiber_scheduler_enqueue_ready(
+    iree_vm_fiber_scheduler_t* scheduler, iree_vm_fiber_t* fiber) {
+  fiber->next = NULL;
+  iree_slim_mutex_lock(&scheduler->ready_mutex);
+  if (scheduler->ready_tail) {
+    scheduler->ready_tail->next = fiber;
+  } else {
+    scheduler->ready_head = fiber;
+  }
+  scheduler->ready_tail = fiber;
+  iree_slim_mutex_unlock(&scheduler->ready_mutex);
+  iree_atomic_fetch_add(&scheduler->ready_count, 1, iree_memory_order_release);
+  iree_notification_post(&scheduler->ready_notification, 1);
+}
+
+// Pops the fiber at the head of the ready queue, if any.
+static iree_vm_fiber_t* iree_vm_fiber_scheduler_dequeue_ready(
+    iree_vm_fiber_scheduler_t* scheduler) {
+  iree_slim_mutex_lock(&scheduler->ready_mutex);
+  iree_vm_fiber_t* fiber = scheduler->ready_head;
+  if (fiber) {
+    scheduler->ready_head = fiber->next;
+    if (!scheduler->ready_head) scheduler->ready_tail = NULL;
+    fiber->next = NULL;
+  }
+  iree_slim_mutex_unlock(&scheduler->ready_mutex);
+  if (fiber) {
+    iree_atomic_fetch_sub(&scheduler->ready_count, 1,
+                          iree_memory_order_relaxed);
+  }
+  return fiber;
+}
+
+// Hands a suspended |fiber| with a wait frame to the poller.
+static void iree_vm_fiber_scheduler_enqueue_wait(
+    iree_vm_fiber_scheduler_t* scheduler, iree_vm_fiber_t* fiber) {
+  iree_vm_fiber_slist_push(&scheduler->mailbox_slist, fiber);
+  iree_event_set(&scheduler->wake_event);
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_fiber_scheduler_invoke(
+    iree_vm_fiber_scheduler_t* scheduler, iree_vm_context_t* context,
+    iree_vm_function_t function, iree_vm_invocation_flags_t flags,
+    const iree_vm_invocation_policy_t* policy, iree_vm_list_t* inputs,
+    iree_vm_list_t* outputs, iree_vm_fiber_callback_fn_t callback,
+    void* user_data) {
+  IREE_ASSERT_ARGUMENT(scheduler);
+  IREE_ASSERT_ARGUMENT(context);
+  IREE_ASSERT_ARGUMENT(callback);
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_vm_fiber_t* fiber = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(scheduler->host_allocator, sizeof(*fiber),
+                                (void**)&fiber));
+  memset(fiber, 0, offsetof(iree_vm_fiber_t, state));
+  fiber->context = context;
+  iree_vm_context_retain(context);
+  fiber->function = function;
+  fiber->flags = flags;
+  fiber->policy = policy;
+  fiber->inputs = inputs;
+  iree_vm_list_retain(inputs);
+  fiber->outputs = outputs;
+  iree_vm_list_retain(outputs);
+  fiber->callback = callback;
+  fiber->user_data = user_data;
+  fiber->wait.handles = fiber->wait.inline_handles;
+  fiber->wait.handle_capacity = IREE_ARRAYSIZE(fiber->wait.inline_handles);
+
+  iree_atomic_fetch_add(&scheduler->fiber_count, 1, iree_memory_order_acq_rel);
+  iree_vm_fiber_scheduler_enqueue_ready(scheduler, fiber);
+
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
+static bool iree_vm_fiber_scheduler_is_idle(void* arg) {
+  iree_vm_fiber_scheduler_t* scheduler = (iree_vm_fiber_scheduler_t*)arg;
+  return iree_atomic_load(&scheduler->fiber_count, iree_memory_order_acquire) ==
+         0;
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_fiber_scheduler_await_idle(
+    iree_vm_fiber_scheduler_t* scheduler, iree_timeout_t timeout) {
+  IREE_ASSERT_ARGUMENT(scheduler);
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_status_t status = iree_ok_status();
+  if (!iree_notification_await(&scheduler->idle_notification,
+                               iree_vm_fiber_scheduler_is_idle, scheduler,
+                               timeout)) {
+    status = iree_status_from_code(IREE_STATUS_DEADLINE_EXCEEDED);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+static void iree_vm_fiber_scheduler_destroy(
+    iree_vm_fiber_scheduler_t* scheduler) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_allocator_t host_allocator = scheduler->host_allocator;
+
+  // Request all threads exit and wake them up if they are waiting.
+  iree_atomic_store(&scheduler->exit_requested, 1, iree_memory_order_release);
+  iree_notification_post(&scheduler->ready_notification, IREE_ALL_WAITERS);
+  if (!iree_wait_handle_is_immediate(scheduler->wake_event)) {
+    iree_event_set(&scheduler->wake_event);
+  }
+
+  // Join all threads. Workers finish the fiber they are running (if any) and
+  // the poller exits without touching its wait list.
+  for (iree_host_size_t i = 0; i < scheduler->worker_count; ++i) {
+    iree_thread_release(scheduler->worker_threads[i]);
+  }
+  iree_thread_release(scheduler->poller_thread);
+
+  // Abort all fibers that were still pending. No threads remain so we can
+  // freely walk all lists.
+  iree_vm_fiber_t* fiber = NULL;
+  while ((fiber = iree_vm_fiber_scheduler_dequeue_ready(scheduler))) {
+    iree_vm_fiber_complete(scheduler, fiber,
+                           iree_status_from_code(IREE_STATUS_ABORTED));
+  }
+  while ((fiber = iree_vm_fiber_slist_pop(&scheduler->mailbox_slist))) {
+    iree_vm_fiber_complete(scheduler, fiber,
+                           iree_status_from_code(IREE_STATUS_ABORTED));
+  }
+  iree_vm_fiber_list_t* wait_lists[2] = {
+      &scheduler->wait_list,
+      &scheduler->poll_list,
+  };
+  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(wait_lists); ++i) {
+    while ((fiber = wait_lists[i]->head)) {
+      iree_vm_fiber_list_remove(wait_lists[i], fiber);
+      iree_vm_fiber_complete(scheduler, fiber,
+                             iree_status_from_code(IREE_STATUS_ABORTED));
+    }
+  }
+
+  iree_allocator_free(host_allocator, scheduler->waiters);
+  iree_wait_set_free(scheduler->wait_set);
+  iree_event_deinitialize(&scheduler->wake_event);
+  iree_vm_fiber_slist_deinitialize(&scheduler->mailbox_slist);
+  iree_notification_deinitialize(&scheduler->ready_notification);
+  iree_slim_mutex_deinitialize(&scheduler->ready_mutex);
+  iree_notification_deinitialize(&scheduler->idle_notification);
+  iree_allocator_free(host_allocator, scheduler);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+//===----------------------------------------------------------------------===//
+// Workers
+//===----------------------------------------------------------------------===//
+
+// Runs |fiber| until it completes, fails, or suspends. Suspended fibers are
+// handed to the poller (waits) or requeued (yields).
+static void iree_vm_fiber_scheduler_run_fiber(
+    iree_vm_fiber_scheduler_t* scheduler, iree_vm_fiber_t* fiber) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_status_t status = iree_ok_status();
+  if (!fiber->begun) {
+    status = iree_vm_begin_invoke(&fiber->state, fiber->context,
+                                  fiber->function, fiber->flags, fiber->policy,
+                                  fiber->inputs, scheduler->host_allocator);
+    if (iree_status_is_ok(status) || iree_status_is_deferred(status)) {
+      // The invocation state now retains the context and has captured the
+      // inputs so we can drop our references.
+      fiber->begun = true;
+      iree_vm_list_release(fiber->inputs);
+      fiber->inputs = NULL;
+      iree_vm_context_release(fiber->context);
+      fiber->context = NULL;
+    }
+  } else {
+    status = iree_vm_resume_invoke(&fiber->state);
+  }
+
+  if (iree_status_is_deferred(status)) {
+    // Suspended: either a wait (poller) or a cooperative yield (requeue).
+    iree_vm_stack_frame_t* current_frame =
+        iree_vm_stack_current_frame(fiber->state.stack);
+    if (IREE_UNLIKELY(!current_frame)) {
+      iree_vm_fiber_complete(
+          scheduler, fiber,
+          iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                           "unbalanced stack after yield"));
+    } else if (current_frame->type == IREE_VM_STACK_FRAME_WAIT) {
+      fiber->wait.frame =
+          (iree_vm_wait_frame_t*)iree_vm_stack_frame_storage(current_frame);
+      fiber->wait.deadline_ns = fiber->wait.frame->deadline_ns;
+      fiber->wait.exported = false;
+      fiber->wait.polled = false;
+      fiber->wait.registered = false;
+      iree_vm_fiber_scheduler_enqueue_wait(scheduler, fiber);
+    } else {
+      iree_vm_fiber_scheduler_enqueue_ready(scheduler, fiber);
+    }
+  } else if (iree_status_is_ok(status)) {
+    // Completed (successfully or otherwise); fetch the invocation result.
+    iree_status_t invoke_status = iree_ok_status();
+    status = iree_vm_end_invoke(&fiber->state, fiber->outputs, &invoke_status);
+    if (iree_status_is_ok(status)) {
+      iree_vm_fiber_complete(scheduler, fiber, invoke_status);
+    } else {
+      iree_status_ignore(invoke_status);
+      iree_vm_fiber_complete(scheduler, fiber, status);
+    }
+  } else {
+    iree_vm_fiber_complete(scheduler, fiber, status);
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+static bool iree_vm_fiber_scheduler_has_work_or_exit(void* arg) {
+  iree_vm_fiber_scheduler_t* scheduler = (iree_vm_fiber_scheduler_t*)arg;
+  return iree_atomic_load(&scheduler->ready_count, iree_memory_order_acquire) >
+             0 ||
+         iree_atomic_load(&scheduler->exit_requested,
+                          iree_memory_order_acquire) != 0;
+}
+
+static int iree_vm_fiber_scheduler_worker_main(void* entry_arg) {
+  iree_vm_fiber_scheduler_t* scheduler = (iree_vm_fiber_scheduler_t*)entry_arg;
+  while (true) {
+    iree_notification_await(&scheduler->ready_notification,
+                            iree_vm_fiber_scheduler_has_work_or_exit, scheduler,
+                            iree_infinite_timeout());
+    if (iree_atomic_load(&scheduler->exit_requested,
+                         iree_memory_order_acquire)) {
+      break;
+    }
+    // Another worker may have raced us to the fiber; that's ok.
+    iree_vm_fiber_t* fiber = iree_vm_fiber_scheduler_dequeue_ready(scheduler);
+    if (fiber) iree_vm_fiber_scheduler_run_fiber(scheduler, fiber);
+  }
+  return 0;
+}
+
+//===----------------------------------------------------------------------===//
+// Poller
+//===----------------------------------------------------------------------===//
+
+// The poller keeps the wait handles of every waiting fiber registered in
+// |wait_set| and only updates it incrementally as fibers arrive, resolve, or
+// fail. Wakes are mapped back to the fibers waiting on the woken handle through
+// the |waiters| table so that each wake only queries those fibers instead of
+// all waiting fibers. Deadlines are only scanned when the earliest one has been
+// reached and fibers with sources that cannot be waited on are queried every
+// poll interval.
+
+static uint32_t iree_vm_fiber_waiter_hash(iree_vm_fiber_scheduler_t* scheduler,
+                                          const iree_wait_handle_t* handle) {
+  // FNV-1a over the primitive identity.
+  uint32_t hash = 2166136261u ^ handle->type;
+  const uint8_t* bytes = (const uint8_t*)&handle->value;
+  for (iree_host_size_t i = 0; i < sizeof(handle->value); ++i) {
+    hash = (hash ^ bytes[i]) * 16777619u;
+  }
+  return hash & scheduler->waiter_mask;
+}
+
+// Returns true if |lhs| and |rhs| reference the same wait primitive.
+static bool iree_vm_fiber_wait_handle_equal(const iree_wait_handle_t* lhs,
+                                            const iree_wait_handle_t* rhs) {
+  return lhs->type == rhs->type &&
+         memcmp(&lhs->value, &rhs->value, sizeof(lhs->value)) == 0;
+}
+
+// Records that |fiber| is waiting on |handle|.
+// The table is sized so that it can never fill up.
+static void iree_vm_fiber_waiter_insert(iree_vm_fiber_scheduler_t* scheduler,
+                                        const iree_wait_handle_t* handle,
+                                        iree_vm_fiber_t* fiber) {
+  uint32_t i = iree_vm_fiber_waiter_hash(scheduler, handle);
+  while (scheduler->waiters[i].fiber) i = (i + 1) & scheduler->waiter_mask;
+  scheduler->waiters[i].handle = *handle;
+  scheduler->waiters[i].fiber = fiber;
+  ++scheduler->waiter_count;
+}
+
+// Removes one record of |fiber| waiting on |handle| and shifts back any entries
+// in the same probe sequence so that lookups never hit a premature empty
+// bucket.
+static void iree_vm_fiber_waiter_remove(iree_vm_fiber_scheduler_t* scheduler,
+                                        const iree_wait_handle_t* handle,
+                                        iree_vm_fiber_t* fiber) {
+  iree_vm_fiber_waiter_t* waiters = scheduler->waiters;
+  const uint32_t mask = scheduler->waiter_mask;
+  uint32_t i = iree_vm_fiber_waiter_hash(scheduler, handle);
+  for (; waiters[i].fiber; i = (i + 1) & mask) {
+    if (waiters[i].fiber == fiber &&
+        iree_vm_fiber_wait_handle_equal(&waiters[i].handle, handle)) {
+      break;
+    }
+  }
+  if (!waiters[i].fiber) return;
+  for (uint32_t j = (i + 1) & mask; waiters[j].fiber; j = (j + 1) & mask) {
+    uint32_t home = iree_vm_fiber_waiter_hash(scheduler, &waiters[j].handle);
+    if (((j - home) & mask) >= ((j - i) & mask)) {
+      waiters[i] = waiters[j];
+      i = j;
+    }
+  }
+  waiters[i].fiber = NULL;
+  --scheduler->waiter_count;
+}
+
+// Removes wait handle |index| of |fiber| from the poller wait set.
+static void iree_vm_fiber_scheduler_erase_wait_handle(
+    iree_vm_fiber_scheduler_t* scheduler, iree_vm_fiber_t* fiber,
+    iree_host_size_t index) {
+  iree_wait_handle_t* handle = &fiber->wait.handles[index];
+  if (iree_wait_handle_is_immediate(*handle)) return;
+  iree_wait_set_erase(scheduler->wait_set, *handle);
+  iree_vm_fiber_waiter_remove(scheduler, handle, fiber);
+  *handle = iree_wait_handle_immediate();
+}
+
+// Removes all wait handles of |fiber| from the poller wait set.
+static void iree_vm_fiber_scheduler_erase_wait_handles(
+    iree_vm_fiber_scheduler_t* scheduler, iree_vm_fiber_t* fiber) {
+  if (!fiber->wait.exported) return;
+  for (iree_host_size_t i = 0; i < fiber->wait.frame->count; ++i) {
+    iree_vm_fiber_scheduler_erase_wait_handle(scheduler, fiber, i);
+  }
+  fiber->wait.exported = false;
+}
+
+// Exports the wait sources of |fiber| and inserts them into the poller wait
+// set. Sources that cannot be exported or registered mark the fiber as polled.
+static iree_status_t iree_vm_fiber_scheduler_insert_wait_handles(
+    iree_vm_fiber_scheduler_t* scheduler, iree_vm_fiber_t* fiber) {
+  iree_vm_wait_frame_t* wait_frame = fiber->wait.frame;
+  if (wait_frame->count > fiber->wait.handle_capacity) {
+    iree_wait_handle_t* handles = NULL;
+    IREE_RETURN_IF_ERROR(iree_allocator_malloc(
+        scheduler->host_allocator, wait_frame->count * sizeof(*handles),
+        (void**)&handles));
+    if (fiber->wait.handles != fiber->wait.inline_handles) {
+      iree_allocator_free(scheduler->host_allocator, fiber->wait.handles);
+    }
+    fiber->wait.handles = handles;
+    fiber->wait.handle_capacity = wait_frame->count;
+  }
+
+  // All handles start immediate so that a partial export can be unwound.
+  for (iree_host_size_t i = 0; i < wait_frame->count; ++i) {
+    fiber->wait.handles[i] = iree_wait_handle_immediate();
+  }
+  fiber->wait.exported = true;
+
+  for (iree_host_size_t i = 0; i < wait_frame->count; ++i) {
+    iree_wait_source_t wait_source = wait_frame->wait_sources[i];
+    if (iree_wait_source_is_immediate(wait_source)) continue;
+    iree_wait_handle_t handle = iree_wait_handle_immediate();
+    iree_wait_handle_t* source_handle =
+        iree_wait_handle_from_source(&wait_source);
+    if (source_handle) {
+      handle = *source_handle;
+    } else {
+      iree_wait_primitive_t wait_primitive = iree_wait_primitive_immediate();
+      iree_status_t status = iree_wait_source_export(
+          wait_source, IREE_WAIT_PRIMITIVE_TYPE_ANY, iree_immediate_timeout(),
+          &wait_primitive);
+      if (iree_status_is_ok(status)) {
+        iree_wait_handle_wrap_primitive(wait_primitive.type,
+                                        wait_primitive.value, &handle);
+      } else if (iree_status_is_unavailable(status)) {
+        // Process-local sources (like HAL semaphores) can't be exported.
+        iree_status_ignore(status);
+        fiber->wait.polled = true;
+        continue;
+      } else {
+        return status;
+      }
+    }
+    if (scheduler->waiter_count >= scheduler->options.max_outstanding_waits) {
+      // Too many outstanding waits; fall back to polling this fiber.
+      fiber->wait.polled = true;
+      continue;
+    }
+    iree_status_t status = iree_wait_set_insert(scheduler->wait_set, handle);
+    if (iree_status_is_resource_exhausted(status)) {
+      // Wait set is full; fall back to polling this fiber.
+      iree_status_ignore(status);
+      fiber->wait.polled = true;
+      continue;
+    } else if (!iree_status_is_ok(status)) {
+      return status;
+    }
+    fiber->wait.handles[i] = handle;
+    iree_vm_fiber_waiter_insert(scheduler, &handle, fiber);
+  }
+  return iree_ok_status();
+}
+
+// Queries the wait sources of |fiber| and returns the wait status code:
+//   OK: the wait condition was satisfied
+//   DEFERRED: the wait is still pending
+//   *: the wait failed (deadline exceeded, source failure, etc)
+// Resolved sources of WAIT_ALL waits are erased from the wait set and neutered
+// so that the poller neither wakes on them nor queries them again.
+static iree_status_code_t iree_vm_fiber_scheduler_query_wait(
+    iree_vm_fiber_scheduler_t* scheduler, iree_vm_fiber_t* fiber,
+    iree_time_t now_ns) {
+  iree_vm_wait_frame_t* wait_frame = fiber->wait.frame;
+  if (wait_frame->wait_type == IREE_VM_WAIT_UNTIL) {
+    return fiber->wait.deadline_ns <= now_ns ? IREE_STATUS_OK
+                                             : IREE_STATUS_DEFERRED;
+  }
+
+  iree_host_size_t resolved_count = 0;
+  for (iree_host_size_t i = 0; i < wait_frame->count; ++i) {
+    iree_wait_source_t* wait_source = &wait_frame->wait_sources[i];
+    if (iree_wait_source_is_immediate(*wait_source)) {
+      ++resolved_count;
+      if (wait_frame->wait_type == IREE_VM_WAIT_ANY) return IREE_STATUS_OK;
+      continue;
+    }
+    iree_status_code_t wait_status_code = IREE_STATUS_OK;
+    iree_status_t status =
+        iree_wait_source_query(*wait_source, &wait_status_code);
+    if (!iree_status_is_ok(status)) {
+      wait_status_code = iree_status_code(status);
+      iree_status_ignore(status);
+    }
+    if (wait_status_code == IREE_STATUS_OK) {
+      ++resolved_count;
+      if (wait_frame->wait_type == IREE_VM_WAIT_ANY) return IREE_STATUS_OK;
+      if (fiber->wait.exported) {
+        iree_vm_fiber_scheduler_erase_wait_handle(scheduler, fiber, i);
+      }
+      *wait_source = iree_wait_source_immediate();
+    } else if (wait_status_code != IREE_STATUS_DEFERRED) {
+      return wait_status_code;
+    }
+  }
+  if (resolved_count == wait_frame->count) return IREE_STATUS_OK;
+  return fiber->wait.deadline_ns <= now_ns ? IREE_STATUS_DEADLINE_EXCEEDED
+                                           : IREE_STATUS_DEFERRED;
+}
+
+// Registers the wait handles of |fiber| and links it into the wait list it
+// belongs in.
+static iree_status_t iree_vm_fiber_scheduler_register_fiber(
+    iree_vm_fiber_scheduler_t* scheduler, iree_vm_fiber_t* fiber,
+    iree_time_t now_ns) {
+  if (fiber->wait.frame->wait_type != IREE_VM_WAIT_UNTIL) {
+    IREE_RETURN_IF_ERROR(
+        iree_vm_fiber_scheduler_insert_wait_handles(scheduler, fiber));
+  }
+  fiber->wait.registered = true;
+  if (fiber->wait.polled) {
+    iree_vm_fiber_list_append(&scheduler->poll_list, fiber);
+    scheduler->next_poll_ns = iree_min(
+        scheduler->next_poll_ns, now_ns + scheduler->options.poll_interval_ns);
+  } else {
+    iree_vm_fiber_list_append(&scheduler->wait_list, fiber);
+  }
+  scheduler->next_deadline_ns =
+      iree_min(scheduler->next_deadline_ns, fiber->wait.deadline_ns);
+  return iree_ok_status();
+}
+
+// Retires |fiber| from the poller. If |status| is OK the wait result is passed
+// to the waiter as |wait_status_code| and the fiber is requeued so that a
+// worker can resume it. Failures to manage the wait itself (vs. failures of the
+// wait) abort the invocation.
+static void iree_vm_fiber_scheduler_retire_fiber(
+    iree_vm_fiber_scheduler_t* scheduler, iree_vm_fiber_t* fiber,
+    iree_status_t status, iree_status_code_t wait_status_code) {
+  if (fiber->wait.registered) {
+    iree_vm_fiber_list_remove(fiber->wait.polled ? &scheduler->poll_list
+                                                 : &scheduler->wait_list,
+                              fiber);
+    fiber->wait.registered = false;
+  }
+  iree_vm_fiber_scheduler_erase_wait_handles(scheduler, fiber);
+  if (!iree_status_is_ok(status)) {
+    iree_vm_fiber_complete(scheduler, fiber, status);
+    return;
+  }
+  fiber->wait.frame->wait_status = iree_status_from_code(wait_status_code);
+  fiber->wait.frame = NULL;
+  IREE_ASSERT(iree_status_is_deferred(fiber->state.status));
+  iree_status_free(fiber->state.status);
+  fiber->state.status = iree_ok_status();
+  iree_vm_fiber_scheduler_enqueue_ready(scheduler, fiber);
+}
+
+// Queries the wait of |fiber| and retires it if it has resolved or failed.
+// Unresolved fibers that are not yet registered are registered.
+// Returns true if the fiber has been retired.
+static bool iree_vm_fiber_scheduler_poll_fiber(
+    iree_vm_fiber_scheduler_t* scheduler, iree_vm_fiber_t* fiber,
+    iree_time_t now_ns) {
+  iree_status_code_t wait_status_code =
+      iree_vm_fiber_scheduler_query_wait(scheduler, fiber, now_ns);
+  iree_status_t status = iree_ok_status();
+  if (wait_status_code == IREE_STATUS_DEFERRED) {
+    if (fiber->wait.registered) return false;
+    status = iree_vm_fiber_scheduler_register_fiber(scheduler, fiber, now_ns);
+    if (iree_status_is_ok(status)) return false;
+  }
+  iree_vm_fiber_scheduler_retire_fiber(scheduler, fiber, status,
+                                       wait_status_code);
+  return true;
+}
+
+// Registers all fibers posted to the mailbox, retiring those that have
+// already resolved.
+static void iree_vm_fiber_scheduler_process_mailbox(
+    iree_vm_fiber_scheduler_t* scheduler, iree_time_t now_ns) {
+  iree_vm_fiber_t* head = NULL;
+  iree_vm_fiber_t* tail = NULL;
+  if (!iree_vm_fiber_slist_flush(&scheduler->mailbox_slist,
+                                 IREE_ATOMIC_SLIST_FLUSH_ORDER_APPROXIMATE_FIFO,
+                                 &head, &tail)) {
+    return;
+  }
+  while (head) {
+    iree_vm_fiber_t* fiber = head;
+    head = fiber->next;
+    fiber->next = NULL;
+    iree_vm_fiber_scheduler_poll_fiber(scheduler, fiber, now_ns);
+  }
+}
+
+// Queries only the fibers waiting on |wake_handle| and retires those that have
+// resolved.
+static void iree_vm_fiber_scheduler_process_wake(
+    iree_vm_fiber_scheduler_t* scheduler, const iree_wait_handle_t* wake_handle,
+    iree_time_t now_ns) {
+  if (iree_wait_handle_is_immediate(*wake_handle)) return;
+
+  // Gather the waiting fibers first as retiring them mutates the table.
+  // A fiber may wait on the same handle multiple times but is only queried
+  // once.
+  iree_vm_fiber_t* woken_list = NULL;
+  iree_vm_fiber_waiter_t* waiters = scheduler->waiters;
+  for (uint32_t i = iree_vm_fiber_waiter_hash(scheduler, wake_handle);
+       waiters[i].fiber; i = (i + 1) & scheduler->waiter_mask) {
+    iree_vm_fiber_t* fiber = waiters[i].fiber;
+    if (fiber->wait.woken ||
+        !iree_vm_fiber_wait_handle_equal(&waiters[i].handle, wake_handle)) {
+      continue;
+    }
+    fiber->wait.woken = true;
+    fiber->wait.woken_next = woken_list;
+    woken_list = fiber;
+  }
+
+  while (woken_list) {
+    iree_vm_fiber_t* fiber = woken_list;
+    woken_list = fiber->wait.woken_next;
+    fiber->wait.woken_next = NULL;
+    fiber->wait.woken = false;
+    iree_vm_fiber_scheduler_poll_fiber(scheduler, fiber, now_ns);
+  }
+}
+
+// Queries the fibers in |list| whose deadline has been reached (or all of them
+// if |poll_all| is set) and retires those that have resolved. The deadlines of
+// the remaining fibers are accumulated into |inout_next_deadline_ns|.
+static void iree_vm_fiber_scheduler_scan_list(
+    iree_vm_fiber_scheduler_t* scheduler, iree_vm_fiber_list_t* list,
+    iree_time_t now_ns, bool poll_all, iree_time_t* inout_next_deadline_ns) {
+  iree_vm_fiber_t* next_fiber = list->head;
+  while (next_fiber) {
+    iree_vm_fiber_t* fiber = next_fiber;
+    next_fiber = fiber->next;
+    if ((poll_all || fiber->wait.deadline_ns <= now_ns) &&
+        iree_vm_fiber_scheduler_poll_fiber(scheduler, fiber, now_ns)) {
+      continue;
+    }
+    *inout_next_deadline_ns =
+        iree_min(*inout_next_deadline_ns, fiber->wait.deadline_ns);
+  }
+}
+
+// Services polled fibers and deadlines that are due as of |now_ns|. When
+// |poll_all| is set all waiting fibers are queried.
+static void iree_vm_fiber_scheduler_scan_waits(
+    iree_vm_fiber_scheduler_t* scheduler, iree_time_t now_ns, bool poll_all) {
+  bool poll_due = poll_all || scheduler->next_poll_ns <= now_ns;
+  bool deadline_due = poll_all || scheduler->next_deadline_ns <= now_ns;
+  if (!poll_due && !deadline_due) return;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_time_t next_deadline_ns = IREE_TIME_INFINITE_FUTURE;
+  iree_vm_fiber_scheduler_scan_list(scheduler, &scheduler->poll_list, now_ns,
+                                    poll_due, &next_deadline_ns);
+  if (poll_due) {
+    scheduler->next_poll_ns =
+        scheduler->poll_list.head ? now_ns + scheduler->options.poll_interval_ns
+                                  : IREE_TIME_INFINITE_FUTURE;
+  }
+  if (deadline_due) {
+    iree_vm_fiber_scheduler_scan_list(scheduler, &scheduler->wait_list, now_ns,
+                                      poll_all, &next_deadline_ns);
+    scheduler->next_deadline_ns = next_deadline_ns;
+  } else {
+    scheduler->next_deadline_ns =
+        iree_min(scheduler->next_deadline_ns, next_deadline_ns);
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+static int iree_vm_fiber_scheduler_poller_main(void* entry_arg) {
+  iree_vm_fiber_scheduler_t* scheduler = (iree_vm_fiber_scheduler_t*)entry_arg;
+  iree_wait_handle_t wake_handle = iree_wait_handle_immediate();
+  bool poll_all = false;
+  while (!iree_atomic_load(&scheduler->exit_requested,
+                           iree_memory_order_acquire)) {
+    IREE_TRACE_ZONE_BEGIN_NAMED(z0, "iree_vm_fiber_scheduler_pump");
+
+    // Reset before flushing the mailbox so that any fibers posted after the
+    // flush will set the event again and cause the wait below to fall through.
+    iree_event_reset(&scheduler->wake_event);
+    iree_time_t now_ns = iree_time_now();
+    iree_vm_fiber_scheduler_process_wake(scheduler, &wake_handle, now_ns);
+    iree_vm_fiber_scheduler_process_mailbox(scheduler, now_ns);
+    iree_vm_fiber_scheduler_scan_waits(scheduler, now_ns, poll_all);
+
+    // Sleep until a registered handle resolves, the wake event is set, or the
+    // earliest deadline/poll interval is reached. Failed waits don't identify
+    // which handle failed and all waiting fibers are queried to find it.
+    iree_time_t deadline_ns =
+        iree_min(scheduler->next_deadline_ns, scheduler->next_poll_ns);
+    wake_handle = iree_wait_handle_immediate();
+    iree_status_t status =
+        iree_wait_any(scheduler->wait_set, deadline_ns, &wake_handle);
+    poll_all = !iree_status_is_ok(status) &&
+               !iree_status_is_deadline_exceeded(status);
+    iree_status_ignore(status);
+
+    IREE_TRACE_ZONE_END(z0);
+  }
+  return 0;
+}
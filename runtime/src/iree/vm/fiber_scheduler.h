@@ -0,0 +1,126 @@
+// Copyright 2025 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_VM_FIBER_SCHEDULER_H_
+#define IREE_VM_FIBER_SCHEDULER_H_
+
+#include "iree/base/api.h"
+#include "iree/vm/context.h"
+#include "iree/vm/invocation.h"
+#include "iree/vm/list.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+//===----------------------------------------------------------------------===//
+// iree_vm_fiber_scheduler_t
+//===----------------------------------------------------------------------===//
+
+// Callback notifying the caller of an iree_vm_fiber_scheduler_invoke that the
+// invocation has completed. If successful then |outputs| will contain the
+// results. Ownership of both |status| and |outputs| is transferred to the
+// callee.
+//
+// This is executed from a scheduler worker thread and must not block; any
+// blocking work should be handed off to another thread so that the worker can
+// continue servicing other fibers.
+typedef void(IREE_API_PTR* iree_vm_fiber_callback_fn_t)(
+    void* user_data, iree_status_t status, iree_vm_list_t* outputs);
+
+// Parameters controlling fiber scheduler behavior.
+typedef struct iree_vm_fiber_scheduler_options_t {
+  // Total number of worker threads used to run ready fibers.
+  // Workers only ever execute VM code and never block on waits and as such
+  // this should generally be no more than the number of available cores.
+  iree_host_size_t worker_count;
+  // Maximum number of unique wait handles the poller will track at once.
+  // Fibers with waits that cannot be registered (either because the set is
+  // full or because the wait source cannot be exported to a system handle)
+  // are polled at |poll_interval_ns| instead.
+  iree_host_size_t max_outstanding_waits;
+  // Interval at which waits that cannot be represented by system wait handles
+  // (such as process-local HAL semaphores) are queried by the poller.
+  iree_duration_t poll_interval_ns;
+} iree_vm_fiber_scheduler_options_t;
+
+// Initializes |out_options| with the default scheduler options.
+IREE_API_EXPORT void iree_vm_fiber_scheduler_options_initialize(
+    iree_vm_fiber_scheduler_options_t* out_options);
+
+// A cooperative scheduler multiplexing many suspended VM invocations (fibers)
+// onto a small pool of worker threads.
+//
+// Each invocation submitted to the scheduler is run as a fiber using the
+// iree_vm_begin_invoke/iree_vm_resume_invoke sequence. When a fiber yields on a
+// wait frame (such as a HAL fence await) it is handed off to a single poller
+// thread that performs one system multi-wait over the wait sources of all
+// suspended fibers. As waits resolve the fibers are returned to the ready queue
+// where the next available worker resumes them. Yields without a wait frame
+// are treated as cooperative rescheduling points and go to the back of the
+// ready queue.
+//
+// This allows the number of concurrent invocations to scale with the amount of
+// outstanding work instead of the number of OS threads: a suspended fiber costs
+// only its VM stack and a few bytes of bookkeeping in the poller.
+//
+// Multiple fibers may only run against the same context concurrently if the
+// context was created with IREE_VM_CONTEXT_FLAG_CONCURRENT.
+//
+// Thread-safe.
+typedef struct iree_vm_fiber_scheduler_t iree_vm_fiber_scheduler_t;
+
+// Creates a fiber scheduler and launches its worker and poller threads.
+IREE_API_EXPORT iree_status_t iree_vm_fiber_scheduler_create(
+    const iree_vm_fiber_scheduler_options_t* options,
+    iree_allocator_t host_allocator,
+    iree_vm_fiber_scheduler_t** out_scheduler);
+
+// Retains the given |scheduler| for the caller.
+IREE_API_EXPORT void iree_vm_fiber_scheduler_retain(
+    iree_vm_fiber_scheduler_t* scheduler);
+
+// Releases the given |scheduler| from the caller.
+// When the last reference is released all threads are joined and any fibers
+// that have not yet completed have their callbacks issued with
+// IREE_STATUS_ABORTED. Use iree_vm_fiber_scheduler_await_idle prior to
+// releasing to allow in-flight invocations to complete.
+IREE_API_EXPORT void iree_vm_fiber_scheduler_release(
+    iree_vm_fiber_scheduler_t* scheduler);
+
+// Returns the total number of fibers that have been submitted and not yet
+// completed (ready, running, or waiting).
+IREE_API_EXPORT iree_host_size_t
+iree_vm_fiber_scheduler_fiber_count(iree_vm_fiber_scheduler_t* scheduler);
+
+// Invokes |function| in |context| as a new fiber on |scheduler|.
+// The call returns immediately with the fiber enqueued for execution and the
+// |callback| may be issued before this function returns.
+//
+// |inputs| is retained until the invocation has begun and |outputs| is
+// retained until the callback is issued, at which point ownership of the
+// reference is passed to the callback.
+//
+// The |callback| is guaranteed to be called exactly once if this function
+// returns OK, even if the invocation fails or the scheduler is released.
+IREE_API_EXPORT iree_status_t iree_vm_fiber_scheduler_invoke(
+    iree_vm_fiber_scheduler_t* scheduler, iree_vm_context_t* context,
+    iree_vm_function_t function, iree_vm_invocation_flags_t flags,
+    const iree_vm_invocation_policy_t* policy, iree_vm_list_t* inputs,
+    iree_vm_list_t* outputs, iree_vm_fiber_callback_fn_t callback,
+    void* user_data);
+
+// Blocks the caller until all fibers submitted to |scheduler| have completed
+// or the |timeout| elapses. Returns IREE_STATUS_DEADLINE_EXCEEDED if fibers
+// are still outstanding when the timeout is reached.
+IREE_API_EXPORT iree_status_t iree_vm_fiber_scheduler_await_idle(
+    iree_vm_fiber_scheduler_t* scheduler, iree_timeout_t timeout);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_VM_FIBER_SCHEDULER_H_
@@ -0,0 +1,402 @@
+// Copyright 2025 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/vm/fiber_scheduler.h"
+
+#include <atomic>
+#include <thread>
+
+#include "iree/base/api.h"
+#include "iree/base/internal/wait_handle.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+#include "iree/vm/api.h"
+#include "iree/vm/native_module_test.h"
+#include "iree/vm/ref_cc.h"
+
+namespace iree {
+namespace {
+
+//===----------------------------------------------------------------------===//
+// wait_module
+//===----------------------------------------------------------------------===//
+// A native module exporting a function that yields to the scheduler with a
+// wait on a set of test-owned events.
+
+static constexpr int kEventCount = 4;
+
+// Program counters of wait_module.wait_all.
+enum {
+  WAIT_ALL_PC_BEGIN = 0,
+  WAIT_ALL_PC_RESUME,
+};
+
+// wait_module.wait_all(%event_mask : i32, %timeout_ms : i32) -> i32
+// Waits until all events selected by |event_mask| have been set or
+// |timeout_ms| elapses (negative for infinite) and returns the status code of
+// the wait.
+static iree_status_t IREE_API_PTR WaitAllShim(
+    iree_vm_stack_t* stack, iree_vm_native_function_flags_t flags,
+    iree_byte_span_t args_storage, iree_byte_span_t rets_storage,
+    iree_vm_native_function_target_t target_fn, void* module,
+    void* module_state) {
+  auto* events = reinterpret_cast<iree_event_t*>(module);
+  iree_vm_stack_frame_t* current_frame = iree_vm_stack_top(stack);
+  if (current_frame->pc == WAIT_ALL_PC_BEGIN) {
+    const int32_t* args = reinterpret_cast<const int32_t*>(args_storage.data);
+    uint32_t event_mask = static_cast<uint32_t>(args[0]);
+    iree_timeout_t timeout = args[1] < 0 ? iree_infinite_timeout()
+                                         : iree_make_timeout_ms(args[1]);
+    iree_wait_source_t wait_sources[kEventCount];
+    iree_host_size_t wait_count = 0;
+    for (int i = 0; i < kEventCount; ++i) {
+      if (event_mask & (1u << i)) {
+        wait_sources[wait_count++] = iree_event_await(&events[i]);
+      }
+    }
+    current_frame->pc = WAIT_ALL_PC_RESUME;
+    iree_vm_wait_frame_t* wait_frame = nullptr;
+    IREE_RETURN_IF_ERROR(iree_vm_stack_wait_enter(stack, IREE_VM_WAIT_ALL,
+                                                  wait_count, timeout,
+                                                  /*trace_zone=*/0,
+                                                  &wait_frame));
+    memcpy(wait_frame->wait_sources, wait_sources,
+           wait_count * sizeof(wait_sources[0]));
+    return iree_status_from_code(IREE_STATUS_DEFERRED);
+  }
+  iree_vm_wait_result_t wait_result;
+  IREE_RETURN_IF_ERROR(iree_vm_stack_wait_leave(stack, &wait_result));
+  reinterpret_cast<int32_t*>(rets_storage.data)[0] =
+      static_cast<int32_t>(iree_status_code(wait_result.status));
+  iree_status_ignore(wait_result.status);
+  return iree_ok_status();
+}
+
+static const iree_vm_native_export_descriptor_t wait_module_exports_[] = {
+    {IREE_SV("wait_all"), IREE_SV("0ii_i"), 0, NULL},
+};
+static const iree_vm_native_function_ptr_t wait_module_funcs_[] = {
+    {WaitAllShim, nullptr},
+};
+static const iree_vm_native_module_descriptor_t wait_module_descriptor_ = {
+    /*name=*/IREE_SV("wait_module"),
+    /*version=*/0,
+    /*attr_count=*/0,
+    /*attrs=*/NULL,
+    /*dependency_count=*/0,
+    /*dependencies=*/NULL,
+    /*import_count=*/0,
+    /*imports=*/NULL,
+    /*export_count=*/IREE_ARRAYSIZE(wait_module_exports_),
+    /*exports=*/wait_module_exports_,
+    /*function_count=*/IREE_ARRAYSIZE(wait_module_funcs_),
+    /*functions=*/wait_module_funcs_,
+};
+
+// Creates a wait_module waiting on |events| (of kEventCount).
+static iree_status_t wait_module_create(iree_vm_instance_t* instance,
+                                        iree_event_t* events,
+                                        iree_allocator_t allocator,
+                                        iree_vm_module_t** out_module) {
+  iree_vm_module_t interface;
+  IREE_RETURN_IF_ERROR(iree_vm_module_initialize(&interface, events));
+  return iree_vm_native_module_create(&interface, &wait_module_descriptor_,
+                                      instance, allocator, out_module);
+}
+
+//===----------------------------------------------------------------------===//
+// iree_vm_fiber_scheduler_t
+//===----------------------------------------------------------------------===//
+
+struct InvocationResults {
+  std::atomic<int> completed{0};
+  std::atomic<int> failed{0};
+  std::atomic<int64_t> sum{0};
+};
+
+static void IREE_API_PTR AccumulateCallback(void* user_data,
+                                            iree_status_t status,
+                                            iree_vm_list_t* outputs) {
+  auto* results = reinterpret_cast<InvocationResults*>(user_data);
+  if (iree_status_is_ok(status)) {
+    iree_vm_value_t ret0;
+    IREE_CHECK_OK(iree_vm_list_get_value(outputs, 0, &ret0));
+    results->sum += ret0.i32;
+  } else {
+    ++results->failed;
+  }
+  iree_status_ignore(status);
+  iree_vm_list_release(outputs);
+  ++results->completed;
+}
+
+class VMFiberSchedulerTest : public ::testing::Test {
+ protected:
+  virtual void SetUp() {
+    for (int i = 0; i < kEventCount; ++i) {
+      IREE_CHECK_OK(
+          iree_event_initialize(/*initial_state=*/false, &events_[i]));
+    }
+    IREE_CHECK_OK(iree_vm_instance_create(IREE_VM_TYPE_CAPACITY_DEFAULT,
+                                          iree_allocator_system(), &instance_));
+    iree_vm_module_t* modules[2] = {nullptr, nullptr};
+    IREE_CHECK_OK(
+        module_a_create(instance_, iree_allocator_system(), &modules[0]));
+    IREE_CHECK_OK(wait_module_create(instance_, events_,
+                                     iree_allocator_system(), &modules[1]));
+    IREE_CHECK_OK(iree_vm_context_create_with_modules(
+        instance_, IREE_VM_CONTEXT_FLAG_CONCURRENT, IREE_ARRAYSIZE(modules),
+        modules, iree_allocator_system(), &context_));
+    for (auto* module : modules) iree_vm_module_release(module);
+    IREE_CHECK_OK(iree_vm_context_resolve_function(
+        context_, iree_make_cstring_view("module_a.add_1"), &add_1_));
+    IREE_CHECK_OK(iree_vm_context_resolve_function(
+        context_, iree_make_cstring_view("wait_module.wait_all"), &wait_all_));
+  }
+
+  virtual void TearDown() {
+    iree_vm_context_release(context_);
+    iree_vm_instance_release(instance_);
+    for (int i = 0; i < kEventCount; ++i) iree_event_deinitialize(&events_[i]);
+  }
+
+  // Submits a call to |function|(|args|...) -> i32 to |scheduler|.
+  void Submit(iree_vm_fiber_scheduler_t* scheduler, iree_vm_function_t function,
+              std::initializer_list<int32_t> args, InvocationResults* results) {
+    vm::ref<iree_vm_list_t> inputs;
+    IREE_ASSERT_OK(iree_vm_list_create(iree_vm_make_undefined_type_def(),
+                                       args.size(), iree_allocator_system(),
+                                       &inputs));
+    for (int32_t arg : args) {
+      iree_vm_value_t arg_value = iree_vm_value_make_i32(arg);
+      IREE_ASSERT_OK(iree_vm_list_push_value(inputs.get(), &arg_value));
+    }
+    vm::ref<iree_vm_list_t> outputs;
+    IREE_ASSERT_OK(iree_vm_list_create(iree_vm_make_undefined_type_def(), 1,
+                                       iree_allocator_system(), &outputs));
+    IREE_ASSERT_OK(iree_vm_fiber_scheduler_invoke(
+        scheduler, context_, function, IREE_VM_INVOCATION_FLAG_NONE,
+        /*policy=*/nullptr, inputs.get(), outputs.get(), AccumulateCallback,
+        results));
+  }
+
+  // Submits a call to module_a.add_1(|arg0|) to |scheduler|.
+  void SubmitAdd1(iree_vm_fiber_scheduler_t* scheduler, int32_t arg0,
+                  InvocationResults* results) {
+    Submit(scheduler, add_1_, {arg0}, results);
+  }
+
+  // Submits a call to wait_module.wait_all(|event_mask|, |timeout_ms|) to
+  // |scheduler|. The result is the status code of the wait.
+  void SubmitWaitAll(iree_vm_fiber_scheduler_t* scheduler, uint32_t event_mask,
+                     int32_t timeout_ms, InvocationResults* results) {
+    Submit(scheduler, wait_all_, {static_cast<int32_t>(event_mask), timeout_ms},
+           results);
+  }
+
+  // Spins until |results| has |count| completions.
+  static void WaitForCompletions(InvocationResults* results, int count) {
+    while (results->completed.load() < count) std::this_thread::yield();
+  }
+
+  iree_event_t events_[kEventCount];
+  iree_vm_instance_t* instance_ = nullptr;
+  iree_vm_context_t* context_ = nullptr;
+  iree_vm_function_t add_1_;
+  iree_vm_function_t wait_all_;
+};
+
+TEST_F(VMFiberSchedulerTest, CreateRelease) {
+  iree_vm_fiber_scheduler_options_t options;
+  iree_vm_fiber_scheduler_options_initialize(&options);
+  iree_vm_fiber_scheduler_t* scheduler = nullptr;
+  IREE_ASSERT_OK(iree_vm_fiber_scheduler_create(
+      &options, iree_allocator_system(), &scheduler));
+  EXPECT_EQ(0, iree_vm_fiber_scheduler_fiber_count(scheduler));
+  IREE_EXPECT_OK(
+      iree_vm_fiber_scheduler_await_idle(scheduler, iree_immediate_timeout()));
+  iree_vm_fiber_scheduler_release(scheduler);
+}
+
+TEST_F(VMFiberSchedulerTest, NoWorkers) {
+  iree_vm_fiber_scheduler_options_t options;
+  iree_vm_fiber_scheduler_options_initialize(&options);
+  options.worker_count = 0;
+  iree_vm_fiber_scheduler_t* scheduler = nullptr;
+  iree_status_t status = iree_vm_fiber_scheduler_create(
+      &options, iree_allocator_system(), &scheduler);
+  IREE_EXPECT_STATUS_IS(IREE_STATUS_INVALID_ARGUMENT, status);
+  iree_status_free(status);
+  EXPECT_EQ(nullptr, scheduler);
+}
+
+TEST_F(VMFiberSchedulerTest, SingleInvocation) {
+  iree_vm_fiber_scheduler_options_t options;
+  iree_vm_fiber_scheduler_options_initialize(&options);
+  iree_vm_fiber_scheduler_t* scheduler = nullptr;
+  IREE_ASSERT_OK(iree_vm_fiber_scheduler_create(
+      &options, iree_allocator_system(), &scheduler));
+
+  InvocationResults results;
+  SubmitAdd1(scheduler, 41, &results);
+  IREE_ASSERT_OK(
+      iree_vm_fiber_scheduler_await_idle(scheduler, iree_infinite_timeout()));
+  EXPECT_EQ(1, results.completed);
+  EXPECT_EQ(0, results.failed);
+  EXPECT_EQ(42, results.sum);
+
+  iree_vm_fiber_scheduler_release(scheduler);
+}
+
+TEST_F(VMFiberSchedulerTest, ManyConcurrentInvocations) {
+  iree_vm_fiber_scheduler_options_t options;
+  iree_vm_fiber_scheduler_options_initialize(&options);
+  options.worker_count = 4;
+  iree_vm_fiber_scheduler_t* scheduler = nullptr;
+  IREE_ASSERT_OK(iree_vm_fiber_scheduler_create(
+      &options, iree_allocator_system(), &scheduler));
+
+  static constexpr int kInvocationCount = 1000;
+  InvocationResults results;
+  int64_t expected_sum = 0;
+  for (int i = 0; i < kInvocationCount; ++i) {
+    SubmitAdd1(scheduler, i, &results);
+    expected_sum += i + 1;
+  }
+  IREE_ASSERT_OK(
+      iree_vm_fiber_scheduler_await_idle(scheduler, iree_infinite_timeout()));
+  EXPECT_EQ(kInvocationCount, results.completed);
+  EXPECT_EQ(0, results.failed);
+  EXPECT_EQ(expected_sum, results.sum);
+  EXPECT_EQ(0, iree_vm_fiber_scheduler_fiber_count(scheduler));
+
+  iree_vm_fiber_scheduler_release(scheduler);
+}
+
+// Tests that fibers waiting on events are resumed only as the events they wait
+// on are set.
+TEST_F(VMFiberSchedulerTest, WaitsResumeOnWake) {
+  iree_vm_fiber_scheduler_options_t options;
+  iree_vm_fiber_scheduler_options_initialize(&options);
+  options.worker_count = 2;
+  iree_vm_fiber_scheduler_t* scheduler = nullptr;
+  IREE_ASSERT_OK(iree_vm_fiber_scheduler_create(
+      &options, iree_allocator_system(), &scheduler));
+
+  // 16 fibers waiting on each event individually.
+  static constexpr int kFibersPerEvent = 16;
+  InvocationResults results;
+  for (int i = 0; i < kEventCount * kFibersPerEvent; ++i) {
+    SubmitWaitAll(scheduler, 1u << (i % kEventCount), /*timeout_ms=*/-1,
+                  &results);
+  }
+  IREE_EXPECT_STATUS_IS(
+      IREE_STATUS_DEADLINE_EXCEEDED,
+      iree_vm_fiber_scheduler_await_idle(scheduler,
+                                         iree_make_timeout_ms(10)));
+  EXPECT_EQ(0, results.completed);
+
+  // Set the events in reverse order and ensure only the fibers waiting on each
+  // are resumed.
+  for (int i = kEventCount - 1; i >= 0; --i) {
+    iree_event_set(&events_[i]);
+    int expected_count = (kEventCount - i) * kFibersPerEvent;
+    WaitForCompletions(&results, expected_count);
+    EXPECT_EQ(expected_count, results.completed);
+  }
+  IREE_ASSERT_OK(
+      iree_vm_fiber_scheduler_await_idle(scheduler, iree_infinite_timeout()));
+  EXPECT_EQ(kEventCount * kFibersPerEvent, results.completed);
+  EXPECT_EQ(0, results.failed);
+  EXPECT_EQ(IREE_STATUS_OK, results.sum);
+
+  iree_vm_fiber_scheduler_release(scheduler);
+}
+
+// Tests that a fiber waiting on multiple events is only resumed once all of
+// them have been set.
+TEST_F(VMFiberSchedulerTest, WaitAllResumesOnLastWake) {
+  iree_vm_fiber_scheduler_options_t options;
+  iree_vm_fiber_scheduler_options_initialize(&options);
+  iree_vm_fiber_scheduler_t* scheduler = nullptr;
+  IREE_ASSERT_OK(iree_vm_fiber_scheduler_create(
+      &options, iree_allocator_system(), &scheduler));
+
+  InvocationResults results;
+  SubmitWaitAll(scheduler, 0b0111, /*timeout_ms=*/-1, &results);
+  iree_event_set(&events_[0]);
+  iree_event_set(&events_[2]);
+  IREE_EXPECT_STATUS_IS(
+      IREE_STATUS_DEADLINE_EXCEEDED,
+      iree_vm_fiber_scheduler_await_idle(scheduler,
+                                         iree_make_timeout_ms(10)));
+  EXPECT_EQ(0, results.completed);
+
+  iree_event_set(&events_[1]);
+  IREE_ASSERT_OK(
+      iree_vm_fiber_scheduler_await_idle(scheduler, iree_infinite_timeout()));
+  EXPECT_EQ(1, results.completed);
+  EXPECT_EQ(0, results.failed);
+  EXPECT_EQ(IREE_STATUS_OK, results.sum);
+
+  iree_vm_fiber_scheduler_release(scheduler);
+}
+
+// Tests that waits that are never satisfied resume with a deadline exceeded
+// result without affecting other waits.
+TEST_F(VMFiberSchedulerTest, WaitDeadlineExceeded) {
+  iree_vm_fiber_scheduler_options_t options;
+  iree_vm_fiber_scheduler_options_initialize(&options);
+  iree_vm_fiber_scheduler_t* scheduler = nullptr;
+  IREE_ASSERT_OK(iree_vm_fiber_scheduler_create(
+      &options, iree_allocator_system(), &scheduler));
+
+  InvocationResults timeout_results;
+  SubmitWaitAll(scheduler, 0b0001, /*timeout_ms=*/10, &timeout_results);
+  InvocationResults wake_results;
+  SubmitWaitAll(scheduler, 0b0001, /*timeout_ms=*/-1, &wake_results);
+
+  WaitForCompletions(&timeout_results, 1);
+  EXPECT_EQ(0, timeout_results.failed);
+  EXPECT_EQ(IREE_STATUS_DEADLINE_EXCEEDED, timeout_results.sum);
+  EXPECT_EQ(1, iree_vm_fiber_scheduler_fiber_count(scheduler));
+
+  iree_event_set(&events_[0]);
+  IREE_ASSERT_OK(
+      iree_vm_fiber_scheduler_await_idle(scheduler, iree_infinite_timeout()));
+  EXPECT_EQ(1, wake_results.completed);
+  EXPECT_EQ(0, wake_results.failed);
+  EXPECT_EQ(IREE_STATUS_OK, wake_results.sum);
+
+  iree_vm_fiber_scheduler_release(scheduler);
+}
+
+// Tests that releasing the scheduler aborts fibers that are still waiting.
+TEST_F(VMFiberSchedulerTest, ReleaseAbortsWaits) {
+  iree_vm_fiber_scheduler_options_t options;
+  iree_vm_fiber_scheduler_options_initialize(&options);
+  iree_vm_fiber_scheduler_t* scheduler = nullptr;
+  IREE_ASSERT_OK(iree_vm_fiber_scheduler_create(
+      &options, iree_allocator_system(), &scheduler));
+
+  static constexpr int kInvocationCount = 8;
+  InvocationResults results;
+  for (int i = 0; i < kInvocationCount; ++i) {
+    SubmitWaitAll(scheduler, 1u << (i % kEventCount), /*timeout_ms=*/-1,
+                  &results);
+  }
+  IREE_EXPECT_STATUS_IS(
+      IREE_STATUS_DEADLINE_EXCEEDED,
+      iree_vm_fiber_scheduler_await_idle(scheduler,
+                                         iree_make_timeout_ms(10)));
+
+  iree_vm_fiber_scheduler_release(scheduler);
+  EXPECT_EQ(kInvocationCount, results.completed);
+  EXPECT_EQ(kInvocationCount, results.failed);
+}
+
+}  // namespace
+}  // namespace iree
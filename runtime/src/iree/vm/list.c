@@ -11,8 +11,14 @@
 #include <stdint.h>
 #include <string.h>
 
+#include "iree/base/internal/object_pool.h"
 #include "iree/vm/instance.h"
 
+// Lists are created for the arguments and results of every invocation and are
+// pooled (along with their storage) when using the system allocator.
+static iree_object_pool_type_t iree_vm_list_pool_type =
+    IREE_OBJECT_POOL_TYPE_INITIALIZER("iree_vm_list");
+
 static uint8_t iree_vm_value_type_size(iree_vm_type_def_t type) {
   // Size of each iree_vm_value_type_t in bytes. We bitpack these so that we
   // can do a simple shift and mask to get the size.
@@ -201,6 +207,8 @@ IREE_API_EXPORT iree_status_t iree_vm_list_create(
   IREE_ASSERT_ARGUMENT(out_list);
   IREE_TRACE_ZONE_BEGIN(z0);
 
+  allocator =
+      iree_object_pool_type_allocator(&iree_vm_list_pool_type, allocator);
   iree_vm_list_t* list = NULL;
   IREE_RETURN_AND_END_ZONE_IF_ERROR(
       z0, iree_allocator_malloc(allocator, sizeof(*list), (void**)&list));
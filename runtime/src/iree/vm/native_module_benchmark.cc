@@ -6,13 +6,106 @@
 
 #include "iree/base/api.h"
 #include "iree/testing/benchmark.h"
+#include "iree/vm/context.h"
+#include "iree/vm/instance.h"
+#include "iree/vm/invocation.h"
+#include "iree/vm/list.h"
 #include "iree/vm/module.h"
 #include "iree/vm/native_module.h"
 #include "iree/vm/native_module_test.h"
 #include "iree/vm/stack.h"
+#include "iree/vm/value.h"
 
 namespace {
 
-// TODO(benvanik): native module benchmarks.
+// Forwards all commands to the system allocator. Host object pools only stand
+// in for the system allocator itself so using this disables pooling.
+static iree_status_t ForwardingAllocatorCtl(void* self,
+                                            iree_allocator_command_t command,
+                                            const void* params,
+                                            void** inout_ptr) {
+  iree_allocator_t system_allocator = iree_allocator_system();
+  return system_allocator.ctl(system_allocator.self, command, params,
+                              inout_ptr);
+}
+
+// Creates a context with module_a and module_b from native_module_test.h.
+static iree_status_t CreateContext(iree_vm_instance_t* instance,
+                                   iree_vm_context_t** out_context) {
+  iree_vm_module_t* module_a = nullptr;
+  IREE_RETURN_IF_ERROR(
+      module_a_create(instance, iree_allocator_system(), &module_a));
+  iree_vm_module_t* module_b = nullptr;
+  iree_status_t status =
+      module_b_create(instance, iree_allocator_system(), &module_b);
+  if (iree_status_is_ok(status)) {
+    iree_vm_module_t* modules[] = {module_a, module_b};
+    status = iree_vm_context_create_with_modules(
+        instance, IREE_VM_CONTEXT_FLAG_NONE, IREE_ARRAYSIZE(modules), modules,
+        iree_allocator_system(), out_context);
+  }
+  iree_vm_module_release(module_b);
+  iree_vm_module_release(module_a);
+  return status;
+}
+
+// Invokes module_b.entry with fresh argument and result lists allocated from
+// |host_allocator| each iteration as an application would per call. This
+// measures the host overhead of an invocation independent of any work.
+static iree_status_t RunInvokeBenchmark(iree_benchmark_state_t* benchmark_state,
+                                        iree_allocator_t host_allocator) {
+  iree_vm_instance_t* instance = nullptr;
+  IREE_RETURN_IF_ERROR(iree_vm_instance_create(
+      IREE_VM_TYPE_CAPACITY_DEFAULT, iree_allocator_system(), &instance));
+  iree_vm_context_t* context = nullptr;
+  iree_status_t status = CreateContext(instance, &context);
+
+  iree_vm_function_t function;
+  if (iree_status_is_ok(status)) {
+    status = iree_vm_context_resolve_function(
+        context, IREE_SV("module_b.entry"), &function);
+  }
+
+  while (iree_status_is_ok(status) &&
+         iree_benchmark_keep_running(benchmark_state, 1)) {
+    iree_vm_list_t* input_list = nullptr;
+    iree_vm_list_t* output_list = nullptr;
+    status = iree_vm_list_create(iree_vm_make_undefined_type_def(), 1,
+                                 host_allocator, &input_list);
+    if (iree_status_is_ok(status)) {
+      iree_vm_value_t arg0 = iree_vm_value_make_i32(1);
+      status = iree_vm_list_push_value(input_list, &arg0);
+    }
+    if (iree_status_is_ok(status)) {
+      status = iree_vm_list_create(iree_vm_make_undefined_type_def(), 1,
+                                   host_allocator, &output_list);
+    }
+    if (iree_status_is_ok(status)) {
+      status = iree_vm_invoke(context, function, IREE_VM_INVOCATION_FLAG_NONE,
+                              /*policy=*/nullptr, input_list, output_list,
+                              host_allocator);
+    }
+    iree_vm_list_release(output_list);
+    iree_vm_list_release(input_list);
+  }
+
+  iree_vm_context_release(context);
+  iree_vm_instance_release(instance);
+  return status;
+}
+
+IREE_BENCHMARK_FN(BM_InvokeSystemAllocator) {
+  return RunInvokeBenchmark(benchmark_state, iree_allocator_system());
+}
+IREE_BENCHMARK_REGISTER(BM_InvokeSystemAllocator);
+
+IREE_BENCHMARK_FN(BM_InvokeUnpooledAllocator) {
+  iree_allocator_t host_allocator = {
+      /*self=*/nullptr,
+      /*ctl=*/ForwardingAllocatorCtl,
+  };
+  return RunInvokeBenchmark(benchmark_state, host_allocator);
+}
+IREE_BENCHMARK_REGISTER(BM_InvokeUnpooledAllocator);
 
 }  // namespace
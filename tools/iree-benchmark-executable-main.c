@@ -38,6 +38,19 @@ IREE_FLAG_LIST(
     "Each occurrence of the flag will run a benchmark with that set of\n"
     "workgroup count values.");
 
+IREE_FLAG(
+    string, dispatch_profile_file, "",
+    "Appends the mean time of each dispatch in nanoseconds to the given file\n"
+    "as a `<dispatch name> <candidate> <nanoseconds>` line. Profiles of\n"
+    "executables compiled with each --iree-llvmcpu-tile-size-candidate= can\n"
+    "be passed to the compiler with --iree-llvmcpu-tile-size-profile= to\n"
+    "select the fastest tile sizes per dispatch.");
+IREE_FLAG(string, dispatch_profile_name, "",
+          "Name of the dispatch (export) recorded in the dispatch profile.");
+IREE_FLAG(int32_t, dispatch_profile_candidate, 0,
+          "Tile size candidate the executable was compiled with recorded in "
+          "the dispatch profile.");
+
 // Total number of executable-level constants we (currently) allow; this is only
 // a limitation of how much memory we allocate and we could make this
 // dynamically growable.
@@ -251,7 +264,10 @@ static iree_status_t iree_benchmark_executable_run(
   // not testing cache effects. This means we need to account for the total
   // number of workgroups executed.
   int64_t dispatch_count = 0;
+  iree_duration_t dispatch_duration_ns = 0;
   while (iree_benchmark_keep_running(benchmark_state, FLAG_batch_size)) {
+    iree_time_t submit_time_ns = iree_time_now();
+
     // Submit the command buffer; if the device could not start executing while
     // we were recording then this will kick off the execution.
     ++fence_value;
@@ -265,6 +281,7 @@ static iree_status_t iree_benchmark_executable_run(
     // batch size is small then the final time may end up being mostly overhead.
     IREE_RETURN_IF_ERROR(iree_hal_semaphore_wait(fence_semaphore, fence_value,
                                                  iree_infinite_timeout()));
+    dispatch_duration_ns += iree_time_now() - submit_time_ns;
 
     iree_benchmark_pause_timing(benchmark_state);
 
@@ -289,6 +306,21 @@ static iree_status_t iree_benchmark_executable_run(
                               args->workgroup_count[2];
   iree_benchmark_set_items_processed(benchmark_state, total_invocations);
 
+  // Append the mean dispatch time to the profile. Each benchmark run (and any
+  // repetitions) appends its own line and the compiler averages them.
+  if (strlen(FLAG_dispatch_profile_file) > 0 && dispatch_count > 0) {
+    FILE* file = fopen(FLAG_dispatch_profile_file, "ab");
+    if (!file) {
+      return iree_make_status(IREE_STATUS_PERMISSION_DENIED,
+                              "failed to open dispatch profile file '%s'",
+                              FLAG_dispatch_profile_file);
+    }
+    fprintf(file, "%s %d %.1f\n", FLAG_dispatch_profile_name,
+            FLAG_dispatch_profile_candidate,
+            (double)dispatch_duration_ns / (double)dispatch_count);
+    fclose(file);
+  }
+
   iree_hal_command_buffer_release(command_buffer);
   iree_hal_semaphore_release(fence_semaphore);
 
@@ -319,6 +351,14 @@ static iree_status_t iree_parse_workgroup_count(
 // and input/output buffers.
 static iree_status_t iree_benchmark_executable_from_flags(
     iree_allocator_t host_allocator) {
+  if (strlen(FLAG_dispatch_profile_file) > 0 &&
+      (strlen(FLAG_dispatch_profile_name) == 0 ||
+       strchr(FLAG_dispatch_profile_name, ' '))) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "--dispatch_profile_file= requires a "
+                            "--dispatch_profile_name= without spaces");
+  }
+
   iree_vm_instance_t* instance = NULL;
   IREE_RETURN_IF_ERROR(iree_vm_instance_create(IREE_VM_TYPE_CAPACITY_DEFAULT,
                                                host_allocator, &instance));
@@ -164,6 +164,19 @@ IREE_FLAG(bool, quiet, false,
 
 IREE_FLAG(string, output, "", "Output .irpa file path.");
 
+IREE_FLAG(int32_t, alignment, IREE_IO_PARAMETER_ARCHIVE_DEFAULT_DATA_ALIGNMENT,
+          "Storage data alignment relative to the header. Use the filesystem\n"
+          "block size (commonly 4096) to allow copies to share source blocks\n"
+          "when the input and output are on the same filesystem.");
+IREE_FLAG(bool, deduplicate, false,
+          "Stores parameters with identical contents only once.");
+IREE_FLAG(bool, checksum, false,
+          "Stores a checksum of each parameter's contents that can be\n"
+          "verified when loading with --parameter_verify_checksums.");
+IREE_FLAG(int32_t, threads,
+          IREE_IO_PARAMETER_ARCHIVE_BUILD_DEFAULT_WORKER_COUNT,
+          "Number of threads used to hash and write parameters.");
+
 typedef struct {
   iree_allocator_t host_allocator;
   const char* path;
@@ -249,9 +262,19 @@ int main(int argc, char** argv) {
         .fn = iree_tooling_open_output_parameter_file,
         .user_data = &open_params,
     };
-    status = iree_io_build_parameter_archive(
+    iree_io_parameter_archive_build_options_t build_options;
+    iree_io_parameter_archive_build_options_initialize(&build_options);
+    if (FLAG_deduplicate) {
+      build_options.flags |= IREE_IO_PARAMETER_ARCHIVE_BUILD_FLAG_DEDUPLICATE;
+    }
+    if (FLAG_checksum) {
+      build_options.flags |= IREE_IO_PARAMETER_ARCHIVE_BUILD_FLAG_CHECKSUM;
+    }
+    build_options.data_alignment = (iree_io_physical_size_t)FLAG_alignment;
+    build_options.worker_count = (iree_host_size_t)iree_max(1, FLAG_threads);
+    status = iree_io_build_parameter_archive_with_options(
         new_index, built_index, open_callback,
-        /*target_file_offset=*/0, host_allocator);
+        /*target_file_offset=*/0, &build_options, host_allocator);
   }
 
   // Dump the new index ala iree-dump-parameters to show the final file.
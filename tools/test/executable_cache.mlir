@@ -0,0 +1,111 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: iree-compile %s -o %t/ignored.vmfb \
+// RUN:     --iree-hal-target-device=local \
+// RUN:     --iree-hal-local-target-device-backends=vmvx \
+// RUN:     --iree-hal-dump-executable-sources-to=- > %t/abs.mlir
+// RUN: sed 's/abs_dispatch_0/renamed_dispatch_0/g' %t/abs.mlir > %t/renamed.mlir
+
+// The first compilation populates the cache.
+// RUN: iree-compile %t/abs.mlir -o %t/miss.vmfb \
+// RUN:     --compile-mode=hal-executable \
+// RUN:     --iree-hal-executable-cache-dir %t/cache \
+// RUN:     --mlir-print-ir-before=iree-codegen-reconcile-translation-info \
+// RUN:     --mlir-print-ir-before=iree-hal-serialize-all-executables \
+// RUN:     --mlir-print-ir-before=iree-vm-ordinal-allocation 2>&1 | \
+// RUN: FileCheck %s --check-prefix=MISS
+
+// Compiling the same executable again (from a different input path and to a
+// different output path) reuses both the translation and the serialization.
+// RUN: cat %t/abs.mlir > %t/abs_copy.mlir
+// RUN: iree-compile %t/abs_copy.mlir -o %t/hit.vmfb \
+// RUN:     --compile-mode=hal-executable \
+// RUN:     --iree-hal-executable-cache-dir %t/cache \
+// RUN:     --mlir-print-ir-before=iree-codegen-reconcile-translation-info \
+// RUN:     --mlir-print-ir-before=iree-hal-serialize-all-executables \
+// RUN:     --mlir-print-ir-before=iree-vm-ordinal-allocation 2>&1 | \
+// RUN: FileCheck %s --check-prefix=HIT
+// RUN: diff %t/miss.vmfb %t/hit.vmfb
+
+// Renamed executables reuse the translation with their names restored but
+// serialize again as names are embedded in the binaries.
+// RUN: iree-compile %t/renamed.mlir -o %t/renamed.vmfb \
+// RUN:     --compile-mode=hal-executable \
+// RUN:     --iree-hal-executable-cache-dir %t/cache \
+// RUN:     --mlir-print-ir-before=iree-codegen-reconcile-translation-info \
+// RUN:     --mlir-print-ir-before=iree-hal-serialize-all-executables \
+// RUN:     --mlir-print-ir-before=iree-vm-ordinal-allocation 2>&1 | \
+// RUN: FileCheck %s --check-prefix=RENAMED
+
+// Dumping binaries bypasses the serialization cache so that the dump files are
+// produced.
+// RUN: iree-compile %t/abs.mlir -o %t/dump.vmfb \
+// RUN:     --compile-mode=hal-executable \
+// RUN:     --iree-hal-executable-cache-dir %t/cache \
+// RUN:     --iree-hal-dump-executable-binaries-to=%t/binaries \
+// RUN:     --mlir-print-ir-before=iree-codegen-reconcile-translation-info \
+// RUN:     --mlir-print-ir-before=iree-hal-serialize-all-executables \
+// RUN:     --mlir-print-ir-before=iree-vm-ordinal-allocation 2>&1 | \
+// RUN: FileCheck %s --check-prefix=DUMP
+// RUN: ls %t/binaries | FileCheck %s --check-prefix=DUMP-FILES
+
+// Files named by flags are keyed by their contents: recompiling with the same
+// file hits while editing it misses. The profile is unused by vmvx but still
+// part of the key.
+// RUN: echo "a" > %t/profile.txt
+// RUN: iree-compile %t/abs.mlir -o %t/file_miss.vmfb \
+// RUN:     --compile-mode=hal-executable \
+// RUN:     --iree-hal-executable-cache-dir %t/cache \
+// RUN:     --iree-llvmcpu-tile-size-profile=%t/profile.txt \
+// RUN:     --mlir-print-ir-before=iree-codegen-reconcile-translation-info \
+// RUN:     --mlir-print-ir-before=iree-hal-serialize-all-executables \
+// RUN:     --mlir-print-ir-before=iree-vm-ordinal-allocation 2>&1 | \
+// RUN: FileCheck %s --check-prefix=MISS
+// RUN: cp %t/profile.txt %t/profile_copy.txt
+// RUN: iree-compile %t/abs.mlir -o %t/file_hit.vmfb \
+// RUN:     --compile-mode=hal-executable \
+// RUN:     --iree-hal-executable-cache-dir %t/cache \
+// RUN:     --iree-llvmcpu-tile-size-profile %t/profile_copy.txt \
+// RUN:     --mlir-print-ir-before=iree-codegen-reconcile-translation-info \
+// RUN:     --mlir-print-ir-before=iree-hal-serialize-all-executables \
+// RUN:     --mlir-print-ir-before=iree-vm-ordinal-allocation 2>&1 | \
+// RUN: FileCheck %s --check-prefix=HIT
+// RUN: echo "b" > %t/profile.txt
+// RUN: iree-compile %t/abs.mlir -o %t/file_edit.vmfb \
+// RUN:     --compile-mode=hal-executable \
+// RUN:     --iree-hal-executable-cache-dir %t/cache \
+// RUN:     --iree-llvmcpu-tile-size-profile=%t/profile.txt \
+// RUN:     --mlir-print-ir-before=iree-codegen-reconcile-translation-info \
+// RUN:     --mlir-print-ir-before=iree-hal-serialize-all-executables \
+// RUN:     --mlir-print-ir-before=iree-vm-ordinal-allocation 2>&1 | \
+// RUN: FileCheck %s --check-prefix=MISS
+
+func.func @abs(%input : tensor<f32>) -> tensor<f32> {
+  %result = math.absf %input : tensor<f32>
+  return %result : tensor<f32>
+}
+
+// MISS: IR Dump Before ReconcileTranslationInfoPass
+// MISS: IR Dump Before SerializeAllExecutablesPass
+// MISS: hal.executable public @abs_dispatch_0
+// MISS: IR Dump Before OrdinalAllocationPass
+
+// HIT-NOT: IR Dump Before ReconcileTranslationInfoPass
+// HIT: IR Dump Before SerializeAllExecutablesPass
+// HIT: hal.executable public @abs_dispatch_0
+// HIT:   hal.executable.export public @abs_dispatch_0_elementwise
+// HIT:     vm.func private @abs_dispatch_0_elementwise
+// HIT-NOT: IR Dump Before OrdinalAllocationPass
+
+// RENAMED-NOT: IR Dump Before ReconcileTranslationInfoPass
+// RENAMED: IR Dump Before SerializeAllExecutablesPass
+// RENAMED: hal.executable public @renamed_dispatch_0
+// RENAMED:   hal.executable.export public @renamed_dispatch_0_elementwise
+// RENAMED:     vm.func private @renamed_dispatch_0_elementwise
+// RENAMED-NOT: abs_dispatch_0
+// RENAMED: IR Dump Before OrdinalAllocationPass
+
+// DUMP-NOT: IR Dump Before ReconcileTranslationInfoPass
+// DUMP: IR Dump Before SerializeAllExecutablesPass
+// DUMP: IR Dump Before OrdinalAllocationPass
+
+// DUMP-FILES: abs_dispatch_0